@@ -3482,6 +3482,23 @@ byte address constants into longword address constants.  */
 /* Propeller PC relative address used as a REPS instruction count.  */
   BFD_RELOC_PROPELLER_REPSREL,
 
+/* Propeller marker at the start of a compressed instruction which the
+linker may replace with a shorter form.  */
+  BFD_RELOC_PROPELLER_RELAX,
+
+/* Propeller marker for a code alignment point; the addend is the
+alignment in bytes.  The linker keeps the padding correct when it
+shrinks code in front of it.  */
+  BFD_RELOC_PROPELLER_ALIGN,
+
+/* Propeller difference of two symbols in code which the linker may
+relax.  The field holds the difference; the reloc is against the
+symbol subtracted, and the linker shrinks the field when it deletes
+code between the two.  */
+  BFD_RELOC_PROPELLER_DIFF8,
+  BFD_RELOC_PROPELLER_DIFF16,
+  BFD_RELOC_PROPELLER_DIFF32,
+
 /* IBM 370/390 relocations  */
   BFD_RELOC_I370_D12,
 
@@ -26,6 +26,9 @@
 #include "libbfd.h"
 #include "elf-bfd.h"
 #include "elf/propeller.h"
+#include "opcode/propeller.h"
+#include "dwarf2.h"
+#include "safe-ctype.h"
 
 /* Forward declarations.  */
 
@@ -529,6 +532,84 @@ static reloc_howto_type propeller_elf_howto_table[] = {
 	 0x0000003F,		/* dst_mask */
 	 TRUE),  		/* pcrel_offset */
 
+  /* Marks a compressed instruction which linker relaxation may
+     shorten; it does not touch the section contents. */
+  HOWTO (R_PROPELLER_RELAX,	/* type */
+	 0,			/* rightshift */
+	 3,			/* size (0 = byte, 1 = short, 2 = long) */
+	 0,			/* bitsize */
+	 FALSE,			/* pc_relative */
+	 0,			/* bitpos */
+	 complain_overflow_dont,	/* complain_on_overflow */
+	 bfd_elf_generic_reloc,	/* special_function */
+	 "R_PROPELLER_RELAX",	/* name */
+	 FALSE,			/* partial_inplace */
+	 0,			/* src_mask */
+	 0,			/* dst_mask */
+	 FALSE),		/* pcrel_offset */
+
+  /* Marks the start of the padding in front of an aligned piece of
+     code; the addend is the alignment. */
+  HOWTO (R_PROPELLER_ALIGN,	/* type */
+	 0,			/* rightshift */
+	 3,			/* size (0 = byte, 1 = short, 2 = long) */
+	 0,			/* bitsize */
+	 FALSE,			/* pc_relative */
+	 0,			/* bitpos */
+	 complain_overflow_dont,	/* complain_on_overflow */
+	 bfd_elf_generic_reloc,	/* special_function */
+	 "R_PROPELLER_ALIGN",	/* name */
+	 FALSE,			/* partial_inplace */
+	 0,			/* src_mask */
+	 0,			/* dst_mask */
+	 FALSE),		/* pcrel_offset */
+
+  /* The difference of two symbols in code which relaxation may
+     shrink.  The assembler puts the difference in the field, and the
+     reloc is against the symbol subtracted; relaxation adjusts the
+     field, and the final link leaves it alone. */
+  HOWTO (R_PROPELLER_DIFF8,	/* type */
+	 0,			/* rightshift */
+	 0,			/* size (0 = byte, 1 = short, 2 = long) */
+	 8,			/* bitsize */
+	 FALSE,			/* pc_relative */
+	 0,			/* bitpos */
+	 complain_overflow_dont,	/* complain_on_overflow */
+	 bfd_elf_generic_reloc,	/* special_function */
+	 "R_PROPELLER_DIFF8",	/* name */
+	 FALSE,			/* partial_inplace */
+	 0,			/* src_mask */
+	 0,			/* dst_mask */
+	 FALSE),		/* pcrel_offset */
+
+  HOWTO (R_PROPELLER_DIFF16,	/* type */
+	 0,			/* rightshift */
+	 1,			/* size (0 = byte, 1 = short, 2 = long) */
+	 16,			/* bitsize */
+	 FALSE,			/* pc_relative */
+	 0,			/* bitpos */
+	 complain_overflow_dont,	/* complain_on_overflow */
+	 bfd_elf_generic_reloc,	/* special_function */
+	 "R_PROPELLER_DIFF16",	/* name */
+	 FALSE,			/* partial_inplace */
+	 0,			/* src_mask */
+	 0,			/* dst_mask */
+	 FALSE),		/* pcrel_offset */
+
+  HOWTO (R_PROPELLER_DIFF32,	/* type */
+	 0,			/* rightshift */
+	 2,			/* size (0 = byte, 1 = short, 2 = long) */
+	 32,			/* bitsize */
+	 FALSE,			/* pc_relative */
+	 0,			/* bitpos */
+	 complain_overflow_dont,	/* complain_on_overflow */
+	 bfd_elf_generic_reloc,	/* special_function */
+	 "R_PROPELLER_DIFF32",	/* name */
+	 FALSE,			/* partial_inplace */
+	 0,			/* src_mask */
+	 0,			/* dst_mask */
+	 FALSE),		/* pcrel_offset */
+
 };
 
 /* Map BFD reloc types to Propeller ELF reloc types. */
@@ -559,6 +640,11 @@ static const struct propeller_reloc_map propeller_reloc_map[] = {
   {BFD_RELOC_16_PCREL, R_PROPELLER_PCREL16},
   {BFD_RELOC_8_PCREL, R_PROPELLER_PCREL8},
   {BFD_RELOC_PROPELLER_REPSREL, R_PROPELLER_REPSREL},
+  {BFD_RELOC_PROPELLER_RELAX, R_PROPELLER_RELAX},
+  {BFD_RELOC_PROPELLER_ALIGN, R_PROPELLER_ALIGN},
+  {BFD_RELOC_PROPELLER_DIFF8, R_PROPELLER_DIFF8},
+  {BFD_RELOC_PROPELLER_DIFF16, R_PROPELLER_DIFF16},
+  {BFD_RELOC_PROPELLER_DIFF32, R_PROPELLER_DIFF32},
 };
 
 static reloc_howto_type *
@@ -727,6 +813,15 @@ propeller_elf_relocate_section (bfd * output_bfd,
       sym = NULL;
       sec = NULL;
 
+      /* the relaxation markers do not change the contents, nor do the
+	 relocs that relaxation has made redundant, nor the symbol
+	 differences it has already adjusted */
+      if (r_type == R_PROPELLER_NONE
+	  || r_type == R_PROPELLER_RELAX || r_type == R_PROPELLER_ALIGN
+	  || r_type == R_PROPELLER_DIFF8 || r_type == R_PROPELLER_DIFF16
+	  || r_type == R_PROPELLER_DIFF32)
+	continue;
+
       if (r_symndx < symtab_hdr->sh_info)
 	{
 	  sym = local_syms + r_symndx;
@@ -841,6 +936,101 @@ propeller_elf_merge_symbol_attribute (struct elf_link_hash_entry *h,
 /* Return the section that should be marked against GC for a given
    relocation.  */
 
+/* Cog overlays are sections whose names start or end with ".cog" or
+   ".ecog".  The linker provides __load_start_xxx and __load_stop_xxx
+   symbols for them, where xxx is the section name with the dots turned
+   into underscores; code that starts a cog refers to the overlay only
+   through those symbols, which are still undefined during GC.  */
+
+static bfd_boolean
+propeller_overlay_section_p (const char *name)
+{
+  size_t namelen = strlen (name);
+
+  return ((namelen > 4 && !strcmp (name + namelen - 4, ".cog"))
+	  || !strncmp (name, ".cog", 4)
+	  || (namelen > 5 && !strcmp (name + namelen - 5, ".ecog"))
+	  || !strncmp (name, ".ecog", 5));
+}
+
+/* If NAME is the __load_start_ or __load_stop_ symbol of an overlay,
+   return the overlay part of it, else NULL.  */
+
+static const char *
+propeller_overlay_symbol_suffix (const char *name)
+{
+  if (CONST_STRNEQ (name, "__load_start_"))
+    return name + sizeof "__load_start_" - 1;
+  if (CONST_STRNEQ (name, "__load_stop_"))
+    return name + sizeof "__load_stop_" - 1;
+  return NULL;
+}
+
+/* Does section name SECNAME give the symbol suffix SUFFIX?  This
+   mangles the name the same way as propeller_place_orphan in ld.  */
+
+static bfd_boolean
+propeller_overlay_name_matches (const char *secname, const char *suffix)
+{
+  const char *s1;
+
+  for (s1 = secname; *s1 != '\0'; s1++)
+    if (ISALNUM (*s1) || *s1 == '_')
+      {
+	if (*suffix++ != *s1)
+	  return FALSE;
+      }
+    else if (s1 != secname && *s1 == '.')
+      {
+	if (*suffix++ != '_')
+	  return FALSE;
+      }
+  return *suffix == '\0';
+}
+
+/* Call FUNC for each input overlay section named by SUFFIX.  Returns
+   the first such section.  */
+
+static asection *
+propeller_overlay_sections (struct bfd_link_info *info, const char *suffix,
+			    void (*func) (struct bfd_link_info *, asection *))
+{
+  asection *first = NULL;
+  bfd *in;
+  asection *sec;
+
+  for (in = info->input_bfds; in; in = in->link.next)
+    for (sec = in->sections; sec; sec = sec->next)
+      if (propeller_overlay_section_p (sec->name)
+	  && propeller_overlay_name_matches (sec->name, suffix))
+	{
+	  if (first == NULL)
+	    first = sec;
+	  else if (func != NULL)
+	    func (info, sec);
+	}
+  return first;
+}
+
+static asection *
+propeller_elf_gc_mark_hook (asection *, struct bfd_link_info *,
+			    Elf_Internal_Rela *, struct elf_link_hash_entry *,
+			    Elf_Internal_Sym *);
+
+static void
+propeller_gc_mark_overlay (struct bfd_link_info *info, asection *sec)
+{
+  if (!sec->gc_mark)
+    _bfd_elf_gc_mark (info, sec, propeller_elf_gc_mark_hook);
+}
+
+static void
+propeller_gc_keep_overlay (struct bfd_link_info *info ATTRIBUTE_UNUSED,
+			   asection *sec)
+{
+  sec->flags |= SEC_KEEP;
+}
+
 static asection *
 propeller_elf_gc_mark_hook (asection * sec,
 			    struct bfd_link_info *info,
@@ -848,6 +1038,24 @@ propeller_elf_gc_mark_hook (asection * sec,
 			    struct elf_link_hash_entry *h,
 			    Elf_Internal_Sym * sym)
 {
+  /* a reference to the load address of an overlay keeps the overlay;
+     it is the only reference a driver's cog code ever gets */
+  if (h != NULL
+      && (h->root.type == bfd_link_hash_undefined
+	  || h->root.type == bfd_link_hash_undefweak))
+    {
+      const char *suffix = propeller_overlay_symbol_suffix (h->root.root.string);
+
+      if (suffix != NULL)
+	{
+	  asection *overlay;
+
+	  overlay = propeller_overlay_sections (info, suffix,
+						propeller_gc_mark_overlay);
+	  if (overlay != NULL)
+	    return overlay;
+	}
+    }
   return _bfd_elf_gc_mark_hook (sec, info, rel, h, sym);
 }
 
@@ -926,6 +1134,18 @@ propeller_elf_object_p (bfd *abfd)
   return TRUE;
 }
 
+/* gas --dual-encoding gives the other encoding of a function its own
+   section type, so that a linker which cannot choose between the two
+   rejects the object rather than keeping both */
+static bfd_boolean
+propeller_elf_section_from_shdr (bfd *abfd, Elf_Internal_Shdr *hdr,
+				 const char *name, int shindex)
+{
+  if (hdr->sh_type != SHT_PROPELLER_DUAL)
+    return FALSE;
+  return _bfd_elf_make_section_from_shdr (abfd, hdr, name, shindex);
+}
+
 /* final write processing; set flags in the object file, etc */
 static void
 propeller_elf_final_write_processing (bfd *abfd,
@@ -1105,40 +1325,2055 @@ propeller_elf_modify_program_headers (bfd *abfd, struct bfd_link_info *info)
   return TRUE;
 }
 
-static void
-propeller_elf_gc_keep (struct bfd_link_info *info)
+/* Linker relaxation.
+
+   Objects assembled with --relax mark every compressed instruction
+   which has a shorter form with an R_PROPELLER_RELAX reloc, and the
+   start of the padding in front of each aligned piece of code with an
+   R_PROPELLER_ALIGN reloc.  Once the final addresses are known
+	ljmp  becomes  brs or brw
+	brw   becomes  brs
+	mvi   becomes  mvib or mviw
+	mviw  becomes  mvib
+   and the bytes which are no longer needed are deleted.  LMM mvi and
+   ldi of a constant may become a single instruction (see below).  */
+
+/* Code behind an alignment marker may only move by a multiple of its
+   alignment, so deleting bytes moves the rest of the section down in
+   pieces; an offset at or above START moves down by DELTA, but not
+   below FLOOR (which is where new padding, if any, starts).  The bytes
+   in [FROM, TO) are the ones that are moved, and MARK is the offset of
+   the alignment marker.  */
+
+struct propeller_shift
 {
-  bfd *in;
-  struct bfd_section *sec;
-  /*
-    look for sections starting or ending with ".cog" or ".ecog";
-    these should never be garbage collected
-    (actually we could do even better and KEEP them only
-    if the corresponding _load_start_xxx symbol is referenced,
-    but for now just keep them all)
-  */
-  for (in = info->input_bfds; in; in = in->link.next)
+  bfd_vma start;
+  bfd_vma from;
+  bfd_vma to;
+  bfd_vma delta;
+  bfd_vma floor;
+  bfd_vma mark;
+};
+
+struct propeller_deletion
+{
+  bfd_vma addr;
+  unsigned int nshift;
+  struct propeller_shift *shift;
+};
+
+/* Return the offset X will have once a deletion is done.  */
+
+static bfd_vma
+propeller_relax_map (const struct propeller_deletion *del, bfd_vma x)
+{
+  unsigned int i;
+
+  if (x < del->addr)
+    return x;
+  for (i = del->nshift; i-- > 0;)
+    {
+      const struct propeller_shift *s = &del->shift[i];
+
+      if (x >= s->start)
+	return x < s->floor + s->delta ? s->floor : x - s->delta;
+    }
+  return x;
+}
+
+/* Return the offset the alignment marker at X will have: the start of
+   the padding in front of the code it aligns.  */
+
+static bfd_vma
+propeller_relax_map_align (const struct propeller_deletion *del, bfd_vma x)
+{
+  unsigned int i;
+
+  for (i = 1; i < del->nshift; i++)
+    if (del->shift[i].mark == x)
+      return del->shift[i].floor;
+  return propeller_relax_map (del, x);
+}
+
+static int
+propeller_compare_relocs (const void *a, const void *b)
+{
+  const Elf_Internal_Rela *ra = *(const Elf_Internal_Rela * const *) a;
+  const Elf_Internal_Rela *rb = *(const Elf_Internal_Rela * const *) b;
+
+  if (ra->r_offset != rb->r_offset)
+    return ra->r_offset < rb->r_offset ? -1 : 1;
+  return 0;
+}
+
+/* Work out how the code moves if COUNT bytes at ADDR in SEC are
+   deleted.  */
+
+static bfd_boolean
+propeller_plan_deletion (asection *sec, bfd_vma addr, unsigned int count,
+			 struct propeller_deletion *del)
+{
+  Elf_Internal_Rela *irel, *irelend;
+  Elf_Internal_Rela **marks;
+  unsigned int nmarks, i;
+  struct propeller_shift *s;
+
+  irel = elf_section_data (sec)->relocs;
+  irelend = irel + sec->reloc_count;
+
+  marks = bfd_malloc ((sec->reloc_count + 1) * sizeof (*marks));
+  del->shift = bfd_malloc ((sec->reloc_count + 1) * sizeof (*del->shift));
+  if (marks == NULL || del->shift == NULL)
+    {
+      free (marks);
+      free (del->shift);
+      return FALSE;
+    }
+
+  nmarks = 0;
+  for (; irel < irelend; irel++)
+    if (ELF32_R_TYPE (irel->r_info) == R_PROPELLER_ALIGN
+	&& irel->r_offset >= addr + count
+	&& irel->r_addend > 1)
+      marks[nmarks++] = irel;
+  qsort (marks, nmarks, sizeof (*marks), propeller_compare_relocs);
+
+  del->addr = addr;
+  s = del->shift;
+  s->start = addr;
+  s->from = addr + count;
+  s->to = sec->size;
+  s->delta = count;
+  s->floor = addr;
+  s->mark = (bfd_vma) -1;
+  del->nshift = 1;
+
+  for (i = 0; i < nmarks && s->delta != 0; i++)
+    {
+      bfd_vma pos = marks[i]->r_offset;
+      bfd_vma align = marks[i]->r_addend;
+      bfd_vma newpos = pos - s->delta;
+
+      if (pos < s->from)
+	continue;
+      s->to = pos;
+      s++;
+      s->from = BFD_ALIGN (pos, align);
+      /* an offset at the marker is the start of the padding, unless
+	 there was none, when it is the aligned code */
+      s->start = pos == s->from ? pos : pos + 1;
+      s->to = sec->size;
+      s->delta = s->from - BFD_ALIGN (newpos, align);
+      s->floor = newpos;
+      s->mark = pos;
+      del->nshift++;
+    }
+
+  free (marks);
+  return TRUE;
+}
+
+/* Find the address a DW_LNE_set_address at offset OFFSET in the line
+   table SEC of ABFD sets, as an offset into section TARGET.  */
+
+static bfd_boolean
+propeller_line_address (bfd *abfd, Elf_Internal_Sym *isymbuf,
+			asection *sec, asection *target,
+			bfd_vma offset, bfd_vma *addr)
+{
+  Elf_Internal_Shdr *symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
+  Elf_Internal_Rela *irel, *irelend;
+
+  irel = elf_section_data (sec)->relocs;
+  irelend = irel + sec->reloc_count;
+  for (; irel < irelend; irel++)
     {
-      for (sec = in->sections; sec; sec = sec->next)
+      unsigned long r_symndx;
+
+      if (irel->r_offset != offset)
+	continue;
+      r_symndx = ELF32_R_SYM (irel->r_info);
+      if (r_symndx < symtab_hdr->sh_info)
+	{
+	  Elf_Internal_Sym *isym = isymbuf + r_symndx;
+
+	  if (bfd_section_from_elf_index (abfd, isym->st_shndx) != target)
+	    return FALSE;
+	  *addr = isym->st_value + irel->r_addend;
+	}
+      else
 	{
-	  const char *name = sec->name;
-	  size_t namelen = strlen(name);
-	  int keep = 0;
-
-	  if ((namelen > 4 && !strcmp(name+namelen-4, ".cog")) || !strncmp(name, ".cog", 4))
-	    keep = 1;
-	  else if ((namelen > 5 && !strcmp(name+namelen-5, ".ecog")) || !strncmp(name, ".ecog", 5))
-	    keep = 1;
-	  if (keep)
-	    sec->flags |= SEC_KEEP;
+	  struct elf_link_hash_entry *h;
+
+	  h = elf_sym_hashes (abfd)[r_symndx - symtab_hdr->sh_info];
+	  if ((h->root.type != bfd_link_hash_defined
+	       && h->root.type != bfd_link_hash_defweak)
+	      || h->root.u.def.section != target)
+	    return FALSE;
+	  *addr = h->root.u.def.value + irel->r_addend;
 	}
+      return TRUE;
     }
-  /* do the usual marking of sections containing entry symbol and
-     symbols undefined on the command-line
-  */
-  _bfd_elf_gc_keep (info);
+  return FALSE;
 }
-
+
+static int
+propeller_compare_vma (const void *a, const void *b)
+{
+  bfd_vma x = *(const bfd_vma *) a;
+  bfd_vma y = *(const bfd_vma *) b;
+
+  return x < y ? -1 : x > y;
+}
+
+/* Fix up the line table of ABFD for a deletion in SEC.  The assembler
+   uses DW_LNS_fixed_advance_pc when relaxing, so the address deltas
+   can be patched in place.  A delta with an R_PROPELLER_DIFF16 reloc
+   is left for propeller_relax_diff.  */
+
+static bfd_boolean
+propeller_relax_line_info (bfd *abfd, asection *sec,
+			   Elf_Internal_Sym *isymbuf,
+			   const struct propeller_deletion *del)
+{
+  asection *lsec;
+  bfd_byte *contents, *p, *end;
+  Elf_Internal_Rela *irel, *irelend;
+  bfd_vma *diffs, offset;
+  size_t ndiffs;
+
+  lsec = bfd_get_section_by_name (abfd, ".debug_line");
+  if (lsec == NULL || lsec->size == 0 || (lsec->flags & SEC_RELOC) == 0)
+    return TRUE;
+
+  contents = elf_section_data (lsec)->this_hdr.contents;
+  if (contents == NULL)
+    {
+      if (!bfd_malloc_and_get_section (abfd, lsec, &contents))
+	return FALSE;
+      elf_section_data (lsec)->this_hdr.contents = contents;
+    }
+  irel = _bfd_elf_link_read_relocs (abfd, lsec, NULL, NULL, TRUE);
+  if (irel == NULL)
+    return FALSE;
+  irelend = irel + lsec->reloc_count;
+
+  diffs = bfd_malloc ((lsec->reloc_count + 1) * sizeof (*diffs));
+  if (diffs == NULL)
+    return FALSE;
+  ndiffs = 0;
+  for (; irel < irelend; irel++)
+    if (ELF32_R_TYPE (irel->r_info) == R_PROPELLER_DIFF16)
+      diffs[ndiffs++] = irel->r_offset;
+  qsort (diffs, ndiffs, sizeof (*diffs), propeller_compare_vma);
+
+  p = contents;
+  end = contents + lsec->size;
+  while (p + 10 <= end)
+    {
+      bfd_byte *unit_end, *hdr, *lengths;
+      unsigned int min_insn, line_range, opcode_base;
+      unsigned int len, n;
+      bfd_vma addr = 0;
+      bfd_boolean in_sec = FALSE;
+
+      /* only 32 bit DWARF is produced for the propeller */
+      unit_end = p + 4 + bfd_get_32 (abfd, p);
+      if (unit_end > end || unit_end < p + 10)
+	break;
+      hdr = p + 10;
+      if (bfd_get_16 (abfd, p + 4) >= 4)
+	hdr++;
+      min_insn = p[10];
+      line_range = hdr[3];
+      opcode_base = hdr[4];
+      lengths = hdr + 5;
+      p = p + 10 + bfd_get_32 (abfd, p + 6);
+      if (line_range == 0 || opcode_base == 0)
+	{
+	  p = unit_end;
+	  continue;
+	}
+
+      while (p < unit_end)
+	{
+	  unsigned int op = *p++;
+
+	  if (op >= opcode_base)
+	    {
+	      addr += ((op - opcode_base) / line_range) * min_insn;
+	      continue;
+	    }
+	  switch (op)
+	    {
+	    case 0:
+	      len = _bfd_safe_read_leb128 (abfd, p, &n, FALSE, unit_end);
+	      p += n;
+	      if (p < unit_end && *p == DW_LNE_set_address)
+		in_sec = propeller_line_address (abfd, isymbuf, lsec, sec,
+						 p + 1 - contents, &addr);
+	      else if (p < unit_end && *p == DW_LNE_end_sequence)
+		in_sec = FALSE;
+	      p += len;
+	      break;
+	    case DW_LNS_advance_pc:
+	      addr += _bfd_safe_read_leb128 (abfd, p, &n, FALSE, unit_end)
+		* min_insn;
+	      p += n;
+	      break;
+	    case DW_LNS_const_add_pc:
+	      addr += ((255 - opcode_base) / line_range) * min_insn;
+	      break;
+	    case DW_LNS_fixed_advance_pc:
+	      if (p + 2 > unit_end)
+		break;
+	      len = bfd_get_16 (abfd, p);
+	      offset = p - contents;
+	      if (in_sec
+		  && bsearch (&offset, diffs, ndiffs, sizeof (*diffs),
+			      propeller_compare_vma) == NULL)
+		bfd_put_16 (abfd, (propeller_relax_map (del, addr + len)
+				   - propeller_relax_map (del, addr)), p);
+	      addr += len;
+	      p += 2;
+	      break;
+	    default:
+	      for (len = lengths[op - 1]; len > 0 && p < unit_end; len--)
+		{
+		  (void) _bfd_safe_read_leb128 (abfd, p, &n, FALSE, unit_end);
+		  p += n;
+		}
+	      break;
+	    }
+	}
+      p = unit_end;
+    }
+
+  free (diffs);
+  return TRUE;
+}
+
+/* Adjust the symbol difference IREL in section O of ABFD for a
+   deletion in SEC.  The reloc is against the symbol subtracted, and
+   the field, which is read at its new offset, holds the difference;
+   both are still as they were before the deletion.  */
+
+static bfd_boolean
+propeller_relax_diff (bfd *abfd, asection *sec, Elf_Internal_Sym *isymbuf,
+		      asection *o, Elf_Internal_Rela *irel,
+		      const struct propeller_deletion *del)
+{
+  Elf_Internal_Shdr *symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
+  unsigned long r_symndx = ELF32_R_SYM (irel->r_info);
+  reloc_howto_type *howto;
+  bfd_byte *contents;
+  bfd_vma start, diff, sign;
+
+  if (r_symndx < symtab_hdr->sh_info)
+    {
+      Elf_Internal_Sym *isym = isymbuf + r_symndx;
+
+      if (bfd_section_from_elf_index (abfd, isym->st_shndx) != sec)
+	return TRUE;
+      start = isym->st_value;
+    }
+  else
+    {
+      struct elf_link_hash_entry *h;
+
+      h = elf_sym_hashes (abfd)[r_symndx - symtab_hdr->sh_info];
+      while (h->root.type == bfd_link_hash_indirect
+	     || h->root.type == bfd_link_hash_warning)
+	h = (struct elf_link_hash_entry *) h->root.u.i.link;
+      if ((h->root.type != bfd_link_hash_defined
+	   && h->root.type != bfd_link_hash_defweak)
+	  || h->root.u.def.section != sec)
+	return TRUE;
+      start = h->root.u.def.value;
+    }
+  start += irel->r_addend;
+
+  contents = elf_section_data (o)->this_hdr.contents;
+  if (contents == NULL)
+    {
+      if (!bfd_malloc_and_get_section (abfd, o, &contents))
+	return FALSE;
+      elf_section_data (o)->this_hdr.contents = contents;
+    }
+
+  howto = &propeller_elf_howto_table[ELF32_R_TYPE (irel->r_info)];
+  sign = (bfd_vma) 1 << (howto->bitsize - 1);
+  diff = bfd_get (howto->bitsize, abfd, contents + irel->r_offset);
+  diff = ((diff & (sign | (sign - 1))) ^ sign) - sign;
+  diff = (propeller_relax_map (del, start + diff)
+	  - propeller_relax_map (del, start));
+  bfd_put (howto->bitsize, abfd, diff, contents + irel->r_offset);
+  return TRUE;
+}
+
+/* Delete COUNT bytes at ADDR in SEC, keeping the code behind any
+   alignment markers aligned, and adjust everything that refers to
+   the moved code.  The section contents, relocs and local symbols
+   must already be cached.  */
+
+static bfd_boolean
+propeller_relax_delete_bytes (bfd *abfd, asection *sec, bfd_vma addr,
+			      unsigned int count)
+{
+  Elf_Internal_Shdr *symtab_hdr;
+  Elf_Internal_Sym *isymbuf, *isym, *isymend;
+  struct elf_link_hash_entry **sym_hashes;
+  struct elf_link_hash_entry **end_hashes;
+  struct propeller_deletion del;
+  unsigned int sec_shndx, i;
+  bfd_byte *contents;
+  asection *o;
+
+  if (!propeller_plan_deletion (sec, addr, count, &del))
+    return FALSE;
+
+  symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
+  isymbuf = (Elf_Internal_Sym *) symtab_hdr->contents;
+  sec_shndx = _bfd_elf_section_from_bfd_section (abfd, sec);
+  contents = elf_section_data (sec)->this_hdr.contents;
+
+  /* the line table is walked with the old offsets */
+  if (!propeller_relax_line_info (abfd, sec, isymbuf, &del))
+    {
+      free (del.shift);
+      return FALSE;
+    }
+
+  /* Move the code, and fill any new padding with nops.  */
+  for (i = 0; i < del.nshift; i++)
+    {
+      struct propeller_shift *s = &del.shift[i];
+
+      if (i > 0)
+	memset (contents + s->floor, PREFIX_MACRO | MACRO_NOP,
+		s->from - s->delta - s->floor);
+      if (s->delta != 0 && s->to > s->from)
+	memmove (contents + s->from - s->delta, contents + s->from,
+		 s->to - s->from);
+    }
+  sec->size -= del.shift[del.nshift - 1].delta;
+
+  /* Adjust the relocs: the offsets of those in this section, the
+     addends of those (in any section) against its section symbol,
+     and the symbol differences across the deleted bytes.  */
+  for (o = abfd->sections; o != NULL; o = o->next)
+    {
+      Elf_Internal_Rela *irel, *irelend;
+
+      if ((o->flags & SEC_RELOC) == 0 || o->reloc_count == 0)
+	continue;
+      if (o == sec)
+	irel = elf_section_data (o)->relocs;
+      else
+	irel = _bfd_elf_link_read_relocs (abfd, o, NULL, NULL, TRUE);
+      if (irel == NULL)
+	{
+	  free (del.shift);
+	  return FALSE;
+	}
+      irelend = irel + o->reloc_count;
+      for (; irel < irelend; irel++)
+	{
+	  unsigned long r_symndx = ELF32_R_SYM (irel->r_info);
+
+	  if (o == sec)
+	    irel->r_offset
+	      = (ELF32_R_TYPE (irel->r_info) == R_PROPELLER_ALIGN
+		 ? propeller_relax_map_align (&del, irel->r_offset)
+		 : propeller_relax_map (&del, irel->r_offset));
+	  switch (ELF32_R_TYPE (irel->r_info))
+	    {
+	    case R_PROPELLER_DIFF8:
+	    case R_PROPELLER_DIFF16:
+	    case R_PROPELLER_DIFF32:
+	      if (!propeller_relax_diff (abfd, sec, isymbuf, o, irel, &del))
+		{
+		  free (del.shift);
+		  return FALSE;
+		}
+	      break;
+	    default:
+	      break;
+	    }
+	  if (r_symndx == 0 || r_symndx >= symtab_hdr->sh_info)
+	    continue;
+	  isym = isymbuf + r_symndx;
+	  if (isym->st_shndx == sec_shndx
+	      && ELF_ST_TYPE (isym->st_info) == STT_SECTION)
+	    {
+	      reloc_howto_type *howto;
+	      bfd_vma bias = 0;
+
+	      /* pc relative addends are relative to the end of the
+		 field, not to the target */
+	      howto = &propeller_elf_howto_table[ELF32_R_TYPE (irel->r_info)];
+	      if (howto->pc_relative)
+		bias = bfd_get_reloc_size (howto);
+	      irel->r_addend = propeller_relax_map (&del,
+						    irel->r_addend + bias)
+		- bias;
+	    }
+	}
+    }
+
+  /* Adjust the local symbols defined in this section.  */
+  isymend = isymbuf + symtab_hdr->sh_info;
+  for (isym = isymbuf; isym < isymend; isym++)
+    if (isym->st_shndx == sec_shndx)
+      {
+	bfd_vma end = isym->st_value + isym->st_size;
+
+	isym->st_value = propeller_relax_map (&del, isym->st_value);
+	if (isym->st_size != 0)
+	  isym->st_size = propeller_relax_map (&del, end) - isym->st_value;
+      }
+
+  /* Now adjust the global symbols defined in this section.  */
+  sym_hashes = elf_sym_hashes (abfd);
+  end_hashes = sym_hashes + (symtab_hdr->sh_size / sizeof (Elf32_External_Sym)
+			     - symtab_hdr->sh_info);
+  for (; sym_hashes < end_hashes; sym_hashes++)
+    {
+      struct elf_link_hash_entry *h = *sym_hashes;
+
+      if ((h->root.type == bfd_link_hash_defined
+	   || h->root.type == bfd_link_hash_defweak)
+	  && h->root.u.def.section == sec)
+	{
+	  bfd_vma end = h->root.u.def.value + h->size;
+
+	  h->root.u.def.value = propeller_relax_map (&del,
+						     h->root.u.def.value);
+	  if (h->size != 0)
+	    h->size = propeller_relax_map (&del, end) - h->root.u.def.value;
+	}
+    }
+
+  free (del.shift);
+  return TRUE;
+}
+
+/* Return the most padding that alignment markers in [LO, HI) of a
+   section could still add.  */
+
+static bfd_vma
+propeller_align_slack (Elf_Internal_Rela *irel, Elf_Internal_Rela *irelend,
+		       bfd_vma lo, bfd_vma hi)
+{
+  bfd_vma slack = 0;
+
+  for (; irel < irelend; irel++)
+    if (ELF32_R_TYPE (irel->r_info) == R_PROPELLER_ALIGN
+	&& irel->r_offset >= lo && irel->r_offset < hi
+	&& irel->r_addend > 1)
+      slack += irel->r_addend - 1;
+  return slack;
+}
+
+/* Get the value of the symbol a reloc refers to, not counting the
+   addend; return FALSE if it is not known yet.  */
+
+static bfd_boolean
+propeller_relax_symbol (bfd *abfd, Elf_Internal_Sym *isymbuf,
+			Elf_Internal_Rela *irel, bfd_vma *valp,
+			asection **secp)
+{
+  Elf_Internal_Shdr *symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
+  unsigned long r_symndx = ELF32_R_SYM (irel->r_info);
+  asection *sym_sec;
+  bfd_vma value;
+
+  if (r_symndx < symtab_hdr->sh_info)
+    {
+      Elf_Internal_Sym *isym = isymbuf + r_symndx;
+
+      if (isym->st_shndx == SHN_UNDEF)
+	return FALSE;
+      sym_sec = bfd_section_from_elf_index (abfd, isym->st_shndx);
+      value = isym->st_value;
+    }
+  else
+    {
+      struct elf_link_hash_entry *h;
+
+      h = elf_sym_hashes (abfd)[r_symndx - symtab_hdr->sh_info];
+      while (h->root.type == bfd_link_hash_indirect
+	     || h->root.type == bfd_link_hash_warning)
+	h = (struct elf_link_hash_entry *) h->root.u.i.link;
+      if (h->root.type != bfd_link_hash_defined
+	  && h->root.type != bfd_link_hash_defweak)
+	return FALSE;
+      sym_sec = h->root.u.def.section;
+      value = h->root.u.def.value;
+    }
+
+  if (sym_sec == NULL || sym_sec->output_section == NULL
+      || discarded_section (sym_sec))
+    return FALSE;
+
+  *valp = value + sym_sec->output_section->vma + sym_sec->output_offset;
+  *secp = sym_sec;
+  return TRUE;
+}
+
+/* The reloc for the operand of an instruction follows the opcode
+   byte; usually it is the next reloc after the marker.  */
+
+static Elf_Internal_Rela *
+propeller_operand_reloc (Elf_Internal_Rela *irel, Elf_Internal_Rela *irelend,
+			 Elf_Internal_Rela *relocs)
+{
+  bfd_vma offset = irel->r_offset + 1;
+
+  if (irel + 1 < irelend && irel[1].r_offset == offset)
+    return irel + 1;
+  for (irel = relocs; irel < irelend; irel++)
+    if (irel->r_offset == offset
+	&& ELF32_R_TYPE (irel->r_info) != R_PROPELLER_RELAX
+	&& ELF32_R_TYPE (irel->r_info) != R_PROPELLER_ALIGN)
+      return irel;
+  return NULL;
+}
+
+/* The reloc of an operand at OFFSET, ignoring the relaxation markers.  */
+
+static Elf_Internal_Rela *
+propeller_reloc_at (Elf_Internal_Rela *relocs, Elf_Internal_Rela *relend,
+		    bfd_vma offset)
+{
+  Elf_Internal_Rela *irel;
+
+  for (irel = relocs; irel < relend; irel++)
+    if (irel->r_offset == offset
+	&& ELF32_R_TYPE (irel->r_info) != R_PROPELLER_NONE
+	&& ELF32_R_TYPE (irel->r_info) != R_PROPELLER_RELAX
+	&& ELF32_R_TYPE (irel->r_info) != R_PROPELLER_ALIGN)
+      return irel;
+  return NULL;
+}
+
+/* Name of the symbol of reloc IREL.  */
+
+static const char *
+propeller_reloc_sym_name (bfd *abfd, Elf_Internal_Sym *isymbuf,
+			  Elf_Internal_Rela *irel)
+{
+  Elf_Internal_Shdr *symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
+  unsigned long r_symndx = ELF32_R_SYM (irel->r_info);
+
+  if (r_symndx < symtab_hdr->sh_info)
+    return bfd_elf_string_from_elf_section (abfd, symtab_hdr->sh_link,
+					    isymbuf[r_symndx].st_name);
+  return elf_sym_hashes (abfd)[r_symndx - symtab_hdr->sh_info]
+    ->root.root.string;
+}
+
+/* LMM literals.
+
+   An LMM mvi or ldi is a native instruction followed by a 32 bit
+   literal:
+	mvi rN,#K  is  jmp #__LMM_MVI_rN ; long K
+	ldi rN,#K  is  rdlong rN,pc ; long K
+   With --relax the assembler marks each one with an R_PROPELLER_RELAX
+   reloc whose addend is the offset of the literal.  If K is a
+   constant, the pair becomes a single instruction:
+	mov rN,#K        if K < 512
+	neg rN,#-K       if -K < 512
+	rdlong rN,#slot  if K is in the literal pool
+   The literal pool holds the constants that the code loads most often;
+   it is built before relaxation, and must be in the first 512 bytes of
+   hub memory so that a slot fits the source field of rdlong.  Addresses
+   are left alone, as they move while the code shrinks.  */
+
+#define LMM_LITERAL_OFFSET	4
+#define LMM_PC_REG		17
+#define LMM_LR_REG		15
+#define LMM_IMM_LIMIT		0x200
+#define LMM_INSN_MOV_IMM	0xa0c00000	/* mov d,#s */
+#define LMM_INSN_NEG_IMM	0xa4c00000	/* neg d,#s */
+#define LMM_INSN_RDLONG_IMM	0x08c00000	/* rdlong d,#s */
+#define LMM_INSN_COND		0x003c0000
+
+struct lmm_pool_entry
+{
+  bfd_vma value;
+  unsigned int count;		/* loads of the value */
+  unsigned int slot;
+};
+
+static asection *lmm_pool_sec;
+static struct lmm_pool_entry *lmm_pool;
+static unsigned int lmm_pool_count;
+
+static int
+lmm_pool_value_compare (const void *a, const void *b)
+{
+  const struct lmm_pool_entry *pa = (const struct lmm_pool_entry *) a;
+  const struct lmm_pool_entry *pb = (const struct lmm_pool_entry *) b;
+
+  if (pa->value != pb->value)
+    return pa->value < pb->value ? -1 : 1;
+  return 0;
+}
+
+static int
+lmm_pool_count_compare (const void *a, const void *b)
+{
+  const struct lmm_pool_entry *pa = (const struct lmm_pool_entry *) a;
+  const struct lmm_pool_entry *pb = (const struct lmm_pool_entry *) b;
+
+  if (pa->count != pb->count)
+    return pa->count > pb->count ? -1 : 1;
+  return lmm_pool_value_compare (a, b);
+}
+
+/* Can constant VALUE be loaded with a mov or neg immediate?  */
+
+static bfd_boolean
+lmm_literal_fits_imm (bfd_vma value)
+{
+  value &= 0xffffffff;
+  return value < LMM_IMM_LIMIT || ((-value) & 0xffffffff) < LMM_IMM_LIMIT;
+}
+
+/* Decode the LMM mvi or ldi marked by IREL in SEC.  On success, set
+   *INSNP to its condition and destination register, *VALUEP to the
+   constant it loads, *SRELP to the reloc of its source field and *LRELP
+   to the reloc of the literal; either reloc may be NULL.  */
+
+static bfd_boolean
+propeller_lmm_literal (bfd *abfd, asection *sec, bfd_byte *contents,
+		       Elf_Internal_Sym *isymbuf, Elf_Internal_Rela *relocs,
+		       Elf_Internal_Rela *relend, Elf_Internal_Rela *irel,
+		       unsigned long *insnp, bfd_vma *valuep,
+		       Elf_Internal_Rela **srelp, Elf_Internal_Rela **lrelp)
+{
+  bfd_vma off = irel->r_offset;
+  Elf_Internal_Rela *srel = NULL, *lrel, *r;
+  const char *name = NULL;
+  unsigned long code, dest;
+  unsigned int reg;
+  char *end;
+
+  if (irel->r_addend != LMM_LITERAL_OFFSET
+      || off + LMM_LITERAL_OFFSET + 4 > sec->size)
+    return FALSE;
+
+  /* the flags are not set the same way by the short forms */
+  code = bfd_get_32 (abfd, contents + off);
+  if ((code & 0x03000000) != 0)
+    return FALSE;
+
+  /* registers are usually symbols defined by the kernel */
+  for (r = relocs; r < relend; r++)
+    if (r->r_offset == off)
+      switch (ELF32_R_TYPE (r->r_info))
+	{
+	case R_PROPELLER_SRC:
+	case R_PROPELLER_SRC_IMM:
+	  srel = r;
+	  name = propeller_reloc_sym_name (abfd, isymbuf, r);
+	  break;
+	case R_PROPELLER_DST:
+	case R_PROPELLER_NONE:
+	case R_PROPELLER_RELAX:
+	case R_PROPELLER_ALIGN:
+	  break;
+	default:
+	  return FALSE;
+	}
+
+  if ((code >> 26) == 0x02 && (code & (1 << 22)) == 0)
+    {
+      /* ldi: rdlong rN,pc */
+      if (srel != NULL
+	  ? name == NULL || strcmp (name, "pc") != 0
+	  : (code & 0x1ff) != LMM_PC_REG)
+	return FALSE;
+      dest = code & (0x1ff << 9);
+    }
+  else if ((code >> 26) == 0x17 && (code & (1 << 22)) != 0
+	   && (code & (1 << 23)) == 0)
+    {
+      /* mvi: jmp #__LMM_MVI_rN */
+      if (name == NULL || strncmp (name, "__LMM_MVI_", 10) != 0)
+	return FALSE;
+      name += 10;
+      if (strcmp (name, "lr") == 0)
+	reg = LMM_LR_REG;
+      else if (name[0] == 'r' && ISDIGIT (name[1]))
+	{
+	  reg = strtoul (name + 1, &end, 10);
+	  if (*end != '\0' || reg >= LMM_LR_REG)
+	    return FALSE;
+	}
+      else
+	return FALSE;
+      dest = reg << 9;
+    }
+  else
+    return FALSE;
+
+  lrel = propeller_reloc_at (relocs, relend, off + LMM_LITERAL_OFFSET);
+  if (lrel == NULL)
+    *valuep = bfd_get_32 (abfd, contents + off + LMM_LITERAL_OFFSET);
+  else
+    {
+      asection *sym_sec;
+
+      if ((ELF32_R_TYPE (lrel->r_info) != R_PROPELLER_32
+	   && ELF32_R_TYPE (lrel->r_info) != R_PROPELLER_23)
+	  || !propeller_relax_symbol (abfd, isymbuf, lrel, valuep, &sym_sec)
+	  || !bfd_is_abs_section (sym_sec))
+	return FALSE;
+      *valuep += lrel->r_addend;
+    }
+  *valuep &= 0xffffffff;
+  *insnp = (code & LMM_INSN_COND) | dest;
+  *srelp = srel;
+  *lrelp = lrel;
+  return TRUE;
+}
+
+/* Build the literal pool: of the constants loaded by the LMM code in
+   INFO's input files which need a long, take those loaded at least
+   twice, most often first, up to MAX_SLOTS.  Returns the section
+   holding the pool, for the linker to place, or NULL if there is
+   nothing worth pooling.  */
+
+asection *bfd_elf32_propeller_literal_pool (struct bfd_link_info *,
+					    unsigned int);
+
+asection *
+bfd_elf32_propeller_literal_pool (struct bfd_link_info *info,
+				  unsigned int max_slots)
+{
+  struct lmm_pool_entry *values = NULL;
+  unsigned int nvalues = 0, maxvalues = 0, i, j;
+  bfd *abfd, *owner = NULL;
+  asection *sec;
+  bfd_byte *contents;
+
+  for (abfd = info->input_bfds; abfd != NULL; abfd = abfd->link.next)
+    {
+      Elf_Internal_Shdr *symtab_hdr;
+      Elf_Internal_Sym *isymbuf = NULL;
+
+      if (bfd_get_flavour (abfd) != bfd_target_elf_flavour
+	  || elf_elfheader (abfd)->e_machine != EM_PROPELLER)
+	continue;
+      if (owner == NULL)
+	owner = abfd;
+      if ((elf_elfheader (abfd)->e_flags & EF_PROPELLER_PROP2) != 0)
+	continue;
+      symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
+
+      for (sec = abfd->sections; sec != NULL; sec = sec->next)
+	{
+	  Elf_Internal_Rela *relocs, *relend, *irel;
+
+	  if ((sec->flags & SEC_CODE) == 0 || (sec->flags & SEC_RELOC) == 0
+	      || sec->reloc_count == 0 || sec->size == 0
+	      || sec->output_section == NULL || discarded_section (sec))
+	    continue;
+	  relocs = _bfd_elf_link_read_relocs (abfd, sec, NULL, NULL,
+					      info->keep_memory);
+	  if (relocs == NULL)
+	    continue;
+	  relend = relocs + sec->reloc_count;
+	  contents = NULL;
+
+	  for (irel = relocs; irel < relend; irel++)
+	    {
+	      Elf_Internal_Rela *srel, *lrel;
+	      unsigned long insn;
+	      bfd_vma value;
+
+	      if (ELF32_R_TYPE (irel->r_info) != R_PROPELLER_RELAX
+		  || irel->r_addend != LMM_LITERAL_OFFSET)
+		continue;
+	      if (contents == NULL)
+		{
+		  contents = elf_section_data (sec)->this_hdr.contents;
+		  if (contents == NULL
+		      && !bfd_malloc_and_get_section (abfd, sec, &contents))
+		    break;
+		}
+	      if (isymbuf == NULL && symtab_hdr->sh_info != 0)
+		{
+		  isymbuf = (Elf_Internal_Sym *) symtab_hdr->contents;
+		  if (isymbuf == NULL)
+		    isymbuf = bfd_elf_get_elf_syms (abfd, symtab_hdr,
+						    symtab_hdr->sh_info, 0,
+						    NULL, NULL, NULL);
+		  if (isymbuf == NULL)
+		    break;
+		}
+	      if (!propeller_lmm_literal (abfd, sec, contents, isymbuf,
+					  relocs, relend, irel, &insn,
+					  &value, &srel, &lrel)
+		  || lmm_literal_fits_imm (value))
+		continue;
+
+	      if (nvalues == maxvalues)
+		{
+		  maxvalues = maxvalues * 2 + 64;
+		  values = (struct lmm_pool_entry *)
+		    bfd_realloc_or_free (values, maxvalues * sizeof (*values));
+		  if (values == NULL)
+		    return NULL;
+		}
+	      values[nvalues].value = value;
+	      values[nvalues].count = 1;
+	      nvalues++;
+	    }
+
+	  if (contents != NULL
+	      && contents != elf_section_data (sec)->this_hdr.contents)
+	    free (contents);
+	  if (elf_section_data (sec)->relocs != relocs)
+	    free (relocs);
+	}
+
+      if (isymbuf != NULL
+	  && symtab_hdr->contents != (unsigned char *) isymbuf)
+	free (isymbuf);
+    }
+
+  /* Count the loads of each value, and keep the ones worth a slot: a
+     slot costs a long, and each load from it saves one.  */
+  if (values != NULL)
+    qsort (values, nvalues, sizeof (*values), lmm_pool_value_compare);
+  for (i = j = 0; i < nvalues; i++)
+    if (j > 0 && values[j - 1].value == values[i].value)
+      values[j - 1].count++;
+    else
+      values[j++] = values[i];
+  nvalues = j;
+  if (values != NULL)
+    qsort (values, nvalues, sizeof (*values), lmm_pool_count_compare);
+  for (i = 0; i < nvalues && i < max_slots && values[i].count > 1; i++)
+    values[i].slot = i;
+  nvalues = i;
+  if (nvalues == 0 || owner == NULL)
+    {
+      free (values);
+      return NULL;
+    }
+
+  sec = bfd_make_section_anyway_with_flags (owner, ".lpool",
+					    SEC_ALLOC | SEC_LOAD
+					    | SEC_HAS_CONTENTS | SEC_IN_MEMORY
+					    | SEC_READONLY | SEC_DATA
+					    | SEC_KEEP);
+  contents = (bfd_byte *) bfd_zalloc (owner, nvalues * 4);
+  if (sec == NULL || contents == NULL
+      || !bfd_set_section_alignment (owner, sec, 2))
+    {
+      free (values);
+      return NULL;
+    }
+  for (i = 0; i < nvalues; i++)
+    bfd_put_32 (owner, values[i].value, contents + 4 * values[i].slot);
+  sec->size = nvalues * 4;
+  sec->contents = contents;
+  elf_section_data (sec)->this_hdr.contents = contents;
+
+  qsort (values, nvalues, sizeof (*values), lmm_pool_value_compare);
+  lmm_pool = values;
+  lmm_pool_count = nvalues;
+  lmm_pool_sec = sec;
+  return sec;
+}
+
+/* Shorten the LMM mvi or ldi marked by IREL in SEC, if its literal is
+   a suitable constant.  Returns the number of bytes deleted.  */
+
+static unsigned int
+propeller_relax_lmm_literal (bfd *abfd, asection *sec, bfd_byte *contents,
+			     Elf_Internal_Sym *isymbuf,
+			     Elf_Internal_Rela *relocs,
+			     Elf_Internal_Rela *relend,
+			     Elf_Internal_Rela *irel)
+{
+  Elf_Internal_Rela *srel, *lrel;
+  struct lmm_pool_entry key, *entry;
+  unsigned long insn;
+  bfd_vma value, slot;
+
+  if (!propeller_lmm_literal (abfd, sec, contents, isymbuf, relocs, relend,
+			      irel, &insn, &value, &srel, &lrel))
+    return 0;
+
+  if (value < LMM_IMM_LIMIT)
+    insn |= LMM_INSN_MOV_IMM | value;
+  else if (((-value) & 0xffffffff) < LMM_IMM_LIMIT)
+    insn |= LMM_INSN_NEG_IMM | ((-value) & 0xffffffff);
+  else
+    {
+      if (lmm_pool_sec == NULL || lmm_pool_sec->output_section == NULL)
+	return 0;
+      key.value = value;
+      entry = (struct lmm_pool_entry *) bsearch (&key, lmm_pool,
+						 lmm_pool_count,
+						 sizeof (*lmm_pool),
+						 lmm_pool_value_compare);
+      if (entry == NULL)
+	return 0;
+      slot = (lmm_pool_sec->output_section->vma + lmm_pool_sec->output_offset
+	      + 4 * entry->slot);
+      if (slot + 4 > LMM_IMM_LIMIT)
+	return 0;
+      insn |= LMM_INSN_RDLONG_IMM | slot;
+    }
+
+  /* A register symbol in the destination field still applies; the
+     source and the literal are done with.  */
+  bfd_put_32 (abfd, insn, contents + irel->r_offset);
+  if (srel != NULL)
+    srel->r_info = ELF32_R_INFO (0, R_PROPELLER_NONE);
+  if (lrel != NULL)
+    lrel->r_info = ELF32_R_INFO (0, R_PROPELLER_NONE);
+  irel->r_info = ELF32_R_INFO (0, R_PROPELLER_NONE);
+
+  return 4;
+}
+
+static bfd_boolean
+propeller_elf_relax_section (bfd *abfd, asection *sec,
+			     struct bfd_link_info *link_info,
+			     bfd_boolean *again)
+{
+  Elf_Internal_Shdr *symtab_hdr;
+  Elf_Internal_Rela *internal_relocs;
+  Elf_Internal_Rela *irel, *irelend;
+  bfd_byte *contents = NULL;
+  Elf_Internal_Sym *isymbuf = NULL;
+
+  /* Assume nothing changes.  */
+  *again = FALSE;
+
+  /* Only code from objects assembled with --relax has anything for
+     us to do.  */
+  if (bfd_link_relocatable (link_info)
+      || (sec->flags & SEC_RELOC) == 0
+      || sec->reloc_count == 0
+      || (sec->flags & SEC_CODE) == 0)
+    return TRUE;
+
+  symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
+
+  internal_relocs = (_bfd_elf_link_read_relocs
+		     (abfd, sec, NULL, (Elf_Internal_Rela *) NULL,
+		      link_info->keep_memory));
+  if (internal_relocs == NULL)
+    goto error_return;
+
+  irelend = internal_relocs + sec->reloc_count;
+  for (irel = internal_relocs; irel < irelend; irel++)
+    {
+      Elf_Internal_Rela *iop;
+      asection *sym_sec;
+      bfd_vma symval, pc, target, slack;
+      bfd_signed_vma disp;
+      unsigned int op, newop, cond, oldlen, newlen, newtype;
+      reloc_howto_type *howto;
+      bfd_boolean branch, lmm;
+
+      if (ELF32_R_TYPE (irel->r_info) != R_PROPELLER_RELAX)
+	continue;
+
+      lmm = irel->r_addend == LMM_LITERAL_OFFSET;
+      iop = NULL;
+      if (!lmm)
+	{
+	  iop = propeller_operand_reloc (irel, irelend, internal_relocs);
+	  if (iop == NULL)
+	    continue;
+	}
+
+      /* Get the section contents if we haven't done so already.  */
+      if (contents == NULL)
+	{
+	  /* Get cached copy if it exists.  */
+	  if (elf_section_data (sec)->this_hdr.contents != NULL)
+	    contents = elf_section_data (sec)->this_hdr.contents;
+	  else
+	    {
+	      /* Go get them off disk.  */
+	      if (!bfd_malloc_and_get_section (abfd, sec, &contents))
+		goto error_return;
+	    }
+	}
+
+      /* Read this BFD's local symbols if we haven't done so already.  */
+      if (isymbuf == NULL && symtab_hdr->sh_info != 0)
+	{
+	  isymbuf = (Elf_Internal_Sym *) symtab_hdr->contents;
+	  if (isymbuf == NULL)
+	    isymbuf = bfd_elf_get_elf_syms (abfd, symtab_hdr,
+					    symtab_hdr->sh_info, 0,
+					    NULL, NULL, NULL);
+	  if (isymbuf == NULL)
+	    goto error_return;
+	}
+
+      if (lmm)
+	{
+	  unsigned int count;
+
+	  count = propeller_relax_lmm_literal (abfd, sec, contents, isymbuf,
+					       internal_relocs, irelend, irel);
+	  if (count == 0)
+	    continue;
+	  elf_section_data (sec)->relocs = internal_relocs;
+	  elf_section_data (sec)->this_hdr.contents = contents;
+	  symtab_hdr->contents = (unsigned char *) isymbuf;
+	  if (!propeller_relax_delete_bytes (abfd, sec,
+					     irel->r_offset + LMM_LITERAL_OFFSET,
+					     count))
+	    goto error_return;
+	  *again = TRUE;
+	  continue;
+	}
+
+      if (!propeller_relax_symbol (abfd, isymbuf, iop, &symval, &sym_sec))
+	continue;
+
+      howto = &propeller_elf_howto_table[ELF32_R_TYPE (iop->r_info)];
+      target = symval + iop->r_addend;
+      if (howto->pc_relative)
+	target += bfd_get_reloc_size (howto);
+      pc = (sec->output_section->vma + sec->output_offset + irel->r_offset);
+
+      op = bfd_get_8 (abfd, contents + irel->r_offset);
+      newop = op;
+      oldlen = newlen = 0;
+      newtype = R_PROPELLER_NONE;
+      branch = FALSE;
+      switch (ELF32_R_TYPE (iop->r_info))
+	{
+	case R_PROPELLER_32:
+	  if (op == (PREFIX_MACRO | MACRO_LJMP))
+	    {
+	      oldlen = 5;
+	      branch = TRUE;
+	    }
+	  else if ((op & 0xf0) == PREFIX_MVI)
+	    {
+	      oldlen = 5;
+	      if (target < 0x100)
+		{
+		  newop = PREFIX_MVIB | (op & 0xf);
+		  newtype = R_PROPELLER_8;
+		  newlen = 2;
+		}
+	      else if (target < 0x10000)
+		{
+		  newop = PREFIX_MVIW | (op & 0xf);
+		  newtype = R_PROPELLER_16;
+		  newlen = 3;
+		}
+	    }
+	  break;
+	case R_PROPELLER_PCREL16:
+	  if ((op & 0xf0) == PREFIX_BRW)
+	    {
+	      oldlen = 3;
+	      branch = TRUE;
+	    }
+	  break;
+	case R_PROPELLER_16:
+	  if ((op & 0xf0) == PREFIX_MVIW && target < 0x100)
+	    {
+	      oldlen = 3;
+	      newop = PREFIX_MVIB | (op & 0xf);
+	      newtype = R_PROPELLER_8;
+	      newlen = 2;
+	    }
+	  break;
+	default:
+	  break;
+	}
+
+      /* A branch may become brs or brw if the target is close enough.
+	 It must be in the same output section, so that the distance
+	 can only shrink, and we allow for padding that alignment may
+	 still add in between.  */
+      if (branch)
+	{
+	  bfd_vma sec_start = sec->output_section->vma + sec->output_offset;
+
+	  if (sym_sec->output_section != sec->output_section)
+	    continue;
+	  if (sym_sec == sec)
+	    slack = (target > pc
+		     ? propeller_align_slack (internal_relocs, irelend,
+					      irel->r_offset,
+					      target - sec_start)
+		     : propeller_align_slack (internal_relocs, irelend,
+					      target - sec_start,
+					      irel->r_offset));
+	  else
+	    slack = (((bfd_vma) 1 << sec->output_section->alignment_power)
+		     + (target > pc
+			? propeller_align_slack (internal_relocs, irelend,
+						 irel->r_offset, sec->size)
+			: propeller_align_slack (internal_relocs, irelend,
+						 0, irel->r_offset)));
+
+	  /* ljmp is always unconditional */
+	  cond = oldlen > 3 ? 0xf : (op & 0xf);
+	  disp = target - (pc + 2);
+	  if (disp + (bfd_signed_vma) slack <= 0x7f
+	      && disp - (bfd_signed_vma) slack >= -0x80)
+	    {
+	      newop = PREFIX_BRS | cond;
+	      newtype = R_PROPELLER_PCREL8;
+	      newlen = 2;
+	    }
+	  else if (oldlen > 3)
+	    {
+	      disp = target - (pc + 3);
+	      if (disp + (bfd_signed_vma) slack <= 0x7fff
+		  && disp - (bfd_signed_vma) slack >= -0x8000)
+		{
+		  newop = PREFIX_BRW | cond;
+		  newtype = R_PROPELLER_PCREL16;
+		  newlen = 3;
+		}
+	    }
+	}
+
+      if (newlen == 0)
+	continue;
+
+      /* Note that we've changed the relocs, section contents, etc.  */
+      elf_section_data (sec)->relocs = internal_relocs;
+      elf_section_data (sec)->this_hdr.contents = contents;
+      symtab_hdr->contents = (unsigned char *) isymbuf;
+
+      /* Rewrite the instruction; a pc relative operand is relative to
+	 the end of its field.  */
+      bfd_put_8 (abfd, newop, contents + irel->r_offset);
+      howto = &propeller_elf_howto_table[newtype];
+      iop->r_info = ELF32_R_INFO (ELF32_R_SYM (iop->r_info), newtype);
+      iop->r_addend = target - symval;
+      if (howto->pc_relative)
+	iop->r_addend -= bfd_get_reloc_size (howto);
+
+      if (!propeller_relax_delete_bytes (abfd, sec, irel->r_offset + newlen,
+					 oldlen - newlen))
+	goto error_return;
+
+      /* the shorter form may allow more relaxation */
+      *again = TRUE;
+    }
+
+  if (isymbuf != NULL
+      && symtab_hdr->contents != (unsigned char *) isymbuf)
+    {
+      if (! link_info->keep_memory)
+	free (isymbuf);
+      else
+	symtab_hdr->contents = (unsigned char *) isymbuf;
+    }
+
+  if (contents != NULL
+      && elf_section_data (sec)->this_hdr.contents != contents)
+    {
+      if (! link_info->keep_memory)
+	free (contents);
+      else
+	{
+	  /* Cache the section contents for elf_link_input_bfd.  */
+	  elf_section_data (sec)->this_hdr.contents = contents;
+	}
+    }
+
+  if (internal_relocs != NULL
+      && elf_section_data (sec)->relocs != internal_relocs)
+    free (internal_relocs);
+
+  return TRUE;
+
+ error_return:
+  if (isymbuf != NULL
+      && symtab_hdr->contents != (unsigned char *) isymbuf)
+    free (isymbuf);
+  if (contents != NULL
+      && elf_section_data (sec)->this_hdr.contents != contents)
+    free (contents);
+  if (internal_relocs != NULL
+      && elf_section_data (sec)->relocs != internal_relocs)
+    free (internal_relocs);
+  return FALSE;
+}
+
+static void
+propeller_elf_gc_keep (struct bfd_link_info *info)
+{
+  struct bfd_sym_chain *sym;
+
+  /* Cog overlays are kept only if their __load_start_xxx or
+     __load_stop_xxx symbol is referenced (see the mark hook); here
+     we just keep those named by symbols undefined on the command
+     line.  */
+  for (sym = info->gc_sym_list; sym != NULL; sym = sym->next)
+    {
+      const char *suffix = propeller_overlay_symbol_suffix (sym->name);
+      asection *overlay;
+
+      if (suffix == NULL)
+	continue;
+      overlay = propeller_overlay_sections (info, suffix,
+					    propeller_gc_keep_overlay);
+      if (overlay != NULL)
+	overlay->flags |= SEC_KEEP;
+    }
+
+  /* do the usual marking of sections containing entry symbol and
+     symbols undefined on the command-line
+  */
+  _bfd_elf_gc_keep (info);
+}
+
+/* fcache candidates.
+
+   Hot loops and small leaf functions of LMM and CMM code run much
+   faster when they are loaded into the fcache buffer of the kernel and
+   executed as native code.  Given a profile, find the code that would
+   fit into the buffer and estimate the cycles that caching it would
+   save.  The cycle counts model the kernel only roughly.  */
+
+#define FCACHE_LMM_CYCLES	 16	/* fetch and execute an LMM instruction */
+#define FCACHE_LMM_HUB_CYCLES	 32	/* the same for a hub instruction */
+#define FCACHE_CMM_BYTE_CYCLES	 16	/* fetch one byte of CMM code */
+#define FCACHE_CMM_DECODE_CYCLES 36	/* dispatch and decode a CMM form */
+#define FCACHE_HELPER_CYCLES	 40	/* call a kernel routine */
+#define FCACHE_NATIVE_CYCLES	 4
+#define FCACHE_NATIVE_HUB_CYCLES 16
+#define FCACHE_LOAD_CYCLES(longs) (32 + 16 * (longs))
+
+struct fcache_insn
+{
+  bfd_vma off;
+  unsigned int len;
+  unsigned int native_len;	/* bytes as native code */
+  unsigned int interp;		/* cycles when interpreted by the kernel */
+  unsigned int native;		/* cycles when run from the cache */
+  bfd_boolean call;		/* the code can not be cached */
+  bfd_boolean branch;
+  bfd_vma target;		/* section offset of the branch target */
+  bfd_boolean has_target;
+  bfd_uint64_t count;		/* executions according to the profile */
+};
+
+struct fcache_sym
+{
+  bfd_vma value;
+  const char *name;
+  unsigned char other;
+  bfd_boolean func;
+};
+
+static int
+fcache_sym_compare (const void *a, const void *b)
+{
+  const struct fcache_sym *sa = (const struct fcache_sym *) a;
+  const struct fcache_sym *sb = (const struct fcache_sym *) b;
+
+  if (sa->value != sb->value)
+    return sa->value < sb->value ? -1 : 1;
+  return sb->func - sa->func;
+}
+
+/* Set the target of INSN from reloc IREL, if it is in SEC.  */
+
+static void
+fcache_reloc_target (bfd *abfd, asection *sec, Elf_Internal_Sym *isymbuf,
+		     Elf_Internal_Rela *irel, struct fcache_insn *insn)
+{
+  reloc_howto_type *howto;
+  asection *sym_sec;
+  bfd_vma target;
+
+  if (!propeller_relax_symbol (abfd, isymbuf, irel, &target, &sym_sec)
+      || sym_sec != sec)
+    return;
+  howto = &propeller_elf_howto_table[ELF32_R_TYPE (irel->r_info)];
+  target += irel->r_addend;
+  if (howto->pc_relative)
+    target += bfd_get_reloc_size (howto);
+  target -= sec->output_section->vma + sec->output_offset;
+  if (target < sec->size)
+    {
+      insn->target = target;
+      insn->has_target = TRUE;
+    }
+}
+
+/* Does the LMM instruction CODE at OFF write the pc?  In input files
+   the pc is usually a reloc against the kernel's label.  */
+
+static bfd_boolean
+fcache_writes_pc (bfd *abfd, Elf_Internal_Sym *isymbuf,
+		  Elf_Internal_Rela *relocs, Elf_Internal_Rela *relend,
+		  bfd_vma off, unsigned long code)
+{
+  Elf_Internal_Rela *irel;
+  const char *name;
+
+  for (irel = relocs; irel < relend; irel++)
+    if (irel->r_offset == off
+	&& ELF32_R_TYPE (irel->r_info) == R_PROPELLER_DST)
+      {
+	name = propeller_reloc_sym_name (abfd, isymbuf, irel);
+	return name != NULL && strcmp (name, "pc") == 0;
+      }
+  return ((code >> 9) & 0x1ff) == LMM_PC_REG;
+}
+
+/* Decode the LMM or CMM instruction at OFF into INSN.  */
+
+static void
+fcache_decode (bfd *abfd, asection *sec, bfd_byte *contents,
+	       Elf_Internal_Rela *relocs, Elf_Internal_Rela *relend,
+	       Elf_Internal_Sym *isymbuf, bfd_vma off, bfd_boolean cmm,
+	       struct fcache_insn *insn)
+{
+  bfd_size_type left = sec->size - off;
+  Elf_Internal_Rela *irel;
+  unsigned int op, len;
+
+  memset (insn, 0, sizeof (*insn));
+  insn->off = off;
+  insn->native = FCACHE_NATIVE_CYCLES;
+  insn->native_len = 4;
+
+  if (!cmm)
+    {
+      unsigned long code;
+      const char *name = NULL;
+
+      insn->len = left < 4 ? left : 4;
+      insn->interp = FCACHE_LMM_CYCLES;
+      if (left < 4)
+	return;
+      code = bfd_get_32 (abfd, contents + off);
+      op = code >> 26;
+      if (op <= 3)
+	{
+	  insn->interp = FCACHE_LMM_HUB_CYCLES;
+	  insn->native = FCACHE_NATIVE_HUB_CYCLES;
+	}
+      else if (op == 0x17 && (code & (1 << 22)) && !(code & (1 << 23)))
+	{
+	  /* jmp #routine: a kernel routine, maybe with a long operand */
+	  irel = propeller_reloc_at (relocs, relend, off);
+	  if (irel != NULL)
+	    name = propeller_reloc_sym_name (abfd, isymbuf, irel);
+	  if (name == NULL)
+	    insn->call = TRUE;
+	  else if (strcmp (name, "__LMM_JMP") == 0)
+	    {
+	      insn->len = 8;
+	      insn->branch = TRUE;
+	      irel = propeller_reloc_at (relocs, relend, off + 4);
+	      if (irel != NULL)
+		fcache_reloc_target (abfd, sec, isymbuf, irel, insn);
+	    }
+	  else if (strncmp (name, "__LMM_MVI_", 10) == 0)
+	    {
+	      /* becomes a mov from a long in the cache */
+	      insn->len = 8;
+	      insn->native_len = 8;
+	    }
+	  else if (strcmp (name, "__LMM_FCACHE_LOAD") == 0)
+	    {
+	      bfd_vma count = left >= 8 ? bfd_get_32 (abfd, contents + off + 4)
+				  : 0;
+
+	      insn->len = 8 + ((count + 3) & ~3);
+	      if (insn->len > left)
+		insn->len = left;
+	      insn->call = TRUE;
+	    }
+	  else if (strcmp (name, "__LMM_RET") == 0
+		   || strcmp (name, "__LMM_POPRET") == 0)
+	    insn->branch = TRUE;
+	  else
+	    insn->call = strcmp (name, "__LMM_PUSHM") != 0
+	      && strcmp (name, "__LMM_POPM") != 0;
+	  if (insn->len > 4 || insn->branch || !insn->call)
+	    insn->interp = FCACHE_HELPER_CYCLES;
+	}
+      else if ((code & (1 << 23)) && fcache_writes_pc (abfd, isymbuf, relocs,
+							relend, off, code))
+	{
+	  /* writes to the pc: brs is add or sub pc,#n */
+	  insn->branch = TRUE;
+	  for (irel = relocs; irel < relend; irel++)
+	    if (irel->r_offset == off
+		&& ELF32_R_TYPE (irel->r_info) == R_PROPELLER_PCREL10)
+	      break;
+	  if (irel < relend)
+	    fcache_reloc_target (abfd, sec, isymbuf, irel, insn);
+	  else if ((op == 0x20 || op == 0x21) && (code & (1 << 22)))
+	    {
+	      bfd_vma n = code & 0x1ff;
+
+	      if (op == 0x20 ? off + 4 + n < sec->size : n <= off + 4)
+		{
+		  insn->target = op == 0x20 ? off + 4 + n : off + 4 - n;
+		  insn->has_target = TRUE;
+		}
+	    }
+	}
+      return;
+    }
+
+  op = bfd_get_8 (abfd, contents + off);
+  switch (op & 0xf0)
+    {
+    case PREFIX_MACRO:
+      switch (op & 0x0f)
+	{
+	case MACRO_PUSHM: case MACRO_POPM: case MACRO_POPRET:
+	case MACRO_MVREG: case MACRO_ADDSP:
+	  len = 2;
+	  break;
+	case MACRO_LCALL: case MACRO_XMVREG: case MACRO_FCACHE:
+	  len = 3;
+	  break;
+	case MACRO_LJMP: case MACRO_NATIVE:
+	  len = 5;
+	  break;
+	default:
+	  len = 1;
+	  break;
+	}
+      break;
+    case PREFIX_REGREG: case PREFIX_REGIMM4: case PREFIX_BRS:
+    case PREFIX_MVIB: case PREFIX_LEASP:
+      len = 2;
+      break;
+    case PREFIX_REGIMM12: case PREFIX_BRW: case PREFIX_MVIW:
+    case PREFIX_XMOVREG: case PREFIX_XMOVIMM:
+      len = 3;
+      break;
+    case PREFIX_MVI:
+      len = 5;
+      break;
+    case PREFIX_PACK_NATIVE:
+      len = 4;
+      break;
+    default:
+      len = 1;
+      break;
+    }
+  if (len > left)
+    len = left;
+  insn->len = len;
+  insn->interp = FCACHE_CMM_BYTE_CYCLES * len + FCACHE_CMM_DECODE_CYCLES;
+
+  switch (op & 0xf0)
+    {
+    case PREFIX_MACRO:
+      switch (op & 0x0f)
+	{
+	case MACRO_RET:
+	case MACRO_POPRET:
+	  insn->branch = TRUE;
+	  break;
+	case MACRO_LCALL:
+	case MACRO_MUL:
+	case MACRO_UDIV:
+	case MACRO_DIV:
+	  insn->call = TRUE;
+	  break;
+	case MACRO_FCACHE:
+	  {
+	    bfd_vma count = len == 3 ? bfd_get_16 (abfd, contents + off + 1)
+				     : 0;
+	    bfd_vma end = ((off + len + 3) & ~(bfd_vma) 3)
+			  + ((count + 3) & ~3);
+
+	    insn->len = end < sec->size ? end - off : left;
+	    insn->call = TRUE;
+	  }
+	  break;
+	case MACRO_LJMP:
+	  insn->branch = TRUE;
+	  irel = propeller_reloc_at (relocs, relend, off + 1);
+	  if (irel != NULL)
+	    fcache_reloc_target (abfd, sec, isymbuf, irel, insn);
+	  break;
+	case MACRO_XMVREG:
+	  insn->native_len = 8;
+	  insn->native = 2 * FCACHE_NATIVE_CYCLES;
+	  break;
+	default:
+	  break;
+	}
+      break;
+    case PREFIX_REGREG:
+    case PREFIX_REGIMM4:
+    case PREFIX_REGIMM12:
+    case PREFIX_XMOVREG:
+    case PREFIX_XMOVIMM:
+      {
+	unsigned int xop = (op & 0xf0) == PREFIX_REGIMM12
+	  ? (len == 3 ? bfd_get_16 (abfd, contents + off + 1) >> 12 : 0)
+	  : bfd_get_8 (abfd, contents + off + len - 1) & 15;
+
+	if (xop >= XOP_RDB)
+	  insn->native = FCACHE_NATIVE_HUB_CYCLES;
+	if ((op & 0xf0) == PREFIX_XMOVREG || (op & 0xf0) == PREFIX_XMOVIMM)
+	  {
+	    insn->native_len = 8;
+	    insn->native += FCACHE_NATIVE_CYCLES;
+	  }
+      }
+      break;
+    case PREFIX_MVI:
+      insn->native_len = 8;
+      break;
+    case PREFIX_BRW:
+    case PREFIX_BRS:
+      insn->branch = TRUE;
+      irel = propeller_reloc_at (relocs, relend, off + 1);
+      if (irel != NULL)
+	fcache_reloc_target (abfd, sec, isymbuf, irel, insn);
+      else if (len > 1)
+	{
+	  bfd_vma target = off + len
+	    + ((op & 0xf0) == PREFIX_BRW
+	       ? (bfd_signed_vma) (short) bfd_get_16 (abfd, contents + off + 1)
+	       : (bfd_signed_vma) (signed char) bfd_get_8 (abfd,
+							   contents + off + 1));
+
+	  if (target < sec->size)
+	    {
+	      insn->target = target;
+	      insn->has_target = TRUE;
+	    }
+	}
+      break;
+    default:
+      break;
+    }
+}
+
+/* Executions of the instruction at VMA..VMA+LEN according to the
+   profile.  */
+
+static bfd_uint64_t
+fcache_profile_count (const bfd_vma *pcs, const bfd_uint64_t *counts,
+		      size_t n, bfd_vma vma, unsigned int len)
+{
+  size_t lo = 0, hi = n;
+  bfd_uint64_t sum = 0;
+
+  while (lo < hi)
+    {
+      size_t mid = (lo + hi) / 2;
+
+      if (pcs[mid] < vma)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  for (; lo < n && pcs[lo] < vma + len; lo++)
+    sum += counts[lo];
+  return sum;
+}
+
+/* Cycles saved by caching INSNS[FIRST..LAST], entered ENTRIES times,
+   or 0 if the code can not be cached.  */
+
+static bfd_uint64_t
+fcache_savings (struct fcache_insn *insns, size_t first, size_t last,
+		bfd_uint64_t entries, bfd_vma fcache_size, bfd_vma *sizep,
+		bfd_uint64_t *execp)
+{
+  bfd_uint64_t saved = 0, execs = 0, load;
+  bfd_vma size = 0;
+  size_t i;
+
+  for (i = first; i <= last; i++)
+    {
+      if (insns[i].call)
+	return 0;
+      size += insns[i].native_len;
+      saved += insns[i].count * (insns[i].interp - insns[i].native);
+      execs += insns[i].count;
+    }
+  /* room for the jump back to the kernel */
+  size += 4;
+  if (size > fcache_size)
+    return 0;
+  load = entries * FCACHE_LOAD_CYCLES (size / 4);
+  if (saved <= load)
+    return 0;
+  *sizep = size;
+  *execp = execs;
+  return saved - load;
+}
+
+/* Find the fcache candidates of the LMM and CMM code in INFO's input
+   files.  The profile gives the executions of each address in PCS, or
+   the cycles spent there if TIME_SAMPLES.  For the best candidate of
+   each function, call REPORT with its output address range, its size
+   as native code, the executions and the cycles saved.  */
+
+void bfd_elf32_propeller_fcache_candidates
+  (struct bfd_link_info *, const bfd_vma *, const bfd_uint64_t *, size_t,
+   bfd_boolean, bfd_vma,
+   void (*) (const char *, bfd_vma, bfd_vma, bfd_vma, bfd_uint64_t,
+	     bfd_uint64_t, bfd_boolean, void *),
+   void *);
+
+void
+bfd_elf32_propeller_fcache_candidates
+  (struct bfd_link_info *info, const bfd_vma *pcs, const bfd_uint64_t *counts,
+   size_t n, bfd_boolean time_samples, bfd_vma fcache_size,
+   void (*report) (const char *, bfd_vma, bfd_vma, bfd_vma, bfd_uint64_t,
+		   bfd_uint64_t, bfd_boolean, void *),
+   void *data)
+{
+  bfd *abfd;
+  asection *sec;
+
+  for (abfd = info->input_bfds; abfd != NULL; abfd = abfd->link.next)
+    {
+      Elf_Internal_Shdr *symtab_hdr;
+      Elf_Internal_Sym *isymbuf, *isym;
+      size_t symcount;
+
+      if (bfd_get_flavour (abfd) != bfd_target_elf_flavour
+	  || elf_elfheader (abfd)->e_machine != EM_PROPELLER)
+	continue;
+      symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
+      symcount = symtab_hdr->sh_size / sizeof (Elf32_External_Sym);
+      if (symcount == 0)
+	continue;
+      isymbuf = bfd_elf_get_elf_syms (abfd, symtab_hdr, symcount, 0,
+				      NULL, NULL, NULL);
+      if (isymbuf == NULL)
+	continue;
+
+      for (sec = abfd->sections; sec != NULL; sec = sec->next)
+	{
+	  Elf_Internal_Rela *relocs = NULL, *relend = NULL;
+	  struct fcache_sym *syms;
+	  struct fcache_insn *insns;
+	  bfd_byte *contents;
+	  size_t nsyms = 0, ninsns = 0, s, i, j, k, first;
+	  bfd_vma base, off;
+	  bfd_boolean cmm;
+
+	  if ((sec->flags & SEC_CODE) == 0 || sec->size == 0
+	      || sec->output_section == NULL || discarded_section (sec)
+	      || (elf_section_flags (sec) & SHF_PROPELLER_COGDATA) != 0)
+	    continue;
+	  base = sec->output_section->vma + sec->output_offset;
+
+	  contents = elf_section_data (sec)->this_hdr.contents;
+	  if (contents == NULL
+	      && !bfd_malloc_and_get_section (abfd, sec, &contents))
+	    continue;
+	  if (sec->reloc_count > 0)
+	    {
+	      relocs = _bfd_elf_link_read_relocs (abfd, sec, NULL, NULL,
+						  info->keep_memory);
+	      if (relocs != NULL)
+		relend = relocs + sec->reloc_count;
+	    }
+
+	  syms = (struct fcache_sym *) bfd_malloc ((symcount + 1)
+						   * sizeof (*syms));
+	  insns = (struct fcache_insn *) bfd_malloc ((sec->size + 1)
+						     * sizeof (*insns));
+	  if (syms == NULL || insns == NULL)
+	    goto next;
+	  for (isym = isymbuf + 1; isym < isymbuf + symcount; isym++)
+	    {
+	      int type = ELF_ST_TYPE (isym->st_info);
+
+	      if (type == STT_SECTION || type == STT_FILE
+		  || isym->st_shndx == SHN_UNDEF
+		  || bfd_section_from_elf_index (abfd, isym->st_shndx) != sec
+		  || isym->st_value >= sec->size)
+		continue;
+	      syms[nsyms].value = isym->st_value;
+	      syms[nsyms].name
+		= bfd_elf_string_from_elf_section (abfd, symtab_hdr->sh_link,
+						   isym->st_name);
+	      syms[nsyms].other = isym->st_other;
+	      syms[nsyms].func = type == STT_FUNC
+		|| ELF_ST_BIND (isym->st_info) != STB_LOCAL;
+	      nsyms++;
+	    }
+	  if (nsyms == 0)
+	    goto next;
+	  qsort (syms, nsyms, sizeof (*syms), fcache_sym_compare);
+
+	  /* Decode the section, function by function.  */
+	  s = 0;
+	  cmm = FALSE;
+	  for (off = 0; off < sec->size; off += insns[ninsns++].len)
+	    {
+	      for (; s < nsyms && syms[s].value <= off; s++)
+		if (syms[s].value == off)
+		  cmm = (syms[s].other & PROPELLER_OTHER_COMPRESSED) != 0;
+	      fcache_decode (abfd, sec, contents, relocs, relend, isymbuf,
+			     off, cmm, &insns[ninsns]);
+	      if (insns[ninsns].len == 0)
+		insns[ninsns].len = 1;
+	      insns[ninsns].count
+		= fcache_profile_count (pcs, counts, n, base + off,
+					insns[ninsns].len);
+	      if (time_samples && insns[ninsns].interp != 0)
+		insns[ninsns].count /= insns[ninsns].interp;
+	    }
+
+	  /* Look at each function: the function itself if it is a leaf,
+	     and the loops closed by a backward branch inside it.  */
+	  s = 0;
+	  for (first = 0; first < ninsns; first = j)
+	    {
+	      const char *fname = NULL;
+	      bfd_uint64_t best = 0, best_execs = 0, saved, execs;
+	      bfd_vma best_size = 0, size;
+	      size_t best_first = 0, best_last = 0;
+	      bfd_boolean best_whole = FALSE;
+
+	      /* the function runs up to the next function symbol */
+	      for (; s < nsyms && syms[s].value <= insns[first].off; s++)
+		if (syms[s].func || fname == NULL)
+		  fname = syms[s].name;
+	      k = s;
+	      for (j = first + 1; j < ninsns; j++)
+		{
+		  bfd_boolean func = FALSE;
+
+		  for (; k < nsyms && syms[k].value <= insns[j].off; k++)
+		    if (syms[k].value == insns[j].off && syms[k].func)
+		      func = TRUE;
+		  if (func)
+		    break;
+		}
+
+	      saved = fcache_savings (insns, first, j - 1, insns[first].count,
+				      fcache_size, &size, &execs);
+	      if (saved > best)
+		{
+		  best = saved;
+		  best_size = size;
+		  best_execs = execs;
+		  best_first = first;
+		  best_last = j - 1;
+		  best_whole = TRUE;
+		}
+
+	      for (i = first; i < j; i++)
+		{
+		  size_t head;
+		  bfd_uint64_t entries;
+
+		  if (!insns[i].has_target || insns[i].target > insns[i].off
+		      || insns[i].target < insns[first].off)
+		    continue;
+		  for (head = first; head < i; head++)
+		    if (insns[head].off == insns[i].target)
+		      break;
+		  if (insns[head].off != insns[i].target)
+		    continue;
+		  /* the loop is entered as often as it is not repeated */
+		  entries = insns[head].count > insns[i].count
+		    ? insns[head].count - insns[i].count : 1;
+		  saved = fcache_savings (insns, head, i, entries, fcache_size,
+					  &size, &execs);
+		  if (saved > best)
+		    {
+		      best = saved;
+		      best_size = size;
+		      best_execs = execs;
+		      best_first = head;
+		      best_last = i;
+		      best_whole = FALSE;
+		    }
+		}
+
+	      if (best != 0)
+		report (fname != NULL ? fname : sec->name,
+			base + insns[best_first].off,
+			base + insns[best_last].off + insns[best_last].len,
+			best_size, best_execs, best, best_whole, data);
+	    }
+
+	next:
+	  free (syms);
+	  free (insns);
+	  if (relocs != NULL && elf_section_data (sec)->relocs != relocs)
+	    free (relocs);
+	  if (contents != elf_section_data (sec)->this_hdr.contents)
+	    free (contents);
+	}
+      free (isymbuf);
+    }
+}
+
+/* gas --dual-encoding assembles the code of a .text section a second
+   time, in the other of LMM and CMM, into a section of the same name
+   with ".lmm" or ".cmm" added.  Each label in it is a local twin of
+   the label in the first section.  The linker keeps one of the two.  */
+
+asection *bfd_elf32_propeller_dual_section (asection *, bfd_boolean *);
+bfd_boolean bfd_elf32_propeller_dual_select (asection *, asection *,
+					     bfd_boolean);
+
+/* The alternate encoding of SEC, if it has one.  *COMPRESSED says
+   whether the alternate is CMM.  gas marks the alternate SEC_EXCLUDE
+   if it could not encode all of SEC.  */
+asection *
+bfd_elf32_propeller_dual_section (asection *sec, bfd_boolean *compressed)
+{
+  char *name;
+  asection *alt;
+
+  if (bfd_get_flavour (sec->owner) != bfd_target_elf_flavour
+      || (sec->flags & SEC_CODE) == 0)
+    return NULL;
+  name = (char *) bfd_malloc (strlen (sec->name) + sizeof ".lmm");
+  if (name == NULL)
+    return NULL;
+  sprintf (name, "%s.cmm", sec->name);
+  *compressed = TRUE;
+  alt = bfd_get_section_by_name (sec->owner, name);
+  if (alt == NULL)
+    {
+      sprintf (name, "%s.lmm", sec->name);
+      *compressed = FALSE;
+      alt = bfd_get_section_by_name (sec->owner, name);
+    }
+  free (name);
+  return alt;
+}
+
+/* Index in SYMS, which has COUNT entries, of the local symbol NAME
+   defined in section SHNDX; or 0.  */
+static unsigned long
+propeller_dual_twin (bfd *abfd, Elf_Internal_Shdr *symtab_hdr,
+		     Elf_Internal_Sym *syms, unsigned long count,
+		     unsigned int shndx, const char *name)
+{
+  unsigned long i;
+
+  for (i = 1; i < count; i++)
+    if (syms[i].st_shndx == shndx
+	&& ELF_ST_TYPE (syms[i].st_info) != STT_SECTION
+	&& strcmp (bfd_elf_string_from_elf_section (abfd, symtab_hdr->sh_link,
+						    syms[i].st_name),
+		   name) == 0)
+      return i;
+  return 0;
+}
+
+/* Link KEEP and leave out DROP, its other encoding.  Symbols defined
+   in DROP move to their twins in KEEP; KEEP_COMPRESSED says whether
+   KEEP is CMM.  Must be called before garbage collection.  */
+bfd_boolean
+bfd_elf32_propeller_dual_select (asection *keep, asection *drop,
+				 bfd_boolean keep_compressed)
+{
+  bfd *abfd = keep->owner;
+  Elf_Internal_Shdr *symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
+  struct elf_link_hash_entry **sym_hashes = elf_sym_hashes (abfd);
+  unsigned int keep_shndx = _bfd_elf_section_from_bfd_section (abfd, keep);
+  unsigned int drop_shndx = _bfd_elf_section_from_bfd_section (abfd, drop);
+  unsigned char other = keep_compressed ? PROPELLER_OTHER_COMPRESSED : 0;
+  Elf_Internal_Sym *isymbuf;
+  unsigned long i, j, nlocals, nglobals;
+
+  /* even a relocatable link must not keep both; what is kept is an
+     ordinary section again */
+  drop->flags |= SEC_EXCLUDE;
+  drop->output_section = bfd_abs_section_ptr;
+  if (elf_section_type (keep) == SHT_PROPELLER_DUAL)
+    elf_section_type (keep) = SHT_PROGBITS;
+
+  /* the symbols point at the first encoding already */
+  if (strncmp (keep->name, drop->name, strlen (drop->name)) != 0)
+    return TRUE;
+
+  /* the local symbols are cached, so that everything after this sees
+     the moved ones */
+  nlocals = symtab_hdr->sh_info;
+  isymbuf = (Elf_Internal_Sym *) symtab_hdr->contents;
+  if (isymbuf == NULL && nlocals != 0)
+    {
+      isymbuf = bfd_elf_get_elf_syms (abfd, symtab_hdr, nlocals, 0,
+				      NULL, NULL, NULL);
+      if (isymbuf == NULL)
+	return FALSE;
+      symtab_hdr->contents = (unsigned char *) isymbuf;
+    }
+
+  for (i = 1; i < nlocals; i++)
+    {
+      Elf_Internal_Sym *isym = isymbuf + i;
+
+      if (isym->st_shndx != drop_shndx
+	  || ELF_ST_TYPE (isym->st_info) == STT_SECTION)
+	continue;
+      j = propeller_dual_twin (abfd, symtab_hdr, isymbuf, nlocals, keep_shndx,
+			       bfd_elf_string_from_elf_section
+			       (abfd, symtab_hdr->sh_link, isym->st_name));
+      if (j == 0)
+	continue;
+      isym->st_shndx = keep_shndx;
+      isym->st_value = isymbuf[j].st_value;
+      isym->st_size = isymbuf[j].st_size;
+      isym->st_other = (isym->st_other & ~PROPELLER_OTHER_COMPRESSED) | other;
+    }
+
+  nglobals = symtab_hdr->sh_size / symtab_hdr->sh_entsize - nlocals;
+  for (i = 0; i < nglobals; i++)
+    {
+      struct elf_link_hash_entry *h = sym_hashes[i];
+
+      if (h == NULL)
+	continue;
+      while (h->root.type == bfd_link_hash_indirect
+	     || h->root.type == bfd_link_hash_warning)
+	h = (struct elf_link_hash_entry *) h->root.u.i.link;
+      if ((h->root.type != bfd_link_hash_defined
+	   && h->root.type != bfd_link_hash_defweak)
+	  || h->root.u.def.section != drop)
+	continue;
+      j = propeller_dual_twin (abfd, symtab_hdr, isymbuf, nlocals, keep_shndx,
+			       h->root.root.string);
+      if (j == 0)
+	{
+	  _bfd_error_handler
+	    (_("%B: %s has no twin in %A"), abfd, h->root.root.string, keep);
+	  continue;
+	}
+      h->root.u.def.section = keep;
+      h->root.u.def.value = isymbuf[j].st_value;
+      h->size = isymbuf[j].st_size;
+      h->other = (h->other & ~PROPELLER_OTHER_COMPRESSED) | other;
+    }
+  return TRUE;
+}
+
 #define ELF_ARCH		bfd_arch_propeller
 #define ELF_MACHINE_CODE	EM_PROPELLER
 #define ELF_MAXPAGESIZE		0x1
@@ -1154,6 +3389,7 @@ propeller_elf_gc_keep (struct bfd_link_info *info)
 #define elf_backend_merge_symbol_attribute      propeller_elf_merge_symbol_attribute
 #define elf_backend_modify_program_headers      propeller_elf_modify_program_headers
 #define elf_backend_object_p                    propeller_elf_object_p
+#define elf_backend_section_from_shdr           propeller_elf_section_from_shdr
 #define elf_backend_final_write_processing      propeller_elf_final_write_processing
 #define elf_backend_gc_keep                     propeller_elf_gc_keep
 
@@ -1165,6 +3401,7 @@ propeller_elf_gc_keep (struct bfd_link_info *info)
 #define bfd_elf32_bfd_set_private_flags         propeller_elf_set_private_flags
 #define bfd_elf32_bfd_merge_private_bfd_data    propeller_elf_merge_private_bfd_data
 #define bfd_elf32_bfd_print_private_bfd_data    propeller_elf_print_private_bfd_data
+#define bfd_elf32_bfd_relax_section		propeller_elf_relax_section
 
 #define bfd_elf32_bfd_is_local_label_name \
 					propeller_elf_is_local_label_name
@@ -1484,6 +1484,11 @@ static const char *const bfd_reloc_code_real_names[] = { "@@uninitialized@@",
   "BFD_RELOC_PROPELLER_16_DIV4",
   "BFD_RELOC_PROPELLER_8_DIV4",
   "BFD_RELOC_PROPELLER_REPSREL",
+  "BFD_RELOC_PROPELLER_RELAX",
+  "BFD_RELOC_PROPELLER_ALIGN",
+  "BFD_RELOC_PROPELLER_DIFF8",
+  "BFD_RELOC_PROPELLER_DIFF16",
+  "BFD_RELOC_PROPELLER_DIFF32",
   "BFD_RELOC_I370_D12",
   "BFD_RELOC_CTOR",
   "BFD_RELOC_ARM_PCREL_BRANCH",
@@ -0,0 +1,869 @@
+/* BFD back-end for compressed Parallax Propeller download images.
+   Copyright 2017 Parallax Inc.
+
+   This file is part of BFD, the Binary File Descriptor library.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* This is a BFD backend for the compressed images sent to a Propeller
+   by the serial loader.  It is mainly meant as an output format for
+   objcopy; reading one back gives a section per record.
+
+   All values are little endian.  The file starts with a 16 byte
+   header:
+
+     0   "PRPZ"
+     4   version (1)
+     5   flags: PROPELLER_IMAGE_DELTA if the image holds only the
+	 pages that differ from an earlier image
+     6   number of records (2 bytes)
+     8   entry address
+     12  CRC-32 of the header, with this field as zero, and the record
+	 table
+
+   followed by a 16 byte entry per record:
+
+     0   load address
+     4   size
+     8   compressed size; equal to the size if the data is stored
+     12  CRC-32 of the uncompressed data
+
+   followed by the data of each record in turn.  The data is a sequence
+   of tokens:
+
+     0x00-0x7f		n+1 literal bytes follow
+     0x80-0xff		copy (n&0x7f)+3 bytes from the 16 bit offset
+			that follows, counted back from the output
+
+   which is simple enough for the decompressor to live in the kernel
+   area of the loader.
+
+   For a delta image the sections are compared, PROPELLER_IMAGE_PAGE
+   bytes at a time, with the image named by _bfd_propeller_image_base
+   (objcopy --propeller-delta), which may be in any format BFD can
+   read.  Only the pages that changed are written.  */
+
+#include "sysdep.h"
+#include "bfd.h"
+#include "libbfd.h"
+#include "libiberty.h"
+
+#define PROPELLER_IMAGE_MAGIC	"PRPZ"
+#define PROPELLER_IMAGE_VERSION	1
+#define PROPELLER_IMAGE_DELTA	0x01
+#define PROPELLER_IMAGE_HDRSZ	16
+#define PROPELLER_IMAGE_RECSZ	16
+#define PROPELLER_IMAGE_PAGE	256
+
+#define LZ_MIN_MATCH	3
+#define LZ_MAX_MATCH	(0x7f + LZ_MIN_MATCH)
+#define LZ_MAX_LITERAL	0x80
+#define LZ_WINDOW	0xffff
+#define LZ_HASH_BITS	12
+#define LZ_MAX_CHAIN	64
+/* Worst case output size: a literal byte followed by a 3 byte match
+   takes 5 bytes for 4.  */
+#define LZ_BOUND(size)	((size) + (size) / 2 + 1)
+
+/* The image to compare with for a delta image.  This variable can be
+   set by objcopy's --propeller-delta parameter.  */
+const char *_bfd_propeller_image_base = NULL;
+
+/* Loadable data, sorted by address, as it is handed to us by
+   set_section_contents.  */
+
+struct propeller_image_data
+{
+  struct propeller_image_data *next;
+  bfd_vma where;
+  bfd_size_type size;
+  bfd_byte *data;
+};
+
+struct propeller_image_tdata
+{
+  struct propeller_image_data *head;
+  struct propeller_image_data *tail;
+};
+
+/* A record, on input.  */
+
+struct propeller_image_record
+{
+  bfd_size_type csize;
+  unsigned long crc;
+  bfd_byte *contents;
+};
+
+/* Compress SIZE bytes at IN into OUT, which has room for
+   LZ_BOUND (SIZE) bytes.  Returns the compressed size, or
+   (bfd_size_type) -1 if memory runs out.  */
+
+static bfd_size_type
+propeller_image_compress (const bfd_byte *in, bfd_size_type size,
+			  bfd_byte *out)
+{
+  long head[1 << LZ_HASH_BITS];
+  long *prev;
+  bfd_size_type pos, lit, n;
+  long i;
+
+  prev = (long *) bfd_malloc (size * sizeof (long) + 1);
+  if (prev == NULL)
+    return (bfd_size_type) -1;
+  for (i = 0; i < (1 << LZ_HASH_BITS); i++)
+    head[i] = -1;
+
+#define LZ_HASH(p) \
+  ((((p)[0] << 8) ^ ((p)[1] << 4) ^ (p)[2]) & ((1 << LZ_HASH_BITS) - 1))
+
+  n = 0;
+  lit = 0;
+  pos = 0;
+  while (pos < size)
+    {
+      bfd_size_type best_len = 0, best_off = 0;
+
+      if (pos + LZ_MIN_MATCH <= size)
+	{
+	  unsigned int h = LZ_HASH (in + pos);
+	  long cand;
+	  int chain;
+
+	  for (cand = head[h], chain = 0;
+	       cand >= 0 && pos - cand <= LZ_WINDOW && chain < LZ_MAX_CHAIN;
+	       cand = prev[cand], chain++)
+	    {
+	      bfd_size_type len = 0;
+
+	      while (len < LZ_MAX_MATCH && pos + len < size
+		     && in[cand + len] == in[pos + len])
+		len++;
+	      if (len > best_len)
+		{
+		  best_len = len;
+		  best_off = pos - cand;
+		  if (len == LZ_MAX_MATCH)
+		    break;
+		}
+	    }
+	}
+
+      if (best_len < LZ_MIN_MATCH)
+	best_len = 1;
+      else
+	{
+	  /* flush the pending literals, then the match */
+	  while (lit < pos)
+	    {
+	      bfd_size_type run = pos - lit;
+
+	      if (run > LZ_MAX_LITERAL)
+		run = LZ_MAX_LITERAL;
+
+	      out[n++] = run - 1;
+	      memcpy (out + n, in + lit, run);
+	      n += run;
+	      lit += run;
+	    }
+	  out[n++] = 0x80 | (best_len - LZ_MIN_MATCH);
+	  out[n++] = best_off & 0xff;
+	  out[n++] = best_off >> 8;
+	  lit = pos + best_len;
+	}
+
+      for (; best_len > 0; best_len--, pos++)
+	if (pos + LZ_MIN_MATCH <= size)
+	  {
+	    unsigned int h = LZ_HASH (in + pos);
+
+	    prev[pos] = head[h];
+	    head[h] = pos;
+	  }
+    }
+  while (lit < size)
+    {
+      bfd_size_type run = size - lit;
+
+      if (run > LZ_MAX_LITERAL)
+	run = LZ_MAX_LITERAL;
+
+      out[n++] = run - 1;
+      memcpy (out + n, in + lit, run);
+      n += run;
+      lit += run;
+    }
+
+#undef LZ_HASH
+
+  free (prev);
+  return n;
+}
+
+/* Decompress CSIZE bytes at IN into the SIZE bytes at OUT.  */
+
+static bfd_boolean
+propeller_image_decompress (const bfd_byte *in, bfd_size_type csize,
+			    bfd_byte *out, bfd_size_type size)
+{
+  bfd_size_type i = 0, o = 0;
+
+  if (csize == size)
+    {
+      memcpy (out, in, size);
+      return TRUE;
+    }
+  while (i < csize)
+    {
+      unsigned int token = in[i++];
+
+      if (token < 0x80)
+	{
+	  bfd_size_type run = token + 1;
+
+	  if (i + run > csize || o + run > size)
+	    return FALSE;
+	  memcpy (out + o, in + i, run);
+	  i += run;
+	  o += run;
+	}
+      else
+	{
+	  bfd_size_type len = (token & 0x7f) + LZ_MIN_MATCH;
+	  bfd_size_type off;
+
+	  if (i + 2 > csize)
+	    return FALSE;
+	  off = in[i] | (in[i + 1] << 8);
+	  i += 2;
+	  if (off == 0 || off > o || o + len > size)
+	    return FALSE;
+	  /* the source may overlap the output */
+	  for (; len > 0; len--, o++)
+	    out[o] = out[o - off];
+	}
+    }
+  return o == size;
+}
+
+/* Create an image.  Invoked via bfd_set_format.  */
+
+static bfd_boolean
+propeller_image_mkobject (bfd *abfd)
+{
+  struct propeller_image_tdata *tdata;
+
+  tdata = (struct propeller_image_tdata *) bfd_zalloc (abfd, sizeof (*tdata));
+  if (tdata == NULL)
+    return FALSE;
+  abfd->tdata.any = tdata;
+  return TRUE;
+}
+
+/* Check whether an existing file is a Propeller image.  */
+
+static const bfd_target *
+propeller_image_object_p (bfd *abfd)
+{
+  bfd_byte hdr[PROPELLER_IMAGE_HDRSZ];
+  bfd_byte *table;
+  bfd_size_type amt;
+  ufile_ptr filesize;
+  file_ptr pos;
+  unsigned int count, i;
+  unsigned long crc;
+
+  if (bfd_seek (abfd, (file_ptr) 0, SEEK_SET) != 0
+      || bfd_bread (hdr, sizeof (hdr), abfd) != sizeof (hdr))
+    {
+      if (bfd_get_error () != bfd_error_system_call)
+	bfd_set_error (bfd_error_wrong_format);
+      return NULL;
+    }
+  if (memcmp (hdr, PROPELLER_IMAGE_MAGIC, 4) != 0
+      || hdr[4] != PROPELLER_IMAGE_VERSION)
+    {
+      bfd_set_error (bfd_error_wrong_format);
+      return NULL;
+    }
+
+  count = bfd_getl16 (hdr + 6);
+  amt = (bfd_size_type) count * PROPELLER_IMAGE_RECSZ;
+  table = (bfd_byte *) bfd_malloc (amt + 1);
+  if (table == NULL)
+    return NULL;
+  if (bfd_bread (table, amt, abfd) != amt)
+    {
+      free (table);
+      if (bfd_get_error () != bfd_error_system_call)
+	bfd_set_error (bfd_error_wrong_format);
+      return NULL;
+    }
+
+  crc = bfd_getl32 (hdr + 12);
+  bfd_putl32 (0, hdr + 12);
+  if (crc != bfd_calc_gnu_debuglink_crc32
+	       (bfd_calc_gnu_debuglink_crc32 (0, hdr, sizeof (hdr)),
+		table, amt))
+    {
+      free (table);
+      bfd_set_error (bfd_error_wrong_format);
+      return NULL;
+    }
+
+  if (! propeller_image_mkobject (abfd))
+    goto fail;
+  abfd->start_address = bfd_getl32 (hdr + 8);
+  filesize = bfd_get_size (abfd);
+
+  pos = PROPELLER_IMAGE_HDRSZ + amt;
+  for (i = 0; i < count; i++)
+    {
+      bfd_byte *rec = table + i * PROPELLER_IMAGE_RECSZ;
+      struct propeller_image_record *r;
+      asection *sec;
+      char secbuf[20];
+      char *name;
+
+      sprintf (secbuf, ".sec%u", i + 1);
+      name = (char *) bfd_alloc (abfd, strlen (secbuf) + 1);
+      r = (struct propeller_image_record *) bfd_zalloc (abfd, sizeof (*r));
+      if (name == NULL || r == NULL)
+	goto fail;
+      strcpy (name, secbuf);
+      sec = bfd_make_section_with_flags (abfd, name,
+					 (SEC_HAS_CONTENTS | SEC_LOAD
+					  | SEC_ALLOC));
+      if (sec == NULL)
+	goto fail;
+      sec->vma = sec->lma = bfd_getl32 (rec);
+      sec->size = bfd_getl32 (rec + 4);
+      sec->filepos = pos;
+      r->csize = bfd_getl32 (rec + 8);
+      r->crc = bfd_getl32 (rec + 12);
+      /* The data has to be in the file, and a match token gives at
+	 most LZ_MAX_MATCH bytes for three.  */
+      if (r->csize > sec->size
+	  || (ufile_ptr) pos > filesize
+	  || r->csize > filesize - pos
+	  || sec->size / LZ_MAX_MATCH > r->csize / 3 + 1)
+	{
+	  bfd_set_error (bfd_error_wrong_format);
+	  goto fail;
+	}
+      sec->used_by_bfd = r;
+      pos += r->csize;
+    }
+
+  free (table);
+  return abfd->xvec;
+
+ fail:
+  free (table);
+  return NULL;
+}
+
+/* Get the contents of a section, decompressing the whole record the
+   first time.  */
+
+static bfd_boolean
+propeller_image_get_section_contents (bfd *abfd,
+				      asection *section,
+				      void *location,
+				      file_ptr offset,
+				      bfd_size_type count)
+{
+  struct propeller_image_record *r
+    = (struct propeller_image_record *) section->used_by_bfd;
+
+  if (r->contents == NULL)
+    {
+      bfd_byte *cdata;
+      bfd_byte *contents;
+
+      cdata = (bfd_byte *) bfd_malloc (r->csize + 1);
+      contents = (bfd_byte *) bfd_alloc (abfd, section->size + 1);
+      if (cdata == NULL || contents == NULL)
+	{
+	  free (cdata);
+	  return FALSE;
+	}
+      if (bfd_seek (abfd, section->filepos, SEEK_SET) != 0
+	  || bfd_bread (cdata, r->csize, abfd) != r->csize)
+	{
+	  free (cdata);
+	  return FALSE;
+	}
+      if (! propeller_image_decompress (cdata, r->csize,
+					contents, section->size)
+	  || bfd_calc_gnu_debuglink_crc32 (0, contents,
+					   section->size) != r->crc)
+	{
+	  free (cdata);
+	  _bfd_error_handler
+	    /* xgettext:c-format */
+	    (_("%B: corrupt data in section `%A'"), abfd, section);
+	  bfd_set_error (bfd_error_bad_value);
+	  return FALSE;
+	}
+      free (cdata);
+      r->contents = contents;
+    }
+
+  memcpy (location, r->contents + offset, (size_t) count);
+  return TRUE;
+}
+
+/* Set the contents of a section.  Only loadable sections go into the
+   image; they are placed by load address.  */
+
+static bfd_boolean
+propeller_image_set_section_contents (bfd *abfd,
+				      asection *section,
+				      const void *location,
+				      file_ptr offset,
+				      bfd_size_type count)
+{
+  struct propeller_image_tdata *tdata
+    = (struct propeller_image_tdata *) abfd->tdata.any;
+  struct propeller_image_data *n;
+
+  if (count == 0
+      || (section->flags & SEC_ALLOC) == 0
+      || (section->flags & SEC_LOAD) == 0
+      || (section->flags & SEC_NEVER_LOAD) != 0)
+    return TRUE;
+
+  n = (struct propeller_image_data *) bfd_alloc (abfd, sizeof (*n));
+  if (n == NULL)
+    return FALSE;
+  n->data = (bfd_byte *) bfd_alloc (abfd, count);
+  if (n->data == NULL)
+    return FALSE;
+  memcpy (n->data, location, (size_t) count);
+  n->where = section->lma + offset;
+  n->size = count;
+
+  /* Sort the data by address.  Optimize for the common case of adding
+     to the end of the list.  */
+  if (tdata->tail != NULL && n->where >= tdata->tail->where)
+    {
+      tdata->tail->next = n;
+      n->next = NULL;
+      tdata->tail = n;
+    }
+  else
+    {
+      struct propeller_image_data **pp;
+
+      for (pp = &tdata->head;
+	   *pp != NULL && (*pp)->where < n->where;
+	   pp = &(*pp)->next)
+	;
+      n->next = *pp;
+      *pp = n;
+      if (n->next == NULL)
+	tdata->tail = n;
+    }
+
+  return TRUE;
+}
+
+/* Read the loadable data of the image we make a delta against into a
+   list sorted by address, like the one set_section_contents builds.  */
+
+static bfd_boolean
+propeller_image_read_base (bfd *abfd, struct propeller_image_tdata *base)
+{
+  bfd *ibfd;
+  asection *sec;
+
+  ibfd = bfd_openr (_bfd_propeller_image_base, NULL);
+  if (ibfd == NULL)
+    return FALSE;
+  if (! bfd_check_format (ibfd, bfd_object))
+    {
+      _bfd_error_handler
+	/* xgettext:c-format */
+	(_("%B: cannot read delta base image %s"), abfd,
+	 _bfd_propeller_image_base);
+      bfd_close (ibfd);
+      return FALSE;
+    }
+
+  for (sec = ibfd->sections; sec != NULL; sec = sec->next)
+    {
+      struct propeller_image_data *n, **pp;
+
+      if ((sec->flags & (SEC_ALLOC | SEC_LOAD | SEC_HAS_CONTENTS))
+	  != (SEC_ALLOC | SEC_LOAD | SEC_HAS_CONTENTS)
+	  || sec->size == 0)
+	continue;
+      n = (struct propeller_image_data *) bfd_alloc (abfd, sizeof (*n));
+      if (n == NULL)
+	goto fail;
+      n->where = sec->lma;
+      n->size = sec->size;
+      n->data = (bfd_byte *) bfd_alloc (abfd, sec->size);
+      if (n->data == NULL
+	  || ! bfd_get_section_contents (ibfd, sec, n->data, 0, sec->size))
+	goto fail;
+      for (pp = &base->head;
+	   *pp != NULL && (*pp)->where < n->where;
+	   pp = &(*pp)->next)
+	;
+      n->next = *pp;
+      *pp = n;
+    }
+
+  bfd_close (ibfd);
+  return TRUE;
+
+ fail:
+  bfd_close (ibfd);
+  return FALSE;
+}
+
+/* Return TRUE if the SIZE bytes at DATA, to be loaded at WHERE, differ
+   from the base image.  */
+
+static bfd_boolean
+propeller_image_changed (struct propeller_image_tdata *base, bfd_vma where,
+			 const bfd_byte *data, bfd_size_type size)
+{
+  struct propeller_image_data *b;
+  bfd_size_type same = 0;
+
+  for (b = base->head; b != NULL && b->where < where + size; b = b->next)
+    {
+      bfd_vma start, end;
+
+      if (b->where + b->size <= where)
+	continue;
+      start = b->where > where ? b->where : where;
+      end = b->where + b->size;
+      if (end > where + size)
+	end = where + size;
+      if (memcmp (data + (start - where), b->data + (start - b->where),
+		  end - start) != 0)
+	return TRUE;
+      same += end - start;
+    }
+  /* bytes the base did not load have changed too */
+  return same < size;
+}
+
+struct propeller_image_out
+{
+  bfd_vma where;
+  bfd_size_type size;
+  const bfd_byte *data;
+};
+
+/* Add a record to write.  */
+
+static bfd_boolean
+propeller_image_add (struct propeller_image_out **recs, unsigned int *count,
+		     unsigned int *alloc, bfd_vma where, bfd_size_type size,
+		     const bfd_byte *data)
+{
+  if (*count >= *alloc)
+    {
+      *alloc = *alloc ? *alloc * 2 : 16;
+      *recs = (struct propeller_image_out *)
+	bfd_realloc_or_free (*recs, *alloc * sizeof (**recs));
+      if (*recs == NULL)
+	return FALSE;
+    }
+  (*recs)[*count].where = where;
+  (*recs)[*count].size = size;
+  (*recs)[*count].data = data;
+  ++*count;
+  return TRUE;
+}
+
+/* Write out the image.  */
+
+static bfd_boolean
+propeller_image_write_object_contents (bfd *abfd)
+{
+  struct propeller_image_tdata *tdata
+    = (struct propeller_image_tdata *) abfd->tdata.any;
+  struct propeller_image_tdata base;
+  struct propeller_image_data *l, *e;
+  struct propeller_image_out *recs = NULL;
+  unsigned int count = 0, alloc = 0, i;
+  bfd_byte hdr[PROPELLER_IMAGE_HDRSZ];
+  bfd_byte *table = NULL;
+  bfd_byte **cdata = NULL;
+  bfd_size_type *csize = NULL;
+  bfd_size_type amt;
+  bfd_boolean ret = FALSE;
+
+  memset (&base, 0, sizeof (base));
+  if (_bfd_propeller_image_base != NULL
+      && ! propeller_image_read_base (abfd, &base))
+    return FALSE;
+
+  for (l = tdata->head; l != NULL; l = e->next)
+    {
+      bfd_size_type size = l->size;
+      bfd_byte *data = l->data;
+      bfd_vma where = l->where;
+
+      /* merge the data of adjacent sections into one record */
+      for (e = l; e->next != NULL && e->next->where == where + size;
+	   e = e->next)
+	size += e->next->size;
+      if (e != l)
+	{
+	  struct propeller_image_data *p;
+	  bfd_size_type off = 0;
+
+	  data = (bfd_byte *) bfd_alloc (abfd, size);
+	  if (data == NULL)
+	    goto out;
+	  for (p = l; ; p = p->next)
+	    {
+	      memcpy (data + off, p->data, p->size);
+	      off += p->size;
+	      if (p == e)
+		break;
+	    }
+	}
+
+      if (_bfd_propeller_image_base == NULL)
+	{
+	  if (! propeller_image_add (&recs, &count, &alloc, where, size, data))
+	    goto out;
+	  continue;
+	}
+
+      /* keep runs of changed pages */
+      while (size > 0)
+	{
+	  bfd_size_type run = 0, len;
+
+	  for (;;)
+	    {
+	      len = PROPELLER_IMAGE_PAGE
+		- ((where + run) & (PROPELLER_IMAGE_PAGE - 1));
+	      if (len > size - run)
+		len = size - run;
+	      if (len == 0
+		  || ! propeller_image_changed (&base, where + run,
+						data + run, len))
+		break;
+	      run += len;
+	    }
+	  if (run > 0
+	      && ! propeller_image_add (&recs, &count, &alloc,
+					where, run, data))
+	    goto out;
+	  /* skip the unchanged page */
+	  run += len;
+	  where += run;
+	  data += run;
+	  size -= run;
+	}
+    }
+
+  if (count > 0xffff)
+    {
+      _bfd_error_handler
+	/* xgettext:c-format */
+	(_("%B: too many records for a Propeller image"), abfd);
+      bfd_set_error (bfd_error_file_too_big);
+      goto out;
+    }
+
+  amt = (bfd_size_type) count * PROPELLER_IMAGE_RECSZ;
+  table = (bfd_byte *) bfd_malloc (amt + 1);
+  cdata = (bfd_byte **) bfd_zmalloc (count * sizeof (bfd_byte *) + 1);
+  csize = (bfd_size_type *) bfd_malloc (count * sizeof (bfd_size_type) + 1);
+  if (table == NULL || cdata == NULL || csize == NULL)
+    goto out;
+
+  for (i = 0; i < count; i++)
+    {
+      bfd_byte *rec = table + i * PROPELLER_IMAGE_RECSZ;
+      bfd_size_type size = recs[i].size;
+
+      cdata[i] = (bfd_byte *) bfd_malloc (LZ_BOUND (size));
+      if (cdata[i] == NULL)
+	goto out;
+      csize[i] = propeller_image_compress (recs[i].data, size, cdata[i]);
+      if (csize[i] == (bfd_size_type) -1)
+	goto out;
+      /* store the data if it does not compress */
+      if (csize[i] >= size)
+	{
+	  memcpy (cdata[i], recs[i].data, size);
+	  csize[i] = size;
+	}
+      bfd_putl32 (recs[i].where, rec);
+      bfd_putl32 (size, rec + 4);
+      bfd_putl32 (csize[i], rec + 8);
+      bfd_putl32 (bfd_calc_gnu_debuglink_crc32 (0, recs[i].data, size),
+		  rec + 12);
+    }
+
+  memcpy (hdr, PROPELLER_IMAGE_MAGIC, 4);
+  hdr[4] = PROPELLER_IMAGE_VERSION;
+  hdr[5] = _bfd_propeller_image_base != NULL ? PROPELLER_IMAGE_DELTA : 0;
+  bfd_putl16 (count, hdr + 6);
+  bfd_putl32 (bfd_get_start_address (abfd), hdr + 8);
+  bfd_putl32 (0, hdr + 12);
+  bfd_putl32 (bfd_calc_gnu_debuglink_crc32
+	      (bfd_calc_gnu_debuglink_crc32 (0, hdr, sizeof (hdr)),
+	       table, amt), hdr + 12);
+
+  if (bfd_seek (abfd, (file_ptr) 0, SEEK_SET) != 0
+      || bfd_bwrite (hdr, sizeof (hdr), abfd) != sizeof (hdr)
+      || bfd_bwrite (table, amt, abfd) != amt)
+    goto out;
+  for (i = 0; i < count; i++)
+    if (bfd_bwrite (cdata[i], csize[i], abfd) != csize[i])
+      goto out;
+  ret = TRUE;
+
+ out:
+  if (cdata != NULL)
+    for (i = 0; i < count; i++)
+      free (cdata[i]);
+  free (cdata);
+  free (csize);
+  free (table);
+  free (recs);
+  return ret;
+}
+
+/* Set the architecture.  We accept an unknown architecture here.  */
+
+static bfd_boolean
+propeller_image_set_arch_mach (bfd *abfd,
+			       enum bfd_architecture arch,
+			       unsigned long mach)
+{
+  if (! bfd_default_set_arch_mach (abfd, arch, mach))
+    {
+      if (arch != bfd_arch_unknown)
+	return FALSE;
+    }
+  return TRUE;
+}
+
+/* Get the size of the headers, for the linker.  */
+
+static int
+propeller_image_sizeof_headers (bfd *abfd ATTRIBUTE_UNUSED,
+				struct bfd_link_info *info ATTRIBUTE_UNUSED)
+{
+  return 0;
+}
+
+/* Some random definitions for the target vector.  */
+
+#define propeller_image_close_and_cleanup                  _bfd_generic_close_and_cleanup
+#define propeller_image_bfd_free_cached_info               _bfd_generic_bfd_free_cached_info
+#define propeller_image_new_section_hook                   _bfd_generic_new_section_hook
+#define propeller_image_get_section_contents_in_window     _bfd_generic_get_section_contents_in_window
+#define propeller_image_get_symtab_upper_bound             bfd_0l
+#define propeller_image_canonicalize_symtab                ((long (*) (bfd *, asymbol **)) bfd_0l)
+#define propeller_image_make_empty_symbol                  _bfd_generic_make_empty_symbol
+#define propeller_image_print_symbol                       _bfd_nosymbols_print_symbol
+#define propeller_image_get_symbol_info                    _bfd_nosymbols_get_symbol_info
+#define propeller_image_get_symbol_version_string          _bfd_nosymbols_get_symbol_version_string
+#define propeller_image_bfd_is_target_special_symbol       ((bfd_boolean (*) (bfd *, asymbol *)) bfd_false)
+#define propeller_image_bfd_is_local_label_name            _bfd_nosymbols_bfd_is_local_label_name
+#define propeller_image_get_lineno                         _bfd_nosymbols_get_lineno
+#define propeller_image_find_nearest_line                  _bfd_nosymbols_find_nearest_line
+#define propeller_image_find_line                          _bfd_nosymbols_find_line
+#define propeller_image_find_inliner_info                  _bfd_nosymbols_find_inliner_info
+#define propeller_image_bfd_make_debug_symbol              _bfd_nosymbols_bfd_make_debug_symbol
+#define propeller_image_read_minisymbols                   _bfd_nosymbols_read_minisymbols
+#define propeller_image_minisymbol_to_symbol               _bfd_nosymbols_minisymbol_to_symbol
+#define propeller_image_bfd_get_relocated_section_contents bfd_generic_get_relocated_section_contents
+#define propeller_image_bfd_relax_section                  bfd_generic_relax_section
+#define propeller_image_bfd_gc_sections                    bfd_generic_gc_sections
+#define propeller_image_bfd_lookup_section_flags           bfd_generic_lookup_section_flags
+#define propeller_image_bfd_merge_sections                 bfd_generic_merge_sections
+#define propeller_image_bfd_is_group_section               bfd_generic_is_group_section
+#define propeller_image_bfd_discard_group                  bfd_generic_discard_group
+#define propeller_image_section_already_linked             _bfd_generic_section_already_linked
+#define propeller_image_bfd_define_common_symbol           bfd_generic_define_common_symbol
+#define propeller_image_bfd_link_hash_table_create         _bfd_generic_link_hash_table_create
+#define propeller_image_bfd_link_add_symbols               _bfd_generic_link_add_symbols
+#define propeller_image_bfd_link_just_syms                 _bfd_generic_link_just_syms
+#define propeller_image_bfd_copy_link_hash_symbol_type     _bfd_generic_copy_link_hash_symbol_type
+#define propeller_image_bfd_final_link                     _bfd_generic_final_link
+#define propeller_image_bfd_link_split_section             _bfd_generic_link_split_section
+#define propeller_image_bfd_link_check_relocs              _bfd_generic_link_check_relocs
+
+/* The Propeller image target vector.  */
+
+const bfd_target propeller_image_vec =
+{
+  "propeller-image",		/* Name.  */
+  bfd_target_unknown_flavour,
+  BFD_ENDIAN_LITTLE,		/* Target byte order.  */
+  BFD_ENDIAN_LITTLE,		/* Target headers byte order.  */
+  EXEC_P,			/* Object flags.  */
+  (SEC_HAS_CONTENTS | SEC_ALLOC | SEC_LOAD),	/* Section flags.  */
+  0,				/* Leading underscore.  */
+  ' ',				/* AR_pad_char.  */
+  16,				/* AR_max_namelen.  */
+  0,				/* match priority.  */
+  bfd_getl64, bfd_getl_signed_64, bfd_putl64,
+  bfd_getl32, bfd_getl_signed_32, bfd_putl32,
+  bfd_getl16, bfd_getl_signed_16, bfd_putl16,	/* Data.  */
+  bfd_getl64, bfd_getl_signed_64, bfd_putl64,
+  bfd_getl32, bfd_getl_signed_32, bfd_putl32,
+  bfd_getl16, bfd_getl_signed_16, bfd_putl16,	/* Headers. */
+
+  {
+    _bfd_dummy_target,
+    propeller_image_object_p,	/* bfd_check_format.  */
+    _bfd_dummy_target,
+    _bfd_dummy_target,
+  },
+  {
+    bfd_false,
+    propeller_image_mkobject,
+    bfd_false,
+    bfd_false,
+  },
+  {				/* bfd_write_contents.  */
+    bfd_false,
+    propeller_image_write_object_contents,
+    bfd_false,
+    bfd_false,
+  },
+
+  BFD_JUMP_TABLE_GENERIC (propeller_image),
+  BFD_JUMP_TABLE_COPY (_bfd_generic),
+  BFD_JUMP_TABLE_CORE (_bfd_nocore),
+  BFD_JUMP_TABLE_ARCHIVE (_bfd_noarchive),
+  BFD_JUMP_TABLE_SYMBOLS (propeller_image),
+  BFD_JUMP_TABLE_RELOCS (_bfd_norelocs),
+  BFD_JUMP_TABLE_WRITE (propeller_image),
+  BFD_JUMP_TABLE_LINK (propeller_image),
+  BFD_JUMP_TABLE_DYNAMIC (_bfd_nodynamic),
+
+  NULL,
+
+  NULL
+};
@@ -3104,6 +3104,28 @@ ENUM
   BFD_RELOC_PROPELLER_REPSREL
 ENUMDOC
   Propeller PC relative address used as a REPS instruction count.
+ENUM
+  BFD_RELOC_PROPELLER_RELAX
+ENUMDOC
+  Propeller marker at the start of a compressed instruction which the
+  linker may replace with a shorter form.
+ENUM
+  BFD_RELOC_PROPELLER_ALIGN
+ENUMDOC
+  Propeller marker for a code alignment point; the addend is the
+  alignment in bytes.  The linker keeps the padding correct when it
+  shrinks code in front of it.
+ENUM
+  BFD_RELOC_PROPELLER_DIFF8
+ENUMX
+  BFD_RELOC_PROPELLER_DIFF16
+ENUMX
+  BFD_RELOC_PROPELLER_DIFF32
+ENUMDOC
+  Propeller difference of two symbols in code which the linker may
+  relax.  The field holds the difference; the reloc is against the
+  symbol subtracted, and the linker shrinks the field when it deletes
+  code between the two.
 
 ENUM
   BFD_RELOC_I370_D12
@@ -800,6 +800,7 @@ extern const bfd_target powerpc_pei_vec;
 extern const bfd_target powerpc_pei_le_vec;
 extern const bfd_target powerpc_xcoff_vec;
 extern const bfd_target propeller_elf32_vec;
+extern const bfd_target propeller_image_vec;
 extern const bfd_target pru_elf32_vec;
 extern const bfd_target riscv_elf32_vec;
 extern const bfd_target riscv_elf64_vec;
@@ -1309,6 +1310,8 @@ static const bfd_target * const _bfd_target_vector[] =
 	&powerpc_xcoff_vec,
 #endif
 
+	&propeller_image_vec,
+
 	&pru_elf32_vec,
 
 #ifdef BFD64
@@ -7795,6 +7795,293 @@ display_gdb_index (struct dwarf_section *section,
   return 1;
 }
 
+static const char *
+get_IDX_name (unsigned long idx)
+{
+  static char buffer[100];
+
+  switch (idx)
+    {
+    case DW_IDX_compile_unit: return "DW_IDX_compile_unit";
+    case DW_IDX_type_unit:    return "DW_IDX_type_unit";
+    case DW_IDX_die_offset:   return "DW_IDX_die_offset";
+    case DW_IDX_parent:       return "DW_IDX_parent";
+    case DW_IDX_type_hash:    return "DW_IDX_type_hash";
+    default:
+      snprintf (buffer, sizeof (buffer), _("Unknown IDX value: %lx"), idx);
+      return buffer;
+    }
+}
+
+/* Display the DWARF 5 name index in SECTION.  Entries are printed as
+   the tag of the DIE and the values of its index attributes; only the
+   forms which the index attributes are given in practice are
+   understood.  */
+
+static int
+display_debug_names (struct dwarf_section *section, void *file)
+{
+  unsigned char *hdrptr = section->start;
+  unsigned char *section_end = section->start + section->size;
+
+  load_debug_section (str, file);
+
+  printf (_("Contents of the %s section:\n"), section->name);
+
+  while (hdrptr < section_end)
+    {
+      unsigned char *unit_start = hdrptr;
+      unsigned char *unit_end;
+      unsigned char *abbrev_table, *abbrev_end, *entry_pool;
+      unsigned char *name_offsets, *entry_offsets;
+      dwarf_vma unit_length;
+      unsigned int offset_size = 4;
+      unsigned int version, augmentation_size;
+      unsigned int comp_unit_count, type_unit_count, foreign_type_unit_count;
+      unsigned int bucket_count, name_count, abbrev_table_size;
+      unsigned int i, used_buckets;
+
+      SAFE_BYTE_GET_AND_INC (unit_length, hdrptr, 4, section_end);
+      if (unit_length == 0xffffffff)
+	{
+	  offset_size = 8;
+	  SAFE_BYTE_GET_AND_INC (unit_length, hdrptr, 8, section_end);
+	}
+      if (unit_length > (dwarf_vma) (section_end - hdrptr)
+	  || unit_length < 32)
+	{
+	  warn (_("Corrupt unit length (0x%s) in the %s section.\n"),
+		dwarf_vmatoa ("x", unit_length), section->name);
+	  return 0;
+	}
+      unit_end = hdrptr + unit_length;
+
+      SAFE_BYTE_GET_AND_INC (version, hdrptr, 2, unit_end);
+      printf (_("\nVersion %u\n"), version);
+      if (version != 5)
+	{
+	  warn (_("Unsupported version %u.\n"), version);
+	  hdrptr = unit_end;
+	  continue;
+	}
+      hdrptr += 2;		/* padding */
+      SAFE_BYTE_GET_AND_INC (comp_unit_count, hdrptr, 4, unit_end);
+      SAFE_BYTE_GET_AND_INC (type_unit_count, hdrptr, 4, unit_end);
+      SAFE_BYTE_GET_AND_INC (foreign_type_unit_count, hdrptr, 4, unit_end);
+      SAFE_BYTE_GET_AND_INC (bucket_count, hdrptr, 4, unit_end);
+      SAFE_BYTE_GET_AND_INC (name_count, hdrptr, 4, unit_end);
+      SAFE_BYTE_GET_AND_INC (abbrev_table_size, hdrptr, 4, unit_end);
+      SAFE_BYTE_GET_AND_INC (augmentation_size, hdrptr, 4, unit_end);
+
+      if (augmentation_size > (unsigned int) (unit_end - hdrptr))
+	{
+	  warn (_("Corrupt augmentation string size in the %s section.\n"),
+		section->name);
+	  return 0;
+	}
+      printf (_("Augmentation string: \"%.*s\"\n"),
+	      (int) strnlen ((const char *) hdrptr, augmentation_size),
+	      hdrptr);
+      hdrptr += (augmentation_size + 3) & ~3;
+
+      /* the CU, TU and foreign TU lists, the buckets, the hashes, the
+	 name and entry offsets, then the abbreviations */
+      if ((dwarf_vma) (comp_unit_count + type_unit_count) * offset_size
+	  + (dwarf_vma) foreign_type_unit_count * 8
+	  + (dwarf_vma) bucket_count * 4
+	  + (dwarf_vma) name_count * (4 + 2 * offset_size)
+	  + abbrev_table_size
+	  > (dwarf_vma) (unit_end - hdrptr))
+	{
+	  warn (_("Corrupt header in the %s section.\n"), section->name);
+	  return 0;
+	}
+
+      printf (_("\nCU table:\n"));
+      for (i = 0; i < comp_unit_count; i++)
+	{
+	  dwarf_vma offset;
+
+	  SAFE_BYTE_GET_AND_INC (offset, hdrptr, offset_size, unit_end);
+	  printf (_("[%3u] 0x%s\n"), i, dwarf_vmatoa ("x", offset));
+	}
+
+      printf (_("\nTU table:\n"));
+      for (i = 0; i < type_unit_count; i++)
+	{
+	  dwarf_vma offset;
+
+	  SAFE_BYTE_GET_AND_INC (offset, hdrptr, offset_size, unit_end);
+	  printf (_("[%3u] 0x%s\n"), i, dwarf_vmatoa ("x", offset));
+	}
+
+      printf (_("\nForeign TU table:\n"));
+      for (i = 0; i < foreign_type_unit_count; i++)
+	{
+	  dwarf_vma signature;
+
+	  SAFE_BYTE_GET_AND_INC (signature, hdrptr, 8, unit_end);
+	  printf (_("[%3u] "), i);
+	  print_dwarf_vma (signature, 8);
+	  printf ("\n");
+	}
+
+      used_buckets = 0;
+      for (i = 0; i < bucket_count; i++)
+	{
+	  unsigned int bucket;
+
+	  SAFE_BYTE_GET_AND_INC (bucket, hdrptr, 4, unit_end);
+	  if (bucket != 0)
+	    used_buckets++;
+	}
+      printf (_("\nUsed %u of %u buckets.\n"), used_buckets, bucket_count);
+
+      hdrptr += name_count * 4;	/* hashes */
+      name_offsets = hdrptr;
+      entry_offsets = name_offsets + name_count * offset_size;
+      abbrev_table = entry_offsets + name_count * offset_size;
+      abbrev_end = abbrev_table + abbrev_table_size;
+      entry_pool = abbrev_end;
+
+      printf (_("\nAbbreviations:\n"));
+      for (hdrptr = abbrev_table; hdrptr < abbrev_end; )
+	{
+	  unsigned int bytes_read;
+	  dwarf_vma code, tag, idx, form;
+
+	  code = read_uleb128 (hdrptr, &bytes_read, abbrev_end);
+	  hdrptr += bytes_read;
+	  if (code == 0)
+	    break;
+	  tag = read_uleb128 (hdrptr, &bytes_read, abbrev_end);
+	  hdrptr += bytes_read;
+	  printf ("  %s %s", dwarf_vmatoa ("u", code), get_TAG_name (tag));
+	  do
+	    {
+	      idx = read_uleb128 (hdrptr, &bytes_read, abbrev_end);
+	      hdrptr += bytes_read;
+	      form = read_uleb128 (hdrptr, &bytes_read, abbrev_end);
+	      hdrptr += bytes_read;
+	      if (idx != 0)
+		printf (" %s (%s)", get_IDX_name (idx), get_FORM_name (form));
+	    }
+	  while ((idx != 0 || form != 0) && hdrptr < abbrev_end);
+	  printf ("\n");
+	}
+
+      printf (_("\nSymbol table:\n"));
+      for (i = 0; i < name_count; i++)
+	{
+	  dwarf_vma name_offset, entry_offset;
+	  unsigned char *entry;
+
+	  SAFE_BYTE_GET (name_offset, name_offsets + i * offset_size,
+			 offset_size, unit_end);
+	  SAFE_BYTE_GET (entry_offset, entry_offsets + i * offset_size,
+			 offset_size, unit_end);
+	  printf ("[%3u] %s:", i + 1, fetch_indirect_string (name_offset));
+
+	  if (entry_offset >= (dwarf_vma) (unit_end - entry_pool))
+	    {
+	      printf (_(" <corrupt entry offset: 0x%s>\n"),
+		      dwarf_vmatoa ("x", entry_offset));
+	      continue;
+	    }
+	  entry = entry_pool + entry_offset;
+	  for (;;)
+	    {
+	      unsigned int bytes_read;
+	      unsigned char *abbrev_ptr;
+	      dwarf_vma code, this_code, tag, idx, form, value;
+
+	      code = read_uleb128 (entry, &bytes_read, unit_end);
+	      entry += bytes_read;
+	      if (code == 0)
+		break;
+
+	      /* find the abbreviation */
+	      for (abbrev_ptr = abbrev_table; abbrev_ptr < abbrev_end; )
+		{
+		  this_code = read_uleb128 (abbrev_ptr, &bytes_read,
+					    abbrev_end);
+		  abbrev_ptr += bytes_read;
+		  if (this_code == 0 || this_code == code)
+		    break;
+		  read_uleb128 (abbrev_ptr, &bytes_read, abbrev_end);
+		  abbrev_ptr += bytes_read;
+		  do
+		    {
+		      idx = read_uleb128 (abbrev_ptr, &bytes_read, abbrev_end);
+		      abbrev_ptr += bytes_read;
+		      form = read_uleb128 (abbrev_ptr, &bytes_read, abbrev_end);
+		      abbrev_ptr += bytes_read;
+		    }
+		  while ((idx != 0 || form != 0) && abbrev_ptr < abbrev_end);
+		}
+	      if (abbrev_ptr >= abbrev_end || this_code != code)
+		{
+		  printf (_(" <unknown abbreviation %s>"),
+			  dwarf_vmatoa ("u", code));
+		  break;
+		}
+
+	      tag = read_uleb128 (abbrev_ptr, &bytes_read, abbrev_end);
+	      abbrev_ptr += bytes_read;
+	      printf (" %s", get_TAG_name (tag));
+	      for (;;)
+		{
+		  idx = read_uleb128 (abbrev_ptr, &bytes_read, abbrev_end);
+		  abbrev_ptr += bytes_read;
+		  form = read_uleb128 (abbrev_ptr, &bytes_read, abbrev_end);
+		  abbrev_ptr += bytes_read;
+		  if (idx == 0 || abbrev_ptr > abbrev_end)
+		    break;
+		  switch (form)
+		    {
+		    case DW_FORM_data1:
+		    case DW_FORM_ref1:
+		    case DW_FORM_flag:
+		      SAFE_BYTE_GET_AND_INC (value, entry, 1, unit_end);
+		      break;
+		    case DW_FORM_data2:
+		    case DW_FORM_ref2:
+		      SAFE_BYTE_GET_AND_INC (value, entry, 2, unit_end);
+		      break;
+		    case DW_FORM_data4:
+		    case DW_FORM_ref4:
+		      SAFE_BYTE_GET_AND_INC (value, entry, 4, unit_end);
+		      break;
+		    case DW_FORM_data8:
+		    case DW_FORM_ref8:
+		    case DW_FORM_ref_sig8:
+		      SAFE_BYTE_GET_AND_INC (value, entry, 8, unit_end);
+		      break;
+		    case DW_FORM_udata:
+		    case DW_FORM_ref_udata:
+		      value = read_uleb128 (entry, &bytes_read, unit_end);
+		      entry += bytes_read;
+		      break;
+		    default:
+		      printf (_(" <unsupported form %s>\n"), get_FORM_name (form));
+		      goto next_name;
+		    }
+		  printf (" %s=0x%s", get_IDX_name (idx), dwarf_vmatoa ("x", value));
+		}
+	    }
+	  printf ("\n");
+	next_name:
+	  ;
+	}
+
+      hdrptr = unit_end;
+      if (hdrptr <= unit_start)
+	break;
+    }
+
+  return 1;
+}
+
 /* Pre-allocate enough space for the CU/TU sets needed.  */
 
 static void
@@ -8558,6 +8845,8 @@ struct dwarf_section_display debug_displays[] =
     display_debug_not_supported, NULL,		FALSE },
   { { ".gdb_index",	    "",			NULL, NULL, 0, 0, 0, NULL, 0, NULL },
     display_gdb_index,      &do_gdb_index,	FALSE },
+  { { ".debug_names",	    ".zdebug_names",	NULL, NULL, 0, 0, 0, NULL, 0, NULL },
+    display_debug_names,    &do_gdb_index,	FALSE },
   { { ".trace_info",	    "",			NULL, NULL, 0, 0, trace_abbrev, NULL, 0, NULL },
     display_trace_info,	    &do_trace_info,	TRUE },
   { { ".trace_abbrev",	    "",			NULL, NULL, 0, 0, 0, NULL, 0, NULL },
@@ -332,6 +332,7 @@ enum command_line_switch
   OPTION_PREFIX_ALLOC_SECTIONS,
   OPTION_PREFIX_SECTIONS,
   OPTION_PREFIX_SYMBOLS,
+  OPTION_PROPELLER_DELTA,
   OPTION_PURE,
   OPTION_READONLY_TEXT,
   OPTION_REDEFINE_SYM,
@@ -463,6 +464,7 @@ static struct option copy_options[] =
   {"prefix-sections", required_argument, 0, OPTION_PREFIX_SECTIONS},
   {"prefix-symbols", required_argument, 0, OPTION_PREFIX_SYMBOLS},
   {"preserve-dates", no_argument, 0, 'p'},
+  {"propeller-delta", required_argument, 0, OPTION_PROPELLER_DELTA},
   {"pure", no_argument, 0, OPTION_PURE},
   {"readonly-text", no_argument, 0, OPTION_READONLY_TEXT},
   {"redefine-sym", required_argument, 0, OPTION_REDEFINE_SYM},
@@ -516,6 +518,11 @@ extern unsigned int _bfd_srec_len;
    on by the --srec-forceS3 command line switch.  */
 extern bfd_boolean _bfd_srec_forceS3;
 
+/* The image that a propeller-image output file is a delta against.
+   This variable is defined in bfd/propeller-image.c and can be set
+   by the --propeller-delta parameter.  */
+extern const char *_bfd_propeller_image_base;
+
 /* Forward declarations.  */
 static void setup_section (bfd *, asection *, void *);
 static void setup_bfd_headers (bfd *, bfd *);
@@ -617,6 +624,8 @@ copy_usage (FILE *stream, int exit_status)
                                      listed in <file>\n\
      --srec-len <number>           Restrict the length of generated Srecords\n\
      --srec-forceS3                Restrict the type of generated Srecords to S3\n\
+     --propeller-delta <file>      Only write the pages of a propeller-image that\n\
+                                     differ from <file>\n\
      --strip-symbols <file>        -N for all symbols listed in <file>\n\
      --strip-unneeded-symbols <file>\n\
                                    --strip-unneeded-symbol for all symbols listed\n\
@@ -5006,6 +5015,10 @@ copy_main (int argc, char *argv[])
 	  _bfd_srec_forceS3 = TRUE;
 	  break;
 
+	case OPTION_PROPELLER_DELTA:
+	  _bfd_propeller_image_base = optarg;
+	  break;
+
 	case OPTION_STRIP_SYMBOLS:
 	  add_specific_symbols (optarg, strip_specific_htab);
 	  break;
@@ -2437,6 +2437,8 @@ disassemble_data (bfd *abfd)
 
   bfd_map_over_sections (abfd, disassemble_section, & disasm_info);
 
+  disassemble_free_target (& disasm_info);
+
   if (aux.dynrelbuf != NULL)
     free (aux.dynrelbuf);
   free (sorted_syms);
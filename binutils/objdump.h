@@ -46,6 +46,8 @@ struct objdump_private_desc
 /* ELF32_AVR specific target.  */
 extern const struct objdump_private_desc objdump_private_desc_elf32_avr;
 
+extern const struct objdump_private_desc objdump_private_desc_elf32_propeller;
+
 /* XCOFF specific target.  */
 extern const struct objdump_private_desc objdump_private_desc_xcoff;
 
@@ -0,0 +1,1159 @@
+/* od-elf32_propeller.c -- dump information about a Propeller elf object file.
+   Copyright (C) 2017 Free Software Foundation, Inc.
+
+   This file is part of GNU Binutils.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+#include "sysdep.h"
+#include "bfd.h"
+#include "objdump.h"
+#include "bucomm.h"
+#include "libiberty.h"
+#include "elf-bfd.h"
+#include "elf/propeller.h"
+#include "opcode/propeller.h"
+
+/* Index of the options in the options[] array.  */
+#define OPT_TIMING 0
+
+/* List of actions.  */
+static struct objdump_private_option options[] =
+  {
+    { "timing", 0 },
+    { NULL, 0 }
+  };
+
+/* Display help.  */
+
+static void
+elf32_propeller_help (FILE *stream)
+{
+  fprintf (stream, _("\
+For Propeller ELF files:\n\
+  timing      Display best and worst case cycles of each basic block\n\
+"));
+}
+
+/* Return TRUE if ABFD is handled.  */
+
+static int
+elf32_propeller_filter (bfd *abfd)
+{
+  return bfd_get_flavour (abfd) == bfd_target_elf_flavour
+    && bfd_get_arch (abfd) == bfd_arch_propeller;
+}
+
+/*
+ * Static timing of P1 code.
+ *
+ * Native instructions take 4 cycles; hub instructions wait for the
+ * cog's hub window, which comes round every 16 cycles, and then take
+ * 8 more, so they cost 8 to 23 cycles depending on where the cog is
+ * relative to its window.  Since the cost of every instruction is
+ * fixed once that phase is known, a basic block is timed for each of
+ * the 16 phases it may be entered with (and for each way conditional
+ * instructions may go), keeping the best and worst total per phase.
+ *
+ * LMM and CMM code is timed through a model of the kernel that
+ * interprets it: every LMM instruction is fetched with a rdlong and
+ * an add, every CMM byte with a rdbyte and an add, and CMM forms are
+ * then dispatched and decoded by a handler of a few instructions.
+ * Calls of the kernel routines (__LMM_CALL, __LMM_MVI_rN, __MULSI ...)
+ * are counted with the approximate cost of their PASM code; the cost
+ * of called functions is not included.  The kernel numbers are
+ * estimates of the propgcc kernels, not measurements.
+ */
+
+/* Kernel model, in instructions (4 cycles each).  */
+#define CMM_DISPATCH_INSNS	4	/* jump through the prefix table */
+#define LMM_LOOP_INSNS		1	/* the add pc,#4 after the fetch */
+
+enum timing_mode
+{
+  MODE_COG,
+  MODE_LMM,
+  MODE_CMM
+};
+
+enum kernel_helper
+{
+  HELPER_NONE,
+  HELPER_JMP,
+  HELPER_CALL,
+  HELPER_MVI,
+  HELPER_FCACHE,
+  HELPER_PUSHM,
+  HELPER_POPM,
+  HELPER_POPRET,
+  HELPER_RET,
+  HELPER_MUL,
+  HELPER_UDIV,
+  HELPER_DIV
+};
+
+static const struct
+{
+  const char *name;
+  enum kernel_helper helper;
+} kernel_helpers[] =
+  {
+    { "__LMM_JMP", HELPER_JMP },
+    { "__LMM_CALL", HELPER_CALL },
+    { "__LMM_FCACHE_LOAD", HELPER_FCACHE },
+    { "__LMM_PUSHM", HELPER_PUSHM },
+    { "__LMM_POPM", HELPER_POPM },
+    { "__LMM_POPRET", HELPER_POPRET },
+    { "__LMM_RET", HELPER_RET },
+    { "__MULSI", HELPER_MUL },
+    { "__UDIVSI", HELPER_UDIV },
+    { "__DIVSI", HELPER_DIV },
+    { NULL, HELPER_NONE }
+  };
+
+/* Handler instructions of the CMM kernel for each prefix, after the
+   dispatch and not counting the operation itself.  */
+static const int cmm_handler_insns[16] =
+  {
+    2,	/* PREFIX_MACRO: second dispatch */
+    6,	/* PREFIX_REGREG */
+    5,	/* PREFIX_REGIMM4 */
+    7,	/* PREFIX_REGIMM12 */
+    5,	/* PREFIX_BRW */
+    8,	/* PREFIX_MVI */
+    4,	/* PREFIX_MVIW */
+    4,	/* PREFIX_BRS */
+    3,	/* PREFIX_SKIP2 */
+    3,	/* PREFIX_SKIP3 */
+    2,	/* PREFIX_MVIB */
+    2,	/* PREFIX_ZEROREG */
+    4,	/* PREFIX_LEASP */
+    10,	/* PREFIX_XMOVREG */
+    9,	/* PREFIX_XMOVIMM */
+    6	/* PREFIX_PACK_NATIVE */
+  };
+
+/* Cycles of a block for each hub window phase it may be entered at.  */
+struct timing
+{
+  unsigned char valid[16];
+  unsigned long lo[16];
+  unsigned long hi[16];
+};
+
+/* What we know about the code being timed.  */
+struct timing_ctx
+{
+  bfd *abfd;
+  asection *sec;
+  bfd_byte *contents;
+  bfd_size_type size;
+  arelent **relocs;
+  long num_relocs;
+  enum kernel_helper cog_helper[512];
+  enum timing_mode mode;
+  /* end of fcache'd native code inside LMM/CMM code */
+  bfd_vma native_end;
+  /* the last immediate moved into a register, for __LMM_PUSHM */
+  unsigned int last_imm;
+  /* the next CMM instruction may be skipped */
+  int skip_next;
+  /* counts of the current block */
+  int hubops;
+  int unbounded;
+};
+
+/* How an instruction changes the flow of control.  */
+struct flow
+{
+  int ends;			/* ends the basic block */
+  int has_target;
+  bfd_vma target;		/* section offset of the branch target */
+};
+
+static void
+timing_init (struct timing *t)
+{
+  int p;
+
+  for (p = 0; p < 16; p++)
+    {
+      t->valid[p] = 1;
+      t->lo[p] = t->hi[p] = 0;
+    }
+}
+
+/* Merge the outcomes in B into A.  */
+static void
+timing_merge (struct timing *a, const struct timing *b)
+{
+  int p;
+
+  for (p = 0; p < 16; p++)
+    {
+      if (!b->valid[p])
+	continue;
+      if (!a->valid[p])
+	{
+	  a->valid[p] = 1;
+	  a->lo[p] = b->lo[p];
+	  a->hi[p] = b->hi[p];
+	  continue;
+	}
+      if (b->lo[p] < a->lo[p])
+	a->lo[p] = b->lo[p];
+      if (b->hi[p] > a->hi[p])
+	a->hi[p] = b->hi[p];
+    }
+}
+
+/* Advance by CYCLES if HUB is zero, else by a hub access.  */
+static void
+timing_step (struct timing *t, int cycles, int hub)
+{
+  struct timing n;
+  int p, c, np;
+
+  memset (&n, 0, sizeof (n));
+  for (p = 0; p < 16; p++)
+    {
+      if (!t->valid[p])
+	continue;
+      c = hub ? 8 + ((16 - p) & 15) : cycles;
+      np = (p + c) & 15;
+      if (!n.valid[np])
+	{
+	  n.valid[np] = 1;
+	  n.lo[np] = t->lo[p] + c;
+	  n.hi[np] = t->hi[p] + c;
+	}
+      else
+	{
+	  if (t->lo[p] + c < n.lo[np])
+	    n.lo[np] = t->lo[p] + c;
+	  if (t->hi[p] + c > n.hi[np])
+	    n.hi[np] = t->hi[p] + c;
+	}
+    }
+  *t = n;
+}
+
+static void
+timing_insns (struct timing *t, int n)
+{
+  if (t != NULL && n > 0)
+    timing_step (t, 4 * n, 0);
+}
+
+static void
+timing_hub (struct timing_ctx *ctx, struct timing *t)
+{
+  if (t == NULL)
+    return;
+  ctx->hubops++;
+  timing_step (t, 0, 1);
+}
+
+/* Index of the first relocation at or after section offset OFF.  */
+static long
+first_reloc (struct timing_ctx *ctx, bfd_vma off)
+{
+  long lo = 0, hi = ctx->num_relocs;
+
+  while (lo < hi)
+    {
+      long mid = (lo + hi) / 2;
+
+      if (ctx->relocs[mid]->address < off)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+/* The relocation of TYPE at section offset OFF, if there is one.  */
+static arelent *
+find_reloc (struct timing_ctx *ctx, bfd_vma off, unsigned int type)
+{
+  long i;
+
+  for (i = first_reloc (ctx, off);
+       i < ctx->num_relocs && ctx->relocs[i]->address == off; i++)
+    if (ctx->relocs[i]->howto != NULL
+	&& ctx->relocs[i]->howto->type == type
+	&& ctx->relocs[i]->sym_ptr_ptr != NULL
+	&& *ctx->relocs[i]->sym_ptr_ptr != NULL)
+      return ctx->relocs[i];
+  return NULL;
+}
+
+/* Section offset of the target of relocation REL, plus BIAS, if it is
+   in this section.  */
+static int
+reloc_target (struct timing_ctx *ctx, arelent *rel, bfd_vma bias,
+	      bfd_vma *target)
+{
+  asymbol *sym = *rel->sym_ptr_ptr;
+  bfd_vma off;
+
+  if (sym->section != ctx->sec)
+    return 0;
+  off = sym->value + rel->addend + bias;
+  if (off >= ctx->size)
+    return 0;
+  *target = off;
+  return 1;
+}
+
+/* Does the instruction at OFF, with destination field DST, write the
+   LMM pc?  In object files the pc is a relocation against the
+   kernel's label.  */
+static int
+writes_pc (struct timing_ctx *ctx, bfd_vma off, unsigned int dst)
+{
+  arelent *rel = find_reloc (ctx, off, R_PROPELLER_DST);
+
+  if (rel != NULL)
+    return strcmp (bfd_asymbol_name (*rel->sym_ptr_ptr), "pc") == 0;
+  return dst == 17;
+}
+
+/* Kernel routine at cog address COG, or called by the instruction at
+   section offset OFF.  */
+static enum kernel_helper
+find_helper (struct timing_ctx *ctx, bfd_vma off, unsigned int cog)
+{
+  long lo = first_reloc (ctx, off);
+
+  for (; lo < ctx->num_relocs && ctx->relocs[lo]->address == off; lo++)
+    {
+      arelent *rel = ctx->relocs[lo];
+      int i;
+
+      if (rel->sym_ptr_ptr == NULL || *rel->sym_ptr_ptr == NULL)
+	continue;
+      for (i = 0; kernel_helpers[i].name != NULL; i++)
+	if (strcmp (bfd_asymbol_name (*rel->sym_ptr_ptr),
+		    kernel_helpers[i].name) == 0)
+	  return kernel_helpers[i].helper;
+      if (strncmp (bfd_asymbol_name (*rel->sym_ptr_ptr), "__LMM_MVI_", 10)
+	  == 0)
+	return HELPER_MVI;
+      return HELPER_NONE;
+    }
+  return ctx->cog_helper[cog & 511];
+}
+
+/* Section offset of hub address ADDR, the long at OFF, if it is known
+   and in this section.  */
+static int
+hub_target (struct timing_ctx *ctx, bfd_vma off, bfd_vma addr,
+	    bfd_vma *target)
+{
+  long i;
+
+  for (i = 0; i < ctx->num_relocs; i++)
+    if (ctx->relocs[i]->address == off)
+      {
+	arelent *rel = ctx->relocs[i];
+	asymbol *sym = rel->sym_ptr_ptr ? *rel->sym_ptr_ptr : NULL;
+
+	if (sym == NULL || sym->section != ctx->sec)
+	  return 0;
+	addr = bfd_asymbol_value (sym) + rel->addend;
+	break;
+      }
+  if (addr < ctx->sec->vma || addr >= ctx->sec->vma + ctx->size)
+    return 0;
+  *target = addr - ctx->sec->vma;
+  return 1;
+}
+
+/* Time kernel routine H; ARG is its argument where it takes one.  */
+static void
+time_helper (struct timing_ctx *ctx, struct timing *t,
+	     enum kernel_helper h, unsigned int arg)
+{
+  struct timing alt;
+  unsigned int i, n;
+
+  if (t == NULL)
+    return;
+  switch (h)
+    {
+    case HELPER_JMP:
+      timing_hub (ctx, t);
+      timing_insns (t, 1);
+      break;
+    case HELPER_CALL:
+      timing_hub (ctx, t);
+      timing_insns (t, 4);
+      break;
+    case HELPER_MVI:
+      timing_hub (ctx, t);
+      timing_insns (t, 2);
+      break;
+    case HELPER_FCACHE:
+      /* nothing to load if the block is still in the cache */
+      alt = *t;
+      timing_insns (&alt, 4);
+      timing_hub (ctx, t);
+      timing_insns (t, 2);
+      n = (arg + 3) / 4;
+      for (i = 0; i < n; i++)
+	{
+	  timing_hub (ctx, t);
+	  timing_insns (t, 2);
+	}
+      timing_merge (t, &alt);
+      break;
+    case HELPER_PUSHM:
+    case HELPER_POPM:
+    case HELPER_POPRET:
+      n = (arg >> 4) & 15;
+      timing_insns (t, 2);
+      for (i = 0; i < n; i++)
+	{
+	  timing_hub (ctx, t);
+	  timing_insns (t, 2);
+	}
+      if (h == HELPER_POPRET)
+	timing_insns (t, 1);
+      break;
+    case HELPER_RET:
+      timing_insns (t, 1);
+      break;
+    case HELPER_MUL:
+      /* one to 32 rounds of shift and add */
+      alt = *t;
+      timing_insns (&alt, 2 + 4);
+      timing_insns (t, 2 + 4 * 32);
+      timing_merge (t, &alt);
+      break;
+    case HELPER_UDIV:
+      timing_insns (t, 4 + 4 * 32);
+      break;
+    case HELPER_DIV:
+      timing_insns (t, 8 + 4 * 32);
+      break;
+    default:
+      break;
+    }
+}
+
+/* Time the execution of native instruction INSN.  */
+static void
+time_native (struct timing_ctx *ctx, struct timing *t, unsigned long insn)
+{
+  unsigned int op = insn >> 26;
+  unsigned int cond = (insn >> 18) & 0xf;
+  struct timing skip;
+
+  if (t == NULL)
+    return;
+  if (cond == 0)
+    {
+      timing_insns (t, 1);
+      return;
+    }
+  skip = *t;
+  if (op <= 3)
+    timing_hub (ctx, t);
+  else if (op >= 0x39 && op <= 0x3b)
+    {
+      /* 4 cycles if the jump is taken, else 8 */
+      struct timing taken = *t;
+
+      timing_insns (&taken, 1);
+      timing_insns (t, 2);
+      timing_merge (t, &taken);
+    }
+  else if (op >= 0x3c && op <= 0x3e)
+    {
+      timing_step (t, 6, 0);
+      ctx->unbounded = 1;
+    }
+  else if (op == 0x3f)
+    {
+      timing_step (t, 7, 0);
+      ctx->unbounded = 1;
+    }
+  else
+    timing_insns (t, 1);
+  if (cond != 0xf)
+    {
+      timing_insns (&skip, 1);
+      timing_merge (t, &skip);
+    }
+}
+
+/* Branches of native instruction INSN at OFF, executing from cog
+   memory.  */
+static void
+flow_native (struct timing_ctx *ctx, bfd_vma off, unsigned long insn,
+	     struct flow *fl)
+{
+  unsigned int op = insn >> 26;
+  int wr = (insn >> 23) & 1;
+  int imm = (insn >> 22) & 1;
+  unsigned int cond = (insn >> 18) & 0xf;
+  bfd_vma addr = (insn & 0x1ff) * 4;
+
+  if (cond == 0)
+    return;
+  if ((op == 0x17 && !wr) || (op >= 0x39 && op <= 0x3b))
+    {
+      arelent *rel;
+
+      fl->ends = 1;
+      if (!imm || ctx->mode != MODE_COG || off >= ctx->native_end
+	  || ctx->native_end != ctx->size)
+	return;
+      /* code in cog sections is linked at its cog address */
+      if ((rel = find_reloc (ctx, off, R_PROPELLER_SRC)) != NULL)
+	fl->has_target = reloc_target (ctx, rel, 0, &fl->target);
+      else if (addr >= ctx->sec->vma && addr < ctx->sec->vma + ctx->size)
+	{
+	  fl->has_target = 1;
+	  fl->target = addr - ctx->sec->vma;
+	}
+    }
+}
+
+/* Decode the instruction at OFF, add its cycles to T if that is not
+   NULL and describe its flow in FL.  Returns its length.  */
+static unsigned int
+time_insn (struct timing_ctx *ctx, bfd_vma off, struct timing *t,
+	   struct flow *fl)
+{
+  bfd_byte *p = ctx->contents + off;
+  bfd_size_type left = ctx->size - off;
+  unsigned long insn;
+  unsigned int op, prefix, low, len, dst, cond, s;
+  enum kernel_helper h;
+  struct timing skip;
+  int i;
+
+  memset (fl, 0, sizeof (*fl));
+
+  if (ctx->mode == MODE_COG || off < ctx->native_end)
+    {
+      if (left < 4)
+	return left;
+      insn = bfd_getl32 (p);
+      time_native (ctx, t, insn);
+      flow_native (ctx, off, insn, fl);
+      return 4;
+    }
+
+  if (ctx->mode == MODE_LMM)
+    {
+      if (left < 4)
+	return left;
+      insn = bfd_getl32 (p);
+      op = insn >> 26;
+      dst = (insn >> 9) & 0x1ff;
+      cond = (insn >> 18) & 0xf;
+      s = insn & 0x1ff;
+      len = 4;
+
+      /* fetch: rdlong ins,pc / add pc,#4 */
+      timing_hub (ctx, t);
+      timing_insns (t, LMM_LOOP_INSNS);
+
+      if (op == 0x17 && ((insn >> 22) & 1) && !((insn >> 23) & 1)
+	  && cond != 0
+	  && (h = find_helper (ctx, off, s)) != HELPER_NONE)
+	{
+	  unsigned long arg = left >= 8 ? bfd_getl32 (p + 4) : 0;
+
+	  if (t != NULL)
+	    {
+	      skip = *t;
+	      timing_insns (t, 1);
+	      time_helper (ctx, t, h,
+			   h == HELPER_FCACHE ? arg : ctx->last_imm);
+	      if (cond != 0xf)
+		{
+		  timing_insns (&skip, 1);
+		  timing_merge (t, &skip);
+		}
+	    }
+	  switch (h)
+	    {
+	    case HELPER_JMP:
+	      fl->ends = 1;
+	      fl->has_target = hub_target (ctx, off + 4, arg, &fl->target);
+	      return 8;
+	    case HELPER_CALL:
+	    case HELPER_MVI:
+	      return 8;
+	    case HELPER_FCACHE:
+	      /* the code that follows runs from the cog */
+	      ctx->native_end = off + 8 + ((arg + 3) & ~3);
+	      if (ctx->native_end > ctx->size)
+		ctx->native_end = ctx->size;
+	      fl->ends = 1;
+	      return 8;
+	    case HELPER_POPRET:
+	    case HELPER_RET:
+	      fl->ends = 1;
+	      return 4;
+	    default:
+	      return 4;
+	    }
+	}
+
+      time_native (ctx, t, insn);
+      if (cond == 0)
+	return len;
+      if (op == 0x28 && ((insn >> 22) & 1))
+	ctx->last_imm = s;
+      if (op == 0x17 && !((insn >> 23) & 1))
+	fl->ends = 1;
+      else if (((insn >> 23) & 1) && writes_pc (ctx, off, dst))
+	{
+	  /* writes to the pc are the LMM branches: brs is add or sub
+	     pc,#n, lret is mov pc,lr */
+	  arelent *rel;
+
+	  fl->ends = 1;
+	  if ((rel = find_reloc (ctx, off, R_PROPELLER_PCREL10)) != NULL)
+	    /* the addend is relative to the next instruction */
+	    fl->has_target = reloc_target (ctx, rel, 4, &fl->target);
+	  else if ((op == 0x20 || op == 0x21) && ((insn >> 22) & 1))
+	    {
+	      bfd_vma next = off + 4;
+
+	      if (op == 0x20 ? next + s <= ctx->size : s <= next)
+		{
+		  fl->has_target = 1;
+		  fl->target = op == 0x20 ? next + s : next - s;
+		}
+	    }
+	}
+      return len;
+    }
+
+  /* CMM */
+  op = p[0];
+  prefix = op & 0xf0;
+  low = op & 0x0f;
+  switch (prefix)
+    {
+    case PREFIX_MACRO:
+      switch (low)
+	{
+	case MACRO_PUSHM: case MACRO_POPM: case MACRO_POPRET:
+	case MACRO_MVREG: case MACRO_ADDSP:
+	  len = 2;
+	  break;
+	case MACRO_LCALL: case MACRO_XMVREG: case MACRO_FCACHE:
+	  len = 3;
+	  break;
+	case MACRO_LJMP: case MACRO_NATIVE:
+	  len = 5;
+	  break;
+	default:
+	  len = 1;
+	  break;
+	}
+      break;
+    case PREFIX_REGREG: case PREFIX_REGIMM4: case PREFIX_BRS:
+    case PREFIX_MVIB: case PREFIX_LEASP:
+      len = 2;
+      break;
+    case PREFIX_REGIMM12: case PREFIX_BRW: case PREFIX_MVIW:
+    case PREFIX_XMOVREG: case PREFIX_XMOVIMM:
+      len = 3;
+      break;
+    case PREFIX_MVI:
+      len = 5;
+      break;
+    case PREFIX_PACK_NATIVE:
+      len = 4;
+      break;
+    default:			/* SKIP2, SKIP3, ZEROREG */
+      len = 1;
+      break;
+    }
+  if (len > left)
+    return left;
+
+  if (t != NULL)
+    {
+      /* fetch every byte, then dispatch on the prefix */
+      for (i = 0; i < (int) len; i++)
+	{
+	  timing_hub (ctx, t);
+	  timing_insns (t, 1);
+	}
+      timing_insns (t, CMM_DISPATCH_INSNS + cmm_handler_insns[prefix >> 4]);
+    }
+
+  switch (prefix)
+    {
+    case PREFIX_MACRO:
+      switch (low)
+	{
+	case MACRO_RET:
+	  timing_insns (t, 1);
+	  fl->ends = 1;
+	  break;
+	case MACRO_PUSHM:
+	case MACRO_POPM:
+	case MACRO_POPRET:
+	  time_helper (ctx, t, low == MACRO_PUSHM ? HELPER_PUSHM
+		       : low == MACRO_POPM ? HELPER_POPM : HELPER_POPRET, p[1]);
+	  fl->ends = low == MACRO_POPRET;
+	  break;
+	case MACRO_LCALL:
+	  timing_insns (t, 3);
+	  break;
+	case MACRO_MUL:
+	  time_helper (ctx, t, HELPER_MUL, 0);
+	  break;
+	case MACRO_UDIV:
+	  time_helper (ctx, t, HELPER_UDIV, 0);
+	  break;
+	case MACRO_DIV:
+	  time_helper (ctx, t, HELPER_DIV, 0);
+	  break;
+	case MACRO_MVREG:
+	case MACRO_ADDSP:
+	  timing_insns (t, 3);
+	  break;
+	case MACRO_XMVREG:
+	  timing_insns (t, 6);
+	  break;
+	case MACRO_LJMP:
+	  timing_insns (t, 2);
+	  fl->ends = 1;
+	  fl->has_target = hub_target (ctx, off + 1, bfd_getl32 (p + 1),
+				       &fl->target);
+	  break;
+	case MACRO_FCACHE:
+	  {
+	    unsigned int count = bfd_getl16 (p + 1);
+	    bfd_vma start = (off + len + 3) & ~(bfd_vma) 3;
+
+	    time_helper (ctx, t, HELPER_FCACHE, count);
+	    ctx->native_end = start + ((count + 3) & ~3);
+	    if (ctx->native_end > ctx->size)
+	      ctx->native_end = ctx->size;
+	    fl->ends = 1;
+	    if (start > ctx->size)
+	      start = ctx->size;
+	    return start - off;
+	  }
+	case MACRO_NATIVE:
+	  timing_insns (t, 2);
+	  time_native (ctx, t, bfd_getl32 (p + 1));
+	  break;
+	default:
+	  break;
+	}
+      break;
+
+    case PREFIX_REGREG:
+    case PREFIX_REGIMM4:
+    case PREFIX_REGIMM12:
+    case PREFIX_XMOVREG:
+    case PREFIX_XMOVIMM:
+      {
+	unsigned int xop;
+
+	if (prefix == PREFIX_REGIMM12)
+	  xop = bfd_getl16 (p + 1) >> 12;
+	else
+	  xop = p[len - 1] & 15;
+	if (xop >= XOP_RDB)
+	  timing_hub (ctx, t);
+	else
+	  timing_insns (t, 1);
+	if (prefix == PREFIX_REGIMM4 && xop == XOP_ADD)
+	  ctx->last_imm = p[1] >> 4;
+      }
+      break;
+
+    case PREFIX_BRW:
+    case PREFIX_BRS:
+      {
+	bfd_signed_vma rel = prefix == PREFIX_BRW
+	  ? (bfd_signed_vma) (short) bfd_getl16 (p + 1)
+	  : (bfd_signed_vma) (signed char) p[1];
+	bfd_vma target = off + len + rel;
+
+	fl->ends = 1;
+	if (target < ctx->size)
+	  {
+	    fl->has_target = 1;
+	    fl->target = target;
+	  }
+      }
+      break;
+
+    case PREFIX_MVIB:
+      ctx->last_imm = p[1];
+      break;
+
+    case PREFIX_SKIP2:
+    case PREFIX_SKIP3:
+      ctx->skip_next = 1;
+      return len;
+
+    case PREFIX_PACK_NATIVE:
+      {
+	unsigned long v = p[1] | (p[2] << 8) | ((unsigned long) p[3] << 16);
+
+	time_native (ctx, t, (v & 0x3ffff) | (((v >> 18) & 0x3f) << 26)
+		     | (0xfUL << 18) | ((unsigned long) low << 22));
+      }
+      break;
+
+    default:
+      break;
+    }
+  return len;
+}
+
+static int
+compare_symbols (const void *a, const void *b)
+{
+  const asymbol *sa = *(const asymbol **) a;
+  const asymbol *sb = *(const asymbol **) b;
+
+  if (bfd_asymbol_value (sa) != bfd_asymbol_value (sb))
+    return bfd_asymbol_value (sa) < bfd_asymbol_value (sb) ? -1 : 1;
+  /* global symbols name a region before local labels at the same
+     address */
+  return ((sb->flags & (BSF_GLOBAL | BSF_FUNCTION)) != 0)
+    - ((sa->flags & (BSF_GLOBAL | BSF_FUNCTION)) != 0);
+}
+
+static int
+compare_relocs (const void *a, const void *b)
+{
+  const arelent *ra = *(const arelent **) a;
+  const arelent *rb = *(const arelent **) b;
+
+  if (ra->address != rb->address)
+    return ra->address < rb->address ? -1 : 1;
+  return 0;
+}
+
+/* Is SEC loaded into cog memory?  */
+static int
+is_cog_section (asection *sec)
+{
+  const char *name = bfd_get_section_name (sec->owner, sec);
+  size_t len = strlen (name);
+
+  return (len > 4 && strcmp (name + len - 4, ".cog") == 0)
+    || strncmp (name, ".cog", 4) == 0
+    || strncmp (name, ".ecog", 5) == 0
+    || strcmp (name, ".lmmkernel") == 0
+    || strcmp (name, ".kernel") == 0;
+}
+
+static const char *
+mode_name (enum timing_mode mode)
+{
+  switch (mode)
+    {
+    case MODE_COG:
+      return "cog";
+    case MODE_LMM:
+      return "LMM";
+    default:
+      return "CMM";
+    }
+}
+
+static void
+print_block (struct timing_ctx *ctx, bfd_vma start, bfd_vma end,
+	     int insns, const struct timing *t, int native)
+{
+  unsigned long best = ~0UL, worst = 0;
+  int p;
+
+  for (p = 0; p < 16; p++)
+    if (t->valid[p])
+      {
+	if (t->lo[p] < best)
+	  best = t->lo[p];
+	if (t->hi[p] > worst)
+	  worst = t->hi[p];
+      }
+  if (best == ~0UL)
+    best = 0;
+  printf ("  %08lx-%08lx %6d %4d %6lu %6lu%s%s\n",
+	  (unsigned long) (ctx->sec->vma + start),
+	  (unsigned long) (ctx->sec->vma + end - 1),
+	  insns, ctx->hubops, best, worst,
+	  ctx->unbounded ? "+" : "",
+	  native ? _(" (fcache)") : "");
+}
+
+/* Return true if the bytes of the section from START to END are all
+   zero, as in the padding after the last function.  */
+static int
+zero_fill (struct timing_ctx *ctx, bfd_vma start, bfd_vma end)
+{
+  for (; start < end; start++)
+    if (ctx->contents[start] != 0)
+      return 0;
+  return 1;
+}
+
+/* Print the timing of the code in SEC.  */
+static void
+dump_section_timing (struct timing_ctx *ctx, asection *sec,
+		     asymbol **syms, long num_syms)
+{
+  bfd *abfd = ctx->abfd;
+  asymbol **secsyms;
+  long nsecsyms = 0, i, relsize;
+  char *leader;
+  bfd_vma off, start, func_end, next;
+  struct timing t;
+  struct flow fl;
+  unsigned int len;
+  int insns, native, pass, prev_ends;
+  long si;
+
+  ctx->sec = sec;
+  ctx->size = bfd_get_section_size (sec);
+  if (!bfd_malloc_and_get_section (abfd, sec, &ctx->contents))
+    {
+      non_fatal (_("can't read section %s"), bfd_get_section_name (abfd, sec));
+      return;
+    }
+
+  ctx->relocs = NULL;
+  ctx->num_relocs = 0;
+  relsize = bfd_get_reloc_upper_bound (abfd, sec);
+  if (relsize > 0)
+    {
+      ctx->relocs = (arelent **) xmalloc (relsize);
+      ctx->num_relocs = bfd_canonicalize_reloc (abfd, sec, ctx->relocs, syms);
+      if (ctx->num_relocs < 0)
+	ctx->num_relocs = 0;
+      qsort (ctx->relocs, ctx->num_relocs, sizeof (arelent *),
+	     compare_relocs);
+    }
+
+  secsyms = (asymbol **) xmalloc ((num_syms + 1) * sizeof (asymbol *));
+  for (i = 0; i < num_syms; i++)
+    if (syms[i]->section == sec
+	&& (syms[i]->flags & (BSF_SECTION_SYM | BSF_FILE | BSF_DEBUGGING)) == 0
+	&& syms[i]->value < ctx->size)
+      secsyms[nsecsyms++] = syms[i];
+  qsort (secsyms, nsecsyms, sizeof (asymbol *), compare_symbols);
+
+  /* Find the leaders of the basic blocks.  */
+  leader = (char *) xcalloc (ctx->size + 1, 1);
+  for (i = 0; i < nsecsyms; i++)
+    leader[secsyms[i]->value] = 1;
+  leader[0] = 1;
+
+  printf (_("\nTiming of section %s:\n"), bfd_get_section_name (abfd, sec));
+  printf (_("  Block             Insns  Hub   Best  Worst\n"));
+
+  for (pass = 0; pass < 2; pass++)
+    {
+      si = 0;
+      ctx->mode = is_cog_section (sec) ? MODE_COG : MODE_LMM;
+      ctx->native_end = ctx->mode == MODE_COG ? ctx->size : 0;
+      ctx->skip_next = 0;
+      ctx->last_imm = 0;
+      ctx->hubops = 0;
+      ctx->unbounded = 0;
+      timing_init (&t);
+      insns = 0;
+      start = 0;
+      native = 0;
+      func_end = ctx->size;
+      prev_ends = 0;
+
+      for (off = 0; off < ctx->size; off += len)
+	{
+	  if (pass == 1 && leader[off] && insns > 0)
+	    {
+	      print_block (ctx, start, off, insns, &t, native);
+	      ctx->hubops = 0;
+	      ctx->unbounded = 0;
+	      timing_init (&t);
+	      insns = 0;
+	    }
+	  if (insns == 0)
+	    {
+	      start = off;
+	      native = ctx->mode != MODE_COG && off < ctx->native_end;
+	    }
+
+	  /* a new symbol may start a region or change the kind of code */
+	  for (; si < nsecsyms && secsyms[si]->value <= off; si++)
+	    {
+	      asymbol *sym = secsyms[si];
+
+	      elf_symbol_type *es;
+
+	      if (sym->value < off)
+		continue;
+	      es = elf_symbol_from (abfd, sym);
+	      if (ctx->mode != MODE_COG && es != NULL)
+		ctx->mode = (es->internal_elf_sym.st_other
+			     & PROPELLER_OTHER_COMPRESSED)
+		  ? MODE_CMM : MODE_LMM;
+	      if (off >= func_end)
+		func_end = ctx->size;
+	      if ((sym->flags & BSF_FUNCTION) && es != NULL
+		  && es->internal_elf_sym.st_size != 0
+		  && off + es->internal_elf_sym.st_size < func_end)
+		func_end = off + es->internal_elf_sym.st_size;
+	      if (pass == 1 && (sym->flags & (BSF_GLOBAL | BSF_FUNCTION)))
+		printf ("\n%s (%s):\n", bfd_asymbol_name (sym),
+			mode_name (ctx->mode));
+	    }
+
+	  /* the bytes after the end of a function, or the zeros after
+	     its last instruction up to the next symbol, are padding */
+	  next = si < nsecsyms ? secsyms[si]->value : ctx->size;
+	  if (off >= func_end || (prev_ends && zero_fill (ctx, off, next)))
+	    {
+	      if (pass == 1 && insns > 0)
+		print_block (ctx, start, off, insns, &t, native);
+	      ctx->hubops = 0;
+	      ctx->unbounded = 0;
+	      ctx->skip_next = 0;
+	      timing_init (&t);
+	      insns = 0;
+	      prev_ends = 0;
+	      len = next - off;
+	      continue;
+	    }
+
+	  if (ctx->skip_next && pass == 1)
+	    {
+	      struct timing skip = t;
+
+	      ctx->skip_next = 0;
+	      len = time_insn (ctx, off, &t, &fl);
+	      timing_merge (&t, &skip);
+	    }
+	  else
+	    {
+	      ctx->skip_next = 0;
+	      len = time_insn (ctx, off, pass == 1 ? &t : NULL, &fl);
+	    }
+	  if (len == 0)
+	    len = 1;
+	  insns++;
+	  prev_ends = fl.ends;
+
+	  if (pass == 0)
+	    {
+	      if (fl.has_target)
+		leader[fl.target] = 1;
+	      if (fl.ends && off + len <= ctx->size)
+		leader[off + len] = 1;
+	    }
+	  if (ctx->native_end != 0 && off + len == ctx->native_end
+	      && ctx->mode != MODE_COG)
+	    leader[off + len] = 1;
+	}
+      if (pass == 1 && insns > 0)
+	print_block (ctx, start, ctx->size, insns, &t, native);
+    }
+
+  free (leader);
+  free (secsyms);
+  free (ctx->relocs);
+  free (ctx->contents);
+}
+
+static void
+elf32_propeller_dump_timing (bfd *abfd)
+{
+  struct timing_ctx ctx;
+  asymbol **syms = NULL;
+  long storage, num_syms = 0, i;
+  asection *sec;
+  int h;
+
+  if (elf_elfheader (abfd)->e_flags & EF_PROPELLER_PROP2)
+    {
+      non_fatal (_("%s: timing is only available for Propeller 1 code"),
+		 bfd_get_filename (abfd));
+      return;
+    }
+
+  memset (&ctx, 0, sizeof (ctx));
+  ctx.abfd = abfd;
+
+  storage = bfd_get_symtab_upper_bound (abfd);
+  if (storage > 0)
+    {
+      syms = (asymbol **) xmalloc (storage);
+      num_syms = bfd_canonicalize_symtab (abfd, syms);
+      if (num_syms < 0)
+	num_syms = 0;
+    }
+
+  /* Kernel routines of linked programs, by cog address.  */
+  for (i = 0; i < num_syms; i++)
+    {
+      const char *name = bfd_asymbol_name (syms[i]);
+      bfd_vma cog;
+
+      if (bfd_is_und_section (syms[i]->section))
+	continue;
+      cog = bfd_asymbol_value (syms[i]);
+      if (!bfd_is_abs_section (syms[i]->section))
+	cog >>= 2;
+      for (h = 0; kernel_helpers[h].name != NULL; h++)
+	if (strcmp (name, kernel_helpers[h].name) == 0)
+	  ctx.cog_helper[cog & 511] = kernel_helpers[h].helper;
+      if (strncmp (name, "__LMM_MVI_", 10) == 0)
+	ctx.cog_helper[cog & 511] = HELPER_MVI;
+    }
+
+  printf (_("Cycles per basic block, over all hub window phases\n"));
+  for (sec = abfd->sections; sec != NULL; sec = sec->next)
+    if ((sec->flags & (SEC_CODE | SEC_HAS_CONTENTS))
+	== (SEC_CODE | SEC_HAS_CONTENTS)
+	&& bfd_get_section_size (sec) != 0)
+      dump_section_timing (&ctx, sec, syms, num_syms);
+
+  free (syms);
+}
+
+static void
+elf32_propeller_dump (bfd *abfd)
+{
+  if (options[OPT_TIMING].selected)
+    elf32_propeller_dump_timing (abfd);
+}
+
+const struct objdump_private_desc objdump_private_desc_elf32_propeller =
+  {
+    elf32_propeller_help,
+    elf32_propeller_filter,
+    elf32_propeller_dump,
+    options
+  };
@@ -4059,6 +4059,16 @@ get_msp430x_section_type_name (unsigned int sh_type)
     }
 }
 
+static const char *
+get_propeller_section_type_name (unsigned int sh_type)
+{
+  switch (sh_type)
+    {
+    case SHT_PROPELLER_DUAL:  return "PROPELLER_DUAL";
+    default:                  return NULL;
+    }
+}
+
 static const char *
 get_v850_section_type_name (unsigned int sh_type)
 {
@@ -4140,6 +4150,9 @@ get_section_type_name (unsigned int sh_type)
 	    case EM_MSP430:
 	      result = get_msp430x_section_type_name (sh_type);
 	      break;
+	    case EM_PROPELLER:
+	      result = get_propeller_section_type_name (sh_type);
+	      break;
 	    case EM_V800:
 	    case EM_V850:
 	    case EM_CYGNUS_V850:
@@ -6032,7 +6045,8 @@ process_section_headers (FILE * file)
 	request_dump_bynumber (i, DEBUG_DUMP);
       else if (do_debug_frames && streq (name, ".eh_frame"))
 	request_dump_bynumber (i, DEBUG_DUMP);
-      else if (do_gdb_index && streq (name, ".gdb_index"))
+      else if (do_gdb_index && (streq (name, ".gdb_index")
+				|| streq (name, ".debug_names")))
 	request_dump_bynumber (i, DEBUG_DUMP);
       /* Trace sections for Itanium VMS.  */
       else if ((do_debugging || do_trace_info || do_trace_abbrevs
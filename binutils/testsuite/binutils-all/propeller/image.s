@@ -0,0 +1,17 @@
+# Two kilobytes of code for the propeller-image tests: a page that
+# compresses poorly, then zeros.  With CHANGE defined, one long in
+# the fifth 256 byte page differs.
+	.text
+	.global	_start
+_start:
+	.set	n, 0
+	.rept	256
+	.long	0x5c7c0000 + n
+	.set	n, n + 1
+	.endr
+	.ifdef	CHANGE
+	.long	1
+	.else
+	.long	0
+	.endif
+	.fill	255, 4, 0
@@ -0,0 +1,11 @@
+# Native code in a cog overlay: hub instructions and a djnz loop.
+	.section foo.cog, "ax"
+	.global	cogfunc
+cogfunc:
+	mov	r1, #4
+	rdlong	r0, r2
+	add	r0, #1
+.Lloop:
+	wrlong	r0, r2
+	djnz	r1, #.Lloop
+	jmp	#cogfunc
@@ -0,0 +1,10 @@
+# Kernel code, assembled as LMM and as CMM: a conditional branch
+# and a call of __LMM_MVI_r1.
+	.text
+	.global	lmmfunc
+lmmfunc:
+	mov	r0, #1
+	mvi	r1, #0x12345
+	add	r0, r1 wz
+	if_z	brs	#lmmfunc
+	lret
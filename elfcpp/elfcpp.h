@@ -279,6 +279,8 @@ enum EM
   EM_FRV = 0x5441,
   // Infineon Technologies 16-bit microcontroller with C166-V2 core.
   EM_X16X = 0x4688,
+  // Parallax Propeller
+  EM_PROPELLER = 0x5072,
   // Xstorym16
   EM_XSTORMY16 = 0xad45,
   // Renesas M32C
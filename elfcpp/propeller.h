@@ -0,0 +1,114 @@
+// propeller.h -- ELF definitions specific to EM_PROPELLER  -*- C++ -*-
+
+// Copyright (C) 2017 Free Software Foundation, Inc.
+
+// This file is part of elfcpp.
+   
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public License
+// as published by the Free Software Foundation; either version 2, or
+// (at your option) any later version.
+
+// In addition to the permissions in the GNU Library General Public
+// License, the Free Software Foundation gives you unlimited
+// permission to link the compiled version of this file into
+// combinations with other programs, and to distribute those
+// combinations without any restriction coming from the use of this
+// file.  (The Library Public License restrictions do apply in other
+// respects; for example, they cover modification of the file, and
+/// distribution when not linked into a combined executable.)
+
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+
+// You should have received a copy of the GNU Library General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston, MA
+// 02110-1301, USA.
+
+#ifndef ELFCPP_PROPELLER_H
+#define ELFCPP_PROPELLER_H
+
+namespace elfcpp
+{
+
+// The relocation numbers must match include/elf/propeller.h.
+
+enum
+{
+  R_PROPELLER_NONE = 0,         // No reloc.
+  R_PROPELLER_32 = 1,           // Direct 32 bit.
+  R_PROPELLER_23 = 2,           // 32 bit data in code, condition bits clear.
+  R_PROPELLER_16 = 3,           // Direct 16 bit.
+  R_PROPELLER_8 = 4,            // Direct 8 bit.
+  R_PROPELLER_SRC_IMM = 5,      // 9 bit immediate source field.
+  R_PROPELLER_SRC = 6,          // Cog long address in the source field.
+  R_PROPELLER_DST = 7,          // Cog long address in the destination field.
+  R_PROPELLER_PCREL10 = 8,      // Signed PC relative, toggles add/sub.
+  R_PROPELLER_REPS = 9,         // 14 bit REPS count, less one.
+  R_PROPELLER_REPINSCNT = 10,   // 6 bit instruction repeat count, less one.
+  R_PROPELLER_DST_IMM = 11,     // 9 bit immediate destination field.
+  R_PROPELLER_32_DIV4 = 12,     // Direct 32 bit, divided by 4.
+  R_PROPELLER_16_DIV4 = 13,     // Direct 16 bit, divided by 4.
+  R_PROPELLER_8_DIV4 = 14,      // Direct 8 bit, divided by 4.
+  R_PROPELLER_PCREL32 = 15,     // PC relative 32 bit.
+  R_PROPELLER_PCREL16 = 16,     // PC relative 16 bit.
+  R_PROPELLER_PCREL8 = 17,      // PC relative 8 bit.
+  R_PROPELLER_REPSREL = 18,     // PC relative repeat count.
+  R_PROPELLER_RELAX = 19,       // Relaxation marker, no effect.
+  R_PROPELLER_ALIGN = 20,       // Alignment marker, no effect.
+  R_PROPELLER_DIFF8 = 21,       // 8 bit symbol difference, no effect.
+  R_PROPELLER_DIFF16 = 22,      // 16 bit symbol difference, no effect.
+  R_PROPELLER_DIFF32 = 23,      // 32 bit symbol difference, no effect.
+};
+
+// Values for the st_other field.
+
+enum
+{
+  // Symbol is a cog address assembled with .cog_ram.
+  STO_PROPELLER_COG_RAM = 0x80,
+  // Symbol was assembled with .compress in effect.
+  STO_PROPELLER_COMPRESSED = 0x40,
+};
+
+// Processor specific flags for the ELF header e_flags field.
+
+enum
+{
+  // File contains Propeller 1 code.
+  EF_PROPELLER_PROP1 = 0x00000001,
+  // File contains Propeller 2 code.
+  EF_PROPELLER_PROP2 = 0x00000002,
+  // Mask for the machine type.
+  EF_PROPELLER_MACH = 0x000000ff,
+  // File contains compressed instructions.
+  EF_PROPELLER_COMPRESS = 0x00000100,
+  // File contains XMM instructions.
+  EF_PROPELLER_XMM = 0x00000200,
+  // ABI version.
+  EF_PROPELLER_ABI_VERS = 0x00ff0000,
+};
+
+// Processor specific section types.
+
+enum
+{
+  // The other encoding of a .text section, from gas --dual-encoding.
+  SHT_PROPELLER_DUAL = 0x70000000,
+};
+
+// Processor specific section and segment flags.
+
+enum
+{
+  // Data to be loaded into a cog.
+  SHF_PROPELLER_COGDATA = 0x10000000,
+  PF_PROPELLER_COGDATA = 0x10000000,
+};
+
+} // End namespace elfcpp.
+
+#endif // !defined(ELFCPP_PROPELLER_H)
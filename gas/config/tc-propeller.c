@@ -27,6 +27,7 @@
 #include "elf/propeller.h"
 #include "dwarf2dbg.h"
 #include "obstack.h"
+#include "subsegs.h"
 
 /* "always" condition code */
 #define CC_ALWAYS   (0xf << 18)
@@ -77,6 +78,10 @@ static char *skip_whitespace (char *str);
 static char *find_whitespace (char *str);
 static char *find_whitespace_or_separator (char *str);
 static int  pasm_replace_expression (expressionS *exp);
+static struct dual_section *dual_find (segT, int);
+static void dual_align (struct dual_section *, int, int);
+static void dual_give_up (segT);
+static int dual_section_p (segT);
 
 static int pasm_default = 0;    /* Use PASM addressing if 1 */
 static int lmm = 0;             /* Enable LMM pseudo-instructions */
@@ -84,6 +89,9 @@ static int compress = 0;        /* Enable compressed (16 bit) instructions */
 static int prop2 = 0;           /* Enable Propeller 2 instructions */
 static int compress_default = 0; /* default compression mode from command line */
 static int elf_flags = 0;       /* machine specific ELF flags */
+int propeller_relax = 0;        /* leave compressed code for the linker to relax */
+static int peephole = 0;        /* combine compressed instructions */
+static int dual = 0;            /* emit code in both LMM and CMM encodings */
 static int cc_flag;             /* set if a condition code was specified in the current instruction */
 static int cc_cleared;          /* set if the condition code field has been cleared in the process of handling inda/indb references */
 
@@ -134,6 +142,41 @@ Prop_regdef p2_regs[] = {
     { 0, 0 }
 };
 
+/*
+ * relaxation of branches
+ *
+ * in CMM mode brw starts out as a 2 byte brs and may grow into the
+ * 3 byte brw; brl may additionally grow into the 5 byte absolute
+ * ljmp macro.
+ * in LMM mode both brw and brl start out as a single "add/sub pc,#n"
+ * (brs) and grow into the jmp #__LMM_JMP + long sequence
+ *
+ * the ranges below are measured from the start of the branch, whereas
+ * the displacement itself is relative to the end of the instruction
+ */
+#define RELAX_CMM_BRW_BRS   1
+#define RELAX_CMM_BRW_BRW   2
+#define RELAX_CMM_BRL_BRS   3
+#define RELAX_CMM_BRL_BRW   4
+#define RELAX_CMM_BRL_LJMP  5
+#define RELAX_LMM_BRS       6
+#define RELAX_LMM_JMP       7
+
+const relax_typeS md_relax_table[] = {
+  /* the first entry is unused, since an rlx_more of 0 ends a chain */
+  { 1, 1, 0, 0 },
+  /* CMM brw */
+  { 0x7f + 2, -0x80 + 2, 2, RELAX_CMM_BRW_BRW },
+  { 0, 0, 3, 0 },
+  /* CMM brl */
+  { 0x7f + 2, -0x80 + 2, 2, RELAX_CMM_BRL_BRW },
+  { 0x7fff + 3, -0x8000 + 3, 3, RELAX_CMM_BRL_LJMP },
+  { 0, 0, 5, 0 },
+  /* LMM brw and brl */
+  { 0x1ff + 4, -0x1ff + 4, 4, RELAX_LMM_JMP },
+  { 0, 0, 8, 0 },
+};
+
 static struct hash_control *insn_hash = NULL;
 static struct hash_control *cond_hash = NULL;
 static struct hash_control *eff_hash = NULL;
@@ -144,7 +187,10 @@ enum {
     OPTION_MD_LMM = OPTION_MD_BASE,
     OPTION_MD_CMM,
     OPTION_MD_P2,
-    OPTION_MD_PASM
+    OPTION_MD_PASM,
+    OPTION_MD_RELAX,
+    OPTION_MD_PEEPHOLE,
+    OPTION_MD_DUAL
 };
 
 struct option md_longopts[] = {
@@ -152,6 +198,9 @@ struct option md_longopts[] = {
   {"cmm", no_argument, NULL, OPTION_MD_CMM},
   {"p2", no_argument, NULL, OPTION_MD_P2},
   {"pasm", no_argument, NULL, OPTION_MD_PASM},
+  {"relax", no_argument, NULL, OPTION_MD_RELAX},
+  {"peephole", no_argument, NULL, OPTION_MD_PEEPHOLE},
+  {"dual-encoding", no_argument, NULL, OPTION_MD_DUAL},
   {NULL, no_argument, NULL, 0}
 };
 
@@ -270,6 +319,51 @@ md_apply_fix (fixS * fixP, valueT * valP, segT seg ATTRIBUTE_UNUSED)
   int rshift;
   int size;
 
+  /* the relaxation markers are only for the linker */
+  if (fixP->fx_r_type == BFD_RELOC_PROPELLER_RELAX
+      || fixP->fx_r_type == BFD_RELOC_PROPELLER_ALIGN)
+    return;
+
+  /* a difference of two symbols which the linker may move apart goes
+     in the field, with a DIFF reloc against the symbol subtracted */
+  if (fixP->fx_subsy != NULL)
+    {
+      symbolS *sub = fixP->fx_subsy;
+
+      switch (fixP->fx_r_type)
+        {
+        case BFD_RELOC_8:
+          fixP->fx_r_type = BFD_RELOC_PROPELLER_DIFF8;
+          break;
+        case BFD_RELOC_16:
+          fixP->fx_r_type = BFD_RELOC_PROPELLER_DIFF16;
+          break;
+        case BFD_RELOC_32:
+          fixP->fx_r_type = BFD_RELOC_PROPELLER_DIFF32;
+          break;
+        default:
+          as_bad_where (fixP->fx_file, fixP->fx_line,
+                        _("difference of `%s' and `%s' may change with --relax"),
+                        S_GET_NAME (fixP->fx_addsy), S_GET_NAME (sub));
+          fixP->fx_done = 1;
+          return;
+        }
+      md_number_to_chars (fixP->fx_where + fixP->fx_frag->fr_literal,
+                          *valP, fixP->fx_size);
+      if (S_IS_EXTERNAL (sub) || S_IS_WEAK (sub))
+        {
+          fixP->fx_addsy = sub;
+          fixP->fx_offset = 0;
+        }
+      else
+        {
+          fixP->fx_addsy = section_symbol (S_GET_SEGMENT (sub));
+          fixP->fx_offset = S_GET_VALUE (sub);
+        }
+      fixP->fx_subsy = NULL;
+      return;
+    }
+
   /* note whether this will delete the relocation */
   if (fixP->fx_addsy == NULL && fixP->fx_pcrel == 0) {
     fixP->fx_done = 1;
@@ -473,6 +567,11 @@ tc_gen_reloc (asection * section ATTRIBUTE_UNUSED, fixS * fixp)
     case BFD_RELOC_PROPELLER_32_DIV4:
     case BFD_RELOC_PROPELLER_16_DIV4:
     case BFD_RELOC_PROPELLER_8_DIV4:
+    case BFD_RELOC_PROPELLER_RELAX:
+    case BFD_RELOC_PROPELLER_ALIGN:
+    case BFD_RELOC_PROPELLER_DIFF8:
+    case BFD_RELOC_PROPELLER_DIFF16:
+    case BFD_RELOC_PROPELLER_DIFF32:
       code = fixp->fx_r_type;
       break;
 
@@ -495,6 +594,142 @@ tc_gen_reloc (asection * section ATTRIBUTE_UNUSED, fixS * fixp)
   return reloc;
 }
 
+/* with --relax, mark a compressed instruction which the linker may
+   replace with a shorter form */
+static void
+mark_relaxable (fragS *frag, int where)
+{
+  if (propeller_relax)
+    fix_new (frag, where, 0, NULL, 0, 0, BFD_RELOC_PROPELLER_RELAX);
+}
+
+/* with --relax, mark an LMM mvi or ldi; the addend is the offset of
+   its 32 bit literal, which the linker may load more cheaply */
+static void
+mark_lmm_literal (fragS *frag, int where)
+{
+  if (propeller_relax)
+    fix_new (frag, where, 0, NULL, 4, 0, BFD_RELOC_PROPELLER_RELAX);
+}
+
+/* with --relax, tell the linker where code has to be aligned, so that
+   it can fix up the padding when it shrinks the code in front of it */
+void
+propeller_do_align (int n, const char *fill, int max)
+{
+  struct dual_section *ds = dual_find (now_seg, 1);
+
+  /* code alignment is repeated in the other encoding; anything else
+     leaves the two different */
+  if (ds != NULL && fill == NULL)
+    dual_align (ds, n, max);
+
+  if (!propeller_relax || n <= 0 || fill != NULL
+      || !subseg_text_p (now_seg)
+      || (max != 0 && max < (1 << n) - 1))
+    return;
+  fix_new (frag_now, frag_now_fix (), 0, NULL, 1 << n, 0,
+           BFD_RELOC_PROPELLER_ALIGN);
+}
+
+/* with --relax, the linker may move two labels in code apart, so
+   their difference is not worked out here */
+bfd_boolean
+propeller_allow_local_subtract (expressionS *left, expressionS *right,
+                                segT seg)
+{
+  return (!propeller_relax
+          || (seg->flags & SEC_CODE) == 0
+          || left->X_add_symbol == right->X_add_symbol);
+}
+
+/* The offsets of the relaxation markers in one section, sorted, so
+   that the differences in the debug info can be checked quickly.  */
+static segT marker_seg;
+static addressT *marker_addr;
+static size_t marker_count;
+
+static int
+compare_marker_addr (const void *a, const void *b)
+{
+  addressT x = *(const addressT *) a;
+  addressT y = *(const addressT *) b;
+
+  return x < y ? -1 : x > y;
+}
+
+/* A difference of two symbols in SEG only has to be left to the linker
+   if there is code it may shrink, or padding it may change, between
+   them; the linker only does either at a relaxation marker.  */
+int
+propeller_force_relocation_sub_same (fixS *fixP, segT seg)
+{
+  addressT lo, hi;
+  size_t l, h;
+
+  if (!propeller_relax || (seg->flags & SEC_CODE) == 0)
+    return 0;
+
+  if (marker_seg != seg)
+    {
+      fixS *f;
+      size_t n = 0;
+
+      for (f = seg_info (seg)->fix_root; f != NULL; f = f->fx_next)
+        if (f->fx_r_type == BFD_RELOC_PROPELLER_RELAX
+            || f->fx_r_type == BFD_RELOC_PROPELLER_ALIGN)
+          n++;
+      marker_addr = XRESIZEVEC (addressT, marker_addr, n);
+      marker_count = 0;
+      for (f = seg_info (seg)->fix_root; f != NULL; f = f->fx_next)
+        if (f->fx_r_type == BFD_RELOC_PROPELLER_RELAX
+            || f->fx_r_type == BFD_RELOC_PROPELLER_ALIGN)
+          marker_addr[marker_count++] = f->fx_frag->fr_address + f->fx_where;
+      qsort (marker_addr, marker_count, sizeof (*marker_addr),
+             compare_marker_addr);
+      marker_seg = seg;
+    }
+
+  lo = S_GET_VALUE (fixP->fx_subsy);
+  hi = S_GET_VALUE (fixP->fx_addsy) + fixP->fx_offset;
+  if (lo > hi)
+    {
+      addressT t = lo;
+      lo = hi;
+      hi = t;
+    }
+
+  /* find the first marker at or above LO */
+  l = 0;
+  h = marker_count;
+  while (l < h)
+    {
+      size_t m = l + (h - l) / 2;
+
+      if (marker_addr[m] < lo)
+        l = m + 1;
+      else
+        h = m;
+    }
+  return l < marker_count && marker_addr[l] < hi;
+}
+
+/* The target of a relaxed branch (marked by md_convert_frag) may be
+   given as the section symbol plus an offset, so that its local label
+   need not go into the symbol table; but not if the linker reads the
+   label's own st_other flags, nor for a label of a section encoded
+   both ways, which the linker moves to its twin if it keeps the other
+   encoding.  Other relocs keep their label.  */
+int
+propeller_fix_adjustable (fixS *fixP)
+{
+  if (!fixP->fx_tcbit)
+    return 0;
+  if (dual_section_p (S_GET_SEGMENT (fixP->fx_addsy)))
+    return 0;
+  return (S_GET_OTHER (fixP->fx_addsy) & PROPELLER_OTHER_COG_RAM) == 0;
+}
+
 const char *
 md_atof (int type, char *litP, int *sizeP)
 {
@@ -518,6 +753,7 @@ pseudo_compress (int x ATTRIBUTE_UNUSED)
 {
   char *opt;
   char delim;
+  int old_compress = compress;
 
   delim = get_symbol_name (&opt);
 
@@ -537,9 +773,12 @@ pseudo_compress (int x ATTRIBUTE_UNUSED)
     {
       as_bad (_("Unrecognized compress option \"%s\""), opt);
     }
+  if (compress != old_compress)
+    dual_give_up (now_seg);
   if (compress == 0)
     {
       /* compression is off, make sure code is aligned */
+      propeller_do_align (2, NULL, 0);
       frag_align_code (2, 0);
     }
   (void) restore_line_pointer (delim);
@@ -1531,6 +1770,498 @@ pack_native(unsigned long code)
   return PREFIX_PACK_NATIVE | eeeI | (bottom << 8);
 }
 
+/*
+ * emit a brw or brl to a plain symbol as a variant frag; the final
+ * encoding is picked by relaxation and written out in md_convert_frag
+ * for CMM, code is just the condition; for LMM it is the jmp
+ * instruction of the long form
+ */
+static void
+emit_relaxable_branch (int format, unsigned long code, expressionS *exp)
+{
+  relax_substateT subtype;
+  int max_chars;
+  char *to;
+
+  if (compress)
+    {
+      if (format == PROPELLER_OPERAND_BRW)
+        subtype = RELAX_CMM_BRW_BRS;
+      else
+        subtype = RELAX_CMM_BRL_BRS;
+      max_chars = 5;
+    }
+  else
+    {
+      subtype = RELAX_LMM_BRS;
+      max_chars = 8;
+    }
+  to = frag_var (rs_machine_dependent, max_chars,
+                 md_relax_table[subtype].rlx_length, subtype,
+                 exp->X_add_symbol, exp->X_add_number, NULL);
+  memset (to, 0, max_chars);
+  md_number_to_chars (to, code, compress ? 1 : 4);
+}
+
+
+/* The CMM peephole optimizer (--peephole).  It remembers the last
+   instruction emitted if it is a register move which may combine with
+   the instruction after it:
+
+     mov rA,rB ; xop rD,rS      ->  xmov rA,rB xop rD,rS
+     mov rN,sp ; add rN,#n      ->  leasp rN,#n
+
+   The second instruction is folded into the bytes of the first, so
+   nothing may come between them: no label, no data, and no new symbol
+   which could point at the second one.  Both must have the same
+   condition.  */
+enum peephole_kind
+{
+  PEEPHOLE_NONE,
+  PEEPHOLE_MVREG,               /* mov rA,rB */
+  PEEPHOLE_MOVSP                /* mov rN,sp */
+};
+
+struct peephole_state
+{
+  enum peephole_kind kind;
+  fragS *frag;
+  int where;                    /* offset of the instruction in frag */
+  int size;
+  unsigned int condmask;
+  unsigned int regs;            /* (A << 4) | B, or N */
+  symbolS *last_symbol;
+};
+
+static struct peephole_state peephole_last;
+
+/* see if the native instruction CODE is a move the peephole optimizer
+   can start from */
+static enum peephole_kind
+peephole_classify (const struct propeller_opcode *op, unsigned int code)
+{
+  unsigned int dest = (code >> 9) & 0x1ff;
+  unsigned int src = code & 0x1ff;
+
+  /* only the default wr effect, and a register source */
+  if (op->compress_type != COMPRESS_MOV || ((code >> 22) & 0xf) != 2
+      || dest > 15)
+    return PEEPHOLE_NONE;
+  if (src <= 15)
+    return PEEPHOLE_MVREG;
+  if (src == SP_REGNUM)
+    return PEEPHOLE_MOVSP;
+  return PEEPHOLE_NONE;
+}
+
+/* remember the instruction just emitted at WHERE in frag_now */
+static void
+peephole_note (enum peephole_kind kind, unsigned int code,
+               unsigned int condmask, int where)
+{
+  peephole_last.kind = kind;
+  if (kind == PEEPHOLE_NONE)
+    return;
+  peephole_last.frag = frag_now;
+  peephole_last.where = where;
+  peephole_last.size = frag_now_fix () - where;
+  peephole_last.condmask = condmask;
+  peephole_last.regs = (code >> 9) & 0xf;
+  if (kind == PEEPHOLE_MVREG)
+    peephole_last.regs = (peephole_last.regs << 4) | (code & 0xf);
+  peephole_last.last_symbol = symbol_lastP;
+}
+
+/* try to fold the instruction about to be emitted into the one before
+   it.  NATIVE and CONDMASK are as parsed; CODE and SIZE are its
+   compressed form.  Returns 1 if the instruction was folded.  */
+static int
+peephole_fuse (const struct propeller_opcode *op, unsigned int native,
+               unsigned int condmask, unsigned int code, int size)
+{
+  unsigned int newcode;
+  int newsize;
+  char *p;
+
+  if (peephole_last.kind == PEEPHOLE_NONE
+      || peephole_last.frag != frag_now
+      || peephole_last.where + peephole_last.size != (int) frag_now_fix ()
+      || peephole_last.last_symbol != symbol_lastP
+      || peephole_last.condmask != condmask)
+    return 0;
+
+  if (peephole_last.kind == PEEPHOLE_MVREG)
+    {
+      unsigned int prefix;
+
+      /* a two byte xop, after the skip prefix if there is one */
+      if (condmask != 0xf)
+        {
+          if (size != 3)
+            return 0;
+          code >>= 8;
+        }
+      else if (size != 2)
+        return 0;
+      prefix = code & 0xf0;
+      if (prefix != PREFIX_REGREG && prefix != PREFIX_REGIMM4)
+        return 0;
+      newcode = (prefix == PREFIX_REGREG ? PREFIX_XMOVREG : PREFIX_XMOVIMM)
+        | (code & 0xf) | (peephole_last.regs << 8)
+        | (((code >> 8) & 0xff) << 16);
+      newsize = 3;
+    }
+  else
+    {
+      unsigned int dest = (native >> 9) & 0x1ff;
+      unsigned int src = native & 0x1ff;
+
+      /* add rN,#n with the default effects */
+      if (op->compress_type != COMPRESS_XOP || op->copc != XOP_ADD
+          || ((native >> 22) & 0xf) != 3
+          || dest != peephole_last.regs || src > 255)
+        return 0;
+      newcode = PREFIX_LEASP | dest | (src << 8);
+      newsize = 2;
+    }
+  if (condmask != 0xf)
+    {
+      newcode = (newcode << 8) | (~condmask & 0xf)
+        | (newsize == 3 ? PREFIX_SKIP3 : PREFIX_SKIP2);
+      newsize++;
+    }
+
+  /* the first instruction has to stay in the same frag */
+  if (newsize > peephole_last.size)
+    {
+      frag_grow (newsize - peephole_last.size);
+      if (frag_now != peephole_last.frag)
+        return 0;
+      frag_more (newsize - peephole_last.size);
+    }
+  else
+    obstack_blank_fast (&frchain_now->frch_obstack,
+                        newsize - peephole_last.size);
+  p = frag_now->fr_literal + peephole_last.where;
+  md_number_to_chars (p, newcode, newsize);
+  peephole_last.kind = PEEPHOLE_NONE;
+  return 1;
+}
+
+/* With --dual-encoding, each .text section is assembled twice: as
+   written, and again in the other encoding (CMM for LMM code, LMM for
+   CMM code) into a section of the same name with ".cmm" or ".lmm"
+   added.  Every label gets a local twin of the same name in the
+   alternate section, and relocations in the alternate section which
+   refer to local labels of the section it shadows are redirected to
+   the twins.  The linker keeps one of the two for each function.
+
+   Only sections which hold nothing but instructions, labels and code
+   alignment can be encoded both ways; anything else in the section
+   (data, a .compress switch, a subsection) gives up on the alternate
+   section, which is then excluded from the link.  */
+struct dual_section
+{
+  segT primary;
+  segT alternate;
+  int alt_compress;             /* encoding of the alternate section */
+  int mixed;                    /* the section can only be used as is */
+  /* where the primary section was left after the last instruction,
+     label or alignment */
+  fragS *frag;
+  int where;
+  fragS *align_frag;            /* frag closed by that alignment */
+  /* and where the alternate section was left */
+  fragS *alt_frag;
+  int alt_where;
+  struct peephole_state peephole;
+  struct dual_section *next;
+};
+
+struct dual_twin
+{
+  symbolS *primary;
+  symbolS *twin;
+  struct dual_section *ds;
+};
+
+static struct dual_section *dual_sections;
+static struct hash_control *dual_twin_hash;
+static int dual_busy;           /* assembling the alternate encoding */
+
+/* the dual section record for SEG, made if CREATE and SEG is one of
+   the sections which are encoded both ways */
+static struct dual_section *
+dual_find (segT seg, int create)
+{
+  struct dual_section *ds;
+  const char *name;
+  char *altname;
+
+  if (!dual || dual_busy)
+    return NULL;
+  for (ds = dual_sections; ds != NULL; ds = ds->next)
+    if (ds->primary == seg)
+      return ds->mixed ? NULL : ds;
+  name = segment_name (seg);
+  if (!create || !lmm || prop2
+      || (strcmp (name, ".text") != 0 && strncmp (name, ".text.", 6) != 0)
+      || elf_group_name (seg) != NULL)
+    return NULL;
+
+  ds = XCNEW (struct dual_section);
+  ds->primary = seg;
+  ds->alt_compress = !compress;
+  ds->frag = frag_now;
+  ds->where = frag_now_fix ();
+  ds->next = dual_sections;
+  dual_sections = ds;
+  /* the two encodings have to start out the same */
+  if (now_subseg != 0 || frag_now != frchain_now->frch_root
+      || frag_now_fix () != 0)
+    {
+      ds->mixed = 1;
+      return NULL;
+    }
+
+  altname = concat (name, compress ? ".lmm" : ".cmm", (char *) NULL);
+  ds->alternate = subseg_new (altname, 0);
+  bfd_set_section_flags (stdoutput, ds->alternate,
+                         bfd_get_section_flags (stdoutput, seg));
+  record_alignment (ds->alternate, 2);
+  subseg_set (seg, 0);
+  if (dual_twin_hash == NULL)
+    dual_twin_hash = hash_new ();
+  return ds;
+}
+
+/* make sure nothing but what dual_* has seen went into the primary
+   section since */
+static void
+dual_check (struct dual_section *ds)
+{
+  if (now_subseg != 0)
+    ds->mixed = 1;
+  else if (frag_now == ds->frag && (int) frag_now_fix () == ds->where)
+    ;
+  else if (ds->align_frag == ds->frag && ds->align_frag->fr_next == frag_now
+           && ds->align_frag->fr_fix == ds->where && frag_now_fix () == 0)
+    ;
+  else
+    ds->mixed = 1;
+  ds->align_frag = NULL;
+  ds->frag = frag_now;
+  ds->where = frag_now_fix ();
+}
+
+/* SEG can only be used as assembled */
+static void
+dual_give_up (segT seg)
+{
+  struct dual_section *ds = dual_find (seg, 0);
+
+  if (ds != NULL)
+    ds->mixed = 1;
+}
+
+/* whether SEG is either encoding of a section encoded both ways; only
+   settled once propeller_dual_finish has run */
+static int
+dual_section_p (segT seg)
+{
+  struct dual_section *ds;
+
+  for (ds = dual_sections; ds != NULL; ds = ds->next)
+    if (ds->alternate != NULL && !ds->mixed
+        && (ds->primary == seg || ds->alternate == seg))
+      return 1;
+  return 0;
+}
+
+/* repeat a code alignment in the alternate section */
+static void
+dual_align (struct dual_section *ds, int n, int max)
+{
+  segT seg = now_seg;
+
+  dual_check (ds);
+  if (ds->mixed)
+    return;
+  ds->align_frag = frag_now;
+
+  dual_busy = 1;
+  subseg_set (ds->alternate, 0);
+  propeller_do_align (n, NULL, max);
+  frag_align_code (n, max);
+  ds->alt_frag = frag_now;
+  ds->alt_where = frag_now_fix ();
+  subseg_set (seg, 0);
+  dual_busy = 0;
+}
+
+/* give the label SYM a twin in the alternate section */
+static void
+dual_label (struct dual_section *ds, symbolS *sym)
+{
+  struct dual_twin *dt;
+  segT seg = now_seg;
+
+  dual_check (ds);
+  if (ds->mixed)
+    return;
+
+  dt = XNEW (struct dual_twin);
+  dt->primary = sym;
+  dt->ds = ds;
+  subseg_set (ds->alternate, 0);
+  dt->twin = symbol_new (S_GET_NAME (sym), ds->alternate, frag_now_fix (),
+                         frag_now);
+  subseg_set (seg, 0);
+  if (ds->alt_compress)
+    S_SET_OTHER (dt->twin, S_GET_OTHER (dt->twin) | PROPELLER_OTHER_COMPRESSED);
+  hash_jam (dual_twin_hash, S_GET_NAME (sym), dt);
+}
+
+/* assemble INSN in the primary section, then again in the alternate
+   one.  Returns 0 if the section is not encoded both ways.  */
+static int
+dual_assemble (char *insn)
+{
+  struct dual_section *ds = dual_find (now_seg, 1);
+  struct peephole_state peep;
+  bfd_boolean loc_seen = dwarf2_loc_directive_seen;
+  segT seg = now_seg;
+  char *copy;
+
+  if (ds == NULL)
+    return 0;
+  dual_check (ds);
+  if (ds->mixed)
+    return 0;
+
+  copy = xstrdup (insn);
+  dual_busy = 1;
+  md_assemble (insn);
+  ds->frag = frag_now;
+  ds->where = frag_now_fix ();
+
+  /* the alternate copy has its own peephole window and line info */
+  peep = peephole_last;
+  peephole_last = ds->peephole;
+  dwarf2_loc_directive_seen = loc_seen;
+  subseg_set (ds->alternate, 0);
+  compress = ds->alt_compress;
+  md_assemble (copy);
+  ds->alt_frag = frag_now;
+  ds->alt_where = frag_now_fix ();
+  compress = !ds->alt_compress;
+  subseg_set (seg, 0);
+  ds->peephole = peephole_last;
+  peephole_last = peep;
+  dual_busy = 0;
+  free (copy);
+  return 1;
+}
+
+/* the twin of SYM, if it is a local label of the section DS shadows */
+static symbolS *
+dual_redirect (struct dual_section *ds, symbolS *sym)
+{
+  struct dual_twin *dt;
+
+  if (sym == NULL || S_IS_EXTERNAL (sym) || S_GET_SEGMENT (sym) != ds->primary)
+    return sym;
+  dt = (struct dual_twin *) hash_find (dual_twin_hash, S_GET_NAME (sym));
+  if (dt == NULL || dt->primary != sym || dt->twin == NULL)
+    return sym;
+  return dt->twin;
+}
+
+/* called before relaxation: settle which sections really have an
+   alternate, and point the relocations and branches of those at the
+   twins of the labels */
+void
+propeller_dual_finish (void)
+{
+  struct dual_section *ds;
+  struct frchain *frchp;
+  fragS *f;
+  fixS *fixp;
+
+  for (ds = dual_sections; ds != NULL; ds = ds->next)
+    {
+      if (ds->alternate == NULL)
+        continue;
+      /* nothing may follow the last instruction */
+      if (!ds->mixed && ds->frag->fr_fix != ds->where)
+        ds->mixed = 1;
+      for (f = ds->frag->fr_next; f != NULL && !ds->mixed; f = f->fr_next)
+        if (f->fr_fix != 0
+            || (f->fr_type == rs_fill && f->fr_var != 0 && f->fr_offset != 0)
+            || (f->fr_type != rs_fill && f->fr_type != rs_align
+                && f->fr_type != rs_align_code))
+          ds->mixed = 1;
+
+      if (ds->mixed)
+        {
+          symbolS *sym, *next;
+
+          bfd_set_section_flags (stdoutput, ds->alternate,
+                                 bfd_get_section_flags (stdoutput,
+                                                        ds->alternate)
+                                 | SEC_EXCLUDE);
+          for (sym = symbol_rootP; sym != NULL; sym = next)
+            {
+              next = symbol_next (sym);
+              if (S_GET_SEGMENT (sym) == ds->alternate)
+                symbol_remove (sym, &symbol_rootP, &symbol_lastP);
+            }
+          continue;
+        }
+
+      /* only a linker which knows to keep one of the two may take
+         the object */
+      elf_section_type (ds->alternate) = SHT_PROPELLER_DUAL;
+      for (frchp = seg_info (ds->alternate)->frchainP;
+           frchp != NULL;
+           frchp = frchp->frch_next)
+        {
+          for (f = frchp->frch_root; f != NULL; f = f->fr_next)
+            if (f->fr_type == rs_machine_dependent)
+              f->fr_symbol = dual_redirect (ds, f->fr_symbol);
+          for (fixp = frchp->fix_root; fixp != NULL; fixp = fixp->fx_next)
+            {
+              fixp->fx_addsy = dual_redirect (ds, fixp->fx_addsy);
+              fixp->fx_subsy = dual_redirect (ds, fixp->fx_subsy);
+            }
+        }
+    }
+}
+
+/* a twin has the type of its label, and if the label's size reaches
+   the last instruction of its section, so does the twin's */
+void
+propeller_frob_symbol (symbolS *sym)
+{
+  struct dual_twin *dt;
+  struct dual_section *ds;
+  symbolS *primary;
+
+  if (dual_twin_hash == NULL)
+    return;
+  dt = (struct dual_twin *) hash_find (dual_twin_hash, S_GET_NAME (sym));
+  if (dt == NULL || dt->twin != sym)
+    return;
+  primary = dt->primary;
+  ds = dt->ds;
+  symbol_get_bfdsym (sym)->flags
+    |= symbol_get_bfdsym (primary)->flags & (BSF_FUNCTION | BSF_OBJECT);
+  if (S_GET_SIZE (primary) != 0 && ds->alt_frag != NULL
+      && S_GET_VALUE (primary) + S_GET_SIZE (primary)
+         == ds->frag->fr_address + ds->where)
+    S_SET_SIZE (sym, ds->alt_frag->fr_address + ds->alt_where
+                     - S_GET_VALUE (sym));
+}
 
 void
 md_assemble (char *instruction_string)
@@ -1551,6 +2282,11 @@ md_assemble (char *instruction_string)
   int insn2_compressed = 0;
   unsigned int reloc_prefix = 0;  /* for a compressed instruction */
   int xmov_flag = 0;
+  int fuse = 0;                 /* may fold into the previous instruction */
+  enum peephole_kind peep_kind = PEEPHOLE_NONE;
+  unsigned int native = 0;
+  unsigned int native_cond = 0xf;
+  int where = 0;
 
   if (ignore_input())
     {
@@ -1558,6 +2294,9 @@ md_assemble (char *instruction_string)
       return;
     }
 
+  if (dual_assemble (instruction_string))
+    return;
+
   /* initialize the condition code flags */
   cc_flag = cc_cleared = 0;
 
@@ -1569,11 +2308,6 @@ md_assemble (char *instruction_string)
   for (p = instruction_string; *p; p++)
     if (*p == '\r') *p = ' ';
 
-#ifdef OBJ_ELF
-  /* Tie dwarf2 debug info to the address at the start of the insn.  */
-  dwarf2_emit_insn (0);
-#endif
-
   str = skip_whitespace (instruction_string);
   p = find_whitespace (str);
   if (p - str == 0)
@@ -1772,6 +2506,7 @@ md_assemble (char *instruction_string)
             }
           op3.code = op3.reloc.exp.X_add_number;
         }
+        insn2.code = op3.code;
         free(pc);
       }
       break;
@@ -2327,6 +3062,38 @@ md_assemble (char *instruction_string)
                 insn.code |= (op2.code << 8);
                 reloc_prefix = 1;
               }
+            else if (peephole && insn2.reloc.type == BFD_RELOC_NONE
+                     && condmask == 0xf)
+              {
+                /* a constant may fit a shorter form */
+                unsigned int val = insn2.code;
+
+                if (val == 0)
+                  {
+                    size = 1;
+                    insn.code = PREFIX_ZEROREG | reg;
+                  }
+                else if (val <= 0xff)
+                  {
+                    size = 2;
+                    insn.code = PREFIX_MVIB | reg | (val << 8);
+                  }
+                else if (val <= 0xffff)
+                  {
+                    size = 3;
+                    insn.code = PREFIX_MVIW | reg | (val << 8);
+                  }
+                else
+                  {
+                    size = 5;
+                    insn.code = op->copc | reg;
+                  }
+                if (size < 5)
+                  {
+                    insn2.code = 0;
+                    reloc_prefix = 1;
+                  }
+              }
             else
               {
                 size = 5;
@@ -2498,6 +3265,49 @@ md_assemble (char *instruction_string)
       return;
     }
 
+  if (peephole && compress && !xmov_flag
+      && insn.reloc.type == BFD_RELOC_NONE && insn2.reloc.type == BFD_RELOC_NONE
+      && op1.reloc.type == BFD_RELOC_NONE && op2.reloc.type == BFD_RELOC_NONE)
+    {
+      native = insn.code;
+      native_cond = condmask;
+      peep_kind = peephole_classify (op, native);
+      fuse = (peephole_last.kind != PEEPHOLE_NONE && size == 4
+              && op->compress_type == COMPRESS_XOP);
+    }
+
+#ifdef OBJ_ELF
+  /* Tie dwarf2 debug info to the address at the start of the insn.
+     An instruction folded into the one before it has no address of
+     its own.  */
+  if (!fuse)
+    dwarf2_emit_insn (0);
+#endif
+
+  /* branches to a simple symbol are left for relaxation to size */
+  if (op->format == PROPELLER_OPERAND_BRW || op->format == PROPELLER_OPERAND_BRL)
+    {
+      if (compress && op->format == PROPELLER_OPERAND_BRW)
+        {
+          if (op2.reloc.type != BFD_RELOC_NONE && op2.reloc.exp.X_op == O_symbol)
+            {
+              emit_relaxable_branch (op->format, condmask, &op2.reloc.exp);
+              elf_flags |= EF_PROPELLER_COMPRESS;
+              return;
+            }
+        }
+      else if (insn2.reloc.type != BFD_RELOC_NONE && insn2.reloc.exp.X_op == O_symbol
+               && (compress || (lmm && (insn.code & (7 << 23)) == 0)))
+        {
+          emit_relaxable_branch (op->format,
+                                 compress ? condmask : (unsigned) insn.code,
+                                 &insn2.reloc.exp);
+          if (compress)
+            elf_flags |= EF_PROPELLER_COMPRESS;
+          return;
+        }
+    }
+
 
   /* check for possible compression */
   if (compress && op->compress_type && !insn_compressed) {
@@ -2726,6 +3536,21 @@ md_assemble (char *instruction_string)
     insn_compressed = 1;
   }
 
+  if (fuse)
+    {
+      if (insn_compressed && !insn2.code
+          && peephole_fuse (op, native, native_cond, insn.code, size))
+        {
+#ifdef OBJ_ELF
+          dwarf2_consume_line_info ();
+#endif
+          return;
+        }
+#ifdef OBJ_ELF
+      dwarf2_emit_insn (0);
+#endif
+    }
+
   {
     unsigned int insn_size;
     unsigned int alloc_size;
@@ -2747,6 +3572,17 @@ md_assemble (char *instruction_string)
     }
     to = frag_more (size);
     alloc_size = size;
+    where = to - frag_now->fr_literal;
+
+    /* mvi and mviw of a symbol may turn out to fit a shorter form */
+    if (insn_compressed && op->format == PROPELLER_OPERAND_MVI
+        && (insn2.reloc.type == BFD_RELOC_32
+            || op2.reloc.type == BFD_RELOC_16))
+      mark_relaxable (frag_now, to - frag_now->fr_literal);
+    else if (!compress && !prop2
+             && (op->format == PROPELLER_OPERAND_MVI
+                 || op->format == PROPELLER_OPERAND_LDI))
+      mark_lmm_literal (frag_now, to - frag_now->fr_literal);
 
     if (compress) {
       if (!insn_compressed) {
@@ -2783,7 +3619,8 @@ md_assemble (char *instruction_string)
     /* insn2 is never used for real instructions, but is useful */
     /* for some pseudoinstruction for LMM and such. */
     /* note that we never have to do this for compressed instructions */
-    if (insn2.reloc.type != BFD_RELOC_NONE || insn2.code)
+    if (insn2.reloc.type != BFD_RELOC_NONE || insn2.code
+        || (!compress && size == 8))
       {
         if (compress && !insn2_compressed) {
           md_number_to_chars ( to, MACRO_NATIVE, 1 );
@@ -2807,19 +3644,97 @@ md_assemble (char *instruction_string)
   }
   if (insn_compressed)
     elf_flags |= EF_PROPELLER_COMPRESS;
+  peephole_note (peep_kind, native, native_cond, where);
 }
 
 int
-md_estimate_size_before_relax (fragS * fragP ATTRIBUTE_UNUSED,
-                               segT segment ATTRIBUTE_UNUSED)
+md_estimate_size_before_relax (fragS * fragP, segT segment)
 {
-  return 0;
+  /* a branch to another section, or to a symbol which may be
+     overridden at link time, cannot be relaxed; use the longest form */
+  if (S_GET_SEGMENT (fragP->fr_symbol) != segment
+      || S_IS_WEAK (fragP->fr_symbol))
+    {
+      while (md_relax_table[fragP->fr_subtype].rlx_more)
+        fragP->fr_subtype = md_relax_table[fragP->fr_subtype].rlx_more;
+    }
+  return md_relax_table[fragP->fr_subtype].rlx_length;
 }
 
+/* write out the encoding relaxation picked for a branch */
 void
 md_convert_frag (bfd * headers ATTRIBUTE_UNUSED,
-                 segT seg ATTRIBUTE_UNUSED, fragS * fragP ATTRIBUTE_UNUSED)
+                 segT seg ATTRIBUTE_UNUSED, fragS * fragP)
 {
+  char *buf = fragP->fr_literal + fragP->fr_fix;
+  unsigned int cond;
+  valueT code;
+  fixS *fixP;
+  int size;
+
+  switch (fragP->fr_subtype)
+    {
+    case RELAX_CMM_BRW_BRS:
+    case RELAX_CMM_BRL_BRS:
+      cond = buf[0] & 0xf;
+      md_number_to_chars (buf, PREFIX_BRS | cond, 1);
+      md_number_to_chars (buf + 1, 0, 1);
+      fixP = fix_new (fragP, fragP->fr_fix + 1, 1, fragP->fr_symbol,
+                      fragP->fr_offset, 1, BFD_RELOC_8_PCREL);
+      fixP->fx_tcbit = 1;
+      size = 2;
+      break;
+    case RELAX_CMM_BRW_BRW:
+    case RELAX_CMM_BRL_BRW:
+      cond = buf[0] & 0xf;
+      md_number_to_chars (buf, PREFIX_BRW | cond, 1);
+      md_number_to_chars (buf + 1, 0, 2);
+      mark_relaxable (fragP, fragP->fr_fix);
+      fixP = fix_new (fragP, fragP->fr_fix + 1, 2, fragP->fr_symbol,
+                      fragP->fr_offset, 1, BFD_RELOC_16_PCREL);
+      fixP->fx_tcbit = 1;
+      size = 3;
+      break;
+    case RELAX_CMM_BRL_LJMP:
+      md_number_to_chars (buf, PREFIX_MACRO | MACRO_LJMP, 1);
+      md_number_to_chars (buf + 1, 0, 4);
+      mark_relaxable (fragP, fragP->fr_fix);
+      fixP = fix_new (fragP, fragP->fr_fix + 1, 4, fragP->fr_symbol,
+                      fragP->fr_offset, 0, BFD_RELOC_32);
+      fixP->fx_tcbit = 1;
+      size = 5;
+      break;
+    case RELAX_LMM_BRS:
+      /* brs is "add pc,#n" (or sub, chosen by the fixup) */
+      code = md_chars_to_number ((unsigned char *) buf, 4);
+      code = 0x80000000 | (code & CC_MASK) | (1 << 23) | (1 << 22);
+      md_number_to_chars (buf, code, 4);
+      fix_new (fragP, fragP->fr_fix, 4, symbol_find_or_make ("pc"),
+               0, 0, BFD_RELOC_PROPELLER_DST);
+      fixP = fix_new (fragP, fragP->fr_fix, 4, fragP->fr_symbol,
+                      fragP->fr_offset, 1, BFD_RELOC_PROPELLER_PCREL10);
+      fixP->fx_tcbit = 1;
+      size = 4;
+      break;
+    case RELAX_LMM_JMP:
+      /* the address is stored after the jmp; for a conditional jump
+         it must decode as a no-op, hence the 23 bit relocation */
+      code = md_chars_to_number ((unsigned char *) buf, 4);
+      cond = (code >> 18) & 0xf;
+      fix_new (fragP, fragP->fr_fix, 4, symbol_find_or_make ("__LMM_JMP"),
+               0, 0, BFD_RELOC_PROPELLER_SRC);
+      md_number_to_chars (buf + 4, 0, 4);
+      fixP = fix_new (fragP, fragP->fr_fix + 4, 4, fragP->fr_symbol,
+                      fragP->fr_offset, 0,
+                      cond == 0xf ? BFD_RELOC_32 : BFD_RELOC_PROPELLER_23);
+      fixP->fx_tcbit = 1;
+      size = 8;
+      break;
+    default:
+      BAD_CASE (fragP->fr_subtype);
+      return;
+    }
+  fragP->fr_fix += size;
 }
 
 void
@@ -2827,6 +3742,14 @@ propeller_frob_label (symbolS * sym)
 {
   unsigned int flag = 0;
   static const int null_flag = 0;
+  struct dual_section *ds;
+
+  /* nothing may be folded across a label */
+  peephole_last.kind = PEEPHOLE_NONE;
+
+  ds = dual_find (now_seg, 1);
+  if (ds != NULL && S_GET_SEGMENT (sym) == now_seg)
+    dual_label (ds, sym);
 
   if (compress) {
     flag |= PROPELLER_OTHER_COMPRESSED;
@@ -2881,6 +3804,15 @@ md_parse_option (int c, const char *arg)
     case OPTION_MD_PASM:
       pasm_default = 1;
       break;
+    case OPTION_MD_RELAX:
+      propeller_relax = 1;
+      break;
+    case OPTION_MD_PEEPHOLE:
+      peephole = 1;
+      break;
+    case OPTION_MD_DUAL:
+      dual = 1;
+      break;
     default:
       return 0;
     }
@@ -2895,6 +3827,10 @@ Propeller options\n\
   --lmm\t\tEnable LMM instructions.\n\
   --cmm\t\tEnable compressed instructions.\n\
   --p2\t\tEnable Propeller 2 instructions.\n\
+  --relax\t\tPrepare compressed and LMM code for linker relaxation.\n\
+  --peephole\t\tCombine compressed instructions into shorter forms.\n\
+  --dual-encoding\tAlso emit .text code in the other of LMM and CMM, for\n\
+\t\t\tthe linker to choose between.\n\
 ");
 }
 
@@ -3002,131 +3938,117 @@ static int pasm_replace_expression (expressionS *exp)
 }
 
 
+/*
+ * PASM ":name" labels are local to the code between two global labels.
+ * Each distinct name gets one entry, which lives in colonsym_hash for
+ * the whole assembly; an entry from an earlier generation is free to
+ * be used again.  The entries used since the last global label are
+ * chained on colonsyms, so clearing them is cheap.
+ */
 typedef struct prop_localsym {
     struct prop_localsym *next;
-    char *name;
+    const char *name;
+    unsigned int generation;
     int defined;
     int value;
 } Prop_LocalSym;
 
+static struct hash_control *colonsym_hash;
+static struct obstack colonsym_obstack;
+static unsigned int colonsym_generation = 1;
 static Prop_LocalSym *colonsyms = 0;
 static int colonval = 0;
 
 /*
- * free and clear the list of local symbols
+ * start a new generation of local symbols
  * also reports any that were never defined
  */
 static void
 clear_colonsyms(void)
 {
-    Prop_LocalSym *cur, *next;
-    cur = colonsyms;
-    while (cur) {
-        next = cur->next;
+    Prop_LocalSym *cur;
+
+    if (!colonsyms)
+        return;
+    for (cur = colonsyms; cur; cur = cur->next) {
         if (!cur->defined) {
             as_bad (_("Local symbol `%s' never defined"), cur->name);
         }
-        xfree(cur->name);
-        xfree(cur);
-        cur = next;
     }
     colonsyms = 0;
     colonval = 0;
+    colonsym_generation++;
 }
 
 /*
- * look up a local sym, allocating it if necessary
+ * look up the local sym of LEN characters at S, allocating it if
+ * necessary
  */
 static Prop_LocalSym *
-lookup_colonsym(const char *s)
+lookup_colonsym(const char *s, size_t len)
 {
     Prop_LocalSym *r;
 
-    for (r = colonsyms; r; r = r->next) {
-        if (!strcmp(s, r->name)) {
-            return r;
-        }
+    if (!colonsym_hash) {
+        colonsym_hash = hash_new_sized (1021);
+        obstack_begin (&colonsym_obstack, 0);
+    }
+    r = (Prop_LocalSym *) hash_find_n (colonsym_hash, s, len);
+    if (!r) {
+        r = (Prop_LocalSym *) obstack_alloc (&colonsym_obstack, sizeof(*r));
+        r->name = (const char *) obstack_copy0 (&colonsym_obstack, s, len);
+        r->generation = 0;
+        hash_insert (colonsym_hash, r->name, r);
+    }
+    if (r->generation != colonsym_generation) {
+        r->generation = colonsym_generation;
+        r->defined = 0;
+        r->value = colonval++;
+        r->next = colonsyms;
+        colonsyms = r;
     }
-    /* if we get here, allocate a new one */
-    r = (Prop_LocalSym *)xmalloc (sizeof(*r));
-    r->name = xstrdup (s);
-    r->defined = 0;
-    r->value = colonval++;
-    r->next = colonsyms;
-    colonsyms = r;
     return r;
 }
 
 /*
- * read a name from *input_ptr; include the ':'
+ * rewrite the local label at s (including the ':') into "val$", or
+ * "val$:" at the start of a line; returns the position after it
  */
-
-static char *
-get_colon_name(char *input_ptr)
-{
-    char *name = input_ptr++;
-    char save_c;
-    while (is_part_of_name (*input_ptr))
-        input_ptr++;
-    save_c = *input_ptr;
-    *input_ptr = 0;
-    name = xstrdup (name);
-    *input_ptr = save_c;
-    return name;
-}
-
 static char *
 handle_colon(char *s, int start_of_line)
 {
-    char *p;
-    char *name;
+    char *p, *end, *eol;
     Prop_LocalSym *sym;
     char buf[80];
-    int i;
+    size_t len, n;
 
-    name = get_colon_name (s);
-    sym = lookup_colonsym (name);
+    end = s + 1;
+    while (is_part_of_name (*end))
+        end++;
+    len = end - s;
+    sym = lookup_colonsym (s, len);
     if (start_of_line) {
         if (sym->defined) {
-            as_bad (_("Symbol `%s' redefined"), name);
-            xfree (name);
+            as_bad (_("Symbol `%.*s' redefined"), (int) len, s);
         }
         sym->defined = 1;
     }
 
-    // now rewrite s into "val$:"
-    p = s;
-    s += strlen(name);
-#if 0
-    while (*s != '\n' && ISSPACE (*s)) {
-        s++;
-    }
-#endif
-    sprintf (buf, "%d", sym->value);
-    if ((size_t)(strlen(buf)+1+start_of_line) > (size_t)(s - p)) {
-        as_bad (_("Not enough space for temporary label `%s'"), name);
-    } else {
-        for (i = 0; buf[i]; i++) {
-            *p++ = buf[i];
-        }
-        *p++ = '$';
-        if (start_of_line)
-            *p++ = ':';
-#if 0
-        while (!ISSPACE (*p) && p != s) {
-            *p++ = ' ';
-        }
-#else
-        // don't insert any extraneous space
-        while(*s) {
-            *p++ = *s++;
-        }
-        *p++ = 0;
-#endif
+    n = sprintf (buf, "%d$%s", sym->value, start_of_line ? ":" : "");
+    if (n > len) {
+        as_bad (_("Not enough space for temporary label `%.*s'"), (int) len, s);
+        return end;
     }
-    xfree (name);
+    memcpy (s, buf, n);
+    p = s + n;
 
-    return s;
+    // close up the rest of the line behind it, and pad the end so
+    // that no extraneous space goes into the middle of the line
+    eol = end + strcspn (end, "\n");
+    memmove (p, end, eol - end);
+    memset (p + (eol - end), ' ', end - p);
+
+    return p;
 }
 
 static void
@@ -3187,21 +4109,24 @@ propeller_start_line_hook (void)
       }
 
     /* check some things at start of line */
-    if (matchword (s, "con") || matchword (s, "dat")) {
-        // erase the word, but keep processing the line
-        // in case they put code after it
-        s[0] = s[1] = s[2] = ' ';
-        is_spin_file = 1;
-        skip_spin_code = 0;
-    }
-    if (is_spin_file
-        && (matchword (s, "pub")
-            || matchword (s, "pri")
-            || matchword (s, "var")
-            || matchword (s, "obj")
-            ))
+    if (ISALPHA (*s))
       {
-        skip_spin_code = 1;
+        if (matchword (s, "con") || matchword (s, "dat")) {
+            // erase the word, but keep processing the line
+            // in case they put code after it
+            s[0] = s[1] = s[2] = ' ';
+            is_spin_file = 1;
+            skip_spin_code = 0;
+        }
+        if (is_spin_file
+            && (matchword (s, "pub")
+                || matchword (s, "pri")
+                || matchword (s, "var")
+                || matchword (s, "obj")
+                ))
+          {
+            skip_spin_code = 1;
+          }
       }
     if (skip_spin_code)
       {
@@ -3222,9 +4147,12 @@ propeller_start_line_hook (void)
           }
         else if (in_quote)
           {
+            s += strcspn (s, "\"\n");
             if (*s == '"')
+              {
                 in_quote = 0;
-            s++;
+                s++;
+              }
           }
         else if (*s == ':' && is_part_of_name (s[1]))
           {
@@ -3250,7 +4178,9 @@ propeller_start_line_hook (void)
           }
         else
           {
-            s++;
+            /* skip to the next character that may start something
+               to rewrite */
+            s += 1 + strcspn (s + 1, ":$\"{\n");
           }
       }
 
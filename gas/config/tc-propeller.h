@@ -48,7 +48,8 @@ long md_chars_to_number (unsigned char *, int);
 
 void propeller_frob_label (symbolS * s);
 
-#define tc_fix_adjustable(f) 0
+#define tc_fix_adjustable(f) propeller_fix_adjustable (f)
+int propeller_fix_adjustable (struct fix *);
 
 #define elf_tc_final_processing propeller_elf_final_processing
 void propeller_elf_final_processing (void);
@@ -61,9 +62,46 @@ void propeller_elf_final_processing (void);
 TC_PARSE_CONS_RETURN_TYPE propeller_cons (expressionS *, int);
 void propeller_cons_fix_new (struct frag *, int, unsigned int, struct expressionS *, TC_PARSE_CONS_RETURN_TYPE reloc);
 
+/* compressed and LMM branches are relaxed to the shortest form that
+   reaches their target */
+extern const struct relax_type md_relax_table[];
+#define TC_GENERIC_RELAX_TABLE md_relax_table
+
+/* with --relax the linker may shrink compressed code, so pc relative
+   fixups are kept as relocations and the line table uses fixed size
+   address advances which the linker can patch */
+extern int propeller_relax;
+#define TC_FORCE_RELOCATION_LOCAL(FIX) \
+  (propeller_relax || !(FIX)->fx_pcrel || TC_FORCE_RELOCATION (FIX))
+#define DWARF2_USE_FIXED_ADVANCE_PC propeller_relax
+
+/* a difference of two symbols in code is left for the linker as an
+   R_PROPELLER_DIFF reloc when it may shrink code between them */
+#define md_allow_local_subtract(l, r, s) \
+  propeller_allow_local_subtract (l, r, s)
+bfd_boolean propeller_allow_local_subtract (expressionS *, expressionS *,
+                                            segT);
+#define TC_FORCE_RELOCATION_SUB_SAME(FIX, SEG) \
+  (! SEG_NORMAL (SEG) || propeller_force_relocation_sub_same (FIX, SEG))
+int propeller_force_relocation_sub_same (struct fix *, segT);
+#define TC_VALIDATE_FIX_SUB(FIX, SEG) \
+  (propeller_relax && (SEG) == S_GET_SEGMENT ((FIX)->fx_subsy))
+/* nor may call frame information use differences of code addresses;
+   a .debug_frame written out with .4byte gets DIFF relocs instead */
+#define CFI_DIFF_EXPR_OK 0
+#define md_do_align(N, FILL, LEN, MAX, LABEL) \
+  propeller_do_align (N, FILL, MAX)
+void propeller_do_align (int, const char *, int);
+
 #define md_start_line_hook propeller_start_line_hook
 void propeller_start_line_hook (void);
 
+/* --dual-encoding sorts out its alternate sections before relaxation */
+#define md_pre_relax_hook propeller_dual_finish ()
+void propeller_dual_finish (void);
+#define tc_frob_symbol(sym, punt) propeller_frob_symbol (sym)
+void propeller_frob_symbol (symbolS *);
+
 extern const char propeller_symbol_chars[];
 #define tc_symbol_chars propeller_symbol_chars
 
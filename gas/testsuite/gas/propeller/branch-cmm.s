@@ -0,0 +1,30 @@
+# brw and brl pick the shortest form which reaches their target.
+	.text
+	.global	_start
+_start:
+	brw	#fwd1		' brs: 129 bytes forward
+	.space	127
+fwd1:
+	brw	#fwd2		' brw: 130 bytes forward
+	.space	128
+fwd2:
+	.space	126
+	brw	#fwd2		' brs: 126 bytes back
+bwd1:
+	.space	127
+	brw	#bwd1		' brw: 127 bytes back
+
+	brl	#fwd3		' brs
+	.space	127
+fwd3:
+	brl	#fwd4		' brw: 130 bytes forward
+	.space	128
+fwd4:
+	brl	#fwd5		' brw: 32770 bytes forward
+	.space	32767
+fwd5:
+	brl	#fwd6		' ljmp: 32771 bytes forward
+	.space	32768
+fwd6:
+	brl	#ext		' ljmp: in another object
+	nop
@@ -0,0 +1,22 @@
+# brw and brl are a single add or sub of pc if the target is within
+# 511 bytes of the end of the branch, and jmp #__LMM_JMP otherwise.
+# The targets are local labels, so the disassembly stays in step.
+	.text
+	.global	_start
+_start:
+	brw	#.Lfwd1		' add pc,#511
+	.space	511
+.Lfwd1:
+	.space	1
+	brw	#.Lfwd2		' jmp: 512 bytes
+	.space	512
+.Lfwd2:
+	.space	1
+.Lbwd1:
+	.space	3
+.Lbwd2:
+	.space	504
+	brw	#.Lbwd1		' sub pc,#511
+	brl	#.Lbwd2		' jmp: 512 bytes
+	brl	#ext		' jmp: in another object
+	nop
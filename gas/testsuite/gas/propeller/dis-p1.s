@@ -0,0 +1,79 @@
+# One instruction word for each P1 entry of propeller_opcodes, so that
+# the disassembler's hashed lookup is checked against the whole table.
+	.text
+	.long	0x00000000
+	.long	0x803c0000
+	.long	0x84bc0000
+	.long	0x08bc0000
+	.long	0x5c3c0000
+	.long	0xa03c0000
+	.long	0x5cbc0000
+	.long	0xa0bc0000
+	.long	0x00bc0000
+	.long	0x043c0000
+	.long	0x04bc0000
+	.long	0x083c0000
+	.long	0x0c7c0000
+	.long	0x0c7c0001
+	.long	0x0c7c0002
+	.long	0x0c7c0003
+	.long	0x0c7c0004
+	.long	0x0c7c0005
+	.long	0x0c7c0006
+	.long	0x0c7c0007
+	.long	0x0c3c0000
+	.long	0x203c0000
+	.long	0x243c0000
+	.long	0x283c0000
+	.long	0x2c3c0000
+	.long	0x303c0000
+	.long	0x343c0000
+	.long	0x383c0000
+	.long	0x3c3c0000
+	.long	0x403c0000
+	.long	0x443c0000
+	.long	0x483c0000
+	.long	0x4c3c0000
+	.long	0x503c0000
+	.long	0x543c0000
+	.long	0x583c0000
+	.long	0x5c7c0000
+	.long	0x603c0000
+	.long	0x643c0000
+	.long	0x683c0000
+	.long	0x6c3c0000
+	.long	0x703c0000
+	.long	0x743c0000
+	.long	0x783c0000
+	.long	0x7c3c0000
+	.long	0x843c0000
+	.long	0x883c0000
+	.long	0x8c3c0000
+	.long	0x903c0000
+	.long	0x943c0000
+	.long	0x983c0000
+	.long	0x9c3c0000
+	.long	0xa43c0000
+	.long	0xa83c0000
+	.long	0xac3c0000
+	.long	0xb03c0000
+	.long	0xb43c0000
+	.long	0xb83c0000
+	.long	0xbc3c0000
+	.long	0xc03c0000
+	.long	0xc43c0000
+	.long	0xc83c0000
+	.long	0xcc3c0000
+	.long	0xccbc0000
+	.long	0xd03c0000
+	.long	0xd43c0000
+	.long	0xd83c0000
+	.long	0xdc3c0000
+	.long	0xe03c0000
+	.long	0xe43c0000
+	.long	0xe83c0000
+	.long	0xec3c0000
+	.long	0xf03c0000
+	.long	0xf43c0000
+	.long	0xf83c0000
+	.long	0xfc3c0000
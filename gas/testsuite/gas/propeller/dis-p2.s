@@ -0,0 +1,287 @@
+# One instruction word for each P2 entry of propeller_opcodes, so that
+# the disassembler's hashed lookup is checked against the whole table.
+	.text
+	.long	0x00000000
+	.long	0x803c0000
+	.long	0x84bc0000
+	.long	0x09bc0000
+	.long	0x1c3c0000
+	.long	0xa03c0000
+	.long	0x1cbc0000
+	.long	0xa0bc0000
+	.long	0x0c7c0000
+	.long	0x0c7c0001
+	.long	0x0c7c0003
+	.long	0x0c7c0004
+	.long	0x0c7c0005
+	.long	0x0c7c0006
+	.long	0x0c7c0007
+	.long	0x203c0000
+	.long	0x243c0000
+	.long	0x283c0000
+	.long	0x2c3c0000
+	.long	0x303c0000
+	.long	0x343c0000
+	.long	0x383c0000
+	.long	0x3c3c0000
+	.long	0x403c0000
+	.long	0x443c0000
+	.long	0x483c0000
+	.long	0x4c3c0000
+	.long	0x503c0000
+	.long	0x543c0000
+	.long	0x583c0000
+	.long	0x603c0000
+	.long	0x643c0000
+	.long	0x683c0000
+	.long	0x6c3c0000
+	.long	0x703c0000
+	.long	0x743c0000
+	.long	0x783c0000
+	.long	0x7c3c0000
+	.long	0x843c0000
+	.long	0x883c0000
+	.long	0x8c3c0000
+	.long	0x903c0000
+	.long	0x943c0000
+	.long	0x983c0000
+	.long	0x9c3c0000
+	.long	0xa43c0000
+	.long	0xa83c0000
+	.long	0xac3c0000
+	.long	0xb03c0000
+	.long	0xb43c0000
+	.long	0xb83c0000
+	.long	0xbc3c0000
+	.long	0xc03c0000
+	.long	0xc43c0000
+	.long	0xc83c0000
+	.long	0xcc3c0000
+	.long	0xccbc0000
+	.long	0xd03c0000
+	.long	0xd43c0000
+	.long	0xd83c0000
+	.long	0xdc3c0000
+	.long	0x00bc0000
+	.long	0x01bc0000
+	.long	0x043c0000
+	.long	0x04bc0000
+	.long	0x05bc0000
+	.long	0x083c0000
+	.long	0x08bc0000
+	.long	0x0c3c0000
+	.long	0x0c7c0008
+	.long	0x0c7c0208
+	.long	0x0c7c0408
+	.long	0x0c7c0608
+	.long	0x0c7c0a08
+	.long	0x0c7c0c08
+	.long	0x0c7c0e08
+	.long	0x0c7c0009
+	.long	0x0cfc0009
+	.long	0x0c7c000a
+	.long	0x0c7c000b
+	.long	0x0c7c000c
+	.long	0x0c7c000d
+	.long	0x0cfc000d
+	.long	0x0c7c000e
+	.long	0x0c7c000f
+	.long	0x0c7c0010
+	.long	0x0c7c0011
+	.long	0x0c7c0012
+	.long	0x0c7c0013
+	.long	0x0c7c0014
+	.long	0x0c7c0015
+	.long	0x0c7c0016
+	.long	0x0c7c0017
+	.long	0x0c7c0018
+	.long	0x0c7c0019
+	.long	0x0c7c001a
+	.long	0x0c7c001b
+	.long	0x0c7c001c
+	.long	0x0c7c001d
+	.long	0x0c7c001e
+	.long	0x0c7c001f
+	.long	0x0c7c0020
+	.long	0x0c7c0021
+	.long	0x0c7c0022
+	.long	0x0c7c0023
+	.long	0x0c7c0024
+	.long	0x0c7c0025
+	.long	0x0c7c0026
+	.long	0x0c7c0027
+	.long	0x0c7c0028
+	.long	0x0c7c0029
+	.long	0x0c7c002a
+	.long	0x0c7c002b
+	.long	0x0c7c002c
+	.long	0x0c7c002d
+	.long	0x0c7c002e
+	.long	0x0c7c002f
+	.long	0x0c7c0030
+	.long	0x0c7c0031
+	.long	0x0c7c0032
+	.long	0x0c7c0033
+	.long	0x0c7c0034
+	.long	0x0c7c0035
+	.long	0x0c7c0036
+	.long	0x0c7c0037
+	.long	0x0c7c0038
+	.long	0x0c7c0039
+	.long	0x0c7c003a
+	.long	0x0c7c003b
+	.long	0x0c7c003c
+	.long	0x0c7c003d
+	.long	0x0c7c003e
+	.long	0x0c7c003f
+	.long	0x0c7c0040
+	.long	0x0dfc0040
+	.long	0x0c7c0080
+	.long	0x0c7c00a0
+	.long	0x0c7c00a1
+	.long	0x0c7c00a2
+	.long	0x0c7c00a3
+	.long	0x0c7c00a4
+	.long	0x0c7c00a5
+	.long	0x0c7c00a6
+	.long	0x0c7c00a7
+	.long	0x0c7c00a8
+	.long	0x0c7c00a9
+	.long	0x0c7c00aa
+	.long	0x0c7c00ab
+	.long	0x0c7c00ac
+	.long	0x0c7c00ad
+	.long	0x0c7c00ae
+	.long	0x0c7c00af
+	.long	0x0c7c00b0
+	.long	0x0c7c00b1
+	.long	0x0d7c00b1
+	.long	0x0c7c00b2
+	.long	0x0c7c00b3
+	.long	0x0c7c00b4
+	.long	0x0c7c00b5
+	.long	0x0c7c00b6
+	.long	0x0c7c00b7
+	.long	0x0c7c00b8
+	.long	0x0c7c00b9
+	.long	0x0c7c00ba
+	.long	0x0c7c00bb
+	.long	0x0c7c00bc
+	.long	0x0c7c00bd
+	.long	0x0c7c00be
+	.long	0x0c7c00bf
+	.long	0x0c7c00c0
+	.long	0x0d7c00c0
+	.long	0x0c7c00c1
+	.long	0x0c7c00c2
+	.long	0x0d7c00c2
+	.long	0x0c7c00c3
+	.long	0x0c7c00c4
+	.long	0x0c7c00c5
+	.long	0x0c7c00c6
+	.long	0x0c7c00c7
+	.long	0x0c7c00c8
+	.long	0x0c7c00c9
+	.long	0x0c7c00ca
+	.long	0x0c7c0094
+	.long	0x0c7c00cc
+	.long	0x0c7c00cd
+	.long	0x0c7c00ce
+	.long	0x0c7c00cf
+	.long	0x0c7c00d0
+	.long	0x0c7c00d1
+	.long	0x0c7c00d2
+	.long	0x0c7c00d3
+	.long	0x0c7c00d4
+	.long	0x0d3c00d5
+	.long	0x0c7c00d6
+	.long	0x0c7c00d7
+	.long	0x0c7c00d8
+	.long	0x0c7c00d9
+	.long	0x0c7c00da
+	.long	0x0c7c00db
+	.long	0x0c7c00dc
+	.long	0x0c7c00dd
+	.long	0x0c7c00de
+	.long	0x0c7c00df
+	.long	0x0c7c00e0
+	.long	0x0c7c00e1
+	.long	0x0c7c00e2
+	.long	0x0d7c00e2
+	.long	0x0c7c00e3
+	.long	0x0c7c00e4
+	.long	0x0c7c00e5
+	.long	0x0c7c00e6
+	.long	0x0c7c00e7
+	.long	0x0c7c00e8
+	.long	0x0c7c00e9
+	.long	0x0c7c00ea
+	.long	0x0c7c00eb
+	.long	0x0c7c00ec
+	.long	0x0c7c00ed
+	.long	0x0c7c00ee
+	.long	0x0c7c00ef
+	.long	0x0c7c00f0
+	.long	0x0c7c00f1
+	.long	0x0c7c00f2
+	.long	0x0c7c00f3
+	.long	0x0c7c00f4
+	.long	0x0c7c00f5
+	.long	0x0c7c00f6
+	.long	0x0c7c00f7
+	.long	0x0c7c00f8
+	.long	0x0c7c00f9
+	.long	0x0c7c00fa
+	.long	0x0c7c00fb
+	.long	0x0c7c00fc
+	.long	0x0c7c00fd
+	.long	0x0c7c00fe
+	.long	0x0c7c00ff
+	.long	0x0c7c0100
+	.long	0x0c7c0120
+	.long	0x0c7c0140
+	.long	0x0c7c0160
+	.long	0x0c7c0180
+	.long	0x0c7c01a0
+	.long	0x0c7c01c0
+	.long	0x0c7c01e0
+	.long	0x103c0000
+	.long	0x113c0000
+	.long	0x123c0000
+	.long	0x133c0000
+	.long	0x10bc0000
+	.long	0x143c0000
+	.long	0x153c0000
+	.long	0x163c0000
+	.long	0x173c0000
+	.long	0x14bc0000
+	.long	0x18bc0000
+	.long	0x1c7c0000
+	.long	0x5c3c0000
+	.long	0x5c7c0000
+	.long	0x5cbc0000
+	.long	0xe03c0000
+	.long	0xe43c0000
+	.long	0xe83c0000
+	.long	0xec3c0000
+	.long	0xe0bc0000
+	.long	0xe4bc0000
+	.long	0xf03c0000
+	.long	0xf13c0000
+	.long	0xf23c0000
+	.long	0xf33c0000
+	.long	0xf43c0000
+	.long	0xf53c0000
+	.long	0xf63c0000
+	.long	0xf73c0000
+	.long	0xf83c0000
+	.long	0xf93c0000
+	.long	0xfa3c0000
+	.long	0xfb3c0000
+	.long	0xf8bc0000
+	.long	0xf9bc0000
+	.long	0xfabc0000
+	.long	0xfbbc0000
+	.long	0xfc3c0000
+	.long	0xfe3c0000
+	.long	0xfebc0000
@@ -0,0 +1,10 @@
+' The other encoding of a function gets a section type of its own,
+' and references to a local label keep the label, for the linker to
+' move to its twin.
+	.section .text.helper,"ax",@progbits
+helper:
+	mov	r2,r3
+	.section .text.data,"ax",@progbits
+table:
+	.long	helper
+	.long	0
@@ -0,0 +1,12 @@
+' PASM :local labels, defined and used on the same line, and reused
+' after each global label.
+	.pasm
+	.text
+func1
+:loop	djnz	r0, #:loop
+	jmp	#:done
+:done	mov	r1, #:done
+func2
+:loop	djnz	r1, #:loop
+	jmp	#:done
+:done	ret
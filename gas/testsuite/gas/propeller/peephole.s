@@ -0,0 +1,32 @@
+' --peephole folds a register move into the instruction after it, and
+' shortens mvi of a constant.
+	.text
+	.global	_start
+_start:
+	mov	r1,r2		' xmov with a register operand
+	add	r3,r4
+	mov	r1,r2		' xmov with a 4 bit immediate
+	sub	r3,#5
+	if_z	mov	r1,r2	' xmov behind a skip
+	if_z	add	r3,r4
+	mov	r5,sp		' leasp
+	add	r5,#16
+
+	mov	r1,r2		' no: a label in between
+label1:
+	add	r3,r4
+	mov	r1,r2		' no: different conditions
+	if_z	add	r3,r4
+	mov	r5,sp		' no: a different register
+	add	r6,#16
+	mov	r5,sp		' no: too big for leasp
+	add	r5,#300
+	mov	r5,sp		' no: a relocation
+	add	r5,#ext
+
+	mvi	r0,#0		' zeroreg
+	mvi	r1,#200		' mvib
+	mvi	r2,#0x1234	' mviw
+	mvi	r3,#0x12345	' mvi
+	if_z	mvi	r4,#0	' no: conditional
+	mvi	r5,#ext		' no: a relocation
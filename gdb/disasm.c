@@ -791,6 +791,11 @@ gdb_disassembler::gdb_disassembler (struct gdbarch *gdbarch,
   disassemble_init_for_target (&m_di);
 }
 
+gdb_disassembler::~gdb_disassembler ()
+{
+  disassemble_free_target (&m_di);
+}
+
 int
 gdb_disassembler::print_insn (CORE_ADDR memaddr,
 			      int *branch_delay_insns)
@@ -908,10 +913,13 @@ gdb_buffered_insn_length (struct gdbarch *gdbarch,
 			  const gdb_byte *insn, int max_len, CORE_ADDR addr)
 {
   struct disassemble_info di;
+  int len;
 
   gdb_buffered_insn_length_init_dis (gdbarch, &di, insn, max_len, addr);
 
-  return gdbarch_print_insn (gdbarch, addr, &di);
+  len = gdbarch_print_insn (gdbarch, addr, &di);
+  disassemble_free_target (&di);
+  return len;
 }
 
 char *
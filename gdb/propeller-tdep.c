@@ -47,12 +47,14 @@
 #include "elf/propeller.h"
 #include "elf-bfd.h"
 #include "bfd-in2.h"
-
-#define PROPELLER_NUM_REGS 19
-#define PROPELLER_CCR_REGNUM 18
-#define PROPELLER_PC_REGNUM 17
-#define PROPELLER_SP_REGNUM 16
-#define PROPELLER_LR_REGNUM 15
+#include "gdb/sim-propeller.h"
+
+/* The register numbers are shared with the simulator.  */
+#define PROPELLER_NUM_REGS PROPELLER_SIM_NUM_REGS
+#define PROPELLER_CCR_REGNUM PROPELLER_SIM_CC_REGNUM
+#define PROPELLER_PC_REGNUM PROPELLER_SIM_PC_REGNUM
+#define PROPELLER_SP_REGNUM PROPELLER_SIM_SP_REGNUM
+#define PROPELLER_LR_REGNUM PROPELLER_SIM_LR_REGNUM
 #define PROPELLER_FP_REGNUM 14
 
 #define PROPELLER_R0_REGNUM 0
@@ -60,7 +62,7 @@
 
 #define NUM_ARG_REGS 6
 
-#define PROPELLER_CMM_BIT 0x40
+#define PROPELLER_CMM_BIT PROPELLER_SIM_CC_CMM
 
 struct gdbarch_tdep {
   int elf_flags;
@@ -164,21 +166,19 @@ struct propeller_frame_cache
   long locals;
 };
 
-/* Allocate and initialize a frame cache.  */
-static struct propeller_frame_cache *
-propeller_alloc_frame_cache (void)
+/* Initialize a frame cache.  */
+static void
+propeller_init_frame_cache (struct propeller_frame_cache *cache)
 {
-  struct propeller_frame_cache *cache;
   int i;
 
-  cache = FRAME_OBSTACK_ZALLOC (struct propeller_frame_cache);
-
   /* Base address.  */
   cache->base = 0;
   cache->sp_offset = 0;
   cache->pc = 0;
   cache->args = 0;
   cache->reg_bytes_saved = 0;
+  cache->saved_sp = 0;
 
   /* Saved registers.  We initialize these to -1 since
      zero is a valid offset  */
@@ -187,7 +187,16 @@ propeller_alloc_frame_cache (void)
 
   /* Frameless until proven otherwise.  */
   cache->locals = -1;
+}
+
+/* Allocate and initialize a frame cache.  */
+static struct propeller_frame_cache *
+propeller_alloc_frame_cache (void)
+{
+  struct propeller_frame_cache *cache;
 
+  cache = FRAME_OBSTACK_ZALLOC (struct propeller_frame_cache);
+  propeller_init_frame_cache (cache);
   return cache;
 }
 
@@ -230,9 +239,247 @@ CALL_P(unsigned int op, struct gdbarch *arch)
   return ((op & 0xfffc0000) == gdbarch_tdep(arch)->call_ins);
 }
 
-/* Do a full analysis of the prologue at PC and update CACHE
-   accordingly.  Bail out early if CURRENT_PC is reached.  Return the
-   address where the analysis stopped.
+/* The prologue is read in one piece of this many bytes: enough for the
+   longest LMM prologue, lpushm, mov and sub followed by a mov, sub and
+   wrlong for each argument register.  */
+#define PROLOGUE_WINDOW (16 + 12 * NUM_ARG_REGS)
+
+/* Prologue instructions, decoded from LMM or CMM code.  */
+enum propeller_prologue_op
+{
+  PROLOGUE_OTHER,
+  PROLOGUE_MOV,			/* mov dst, src */
+  PROLOGUE_SUB,			/* sub dst, #src */
+  PROLOGUE_WRLONG,		/* wrlong dst, src */
+  PROLOGUE_PUSHM,		/* lpushm #src */
+  PROLOGUE_LEASP		/* leasp dst, #src */
+};
+
+struct propeller_prologue_insn
+{
+  enum propeller_prologue_op op;
+  int dst;
+  int src;
+  CORE_ADDR pc;
+  CORE_ADDR next;
+};
+
+static void
+propeller_decode_native (unsigned int op, struct propeller_prologue_insn *insn)
+{
+  insn->dst = GET_DST(op);
+  insn->src = GET_SRC(op);
+  if (MOVE_P(op))
+    insn->op = PROLOGUE_MOV;
+  else if (SUB_P(op))
+    insn->op = PROLOGUE_SUB;
+  else if (WRLONG_P(op))
+    insn->op = PROLOGUE_WRLONG;
+  else
+    insn->op = PROLOGUE_OTHER;
+}
+
+/* Decode the CMM instruction at BUF into one or two (for xmov) prologue
+   instructions.  Returns the number of instructions, or 0 if BUF is
+   too short.  */
+static int
+propeller_decode_cmm (const gdb_byte *buf, int len,
+		      enum bfd_endian byte_order,
+		      struct propeller_prologue_insn *insn)
+{
+  int op = buf[0];
+  int size, xop, src, imm, n = 0;
+
+  switch (op & 0xf0)
+    {
+    case PREFIX_MACRO:
+      switch (op & 0x0f)
+	{
+	case MACRO_PUSHM: case MACRO_POPM: case MACRO_POPRET:
+	case MACRO_MVREG: case MACRO_ADDSP:
+	  size = 2;
+	  break;
+	case MACRO_LCALL: case MACRO_XMVREG: case MACRO_FCACHE:
+	  size = 3;
+	  break;
+	case MACRO_LJMP: case MACRO_NATIVE:
+	  size = 5;
+	  break;
+	default:
+	  size = 1;
+	  break;
+	}
+      break;
+    case PREFIX_REGREG: case PREFIX_REGIMM4: case PREFIX_BRS:
+    case PREFIX_MVIB: case PREFIX_LEASP:
+      size = 2;
+      break;
+    case PREFIX_REGIMM12: case PREFIX_BRW: case PREFIX_MVIW:
+    case PREFIX_XMOVREG: case PREFIX_XMOVIMM:
+      size = 3;
+      break;
+    case PREFIX_MVI:
+      size = 5;
+      break;
+    case PREFIX_PACK_NATIVE:
+      size = 4;
+      break;
+    default:
+      size = 1;
+      break;
+    }
+  if (size > len)
+    return 0;
+
+  insn[0].op = PROLOGUE_OTHER;
+  insn[0].next = insn[0].pc + size;
+  switch (op & 0xf0)
+    {
+    case PREFIX_MACRO:
+      switch (op & 0x0f)
+	{
+	case MACRO_PUSHM:
+	  insn[0].op = PROLOGUE_PUSHM;
+	  insn[0].src = buf[1];
+	  break;
+	case MACRO_MVREG:
+	  insn[0].op = PROLOGUE_MOV;
+	  insn[0].dst = buf[1] >> 4;
+	  insn[0].src = buf[1] & 0xf;
+	  break;
+	case MACRO_XMVREG:
+	  insn[0].op = PROLOGUE_MOV;
+	  insn[0].dst = buf[1] >> 4;
+	  insn[0].src = buf[1] & 0xf;
+	  insn[1] = insn[0];
+	  insn[1].dst = buf[2] >> 4;
+	  insn[1].src = buf[2] & 0xf;
+	  return 2;
+	case MACRO_ADDSP:
+	  /* add sp, or sub sp with a negative byte */
+	  if (buf[1] >= 0x80)
+	    {
+	      insn[0].op = PROLOGUE_SUB;
+	      insn[0].dst = PROPELLER_SP_REGNUM;
+	      insn[0].src = 0x100 - buf[1];
+	    }
+	  break;
+	case MACRO_NATIVE:
+	  propeller_decode_native (extract_unsigned_integer (buf + 1, 4,
+							     byte_order),
+				   &insn[0]);
+	  break;
+	}
+      break;
+    case PREFIX_XMOVREG:
+    case PREFIX_XMOVIMM:
+      /* xmov does a mov before the operation */
+      insn[0].op = PROLOGUE_MOV;
+      insn[0].dst = buf[1] >> 4;
+      insn[0].src = buf[1] & 0xf;
+      insn[1] = insn[0];
+      n = 1;
+      buf++;
+      /* fall through */
+    case PREFIX_REGREG:
+    case PREFIX_REGIMM4:
+    case PREFIX_REGIMM12:
+      if ((op & 0xf0) == PREFIX_REGIMM12)
+	{
+	  src = extract_unsigned_integer (buf + 1, 2, byte_order);
+	  xop = src >> 12;
+	  src &= 0xfff;
+	}
+      else
+	{
+	  xop = buf[1] & 0xf;
+	  src = buf[1] >> 4;
+	}
+      imm = (op & 0xf0) != PREFIX_REGREG && (op & 0xf0) != PREFIX_XMOVREG;
+      insn[n].op = PROLOGUE_OTHER;
+      insn[n].dst = op & 0xf;
+      insn[n].src = src;
+      if (xop == XOP_SUB && imm)
+	insn[n].op = PROLOGUE_SUB;
+      else if (xop == XOP_WRL && !imm)
+	insn[n].op = PROLOGUE_WRLONG;
+      return n + 1;
+    case PREFIX_LEASP:
+      insn[0].op = PROLOGUE_LEASP;
+      insn[0].dst = op & 0xf;
+      insn[0].src = buf[1];
+      break;
+    case PREFIX_PACK_NATIVE:
+      /* the condition is always; the rest is packed into three bytes */
+      src = buf[1] | (buf[2] << 8) | (buf[3] << 16);
+      propeller_decode_native ((src & 0x3ffff) | (((src >> 18) & 0x3f) << 26)
+			       | (0xf << 18) | ((op & 0xf) << 22), &insn[0]);
+      break;
+    }
+  return 1;
+}
+
+/* Decode the LEN bytes of code at BUF, read from PC, into at most MAX
+   prologue instructions.  Returns the number of instructions.  */
+static int
+propeller_decode_prologue (struct gdbarch *gdbarch, const gdb_byte *buf,
+			   int len, CORE_ADDR pc, int cmm,
+			   struct propeller_prologue_insn *insns, int max)
+{
+  enum bfd_endian byte_order = gdbarch_byte_order (gdbarch);
+  int off = 0, n = 0;
+
+  while (n + 2 <= max && off < len)
+    {
+      struct propeller_prologue_insn *insn = &insns[n];
+      int count = 1;
+
+      insn->pc = pc + off;
+      if (cmm)
+	count = propeller_decode_cmm (buf + off, len - off, byte_order, insn);
+      else if (off + 4 <= len)
+	{
+	  unsigned int op = extract_unsigned_integer (buf + off, 4, byte_order);
+
+	  propeller_decode_native (op, insn);
+	  insn->next = insn->pc + 4;
+	  /* lpushm is a mov of the register mask to __TMP0 followed by a
+	     call of __LMM_PUSHM */
+	  if (MOVE_P(op) && off + 8 <= len
+	      && CALL_P(extract_unsigned_integer (buf + off + 4, 4, byte_order),
+			gdbarch))
+	    {
+	      insn->op = PROLOGUE_PUSHM;
+	      insn->next = insn->pc + 8;
+	    }
+	}
+      else
+	count = 0;
+      if (count == 0)
+	break;
+      off = insns[n].next - pc;
+      n += count;
+    }
+  return n;
+}
+
+/* Read the prologue window at PC, or as much of it as there is before
+   the end of memory.  Returns the number of bytes read.  */
+static int
+propeller_read_prologue (CORE_ADDR pc, gdb_byte *buf)
+{
+  int len = PROLOGUE_WINDOW;
+
+  while (len > 0 && target_read_code (pc, buf, len) != 0)
+    len /= 2;
+  if (len == 0)
+    memory_error (TARGET_XFER_E_IO, pc);
+  return len;
+}
+
+/* Analyze the prologue instructions INSNS of the function at PC and
+   update CACHE accordingly.  Bail out early if CURRENT_PC is reached.
+   Return the address where the analysis stopped.
 
    We (intend to) handle all cases that can be generated by gcc.
 
@@ -274,42 +521,51 @@ Without:
   Note the repeats of "mov, sub, wrlong", which stash incoming
   parameters into the frame.
 
+  CMM code has the same prologues in compressed form: lpushm is
+  MACRO_PUSHM, sub sp is MACRO_ADDSP, the moves and wrlongs from and
+  to sp are packed native instructions, and the parameters may be
+  stored through a leasp instead of a mov and sub:
+
+    03 1e 	lpushm	#0x1e
+    f2 10 1c a0 	mov	r14, sp
+    0c f8 	sub	sp, #0x8
+    0a 7e 	mov	r7, r14
+    27 81 	sub	r7, #0x8
+    10 7f 	wrlong	r0, r7
+    c7 04 	leasp	r7, #0x4
+    11 7f 	wrlong	r1, r7
+
 */
 
 static CORE_ADDR
-propeller_analyze_prologue (struct gdbarch *gdbarch,
-			    CORE_ADDR pc,
-			    CORE_ADDR current_pc,
-			    struct propeller_frame_cache *cache){
-  enum bfd_endian byte_order = gdbarch_byte_order (gdbarch);
-  unsigned int op;
+propeller_scan_prologue (struct propeller_prologue_insn *insn, int n,
+			 CORE_ADDR pc, CORE_ADDR current_pc,
+			 struct propeller_frame_cache *cache)
+{
+  struct propeller_prologue_insn *end = insn + n;
   CORE_ADDR base_pc = pc;
 
   if(pc >= current_pc)
     return current_pc;
 
-  op = read_memory_unsigned_integer (pc, 4, byte_order);
-
-  if(SUB4_P(op)) {
+  if (insn < end && insn->op == PROLOGUE_SUB && insn->src == 4) {
     int reg;
-    pc += 4;
-    op = read_memory_unsigned_integer (pc, 4, byte_order);
-    if(WRLONG_P(op)){
-      reg = GET_DST(op);
+    insn++;
+    if(insn < end && insn->op == PROLOGUE_WRLONG){
+      reg = insn->dst;
       cache->sp_offset += 4;
       cache->saved_regs[reg] = cache->sp_offset;
       if(reg == 15){
 	cache->saved_regs[PROPELLER_PC_REGNUM] = cache->sp_offset;
       }
-      pc += 4;
-      op = read_memory_unsigned_integer (pc, 4, byte_order);
+      insn++;
       cache->reg_bytes_saved = 4;
-      if(MOVE_P(op)){
-	pc += 4;
-	op = read_memory_unsigned_integer (pc, 4, byte_order);
-	if(SUB_P(op)){
-	  cache->locals = GET_SRC(op) + 4;
-	  pc += 4;
+      if(insn < end && insn->op == PROLOGUE_MOV){
+	insn++;
+	if(insn < end && insn->op == PROLOGUE_SUB){
+	  cache->locals = insn->src + 4;
+	  pc = insn->next;
+	  insn++;
 	} else {
 	  return base_pc;
 	}
@@ -319,71 +575,63 @@ propeller_analyze_prologue (struct gdbarch *gdbarch,
     } else {
       return base_pc;
     }
-  } else if(MOVE_P(op)){
+  } else if (insn < end && insn->op == PROLOGUE_PUSHM) {
     int reg;
     int count;
-    reg = GET_SRC(op) & 0xf;
-    count = (GET_SRC(op) & 0xf0) >> 4;
-    op = read_memory_unsigned_integer (pc+4, 4, byte_order);
-    if(CALL_P(op, gdbarch)){
-      pc += 8;
-      cache->locals = 4 * count;
-      cache-> reg_bytes_saved = 4 * count;
-      for(; count; count--){
-	cache->sp_offset += 4;
-	if(reg == 15){
-	  // do the PC, too
-	  cache->saved_regs[PROPELLER_PC_REGNUM] = cache->sp_offset;
-	}
-	cache->saved_regs[reg++] = cache->sp_offset;
+    reg = insn->src & 0xf;
+    count = (insn->src & 0xf0) >> 4;
+    insn++;
+    cache->locals = 4 * count;
+    cache-> reg_bytes_saved = 4 * count;
+    for(; count; count--){
+      cache->sp_offset += 4;
+      if(reg == 15){
+	// do the PC, too
+	cache->saved_regs[PROPELLER_PC_REGNUM] = cache->sp_offset;
       }
-      op = read_memory_unsigned_integer (pc, 4, byte_order);
-      if(MOVE_P(op)){
-	pc += 4;
-	op = read_memory_unsigned_integer (pc, 4, byte_order);
-	if(SUB_P(op)){
-	  cache->locals += GET_SRC(op);
-	  pc += 4;
-	} else {
-	  return base_pc;
-	}
+      cache->saved_regs[reg++] = cache->sp_offset;
+    }
+    if(insn < end && insn->op == PROLOGUE_MOV){
+      insn++;
+      if(insn < end && insn->op == PROLOGUE_SUB){
+	cache->locals += insn->src;
+	pc = insn->next;
+	insn++;
       } else {
 	return base_pc;
       }
     } else {
       return base_pc;
     }
+  } else if (insn < end && insn->op == PROLOGUE_MOV) {
+    return base_pc;
   }
-  while(pc < current_pc){
+  while(insn < end && insn->pc < current_pc){
     int offset;
+    int reg;
     // some number of parameters will be written into the frame.
-    op = read_memory_unsigned_integer (pc, 4, byte_order);
-    if(MOVE_P(op)){
+    if(insn->op == PROLOGUE_MOV && insn + 2 < end
+       && insn[1].op == PROLOGUE_SUB && insn[2].op == PROLOGUE_WRLONG){
+      offset = insn[1].src;
+      reg = insn[2].dst;
+      pc = insn[2].next;
+      insn += 3;
+    } else if(insn->op == PROLOGUE_LEASP && insn + 1 < end
+	      && insn[1].op == PROLOGUE_WRLONG && cache->locals >= 0){
+      // leasp addresses the slot from sp, not from the frame pointer
+      offset = cache->locals - cache->reg_bytes_saved - insn->src;
+      reg = insn[1].dst;
+      pc = insn[1].next;
+      insn += 2;
     } else {
       // Not part of the prologue.
       break;
     }
-    op = read_memory_unsigned_integer (pc+4, 4, byte_order);
-    if(SUB_P(op)){
-      offset = GET_SRC(op);
-    } else {
-      // Not part of the prologue.
-      break;
-    }
-    op = read_memory_unsigned_integer (pc+8, 4, byte_order);
-    if(WRLONG_P(op)) {
-      int reg;
-      // FIXME track where the value went
-      reg = GET_DST(op);
-      if(offset > cache->args) cache->args = offset;
-      cache->saved_regs[reg] = cache->sp_offset + offset;
-      if(reg == 15){
-	cache->saved_regs[PROPELLER_PC_REGNUM] = cache->sp_offset;
-      }
-      pc += 12;
-    } else {
-      // Not part of the prologue.
-      break;
+    // FIXME track where the value went
+    if(offset > cache->args) cache->args = offset;
+    cache->saved_regs[reg] = cache->sp_offset + offset;
+    if(reg == 15){
+      cache->saved_regs[PROPELLER_PC_REGNUM] = cache->sp_offset;
     }
   }
 
@@ -392,6 +640,147 @@ propeller_analyze_prologue (struct gdbarch *gdbarch,
   return pc;
 }
 
+/* Prologue analyses, per objfile and keyed by the function address.
+   A backtrace over a serial link spends most of its time reading
+   prologues, and the same functions turn up in frame after frame.  The
+   table lives on the objfile's obstack, so it goes away when the
+   objfile is reloaded.  */
+
+struct propeller_prologue_entry
+{
+  CORE_ADDR func;
+  /* where the analysis stopped; it is only valid for frames at or
+     past this point */
+  CORE_ADDR end;
+  struct propeller_frame_cache cache;
+  /* the decoded prologue, kept for frames stopped inside it */
+  int n_insns;
+  struct propeller_prologue_insn *insns;
+};
+
+static const struct objfile_data *propeller_prologue_data;
+
+static hashval_t
+propeller_prologue_hash (const void *p)
+{
+  const struct propeller_prologue_entry *e
+    = (const struct propeller_prologue_entry *) p;
+
+  return (hashval_t) e->func;
+}
+
+static int
+propeller_prologue_eq (const void *a, const void *b)
+{
+  const struct propeller_prologue_entry *ea
+    = (const struct propeller_prologue_entry *) a;
+  const struct propeller_prologue_entry *eb
+    = (const struct propeller_prologue_entry *) b;
+
+  return ea->func == eb->func;
+}
+
+static htab_t
+propeller_prologue_table (CORE_ADDR func)
+{
+  struct obj_section *sec = find_pc_section (func);
+  htab_t htab;
+
+  if (sec == NULL)
+    return NULL;
+  htab = (htab_t) objfile_data (sec->objfile, propeller_prologue_data);
+  if (htab == NULL)
+    {
+      htab = htab_create_alloc_ex (64, propeller_prologue_hash,
+				   propeller_prologue_eq, NULL,
+				   &sec->objfile->objfile_obstack,
+				   hashtab_obstack_allocate,
+				   dummy_obstack_deallocate);
+      set_objfile_data (sec->objfile, propeller_prologue_data, htab);
+    }
+  return htab;
+}
+
+/* Copy what the prologue analysis found from FROM to TO.  */
+static void
+propeller_copy_prologue (struct propeller_frame_cache *to,
+			 const struct propeller_frame_cache *from)
+{
+  to->args = from->args;
+  to->reg_bytes_saved = from->reg_bytes_saved;
+  to->sp_offset = from->sp_offset;
+  to->locals = from->locals;
+  memcpy (to->saved_regs, from->saved_regs, sizeof (to->saved_regs));
+}
+
+/* Do a full analysis of the prologue at PC and update CACHE
+   accordingly.  Bail out early if CURRENT_PC is reached.  Return the
+   address where the analysis stopped.  */
+
+static CORE_ADDR
+propeller_analyze_prologue (struct gdbarch *gdbarch,
+			    CORE_ADDR pc,
+			    CORE_ADDR current_pc,
+			    struct propeller_frame_cache *cache){
+  gdb_byte buf[PROLOGUE_WINDOW];
+  struct propeller_prologue_insn insns[PROLOGUE_WINDOW];
+  struct propeller_prologue_entry key, *entry;
+  struct propeller_frame_cache full;
+  htab_t htab;
+  CORE_ADDR end;
+  int len, n;
+
+  if(pc >= current_pc)
+    return current_pc;
+
+  htab = propeller_prologue_table (pc);
+  key.func = pc;
+  entry = NULL;
+  if (htab != NULL)
+    entry = (struct propeller_prologue_entry *) htab_find (htab, &key);
+
+  if (entry == NULL)
+    {
+      struct obstack *obstack;
+      void **slot;
+
+      len = propeller_read_prologue (pc, buf);
+      n = propeller_decode_prologue (gdbarch, buf, len, pc,
+				     propeller_pc_is_cmm (gdbarch, pc),
+				     insns, PROLOGUE_WINDOW);
+
+      propeller_init_frame_cache (&full);
+      end = propeller_scan_prologue (insns, n, pc, (CORE_ADDR) -1, &full);
+      if (htab == NULL)
+	{
+	  /* no objfile to hang the result on */
+	  if (current_pc < end)
+	    return propeller_scan_prologue (insns, n, pc, current_pc, cache);
+	  propeller_copy_prologue (cache, &full);
+	  return end;
+	}
+
+      obstack = &find_pc_section (pc)->objfile->objfile_obstack;
+      slot = htab_find_slot (htab, &key, INSERT);
+
+      entry = XOBNEW (obstack, struct propeller_prologue_entry);
+      entry->func = pc;
+      entry->end = end;
+      entry->cache = full;
+      entry->n_insns = n;
+      entry->insns = XOBNEWVEC (obstack, struct propeller_prologue_insn, n);
+      memcpy (entry->insns, insns, n * sizeof (insns[0]));
+      *slot = entry;
+    }
+
+  /* stopped inside the prologue */
+  if (current_pc < entry->end)
+    return propeller_scan_prologue (entry->insns, entry->n_insns, pc,
+				    current_pc, cache);
+  propeller_copy_prologue (cache, &entry->cache);
+  return entry->end;
+}
+
 /* Return PC of first real instruction.  */
 
 static CORE_ADDR
@@ -422,16 +811,8 @@ propeller_skip_prologue (struct gdbarch *gdbarch, CORE_ADDR start_pc)
 	      || strncmp (COMPUNIT_PRODUCER (cust), "clang ", sizeof ("clang ") - 1) == 0))
 	return post_prologue_pc;
     }
-  cache.locals = -1;
-  if (propeller_pc_is_cmm (gdbarch, start_pc))
-    {
-      fprintf(stderr, "CMM PROLOGUE CODE NEEDED\n");
-      pc = 0;
-    }
-  else
-    {
-      pc = propeller_analyze_prologue (gdbarch, start_pc, (CORE_ADDR) -1, &cache);
-    }
+  propeller_init_frame_cache (&cache);
+  pc = propeller_analyze_prologue (gdbarch, start_pc, (CORE_ADDR) -1, &cache);
   if (cache.locals < 0)
     return start_pc;
   return pc;
@@ -978,4 +1359,6 @@ void
 _initialize_propeller_tdep (void)
 {
   gdbarch_register (bfd_arch_propeller, propeller_gdbarch_init, propeller_dump_tdep);
+
+  propeller_prologue_data = register_objfile_data ();
 } 
@@ -1100,14 +1100,16 @@ Add_archive_symbols::~Add_archive_symbols()
 }
 
 // Return whether we can add the archive symbols.  We are blocked by
-// this_blocker_.  We block next_blocker_.  We also lock the file.
+// this_blocker_, and by any symbol table shard still adding symbols
+// from earlier input files.  We block next_blocker_.  We also lock
+// the file.
 
 Task_token*
 Add_archive_symbols::is_runnable()
 {
   if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
     return this->this_blocker_;
-  return NULL;
+  return this->symtab_->add_symbols_blocker();
 }
 
 void
@@ -1330,7 +1332,7 @@ Add_lib_group_symbols::is_runnable()
     return this->readsyms_blocker_;
   if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
     return this->this_blocker_;
-  return NULL;
+  return this->symtab_->add_symbols_blocker();
 }
 
 void
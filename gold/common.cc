@@ -185,6 +185,65 @@ Symbol_table::allocate_commons(Layout* layout, Mapfile* mapfile)
     gold_unreachable();
 }
 
+// Sort common symbols by the position in the input at which they
+// were seen.
+
+class Sort_commons_by_input_order
+{
+ public:
+  bool
+  operator()(const std::pair<uint64_t, Symbol*>& a,
+	     const std::pair<uint64_t, Symbol*>& b) const
+  { return a.first < b.first; }
+};
+
+// Move the common symbols of type COMMONS_SECTION_TYPE from the
+// shards to COMMONS.  Symbols are recorded in their shard as they are
+// seen, and the shards may be filled in parallel, so put them back in
+// the order in which they were seen in the input.  This is the order
+// in which a serial link records them, so the ties left by
+// Sort_commons are broken the same way whatever the number of
+// threads.
+
+void
+Symbol_table::gather_commons(Commons_section_type commons_section_type,
+			     Commons_type* commons)
+{
+  Shard_commons_type all;
+  for (unsigned int i = 0; i < shard_count; ++i)
+    {
+      Symbol_table_shard* shard = this->shards_[i];
+      Shard_commons_type* list;
+      switch (commons_section_type)
+	{
+	case COMMONS_NORMAL:
+	  list = &shard->commons;
+	  break;
+	case COMMONS_TLS:
+	  list = &shard->tls_commons;
+	  break;
+	case COMMONS_SMALL:
+	  list = &shard->small_commons;
+	  break;
+	case COMMONS_LARGE:
+	  list = &shard->large_commons;
+	  break;
+	default:
+	  gold_unreachable();
+	}
+      all.insert(all.end(), list->begin(), list->end());
+      list->clear();
+    }
+
+  std::stable_sort(all.begin(), all.end(), Sort_commons_by_input_order());
+
+  commons->reserve(commons->size() + all.size());
+  for (Shard_commons_type::const_iterator p = all.begin();
+       p != all.end();
+       ++p)
+    commons->push_back(p->second);
+}
+
 // Allocated the common symbols, sized version.
 
 template<int size>
@@ -192,6 +251,12 @@ void
 Symbol_table::do_allocate_commons(Layout* layout, Mapfile* mapfile,
 				  Sort_commons_order sort_order)
 {
+  // Gather the common symbols recorded in each shard.
+  this->gather_commons(COMMONS_NORMAL, &this->commons_);
+  this->gather_commons(COMMONS_TLS, &this->tls_commons_);
+  this->gather_commons(COMMONS_SMALL, &this->small_commons_);
+  this->gather_commons(COMMONS_LARGE, &this->large_commons_);
+
   if (!this->commons_.empty())
     this->do_allocate_commons_list<size>(layout, COMMONS_NORMAL,
 					 &this->commons_, mapfile,
@@ -24,52 +24,142 @@
 #include <zlib.h>
 #include "parameters.h"
 #include "options.h"
+#include "workqueue.h"
 #include "compressed_output.h"
 
 namespace gold
 {
 
-// Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns true
-// if it successfully compressed, false if it failed for any reason
-// (including not having zlib support in the library).  If it returns
-// true, it allocates memory for the compressed data using new, and
-// sets *COMPRESSED_DATA and *COMPRESSED_SIZE to appropriate values.
-// It also writes a header before COMPRESSED_DATA: 4 bytes saying
-// "ZLIB", and 8 bytes indicating the uncompressed size, in big-endian
-// order.
+// Return the zlib compression level to use for output sections.
 
-static bool
-zlib_compress(int header_size,
-              const unsigned char* uncompressed_data,
-              unsigned long uncompressed_size,
-              unsigned char** compressed_data,
-              unsigned long* compressed_size)
+static int
+zlib_compress_level()
 {
-  *compressed_size = uncompressed_size + uncompressed_size / 1000 + 128;
-  *compressed_data = new unsigned char[*compressed_size + header_size];
-
-  int compress_level;
+  if (parameters->options().user_set_compress_debug_sections_level())
+    return parameters->options().compress_debug_sections_level();
   if (parameters->options().optimize() >= 1)
-    compress_level = 9;
+    return 9;
+  return 1;
+}
+
+// Return the two byte zlib stream header that compress2 would write
+// at compression level LEVEL.
+
+static unsigned int
+zlib_stream_header(int level)
+{
+  unsigned int level_flags;
+  if (level < 2)
+    level_flags = 0;
+  else if (level < 6)
+    level_flags = 1;
+  else if (level == 6)
+    level_flags = 2;
   else
-    compress_level = 1;
-
-  int rc = compress2(reinterpret_cast<Bytef*>(*compressed_data) + header_size,
-                     compressed_size,
-                     reinterpret_cast<const Bytef*>(uncompressed_data),
-                     uncompressed_size,
-                     compress_level);
-  if (rc == Z_OK)
+    level_flags = 3;
+  unsigned int header = (Z_DEFLATED + ((MAX_WBITS - 8) << 4)) << 8;
+  header |= level_flags << 6;
+  header += 31 - (header % 31);
+  return header;
+}
+
+// zlib's sizes are 32 bits, so we pass it at most this much at a time.
+
+static const unsigned long zlib_max_slice = 0x40000000;
+
+// Return the adler32 checksum of the SIZE bytes at DATA.
+
+static unsigned long
+zlib_adler32(const unsigned char* data, unsigned long size)
+{
+  unsigned long adler = adler32(0, NULL, 0);
+  do
     {
-      *compressed_size += header_size;
-      return true;
+      unsigned long slice = std::min(size, zlib_max_slice);
+      adler = adler32(adler, data, slice);
+      data += slice;
+      size -= slice;
     }
-  else
+  while (size > 0);
+  return adler;
+}
+
+// Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE as a raw
+// deflate stream, with no zlib header or trailer.  If LAST is false,
+// the stream is ended with a sync flush rather than a final block, so
+// that the output of several calls may be concatenated, in order, to
+// form a single deflate stream.  Returns true if it successfully
+// compressed, false if it failed for any reason.  If it returns true,
+// it allocates memory for the compressed data using new, and sets
+// *COMPRESSED_DATA and *COMPRESSED_SIZE to appropriate values.
+
+static bool
+zlib_compress(int level,
+	      const unsigned char* uncompressed_data,
+	      unsigned long uncompressed_size,
+	      bool last,
+	      unsigned char** compressed_data,
+	      unsigned long* compressed_size)
+{
+  z_stream strm;
+  strm.zalloc = NULL;
+  strm.zfree = NULL;
+  strm.opaque = NULL;
+
+  // Use the same memory level as compress2, so that a section
+  // compressed as a single chunk is compressed exactly as before.
+  if (deflateInit2(&strm, level, Z_DEFLATED, -MAX_WBITS, 8,
+		   Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+
+  unsigned long buffer_size = (uncompressed_size + uncompressed_size / 1000
+			       + 128);
+  *compressed_data = new unsigned char[buffer_size];
+
+  const unsigned char* in = uncompressed_data;
+  unsigned long in_left = uncompressed_size;
+  unsigned char* out = *compressed_data;
+  unsigned long out_left = buffer_size;
+  const int final_flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+  bool success = false;
+  while (true)
+    {
+      unsigned long in_slice = std::min(in_left, zlib_max_slice);
+      unsigned long out_slice = std::min(out_left, zlib_max_slice);
+      strm.next_in = const_cast<Bytef*>(in);
+      strm.avail_in = in_slice;
+      strm.next_out = out;
+      strm.avail_out = out_slice;
+      int flush = in_slice == in_left ? final_flush : Z_NO_FLUSH;
+
+      int rc = deflate(&strm, flush);
+
+      in += in_slice - strm.avail_in;
+      in_left -= in_slice - strm.avail_in;
+      out += out_slice - strm.avail_out;
+      out_left -= out_slice - strm.avail_out;
+
+      // A sync flush is only complete if there is output space left
+      // over.
+      if (rc == Z_STREAM_END
+	  || (rc == Z_OK && flush == Z_SYNC_FLUSH && strm.avail_out > 0))
+	{
+	  success = true;
+	  break;
+	}
+      if (rc != Z_OK || out_left == 0)
+	break;
+    }
+  *compressed_size = buffer_size - out_left;
+
+  deflateEnd(&strm);
+
+  if (!success)
     {
       delete[] *compressed_data;
       *compressed_data = NULL;
-      return false;
     }
+  return success;
 }
 
 // Decompress COMPRESSED_DATA of size COMPRESSED_SIZE, into a buffer
@@ -209,19 +299,50 @@ decompress_input_section(const unsigned char* compressed_data,
   return false;
 }
 
+// A task to compress one chunk of an Output_compressed_section.
+
+class Compress_chunk_task : public Task
+{
+ public:
+  Compress_chunk_task(Output_compressed_section* os, unsigned int chunk,
+		      Task_token* final_blocker)
+    : os_(os), chunk_(chunk), final_blocker_(final_blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->os_->compress_chunk(this->chunk_); }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->final_blocker_); }
+
+  std::string
+  get_name() const
+  { return std::string("Compress_chunk_task ") + this->os_->name(); }
+
+ private:
+  Output_compressed_section* os_;
+  unsigned int chunk_;
+  Task_token* final_blocker_;
+};
+
 // Class Output_compressed_section.
 
-// Set the final data size of a compressed section.  This is where
-// we actually compress the section data.
+// Fill in the postprocessing buffer and split it into the chunks
+// which are compressed separately.  The chunks do not depend on the
+// number of threads, so the output is the same however many threads
+// we use.
 
 void
-Output_compressed_section::set_final_data_size()
+Output_compressed_section::set_up_chunks()
 {
-  off_t uncompressed_size = this->postprocessing_buffer_size();
-
-  // (Try to) compress the data.
-  unsigned long compressed_size;
-  unsigned char* uncompressed_data = this->postprocessing_buffer();
+  gold_assert(!this->have_chunks_);
+  this->have_chunks_ = true;
 
   // At this point the contents of all regular input sections will
   // have been copied into the postprocessing buffer, and relocations
@@ -229,6 +350,79 @@ Output_compressed_section::set_final_data_size()
   // anything other than a regular input section.
   this->write_to_postprocessing_buffer();
 
+  // A chunk size of zero means that we compress the whole section as
+  // a single chunk.
+  unsigned long uncompressed_size = this->postprocessing_buffer_size();
+  uint64_t chunk_size = this->options_->compress_debug_sections_chunk_size();
+  if (chunk_size == 0 || chunk_size > uncompressed_size)
+    chunk_size = std::max(uncompressed_size, 1UL);
+  this->chunk_size_ = chunk_size;
+
+  unsigned int chunk_count = 1;
+  if (uncompressed_size > chunk_size)
+    chunk_count = (uncompressed_size + chunk_size - 1) / chunk_size;
+  this->chunks_.resize(chunk_count);
+}
+
+// Compress chunk I of the section contents.
+
+void
+Output_compressed_section::compress_chunk(unsigned int i)
+{
+  gold_assert(i < this->chunks_.size());
+  Chunk* chunk = &this->chunks_[i];
+
+  unsigned long uncompressed_size = this->postprocessing_buffer_size();
+  unsigned long offset = i * this->chunk_size_;
+  unsigned long size = std::min(this->chunk_size_,
+				uncompressed_size - offset);
+  const unsigned char* data = this->postprocessing_buffer() + offset;
+  bool last = i + 1 == this->chunks_.size();
+
+  chunk->adler = zlib_adler32(data, size);
+  chunk->ok = zlib_compress(zlib_compress_level(), data, size, last,
+			    &chunk->data, &chunk->size);
+}
+
+// Split the section contents into chunks, and return the number of
+// tasks we will queue to compress them.
+
+unsigned int
+Output_compressed_section::do_prepare_postprocessing_tasks()
+{
+  this->set_up_chunks();
+  return this->chunks_.size();
+}
+
+// Queue a task to compress each chunk of the section contents.  The
+// caller has already added a blocker to BLOCKER for each chunk.
+
+void
+Output_compressed_section::do_queue_postprocessing_tasks(Workqueue* workqueue,
+							 Task_token* blocker)
+{
+  gold_assert(this->have_chunks_);
+  unsigned int chunk_count = this->chunks_.size();
+  for (unsigned int i = 0; i < chunk_count; ++i)
+    workqueue->queue(new Compress_chunk_task(this, i, blocker));
+}
+
+// Set the final data size of a compressed section.  This is where
+// we put together the compressed chunks.  If the compression tasks
+// were not queued, we compress the section data here.
+
+void
+Output_compressed_section::set_final_data_size()
+{
+  off_t uncompressed_size = this->postprocessing_buffer_size();
+
+  if (!this->have_chunks_)
+    {
+      this->set_up_chunks();
+      for (unsigned int i = 0; i < this->chunks_.size(); ++i)
+	this->compress_chunk(i);
+    }
+
   bool success = false;
   enum { none, gnu_zlib, gabi_zlib } compress;
   int compression_header_size = 12;
@@ -248,10 +442,62 @@ Output_compressed_section::set_final_data_size()
     }
   else
     compress = none;
+
+  // Put together the compression header, the zlib stream header, the
+  // compressed chunks, and the adler32 checksum of the whole section.
+  unsigned long compressed_size = compression_header_size + 2 + 4;
   if (compress != none)
-    success = zlib_compress(compression_header_size, uncompressed_data,
-			    uncompressed_size, &this->data_,
-			    &compressed_size);
+    {
+      success = true;
+      for (std::vector<Chunk>::const_iterator p = this->chunks_.begin();
+	   p != this->chunks_.end();
+	   ++p)
+	{
+	  if (!p->ok)
+	    success = false;
+	  compressed_size += p->size;
+	}
+    }
+  if (success)
+    {
+      this->data_ = new unsigned char[compressed_size];
+      // Clear the header, which includes reserved fields, so that the
+      // output does not depend on the contents of uninitialized memory.
+      memset(this->data_, 0, compression_header_size);
+      unsigned char* pov = this->data_ + compression_header_size;
+      elfcpp::Swap_unaligned<16, true>::writeval(
+	  pov, zlib_stream_header(zlib_compress_level()));
+      pov += 2;
+
+      unsigned long adler = 0;
+      unsigned long offset = 0;
+      for (std::vector<Chunk>::const_iterator p = this->chunks_.begin();
+	   p != this->chunks_.end();
+	   ++p)
+	{
+	  memcpy(pov, p->data, p->size);
+	  pov += p->size;
+	  unsigned long len = std::min<unsigned long>(this->chunk_size_,
+						      uncompressed_size
+						      - offset);
+	  if (p == this->chunks_.begin())
+	    adler = p->adler;
+	  else
+	    adler = adler32_combine(adler, p->adler, len);
+	  offset += len;
+	}
+      elfcpp::Swap_unaligned<32, true>::writeval(pov, adler);
+      pov += 4;
+      gold_assert(static_cast<unsigned long>(pov - this->data_)
+		  == compressed_size);
+    }
+
+  for (std::vector<Chunk>::iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    delete[] p->data;
+  std::vector<Chunk>().swap(this->chunks_);
+
   if (success)
     {
       elfcpp::Elf_Xword flags = this->flags();
@@ -29,6 +29,7 @@
 #define GOLD_COMPRESSED_OUTPUT_H
 
 #include <string>
+#include <vector>
 
 #include "output.h"
 
@@ -60,10 +61,25 @@ class Output_compressed_section : public Output_section
 			    const char* name, elfcpp::Elf_Word flags,
 			    elfcpp::Elf_Xword type)
     : Output_section(name, flags, type),
-      options_(options)
+      options_(options), data_(NULL), chunks_(), chunk_size_(0),
+      have_chunks_(false)
   { this->set_requires_postprocessing(); }
 
+  // Compress chunk I of the section contents.  This is called by the
+  // tasks queued by do_queue_postprocessing_tasks.
+  void
+  compress_chunk(unsigned int i);
+
  protected:
+  // Split the section contents into chunks to compress in parallel,
+  // and return the number of chunks.
+  unsigned int
+  do_prepare_postprocessing_tasks();
+
+  // Queue a task to compress each chunk.
+  void
+  do_queue_postprocessing_tasks(Workqueue*, Task_token*);
+
   // Set the final data size.
   void
   set_final_data_size();
@@ -73,10 +89,39 @@ class Output_compressed_section : public Output_section
   do_write(Output_file*);
 
  private:
+  // A piece of the section contents which is compressed separately.
+  // Each chunk is compressed as a raw deflate stream; concatenated in
+  // order, the chunks form the body of a single zlib stream.
+  struct Chunk
+  {
+    Chunk()
+      : data(NULL), size(0), adler(0), ok(false)
+    { }
+
+    // The compressed data, allocated with new.
+    unsigned char* data;
+    // The size of the compressed data.
+    unsigned long size;
+    // The adler32 checksum of the uncompressed data.
+    unsigned long adler;
+    // Whether the chunk was compressed successfully.
+    bool ok;
+  };
+
+  // Fill in the postprocessing buffer and split it into chunks.
+  void
+  set_up_chunks();
+
   // The options--this includes the compression type.
   const General_options* options_;
   // The compressed data.
   unsigned char* data_;
+  // The separately compressed pieces of the section contents.
+  std::vector<Chunk> chunks_;
+  // The size of each uncompressed chunk, except perhaps the last.
+  unsigned long chunk_size_;
+  // Whether set_up_chunks has been called.
+  bool have_chunks_;
   // The new section name if we do compress.
   std::string new_section_name_;
 };
@@ -1175,7 +1175,10 @@ class Loadaddr_expression : public Section_expression
       {
 	if (eei->result_section_pointer != NULL)
 	  *eei->result_section_pointer = os;
-	return os->address();
+	if (os->is_address_valid())
+	  return os->address();
+	*eei->is_valid_pointer = false;
+	return 0;
       }
   }
 
@@ -28,6 +28,8 @@
 #include "object.h"
 #include "output.h"
 #include "demangle.h"
+#include "int_encoding.h"
+#include "workqueue.h"
 
 namespace gold
 {
@@ -171,7 +173,308 @@ mapped_index_string_hash(const unsigned char* str)
   return r;
 }
 
-// A specialization of Dwarf_info_reader, for building the .gdb_index.
+class Gdb_index_info_reader;
+
+// Statistics gathered while scanning the debug info.
+
+struct Gdb_index_stats
+{
+  Gdb_index_stats()
+    : cu_count(0), cu_nopubnames_count(0), tu_count(0),
+      tu_nopubnames_count(0)
+  { }
+
+  // Add the statistics in STATS to these.
+  void
+  add(const Gdb_index_stats& stats)
+  {
+    this->cu_count += stats.cu_count;
+    this->cu_nopubnames_count += stats.cu_nopubnames_count;
+    this->tu_count += stats.tu_count;
+    this->tu_nopubnames_count += stats.tu_nopubnames_count;
+  }
+
+  // Total number of DWARF compilation units processed.
+  unsigned int cu_count;
+  // Number of DWARF compilation units without pubnames/pubtypes.
+  unsigned int cu_nopubnames_count;
+  // Total number of DWARF type units processed.
+  unsigned int tu_count;
+  // Number of DWARF type units without pubnames/pubtypes.
+  unsigned int tu_nopubnames_count;
+};
+
+// The statistics for all the objects merged into the index.
+static Gdb_index_stats gdb_index_stats;
+
+// The information gathered from the .debug_info and .debug_types
+// sections of one input object.  The sections are scanned by a
+// Debug_index_scan task, which runs in parallel with the tasks for the
+// other objects.  CU and TU indexes are local to the object, and each
+// symbol or name is entered once, with the list of units or DIEs that
+// define it, in the order it was first seen.  Debug_index::merge_objects
+// then translates the indexes and adds the symbols and names to the
+// index, giving the same result as scanning every object in input
+// order.
+
+class Debug_index::Object_info
+{
+ public:
+  // A name for the .debug_names section.  NAME points into the name
+  // map.
+  struct Local_name
+  {
+    Local_name(const char* n)
+      : name(n), entries(new Name_entries())
+    { }
+
+    const char* name;
+    Name_entries* entries;
+  };
+
+  typedef std::vector<Local_name> Local_names;
+
+  Object_info(Relobj* object, unsigned int symtab_shndx);
+
+  ~Object_info();
+
+  // Return the object.
+  Relobj*
+  object() const
+  { return this->object_; }
+
+  // Record a section to scan.
+  void
+  add_section(bool is_type_unit, unsigned int shndx,
+	      unsigned int reloc_shndx, unsigned int reloc_type)
+  {
+    this->sections_.push_back(Section(is_type_unit, shndx, reloc_shndx,
+				      reloc_type));
+  }
+
+  // Scan the recorded sections.
+  void
+  scan();
+
+  // Return whether the sections have been scanned.
+  bool
+  is_scanned() const
+  { return this->is_scanned_; }
+
+  // Add a compilation unit, and return its local index.
+  int
+  add_comp_unit(off_t cu_offset, off_t cu_length)
+  {
+    this->comp_units_.push_back(Comp_unit(cu_offset, cu_length));
+    return this->comp_units_.size() - 1;
+  }
+
+  // Add a type unit, and return its local index.
+  int
+  add_type_unit(off_t tu_offset, off_t type_offset, uint64_t signature)
+  {
+    this->type_units_.push_back(Type_unit(tu_offset, type_offset, signature));
+    return this->type_units_.size() - 1;
+  }
+
+  // Add an address range.
+  void
+  add_address_range_list(int cu_index, Dwarf_range_list* ranges)
+  {
+    this->ranges_.push_back(Per_cu_range_list(this->object_, cu_index,
+					      ranges));
+  }
+
+  // Add a symbol for the .gdb_index section.  FLAGS are the gdb_index
+  // version 7 flags to be stored in the high-byte of the cu_index
+  // field.
+  void
+  add_symbol(int cu_index, const char* sym_name, uint8_t flags);
+
+  // Return whether we are collecting names for the .debug_names
+  // section.
+  bool
+  want_names() const
+  { return this->want_names_; }
+
+  // Add a name for the .debug_names section, for the DIE at
+  // DIE_OFFSET in the CU with index CU_INDEX.
+  void
+  add_name(int cu_index, const char* name, off_t die_offset,
+	   unsigned int tag);
+
+  // Return the offset into the pubnames table for the cu at the given
+  // offset.
+  off_t
+  find_pubname_offset(off_t cu_offset);
+
+  // Return the offset into the pubtypes table for the cu at the
+  // given offset.
+  off_t
+  find_pubtype_offset(off_t cu_offset);
+
+  // Return TRUE if we have already processed the pubnames and types
+  // set of the CUs and TUs associated with the statement list at
+  // OFFSET.
+  bool
+  pubnames_read(off_t offset) const
+  { return this->stmt_list_offset_ == offset; }
+
+  // Record that we have already read the pubnames associated with
+  // OFFSET.
+  void
+  set_pubnames_read(off_t offset)
+  { this->stmt_list_offset_ = offset; }
+
+  // Return a pointer to the given table.
+  Dwarf_pubnames_table*
+  pubnames_table()
+  { return this->pubnames_table_; }
+
+  Dwarf_pubnames_table*
+  pubtypes_table()
+  { return this->pubtypes_table_; }
+
+  // Return the statistics for this object.
+  Gdb_index_stats*
+  stats()
+  { return &this->stats_; }
+
+  // Record that the object has a unit of DWARF version VERSION,
+  // which we cannot read.
+  void
+  set_unsupported_version(unsigned int version)
+  {
+    if (this->unsupported_version_ == 0)
+      this->unsupported_version_ = version;
+  }
+
+  // Return the DWARF version of the first unit we could not read, or
+  // 0 if we read them all.
+  unsigned int
+  unsupported_version() const
+  { return this->unsupported_version_; }
+
+  // Record that the object has its own .debug_names section.
+  void
+  set_has_input_names()
+  { this->has_input_names_ = true; }
+
+  // Return whether the object has its own .debug_names section.
+  bool
+  has_input_names() const
+  { return this->has_input_names_; }
+
+  // Return whether the object has a .debug_types section.
+  bool
+  has_type_units() const;
+
+  // Accessors for Debug_index::merge_objects.
+
+  const std::vector<Comp_unit>&
+  comp_units() const
+  { return this->comp_units_; }
+
+  const std::vector<Type_unit>&
+  type_units() const
+  { return this->type_units_; }
+
+  const std::vector<Per_cu_range_list>&
+  ranges() const
+  { return this->ranges_; }
+
+  Symbols&
+  symbols()
+  { return this->symbols_; }
+
+  bool
+  last_symbol_is_new() const
+  { return this->last_symbol_is_new_; }
+
+  Local_names&
+  names()
+  { return this->names_; }
+
+ private:
+  // A .debug_info or .debug_types section to scan.
+  struct Section
+  {
+    Section(bool is_tu, unsigned int sh, unsigned int reloc_sh,
+	    unsigned int rtype)
+      : is_type_unit(is_tu), shndx(sh), reloc_shndx(reloc_sh),
+	reloc_type(rtype)
+    { }
+
+    bool is_type_unit;
+    unsigned int shndx;
+    unsigned int reloc_shndx;
+    unsigned int reloc_type;
+  };
+
+  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
+  typedef Unordered_map<std::string, unsigned int> String_map;
+
+  // Create a map from dies to pubnames.
+  Dwarf_pubnames_table*
+  map_pubtable_to_dies(unsigned int attr,
+                       Gdb_index_info_reader* dwinfo);
+
+  // Wrapper for map_pubtable_to_dies
+  void
+  map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo);
+
+  // The object.
+  Relobj* object_;
+  // The index of the object's symbol table section, or 0.
+  unsigned int symtab_shndx_;
+  // The symbol table, used for relocations.  It is only read while
+  // the sections are scanned, and the view is released with the
+  // object's lock.
+  const unsigned char* symbols_data_;
+  off_t symbols_size_;
+  // The sections to scan.
+  std::vector<Section> sections_;
+  // Whether the sections have been scanned.
+  bool is_scanned_;
+  // Whether to collect symbols for the .gdb_index section.
+  bool want_symbols_;
+  // Whether to collect names for the .debug_names section.
+  bool want_names_;
+  // The DWARF compilation units.
+  std::vector<Comp_unit> comp_units_;
+  // The DWARF type units.
+  std::vector<Type_unit> type_units_;
+  // The address ranges.
+  std::vector<Per_cu_range_list> ranges_;
+  // The symbols, in the order they were first seen.
+  Symbols symbols_;
+  // Map from a symbol name to its index in SYMBOLS_.
+  String_map symbol_map_;
+  // Whether the last call to add_symbol added a new symbol.
+  bool last_symbol_is_new_;
+  // The names, in the order they were first seen.
+  Local_names names_;
+  // Map from a name to its index in NAMES_.
+  String_map name_map_;
+  // Maps from a CU offset to its pubnames and pubtypes.
+  Pubname_offset_map cu_pubname_map_;
+  Pubname_offset_map cu_pubtype_map_;
+  // Tables to store the pubnames sections of the object.
+  Dwarf_pubnames_table* pubnames_table_;
+  Dwarf_pubnames_table* pubtypes_table_;
+  // Stmt list offset of the CUs and TUs associated with the last
+  // read pubnames and pubtypes sections.
+  off_t stmt_list_offset_;
+  // The DWARF version of the first unit we could not read, or 0.
+  unsigned int unsupported_version_;
+  // Whether the object has its own .debug_names section.
+  bool has_input_names_;
+  // Statistics.
+  Gdb_index_stats stats_;
+};
+
+// A specialization of Dwarf_info_reader, for building the .gdb_index
+// and .debug_names sections.
 
 class Gdb_index_info_reader : public Dwarf_info_reader
 {
@@ -183,19 +486,16 @@ class Gdb_index_info_reader : public Dwarf_info_reader
 			unsigned int shndx,
 			unsigned int reloc_shndx,
 			unsigned int reloc_type,
-			Gdb_index* gdb_index)
+			Debug_index::Object_info* info)
     : Dwarf_info_reader(is_type_unit, object, symbols, symbols_size, shndx,
 			reloc_shndx, reloc_type),
-      gdb_index_(gdb_index), cu_index_(0), cu_language_(0)
+      info_(info), cu_index_(0), cu_language_(0), unit_checkpoint_(0),
+      decl_names_()
   { }
 
   ~Gdb_index_info_reader()
   { this->clear_declarations(); }
 
-  // Print usage statistics.
-  static void
-  print_stats();
-
  protected:
   // Visit a compilation unit.
   virtual void
@@ -206,6 +506,10 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   visit_type_unit(off_t tu_offset, off_t tu_length, off_t type_offset,
 		  uint64_t signature, Dwarf_die*);
 
+  // Visit a unit we cannot read.
+  virtual void
+  visit_unsupported_unit(off_t unit_offset, unsigned int version);
+
  private:
   // A map for recording DIEs we've seen that may be referred to be
   // later DIEs (via DW_AT_specification or DW_AT_abstract_origin).
@@ -228,6 +532,12 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   };
   typedef Unordered_map<off_t, Declaration_pair> Declaration_map;
 
+  // A map from the offset of a DIE that may be referred to by later
+  // DIEs to its DW_AT_name and linkage name, for the .debug_names
+  // section.
+  typedef Unordered_map<off_t, std::pair<const char*, const char*> >
+    Decl_names_map;
+
   // Visit a top-level DIE.
   void
   visit_top_die(Dwarf_die* die);
@@ -269,6 +579,30 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   std::string
   get_qualified_name(Dwarf_die* die, Dwarf_die* context);
 
+  // Visit the children of a DIE, looking for names for the
+  // .debug_names section.
+  void
+  visit_children_for_names(Dwarf_die* die);
+
+  // Visit a DIE, looking for names for the .debug_names section.
+  void
+  visit_die_for_names(Dwarf_die* die);
+
+  // Add the names of DIE for the .debug_names section.
+  void
+  add_die_names(Dwarf_die* die);
+
+  // Find the DW_AT_name and linkage name of DIE, following
+  // DW_AT_specification and DW_AT_abstract_origin.
+  void
+  get_die_names(Dwarf_die* die, int depth, const char** name,
+		const char** linkage_name);
+
+  // Find the DW_AT_name and linkage name of the DIE at DECL_OFFSET.
+  void
+  get_decl_names(off_t decl_offset, int depth, const char** name,
+		 const char** linkage_name);
+
   // Record the address ranges for a compilation unit.
   void
   record_cu_ranges(Dwarf_die* die);
@@ -285,8 +619,8 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   void
   clear_declarations();
 
-  // The Gdb_index section.
-  Gdb_index* gdb_index_;
+  // The information gathered from the object.
+  Debug_index::Object_info* info_;
   // The current CU index (negative for a TU).
   int cu_index_;
   // The language of the current CU or TU.
@@ -294,35 +628,22 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   // Map from DIE offset to (parent offset, name) pair,
   // for DW_AT_specification.
   Declaration_map declarations_;
-
-  // Statistics.
-  // Total number of DWARF compilation units processed.
-  static unsigned int dwarf_cu_count;
-  // Number of DWARF compilation units with pubnames/pubtypes.
-  static unsigned int dwarf_cu_nopubnames_count;
-  // Total number of DWARF type units processed.
-  static unsigned int dwarf_tu_count;
-  // Number of DWARF type units with pubnames/pubtypes.
-  static unsigned int dwarf_tu_nopubnames_count;
+  // The relocation tracker checkpoint for the start of the current
+  // unit.
+  uint64_t unit_checkpoint_;
+  // Map from DIE offset to (name, linkage name) pair, for
+  // DW_AT_specification and DW_AT_abstract_origin.
+  Decl_names_map decl_names_;
 };
 
-// Total number of DWARF compilation units processed.
-unsigned int Gdb_index_info_reader::dwarf_cu_count = 0;
-// Number of DWARF compilation units without pubnames/pubtypes.
-unsigned int Gdb_index_info_reader::dwarf_cu_nopubnames_count = 0;
-// Total number of DWARF type units processed.
-unsigned int Gdb_index_info_reader::dwarf_tu_count = 0;
-// Number of DWARF type units without pubnames/pubtypes.
-unsigned int Gdb_index_info_reader::dwarf_tu_nopubnames_count = 0;
-
 // Process a compilation unit and parse its child DIE.
 
 void
 Gdb_index_info_reader::visit_compilation_unit(off_t cu_offset, off_t cu_length,
 					      Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_cu_count;
-  this->cu_index_ = this->gdb_index_->add_comp_unit(cu_offset, cu_length);
+  ++this->info_->stats()->cu_count;
+  this->cu_index_ = this->info_->add_comp_unit(cu_offset, cu_length);
   this->visit_top_die(root_die);
 }
 
@@ -333,24 +654,35 @@ Gdb_index_info_reader::visit_type_unit(off_t tu_offset, off_t,
 				       off_t type_offset, uint64_t signature,
 				       Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_tu_count;
+  ++this->info_->stats()->tu_count;
   // Use a negative index to flag this as a TU instead of a CU.
-  this->cu_index_ = -1 - this->gdb_index_->add_type_unit(tu_offset, type_offset,
-							 signature);
+  this->cu_index_ = -1 - this->info_->add_type_unit(tu_offset, type_offset,
+						    signature);
   this->visit_top_die(root_die);
 }
 
+// Record a unit whose header we cannot read.  It is in neither the
+// .gdb_index nor the .debug_names section.
+
+void
+Gdb_index_info_reader::visit_unsupported_unit(off_t, unsigned int version)
+{
+  this->info_->set_unsupported_version(version);
+}
+
 // Process a top-level DIE.
-// For compile_unit DIEs, record the address ranges.  For all
-// interesting tags, add qualified names to the symbol table
-// and process interesting children.  We may need to process
-// certain children just for saving declarations that might be
-// referenced by later DIEs with a DW_AT_specification attribute.
+// For compile_unit DIEs, record the address ranges, and collect the
+// names for the .debug_names section.  For all interesting tags, add
+// qualified names to the symbol table and process interesting
+// children.  We may need to process certain children just for saving
+// declarations that might be referenced by later DIEs with a
+// DW_AT_specification attribute.
 
 void
 Gdb_index_info_reader::visit_top_die(Dwarf_die* die)
 {
   this->clear_declarations();
+  this->unit_checkpoint_ = this->get_reloc_checkpoint();
 
   switch (die->tag())
     {
@@ -358,7 +690,18 @@ Gdb_index_info_reader::visit_top_die(Dwarf_die* die)
       case elfcpp::DW_TAG_type_unit:
 	this->cu_language_ = die->int_attribute(elfcpp::DW_AT_language);
 	if (die->tag() == elfcpp::DW_TAG_compile_unit)
-	  this->record_cu_ranges(die);
+	  {
+	    this->record_cu_ranges(die);
+	    // The .debug_names section lists the DIEs that DWARF 5
+	    // section 6.1.1.1 asks for wherever they are in the tree,
+	    // so it needs its own walk of the whole unit.  Rewind the
+	    // relocation tracker for the walk below.
+	    if (this->info_->want_names())
+	      {
+		this->visit_children_for_names(die);
+		this->reset_relocs(this->unit_checkpoint_);
+	      }
+	  }
 	// If there is a pubnames and/or pubtypes section for this
 	// compilation unit, use those; otherwise, parse the DWARF
 	// info to extract the names.
@@ -381,9 +724,9 @@ Gdb_index_info_reader::visit_top_die(Dwarf_die* die)
 		return;
 	      }
 	    if (die->tag() == elfcpp::DW_TAG_compile_unit)
-	      ++Gdb_index_info_reader::dwarf_cu_nopubnames_count;
+	      ++this->info_->stats()->cu_nopubnames_count;
 	    else
-	      ++Gdb_index_info_reader::dwarf_tu_nopubnames_count;
+	      ++this->info_->stats()->tu_nopubnames_count;
 	    this->visit_children(die, NULL);
 	  }
 	break;
@@ -437,8 +780,7 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	    // If the DIE is not a declaration, add it to the index.
 	    std::string full_name = this->get_qualified_name(die, context);
 	    if (!full_name.empty())
-	      this->gdb_index_->add_symbol(this->cu_index_,
-                                           full_name.c_str(), 0);
+	      this->info_->add_symbol(this->cu_index_, full_name.c_str(), 0);
 	  }
 	break;
       case elfcpp::DW_TAG_typedef:
@@ -477,8 +819,8 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	      if (full_name.empty())
 		full_name = this->get_qualified_name(die, context);
 	      if (!full_name.empty())
-		this->gdb_index_->add_symbol(this->cu_index_,
-					     full_name.c_str(), 0);
+		this->info_->add_symbol(this->cu_index_,
+					full_name.c_str(), 0);
 	    }
 
 	  // We're interested in the children only for namespaces and
@@ -812,6 +1154,212 @@ Gdb_index_info_reader::get_qualified_name(Dwarf_die* die, Dwarf_die* context)
   return full_name;
 }
 
+// Visit the children of PARENT, looking for names for the
+// .debug_names section.
+
+void
+Gdb_index_info_reader::visit_children_for_names(Dwarf_die* parent)
+{
+  off_t next_offset = 0;
+  for (off_t die_offset = parent->child_offset();
+       die_offset != 0;
+       die_offset = next_offset)
+    {
+      Dwarf_die die(this, die_offset, parent);
+      if (die.tag() == 0)
+	break;
+      this->visit_die_for_names(&die);
+      next_offset = die.sibling_offset();
+    }
+}
+
+// Return true if DIE has a machine address, and so describes code
+// rather than an abstract instance or an out-of-line declaration.
+
+static bool
+die_has_address(Dwarf_die* die)
+{
+  return (die->attribute(elfcpp::DW_AT_low_pc) != NULL
+	  || die->attribute(elfcpp::DW_AT_high_pc) != NULL
+	  || die->attribute(elfcpp::DW_AT_ranges) != NULL
+	  || die->attribute(elfcpp::DW_AT_entry_pc) != NULL);
+}
+
+// Return true if the DW_AT_location of the variable DIE gives a static
+// or thread-local address: a DW_OP_addr operation, or an expression
+// ending with a TLS operation.
+
+static bool
+die_has_static_location(Dwarf_die* die)
+{
+  const Dwarf_die::Attribute_value* loc =
+      die->attribute(elfcpp::DW_AT_location);
+  if (loc == NULL)
+    return false;
+  switch (loc->form)
+    {
+      case elfcpp::DW_FORM_block1:
+      case elfcpp::DW_FORM_block2:
+      case elfcpp::DW_FORM_block4:
+      case elfcpp::DW_FORM_block:
+      case elfcpp::DW_FORM_exprloc:
+	break;
+      default:
+	// A location list describes an automatic variable.
+	return false;
+    }
+  if (loc->aux.blocklen == 0)
+    return false;
+  const unsigned char* expr = loc->val.blockval;
+  unsigned char last = expr[loc->aux.blocklen - 1];
+  return (expr[0] == elfcpp::DW_OP_addr
+	  || last == elfcpp::DW_OP_form_tls_address
+	  || last == elfcpp::DW_OP_GNU_push_tls_address);
+}
+
+// Visit DIE and its children, adding the names of the DIEs listed in
+// DWARF 5 section 6.1.1.1 to the .debug_names section.  We also
+// remember the names of declarations, functions and variables that
+// are not listed, since later DIEs may complete or inline them.
+
+void
+Gdb_index_info_reader::visit_die_for_names(Dwarf_die* die)
+{
+  unsigned int tag = die->tag();
+  bool is_indexed = false;
+  if (!die->is_declaration())
+    {
+      switch (tag)
+	{
+	  case elfcpp::DW_TAG_base_type:
+	  case elfcpp::DW_TAG_class_type:
+	  case elfcpp::DW_TAG_constant:
+	  case elfcpp::DW_TAG_enumeration_type:
+	  case elfcpp::DW_TAG_enumerator:
+	  case elfcpp::DW_TAG_imported_declaration:
+	  case elfcpp::DW_TAG_interface_type:
+	  case elfcpp::DW_TAG_namespace:
+	  case elfcpp::DW_TAG_ptr_to_member_type:
+	  case elfcpp::DW_TAG_structure_type:
+	  case elfcpp::DW_TAG_subrange_type:
+	  case elfcpp::DW_TAG_typedef:
+	  case elfcpp::DW_TAG_union_type:
+	  case elfcpp::DW_TAG_unspecified_type:
+	    is_indexed = true;
+	    break;
+	  case elfcpp::DW_TAG_inlined_subroutine:
+	  case elfcpp::DW_TAG_label:
+	  case elfcpp::DW_TAG_subprogram:
+	    is_indexed = die_has_address(die);
+	    break;
+	  case elfcpp::DW_TAG_variable:
+	    is_indexed = die_has_static_location(die);
+	    break;
+	  default:
+	    break;
+	}
+    }
+
+  if (is_indexed)
+    this->add_die_names(die);
+  else if (die->is_declaration()
+	   || tag == elfcpp::DW_TAG_subprogram
+	   || tag == elfcpp::DW_TAG_variable)
+    {
+      const char* name;
+      const char* linkage_name;
+      this->get_die_names(die, 0, &name, &linkage_name);
+    }
+
+  this->visit_children_for_names(die);
+}
+
+// Add the names of DIE for the .debug_names section: its DW_AT_name,
+// or that of the DIE it completes or inlines, and for a function or
+// variable its DW_AT_linkage_name.  A namespace without a name is
+// listed as "(anonymous namespace)".
+
+void
+Gdb_index_info_reader::add_die_names(Dwarf_die* die)
+{
+  const char* name;
+  const char* linkage_name;
+  this->get_die_names(die, 0, &name, &linkage_name);
+
+  unsigned int tag = die->tag();
+  if (name == NULL && tag == elfcpp::DW_TAG_namespace)
+    name = "(anonymous namespace)";
+  if (name != NULL)
+    this->info_->add_name(this->cu_index_, name, die->offset(), tag);
+  if (linkage_name != NULL
+      && (tag == elfcpp::DW_TAG_subprogram
+	  || tag == elfcpp::DW_TAG_inlined_subroutine
+	  || tag == elfcpp::DW_TAG_variable)
+      && (name == NULL || strcmp(name, linkage_name) != 0))
+    this->info_->add_name(this->cu_index_, linkage_name, die->offset(), tag);
+}
+
+// Find the DW_AT_name and linkage name of DIE.  If it has neither, look
+// for them in the DIE named by its DW_AT_specification or
+// DW_AT_abstract_origin attribute, and so on down the chain.  DEPTH is
+// the number of links we have followed, which bounds the search in
+// case of a cycle.  Later DIEs may refer to this one as well, so we
+// remember the result.
+
+void
+Gdb_index_info_reader::get_die_names(Dwarf_die* die, int depth,
+				     const char** name,
+				     const char** linkage_name)
+{
+  *name = die->name();
+  *linkage_name = die->linkage_name();
+  off_t decl_offset = die->specification();
+  if (decl_offset == 0)
+    decl_offset = die->abstract_origin();
+  if ((*name == NULL || *linkage_name == NULL)
+      && decl_offset != 0
+      && depth < 8)
+    {
+      const char* decl_name;
+      const char* decl_linkage_name;
+      this->get_decl_names(decl_offset, depth + 1, &decl_name,
+			   &decl_linkage_name);
+      if (*name == NULL)
+	*name = decl_name;
+      if (*linkage_name == NULL)
+	*linkage_name = decl_linkage_name;
+    }
+  this->decl_names_[die->offset()] = std::make_pair(*name, *linkage_name);
+}
+
+// Find the DW_AT_name and linkage name of the DIE at DECL_OFFSET.  We
+// normally saw the DIE before, but if not, we need to read it.  It may
+// precede the current position of the relocation tracker, so we rewind
+// the tracker to the start of the unit, and reset it when we're done.
+
+void
+Gdb_index_info_reader::get_decl_names(off_t decl_offset, int depth,
+				      const char** name,
+				      const char** linkage_name)
+{
+  Decl_names_map::const_iterator it = this->decl_names_.find(decl_offset);
+  if (it != this->decl_names_.end())
+    {
+      *name = it->second.first;
+      *linkage_name = it->second.second;
+      return;
+    }
+
+  *name = NULL;
+  *linkage_name = NULL;
+  uint64_t checkpoint = this->get_reloc_checkpoint();
+  this->reset_relocs(this->unit_checkpoint_);
+  Dwarf_die decl(this, decl_offset, NULL);
+  if (decl.tag() != 0)
+    this->get_die_names(&decl, depth, name, linkage_name);
+  this->reset_relocs(checkpoint);
+}
+
 // Record the address ranges for a compilation unit.
 
 void
@@ -825,8 +1373,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
     {
       Dwarf_range_list* ranges = this->read_range_list(shndx, ranges_offset);
       if (ranges != NULL)
-	this->gdb_index_->add_address_range_list(this->object(),
-						 this->cu_index_, ranges);
+	this->info_->add_address_range_list(this->cu_index_, ranges);
       return;
     }
 
@@ -851,8 +1398,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
         {
 	  Dwarf_range_list* ranges = new Dwarf_range_list();
 	  ranges->add(shndx, low_pc, high_pc);
-	  this->gdb_index_->add_address_range_list(this->object(),
-						   this->cu_index_, ranges);
+	  this->info_->add_address_range_list(this->cu_index_, ranges);
         }
     }
 }
@@ -877,7 +1423,7 @@ Gdb_index_info_reader::read_pubtable(Dwarf_pubnames_table* table, off_t offset)
       if (name == NULL)
         break;
 
-      this->gdb_index_->add_symbol(this->cu_index_, name, flag_byte);
+      this->info_->add_symbol(this->cu_index_, name, flag_byte);
     }
   return true;
 }
@@ -916,8 +1462,7 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
           // have read. If it does, then no need to read the pubnames.
           // If it doesn't, then the caller will have to parse the
           // dies manually to find the names.
-          return this->gdb_index_->pubnames_read(this->object(),
-                                                 stmt_list_off);
+          return this->info_->pubnames_read(stmt_list_off);
         }
       else
         {
@@ -928,10 +1473,10 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
 
   // We found the attribute, so we can check if the corresponding
   // pubnames have been read.
-  if (this->gdb_index_->pubnames_read(this->object(), stmt_list_off))
+  if (this->info_->pubnames_read(stmt_list_off))
     return true;
 
-  this->gdb_index_->set_pubnames_read(this->object(), stmt_list_off);
+  this->info_->set_pubnames_read(stmt_list_off);
 
   // We have an attribute, and the pubnames haven't been read, so read
   // them.
@@ -939,12 +1484,12 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
   // In some of the cases, we could rely on the previous value of
   // offset here, but sorting out which cases complicates the logic
   // enough that it isn't worth it. So just look up the offset again.
-  offset = this->gdb_index_->find_pubname_offset(this->cu_offset());
-  names = this->read_pubtable(this->gdb_index_->pubnames_table(), offset);
+  offset = this->info_->find_pubname_offset(this->cu_offset());
+  names = this->read_pubtable(this->info_->pubnames_table(), offset);
 
   bool types = false;
-  offset = this->gdb_index_->find_pubtype_offset(this->cu_offset());
-  types = this->read_pubtable(this->gdb_index_->pubtypes_table(), offset);
+  offset = this->info_->find_pubtype_offset(this->cu_offset());
+  types = this->read_pubtable(this->info_->pubtypes_table(), offset);
   return names || types;
 }
 
@@ -962,57 +1507,103 @@ Gdb_index_info_reader::clear_declarations()
     }
 
   this->declarations_.clear();
+  this->decl_names_.clear();
 }
 
-// Print usage statistics.
-void
-Gdb_index_info_reader::print_stats()
+// Class Debug_index::Object_info.
+
+Debug_index::Object_info::Object_info(Relobj* object,
+				      unsigned int symtab_shndx)
+  : object_(object), symtab_shndx_(symtab_shndx), symbols_data_(NULL),
+    symbols_size_(0),
+    sections_(), is_scanned_(false),
+    want_symbols_(parameters->options().gdb_index()),
+    want_names_(parameters->options().debug_names()),
+    comp_units_(), type_units_(), ranges_(), symbols_(), symbol_map_(),
+    last_symbol_is_new_(false),
+    names_(), name_map_(), cu_pubname_map_(), cu_pubtype_map_(),
+    pubnames_table_(NULL), pubtypes_table_(NULL), stmt_list_offset_(-1),
+    unsupported_version_(0), has_input_names_(false), stats_()
+{ }
+
+Debug_index::Object_info::~Object_info()
 {
-  fprintf(stderr, _("%s: DWARF CUs: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_cu_count);
-  fprintf(stderr, _("%s: DWARF CUs without pubnames/pubtypes: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_cu_nopubnames_count);
-  fprintf(stderr, _("%s: DWARF TUs: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_tu_count);
-  fprintf(stderr, _("%s: DWARF TUs without pubnames/pubtypes: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_tu_nopubnames_count);
+  delete this->pubnames_table_;
+  delete this->pubtypes_table_;
+  for (Symbols::iterator p = this->symbols_.begin();
+       p != this->symbols_.end();
+       ++p)
+    delete p->cu_vector;
+  for (Local_names::iterator p = this->names_.begin();
+       p != this->names_.end();
+       ++p)
+    delete p->entries;
 }
 
-// Class Gdb_index.
-
-// Construct the .gdb_index section.
+// Return whether the object has a .debug_types section.
 
-Gdb_index::Gdb_index(Output_section* gdb_index_section)
-  : Output_section_data(4),
-    pubnames_table_(NULL),
-    pubtypes_table_(NULL),
-    gdb_index_section_(gdb_index_section),
-    comp_units_(),
-    type_units_(),
-    ranges_(),
-    cu_vector_list_(),
-    cu_vector_offsets_(NULL),
-    stringpool_(),
-    tu_offset_(0),
-    addr_offset_(0),
-    symtab_offset_(0),
-    cu_pool_offset_(0),
-    stringpool_offset_(0),
-    pubnames_object_(NULL),
-    stmt_list_offset_(-1)
+bool
+Debug_index::Object_info::has_type_units() const
 {
-  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+  for (std::vector<Section>::const_iterator p = this->sections_.begin();
+       p != this->sections_.end();
+       ++p)
+    if (p->is_type_unit)
+      return true;
+  return false;
 }
 
-Gdb_index::~Gdb_index()
+// Scan the recorded .debug_info and .debug_types sections.  The
+// caller must hold the object's lock.
+
+void
+Debug_index::Object_info::scan()
 {
-  // Free the memory used by the symbol table.
-  delete this->gdb_symtab_;
-  // Free the memory used by the CU vectors.
-  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
-    delete this->cu_vector_list_[i];
-}
+  gold_assert(!this->is_scanned_);
 
+  if (this->symtab_shndx_ != 0)
+    {
+      section_size_type len;
+      this->symbols_data_ =
+	this->object_->section_contents(this->symtab_shndx_, &len, false);
+      this->symbols_size_ = len;
+    }
+
+  // The pubnames tables are read with the reader for the first
+  // section, and use it to read the tables for the later sections, so
+  // keep it until we are done.
+  Gdb_index_info_reader* first_dwinfo = NULL;
+  for (std::vector<Section>::const_iterator p = this->sections_.begin();
+       p != this->sections_.end();
+       ++p)
+    {
+      Gdb_index_info_reader* dwinfo =
+	new Gdb_index_info_reader(p->is_type_unit, this->object_,
+				  this->symbols_data_, this->symbols_size_,
+				  p->shndx, p->reloc_shndx,
+				  p->reloc_type, this);
+      if (first_dwinfo == NULL)
+	{
+	  first_dwinfo = dwinfo;
+	  this->map_pubnames_and_types_to_dies(dwinfo);
+	}
+      dwinfo->parse();
+      if (dwinfo != first_dwinfo)
+	delete dwinfo;
+    }
+
+  // We no longer need the symbols or the pubnames tables.
+  this->symbols_data_ = NULL;
+  this->symbols_size_ = 0;
+  delete this->pubnames_table_;
+  this->pubnames_table_ = NULL;
+  delete this->pubtypes_table_;
+  this->pubtypes_table_ = NULL;
+  delete first_dwinfo;
+  this->cu_pubname_map_.clear();
+  this->cu_pubtype_map_.clear();
+  this->is_scanned_ = true;
+}
 
 // Scan the pubnames and pubtypes sections and build a map of the
 // various cus and tus they refer to, so we can process the entries
@@ -1020,11 +1611,8 @@ Gdb_index::~Gdb_index()
 // Return the just-read table so it can be cached.
 
 Dwarf_pubnames_table*
-Gdb_index::map_pubtable_to_dies(unsigned int attr,
-                                Gdb_index_info_reader* dwinfo,
-                                Relobj* object,
-                                const unsigned char* symbols,
-                                off_t symbols_size)
+Debug_index::Object_info::map_pubtable_to_dies(unsigned int attr,
+					       Gdb_index_info_reader* dwinfo)
 {
   uint64_t section_offset = 0;
   Dwarf_pubnames_table* table;
@@ -1042,7 +1630,8 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
     }
 
   map->clear();
-  if (!table->read_section(object, symbols, symbols_size))
+  if (!table->read_section(this->object_, this->symbols_data_,
+			   this->symbols_size_))
     return NULL;
 
   while (table->read_header(section_offset))
@@ -1057,30 +1646,24 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
 // Wrapper for map_pubtable_to_dies
 
 void
-Gdb_index::map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                          Relobj* object,
-                                          const unsigned char* symbols,
-                                          off_t symbols_size)
+Debug_index::Object_info::map_pubnames_and_types_to_dies(
+    Gdb_index_info_reader* dwinfo)
 {
-  // This is a new object, so reset the relevant variables.
-  this->pubnames_object_ = object;
   this->stmt_list_offset_ = -1;
 
   delete this->pubnames_table_;
   this->pubnames_table_
-      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames, dwinfo,
-                                   object, symbols, symbols_size);
+      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames, dwinfo);
   delete this->pubtypes_table_;
   this->pubtypes_table_
-      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes, dwinfo,
-                                   object, symbols, symbols_size);
+      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes, dwinfo);
 }
 
 // Given a cu_offset, find the associated section of the pubnames
 // table.
 
 off_t
-Gdb_index::find_pubname_offset(off_t cu_offset)
+Debug_index::Object_info::find_pubname_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubname_map_.find(cu_offset);
   if (it != this->cu_pubname_map_.end())
@@ -1092,7 +1675,7 @@ Gdb_index::find_pubname_offset(off_t cu_offset)
 // table.
 
 off_t
-Gdb_index::find_pubtype_offset(off_t cu_offset)
+Debug_index::Object_info::find_pubtype_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubtype_map_.find(cu_offset);
   if (it != this->cu_pubtype_map_.end())
@@ -1100,81 +1683,350 @@ Gdb_index::find_pubtype_offset(off_t cu_offset)
   return -1;
 }
 
-// Scan a .debug_info or .debug_types input section.
-
-void
-Gdb_index::scan_debug_info(bool is_type_unit,
-			   Relobj* object,
-			   const unsigned char* symbols,
-			   off_t symbols_size,
-			   unsigned int shndx,
-			   unsigned int reloc_shndx,
-			   unsigned int reloc_type)
-{
-  Gdb_index_info_reader dwinfo(is_type_unit, object,
-			       symbols, symbols_size,
-			       shndx, reloc_shndx,
-			       reloc_type, this);
-  if (object != this->pubnames_object_)
-    map_pubnames_and_types_to_dies(&dwinfo, object, symbols, symbols_size);
-  dwinfo.parse();
-}
-
 // Add a symbol.
 
 void
-Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
+Debug_index::Object_info::add_symbol(int cu_index, const char* sym_name,
+				     uint8_t flags)
 {
-  unsigned int hash = mapped_index_string_hash(
-      reinterpret_cast<const unsigned char*>(sym_name));
-  Gdb_symbol* sym = new Gdb_symbol();
-  this->stringpool_.add(sym_name, true, &sym->name_key);
-  sym->hashval = hash;
-  sym->cu_vector_index = 0;
-
-  Gdb_symbol* found = this->gdb_symtab_->add(sym);
-  if (found == sym)
-    {
-      // New symbol -- allocate a new CU index vector.
-      found->cu_vector_index = this->cu_vector_list_.size();
-      this->cu_vector_list_.push_back(new Cu_vector());
-    }
-  else
+  if (!this->want_symbols_)
+    return;
+
+  std::pair<String_map::iterator, bool> ins =
+    this->symbol_map_.insert(std::make_pair(std::string(sym_name),
+					    this->symbols_.size()));
+  if (ins.second)
     {
-      // Found an existing symbol -- append to the existing
-      // CU index vector.
-      delete sym;
+      // New symbol -- hash it here, rather than in the serial merge.
+      const char* name = ins.first->first.c_str();
+      unsigned int hash = mapped_index_string_hash(
+	  reinterpret_cast<const unsigned char*>(name));
+      this->symbols_.push_back(Symbol(name, hash));
     }
+  this->last_symbol_is_new_ = ins.second;
 
   // Add the CU index to the vector list for this symbol,
   // if it's not already on the list.  We only need to
   // check the last added entry.
-  Cu_vector* cu_vec = this->cu_vector_list_[found->cu_vector_index];
+  Cu_vector* cu_vec = this->symbols_[ins.first->second].cu_vector;
   if (cu_vec->size() == 0
       || cu_vec->back().first != cu_index
       || cu_vec->back().second != flags)
     cu_vec->push_back(std::make_pair(cu_index, flags));
 }
 
-// Return TRUE if we have already processed the pubnames associated
-// with the statement list at the given OFFSET.
+// Add a name.
 
-bool
-Gdb_index::pubnames_read(const Relobj* object, off_t offset)
+void
+Debug_index::Object_info::add_name(int cu_index, const char* name,
+				   off_t die_offset, unsigned int tag)
 {
-  bool ret = (this->pubnames_object_ == object
-	      && this->stmt_list_offset_ == offset);
-  return ret;
+  gold_assert(this->want_names_);
+
+  std::pair<String_map::iterator, bool> ins =
+    this->name_map_.insert(std::make_pair(std::string(name),
+					  this->names_.size()));
+  if (ins.second)
+    this->names_.push_back(Local_name(ins.first->first.c_str()));
+
+  Name_entries* entries = this->names_[ins.first->second].entries;
+  Name_entry entry(cu_index, die_offset, tag);
+  if (entries->empty() || !(entries->back() == entry))
+    entries->push_back(entry);
+}
+
+// This task scans the .debug_info and .debug_types sections of one
+// input object.
+
+class Debug_index_scan : public Task
+{
+ public:
+  Debug_index_scan(Debug_index::Object_info* info, Task_token* blocker)
+    : info_(info), blocker_(blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    Relobj* object = this->info_->object();
+    return object->is_locked() ? object->token() : NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->info_->object()->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->info_->scan();
+    this->info_->object()->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Debug_index_scan " + this->info_->object()->name(); }
+
+ private:
+  Debug_index::Object_info* info_;
+  Task_token* blocker_;
+};
+
+// Class Debug_index.
+
+Debug_index::Debug_index()
+  : objects_(), comp_units_(), type_units_(), ranges_(), symbols_(),
+    symbol_pool_(), symbol_map_(),
+    trailing_symbol_lookup_(false), names_complete_(true), names_(),
+    name_pool_(), name_map_()
+{ }
+
+Debug_index::~Debug_index()
+{
+  for (unsigned int i = 0; i < this->objects_.size(); ++i)
+    delete this->objects_[i];
+  for (unsigned int i = 0; i < this->symbols_.size(); ++i)
+    delete this->symbols_[i].cu_vector;
+  for (unsigned int i = 0; i < this->names_.size(); ++i)
+    delete this->names_[i].entries;
 }
 
-// Record that we have processed the pubnames associated with the
-// statement list for OBJECT at the given OFFSET.
+// Record a .debug_info or .debug_types input section.  Sections of
+// the same object are normally recorded one after the other, and are
+// scanned together.
 
 void
-Gdb_index::set_pubnames_read(const Relobj* object, off_t offset)
+Debug_index::add_debug_info(bool is_type_unit,
+			    Relobj* object,
+			    unsigned int symtab_shndx,
+			    unsigned int shndx,
+			    unsigned int reloc_shndx,
+			    unsigned int reloc_type)
 {
-  this->pubnames_object_ = object;
-  this->stmt_list_offset_ = offset;
+  if (this->objects_.empty() || this->objects_.back()->object() != object)
+    this->objects_.push_back(new Object_info(object, symtab_shndx));
+  this->objects_.back()->add_section(is_type_unit, shndx, reloc_shndx,
+				     reloc_type);
+}
+
+// Record that OBJECT has its own .debug_names section.  We discard
+// the input .debug_names sections, so the units of OBJECT are only
+// indexed if we write a .debug_names section for every unit.
+
+void
+Debug_index::add_input_names(Relobj* object)
+{
+  gold_assert(!this->objects_.empty()
+	      && this->objects_.back()->object() == object);
+  this->objects_.back()->set_has_input_names();
+}
+
+// Queue a Debug_index_scan task for each object.
+
+void
+Debug_index::queue_scan_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  // Add all the blockers before queuing any task that may release
+  // them.
+  blocker->add_blockers(this->objects_.size());
+  for (std::vector<Object_info*>::const_iterator p = this->objects_.begin();
+       p != this->objects_.end();
+       ++p)
+    workqueue->queue(new Debug_index_scan(*p, blocker));
+}
+
+// Merge the information from each scanned object.  We walk the
+// objects in input order, so the CU and TU lists, the order of the
+// symbols and names and their string pools, and the CU vectors are
+// the same as if the objects had been scanned one after the other.
+
+void
+Debug_index::merge_objects()
+{
+  // A .debug_names section that leaves out some units would tell the
+  // debugger that they have no names, so if any object has units we
+  // do not index, we write no names at all.
+  if (parameters->options().debug_names())
+    {
+      for (std::vector<Object_info*>::const_iterator p =
+	     this->objects_.begin();
+	   p != this->objects_.end() && this->names_complete_;
+	   ++p)
+	{
+	  const Object_info* info = *p;
+	  const char* name = info->object()->name().c_str();
+	  if (info->has_input_names())
+	    gold_warning(_("%s: input .debug_names section is not merged; "
+			   "not writing a .debug_names section"), name);
+	  else if (info->has_type_units())
+	    gold_warning(_("%s: --debug-names does not support type units; "
+			   "not writing a .debug_names section"), name);
+	  else if (info->unsupported_version() != 0)
+	    gold_warning(_("%s: --debug-names does not support DWARF "
+			   "version %u; not writing a .debug_names section"),
+			 name, info->unsupported_version());
+	  else
+	    continue;
+	  this->names_complete_ = false;
+	}
+    }
+
+  for (std::vector<Object_info*>::const_iterator p = this->objects_.begin();
+       p != this->objects_.end();
+       ++p)
+    {
+      Object_info* info = *p;
+      gold_assert(info->is_scanned());
+
+      // Translate the local CU and TU indexes of this object.
+      const int cu_base = this->comp_units_.size();
+      const int tu_base = this->type_units_.size();
+
+      this->comp_units_.insert(this->comp_units_.end(),
+			       info->comp_units().begin(),
+			       info->comp_units().end());
+      this->type_units_.insert(this->type_units_.end(),
+			       info->type_units().begin(),
+			       info->type_units().end());
+
+      for (std::vector<Per_cu_range_list>::const_iterator q =
+	     info->ranges().begin();
+	   q != info->ranges().end();
+	   ++q)
+	{
+	  int cu_index = static_cast<int>(q->cu_index);
+	  cu_index = cu_index < 0 ? cu_index - tu_base : cu_index + cu_base;
+	  this->ranges_.push_back(Per_cu_range_list(q->object, cu_index,
+						    q->ranges));
+	}
+
+      Symbols& symbols(info->symbols());
+      bool is_new = false;
+      for (Symbols::iterator q = symbols.begin(); q != symbols.end(); ++q)
+	{
+	  Cu_vector* local_vec = q->cu_vector;
+	  for (Cu_vector::iterator r = local_vec->begin();
+	       r != local_vec->end();
+	       ++r)
+	    r->first = r->first < 0 ? r->first - tu_base : r->first + cu_base;
+
+	  Stringpool::Key key;
+	  const char* name = this->symbol_pool_.add(q->name, true, &key);
+	  std::pair<Index_map::iterator, bool> ins =
+	    this->symbol_map_.insert(std::make_pair(key,
+						    this->symbols_.size()));
+	  is_new = ins.second;
+	  if (ins.second)
+	    {
+	      // New symbol -- the object's CU vector becomes its CU
+	      // vector.
+	      this->symbols_.push_back(*q);
+	      this->symbols_.back().name = name;
+	      this->symbols_.back().name_key = key;
+	      q->cu_vector = NULL;
+	      continue;
+	    }
+
+	  // Found an existing symbol -- append to the existing
+	  // CU index vector.
+	  Cu_vector* cu_vec = this->symbols_[ins.first->second].cu_vector;
+	  for (Cu_vector::const_iterator r = local_vec->begin();
+	       r != local_vec->end();
+	       ++r)
+	    if (cu_vec->size() == 0 || cu_vec->back() != *r)
+	      cu_vec->push_back(*r);
+	}
+      // Symbols new to this object are at the end of its list, so the
+      // last lookup in this object found a new symbol only if it was
+      // new to this object and the last of its symbols is new.
+      if (!symbols.empty())
+	this->trailing_symbol_lookup_ = (!info->last_symbol_is_new()
+					 || !is_new);
+
+      // The object frees the names we do not take.
+      Object_info::Local_names& names(info->names());
+      for (Object_info::Local_names::iterator q = names.begin();
+	   this->names_complete_ && q != names.end();
+	   ++q)
+	{
+	  Name_entries* local_entries = q->entries;
+	  for (Name_entries::iterator r = local_entries->begin();
+	       r != local_entries->end();
+	       ++r)
+	    r->cu_index += cu_base;
+
+	  Stringpool::Key key;
+	  const char* name = this->name_pool_.add(q->name, true, &key);
+	  std::pair<Index_map::iterator, bool> ins =
+	    this->name_map_.insert(std::make_pair(key, this->names_.size()));
+	  if (ins.second)
+	    {
+	      this->names_.push_back(Name(name, key, local_entries));
+	      q->entries = NULL;
+	      continue;
+	    }
+
+	  Name_entries* entries = this->names_[ins.first->second].entries;
+	  entries->insert(entries->end(), local_entries->begin(),
+			  local_entries->end());
+	}
+
+      gdb_index_stats.add(*info->stats());
+      delete info;
+    }
+  this->objects_.clear();
+}
+
+// Print usage statistics.
+
+void
+Debug_index::print_stats()
+{
+  if (!parameters->options().gdb_index()
+      && !parameters->options().debug_names())
+    return;
+
+  fprintf(stderr, _("%s: DWARF CUs: %u\n"),
+          program_name, gdb_index_stats.cu_count);
+  fprintf(stderr, _("%s: DWARF CUs without pubnames/pubtypes: %u\n"),
+          program_name, gdb_index_stats.cu_nopubnames_count);
+  fprintf(stderr, _("%s: DWARF TUs: %u\n"),
+          program_name, gdb_index_stats.tu_count);
+  fprintf(stderr, _("%s: DWARF TUs without pubnames/pubtypes: %u\n"),
+          program_name, gdb_index_stats.tu_nopubnames_count);
+}
+
+// Class Gdb_index.
+
+// Construct the .gdb_index section.
+
+Gdb_index::Gdb_index(Output_section* gdb_index_section,
+		     Debug_index* debug_index)
+  : Output_section_data(4),
+    gdb_index_section_(gdb_index_section),
+    debug_index_(debug_index),
+    gdb_symtab_(NULL),
+    cu_vector_offsets_(NULL),
+    tu_offset_(0),
+    addr_offset_(0),
+    symtab_offset_(0),
+    cu_pool_offset_(0),
+    stringpool_offset_(0)
+{
+}
+
+Gdb_index::~Gdb_index()
+{
+  // Free the memory used by the symbol table.
+  delete this->gdb_symtab_;
+  delete[] this->cu_vector_offsets_;
 }
 
 // Set the size of the .gdb_index section.
@@ -1182,37 +2034,69 @@ Gdb_index::set_pubnames_read(const Relobj* object, off_t offset)
 void
 Gdb_index::set_final_data_size()
 {
+  const Debug_index::Symbols& symbols(this->debug_index_->symbols());
+  Stringpool* stringpool = this->debug_index_->symbol_pool();
+
+  // Build the symbol table the first time through.  The symbols are
+  // already unique, and are added in the order they were first seen.
+  if (this->gdb_symtab_ == NULL)
+    {
+      this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+      for (unsigned int i = 0; i < symbols.size(); ++i)
+	{
+	  Gdb_symbol* sym = new Gdb_symbol();
+	  sym->name_key = symbols[i].name_key;
+	  sym->hashval = symbols[i].hashval;
+	  sym->cu_vector_index = i;
+	  Gdb_symbol* found = this->gdb_symtab_->add(sym);
+	  gold_assert(found == sym);
+	}
+      if (this->debug_index_->trailing_symbol_lookup())
+	{
+	  // Repeat the last lookup, which may grow the table.
+	  Gdb_symbol sym;
+	  sym.name_key = symbols.back().name_key;
+	  sym.hashval = symbols.back().hashval;
+	  sym.cu_vector_index = symbols.size() - 1;
+	  Gdb_symbol* found = this->gdb_symtab_->add(&sym);
+	  gold_assert(found != &sym);
+	}
+    }
+
   // Finalize the string pool.
-  this->stringpool_.set_string_offsets();
+  stringpool->set_string_offsets();
 
   // Compute the total size of the CU vectors.
   // For each CU vector, include one entry for the count at the
   // beginning of the vector.
-  unsigned int cu_vector_count = this->cu_vector_list_.size();
+  unsigned int cu_vector_count = symbols.size();
   unsigned int cu_vector_size = 0;
-  this->cu_vector_offsets_ = new off_t[cu_vector_count];
+  if (this->cu_vector_offsets_ == NULL)
+    this->cu_vector_offsets_ = new off_t[cu_vector_count];
   for (unsigned int i = 0; i < cu_vector_count; ++i)
     {
-      Cu_vector* cu_vec = this->cu_vector_list_[i];
+      const Debug_index::Cu_vector* cu_vec = symbols[i].cu_vector;
       cu_vector_offsets_[i] = cu_vector_size;
       cu_vector_size += gdb_index_offset_size * (cu_vec->size() + 1);
     }
 
   // Assign relative offsets to each portion of the index,
   // and find the total size of the section.
+  const std::vector<Debug_index::Per_cu_range_list>&
+    ranges(this->debug_index_->ranges());
   section_size_type data_size = gdb_index_hdr_size;
-  data_size += this->comp_units_.size() * gdb_index_cu_size;
+  data_size += this->debug_index_->comp_units().size() * gdb_index_cu_size;
   this->tu_offset_ = data_size;
-  data_size += this->type_units_.size() * gdb_index_tu_size;
+  data_size += this->debug_index_->type_units().size() * gdb_index_tu_size;
   this->addr_offset_ = data_size;
-  for (unsigned int i = 0; i < this->ranges_.size(); ++i)
-    data_size += this->ranges_[i].ranges->size() * gdb_index_addr_size;
+  for (unsigned int i = 0; i < ranges.size(); ++i)
+    data_size += ranges[i].ranges->size() * gdb_index_addr_size;
   this->symtab_offset_ = data_size;
   data_size += this->gdb_symtab_->capacity() * gdb_index_sym_size;
   this->cu_pool_offset_ = data_size;
   data_size += cu_vector_size;
   this->stringpool_offset_ = data_size;
-  data_size += this->stringpool_.get_strtab_size();
+  data_size += stringpool->get_strtab_size();
 
   this->set_data_size(data_size);
 }
@@ -1226,6 +2110,14 @@ Gdb_index::do_write(Output_file* of)
   const off_t oview_size = this->data_size();
   unsigned char* const oview = of->get_output_view(off, oview_size);
   unsigned char* pov = oview;
+  const std::vector<Debug_index::Comp_unit>&
+    comp_units(this->debug_index_->comp_units());
+  const std::vector<Debug_index::Type_unit>&
+    type_units(this->debug_index_->type_units());
+  const std::vector<Debug_index::Per_cu_range_list>&
+    ranges(this->debug_index_->ranges());
+  const Debug_index::Symbols& symbols(this->debug_index_->symbols());
+  Stringpool* stringpool = this->debug_index_->symbol_pool();
 
   // Write the file header.
   // (1) Version number.
@@ -1250,10 +2142,10 @@ Gdb_index::do_write(Output_file* of)
   gold_assert(pov - oview == gdb_index_hdr_size);
 
   // Write the CU list.
-  unsigned int comp_units_count = this->comp_units_.size();
+  unsigned int comp_units_count = comp_units.size();
   for (unsigned int i = 0; i < comp_units_count; ++i)
     {
-      const Comp_unit& cu = this->comp_units_[i];
+      const Debug_index::Comp_unit& cu = comp_units[i];
       elfcpp::Swap<64, false>::writeval(pov, cu.cu_offset);
       elfcpp::Swap<64, false>::writeval(pov + 8, cu.cu_length);
       pov += 16;
@@ -1262,9 +2154,9 @@ Gdb_index::do_write(Output_file* of)
   gold_assert(pov - oview == this->tu_offset_);
 
   // Write the types CU list.
-  for (unsigned int i = 0; i < this->type_units_.size(); ++i)
+  for (unsigned int i = 0; i < type_units.size(); ++i)
     {
-      const Type_unit& tu = this->type_units_[i];
+      const Debug_index::Type_unit& tu = type_units[i];
       elfcpp::Swap<64, false>::writeval(pov, tu.tu_offset);
       elfcpp::Swap<64, false>::writeval(pov + 8, tu.type_offset);
       elfcpp::Swap<64, false>::writeval(pov + 16, tu.type_signature);
@@ -1274,18 +2166,18 @@ Gdb_index::do_write(Output_file* of)
   gold_assert(pov - oview == this->addr_offset_);
 
   // Write the address area.
-  for (unsigned int i = 0; i < this->ranges_.size(); ++i)
+  for (unsigned int i = 0; i < ranges.size(); ++i)
     {
-      int cu_index = this->ranges_[i].cu_index;
+      int cu_index = ranges[i].cu_index;
       // Translate negative indexes, which refer to a TU, to a
       // logical index into a concatenated CU/TU list.
       if (cu_index < 0)
         cu_index = comp_units_count + (-1 - cu_index);
-      Relobj* object = this->ranges_[i].object;
-      const Dwarf_range_list& ranges = *this->ranges_[i].ranges;
-      for (unsigned int j = 0; j < ranges.size(); ++j)
+      Relobj* object = ranges[i].object;
+      const Dwarf_range_list& range_list = *ranges[i].ranges;
+      for (unsigned int j = 0; j < range_list.size(); ++j)
         {
-	  const Dwarf_range_list::Range& range = ranges[j];
+	  const Dwarf_range_list::Range& range = range_list[j];
 	  uint64_t base = 0;
 	  if (range.shndx > 0)
 	    {
@@ -1311,7 +2203,7 @@ Gdb_index::do_write(Output_file* of)
       unsigned int cu_vector_offset = 0;
       if (sym != NULL)
 	{
-	  name_offset = (this->stringpool_.get_offset_from_key(sym->name_key)
+	  name_offset = (stringpool->get_offset_from_key(sym->name_key)
 			 + this->stringpool_offset_ - this->cu_pool_offset_);
 	  cu_vector_offset = this->cu_vector_offsets_[sym->cu_vector_index];
 	}
@@ -1323,9 +2215,9 @@ Gdb_index::do_write(Output_file* of)
   gold_assert(pov - oview == this->cu_pool_offset_);
 
   // Write the CU vectors into the constant pool.
-  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
+  for (unsigned int i = 0; i < symbols.size(); ++i)
     {
-      Cu_vector* cu_vec = this->cu_vector_list_[i];
+      const Debug_index::Cu_vector* cu_vec = symbols[i].cu_vector;
       elfcpp::Swap<32, false>::writeval(pov, cu_vec->size());
       pov += 4;
       for (unsigned int j = 0; j < cu_vec->size(); ++j)
@@ -1343,17 +2235,259 @@ Gdb_index::do_write(Output_file* of)
   gold_assert(pov - oview == this->stringpool_offset_);
 
   // Write the strings into the constant pool.
-  this->stringpool_.write_to_buffer(pov, oview_size - this->stringpool_offset_);
+  stringpool->write_to_buffer(pov, oview_size - this->stringpool_offset_);
 
   of->write_output_view(off, oview_size, oview);
 }
 
-// Print usage statistics.
+// Class Debug_names.
+
+// The size of the .debug_names header, including the augmentation
+// string.
+const section_size_type debug_names_hdr_size = 40;
+
+// The augmentation string, which identifies the producer.
+const char debug_names_augmentation[] = "GOLD";
+
+// The hash function for names in the .debug_names section, from
+// section 6.1.1.4.5 of the DWARF 5 standard.
+
+static uint32_t
+debug_names_hash(const char* name)
+{
+  uint32_t h = 5381;
+  for (const unsigned char* p = reinterpret_cast<const unsigned char*>(name);
+       *p != '\0';
+       ++p)
+    h = h * 33 + tolower(*p);
+  return h;
+}
+
+Debug_names::Debug_names(Debug_index* debug_index,
+			 Output_section_data* strtab)
+  : Output_section_data(4),
+    debug_index_(debug_index),
+    strtab_(strtab),
+    name_order_(),
+    hashes_(),
+    buckets_(),
+    abbrev_table_(),
+    entry_offsets_(),
+    entry_pool_()
+{
+}
+
+// Set the size of the .debug_names section.  If there are units we
+// did not index, the section is empty, which tells the debugger to
+// read the debug info itself.
+
+void
+Debug_names::set_final_data_size()
+{
+  if (!this->debug_index_->names_complete())
+    {
+      this->set_data_size(0);
+      return;
+    }
+
+  const Debug_index::Names& names(this->debug_index_->names());
+  const unsigned int name_count = names.size();
+
+  // Build the hash table, the abbreviation table, and the entry pool
+  // the first time through.  The abbreviation table always ends with
+  // a zero code, so it is never empty once built.
+  if (this->abbrev_table_.empty())
+    {
+      unsigned int bucket_count;
+      if (name_count > 1024)
+	bucket_count = name_count / 4;
+      else if (name_count > 16)
+	bucket_count = name_count / 2;
+      else
+	bucket_count = name_count;
+
+      // Sort the names by bucket, keeping the names in each bucket in
+      // the order they were first seen.
+      std::vector<uint32_t> hashes(name_count);
+      std::vector<unsigned int> bucket_starts(bucket_count + 1, 0);
+      for (unsigned int i = 0; i < name_count; ++i)
+	{
+	  hashes[i] = debug_names_hash(names[i].name);
+	  ++bucket_starts[hashes[i] % bucket_count + 1];
+	}
+      for (unsigned int i = 0; i < bucket_count; ++i)
+	bucket_starts[i + 1] += bucket_starts[i];
+
+      this->buckets_.resize(bucket_count);
+      for (unsigned int i = 0; i < bucket_count; ++i)
+	this->buckets_[i] = (bucket_starts[i] == bucket_starts[i + 1]
+			     ? 0
+			     : bucket_starts[i] + 1);
+
+      this->name_order_.resize(name_count);
+      this->hashes_.resize(name_count);
+      for (unsigned int i = 0; i < name_count; ++i)
+	{
+	  unsigned int pos = bucket_starts[hashes[i] % bucket_count]++;
+	  this->name_order_[pos] = i;
+	  this->hashes_[pos] = hashes[i];
+	}
+
+      // Every entry records the index of its CU and the offset of its
+      // DIE, so we need one abbreviation for each tag.
+      Unordered_map<unsigned int, unsigned int> abbrev_codes;
+      this->entry_offsets_.resize(name_count);
+      for (unsigned int i = 0; i < name_count; ++i)
+	{
+	  this->entry_offsets_[i] = this->entry_pool_.size();
+	  const Debug_index::Name_entries& entries =
+	    *names[this->name_order_[i]].entries;
+	  for (Debug_index::Name_entries::const_iterator p = entries.begin();
+	       p != entries.end();
+	       ++p)
+	    {
+	      std::pair<Unordered_map<unsigned int, unsigned int>::iterator,
+			bool> ins =
+		abbrev_codes.insert(std::make_pair(p->tag,
+						   abbrev_codes.size() + 1));
+	      unsigned int code = ins.first->second;
+	      if (ins.second)
+		{
+		  std::vector<unsigned char>* abbrevs = &this->abbrev_table_;
+		  write_unsigned_LEB_128(abbrevs, code);
+		  write_unsigned_LEB_128(abbrevs, p->tag);
+		  write_unsigned_LEB_128(abbrevs, elfcpp::DW_IDX_compile_unit);
+		  write_unsigned_LEB_128(abbrevs, elfcpp::DW_FORM_udata);
+		  write_unsigned_LEB_128(abbrevs, elfcpp::DW_IDX_die_offset);
+		  write_unsigned_LEB_128(abbrevs, elfcpp::DW_FORM_ref4);
+		  write_unsigned_LEB_128(abbrevs, 0);
+		  write_unsigned_LEB_128(abbrevs, 0);
+		}
+	      write_unsigned_LEB_128(&this->entry_pool_, code);
+	      write_unsigned_LEB_128(&this->entry_pool_, p->cu_index);
+	      insert_into_vector<32>(&this->entry_pool_, p->die_offset);
+	    }
+	  // A zero code ends the list of entries for the name.
+	  this->entry_pool_.push_back(0);
+	}
+      this->abbrev_table_.push_back(0);
+    }
+
+  section_size_type data_size = debug_names_hdr_size;
+  data_size += this->debug_index_->comp_units().size() * 4;
+  data_size += this->buckets_.size() * 4;
+  // The hashes, the string offsets, and the entry offsets.
+  data_size += name_count * 3 * 4;
+  data_size += this->abbrev_table_.size();
+  data_size += this->entry_pool_.size();
+
+  this->set_data_size(data_size);
+}
+
+// Write the data to the file.
+
 void
-Gdb_index::print_stats()
+Debug_names::do_write(Output_file* of)
 {
-  if (parameters->options().gdb_index())
-    Gdb_index_info_reader::print_stats();
+  const off_t off = this->offset();
+  const section_size_type oview_size = this->data_size();
+  if (oview_size == 0)
+    return;
+  unsigned char* const oview = of->get_output_view(off, oview_size);
+  this->do_write_to_buffer(oview);
+  of->write_output_view(off, oview_size, oview);
+}
+
+// Write the data to a buffer.  This is used when the section is
+// compressed.
+
+void
+Debug_names::do_write_to_buffer(unsigned char* buffer)
+{
+  if (this->data_size() == 0)
+    return;
+  if (parameters->target().is_big_endian())
+    this->write_contents<true>(buffer);
+  else
+    this->write_contents<false>(buffer);
+}
+
+template<bool big_endian>
+void
+Debug_names::write_contents(unsigned char* const oview)
+{
+  const std::vector<Debug_index::Comp_unit>&
+    comp_units(this->debug_index_->comp_units());
+  const Debug_index::Names& names(this->debug_index_->names());
+  Stringpool* name_pool = this->debug_index_->name_pool();
+  const unsigned int name_count = names.size();
+  unsigned char* pov = oview;
+
+  // Write the header.
+  // (1) Unit length.
+  elfcpp::Swap<32, big_endian>::writeval(pov, this->data_size() - 4);
+  // (2) Version number, and padding.
+  elfcpp::Swap<16, big_endian>::writeval(pov + 4, 5);
+  elfcpp::Swap<16, big_endian>::writeval(pov + 6, 0);
+  // (3) CU count, local TU count, and foreign TU count.
+  elfcpp::Swap<32, big_endian>::writeval(pov + 8, comp_units.size());
+  elfcpp::Swap<32, big_endian>::writeval(pov + 12, 0);
+  elfcpp::Swap<32, big_endian>::writeval(pov + 16, 0);
+  // (4) Bucket count and name count.
+  elfcpp::Swap<32, big_endian>::writeval(pov + 20, this->buckets_.size());
+  elfcpp::Swap<32, big_endian>::writeval(pov + 24, name_count);
+  // (5) Abbreviation table size.
+  elfcpp::Swap<32, big_endian>::writeval(pov + 28,
+					 this->abbrev_table_.size());
+  // (6) Augmentation string size, and augmentation string.
+  elfcpp::Swap<32, big_endian>::writeval(pov + 32, 4);
+  memcpy(pov + 36, debug_names_augmentation, 4);
+  pov += debug_names_hdr_size;
+
+  // Write the CU list.
+  for (unsigned int i = 0; i < comp_units.size(); ++i)
+    {
+      elfcpp::Swap<32, big_endian>::writeval(pov, comp_units[i].cu_offset);
+      pov += 4;
+    }
+
+  // Write the hash table.
+  for (unsigned int i = 0; i < this->buckets_.size(); ++i)
+    {
+      elfcpp::Swap<32, big_endian>::writeval(pov, this->buckets_[i]);
+      pov += 4;
+    }
+  for (unsigned int i = 0; i < name_count; ++i)
+    {
+      elfcpp::Swap<32, big_endian>::writeval(pov, this->hashes_[i]);
+      pov += 4;
+    }
+
+  // Write the name table: the offsets of the names in the .debug_str
+  // section, then the offsets of their entries in the entry pool.
+  const section_offset_type strtab_offset =
+    this->strtab_->address() - this->strtab_->output_section()->address();
+  for (unsigned int i = 0; i < name_count; ++i)
+    {
+      const Debug_index::Name& name(names[this->name_order_[i]]);
+      elfcpp::Swap<32, big_endian>::writeval(
+	  pov, strtab_offset + name_pool->get_offset_from_key(name.name_key));
+      pov += 4;
+    }
+  for (unsigned int i = 0; i < name_count; ++i)
+    {
+      elfcpp::Swap<32, big_endian>::writeval(pov, this->entry_offsets_[i]);
+      pov += 4;
+    }
+
+  // Write the abbreviation table and the entry pool.
+  memcpy(pov, &this->abbrev_table_[0], this->abbrev_table_.size());
+  pov += this->abbrev_table_.size();
+  if (!this->entry_pool_.empty())
+    memcpy(pov, &this->entry_pool_[0], this->entry_pool_.size());
+  pov += this->entry_pool_.size();
+
+  gold_assert(pov - oview == this->data_size());
 }
 
 } // End namespace gold.
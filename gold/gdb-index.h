@@ -1,4 +1,4 @@
-// gdb-index.h -- generate .gdb_index section for fast debug lookup  -*- C++ -*-
+// gdb-index.h -- generate .gdb_index and .debug_names sections   -*- C++ -*-
 
 // Copyright (C) 2012-2017 Free Software Foundation, Inc.
 // Written by Cary Coutant <ccoutant@google.com>.
@@ -42,92 +42,248 @@ class Sized_relobj;
 class Dwarf_range_list;
 template <typename T>
 class Gdb_hashtab;
-class Gdb_index_info_reader;
-class Dwarf_pubnames_table;
+class Workqueue;
+class Task_token;
 
-// This class manages the .gdb_index section, which is a fast
-// lookup table for DWARF information used by the gdb debugger.
-// The format of this section is described in gdb/doc/gdb.texinfo.
+// This class collects the information needed for the .gdb_index and
+// .debug_names sections from the .debug_info and .debug_types
+// sections of the input objects.  The debug info of each input object
+// is scanned by a separate task, and the results are merged in input
+// order before the layout is finalized, so the indexes do not depend
+// on the order the tasks ran in.
 
-class Gdb_index : public Output_section_data
+class Debug_index
 {
  public:
-  Gdb_index(Output_section* gdb_index_section);
+  Debug_index();
 
-  ~Gdb_index();
+  ~Debug_index();
+
+  // The information gathered from the .debug_info and .debug_types
+  // sections of one input object.
+  class Object_info;
+
+  // An entry in the compilation unit list.
+  struct Comp_unit
+  {
+    Comp_unit(off_t off, off_t len)
+      : cu_offset(off), cu_length(len)
+    { }
+    uint64_t cu_offset;
+    uint64_t cu_length;
+  };
 
-  // Scan a .debug_info or .debug_types input section.
-  void scan_debug_info(bool is_type_unit,
-		       Relobj* object,
-		       const unsigned char* symbols,
-		       off_t symbols_size,
-		       unsigned int shndx,
-		       unsigned int reloc_shndx,
-		       unsigned int reloc_type);
-
-  // Add a compilation unit.
-  int
-  add_comp_unit(off_t cu_offset, off_t cu_length)
+  // An entry in the type unit list.
+  struct Type_unit
   {
-    this->comp_units_.push_back(Comp_unit(cu_offset, cu_length));
-    return this->comp_units_.size() - 1;
-  }
+    Type_unit(off_t off, off_t toff, uint64_t sig)
+      : tu_offset(off), type_offset(toff), type_signature(sig)
+    { }
+    uint64_t tu_offset;
+    uint64_t type_offset;
+    uint64_t type_signature;
+  };
 
-  // Add a type unit.
-  int
-  add_type_unit(off_t tu_offset, off_t type_offset, uint64_t signature)
+  // An entry in the address range list.
+  struct Per_cu_range_list
   {
-    this->type_units_.push_back(Type_unit(tu_offset, type_offset, signature));
-    return this->type_units_.size() - 1;
-  }
+    Per_cu_range_list(Relobj* obj, uint32_t index, Dwarf_range_list* r)
+      : object(obj), cu_index(index), ranges(r)
+    { }
+    Relobj* object;
+    uint32_t cu_index;
+    Dwarf_range_list* ranges;
+  };
 
-  // Add an address range.
-  void
-  add_address_range_list(Relobj* object, unsigned int cu_index,
-			 Dwarf_range_list* ranges)
+  // The CU and TU indexes, and the gdb_index version 7 flags, of a
+  // symbol in the .gdb_index section.  A TU has a negative index.
+  typedef std::vector<std::pair<int, uint8_t> > Cu_vector;
+
+  // A symbol for the .gdb_index section, named by its fully qualified
+  // name.
+  struct Symbol
   {
-    this->ranges_.push_back(Per_cu_range_list(object, cu_index, ranges));
-  }
+    Symbol(const char* n, unsigned int h)
+      : name(n), name_key(0), hashval(h), cu_vector(new Cu_vector())
+    { }
 
-  // Add a symbol.  FLAGS are the gdb_index version 7 flags to be stored in
-  // the high-byte of the cu_index field.
-  void
-  add_symbol(int cu_index, const char* sym_name, uint8_t flags);
+    // The name.
+    const char* name;
+    // The key of the name in the symbol string pool, once merged.
+    Stringpool::Key name_key;
+    // The hash value of the name.
+    unsigned int hashval;
+    // The CUs and TUs which define the symbol.
+    Cu_vector* cu_vector;
+  };
 
-  // Return the offset into the pubnames table for the cu at the given
-  // offset.
-  off_t
-  find_pubname_offset(off_t cu_offset);
+  typedef std::vector<Symbol> Symbols;
 
-  // Return the offset into the pubtypes table for the cu at the
-  // given offset.
-  off_t
-  find_pubtype_offset(off_t cu_offset);
+  // A DIE for the .debug_names section.
+  struct Name_entry
+  {
+    Name_entry(int cu, off_t off, unsigned int t)
+      : cu_index(cu), die_offset(off), tag(t)
+    { }
 
-  // Return TRUE if we have already processed the pubnames and types
-  // set for OBJECT of the CUs and TUS associated with the statement
-  // list at OFFSET.
-  bool
-  pubnames_read(const Relobj* object, off_t offset);
+    bool
+    operator==(const Name_entry& e) const
+    {
+      return (this->cu_index == e.cu_index
+	      && this->die_offset == e.die_offset
+	      && this->tag == e.tag);
+    }
+
+    // The index of the CU.
+    int cu_index;
+    // The offset of the DIE within the CU.
+    uint64_t die_offset;
+    // The tag of the DIE.
+    unsigned int tag;
+  };
+
+  typedef std::vector<Name_entry> Name_entries;
+
+  // A name for the .debug_names section, with the DIEs it names.
+  struct Name
+  {
+    Name(const char* n, Stringpool::Key k, Name_entries* e)
+      : name(n), name_key(k), entries(e)
+    { }
+
+    // The name.
+    const char* name;
+    // The key of the name in the names string pool.
+    Stringpool::Key name_key;
+    // The DIEs.
+    Name_entries* entries;
+  };
+
+  typedef std::vector<Name> Names;
+
+  // Record a .debug_info or .debug_types input section.  The section
+  // is scanned later, by the task queued for its object by
+  // queue_scan_tasks, which reads the symbol table in section
+  // SYMTAB_SHNDX.
+  void
+  add_debug_info(bool is_type_unit,
+		 Relobj* object,
+		 unsigned int symtab_shndx,
+		 unsigned int shndx,
+		 unsigned int reloc_shndx,
+		 unsigned int reloc_type);
+
+  // Record that OBJECT, whose .debug_info section has been recorded,
+  // has its own .debug_names section.
+  void
+  add_input_names(Relobj* object);
+
+  // Queue a task to scan the recorded sections of each input object.
+  // Each task holds BLOCKER until it is done.
+  void
+  queue_scan_tasks(Workqueue*, Task_token* blocker);
 
-  // Record that we have already read the pubnames associated with
-  // OBJECT and OFFSET.
+  // Merge the information gathered from each input object, in input
+  // order.  This is called when all the scan tasks are done.
   void
-  set_pubnames_read(const Relobj* object, off_t offset);
+  merge_objects();
+
+  // Return the list of DWARF compilation units.
+  const std::vector<Comp_unit>&
+  comp_units() const
+  { return this->comp_units_; }
+
+  // Return the list of DWARF type units.
+  const std::vector<Type_unit>&
+  type_units() const
+  { return this->type_units_; }
+
+  // Return the list of address ranges.
+  const std::vector<Per_cu_range_list>&
+  ranges() const
+  { return this->ranges_; }
+
+  // Return the symbols for the .gdb_index section, in the order they
+  // were first seen.
+  const Symbols&
+  symbols() const
+  { return this->symbols_; }
+
+  // Return the string pool holding the symbol names.
+  Stringpool*
+  symbol_pool()
+  { return &this->symbol_pool_; }
+
+  // Return true if the last symbol lookup made by a serial scan of the
+  // objects would have found an existing symbol.  Such a lookup may
+  // grow the .gdb_index hash table, and Gdb_index repeats it so that
+  // the table does not depend on how the objects were scanned.
+  bool
+  trailing_symbol_lookup() const
+  { return this->trailing_symbol_lookup_; }
+
+  // Return whether the .debug_names section can describe every unit.
+  // It cannot describe type units, units we could not read, or the
+  // units of an object that has its own .debug_names section.
+  bool
+  names_complete() const
+  { return this->names_complete_; }
 
-  // Return a pointer to the given table.
-  Dwarf_pubnames_table*
-  pubnames_table()
-  { return pubnames_table_; }
+  // Return the names for the .debug_names section, in the order they
+  // were first seen.
+  const Names&
+  names() const
+  { return this->names_; }
 
-  Dwarf_pubnames_table*
-  pubtypes_table()
-  { return pubtypes_table_; }
+  // Return the string pool holding the .debug_names names.
+  Stringpool*
+  name_pool()
+  { return &this->name_pool_; }
 
   // Print usage statistics.
   static void
   print_stats();
 
+ private:
+  typedef Unordered_map<Stringpool::Key, unsigned int> Index_map;
+
+  // The input objects with sections to scan, in input order.
+  std::vector<Object_info*> objects_;
+  // The list of DWARF compilation units.
+  std::vector<Comp_unit> comp_units_;
+  // The list of DWARF type units.
+  std::vector<Type_unit> type_units_;
+  // The list of address ranges.
+  std::vector<Per_cu_range_list> ranges_;
+  // The symbols for the .gdb_index section.
+  Symbols symbols_;
+  // The names of the symbols.
+  Stringpool symbol_pool_;
+  // Map from a key in SYMBOL_POOL_ to an index in SYMBOLS_.
+  Index_map symbol_map_;
+  // Whether the last symbol lookup found an existing symbol.
+  bool trailing_symbol_lookup_;
+  // Whether the .debug_names section can describe every unit.
+  bool names_complete_;
+  // The names for the .debug_names section.
+  Names names_;
+  // The strings of the names.
+  Stringpool name_pool_;
+  // Map from a key in NAME_POOL_ to an index in NAMES_.
+  Index_map name_map_;
+};
+
+// This class manages the .gdb_index section, which is a fast
+// lookup table for DWARF information used by the gdb debugger.
+// The format of this section is described in gdb/doc/gdb.texinfo.
+
+class Gdb_index : public Output_section_data
+{
+ public:
+  Gdb_index(Output_section* gdb_index_section, Debug_index* debug_index);
+
+  ~Gdb_index();
+
  protected:
   // This is called to update the section size prior to assigning
   // the address and file offset.
@@ -148,54 +304,7 @@ class Gdb_index : public Output_section_data
   do_print_to_mapfile(Mapfile* mapfile) const
   { mapfile->print_output_data(this, _("** gdb_index")); }
 
-  // Create a map from dies to pubnames.
-  Dwarf_pubnames_table*
-  map_pubtable_to_dies(unsigned int attr,
-                       Gdb_index_info_reader* dwinfo,
-                       Relobj* object,
-                       const unsigned char* symbols,
-                       off_t symbols_size);
-
-  // Wrapper for map_pubtable_to_dies
-  void
-  map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                 Relobj* object,
-                                 const unsigned char* symbols,
-                                 off_t symbols_size);
-
  private:
-  // An entry in the compilation unit list.
-  struct Comp_unit
-  {
-    Comp_unit(off_t off, off_t len)
-      : cu_offset(off), cu_length(len)
-    { }
-    uint64_t cu_offset;
-    uint64_t cu_length;
-  };
-
-  // An entry in the type unit list.
-  struct Type_unit
-  {
-    Type_unit(off_t off, off_t toff, uint64_t sig)
-      : tu_offset(off), type_offset(toff), type_signature(sig)
-    { }
-    uint64_t tu_offset;
-    uint64_t type_offset;
-    uint64_t type_signature;
-  };
-
-  // An entry in the address range list.
-  struct Per_cu_range_list
-  {
-    Per_cu_range_list(Relobj* obj, uint32_t index, Dwarf_range_list* r)
-      : object(obj), cu_index(index), ranges(r)
-    { }
-    Relobj* object;
-    uint32_t cu_index;
-    Dwarf_range_list* ranges;
-  };
-
   // A symbol table entry.
   struct Gdb_symbol
   {
@@ -214,49 +323,79 @@ class Gdb_index : public Output_section_data
     { return this->name_key == symbol->name_key; }
   };
 
-  typedef std::vector<std::pair<int, uint8_t> > Cu_vector;
-
-  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
-  Pubname_offset_map cu_pubname_map_;
-  Pubname_offset_map cu_pubtype_map_;
-
-  // Scan the given pubtable and build a map of the various dies it
-  // refers to, so we can process the entries when we encounter the
-  // die.
-  void
-  map_pubtable_to_dies(Dwarf_pubnames_table* table,
-                       Pubname_offset_map* map);
-
-  // Tables to store the pubnames section of the current object.
-  Dwarf_pubnames_table* pubnames_table_;
-  Dwarf_pubnames_table* pubtypes_table_;
-
   // The .gdb_index section.
   Output_section* gdb_index_section_;
-  // The list of DWARF compilation units.
-  std::vector<Comp_unit> comp_units_;
-  // The list of DWARF type units.
-  std::vector<Type_unit> type_units_;
-  // The list of address ranges.
-  std::vector<Per_cu_range_list> ranges_;
+  // The information collected from the debug info.
+  Debug_index* debug_index_;
   // The symbol table.
   Gdb_hashtab<Gdb_symbol>* gdb_symtab_;
-  // The CU vector portion of the constant pool.
-  std::vector<Cu_vector*> cu_vector_list_;
   // An array to map from a CU vector index to an offset to the constant pool.
   off_t* cu_vector_offsets_;
-  // The string portion of the constant pool.
-  Stringpool stringpool_;
   // Offsets of the various pieces of the .gdb_index section.
   off_t tu_offset_;
   off_t addr_offset_;
   off_t symtab_offset_;
   off_t cu_pool_offset_;
   off_t stringpool_offset_;
-  // Object, stmt list offset of the CUs and TUs associated with the
-  // last read pubnames and pubtypes sections.
-  const Relobj* pubnames_object_;
-  off_t stmt_list_offset_;
+};
+
+// This class manages the DWARF 5 .debug_names section, a name index
+// of the compilation units described in section 6.1.1 of the DWARF 5
+// standard.  The names are stored in STRTAB, which is added to the
+// .debug_str section.
+
+class Debug_names : public Output_section_data
+{
+ public:
+  Debug_names(Debug_index* debug_index, Output_section_data* strtab);
+
+ protected:
+  // This is called to update the section size prior to assigning
+  // the address and file offset.
+  void
+  update_data_size()
+  { this->set_final_data_size(); }
+
+  // Set the final data size.
+  void
+  set_final_data_size();
+
+  // Write the data to the file.
+  void
+  do_write(Output_file*);
+
+  // Write the data to a buffer.
+  void
+  do_write_to_buffer(unsigned char*);
+
+  // Write to a map file.
+  void
+  do_print_to_mapfile(Mapfile* mapfile) const
+  { mapfile->print_output_data(this, _("** debug_names")); }
+
+ private:
+  // Write the section contents to POV.
+  template<bool big_endian>
+  void
+  write_contents(unsigned char* pov);
+
+  // The information collected from the debug info.
+  Debug_index* debug_index_;
+  // The string table in the .debug_str section.
+  Output_section_data* strtab_;
+  // The indexes of the names in the table, sorted by bucket.
+  std::vector<unsigned int> name_order_;
+  // The hash values of the names, in the same order.
+  std::vector<uint32_t> hashes_;
+  // The index, plus one, of the first name in each bucket, or zero if
+  // the bucket is empty.
+  std::vector<uint32_t> buckets_;
+  // The abbreviation table.
+  std::vector<unsigned char> abbrev_table_;
+  // The offset of the entries of each name in the entry pool.
+  std::vector<uint32_t> entry_offsets_;
+  // The entry pool.
+  std::vector<unsigned char> entry_pool_;
 };
 
 } // End namespace gold.
@@ -45,6 +45,7 @@
 #include "gc.h"
 #include "icf.h"
 #include "incremental.h"
+#include "gdb-index.h"
 #include "timer.h"
 
 namespace gold
@@ -134,6 +135,39 @@ Middle_runner::run(Workqueue* workqueue, const Task* task)
 		     this->layout_, workqueue, this->mapfile_);
 }
 
+// This class arranges to run the rest of the functions done in the
+// middle of the link once identical code folding is done.
+
+class Middle_layout_runner : public Task_function_runner
+{
+ public:
+  Middle_layout_runner(const General_options& options,
+		       const Input_objects* input_objects,
+		       Symbol_table* symtab,
+		       Layout* layout, Mapfile* mapfile)
+    : options_(options), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), mapfile_(mapfile)
+  { }
+
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  const General_options& options_;
+  const Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Mapfile* mapfile_;
+};
+
+void
+Middle_layout_runner::run(Workqueue* workqueue, const Task* task)
+{
+  queue_middle_layout_tasks(this->options_, task, this->input_objects_,
+			    this->symtab_, this->layout_, workqueue,
+			    this->mapfile_);
+}
+
 // This class arranges the tasks to process the relocs for garbage collection.
 
 class Gc_runner : public Task_function_runner
@@ -269,6 +303,15 @@ queue_initial_tasks(const General_options& options,
 	workqueue->queue(tasks[i]);
     }
 
+  // Symbols from relocatable objects may still be being added to the
+  // symbol table shards after the last input file's tasks are done.
+  // Wait for them before going on.
+  Task_token* symbols_blocker = new Task_token(true);
+  symbols_blocker->add_blocker();
+  workqueue->queue(new Wait_for_symbols(symtab, this_blocker,
+					symbols_blocker));
+  this_blocker = symbols_blocker;
+
   if (options.has_plugins())
     {
       Task_token* next_blocker = new Task_token(true);
@@ -527,12 +570,43 @@ queue_middle_tasks(const General_options& options,
 
   // If identical code folding (--icf) is chosen it makes sense to do it
   // only after garbage collection (--gc-sections) as we do not want to
-  // be folding sections that will be garbage.
+  // be folding sections that will be garbage.  The identical sections
+  // are found by a set of tasks, and the rest of the middle tasks are
+  // queued when they are done.
   if (parameters->options().icf_enabled())
     {
-      symtab->icf()->find_identical_sections(input_objects, symtab);
+      Task_token* icf_blocker = new Task_token(true);
+      icf_blocker->add_blocker();
+      symtab->icf()->queue_find_identical_sections(input_objects, symtab,
+						   workqueue, task,
+						   icf_blocker);
+      workqueue->queue(new Task_function(new Middle_layout_runner(options,
+								  input_objects,
+								  symtab,
+								  layout,
+								  mapfile),
+					 icf_blocker,
+					 "Task_function Middle_layout_runner"));
+      return;
     }
 
+  queue_middle_layout_tasks(options, task, input_objects, symtab, layout,
+			    workqueue, mapfile);
+}
+
+// Queue up the rest of the middle set of tasks, starting with the
+// second layout of the input sections.  This is called directly by
+// queue_middle_tasks, or once identical code folding is done.
+
+void
+queue_middle_layout_tasks(const General_options& options,
+			  const Task* task,
+			  const Input_objects* input_objects,
+			  Symbol_table* symtab,
+			  Layout* layout,
+			  Workqueue* workqueue,
+			  Mapfile* mapfile)
+{
   // Call Object::layout for the second time to determine the
   // output_sections for all referenced input sections.  When
   // --gc-sections or --icf is turned on, or when certain input
@@ -701,13 +775,20 @@ queue_middle_tasks(const General_options& options,
 
   // Allocate common symbols.  We use a blocker to run this before the
   // Scan_relocs tasks, because it writes to the symbol table just as
-  // they do.
-  if (parameters->options().define_common())
+  // they do.  When building a .gdb_index or .debug_names section, the
+  // tasks that scan the debug info of each object share the blocker,
+  // so the indexes are complete before the layout is finalized.
+  Debug_index* debug_index = layout->debug_index();
+  if (parameters->options().define_common() || debug_index != NULL)
     {
       this_blocker = new Task_token(true);
-      this_blocker->add_blocker();
-      workqueue->queue(new Allocate_commons_task(symtab, layout, mapfile,
-						 this_blocker));
+      if (parameters->options().define_common())
+	this_blocker->add_blocker();
+      if (debug_index != NULL)
+	debug_index->queue_scan_tasks(workqueue, this_blocker);
+      if (parameters->options().define_common())
+	workqueue->queue(new Allocate_commons_task(symtab, layout, mapfile,
+						   this_blocker));
     }
 
   // If doing garbage collection, the relocations have already been read.
@@ -870,12 +951,16 @@ queue_final_tasks(const General_options& options,
     }
   else
     {
+      // Postprocessing, such as compressing debug sections, can only
+      // start once FINAL_BLOCKER is released.  The task function will
+      // queue any parallel postprocessing tasks, followed by the
+      // Write_after_input_sections_task.
       Task_token* new_final_blocker = new Task_token(true);
       new_final_blocker->add_blocker();
-      Task* t = new Write_after_input_sections_task(layout, of,
-						    final_blocker,
-						    new_final_blocker);
-      workqueue->queue(t);
+      workqueue->queue(new Task_function(
+	  new Postprocessing_task_runner(layout, of, new_final_blocker),
+	  final_blocker,
+	  "Task_function Postprocessing_task_runner"));
       final_blocker = new_final_blocker;
     }
 
@@ -132,6 +132,19 @@
 //
 //
 //
+// Parallel Folding :
+// ----------------
+//
+// The sections of each object are read and checksummed by a task for
+// that object.  Each iteration then forms the groups serially, since a
+// section's checksum depends on the groups formed for the sections
+// before it.  While grouping, a section is assumed to be identical to
+// the kept section of the first group with the same checksum and
+// length.  The contents of these pairs are compared by parallel tasks
+// afterwards, and if any pair differs the iteration is redone comparing
+// contents as it goes.  The result is the same as comparing the contents
+// while grouping.
+//
 // How to run  : --icf=[safe|all|none]
 // Optional parameters : --icf-iterations <num> --print-icf-sections
 //
@@ -139,6 +152,9 @@
 // applications.  Up to 6 %  text size reductions.
 
 #include "gold.h"
+
+#include <algorithm>
+
 #include "object.h"
 #include "gc.h"
 #include "icf.h"
@@ -147,6 +163,7 @@
 #include "demangle.h"
 #include "elfcpp.h"
 #include "int_encoding.h"
+#include "workqueue.h"
 
 namespace gold
 {
@@ -155,52 +172,27 @@ namespace gold
 // sections has unique contents.  Such unique sections or groups can be
 // declared final and need not be processed any further.
 // Parameters :
-// ID_SECTION : Vector mapping a section index to a Section_id pair.
+// SECTION_CKSUMS : Checksum of each section.  Before the first
+//                  iteration this is computed on the section's text,
+//                  afterwards on the section's text and relocs to
+//                  sections that cannot be folded.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sections is already known to be unique.
-// SECTION_CONTENTS : Contains the section's text and relocs to sections
-//                    that cannot be folded.   SECTION_CONTENTS are NULL
-//                    implies that this function is being called for the
-//                    first time before the first iteration of icf.
 
 static void
-preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
-                               std::vector<bool>* is_secn_or_group_unique,
-                               std::vector<std::string>* section_contents)
+preprocess_for_unique_sections(const std::vector<uint32_t>& section_cksums,
+                               std::vector<bool>* is_secn_or_group_unique)
 {
   Unordered_map<uint32_t, unsigned int> uniq_map;
   std::pair<Unordered_map<uint32_t, unsigned int>::iterator, bool>
     uniq_map_insert;
 
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  for (unsigned int i = 0; i < section_cksums.size(); i++)
     {
       if ((*is_secn_or_group_unique)[i])
         continue;
 
-      uint32_t cksum;
-      Section_id secn = id_section[i];
-      section_size_type plen;
-      if (section_contents == NULL)
-        {
-          // Lock the object so we can read from it.  This is only called
-          // single-threaded from queue_middle_tasks, so it is OK to lock.
-          // Unfortunately we have no way to pass in a Task token.
-          const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-          Task_lock_obj<Object> tl(dummy_task, secn.first);
-          const unsigned char* contents;
-          contents = secn.first->section_contents(secn.second,
-                                                  &plen,
-                                                  false);
-          cksum = xcrc32(contents, plen, 0xffffffff);
-        }
-      else
-        {
-          const unsigned char* contents_array = reinterpret_cast
-            <const unsigned char*>((*section_contents)[i].c_str());
-          cksum = xcrc32(contents_array, (*section_contents)[i].length(),
-                         0xffffffff);
-        }
-      uniq_map_insert = uniq_map.insert(std::make_pair(cksum, i));
+      uniq_map_insert = uniq_map.insert(std::make_pair(section_cksums[i], i));
       if (uniq_map_insert.second)
         {
           (*is_secn_or_group_unique)[i] = true;
@@ -252,48 +244,70 @@ get_rel_addend(const unsigned char* reloc_addend_ptr,
     }
 }
 
-// This returns the buffer containing the section's contents, both
-// text and relocs.  Relocs are differentiated as those pointing to
-// sections that could be folded and those that cannot.  Only relocs
-// pointing to sections that could be folded are recomputed on
-// subsequent invocations of this function.
+// Look through function descriptors for the targets of the relocs in
+// RELOC_INFO.  This is done once for each section, before its
+// contents are first computed.
+
+static void
+get_function_locations(Icf::Reloc_info* reloc_info)
+{
+  Icf::Sections_reachable_info& v = reloc_info->section_info;
+  Icf::Addend_info& a = reloc_info->addend_info;
+  Icf::Sections_reachable_info::iterator it_v = v.begin();
+  Icf::Addend_info::iterator it_a = a.begin();
+
+  for (; it_v != v.end(); ++it_v, ++it_a)
+    {
+      if (it_v->first == NULL)
+        continue;
+
+      Symbol_location loc;
+      loc.object = it_v->first;
+      loc.shndx = it_v->second;
+      loc.offset = convert_types<off_t, long long>(it_a->first
+                                                   + it_a->second);
+      parameters->target().function_location(&loc);
+      if (loc.shndx != it_v->second)
+        {
+          it_v->second = loc.shndx;
+          // Modify symvalue/addend to the code entry.
+          it_a->first = loc.offset;
+          it_a->second = 0;
+        }
+    }
+}
+
+// This computes the part of the buffer holding the section's contents,
+// both text and relocs, that does not change between iterations.
+// Relocs are differentiated as those pointing to sections that could
+// be folded and those that cannot.  Relocs pointing to sections that
+// could be folded are only recorded here; their part of the buffer is
+// recomputed on each iteration by get_icf_reloc_contents.
 // Parameters  :
-// FIRST_ITERATION    : true if it is the first invocation.
 // SECN               : Section for which contents are desired.
-// SECTION_NUM        : Unique section number of this section.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
-// KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
+// OTHER_OBJECTS_OK   : Whether the contents of sections in objects
+//                      other than SECN's may be read.  If this is
+//                      false and they must be, this returns false.
 // SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
 //                      sections.
+// TRACKED_RELOCS     : Store the section's relocs to ICF sections.
 
-static std::string
-get_section_contents(bool first_iteration,
-                     const Section_id& secn,
-                     unsigned int section_num,
-                     unsigned int* num_tracked_relocs,
+static bool
+get_section_contents(const Section_id& secn,
+                     bool other_objects_ok,
                      Symbol_table* symtab,
-                     const std::vector<unsigned int>& kept_section_id,
-                     std::vector<std::string>* section_contents)
+                     std::string* section_contents,
+                     Icf::Tracked_relocs* tracked_relocs)
 {
-  // Lock the object so we can read from it.  This is only called
-  // single-threaded from queue_middle_tasks, so it is OK to lock.
-  // Unfortunately we have no way to pass in a Task token.
-  const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-  Task_lock_obj<Object> tl(dummy_task, secn.first);
-
   section_size_type plen;
-  const unsigned char* contents = NULL;
-  if (first_iteration)
-    contents = secn.first->section_contents(secn.second, &plen, false);
+  const unsigned char* contents;
+  contents = secn.first->section_contents(secn.second, &plen, false);
 
   // The buffer to hold all the contents including relocs.  A checksum
   // is then computed on this buffer.
   std::string buffer;
-  std::string icf_reloc_buffer;
 
-  if (num_tracked_relocs)
-    *num_tracked_relocs = 0;
+  tracked_relocs->clear();
 
   Icf::Reloc_info_list& reloc_info_list = 
     symtab->icf()->reloc_info_list();
@@ -301,51 +315,29 @@ get_section_contents(bool first_iteration,
   Icf::Reloc_info_list::iterator it_reloc_info_list =
     reloc_info_list.find(secn);
 
-  buffer.clear();
-  icf_reloc_buffer.clear();
-
   // Process relocs and put them into the buffer.
 
   if (it_reloc_info_list != reloc_info_list.end())
     {
-      Icf::Sections_reachable_info &v =
+      const Icf::Sections_reachable_info &v =
         (it_reloc_info_list->second).section_info;
       // Stores the information of the symbol pointed to by the reloc.
       const Icf::Symbol_info &s = (it_reloc_info_list->second).symbol_info;
       // Stores the addend and the symbol value.
-      Icf::Addend_info &a = (it_reloc_info_list->second).addend_info;
+      const Icf::Addend_info &a = (it_reloc_info_list->second).addend_info;
       // Stores the offset of the reloc.
       const Icf::Offset_info &o = (it_reloc_info_list->second).offset_info;
       const Icf::Reloc_addend_size_info &reloc_addend_size_info =
         (it_reloc_info_list->second).reloc_addend_size_info;
-      Icf::Sections_reachable_info::iterator it_v = v.begin();
+      Icf::Sections_reachable_info::const_iterator it_v = v.begin();
       Icf::Symbol_info::const_iterator it_s = s.begin();
-      Icf::Addend_info::iterator it_a = a.begin();
+      Icf::Addend_info::const_iterator it_a = a.begin();
       Icf::Offset_info::const_iterator it_o = o.begin();
       Icf::Reloc_addend_size_info::const_iterator it_addend_size =
         reloc_addend_size_info.begin();
 
       for (; it_v != v.end(); ++it_v, ++it_s, ++it_a, ++it_o, ++it_addend_size)
         {
-	  if (first_iteration
-	      && it_v->first != NULL)
-	    {
-	      Symbol_location loc;
-	      loc.object = it_v->first;
-	      loc.shndx = it_v->second;
-	      loc.offset = convert_types<off_t, long long>(it_a->first
-							   + it_a->second);
-	      // Look through function descriptors
-	      parameters->target().function_location(&loc);
-	      if (loc.shndx != it_v->second)
-		{
-		  it_v->second = loc.shndx;
-		  // Modify symvalue/addend to the code entry.
-		  it_a->first = loc.offset;
-		  it_a->second = 0;
-		}
-	    }
-
           // ADDEND_STR stores the symbol value and addend and offset,
           // each at most 16 hex digits long.  it_a points to a pair
           // where first is the symbol value and second is the
@@ -364,15 +356,12 @@ get_section_contents(bool first_iteration,
 	  // object is NULL.
 	  if (it_v->first == NULL)
             {
-	      if (first_iteration)
-                {
-		  // If the symbol name is available, use it.
-                  if ((*it_s) != NULL)
-                      buffer.append((*it_s)->name());
-                  // Append the addend.
-                  buffer.append(addend_str);
-                  buffer.append("@");
-		}
+              // If the symbol name is available, use it.
+              if ((*it_s) != NULL)
+                buffer.append((*it_s)->name());
+              // Append the addend.
+              buffer.append(addend_str);
+              buffer.append("@");
 	      continue;
 	    }
 
@@ -383,12 +372,9 @@ get_section_contents(bool first_iteration,
           if (reloc_secn.first == secn.first
               && reloc_secn.second == secn.second)
             {
-              if (first_iteration)
-                {
-                  buffer.append("R");
-                  buffer.append(addend_str);
-                  buffer.append("@");
-                }
+              buffer.append("R");
+              buffer.append(addend_str);
+              buffer.append("@");
               continue;
             }
           Icf::Uniq_secn_id_map& section_id_map =
@@ -403,36 +389,26 @@ get_section_contents(bool first_iteration,
               && section_id_map_it != section_id_map.end())
             {
               // This is a reloc to a section that might be folded.
-              if (num_tracked_relocs)
-                (*num_tracked_relocs)++;
-
-              char kept_section_str[10];
-              unsigned int secn_id = section_id_map_it->second;
-              snprintf(kept_section_str, sizeof(kept_section_str), "%u",
-                       kept_section_id[secn_id]);
-              if (first_iteration)
-                {
-                  buffer.append("ICF_R");
-                  buffer.append(addend_str);
-                }
-              icf_reloc_buffer.append(kept_section_str);
-              // Append the addend.
-              icf_reloc_buffer.append(addend_str);
-              icf_reloc_buffer.append("@");
+              Icf::Tracked_reloc tracked_reloc;
+              tracked_reloc.section_num = section_id_map_it->second;
+              tracked_reloc.addend = addend_str;
+              tracked_relocs->push_back(tracked_reloc);
+              buffer.append("ICF_R");
+              buffer.append(addend_str);
             }
           else
             {
               // This is a reloc to a section that cannot be folded.
-              // Process it only in the first iteration.
-              if (!first_iteration)
-                continue;
-
               uint64_t secn_flags = (it_v->first)->section_flags(it_v->second);
               // This reloc points to a merge section.  Hash the
               // contents of this section.
               if ((secn_flags & elfcpp::SHF_MERGE) != 0
 		  && parameters->target().can_icf_inline_merge_sections())
                 {
+                  // Another task may be reading the other object.
+                  if (!other_objects_ok && it_v->first != secn.first)
+                    return false;
+
                   uint64_t entsize =
                     (it_v->first)->section_entsize(it_v->second);
 		  long long offset = it_a->first;
@@ -541,28 +517,79 @@ get_section_contents(bool first_iteration,
         }
     }
 
-  if (first_iteration)
+  buffer.append("Contents = ");
+  buffer.append(reinterpret_cast<const char*>(contents), plen);
+  section_contents->swap(buffer);
+  return true;
+}
+
+// This computes the part of the buffer holding the section's contents
+// for its relocs to sections that could be folded.  This depends on
+// the groups of identical sections formed so far.
+// Parameters  :
+// TRACKED_RELOCS     : The section's relocs to ICF sections.
+// KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
+// ICF_RELOC_CONTENTS : Store the contents for the relocs.
+
+static void
+get_icf_reloc_contents(const Icf::Tracked_relocs& tracked_relocs,
+                       const std::vector<unsigned int>& kept_section_id,
+                       std::string* icf_reloc_contents)
+{
+  icf_reloc_contents->clear();
+  for (Icf::Tracked_relocs::const_iterator p = tracked_relocs.begin();
+       p != tracked_relocs.end();
+       ++p)
     {
-      buffer.append("Contents = ");
-      buffer.append(reinterpret_cast<const char*>(contents), plen);
-      // Store the section contents that don't change to avoid recomputing
-      // during the next call to this function.
-      (*section_contents)[section_num] = buffer;
+      char kept_section_str[10];
+      snprintf(kept_section_str, sizeof(kept_section_str), "%u",
+               kept_section_id[p->section_num]);
+      icf_reloc_contents->append(kept_section_str);
+      // Append the addend.
+      icf_reloc_contents->append(p->addend);
+      icf_reloc_contents->append("@");
     }
-  else
+}
+
+// Return whether the buffer made of A1 followed by A2 is the same as
+// the buffer made of B1 followed by B2.  Both buffers must have the
+// same length.
+
+static bool
+is_same_contents(const std::string& a1, const std::string& a2,
+                 const std::string& b1, const std::string& b2)
+{
+  const std::string* a[2] = { &a1, &a2 };
+  const std::string* b[2] = { &b1, &b2 };
+  unsigned int ai = 0;
+  unsigned int bi = 0;
+  size_t aoff = 0;
+  size_t boff = 0;
+  while (ai < 2 && bi < 2)
     {
-      gold_assert(buffer.empty());
-      // Reuse the contents computed in the previous iteration.
-      buffer.append((*section_contents)[section_num]);
+      if (aoff == a[ai]->length())
+        {
+          ++ai;
+          aoff = 0;
+          continue;
+        }
+      if (boff == b[bi]->length())
+        {
+          ++bi;
+          boff = 0;
+          continue;
+        }
+      size_t len = std::min(a[ai]->length() - aoff, b[bi]->length() - boff);
+      if (memcmp(a[ai]->data() + aoff, b[bi]->data() + boff, len) != 0)
+        return false;
+      aoff += len;
+      boff += len;
     }
-
-  buffer.append(icf_reloc_buffer);
-  return buffer;
+  return true;
 }
 
-// This function computes a checksum on each section to detect and form
-// groups of identical sections.  The first iteration does this for all 
-// sections.
+// This function forms groups of identical sections using a checksum
+// of each section.  The first iteration does this for all sections.
 // Further iterations do this only for the kept sections from each group to
 // determine if larger groups of identical sections could be formed.  The
 // first section in each group is the kept section for that group.
@@ -570,155 +597,96 @@ get_section_contents(bool first_iteration,
 // CRC32 is the checksumming algorithm and can have collisions.  That is,
 // two sections with different contents can have the same checksum. Hence,
 // a multimap is used to maintain more than one group of checksum
-// identical sections.  A section is added to a group only after its
-// contents are explicitly compared with the kept section of the group.
+// identical sections.  If COMPARE_CONTENTS is true, a section is added to
+// a group only after its contents are explicitly compared with the kept
+// section of the group.  Otherwise the section is added to the first group
+// with the same checksum and length, and the pair is recorded in
+// MATCHED_SECTIONS_ so that the contents can be compared in parallel
+// afterwards.  If all such pairs turn out to be identical, the groups are
+// the same as if the contents had been compared here.
 //
-// Parameters  :
-// ITERATION_NUM           : Invocation instance of this function.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
-// KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
-// ID_SECTION         : Vector mapping a section to an unique integer.
-// IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
-//                            sections is already known to be unique.
-// SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
-//                      sections.
+// The checksum of a section's buffer is computed by continuing the
+// checksum of the part that does not change between iterations, which
+// was computed when that part was read.
 
-static bool
-match_sections(unsigned int iteration_num,
-               Symbol_table* symtab,
-               std::vector<unsigned int>* num_tracked_relocs,
-               std::vector<unsigned int>* kept_section_id,
-               const std::vector<Section_id>& id_section,
-	       const std::vector<uint64_t>& section_addraligns,
-               std::vector<bool>* is_secn_or_group_unique,
-               std::vector<std::string>* section_contents)
+bool
+Icf::group_sections(bool compare_contents)
 {
   Unordered_multimap<uint32_t, unsigned int> section_cksum;
   std::pair<Unordered_multimap<uint32_t, unsigned int>::iterator,
             Unordered_multimap<uint32_t, unsigned int>::iterator> key_range;
   bool converged = true;
 
-  if (iteration_num == 1)
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   NULL);
-  else
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   section_contents);
-
-  std::vector<std::string> full_section_contents;
+  this->matched_sections_.clear();
 
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  for (unsigned int i = 0; i < this->id_section_.size(); i++)
     {
-      full_section_contents.push_back("");
-      if ((*is_secn_or_group_unique)[i])
+      if (this->is_secn_or_group_unique_[i])
         continue;
 
-      Section_id secn = id_section[i];
-      std::string this_secn_contents;
-      uint32_t cksum;
-      if (iteration_num == 1)
+      if (this->num_iterations_ > 1 && this->kept_section_id_[i] != i)
         {
-          unsigned int num_relocs = 0;
-          this_secn_contents = get_section_contents(true, secn, i, &num_relocs,
-                                                    symtab, (*kept_section_id),
-                                                    section_contents);
-          (*num_tracked_relocs)[i] = num_relocs;
+          // This section is already folded into something.
+          continue;
         }
-      else
-        {
-          if ((*kept_section_id)[i] != i)
-            {
-              // This section is already folded into something.
-              continue;
-            }
-          this_secn_contents = get_section_contents(false, secn, i, NULL,
-                                                    symtab, (*kept_section_id),
-                                                    section_contents);
-        }
-
-      const unsigned char* this_secn_contents_array =
-            reinterpret_cast<const unsigned char*>(this_secn_contents.c_str());
-      cksum = xcrc32(this_secn_contents_array, this_secn_contents.length(),
-                     0xffffffff);
-      size_t count = section_cksum.count(cksum);
 
-      if (count == 0)
-        {
-          // Start a group with this cksum.
-          section_cksum.insert(std::make_pair(cksum, i));
-          full_section_contents[i] = this_secn_contents;
-        }
-      else
+      std::string* icf_reloc_contents = &this->icf_reloc_contents_[i];
+      get_icf_reloc_contents(this->tracked_relocs_[i],
+                             this->kept_section_id_, icf_reloc_contents);
+      const unsigned char* icf_reloc_contents_array =
+        reinterpret_cast<const unsigned char*>(icf_reloc_contents->c_str());
+      uint32_t cksum = xcrc32(icf_reloc_contents_array,
+                              icf_reloc_contents->length(),
+                              this->section_cksums_[i]);
+      size_t length = (this->section_contents_[i].length()
+                       + icf_reloc_contents->length());
+
+      key_range = section_cksum.equal_range(cksum);
+      Unordered_multimap<uint32_t, unsigned int>::iterator it;
+      // Search all the groups with this cksum for a match.
+      for (it = key_range.first; it != key_range.second; ++it)
         {
-          key_range = section_cksum.equal_range(cksum);
-          Unordered_multimap<uint32_t, unsigned int>::iterator it;
-          // Search all the groups with this cksum for a match.
-          for (it = key_range.first; it != key_range.second; ++it)
+          unsigned int kept_section = it->second;
+          if (this->section_contents_[kept_section].length()
+              + this->icf_reloc_contents_[kept_section].length() != length)
+            continue;
+          if (!compare_contents)
+            this->matched_sections_.push_back(std::make_pair(i,
+                                                             kept_section));
+          else if (!is_same_contents(this->section_contents_[i],
+                                     *icf_reloc_contents,
+                                     this->section_contents_[kept_section],
+                                     this->icf_reloc_contents_[kept_section]))
+            continue;
+
+          // Check section alignment here.
+          // The section with the larger alignment requirement
+          // should be kept.  We assume alignment can only be 
+          // zero or positive integral powers of two.
+          uint64_t align_i = this->section_addraligns_[i];
+          uint64_t align_kept = this->section_addraligns_[kept_section];
+          if (align_i <= align_kept)
             {
-              unsigned int kept_section = it->second;
-              if (full_section_contents[kept_section].length()
-                  != this_secn_contents.length())
-                  continue;
-              if (memcmp(full_section_contents[kept_section].c_str(),
-                         this_secn_contents.c_str(),
-                         this_secn_contents.length()) != 0)
-                  continue;
-
-	      // Check section alignment here.
-	      // The section with the larger alignment requirement
-	      // should be kept.  We assume alignment can only be 
-	      // zero or positive integral powers of two.
-	      uint64_t align_i = section_addraligns[i];
-	      uint64_t align_kept = section_addraligns[kept_section];
-	      if (align_i <= align_kept)
-		{
-		  (*kept_section_id)[i] = kept_section;
-		}
-	      else
-		{
-		  (*kept_section_id)[kept_section] = i;
-		  it->second = i;
-		  full_section_contents[kept_section].swap(
-		      full_section_contents[i]);
-		}
-
-              converged = false;
-              break;
+              this->kept_section_id_[i] = kept_section;
             }
-          if (it == key_range.second)
+          else
             {
-              // Create a new group for this cksum.
-              section_cksum.insert(std::make_pair(cksum, i));
-              full_section_contents[i] = this_secn_contents;
+              this->kept_section_id_[kept_section] = i;
+              it->second = i;
             }
-        }
-      // If there are no relocs to foldable sections do not process
-      // this section any further.
-      if (iteration_num == 1 && (*num_tracked_relocs)[i] == 0)
-        (*is_secn_or_group_unique)[i] = true;
-    }
 
-  // If a section was folded into another section that was later folded
-  // again then the former has to be updated.
-  for (unsigned int i = 0; i < id_section.size(); i++)
-    {
-      // Find the end of the folding chain
-      unsigned int kept = i;
-      while ((*kept_section_id)[kept] != kept)
-        {
-          kept = (*kept_section_id)[kept];
+          converged = false;
+          break;
         }
-      // Update every element of the chain
-      unsigned int current = i;
-      while ((*kept_section_id)[current] != kept)
+      if (it == key_range.second)
         {
-          unsigned int next = (*kept_section_id)[current];
-          (*kept_section_id)[current] = kept;
-          current = next;
+          // Create a new group for this cksum.
+          section_cksum.insert(std::make_pair(cksum, i));
         }
+      // If there are no relocs to foldable sections do not process
+      // this section any further.
+      if (this->num_iterations_ == 1 && this->tracked_relocs_[i].empty())
+        this->is_secn_or_group_unique_[i] = true;
     }
 
   return converged;
@@ -742,32 +710,201 @@ is_function_ctor_or_dtor(const std::string& section_name)
   return false;
 }
 
+// This task reads the foldable sections of one object.  Depending on
+// CONTENTS it either computes a checksum of the sections' text, or
+// computes the part of their buffers that does not change between
+// iterations.
+
+class Icf_read_sections : public Task
+{
+ public:
+  Icf_read_sections(Icf* icf, Relobj* object, unsigned int begin,
+                    unsigned int end, bool contents,
+                    Task_token* next_blocker)
+    : icf_(icf), object_(object), begin_(begin), end_(end),
+      contents_(contents), next_blocker_(next_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return this->object_->is_locked() ? this->object_->token() : NULL; }
+
+  void
+  locks(Task_locker* tl)
+  {
+    tl->add(this, this->object_->token());
+    tl->add(this, this->next_blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    if (this->contents_)
+      this->icf_->read_section_contents(this->begin_, this->end_);
+    else
+      this->icf_->checksum_sections(this->begin_, this->end_);
+    this->object_->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Icf_read_sections " + this->object_->name(); }
+
+ private:
+  Icf* icf_;
+  Relobj* object_;
+  unsigned int begin_;
+  unsigned int end_;
+  bool contents_;
+  Task_token* next_blocker_;
+};
+
+// This task compares the contents of some of the pairs of sections
+// that were assumed to be identical while forming the groups.
+
+class Icf_compare_sections : public Task
+{
+ public:
+  Icf_compare_sections(Icf* icf, size_t begin, size_t end,
+                       Task_token* next_blocker)
+    : icf_(icf), begin_(begin), end_(end), next_blocker_(next_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->icf_->compare_matched_sections(this->begin_, this->end_); }
+
+  std::string
+  get_name() const
+  { return "Icf_compare_sections"; }
+
+ private:
+  Icf* icf_;
+  size_t begin_;
+  size_t end_;
+  Task_token* next_blocker_;
+};
+
+// This task runs one of the serial steps of forming the groups of
+// identical sections, once the tasks it depends on are done.  The
+// FINISH step unblocks DONE_BLOCKER.
+
+class Icf_match_sections : public Task
+{
+ public:
+  enum Step
+  {
+    // Find the sections whose text is unique.
+    START_FIRST_ITERATION,
+    // Form the groups for the first iteration.
+    START_ITERATION,
+    // Check the groups and update the kept sections.
+    FINISH_ITERATION,
+    // Handle --keep-unique.
+    FINISH
+  };
+
+  Icf_match_sections(Icf* icf, Step step, Task_token* this_blocker,
+                     Task_token* done_blocker)
+    : icf_(icf), step_(step), this_blocker_(this_blocker),
+      done_blocker_(done_blocker)
+  { }
+
+  ~Icf_match_sections()
+  {
+    if (this->this_blocker_ != NULL)
+      delete this->this_blocker_;
+  }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    if (this->step_ == FINISH)
+      tl->add(this, this->done_blocker_);
+  }
+
+  void
+  run(Workqueue* workqueue)
+  {
+    switch (this->step_)
+      {
+      case START_FIRST_ITERATION:
+        this->icf_->start_first_iteration(workqueue, this->done_blocker_);
+        break;
+      case START_ITERATION:
+        this->icf_->start_iteration(workqueue, this, this->done_blocker_);
+        break;
+      case FINISH_ITERATION:
+        this->icf_->finish_iteration(workqueue, this, this->done_blocker_);
+        break;
+      case FINISH:
+        this->icf_->finish_identical_sections();
+        break;
+      default:
+        gold_unreachable();
+      }
+  }
+
+  std::string
+  get_name() const
+  { return "Icf_match_sections"; }
+
+ private:
+  Icf* icf_;
+  Step step_;
+  Task_token* this_blocker_;
+  Task_token* done_blocker_;
+};
+
 // This is the main ICF function called in gold.cc.  This does the
-// initialization and calls match_sections repeatedly (twice by default)
-// which computes the crc checksums and detects identical functions.
+// initialization and queues the tasks which compute the crc checksums
+// and detect identical functions.  The sections are read by a task
+// for each object.  Each iteration then forms the groups serially, and
+// verifies them in parallel.  The iterations run until convergence, or
+// twice by default.
 
 void
-Icf::find_identical_sections(const Input_objects* input_objects,
-                             Symbol_table* symtab)
+Icf::queue_find_identical_sections(const Input_objects* input_objects,
+                                   Symbol_table* symtab,
+                                   Workqueue* workqueue,
+                                   const Task* task,
+                                   Task_token* done_blocker)
 {
   unsigned int section_num = 0;
-  std::vector<unsigned int> num_tracked_relocs;
-  std::vector<uint64_t> section_addraligns;
-  std::vector<bool> is_secn_or_group_unique;
-  std::vector<std::string> section_contents;
   const Target& target = parameters->target();
 
+  this->symtab_ = symtab;
+
   // Decide which sections are possible candidates first.
 
   for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
        p != input_objects->relobj_end();
        ++p)
     {
-      // Lock the object so we can read from it.  This is only called
-      // single-threaded from queue_middle_tasks, so it is OK to lock.
-      // Unfortunately we have no way to pass in a Task token.
-      const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-      Task_lock_obj<Object> tl(dummy_task, *p);
+      // Lock the object so we can read from it.
+      Task_lock_obj<Object> tl(task, *p);
 
       for (unsigned int i = 0;i < (*p)->shnum(); ++i)
         {
@@ -792,40 +929,281 @@ Icf::find_identical_sections(const Input_objects* input_objects,
           this->id_section_.push_back(Section_id(*p, i));
           this->section_id_[Section_id(*p, i)] = section_num;
           this->kept_section_id_.push_back(section_num);
-          num_tracked_relocs.push_back(0);
-	  section_addraligns.push_back((*p)->section_addralign(i));
-          is_secn_or_group_unique.push_back(false);
-          section_contents.push_back("");
+	  this->section_addraligns_.push_back((*p)->section_addralign(i));
+          this->is_secn_or_group_unique_.push_back(false);
           section_num++;
         }
     }
 
-  unsigned int num_iterations = 0;
+  this->section_cksums_.resize(section_num);
+  this->section_contents_.resize(section_num);
+  this->tracked_relocs_.resize(section_num);
+  this->needs_serial_contents_.resize(section_num);
+  this->icf_reloc_contents_.resize(section_num);
 
   // Default number of iterations to run ICF is 2.
-  unsigned int max_iterations = (parameters->options().icf_iterations() > 0)
-                            ? parameters->options().icf_iterations()
-                            : 2;
+  this->max_iterations_ = ((parameters->options().icf_iterations() > 0)
+                           ? parameters->options().icf_iterations()
+                           : 2);
+
+  Task_token* blocker = this->queue_read_sections(workqueue, false);
+  Icf_match_sections::Step step = Icf_match_sections::START_FIRST_ITERATION;
+  workqueue->queue(new Icf_match_sections(this, step, blocker,
+                                          done_blocker));
+}
+
+// Queue an Icf_read_sections task for each object which has sections
+// that are not yet known to be unique.
+
+Task_token*
+Icf::queue_read_sections(Workqueue* workqueue, bool contents)
+{
+  // The sections of each object are numbered consecutively.
+  std::vector<unsigned int> starts;
+  unsigned int count = this->id_section_.size();
+  unsigned int begin = 0;
+  while (begin < count)
+    {
+      Relobj* object = this->id_section_[begin].first;
+      unsigned int end = begin;
+      bool any = false;
+      for (; end < count && this->id_section_[end].first == object; ++end)
+        if (!this->is_secn_or_group_unique_[end])
+          any = true;
+      if (any)
+        starts.push_back(begin);
+      begin = end;
+    }
+
+  Task_token* blocker = new Task_token(true);
+  if (!starts.empty())
+    blocker->add_blockers(starts.size());
+  for (std::vector<unsigned int>::const_iterator p = starts.begin();
+       p != starts.end();
+       ++p)
+    {
+      Relobj* object = this->id_section_[*p].first;
+      unsigned int end = *p;
+      while (end < count && this->id_section_[end].first == object)
+        ++end;
+      workqueue->queue(new Icf_read_sections(this, object, *p, end, contents,
+                                             blocker));
+    }
+  return blocker;
+}
+
+// Compute a checksum of the text of each section.  These are used to
+// find the sections whose text is unique, which need not be processed
+// any further.
+
+void
+Icf::checksum_sections(unsigned int begin, unsigned int end)
+{
+  for (unsigned int i = begin; i < end; ++i)
+    {
+      Section_id secn = this->id_section_[i];
+      section_size_type plen;
+      const unsigned char* contents;
+      contents = secn.first->section_contents(secn.second, &plen, false);
+      this->section_cksums_[i] = xcrc32(contents, plen, 0xffffffff);
+    }
+}
 
-  bool converged = false;
+// Compute the part of the buffer of each section that does not change
+// between iterations, and its checksum.  The checksum replaces the one
+// computed by checksum_sections.  Sections which refer to merge
+// sections in other objects are left to start_iteration, since
+// another task may be reading those objects.
 
-  while (!converged && (num_iterations < max_iterations))
+void
+Icf::read_section_contents(unsigned int begin, unsigned int end)
+{
+  for (unsigned int i = begin; i < end; ++i)
     {
-      num_iterations++;
-      converged = match_sections(num_iterations, symtab,
-                                 &num_tracked_relocs, &this->kept_section_id_,
-                                 this->id_section_, section_addraligns,
-                                 &is_secn_or_group_unique, &section_contents);
+      if (this->is_secn_or_group_unique_[i])
+        continue;
+
+      Section_id secn = this->id_section_[i];
+      Reloc_info_list::iterator p = this->reloc_info_list_.find(secn);
+      if (p != this->reloc_info_list_.end())
+        get_function_locations(&p->second);
+
+      if (!get_section_contents(secn, false, this->symtab_,
+                                &this->section_contents_[i],
+                                &this->tracked_relocs_[i]))
+        {
+          this->needs_serial_contents_[i] = 1;
+          continue;
+        }
+      const std::string& contents(this->section_contents_[i]);
+      this->section_cksums_[i] =
+        xcrc32(reinterpret_cast<const unsigned char*>(contents.c_str()),
+               contents.length(), 0xffffffff);
     }
+}
 
+// Sections whose text is unique cannot be folded.  Read the rest of
+// the sections.
+
+void
+Icf::start_first_iteration(Workqueue* workqueue, Task_token* done_blocker)
+{
+  preprocess_for_unique_sections(this->section_cksums_,
+                                 &this->is_secn_or_group_unique_);
+
+  Task_token* blocker = this->queue_read_sections(workqueue, true);
+  workqueue->queue(new Icf_match_sections(this,
+                                          Icf_match_sections::START_ITERATION,
+                                          blocker, done_blocker));
+}
+
+// Form the groups of an iteration, and queue tasks to compare the
+// sections assumed to be identical.  The tasks are split so that each
+// compares a similar number of bytes.
+
+void
+Icf::start_iteration(Workqueue* workqueue, const Task* task,
+                     Task_token* done_blocker)
+{
+  this->num_iterations_++;
+
+  if (this->num_iterations_ == 1)
+    {
+      for (unsigned int i = 0; i < this->id_section_.size(); ++i)
+        {
+          if (!this->needs_serial_contents_[i])
+            continue;
+
+          Section_id secn = this->id_section_[i];
+          Task_lock_obj<Object> tl(task, secn.first);
+          bool ok = get_section_contents(secn, true, this->symtab_,
+                                         &this->section_contents_[i],
+                                         &this->tracked_relocs_[i]);
+          gold_assert(ok);
+          const std::string& contents(this->section_contents_[i]);
+          this->section_cksums_[i] =
+            xcrc32(reinterpret_cast<const unsigned char*>(contents.c_str()),
+                   contents.length(), 0xffffffff);
+        }
+      this->needs_serial_contents_.clear();
+    }
+  else
+    preprocess_for_unique_sections(this->section_cksums_,
+                                   &this->is_secn_or_group_unique_);
+
+  this->saved_kept_section_id_ = this->kept_section_id_;
+  this->saved_is_secn_or_group_unique_ = this->is_secn_or_group_unique_;
+  this->converged_ = this->group_sections(false);
+
+  const size_t compare_task_size = 1024 * 1024;
+  std::vector<size_t> starts;
+  size_t size = 0;
+  for (size_t k = 0; k < this->matched_sections_.size(); ++k)
+    {
+      if (size == 0)
+        starts.push_back(k);
+      unsigned int i = this->matched_sections_[k].first;
+      size += (this->section_contents_[i].length()
+               + this->icf_reloc_contents_[i].length() + 1);
+      if (size >= compare_task_size)
+        size = 0;
+    }
+
+  this->match_verified_.assign(this->matched_sections_.size(), 0);
+
+  Task_token* blocker = new Task_token(true);
+  if (!starts.empty())
+    blocker->add_blockers(starts.size());
+  for (size_t t = 0; t < starts.size(); ++t)
+    {
+      size_t end = (t + 1 < starts.size()
+                    ? starts[t + 1]
+                    : this->matched_sections_.size());
+      workqueue->queue(new Icf_compare_sections(this, starts[t], end,
+                                                blocker));
+    }
+  workqueue->queue(new Icf_match_sections(this,
+                                          Icf_match_sections::FINISH_ITERATION,
+                                          blocker, done_blocker));
+}
+
+// Compare the pairs of sections assumed to be identical.
+
+void
+Icf::compare_matched_sections(size_t begin, size_t end)
+{
+  for (size_t k = begin; k < end; ++k)
+    {
+      unsigned int i = this->matched_sections_[k].first;
+      unsigned int kept_section = this->matched_sections_[k].second;
+      if (is_same_contents(this->section_contents_[i],
+                           this->icf_reloc_contents_[i],
+                           this->section_contents_[kept_section],
+                           this->icf_reloc_contents_[kept_section]))
+        this->match_verified_[k] = 1;
+    }
+}
+
+// If any pair of sections assumed to be identical was not, redo the
+// iteration comparing the contents as the groups are formed.  This is
+// only needed when checksums collide.  Then start the next iteration,
+// unless done.
+
+void
+Icf::finish_iteration(Workqueue* workqueue, const Task* task,
+                      Task_token* done_blocker)
+{
+  if (std::find(this->match_verified_.begin(), this->match_verified_.end(),
+                0) != this->match_verified_.end())
+    {
+      this->kept_section_id_.swap(this->saved_kept_section_id_);
+      this->is_secn_or_group_unique_.swap(
+          this->saved_is_secn_or_group_unique_);
+      this->converged_ = this->group_sections(true);
+    }
+
+  // If a section was folded into another section that was later folded
+  // again then the former has to be updated.
+  std::vector<unsigned int>& kept_section_id(this->kept_section_id_);
+  for (unsigned int i = 0; i < kept_section_id.size(); i++)
+    {
+      // Find the end of the folding chain
+      unsigned int kept = i;
+      while (kept_section_id[kept] != kept)
+        {
+          kept = kept_section_id[kept];
+        }
+      // Update every element of the chain
+      unsigned int current = i;
+      while (kept_section_id[current] != kept)
+        {
+          unsigned int next = kept_section_id[current];
+          kept_section_id[current] = kept;
+          current = next;
+        }
+    }
+
+  if (!this->converged_ && this->num_iterations_ < this->max_iterations_)
+    this->start_iteration(workqueue, task, done_blocker);
+  else
+    workqueue->queue(new Icf_match_sections(this, Icf_match_sections::FINISH,
+                                            NULL, done_blocker));
+}
+
+// Handle --keep-unique once the groups are formed, and release the
+// state used to form them.
+
+void
+Icf::finish_identical_sections()
+{
   if (parameters->options().print_icf_sections())
     {
-      if (converged)
+      if (this->converged_)
         gold_info(_("%s: ICF Converged after %u iteration(s)"),
-                  program_name, num_iterations);
+                  program_name, this->num_iterations_);
       else
         gold_info(_("%s: ICF stopped after %u iteration(s)"),
-                  program_name, num_iterations);
+                  program_name, this->num_iterations_);
     }
 
   // Unfold --keep-unique symbols.
@@ -835,7 +1213,7 @@ Icf::find_identical_sections(const Input_objects* input_objects,
        ++p)
     {
       const char* name = p->c_str();
-      Symbol* sym = symtab->lookup(name);
+      Symbol* sym = this->symtab_->lookup(name);
       if (sym == NULL)
 	{
 	  gold_warning(_("Could not find symbol %s to unfold\n"), name);
@@ -854,6 +1232,17 @@ Icf::find_identical_sections(const Input_objects* input_objects,
 
     }
 
+  this->section_addraligns_.clear();
+  this->is_secn_or_group_unique_.clear();
+  this->section_cksums_.clear();
+  this->section_contents_.clear();
+  this->tracked_relocs_.clear();
+  this->icf_reloc_contents_.clear();
+  this->matched_sections_.clear();
+  this->match_verified_.clear();
+  this->saved_kept_section_id_.clear();
+  this->saved_is_secn_or_group_unique_.clear();
+
   this->icf_ready();
 }
 
@@ -35,6 +35,9 @@ namespace gold
 class Object;
 class Input_objects;
 class Symbol_table;
+class Task;
+class Task_token;
+class Workqueue;
 
 class Icf
 {
@@ -64,11 +67,28 @@ class Icf
   typedef Unordered_map<Section_id, Reloc_info,
                         Section_id_hash> Reloc_info_list;
 
+  // A reloc to a section which might be folded.  Only these relocs
+  // are recomputed on the iterations after the first one.
+  struct Tracked_reloc
+  {
+    // The unique number of the section the reloc points to.
+    unsigned int section_num;
+    // The symbol value, addend and offset of the reloc as text.
+    std::string addend;
+  };
+
+  typedef std::vector<Tracked_reloc> Tracked_relocs;
+
   Icf()
   : id_section_(), section_id_(), kept_section_id_(),
     fptr_section_id_(),
     icf_ready_(false),
-    reloc_info_list_()
+    reloc_info_list_(), symtab_(NULL), section_addraligns_(),
+    is_secn_or_group_unique_(), section_cksums_(), section_contents_(),
+    tracked_relocs_(), needs_serial_contents_(), icf_reloc_contents_(),
+    matched_sections_(), match_verified_(), saved_kept_section_id_(),
+    saved_is_secn_or_group_unique_(), num_iterations_(0),
+    max_iterations_(0), converged_(false)
   { }
 
   // Returns the kept folded identical section corresponding to
@@ -76,11 +96,57 @@ class Icf
   Section_id
   get_folded_section(Relobj* dup_obj, unsigned int dup_shndx);
 
-  // Forms groups of identical sections where the first member
-  // of each group is the kept section during folding.
+  // Queues the tasks which form groups of identical sections where
+  // the first member of each group is the kept section during
+  // folding.  TASK is the task doing the queueing.  DONE_BLOCKER is
+  // unblocked when the groups have been formed.
+  void
+  queue_find_identical_sections(const Input_objects* input_objects,
+                                Symbol_table* symtab,
+                                Workqueue* workqueue,
+                                const Task* task,
+                                Task_token* done_blocker);
+
+  // The steps below are run by the tasks queued by
+  // queue_find_identical_sections.
+
+  // Compute the checksum of the contents of the sections numbered
+  // BEGIN to END, which all belong to one object.
+  void
+  checksum_sections(unsigned int begin, unsigned int end);
+
+  // Compute the part of the checksummed buffer that does not change
+  // between iterations for the sections numbered BEGIN to END, which
+  // all belong to one object.
+  void
+  read_section_contents(unsigned int begin, unsigned int end);
+
+  // Verify the matches numbered BEGIN to END found by the last
+  // grouping pass.
+  void
+  compare_matched_sections(size_t begin, size_t end);
+
+  // Find the sections whose contents are unique after the contents
+  // checksums are known, and queue the tasks which read the rest of
+  // the contents.
   void
-  find_identical_sections(const Input_objects* input_objects,
-                          Symbol_table* symtab);
+  start_first_iteration(Workqueue* workqueue, Task_token* done_blocker);
+
+  // Group the sections for the next iteration, and queue the tasks
+  // which verify the groups.  TASK is the task running this.
+  void
+  start_iteration(Workqueue* workqueue, const Task* task,
+                  Task_token* done_blocker);
+
+  // Finish an iteration once its groups are verified, and either start
+  // another one or queue the final step.
+  void
+  finish_iteration(Workqueue* workqueue, const Task* task,
+                   Task_token* done_blocker);
+
+  // Handle --keep-unique and mark ICF as ready.
+  void
+  finish_identical_sections();
 
   // This is set when ICF has been run and the groups of
   // identical sections have been formed.
@@ -160,6 +226,59 @@ class Icf
   bool icf_ready_;
   // This list is populated by gc_process_relocs in gc.h.
   Reloc_info_list reloc_info_list_;
+
+  // Queue a task for each object to read its foldable sections.  If
+  // CONTENTS is false the tasks call checksum_sections, otherwise
+  // read_section_contents.  Returns a blocker for the tasks.
+  Task_token*
+  queue_read_sections(Workqueue* workqueue, bool contents);
+
+  // Form groups of sections with identical contents for this
+  // iteration.  If COMPARE_CONTENTS is false, a section is assumed to
+  // match the first group with the same checksum and length, and the
+  // match is recorded to be verified later.  Returns true if no
+  // section was folded.
+  bool
+  group_sections(bool compare_contents);
+
+  // The state below is only used while the groups of identical
+  // sections are being formed.
+
+  // The symbol table.
+  Symbol_table* symtab_;
+  // Gives the alignment of each section.
+  std::vector<uint64_t> section_addraligns_;
+  // Whether a section, or the group it is kept for, is known to have
+  // unique contents.
+  std::vector<bool> is_secn_or_group_unique_;
+  // A checksum of the section contents, and after the first
+  // iteration of SECTION_CONTENTS_.
+  std::vector<uint32_t> section_cksums_;
+  // The section's text and relocs to non-ICF sections.
+  std::vector<std::string> section_contents_;
+  // The section's relocs to ICF sections.
+  std::vector<Tracked_relocs> tracked_relocs_;
+  // Set for sections whose contents could not be read in parallel
+  // because they refer to merge sections in other objects.
+  std::vector<unsigned char> needs_serial_contents_;
+  // The section's relocs to ICF sections as of this iteration.
+  std::vector<std::string> icf_reloc_contents_;
+  // The sections assumed identical by this iteration, paired with the
+  // kept section of their group.
+  std::vector<std::pair<unsigned int, unsigned int> > matched_sections_;
+  // Set if the sections in the corresponding MATCHED_SECTIONS_ entry
+  // were verified to be identical.
+  std::vector<unsigned char> match_verified_;
+  // The group state before this iteration, to redo the iteration if a
+  // match does not verify.
+  std::vector<unsigned int> saved_kept_section_id_;
+  std::vector<bool> saved_is_secn_or_group_unique_;
+  // The number of iterations started.
+  unsigned int num_iterations_;
+  // The maximum number of iterations to run.
+  unsigned int max_iterations_;
+  // Whether the last iteration folded nothing.
+  bool converged_;
 };
 
 // This function returns true if this section corresponds to a function that
@@ -2056,10 +2056,11 @@ Sized_relobj_incr<size, big_endian>::do_layout(
       out_sections[i] = os;
       this->section_offsets()[i] = static_cast<Address>(sect.sh_offset);
 
-      // When generating a .gdb_index section, we do additional
-      // processing of .debug_info and .debug_types sections after all
-      // the other sections.
-      if (parameters->options().gdb_index())
+      // When generating a .gdb_index or .debug_names section, we do
+      // additional processing of .debug_info and .debug_types sections
+      // after all the other sections.
+      if (parameters->options().gdb_index()
+	  || parameters->options().debug_names())
 	{
 	  const char* name = os->name();
 	  if (strcmp(name, ".debug_info") == 0)
@@ -2085,15 +2086,15 @@ Sized_relobj_incr<size, big_endian>::do_layout(
 		    signature);
     }
 
-  // When building a .gdb_index section, scan the .debug_info and
-  // .debug_types sections.
+  // When building a .gdb_index or .debug_names section, scan the
+  // .debug_info and .debug_types sections.
   for (std::vector<unsigned int>::const_iterator p
 	   = debug_info_sections.begin();
        p != debug_info_sections.end();
        ++p)
     {
       unsigned int i = *p;
-      layout->add_to_gdb_index(false, this, NULL, 0, i, 0, 0);
+      layout->add_to_debug_index(false, this, 0, i, 0, 0);
     }
   for (std::vector<unsigned int>::const_iterator p
 	   = debug_types_sections.begin();
@@ -2101,7 +2102,7 @@ Sized_relobj_incr<size, big_endian>::do_layout(
        ++p)
     {
       unsigned int i = *p;
-      layout->add_to_gdb_index(true, this, 0, 0, i, 0, 0);
+      layout->add_to_debug_index(true, this, 0, i, 0, 0);
     }
 }
 
@@ -2191,7 +2192,7 @@ Sized_relobj_incr<size, big_endian>::do_add_symbols(
       osym.put_st_other(gsym.get_st_other());
       osym.put_st_shndx(shndx);
 
-      Symbol* res = symtab->add_from_incrobj(this, name, NULL, &sym);
+      Symbol* res = symtab->add_from_incrobj(this, name, NULL, &sym, i);
 
       if (shndx != elfcpp::SHN_UNDEF)
 	++this->defined_count_;
@@ -2791,7 +2792,8 @@ Sized_incr_dynobj<size, big_endian>::do_add_symbols(
       osym.put_st_shndx(shndx);
 
       Sized_symbol<size>* res =
-	  symtab->add_from_incrobj<size, big_endian>(this, name, NULL, &sym);
+	  symtab->add_from_incrobj<size, big_endian>(this, name, NULL,
+						     &sym, i);
       this->symbols_[i] = res;
       this->ibase_->add_global_symbol(output_symndx - first_global,
 				      this->symbols_[i]);
@@ -447,7 +447,7 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     eh_frame_data_(NULL),
     added_eh_frame_data_(false),
     eh_frame_hdr_section_(NULL),
-    gdb_index_data_(NULL),
+    debug_index_(NULL),
     build_id_note_(NULL),
     debug_abbrev_(NULL),
     debug_info_(NULL),
@@ -733,6 +733,15 @@ Layout::include_section(Sized_relobj_file<size, big_endian>*, const char* name,
 	      && is_gdb_fast_lookup_section(name + 8))
 	    return false;
 	}
+      if (parameters->options().debug_names()
+	  && (shdr.get_sh_flags() & elfcpp::SHF_ALLOC) == 0)
+	{
+	  // When building .debug_names, we replace the name indexes of
+	  // the input objects, which describe only their own CUs.
+	  if (strcmp(name, ".debug_names") == 0
+	      || strcmp(name, ".zdebug_names") == 0)
+	    return false;
+	}
       if (parameters->options().strip_lto_sections()
 	  && !parameters->options().relocatable()
 	  && (shdr.get_sh_flags() & elfcpp::SHF_ALLOC) == 0)
@@ -1094,6 +1103,12 @@ Layout::init_fixed_output_section(const char* name,
       && strcmp(name, ".gdb_index") == 0)
     return NULL;
 
+  // Likewise for a .debug_names section.
+  if (parameters->options().debug_names()
+      && sh_type == elfcpp::SHT_PROGBITS
+      && strcmp(name, ".debug_names") == 0)
+    return NULL;
+
   typename elfcpp::Elf_types<size>::Elf_Addr sh_addr = shdr.get_sh_addr();
   typename elfcpp::Elf_types<size>::Elf_Off sh_offset = shdr.get_sh_offset();
   typename elfcpp::Elf_types<size>::Elf_WXword sh_size = shdr.get_sh_size();
@@ -1581,36 +1596,86 @@ Layout::add_eh_frame_for_plt(Output_data* plt, const unsigned char* cie_data,
     }
 }
 
-// Scan a .debug_info or .debug_types section, and add summary
-// information to the .gdb_index section.
+// Record a .debug_info or .debug_types section to be scanned for
+// summary information for the .gdb_index and .debug_names sections.
+// The scan itself is done by the tasks queued in
+// queue_middle_layout_tasks.
 
 template<int size, bool big_endian>
 void
-Layout::add_to_gdb_index(bool is_type_unit,
-			 Sized_relobj<size, big_endian>* object,
-			 const unsigned char* symbols,
-			 off_t symbols_size,
-			 unsigned int shndx,
-			 unsigned int reloc_shndx,
-			 unsigned int reloc_type)
+Layout::add_to_debug_index(bool is_type_unit,
+			   Sized_relobj<size, big_endian>* object,
+			   unsigned int symtab_shndx,
+			   unsigned int shndx,
+			   unsigned int reloc_shndx,
+			   unsigned int reloc_type)
 {
-  if (this->gdb_index_data_ == NULL)
+  if (this->debug_index_ == NULL)
     {
-      Output_section* os = this->choose_output_section(NULL, ".gdb_index",
-						       elfcpp::SHT_PROGBITS, 0,
-						       false, ORDER_INVALID,
-						       false, false, false);
-      if (os == NULL)
-	return;
+      Debug_index* debug_index = new Debug_index();
+      bool have_index = false;
 
-      this->gdb_index_data_ = new Gdb_index(os);
-      os->add_output_section_data(this->gdb_index_data_);
-      os->set_after_input_sections();
+      if (parameters->options().gdb_index())
+	{
+	  Output_section* os =
+	    this->choose_output_section(NULL, ".gdb_index",
+					elfcpp::SHT_PROGBITS, 0, false,
+					ORDER_INVALID, false, false, false);
+	  if (os != NULL)
+	    {
+	      os->add_output_section_data(new Gdb_index(os, debug_index));
+	      os->set_after_input_sections();
+	      have_index = true;
+	    }
+	}
+
+      if (parameters->options().debug_names())
+	{
+	  // The names are added to the .debug_str section.
+	  Output_section* str_os = this->find_output_section(".debug_str");
+	  if (str_os == NULL)
+	    str_os = this->choose_output_section(NULL, ".debug_str",
+						 elfcpp::SHT_PROGBITS,
+						 (elfcpp::SHF_MERGE
+						  | elfcpp::SHF_STRINGS),
+						 false, ORDER_INVALID,
+						 false, false, false);
+	  Output_section* os =
+	    this->choose_output_section(NULL, ".debug_names",
+					elfcpp::SHT_PROGBITS, 0, false,
+					ORDER_INVALID, false, false, false);
+	  if (str_os != NULL && os != NULL)
+	    {
+	      Output_section_data* strtab =
+		new Output_data_strtab(debug_index->name_pool());
+	      str_os->add_output_section_data(strtab);
+	      os->add_output_section_data(new Debug_names(debug_index,
+							  strtab));
+	      os->set_after_input_sections();
+	      have_index = true;
+	    }
+	}
+
+      if (!have_index)
+	{
+	  delete debug_index;
+	  return;
+	}
+      this->debug_index_ = debug_index;
     }
 
-  this->gdb_index_data_->scan_debug_info(is_type_unit, object, symbols,
-					 symbols_size, shndx, reloc_shndx,
-					 reloc_type);
+  this->debug_index_->add_debug_info(is_type_unit, object, symtab_shndx,
+				     shndx, reloc_shndx, reloc_type);
+}
+
+// Record that OBJECT has its own .debug_names section, which we do
+// not copy to the output file.
+
+void
+Layout::add_input_debug_names(Relobj* object)
+{
+  if (this->debug_index_ != NULL)
+    this->debug_index_->add_input_names(object);
 }
 
 // Add POSD to an output section using NAME, TYPE, and FLAGS.  Return
@@ -1640,6 +1705,8 @@ Layout::section_flags_to_segment(elfcpp::Elf_Xword flags)
     ret |= elfcpp::PF_W;
   if ((flags & elfcpp::SHF_EXECINSTR) != 0)
     ret |= elfcpp::PF_X;
+  if (parameters->target_valid())
+    ret |= parameters->target().segment_flags_for_section(flags);
   return ret;
 }
 
@@ -2494,7 +2561,8 @@ Layout::relaxation_loop_body(
   Output_segment* load_seg;
   if (this->script_options_->saw_sections_clause())
     load_seg = this->set_section_addresses_from_script(symtab);
-  else if (parameters->options().relocatable())
+  else if (parameters->options().relocatable()
+	   || !target->headers_in_load_segment())
     load_seg = NULL;
   else
     load_seg = this->find_first_load_seg(target);
@@ -2699,6 +2767,11 @@ Layout::finalize(const Input_objects* input_objects, Symbol_table* symtab,
   unsigned int local_dynamic_count = 0;
   unsigned int forced_local_dynamic_count = 0;
 
+  // Merge the information gathered by the tasks that scanned the
+  // debug info before any of the index sections is sized.
+  if (this->debug_index_ != NULL)
+    this->debug_index_->merge_objects();
+
   target->finalize_sections(this, input_objects, symtab);
 
   this->count_local_symbols(task, input_objects);
@@ -5427,6 +5500,37 @@ Layout::write_data(const Symbol_table* symtab, Output_file* of) const
     (*p)->write(of);
 }
 
+// Queue the tasks which postprocess output sections in parallel.
+
+void
+Layout::queue_postprocessing_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  if (!this->any_postprocessing_sections_)
+    return;
+
+  // Add all the blockers before queueing any task, since a task may
+  // release BLOCKER as soon as it is queued.
+  unsigned int task_count = 0;
+  for (Section_list::const_iterator p = this->section_list_.begin();
+       p != this->section_list_.end();
+       ++p)
+    {
+      if ((*p)->requires_postprocessing())
+	task_count += (*p)->prepare_postprocessing_tasks();
+    }
+  if (task_count == 0)
+    return;
+  blocker->add_blockers(task_count);
+
+  for (Section_list::const_iterator p = this->section_list_.begin();
+       p != this->section_list_.end();
+       ++p)
+    {
+      if ((*p)->requires_postprocessing())
+	(*p)->queue_postprocessing_tasks(workqueue, blocker);
+    }
+}
+
 // Write out the Output_sections which can only be written after the
 // input sections are complete.
 
@@ -5701,6 +5805,22 @@ Write_after_input_sections_task::run(Workqueue*)
   this->layout_->write_sections_after_input_sections(this->of_);
 }
 
+// Postprocessing_task_runner methods.
+
+// Queue the postprocessing tasks, followed by the task which sets the
+// final section sizes and writes out the sections.
+
+void
+Postprocessing_task_runner::run(Workqueue* workqueue, const Task*)
+{
+  Task_token* post_tasks_blocker = new Task_token(true);
+  this->layout_->queue_postprocessing_tasks(workqueue, post_tasks_blocker);
+  workqueue->queue(new Write_after_input_sections_task(this->layout_,
+						       this->of_,
+						       post_tasks_blocker,
+						       this->final_blocker_));
+}
+
 // Build IDs can be computed as a "flat" sha1 or md5 of a string of bytes,
 // or as a "tree" where each chunk of the string is hashed and then those
 // hashes are put into a (much smaller) string which is hashed with sha1.
@@ -6002,49 +6122,45 @@ Layout::layout_eh_frame<64, true>(Sized_relobj_file<64, true>* object,
 #ifdef HAVE_TARGET_32_LITTLE
 template
 void
-Layout::add_to_gdb_index(bool is_type_unit,
-			 Sized_relobj<32, false>* object,
-			 const unsigned char* symbols,
-			 off_t symbols_size,
-			 unsigned int shndx,
-			 unsigned int reloc_shndx,
-			 unsigned int reloc_type);
+Layout::add_to_debug_index(bool is_type_unit,
+			   Sized_relobj<32, false>* object,
+			   unsigned int symtab_shndx,
+			   unsigned int shndx,
+			   unsigned int reloc_shndx,
+			   unsigned int reloc_type);
 #endif
 
 #ifdef HAVE_TARGET_32_BIG
 template
 void
-Layout::add_to_gdb_index(bool is_type_unit,
-			 Sized_relobj<32, true>* object,
-			 const unsigned char* symbols,
-			 off_t symbols_size,
-			 unsigned int shndx,
-			 unsigned int reloc_shndx,
-			 unsigned int reloc_type);
+Layout::add_to_debug_index(bool is_type_unit,
+			   Sized_relobj<32, true>* object,
+			   unsigned int symtab_shndx,
+			   unsigned int shndx,
+			   unsigned int reloc_shndx,
+			   unsigned int reloc_type);
 #endif
 
 #ifdef HAVE_TARGET_64_LITTLE
 template
 void
-Layout::add_to_gdb_index(bool is_type_unit,
-			 Sized_relobj<64, false>* object,
-			 const unsigned char* symbols,
-			 off_t symbols_size,
-			 unsigned int shndx,
-			 unsigned int reloc_shndx,
-			 unsigned int reloc_type);
+Layout::add_to_debug_index(bool is_type_unit,
+			   Sized_relobj<64, false>* object,
+			   unsigned int symtab_shndx,
+			   unsigned int shndx,
+			   unsigned int reloc_shndx,
+			   unsigned int reloc_type);
 #endif
 
 #ifdef HAVE_TARGET_64_BIG
 template
 void
-Layout::add_to_gdb_index(bool is_type_unit,
-			 Sized_relobj<64, true>* object,
-			 const unsigned char* symbols,
-			 off_t symbols_size,
-			 unsigned int shndx,
-			 unsigned int reloc_shndx,
-			 unsigned int reloc_type);
+Layout::add_to_debug_index(bool is_type_unit,
+			   Sized_relobj<64, true>* object,
+			   unsigned int symtab_shndx,
+			   unsigned int shndx,
+			   unsigned int reloc_shndx,
+			   unsigned int reloc_type);
 #endif
 
 } // End namespace gold.
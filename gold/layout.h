@@ -58,7 +58,7 @@ class Output_symtab_xindex;
 class Output_reduced_debug_abbrev_section;
 class Output_reduced_debug_info_section;
 class Eh_frame;
-class Gdb_index;
+class Debug_index;
 class Target;
 struct Timespec;
 
@@ -653,17 +653,27 @@ class Layout
 		       size_t cie_length, const unsigned char* fde_data,
 		       size_t fde_length);
 
-  // Scan a .debug_info or .debug_types section, and add summary
-  // information to the .gdb_index section.
+  // Record a .debug_info or .debug_types section to be scanned for
+  // summary information for the .gdb_index and .debug_names sections.
   template<int size, bool big_endian>
   void
-  add_to_gdb_index(bool is_type_unit,
-		   Sized_relobj<size, big_endian>* object,
-		   const unsigned char* symbols,
-		   off_t symbols_size,
-		   unsigned int shndx,
-		   unsigned int reloc_shndx,
-		   unsigned int reloc_type);
+  add_to_debug_index(bool is_type_unit,
+		     Sized_relobj<size, big_endian>* object,
+		     unsigned int symtab_shndx,
+		     unsigned int shndx,
+		     unsigned int reloc_shndx,
+		     unsigned int reloc_type);
+
+  // Record that OBJECT, whose debug info sections have just been
+  // recorded, has its own .debug_names section.
+  void
+  add_input_debug_names(Relobj* object);
+
+  // Return the information collected for the .gdb_index and
+  // .debug_names sections, or NULL if there is none.
+  Debug_index*
+  debug_index() const
+  { return this->debug_index_; }
 
   // Handle a GNU stack note.  This is called once per input object
   // file.  SEEN_GNU_STACK is true if the object file has a
@@ -850,6 +860,11 @@ class Layout
   void
   write_data(const Symbol_table*, Output_file*) const;
 
+  // Queue the tasks which postprocess output sections in parallel,
+  // such as compressing debug sections.  Each task releases BLOCKER.
+  void
+  queue_postprocessing_tasks(Workqueue*, Task_token* blocker);
+
   // Write out output sections which can not be written until all the
   // input sections are complete.
   void
@@ -1379,8 +1394,9 @@ class Layout
   bool added_eh_frame_data_;
   // The exception frame header output section if there is one.
   Output_section* eh_frame_hdr_section_;
-  // The data for the .gdb_index section.
-  Gdb_index* gdb_index_data_;
+  // The information collected for the .gdb_index and .debug_names
+  // sections.
+  Debug_index* debug_index_;
   // The space for the build ID checksum if there is one.
   Output_section_data* build_id_note_;
   // The output section containing dwarf abbreviations
@@ -1599,6 +1615,29 @@ class Write_after_input_sections_task : public Task
   Task_token* final_blocker_;
 };
 
+// This task function queues the tasks which postprocess output
+// sections in parallel, and then the Write_after_input_sections_task
+// which waits for them.  It cannot run until all relocations have
+// been applied.
+
+class Postprocessing_task_runner : public Task_function_runner
+{
+ public:
+  Postprocessing_task_runner(Layout* layout, Output_file* of,
+			     Task_token* final_blocker)
+    : layout_(layout), of_(of), final_blocker_(final_blocker)
+  { }
+
+  // Run the operation.
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  Layout* layout_;
+  Output_file* of_;
+  Task_token* final_blocker_;
+};
+
 // This task function handles computation of the build id.
 // When using --build-id=tree, it schedules the tasks that
 // compute the hashes for each chunk of the file. This task
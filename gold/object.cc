@@ -682,12 +682,16 @@ need_decompressed_section(const char* name)
       // We will need .zdebug_str if this is not an incremental link
       // (i.e., we are processing string merge sections) or if we need
       // to build a gdb index.
-      if ((!parameters->incremental() || parameters->options().gdb_index())
+      if ((!parameters->incremental()
+	   || parameters->options().gdb_index()
+	   || parameters->options().debug_names())
 	  && strcmp(name, "str") == 0)
 	return true;
 
-      // We will need these other sections when building a gdb index.
-      if (parameters->options().gdb_index()
+      // We will need these other sections when building a gdb index
+      // or a .debug_names section.
+      if ((parameters->options().gdb_index()
+	   || parameters->options().debug_names())
 	  && (strcmp(name, "info") == 0
 	      || strcmp(name, "types") == 0
 	      || strcmp(name, "pubnames") == 0
@@ -703,7 +707,8 @@ need_decompressed_section(const char* name)
   // Otherwise, we would decompress the section twice: once for
   // string merge processing, and once for building the gdb index.
   if (!parameters->incremental()
-      && parameters->options().gdb_index()
+      && (parameters->options().gdb_index()
+	  || parameters->options().debug_names())
       && strcmp(name, "str") == 0)
     return true;
 
@@ -815,7 +820,8 @@ Sized_relobj_file<size, big_endian>::do_find_special_sections(
 
   return (this->has_eh_frame_
 	  || (!parameters->options().relocatable()
-	      && parameters->options().gdb_index()
+	      && (parameters->options().gdb_index()
+		  || parameters->options().debug_names())
 	      && (memmem(names, sd->section_names_size, "debug_info", 11) == 0
 		  || memmem(names, sd->section_names_size,
 			    "debug_types", 12) == 0)));
@@ -1523,6 +1529,7 @@ Sized_relobj_file<size, big_endian>::do_layout(Symbol_table* symtab,
   // Keep track of .debug_info and .debug_types sections.
   std::vector<unsigned int> debug_info_sections;
   std::vector<unsigned int> debug_types_sections;
+  bool has_debug_names = false;
 
   // Skip the first, dummy, section.
   pshdrs = shdrs + This::shdr_size;
@@ -1770,11 +1777,13 @@ Sized_relobj_file<size, big_endian>::do_layout(Symbol_table* symtab,
 	  this->layout_section(layout, i, name, shdr, reloc_shndx[i],
 			       reloc_type[i]);
 
-	  // When generating a .gdb_index section, we do additional
-	  // processing of .debug_info and .debug_types sections after all
-	  // the other sections for the same reason as above.
+	  // When generating a .gdb_index or .debug_names section, we do
+	  // additional processing of .debug_info and .debug_types
+	  // sections after all the other sections for the same reason as
+	  // above.
 	  if (!relocatable
-	      && parameters->options().gdb_index()
+	      && (parameters->options().gdb_index()
+		  || parameters->options().debug_names())
 	      && !(shdr.get_sh_flags() & elfcpp::SHF_ALLOC))
 	    {
 	      if (strcmp(name, ".debug_info") == 0
@@ -1783,6 +1792,9 @@ Sized_relobj_file<size, big_endian>::do_layout(Symbol_table* symtab,
 	      else if (strcmp(name, ".debug_types") == 0
 		       || strcmp(name, ".zdebug_types") == 0)
 		debug_types_sections.push_back(i);
+	      else if (strcmp(name, ".debug_names") == 0
+		       || strcmp(name, ".zdebug_names") == 0)
+		has_debug_names = true;
 	    }
 	}
     }
@@ -1866,8 +1878,8 @@ Sized_relobj_file<size, big_endian>::do_layout(Symbol_table* symtab,
       out_section_offsets[i] = invalid_address;
     }
 
-  // When building a .gdb_index section, scan the .debug_info and
-  // .debug_types sections.
+  // When building a .gdb_index or .debug_names section, scan the
+  // .debug_info and .debug_types sections.
   gold_assert(!is_pass_one
 	      || (debug_info_sections.empty() && debug_types_sections.empty()));
   for (std::vector<unsigned int>::const_iterator p
@@ -1876,8 +1888,8 @@ Sized_relobj_file<size, big_endian>::do_layout(Symbol_table* symtab,
        ++p)
     {
       unsigned int i = *p;
-      layout->add_to_gdb_index(false, this, symbols_data, symbols_size,
-			       i, reloc_shndx[i], reloc_type[i]);
+      layout->add_to_debug_index(false, this, this->symtab_shndx_, i,
+				 reloc_shndx[i], reloc_type[i]);
     }
   for (std::vector<unsigned int>::const_iterator p
 	   = debug_types_sections.begin();
@@ -1885,9 +1897,12 @@ Sized_relobj_file<size, big_endian>::do_layout(Symbol_table* symtab,
        ++p)
     {
       unsigned int i = *p;
-      layout->add_to_gdb_index(true, this, symbols_data, symbols_size,
-			       i, reloc_shndx[i], reloc_type[i]);
+      layout->add_to_debug_index(true, this, this->symtab_shndx_, i,
+				 reloc_shndx[i], reloc_type[i]);
     }
+  if (has_debug_names
+      && (!debug_info_sections.empty() || !debug_types_sections.empty()))
+    layout->add_input_debug_names(this);
 
   if (is_pass_two)
     {
@@ -2018,6 +2033,15 @@ Sized_relobj_file<size, big_endian>::do_add_symbols(Symbol_table* symtab,
 
   this->symbols_.resize(symcount);
 
+  if (!sd->shard_starts.empty())
+    {
+      // The symbols will be added by do_add_symbols_shard, which
+      // needs the symbol data, so we don't free it here.
+      gold_assert(sd->shard_symbols.size() <= symcount);
+      this->defined_count_ = sd->defined_count;
+      return;
+    }
+
   const char* sym_names =
     reinterpret_cast<const char*>(sd->symbol_names->data());
   symtab->add_from_relobj(this,
@@ -2033,6 +2057,114 @@ Sized_relobj_file<size, big_endian>::do_add_symbols(Symbol_table* symtab,
   sd->symbol_names = NULL;
 }
 
+// Sort the external symbols into symbol table shards.  This is done
+// while reading the symbols, which happens in parallel for different
+// input files, so that the Add_symbols task only has to queue one
+// task per shard.  We also read any extended section indexes now,
+// while the file is locked.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::do_partition_symbols(
+    Read_symbols_data* sd)
+{
+  if (sd->symbols == NULL)
+    return;
+
+  const int sym_size = This::sym_size;
+  size_t symcount = ((sd->symbols_size - sd->external_symbols_offset)
+		     / sym_size);
+  if (symcount * sym_size != sd->symbols_size - sd->external_symbols_offset)
+    {
+      // do_add_symbols will report this.
+      return;
+    }
+
+  const unsigned int loccount = this->local_symbol_count_;
+  const unsigned char* syms = (sd->symbols->data()
+			       + sd->external_symbols_offset);
+  const char* sym_names =
+    reinterpret_cast<const char*>(sd->symbol_names->data());
+  const section_size_type sym_name_size = sd->symbol_names_size;
+
+  const unsigned int shard_count = Symbol_table::shard_count;
+  std::vector<unsigned int> shards(symcount, -1U);
+  std::vector<unsigned int> counts(shard_count, 0);
+  size_t defined = 0;
+  const unsigned char* p = syms;
+  for (size_t i = 0; i < symcount; ++i, p += sym_size)
+    {
+      elfcpp::Sym<size, big_endian> sym(p);
+      unsigned int st_name = sym.get_st_name();
+      if (st_name >= sym_name_size)
+	{
+	  this->error(_("bad global symbol name offset %u at %zu"),
+		      st_name, i);
+	  continue;
+	}
+
+      bool is_ordinary;
+      unsigned int st_shndx = this->adjust_sym_shndx(i + loccount,
+						     sym.get_st_shndx(),
+						     &is_ordinary);
+      if (st_shndx != elfcpp::SHN_UNDEF)
+	++defined;
+
+      // Only the part of the name before any version selects the
+      // shard.
+      const char* name = sym_names + st_name;
+      const char* ver = strchr(name, '@');
+      size_t namelen = ver != NULL ? ver - name : strlen(name);
+      unsigned int shard = Symbol_table::shard_for_name(name, namelen);
+      shards[i] = shard;
+      ++counts[shard];
+    }
+
+  sd->shard_starts.resize(shard_count + 1);
+  unsigned int start = 0;
+  for (unsigned int i = 0; i < shard_count; ++i)
+    {
+      sd->shard_starts[i] = start;
+      start += counts[i];
+    }
+  sd->shard_starts[shard_count] = start;
+
+  sd->shard_symbols.resize(start);
+  std::vector<unsigned int> next(sd->shard_starts.begin(),
+				 sd->shard_starts.end() - 1);
+  for (size_t i = 0; i < symcount; ++i)
+    if (shards[i] != -1U)
+      sd->shard_symbols[next[shards[i]]++] = i;
+
+  sd->defined_count = defined;
+}
+
+// Add the symbols in one symbol table shard.  This is called by an
+// Add_symbols_shard task after do_add_symbols has sized the symbols_
+// vector.  The tasks for different shards of this object may run at
+// the same time; each only sets the entries of symbols_ for its own
+// symbols.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::do_add_symbols_shard(
+    Symbol_table* symtab,
+    Read_symbols_data* sd,
+    unsigned int shard)
+{
+  gold_assert(shard < Symbol_table::shard_count);
+  const unsigned int* shard_symbols = &sd->shard_symbols[0];
+  const unsigned char* syms = (sd->symbols->data()
+			       + sd->external_symbols_offset);
+  const char* sym_names =
+    reinterpret_cast<const char*>(sd->symbol_names->data());
+  symtab->add_from_relobj_shard(this, syms, this->local_symbol_count_,
+				sym_names, sd->symbol_names_size,
+				&this->symbols_, shard,
+				shard_symbols + sd->shard_starts[shard],
+				shard_symbols + sd->shard_starts[shard + 1]);
+}
+
 // Find out if this object, that is a member of a lib group, should be included
 // in the link. We check every symbol defined by this object. If the symbol
 // table has a strong undefined reference to that symbol, we have to include
@@ -2972,6 +3104,10 @@ Input_objects::add_object(Object* obj)
   if (parameters->options().trace())
     gold_info("%s", obj->name().c_str());
 
+  // Objects are added in input order, even when their symbols are
+  // added in parallel, so this is a stable position for the object.
+  obj->set_input_order(this->number_of_input_objects());
+
   if (!obj->is_dynamic())
     this->relobj_list_.push_back(static_cast<Relobj*>(obj));
   else
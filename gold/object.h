@@ -59,7 +59,8 @@ struct Read_symbols_data
 {
   Read_symbols_data()
     : section_headers(NULL), section_names(NULL), symbols(NULL),
-      symbol_names(NULL), versym(NULL), verdef(NULL), verneed(NULL)
+      symbol_names(NULL), versym(NULL), verdef(NULL), verneed(NULL),
+      shard_starts(), shard_symbols(), defined_count(0)
   { }
 
   ~Read_symbols_data();
@@ -95,6 +96,18 @@ struct Read_symbols_data
   File_view* verneed;
   section_size_type verneed_size;
   unsigned int verneed_info;
+
+  // Symbol table shards.  These are only set if the external symbols
+  // are to be added to the symbol table in parallel, one task per
+  // shard.  SHARD_SYMBOLS holds the indexes of the external symbols,
+  // relative to EXTERNAL_SYMBOLS_OFFSET, grouped by shard; the
+  // symbols of shard I are SHARD_SYMBOLS[SHARD_STARTS[I]] up to
+  // SHARD_SYMBOLS[SHARD_STARTS[I + 1]].
+  std::vector<unsigned int> shard_starts;
+  std::vector<unsigned int> shard_symbols;
+  // The number of defined external symbols, counted when the symbols
+  // are partitioned.
+  size_t defined_count;
 };
 
 // Information used to print error messages.
@@ -398,8 +411,8 @@ class Object
   Object(const std::string& name, Input_file* input_file, bool is_dynamic,
 	 off_t offset = 0)
     : name_(name), input_file_(input_file), offset_(offset), shnum_(-1U),
-      is_dynamic_(is_dynamic), is_needed_(false), uses_split_stack_(false),
-      has_no_split_stack_(false), no_export_(false),
+      input_order_(0), is_dynamic_(is_dynamic), is_needed_(false),
+      uses_split_stack_(false), has_no_split_stack_(false), no_export_(false),
       is_in_system_directory_(false), as_needed_(false), xindex_(NULL),
       compressed_sections_(NULL)
   {
@@ -655,6 +668,22 @@ class Object
   add_symbols(Symbol_table* symtab, Read_symbols_data* sd, Layout *layout)
   { this->do_add_symbols(symtab, sd, layout); }
 
+  // Sort the external symbols read by read_symbols into symbol table
+  // shards, so that they can be added by add_symbols_shard.  This is
+  // called while the file is still locked.  It does nothing for
+  // objects whose symbols can not be added in parallel.
+  void
+  partition_symbols(Read_symbols_data* sd)
+  { this->do_partition_symbols(sd); }
+
+  // Add the symbols in shard SHARD to the global symbol table.  This
+  // is only called after add_symbols, for an object whose symbols
+  // were partitioned.
+  void
+  add_symbols_shard(Symbol_table* symtab, Read_symbols_data* sd,
+		    unsigned int shard)
+  { this->do_add_symbols_shard(symtab, sd, shard); }
+
   // Add symbol information to the global symbol table.
   Archive::Should_include
   should_include_member(Symbol_table* symtab, Layout* layout,
@@ -797,6 +826,18 @@ class Object
   searched_for() const
   { return this->input_file()->will_search_for(); }
 
+  // Return the position of this object among the objects added to
+  // the link.
+  unsigned int
+  input_order() const
+  { return this->input_order_; }
+
+  // Set the position of this object among the objects added to the
+  // link.  This is called by Input_objects::add_object.
+  void
+  set_input_order(unsigned int input_order)
+  { this->input_order_ = input_order; }
+
   bool
   no_export() const
   { return this->no_export_; }
@@ -889,6 +930,18 @@ class Object
   virtual void
   do_add_symbols(Symbol_table*, Read_symbols_data*, Layout*) = 0;
 
+  // Partition the symbols into symbol table shards.  By default we
+  // don't, and the symbols are added by do_add_symbols.
+  virtual void
+  do_partition_symbols(Read_symbols_data*)
+  { }
+
+  // Add the symbols in one symbol table shard--implemented by child
+  // classes which implement do_partition_symbols.
+  virtual void
+  do_add_symbols_shard(Symbol_table*, Read_symbols_data*, unsigned int)
+  { gold_unreachable(); }
+
   virtual Archive::Should_include
   do_should_include_member(Symbol_table* symtab, Layout*, Read_symbols_data*,
                            std::string* why) = 0;
@@ -1061,6 +1114,8 @@ class Object
   off_t offset_;
   // Number of input sections.
   unsigned int shnum_;
+  // The position of this object among the objects added to the link.
+  unsigned int input_order_;
   // Whether this is a dynamic object.
   bool is_dynamic_ : 1;
   // Whether this object is needed.  This is only set for dynamic
@@ -2389,6 +2444,14 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   void
   do_add_symbols(Symbol_table*, Read_symbols_data*, Layout*);
 
+  // Partition the symbols into symbol table shards.
+  void
+  do_partition_symbols(Read_symbols_data*);
+
+  // Add the symbols in one symbol table shard.
+  void
+  do_add_symbols_shard(Symbol_table*, Read_symbols_data*, unsigned int);
+
   Archive::Should_include
   do_should_include_member(Symbol_table* symtab, Layout*, Read_symbols_data*,
                            std::string* why);
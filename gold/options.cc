@@ -1324,6 +1324,13 @@ General_options::finalize()
 		 "[0.0, 1.0)"),
 	       this->hash_bucket_empty_fraction());
 
+  if (this->user_set_compress_debug_sections_level()
+      && (this->compress_debug_sections_level() < 1
+	  || this->compress_debug_sections_level() > 9))
+    gold_fatal(_("--compress-debug-sections-level value %d out of range "
+		 "[1, 9]"),
+	       this->compress_debug_sections_level());
+
   if (this->implicit_incremental_ && this->incremental_mode_ == INCREMENTAL_OFF)
     gold_fatal(_("Options --incremental-changed, --incremental-unchanged, "
 		 "--incremental-unknown require the use of --incremental"));
@@ -760,6 +760,17 @@ class General_options
 	      ("[none,zlib,zlib-gnu,zlib-gabi]"),
 	      {"none", "zlib", "zlib-gnu", "zlib-gabi"});
 
+  DEFINE_uint(compress_debug_sections_level, options::TWO_DASHES, '\0', 0,
+	      N_("Compression level for --compress-debug-sections "
+		 "(default 1, or 9 with -O1)"),
+	      N_("LEVEL"));
+
+  DEFINE_uint64(compress_debug_sections_chunk_size, options::TWO_DASHES,
+		'\0', 1 << 20,
+		N_("Size of the pieces of each debug section compressed "
+		   "in parallel (0 for no splitting)"),
+		N_("SIZE"));
+
   DEFINE_bool(copy_dt_needed_entries, options::TWO_DASHES, '\0', false,
 	      N_("Not supported"),
 	      N_("Do not copy DT_NEEDED tags from shared libraries"));
@@ -774,6 +785,10 @@ class General_options
 
   // d
 
+  DEFINE_bool(debug_names, options::TWO_DASHES, '\0', false,
+	      N_("Generate .debug_names section"),
+	      N_("Do not generate .debug_names section"));
+
   DEFINE_bool(define_common, options::TWO_DASHES, 'd', false,
 	      N_("Define common symbols"),
 	      N_("Do not define common symbols in relocatable output"));
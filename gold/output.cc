@@ -3791,6 +3791,17 @@ Output_section::create_postprocessing_buffer()
 	{
 	  off = align_address(off, p->addralign());
 	  p->finalize_data_size();
+	  // The data is written to the buffer rather than to the file,
+	  // but give the data we generate an address within the
+	  // unprocessed contents, so that other sections can refer to it.
+	  if (!p->is_input_section()
+	      && !p->is_relaxed_input_section()
+	      && this->is_address_valid())
+	    {
+	      Output_section_data* posd = p->output_section_data();
+	      if (!posd->is_address_valid())
+		posd->set_address(this->address() + off);
+	    }
 	  off += p->data_size();
 	}
       this->set_current_data_size_for_child(off);
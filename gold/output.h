@@ -3647,6 +3647,22 @@ class Output_section : public Output_data
   postprocessing_buffer_size() const
   { return this->current_data_size_for_child(); }
 
+  // If a section requires postprocessing, get ready to do part of
+  // that postprocessing in parallel, and return the number of tasks
+  // which queue_postprocessing_tasks will queue.  This is called after
+  // all relocations have been applied, and before the final size of
+  // the section is set.
+  unsigned int
+  prepare_postprocessing_tasks()
+  { return this->do_prepare_postprocessing_tasks(); }
+
+  // Queue the tasks counted by prepare_postprocessing_tasks.  Each
+  // task must release BLOCKER when it completes; the caller has
+  // already added a blocker for each of them.
+  void
+  queue_postprocessing_tasks(Workqueue* workqueue, Task_token* blocker)
+  { this->do_queue_postprocessing_tasks(workqueue, blocker); }
+
   // Modify the section name.  This is only permitted for an
   // unallocated section, and only before the size has been finalized.
   // Otherwise the name will not get into Layout::namepool_.
@@ -4258,6 +4274,17 @@ class Output_section : public Output_data
   void
   write_to_postprocessing_buffer();
 
+  // Return the number of postprocessing tasks for this section.  Most
+  // sections do all of their postprocessing in set_final_data_size.
+  virtual unsigned int
+  do_prepare_postprocessing_tasks()
+  { return 0; }
+
+  // Queue the postprocessing tasks for this section.
+  virtual void
+  do_queue_postprocessing_tasks(Workqueue*, Task_token*)
+  { }
+
   // Whether this always keeps an input section list
   bool
   always_keeps_input_sections() const
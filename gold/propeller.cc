@@ -0,0 +1,1367 @@
+// propeller.cc -- Parallax Propeller target support for gold.
+
+// Copyright (C) 2017 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "elfcpp.h"
+#include "propeller.h"
+#include "parameters.h"
+#include "reloc.h"
+#include "object.h"
+#include "symtab.h"
+#include "layout.h"
+#include "output.h"
+#include "script.h"
+#include "script-c.h"
+#include "script-sections.h"
+#include "target.h"
+#include "target-reloc.h"
+#include "target-select.h"
+#include "gc.h"
+#include "icf.h"
+
+// The Propeller has no dynamic linking, so this is a static target.
+// Code runs either from hub memory (LMM, CMM and XMM code) or from the
+// 512 longs of a cog.  Cog code is linked as an overlay: it runs at a
+// cog address but is loaded in hub memory after the code, from where
+// a driver copies it into a cog.  The GNU linker places these overlays
+// in ld/emultempl/propeller.em; the same placement is done here
+// through the orphan hooks of the target.
+
+namespace
+{
+
+using namespace gold;
+
+class Target_propeller;
+
+// The kinds of cog overlay, recognized by the names of the orphan
+// sections which hold them.
+
+enum Propeller_overlay
+{
+  // Not an overlay.
+  OVERLAY_NONE,
+  // .cog* or *.cog: runs in coguser, loaded after .text.
+  OVERLAY_COG,
+  // .ecog* or *.ecog: runs in coguser, loaded after .drivers.
+  OVERLAY_ECOG,
+  // *.kerext: runs in kerextmem, loaded after .hub.
+  OVERLAY_KEREXT
+};
+
+// Return the kind of overlay held by a section named NAME.
+
+Propeller_overlay
+propeller_overlay(const char* name)
+{
+  size_t len = strlen(name);
+  Propeller_overlay ret = OVERLAY_NONE;
+  if (is_prefix_of(".cog", name)
+      || (len >= 4 && strcmp(name + len - 4, ".cog") == 0))
+    ret = OVERLAY_COG;
+  if (is_prefix_of(".ecog", name)
+      || (len >= 5 && strcmp(name + len - 5, ".ecog") == 0))
+    ret = OVERLAY_ECOG;
+  if (len >= 7 && strcmp(name + len - 7, ".kerext") == 0)
+    ret = OVERLAY_KEREXT;
+  return ret;
+}
+
+// Return the name used for the overlay NAME in its __load_start_ and
+// __load_stop_ symbols: the letters, digits and underscores of NAME,
+// with every dot but a leading one turned into an underscore.
+
+std::string
+propeller_overlay_symbol_name(const char* name)
+{
+  std::string ret;
+  for (const char* p = name; *p != '\0'; ++p)
+    {
+      if ((*p >= 'a' && *p <= 'z')
+	  || (*p >= 'A' && *p <= 'Z')
+	  || (*p >= '0' && *p <= '9')
+	  || *p == '_')
+	ret.push_back(*p);
+      else if (*p == '.' && p != name)
+	ret.push_back('_');
+    }
+  return ret;
+}
+
+// Return the overlay symbol name in NAME, if NAME is a __load_start_
+// or __load_stop_ symbol, else NULL.
+
+const char*
+propeller_overlay_symbol_suffix(const char* name)
+{
+  if (is_prefix_of("__load_start_", name))
+    return name + strlen("__load_start_");
+  if (is_prefix_of("__load_stop_", name))
+    return name + strlen("__load_stop_");
+  return NULL;
+}
+
+// A Propeller relocatable object.  It remembers the e_flags of the
+// file and the values of the local symbols which were assembled with
+// .cog_ram.
+
+class Propeller_relobj : public Sized_relobj_file<32, false>
+{
+ public:
+  typedef elfcpp::Elf_types<32>::Elf_Addr Address;
+
+  Propeller_relobj(const std::string& name, Input_file* input_file,
+		   off_t offset, const elfcpp::Ehdr<32, false>& ehdr)
+    : Sized_relobj_file<32, false>(name, input_file, offset, ehdr),
+      e_flags_(ehdr.get_e_flags()), cog_ram_values_()
+  { }
+
+  ~Propeller_relobj()
+  { }
+
+  // Return the e_flags of the ELF header.
+  elfcpp::Elf_Word
+  e_flags() const
+  { return this->e_flags_; }
+
+  // Return whether the local symbol R_SYM was assembled with
+  // .cog_ram.  If so, set *VALUE to its st_value.
+  bool
+  cog_ram_value(unsigned int r_sym, Address* value) const
+  {
+    if (this->cog_ram_values_.empty())
+      return false;
+    Cog_ram_values::const_iterator p = this->cog_ram_values_.find(r_sym);
+    if (p == this->cog_ram_values_.end())
+      return false;
+    *value = p->second;
+    return true;
+  }
+
+ protected:
+  // Count the local symbols.
+  void
+  do_count_local_symbols(Stringpool_template<char>*,
+			 Stringpool_template<char>*);
+
+  // Lay out the input sections.
+  void
+  do_layout(Symbol_table*, Layout*, Read_symbols_data*);
+
+ private:
+  typedef Unordered_map<unsigned int, Address> Cog_ram_values;
+
+  // The e_flags of the ELF header.
+  elfcpp::Elf_Word e_flags_;
+  // The st_value of each local .cog_ram symbol.
+  Cog_ram_values cog_ram_values_;
+};
+
+// The Propeller target.
+
+class Target_propeller : public Sized_target<32, false>
+{
+ public:
+  typedef elfcpp::Elf_types<32>::Elf_Addr Address;
+
+  Target_propeller()
+    : Sized_target<32, false>(&propeller_info),
+      overlay_sections_(), provided_overlays_()
+  { }
+
+  // Process the relocations to determine unreferenced sections for
+  // garbage collection.
+  void
+  gc_process_relocs(Symbol_table* symtab,
+		    Layout* layout,
+		    Sized_relobj_file<32, false>* object,
+		    unsigned int data_shndx,
+		    unsigned int sh_type,
+		    const unsigned char* prelocs,
+		    size_t reloc_count,
+		    Output_section* output_section,
+		    bool needs_special_offset_handling,
+		    size_t local_symbol_count,
+		    const unsigned char* plocal_symbols);
+
+  // Scan the relocations to look for symbol adjustments.
+  void
+  scan_relocs(Symbol_table* symtab,
+	      Layout* layout,
+	      Sized_relobj_file<32, false>* object,
+	      unsigned int data_shndx,
+	      unsigned int sh_type,
+	      const unsigned char* prelocs,
+	      size_t reloc_count,
+	      Output_section* output_section,
+	      bool needs_special_offset_handling,
+	      size_t local_symbol_count,
+	      const unsigned char* plocal_symbols);
+
+  // Finalize the sections.
+  void
+  do_finalize_sections(Layout*, const Input_objects*, Symbol_table*);
+
+  // Relocate a section.
+  void
+  relocate_section(const Relocate_info<32, false>*,
+		   unsigned int sh_type,
+		   const unsigned char* prelocs,
+		   size_t reloc_count,
+		   Output_section* output_section,
+		   bool needs_special_offset_handling,
+		   unsigned char* view,
+		   Address view_address,
+		   section_size_type view_size,
+		   const Reloc_symbol_changes*);
+
+  // Scan the relocs during a relocatable link.
+  void
+  scan_relocatable_relocs(Symbol_table* symtab,
+			  Layout* layout,
+			  Sized_relobj_file<32, false>* object,
+			  unsigned int data_shndx,
+			  unsigned int sh_type,
+			  const unsigned char* prelocs,
+			  size_t reloc_count,
+			  Output_section* output_section,
+			  bool needs_special_offset_handling,
+			  size_t local_symbol_count,
+			  const unsigned char* plocal_symbols,
+			  Relocatable_relocs*);
+
+  // Scan the relocs for --emit-relocs.
+  void
+  emit_relocs_scan(Symbol_table* symtab,
+		   Layout* layout,
+		   Sized_relobj_file<32, false>* object,
+		   unsigned int data_shndx,
+		   unsigned int sh_type,
+		   const unsigned char* prelocs,
+		   size_t reloc_count,
+		   Output_section* output_section,
+		   bool needs_special_offset_handling,
+		   size_t local_symbol_count,
+		   const unsigned char* plocal_syms,
+		   Relocatable_relocs* rr);
+
+  // Emit relocations for a section.
+  void
+  relocate_relocs(const Relocate_info<32, false>*,
+		  unsigned int sh_type,
+		  const unsigned char* prelocs,
+		  size_t reloc_count,
+		  Output_section* output_section,
+		  elfcpp::Elf_types<32>::Elf_Off offset_in_output_section,
+		  unsigned char* view,
+		  Address view_address,
+		  section_size_type view_size,
+		  unsigned char* reloc_view,
+		  section_size_type reloc_view_size);
+
+  // Make an ELF object.
+  Object*
+  do_make_elf_object(const std::string&, Input_file*, off_t,
+		     const elfcpp::Ehdr<32, false>& ehdr);
+
+  Object*
+  do_make_elf_object(const std::string&, Input_file*, off_t,
+		     const elfcpp::Ehdr<32, true>&)
+  { gold_unreachable(); }
+
+  Object*
+  do_make_elf_object(const std::string&, Input_file*, off_t,
+		     const elfcpp::Ehdr<64, false>&)
+  { gold_unreachable(); }
+
+  Object*
+  do_make_elf_object(const std::string&, Input_file*, off_t,
+		     const elfcpp::Ehdr<64, true>&)
+  { gold_unreachable(); }
+
+  // Mark cog overlays as cog data.
+  void
+  do_new_output_section(Output_section*) const;
+
+  // Copy the cog data flag of a section to its segment.
+  elfcpp::Elf_Word
+  do_segment_flags_for_section(elfcpp::Elf_Xword flags) const
+  { return flags & elfcpp::SHF_PROPELLER_COGDATA; }
+
+  // Return the output section which an overlay follows.
+  const char*
+  do_orphan_section_follows(const Output_section*) const;
+
+  // The headers are not loaded; like the default linker script, start
+  // the code at address 0.
+  bool
+  do_headers_in_load_segment() const
+  { return false; }
+
+  // Return the address at which an overlay runs.
+  bool
+  do_orphan_run_address(const Output_section*, Symbol_table*, Layout*,
+			uint64_t*) const;
+
+  // Keep the overlays named by a __load_start_ or __load_stop_ symbol
+  // given with -u.
+  void
+  do_gc_mark_symbol(Symbol_table*, Symbol*) const;
+
+  // Remember the input section SHNDX of OBJECT as part of an overlay
+  // during the first pass of garbage collection.
+  void
+  add_overlay_section(const char* name, Relobj* object, unsigned int shndx)
+  {
+    this->overlay_sections_[propeller_overlay_symbol_name(name)].push_back(
+	Section_id(object, shndx));
+  }
+
+  // Define the __load_start_ and __load_stop_ symbols of the overlay
+  // output section OS, if they are used.
+  void
+  provide_overlay_symbols(Layout*, const Output_section* os);
+
+ private:
+  // The class which scans relocations.
+  class Scan
+  {
+   public:
+    Scan()
+    { }
+
+    inline void
+    local(Symbol_table* symtab, Layout* layout, Target_propeller* target,
+	  Sized_relobj_file<32, false>* object,
+	  unsigned int data_shndx,
+	  Output_section* output_section,
+	  const elfcpp::Rela<32, false>& reloc, unsigned int r_type,
+	  const elfcpp::Sym<32, false>& lsym,
+	  bool is_discarded);
+
+    inline void
+    global(Symbol_table* symtab, Layout* layout, Target_propeller* target,
+	   Sized_relobj_file<32, false>* object,
+	   unsigned int data_shndx,
+	   Output_section* output_section,
+	   const elfcpp::Rela<32, false>& reloc, unsigned int r_type,
+	   Symbol* gsym);
+
+    inline bool
+    local_reloc_may_be_function_pointer(Symbol_table*, Layout*,
+					Target_propeller*,
+					Sized_relobj_file<32, false>*,
+					unsigned int,
+					Output_section*,
+					const elfcpp::Rela<32, false>&,
+					unsigned int,
+					const elfcpp::Sym<32, false>&)
+    { return false; }
+
+    inline bool
+    global_reloc_may_be_function_pointer(Symbol_table*, Layout*,
+					 Target_propeller*,
+					 Sized_relobj_file<32, false>*,
+					 unsigned int,
+					 Output_section*,
+					 const elfcpp::Rela<32, false>&,
+					 unsigned int,
+					 Symbol*)
+    { return false; }
+
+   private:
+    static void
+    unsupported_reloc_local(Sized_relobj_file<32, false>*,
+			    unsigned int r_type);
+
+    static void
+    unsupported_reloc_global(Sized_relobj_file<32, false>*,
+			     unsigned int r_type, Symbol*);
+
+    // Return whether R_TYPE is a relocation of this target.
+    static inline bool
+    is_supported(unsigned int r_type)
+    { return r_type <= elfcpp::R_PROPELLER_DIFF32; }
+  };
+
+  // The class which implements relocation.
+  class Relocate
+  {
+   public:
+    // Do a relocation.  Return false if the caller should not issue
+    // any warnings about this relocation.
+    inline bool
+    relocate(const Relocate_info<32, false>*, unsigned int,
+	     Target_propeller*, Output_section*, size_t, const unsigned char*,
+	     const Sized_symbol<32>*, const Symbol_value<32>*,
+	     unsigned char*, Address, section_size_type);
+  };
+
+  // Merge the e_flags of the input objects, as the GNU linker does.
+  void
+  merge_e_flags(const Input_objects*);
+
+  // The overlay input sections, by the name used in their symbols.
+  typedef std::map<std::string, std::vector<Section_id> > Overlay_sections;
+
+  // Information about this specific target which we pass to the
+  // general Target structure.
+  static Target::Target_info propeller_info;
+
+  // The overlay input sections seen in the first pass of garbage
+  // collection.
+  Overlay_sections overlay_sections_;
+  // The overlay output sections whose symbols have been provided.
+  std::set<const Output_section*> provided_overlays_;
+};
+
+Target::Target_info Target_propeller::propeller_info =
+{
+  32,			// size
+  false,		// is_big_endian
+  elfcpp::EM_PROPELLER,	// machine_code
+  false,		// has_make_symbol
+  false,		// has_resolve
+  false,		// has_code_fill
+  false,		// is_default_stack_executable
+  false,		// can_icf_inline_merge_sections
+  '\0',			// wrap_char
+  NULL,			// dynamic_linker
+  0,			// default_text_segment_address
+  1,			// abi_pagesize (overridable by -z max-page-size)
+  1,			// common_pagesize (overridable by -z common-page-size)
+  false,                // isolate_execinstr
+  0,                    // rosegment_gap
+  elfcpp::SHN_UNDEF,	// small_common_shndx
+  elfcpp::SHN_UNDEF,	// large_common_shndx
+  0,			// small_common_section_flags
+  0,			// large_common_section_flags
+  NULL,			// attributes_section
+  NULL,			// attributes_vendor
+  "_start",		// entry_symbol_name
+  32,			// hash_entry_size
+};
+
+// Return the Propeller target.
+
+inline Target_propeller*
+propeller_target()
+{
+  return static_cast<Target_propeller*>(
+      parameters->sized_target<32, false>());
+}
+
+// Relocation helpers.  Most Propeller relocations store a value into
+// a field of a little endian word, in the manner of a bfd howto.  The
+// words of compressed code need not be aligned.
+
+class Propeller_relocate_functions
+{
+ public:
+  typedef elfcpp::Elf_types<32>::Elf_Addr Address;
+
+  enum Overflow_check
+  {
+    // No overflow checking.
+    CHECK_NONE,
+    // Check for overflow of a signed value.
+    CHECK_SIGNED,
+    // Check for overflow of a signed or unsigned value, like a bfd
+    // complain_overflow_bitfield.
+    CHECK_BITFIELD
+  };
+
+  enum Status
+  {
+    STATUS_OKAY,
+    STATUS_OVERFLOW
+  };
+
+  // Store VALUE, shifted right by RIGHTSHIFT, into the BITSIZE bit
+  // field at bit BITPOS of the VALSIZE bit word at VIEW.
+  template<int valsize, int bitsize>
+  static inline Status
+  field(unsigned char* view, Address value, int rightshift, int bitpos,
+	Overflow_check check)
+  {
+    typedef typename elfcpp::Swap_unaligned<valsize, false>::Valtype Valtype;
+    Valtype val = elfcpp::Swap_unaligned<valsize, false>::readval(view);
+    Valtype mask =
+      static_cast<Valtype>(Limits<bitsize>::MAX_UNSIGNED) << bitpos;
+    val = Bits<valsize>::bit_select32(val, (value >> rightshift) << bitpos,
+				      mask);
+    elfcpp::Swap_unaligned<valsize, false>::writeval(view, val);
+
+    // The range is checked on the signed value.
+    uint32_t shifted =
+      static_cast<uint32_t>(static_cast<int32_t>(value) >> rightshift);
+    switch (check)
+      {
+      case CHECK_SIGNED:
+	return (Bits<bitsize>::has_overflow32(shifted)
+		? STATUS_OVERFLOW
+		: STATUS_OKAY);
+      case CHECK_BITFIELD:
+	return (Bits<bitsize>::has_signed_unsigned_overflow32(shifted)
+		? STATUS_OVERFLOW
+		: STATUS_OKAY);
+      case CHECK_NONE:
+      default:
+	return STATUS_OKAY;
+      }
+  }
+
+  // R_PROPELLER_23: 32 bits of data inline in code, which must leave
+  // the condition bits clear so that it executes as a no-op.
+  static inline Status
+  rel23(unsigned char* view, Address value)
+  {
+    const uint32_t mask = 0xffc3ffff;
+    uint32_t val = elfcpp::Swap_unaligned<32, false>::readval(view);
+    val = Bits<32>::bit_select32(val, value, mask);
+    elfcpp::Swap_unaligned<32, false>::writeval(view, val);
+    return (value & ~mask) != 0 ? STATUS_OVERFLOW : STATUS_OKAY;
+  }
+
+  // R_PROPELLER_PCREL10: a pc relative offset between -511 and 511.
+  // The sign is given by the instruction, which is toggled from add
+  // to sub for a negative offset.
+  static inline Status
+  pcrel10(unsigned char* view, Address value, Address address)
+  {
+    int32_t rel = static_cast<int32_t>(value - address);
+    Status status = (rel < -0x1ff || rel > 0x1ff
+		     ? STATUS_OVERFLOW
+		     : STATUS_OKAY);
+    uint32_t val = elfcpp::Swap_unaligned<32, false>::readval(view);
+    if (rel < 0)
+      {
+	val |= 0x04000000;
+	rel = -rel;
+      }
+    val = Bits<32>::bit_select32(val, rel, 0x1ff);
+    elfcpp::Swap_unaligned<32, false>::writeval(view, val);
+    return status;
+  }
+
+  // R_PROPELLER_REPINSCNT and R_PROPELLER_REPSREL: a 6 bit repeat
+  // count, which is one less than the number of instructions.
+  static inline Status
+  repeat_count(unsigned char* view, int32_t count)
+  {
+    Status status = STATUS_OKAY;
+    if (count < 0)
+      {
+	count = 0;
+	status = STATUS_OVERFLOW;
+      }
+    else if (count > 0x3f)
+      status = STATUS_OVERFLOW;
+    uint32_t val = elfcpp::Swap_unaligned<32, false>::readval(view);
+    val = Bits<32>::bit_select32(val, count, 0x3f);
+    elfcpp::Swap_unaligned<32, false>::writeval(view, val);
+    return status;
+  }
+
+  // R_PROPELLER_REPS: a 14 bit repeat count, one less than the count.
+  // The low 13 bits go into bits 9 to 21 and the top bit into bit 25,
+  // as the assembler encodes a constant.
+  static inline Status
+  reps(unsigned char* view, Address value)
+  {
+    int32_t count = static_cast<int32_t>(value) - 1;
+    Status status = (count < 0 || count >= (1 << 14)
+		     ? STATUS_OVERFLOW
+		     : STATUS_OKAY);
+    uint32_t val = elfcpp::Swap_unaligned<32, false>::readval(view);
+    val = Bits<32>::bit_select32(val,
+				 (((count & 0x1fff) << 9)
+				  | ((count & 0x2000) << (25 - 13))),
+				 0x023ffe00);
+    elfcpp::Swap_unaligned<32, false>::writeval(view, val);
+    return status;
+  }
+};
+
+// Count the local symbols, and note the ones which were assembled
+// with .cog_ram.
+
+void
+Propeller_relobj::do_count_local_symbols(Stringpool_template<char>* pool,
+					 Stringpool_template<char>* dynpool)
+{
+  // Ask parent to count the local symbols.
+  Sized_relobj_file<32, false>::do_count_local_symbols(pool, dynpool);
+  const unsigned int loccount = this->local_symbol_count();
+  if (loccount == 0)
+    return;
+
+  // Read the symbol table section header.
+  const unsigned int symtab_shndx = this->symtab_shndx();
+  elfcpp::Shdr<32, false>
+    symtabshdr(this, this->elf_file()->section_header(symtab_shndx));
+  gold_assert(symtabshdr.get_sh_type() == elfcpp::SHT_SYMTAB);
+
+  // Read the local symbols.
+  const int sym_size = elfcpp::Elf_sizes<32>::sym_size;
+  gold_assert(loccount == symtabshdr.get_sh_info());
+  off_t locsize = loccount * sym_size;
+  const unsigned char* psyms = this->get_view(symtabshdr.get_sh_offset(),
+					      locsize, true, true);
+
+  // Skip the first dummy symbol.
+  psyms += sym_size;
+  for (unsigned int i = 1; i < loccount; ++i, psyms += sym_size)
+    {
+      elfcpp::Sym<32, false> sym(psyms);
+      if ((sym.get_st_other() & elfcpp::STO_PROPELLER_COG_RAM) != 0)
+	this->cog_ram_values_[i] = sym.get_st_value();
+    }
+}
+
+// Lay out the input sections, and find the cog overlays among them.
+
+void
+Propeller_relobj::do_layout(Symbol_table* symtab, Layout* layout,
+			    Read_symbols_data* sd)
+{
+  // In the first pass of garbage collection nothing is placed yet;
+  // the overlays are only recorded, so that a reference to their
+  // symbols can keep them.
+  bool is_gc_pass_one = (parameters->options().gc_sections()
+			 && !symtab->gc()->is_worklist_ready());
+
+  Sized_relobj_file<32, false>::do_layout(symtab, layout, sd);
+
+  // Only the GNU linker chooses between the two encodings of a
+  // function assembled with gas --dual-encoding; keeping both would
+  // define each of its labels twice.
+  const unsigned int shnum = this->shnum();
+  if (!parameters->options().gc_sections() || is_gc_pass_one)
+    {
+      for (unsigned int shndx = 1; shndx < shnum; ++shndx)
+	if (this->section_type(shndx) == elfcpp::SHT_PROPELLER_DUAL)
+	  gold_error(_("%s: section %s is the other encoding of a function "
+		       "assembled with --dual-encoding, which gold does not "
+		       "support"),
+		     this->name().c_str(), this->section_name(shndx).c_str());
+    }
+
+  if (parameters->options().relocatable())
+    return;
+
+  Target_propeller* target = propeller_target();
+  for (unsigned int shndx = 1; shndx < shnum; ++shndx)
+    {
+      if (is_gc_pass_one)
+	{
+	  if ((this->section_flags(shndx) & elfcpp::SHF_ALLOC) == 0)
+	    continue;
+	  std::string name = this->section_name(shndx);
+	  if (propeller_overlay(name.c_str()) != OVERLAY_NONE)
+	    target->add_overlay_section(name.c_str(), this, shndx);
+	}
+      else
+	{
+	  const Output_section* os = this->output_section(shndx);
+	  if (os != NULL && propeller_overlay(os->name()) != OVERLAY_NONE)
+	    target->provide_overlay_symbols(layout, os);
+	}
+    }
+}
+
+// Make an ELF object.
+
+Object*
+Target_propeller::do_make_elf_object(const std::string& name,
+				     Input_file* input_file,
+				     off_t offset,
+				     const elfcpp::Ehdr<32, false>& ehdr)
+{
+  if (ehdr.get_e_type() == elfcpp::ET_REL)
+    {
+      Propeller_relobj* obj =
+	new Propeller_relobj(name, input_file, offset, ehdr);
+      obj->setup();
+      return obj;
+    }
+  return Target::do_make_elf_object(name, input_file, offset, ehdr);
+}
+
+// Define the __load_start_ and __load_stop_ symbols of an overlay as
+// the start and end of its load address, as the GNU linker does.
+// They are only defined if they are referenced.
+
+void
+Target_propeller::provide_overlay_symbols(Layout* layout,
+					  const Output_section* os)
+{
+  if (!this->provided_overlays_.insert(os).second)
+    return;
+
+  Script_options* script_options = layout->script_options();
+  const char* name = os->name();
+  size_t namelen = strlen(name);
+  std::string symname = propeller_overlay_symbol_name(name);
+
+  std::string start = "__load_start_" + symname;
+  if (!script_options->is_pending_assignment(start.c_str()))
+    script_options->add_symbol_assignment(
+	start.c_str(), start.length(), false,
+	script_exp_function_loadaddr(name, namelen), true, false);
+
+  std::string stop = "__load_stop_" + symname;
+  if (!script_options->is_pending_assignment(stop.c_str()))
+    script_options->add_symbol_assignment(
+	stop.c_str(), stop.length(), false,
+	script_exp_binary_add(script_exp_function_loadaddr(name, namelen),
+			      script_exp_function_sizeof(name, namelen)),
+	true, false);
+}
+
+// Mark a new output section holding a cog overlay as cog data, which
+// the loader copies into a cog.
+
+void
+Target_propeller::do_new_output_section(Output_section* os) const
+{
+  Propeller_overlay overlay = propeller_overlay(os->name());
+  if (overlay == OVERLAY_COG || overlay == OVERLAY_KEREXT)
+    os->set_flags(os->flags() | elfcpp::SHF_PROPELLER_COGDATA);
+}
+
+// Return the output section in the linker script which an overlay
+// follows.
+
+const char*
+Target_propeller::do_orphan_section_follows(const Output_section* os) const
+{
+  switch (propeller_overlay(os->name()))
+    {
+    case OVERLAY_COG:
+      return ".text";
+    case OVERLAY_ECOG:
+      return ".drivers";
+    case OVERLAY_KEREXT:
+      return ".hub";
+    case OVERLAY_NONE:
+    default:
+      return NULL;
+    }
+}
+
+// An overlay runs at the start of the coguser or kerextmem memory
+// region of the linker script.  Without the region it runs where it
+// is loaded.
+
+bool
+Target_propeller::do_orphan_run_address(const Output_section* os,
+					Symbol_table* symtab,
+					Layout* layout,
+					uint64_t* address) const
+{
+  Propeller_overlay overlay = propeller_overlay(os->name());
+  if (overlay == OVERLAY_NONE)
+    return false;
+
+  const char* region = (overlay == OVERLAY_KEREXT ? "kerextmem" : "coguser");
+  Script_sections* ss = layout->script_options()->script_sections();
+  Expression* origin = ss->find_memory_region_origin(region, strlen(region));
+  if (origin == NULL)
+    return false;
+  *address = origin->eval(symtab, layout, false);
+  return true;
+}
+
+// Keep the overlays named by a __load_start_ or __load_stop_ symbol
+// which is undefined on the command line.
+
+void
+Target_propeller::do_gc_mark_symbol(Symbol_table* symtab, Symbol* sym) const
+{
+  const char* suffix = propeller_overlay_symbol_suffix(sym->name());
+  if (suffix == NULL)
+    return;
+  Overlay_sections::const_iterator p = this->overlay_sections_.find(suffix);
+  if (p == this->overlay_sections_.end())
+    return;
+  for (std::vector<Section_id>::const_iterator q = p->second.begin();
+       q != p->second.end();
+       ++q)
+    symtab->gc()->worklist().push_back(*q);
+}
+
+// Report an unsupported relocation against a local symbol.
+
+void
+Target_propeller::Scan::unsupported_reloc_local(
+    Sized_relobj_file<32, false>* object,
+    unsigned int r_type)
+{
+  gold_error(_("%s: unsupported reloc %u against local symbol"),
+	     object->name().c_str(), r_type);
+}
+
+// Report an unsupported relocation against a global symbol.
+
+void
+Target_propeller::Scan::unsupported_reloc_global(
+    Sized_relobj_file<32, false>* object,
+    unsigned int r_type,
+    Symbol* gsym)
+{
+  gold_error(_("%s: unsupported reloc %u against global symbol %s"),
+	     object->name().c_str(), r_type, gsym->demangled_name().c_str());
+}
+
+// Scan a relocation for a local symbol.  There is nothing to set up:
+// every relocation is resolved statically.
+
+inline void
+Target_propeller::Scan::local(Symbol_table*,
+			      Layout*,
+			      Target_propeller*,
+			      Sized_relobj_file<32, false>* object,
+			      unsigned int,
+			      Output_section*,
+			      const elfcpp::Rela<32, false>&,
+			      unsigned int r_type,
+			      const elfcpp::Sym<32, false>&,
+			      bool is_discarded)
+{
+  if (is_discarded)
+    return;
+
+  if (!is_supported(r_type))
+    unsupported_reloc_local(object, r_type);
+}
+
+// Scan a relocation for a global symbol.
+
+inline void
+Target_propeller::Scan::global(Symbol_table*,
+			       Layout*,
+			       Target_propeller*,
+			       Sized_relobj_file<32, false>* object,
+			       unsigned int,
+			       Output_section*,
+			       const elfcpp::Rela<32, false>&,
+			       unsigned int r_type,
+			       Symbol* gsym)
+{
+  if (!is_supported(r_type))
+    unsupported_reloc_global(object, r_type, gsym);
+}
+
+// Process relocations for gc.  A reference to the __load_start_ or
+// __load_stop_ symbol of an overlay keeps the overlay: it is the only
+// reference the code which starts a cog ever makes to it.
+
+void
+Target_propeller::gc_process_relocs(Symbol_table* symtab,
+				    Layout* layout,
+				    Sized_relobj_file<32, false>* object,
+				    unsigned int data_shndx,
+				    unsigned int sh_type,
+				    const unsigned char* prelocs,
+				    size_t reloc_count,
+				    Output_section* output_section,
+				    bool needs_special_offset_handling,
+				    size_t local_symbol_count,
+				    const unsigned char* plocal_symbols)
+{
+  typedef gold::Default_classify_reloc<elfcpp::SHT_RELA, 32, false>
+      Classify_reloc;
+
+  if (sh_type == elfcpp::SHT_REL)
+    return;
+
+  gold::gc_process_relocs<32, false, Target_propeller, Scan, Classify_reloc>(
+    symtab,
+    layout,
+    this,
+    object,
+    data_shndx,
+    prelocs,
+    reloc_count,
+    output_section,
+    needs_special_offset_handling,
+    local_symbol_count,
+    plocal_symbols);
+
+  if (this->overlay_sections_.empty())
+    return;
+
+  const int reloc_size = elfcpp::Elf_sizes<32>::rela_size;
+  for (size_t i = 0; i < reloc_count; ++i, prelocs += reloc_size)
+    {
+      elfcpp::Rela<32, false> reloc(prelocs);
+      unsigned int r_sym = elfcpp::elf_r_sym<32>(reloc.get_r_info());
+      if (r_sym < local_symbol_count)
+	continue;
+
+      const char* suffix =
+	propeller_overlay_symbol_suffix(object->global_symbol(r_sym)->name());
+      if (suffix == NULL)
+	continue;
+      Overlay_sections::const_iterator p =
+	this->overlay_sections_.find(suffix);
+      if (p == this->overlay_sections_.end())
+	continue;
+      for (std::vector<Section_id>::const_iterator q = p->second.begin();
+	   q != p->second.end();
+	   ++q)
+	symtab->gc()->add_reference(object, data_shndx, q->first, q->second);
+    }
+}
+
+// Scan relocations for a section.
+
+void
+Target_propeller::scan_relocs(Symbol_table* symtab,
+			      Layout* layout,
+			      Sized_relobj_file<32, false>* object,
+			      unsigned int data_shndx,
+			      unsigned int sh_type,
+			      const unsigned char* prelocs,
+			      size_t reloc_count,
+			      Output_section* output_section,
+			      bool needs_special_offset_handling,
+			      size_t local_symbol_count,
+			      const unsigned char* plocal_symbols)
+{
+  typedef gold::Default_classify_reloc<elfcpp::SHT_RELA, 32, false>
+      Classify_reloc;
+
+  if (sh_type == elfcpp::SHT_REL)
+    {
+      gold_error(_("%s: unsupported REL reloc section"),
+		 object->name().c_str());
+      return;
+    }
+
+  gold::scan_relocs<32, false, Target_propeller, Scan, Classify_reloc>(
+    symtab,
+    layout,
+    this,
+    object,
+    data_shndx,
+    prelocs,
+    reloc_count,
+    output_section,
+    needs_special_offset_handling,
+    local_symbol_count,
+    plocal_symbols);
+}
+
+// Merge the e_flags of the input objects.  The machine and the ABI
+// version must agree where they are given; the other flags may only
+// be set by some of the objects unless --no-warn-mismatch.
+
+void
+Target_propeller::merge_e_flags(const Input_objects* input_objects)
+{
+  elfcpp::Elf_Word flags = 0;
+  bool flags_set = false;
+  const elfcpp::Elf_Word fixed = (elfcpp::EF_PROPELLER_MACH
+				  | elfcpp::EF_PROPELLER_ABI_VERS);
+
+  for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
+       p != input_objects->relobj_end();
+       ++p)
+    {
+      if ((*p)->is_dynamic()
+	  || (*p)->input_file()->format() != Input_file::FORMAT_ELF)
+	continue;
+      Propeller_relobj* relobj = static_cast<Propeller_relobj*>(*p);
+      elfcpp::Elf_Word new_flags = relobj->e_flags();
+
+      if (!flags_set)
+	{
+	  flags = new_flags;
+	  flags_set = true;
+	  continue;
+	}
+      if (flags == new_flags)
+	continue;
+
+      elfcpp::Elf_Word old_mach = flags & elfcpp::EF_PROPELLER_MACH;
+      elfcpp::Elf_Word new_mach = new_flags & elfcpp::EF_PROPELLER_MACH;
+      if (old_mach != 0 && new_mach != 0 && old_mach != new_mach)
+	gold_error(_("%s: propeller architecture mismatch: "
+		     "old = 0x%.8x, new = 0x%.8x"),
+		   relobj->name().c_str(), old_mach, new_mach);
+
+      elfcpp::Elf_Word old_ver = flags & elfcpp::EF_PROPELLER_ABI_VERS;
+      elfcpp::Elf_Word new_ver = new_flags & elfcpp::EF_PROPELLER_ABI_VERS;
+      if (old_ver != 0 && new_ver != 0 && old_ver != new_ver)
+	gold_error(_("%s: propeller version mismatch: "
+		     "old = 0x%.8x, new = 0x%.8x"),
+		   relobj->name().c_str(), old_ver, new_ver);
+
+      if ((flags & ~fixed) != 0
+	  && (new_flags & ~fixed) != 0
+	  && parameters->options().warn_mismatch())
+	gold_error(_("%s: ELF header flags mismatch: "
+		     "old_flags = 0x%.8x, new_flags = 0x%.8x"),
+		   relobj->name().c_str(), flags, new_flags);
+      flags |= new_flags;
+    }
+
+  if (flags_set)
+    this->set_processor_specific_flags(flags);
+}
+
+// Finalize the sections.
+
+void
+Target_propeller::do_finalize_sections(Layout* layout,
+				       const Input_objects* input_objects,
+				       Symbol_table*)
+{
+  this->merge_e_flags(input_objects);
+
+  // Only a SECTIONS clause gives the overlays an address apart from
+  // the one they are loaded at.
+  if (!parameters->options().relocatable()
+      && !this->provided_overlays_.empty()
+      && !layout->script_options()->saw_sections_clause())
+    gold_warning(_("cog overlays need a SECTIONS clause in a linker script; "
+		   "they will run where they are loaded"));
+}
+
+// Perform a relocation.
+
+inline bool
+Target_propeller::Relocate::relocate(
+    const Relocate_info<32, false>* relinfo,
+    unsigned int,
+    Target_propeller*,
+    Output_section*,
+    size_t relnum,
+    const unsigned char* preloc,
+    const Sized_symbol<32>* gsym,
+    const Symbol_value<32>* psymval,
+    unsigned char* view,
+    Address address,
+    section_size_type)
+{
+  if (view == NULL)
+    return true;
+
+  typedef Propeller_relocate_functions Reloc;
+
+  const elfcpp::Rela<32, false> rela(preloc);
+  unsigned int r_type = elfcpp::elf_r_type<32>(rela.get_r_info());
+  const elfcpp::Elf_Sword addend = rela.get_r_addend();
+  const Propeller_relobj* object =
+    static_cast<const Propeller_relobj*>(relinfo->object);
+
+  // A label assembled with .cog_ram is the address of a long in the
+  // cog, so an immediate source gets its offset in longs.
+  Address value;
+  Address st_value;
+  if (gsym == NULL
+      && r_type == elfcpp::R_PROPELLER_SRC_IMM
+      && object->cog_ram_value(elfcpp::elf_r_sym<32>(rela.get_r_info()),
+			       &st_value))
+    value = psymval->value(object, 0) - st_value + st_value / 4 + addend;
+  else
+    value = psymval->value(object, addend);
+
+  Reloc::Status status = Reloc::STATUS_OKAY;
+  switch (r_type)
+    {
+    case elfcpp::R_PROPELLER_NONE:
+    case elfcpp::R_PROPELLER_RELAX:
+    case elfcpp::R_PROPELLER_ALIGN:
+      // The relaxation markers do not change the contents.
+      break;
+
+    case elfcpp::R_PROPELLER_DIFF8:
+    case elfcpp::R_PROPELLER_DIFF16:
+    case elfcpp::R_PROPELLER_DIFF32:
+      // The assembler already put the difference in the field, and
+      // gold does not relax the code between the two symbols.
+      break;
+
+    case elfcpp::R_PROPELLER_32:
+      status = Reloc::field<32, 32>(view, value, 0, 0, Reloc::CHECK_NONE);
+      break;
+
+    case elfcpp::R_PROPELLER_23:
+      status = Reloc::rel23(view, value);
+      break;
+
+    case elfcpp::R_PROPELLER_16:
+      status = Reloc::field<16, 16>(view, value, 0, 0, Reloc::CHECK_BITFIELD);
+      break;
+
+    case elfcpp::R_PROPELLER_8:
+      status = Reloc::field<8, 8>(view, value, 0, 0, Reloc::CHECK_BITFIELD);
+      break;
+
+    case elfcpp::R_PROPELLER_SRC_IMM:
+      status = Reloc::field<32, 9>(view, value, 0, 0, Reloc::CHECK_BITFIELD);
+      break;
+
+    case elfcpp::R_PROPELLER_SRC:
+      status = Reloc::field<32, 9>(view, value, 2, 0, Reloc::CHECK_BITFIELD);
+      break;
+
+    case elfcpp::R_PROPELLER_DST:
+      status = Reloc::field<32, 9>(view, value, 2, 9, Reloc::CHECK_BITFIELD);
+      break;
+
+    case elfcpp::R_PROPELLER_DST_IMM:
+      status = Reloc::field<32, 9>(view, value, 0, 9, Reloc::CHECK_BITFIELD);
+      break;
+
+    case elfcpp::R_PROPELLER_32_DIV4:
+      status = Reloc::field<32, 32>(view, value, 2, 0, Reloc::CHECK_NONE);
+      break;
+
+    case elfcpp::R_PROPELLER_16_DIV4:
+      status = Reloc::field<16, 16>(view, value, 2, 0, Reloc::CHECK_BITFIELD);
+      break;
+
+    case elfcpp::R_PROPELLER_8_DIV4:
+      status = Reloc::field<8, 8>(view, value, 2, 0, Reloc::CHECK_BITFIELD);
+      break;
+
+    case elfcpp::R_PROPELLER_PCREL32:
+      status = Reloc::field<32, 32>(view, value - address, 0, 0,
+				    Reloc::CHECK_SIGNED);
+      break;
+
+    case elfcpp::R_PROPELLER_PCREL16:
+      status = Reloc::field<16, 16>(view, value - address, 0, 0,
+				    Reloc::CHECK_SIGNED);
+      break;
+
+    case elfcpp::R_PROPELLER_PCREL8:
+      status = Reloc::field<8, 8>(view, value - address, 0, 0,
+				  Reloc::CHECK_SIGNED);
+      break;
+
+    case elfcpp::R_PROPELLER_PCREL10:
+      status = Reloc::pcrel10(view, value, address);
+      break;
+
+    case elfcpp::R_PROPELLER_REPINSCNT:
+      status = Reloc::repeat_count(view, static_cast<int32_t>(value) - 1);
+      break;
+
+    case elfcpp::R_PROPELLER_REPSREL:
+      // The distance in bytes to the end of the repeated block, as
+      // the assembler resolves it.
+      status = Reloc::repeat_count(view,
+				   (static_cast<int32_t>(value - address) - 1)
+				   >> 2);
+      break;
+
+    case elfcpp::R_PROPELLER_REPS:
+      status = Reloc::reps(view, value);
+      break;
+
+    default:
+      gold_error_at_location(relinfo, relnum, rela.get_r_offset(),
+			     _("unsupported reloc %u"),
+			     r_type);
+      break;
+    }
+
+  if (status == Reloc::STATUS_OVERFLOW)
+    gold_error_at_location(relinfo, relnum, rela.get_r_offset(),
+			   _("relocation overflow"));
+
+  return true;
+}
+
+// Relocate section data.
+
+void
+Target_propeller::relocate_section(
+    const Relocate_info<32, false>* relinfo,
+    unsigned int sh_type,
+    const unsigned char* prelocs,
+    size_t reloc_count,
+    Output_section* output_section,
+    bool needs_special_offset_handling,
+    unsigned char* view,
+    Address address,
+    section_size_type view_size,
+    const Reloc_symbol_changes* reloc_symbol_changes)
+{
+  typedef gold::Default_classify_reloc<elfcpp::SHT_RELA, 32, false>
+      Classify_reloc;
+
+  gold_assert(sh_type == elfcpp::SHT_RELA);
+
+  gold::relocate_section<32, false, Target_propeller, Relocate,
+			 gold::Default_comdat_behavior, Classify_reloc>(
+    relinfo,
+    this,
+    prelocs,
+    reloc_count,
+    output_section,
+    needs_special_offset_handling,
+    view,
+    address,
+    view_size,
+    reloc_symbol_changes);
+}
+
+// Scan the relocs during a relocatable link.
+
+void
+Target_propeller::scan_relocatable_relocs(
+    Symbol_table* symtab,
+    Layout* layout,
+    Sized_relobj_file<32, false>* object,
+    unsigned int data_shndx,
+    unsigned int sh_type,
+    const unsigned char* prelocs,
+    size_t reloc_count,
+    Output_section* output_section,
+    bool needs_special_offset_handling,
+    size_t local_symbol_count,
+    const unsigned char* plocal_symbols,
+    Relocatable_relocs* rr)
+{
+  typedef gold::Default_classify_reloc<elfcpp::SHT_RELA, 32, false>
+      Classify_reloc;
+  typedef gold::Default_scan_relocatable_relocs<Classify_reloc>
+      Scan_relocatable_relocs;
+
+  gold_assert(sh_type == elfcpp::SHT_RELA);
+
+  gold::scan_relocatable_relocs<32, false, Scan_relocatable_relocs>(
+    symtab,
+    layout,
+    object,
+    data_shndx,
+    prelocs,
+    reloc_count,
+    output_section,
+    needs_special_offset_handling,
+    local_symbol_count,
+    plocal_symbols,
+    rr);
+}
+
+// Scan the relocs for --emit-relocs.
+
+void
+Target_propeller::emit_relocs_scan(
+    Symbol_table* symtab,
+    Layout* layout,
+    Sized_relobj_file<32, false>* object,
+    unsigned int data_shndx,
+    unsigned int sh_type,
+    const unsigned char* prelocs,
+    size_t reloc_count,
+    Output_section* output_section,
+    bool needs_special_offset_handling,
+    size_t local_symbol_count,
+    const unsigned char* plocal_syms,
+    Relocatable_relocs* rr)
+{
+  typedef gold::Default_classify_reloc<elfcpp::SHT_RELA, 32, false>
+      Classify_reloc;
+  typedef gold::Default_emit_relocs_strategy<Classify_reloc>
+      Emit_relocs_strategy;
+
+  gold_assert(sh_type == elfcpp::SHT_RELA);
+
+  gold::scan_relocatable_relocs<32, false, Emit_relocs_strategy>(
+    symtab,
+    layout,
+    object,
+    data_shndx,
+    prelocs,
+    reloc_count,
+    output_section,
+    needs_special_offset_handling,
+    local_symbol_count,
+    plocal_syms,
+    rr);
+}
+
+// Relocate a section during a relocatable link.
+
+void
+Target_propeller::relocate_relocs(
+    const Relocate_info<32, false>* relinfo,
+    unsigned int sh_type,
+    const unsigned char* prelocs,
+    size_t reloc_count,
+    Output_section* output_section,
+    elfcpp::Elf_types<32>::Elf_Off offset_in_output_section,
+    unsigned char* view,
+    Address view_address,
+    section_size_type view_size,
+    unsigned char* reloc_view,
+    section_size_type reloc_view_size)
+{
+  typedef gold::Default_classify_reloc<elfcpp::SHT_RELA, 32, false>
+      Classify_reloc;
+
+  gold_assert(sh_type == elfcpp::SHT_RELA);
+
+  gold::relocate_relocs<32, false, Classify_reloc>(
+    relinfo,
+    prelocs,
+    reloc_count,
+    output_section,
+    offset_in_output_section,
+    view,
+    view_address,
+    view_size,
+    reloc_view,
+    reloc_view_size);
+}
+
+// The selector for Propeller object files.
+
+class Target_selector_propeller : public Target_selector
+{
+public:
+  Target_selector_propeller()
+    : Target_selector(elfcpp::EM_PROPELLER, 32, false,
+		      "elf32-propeller", "elf32_propeller")
+  { }
+
+  virtual Target*
+  do_instantiate_target()
+  { return new Target_propeller(); }
+};
+
+Target_selector_propeller target_selector_propeller;
+
+} // End anonymous namespace.
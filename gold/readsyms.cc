@@ -400,6 +400,13 @@ Read_symbols::do_read_symbols(Workqueue* workqueue)
       Read_symbols_data* sd = new Read_symbols_data;
       elf_obj->read_symbols(sd);
 
+      // If the symbols can be added to the symbol table in parallel,
+      // sort them into shards now, while we are reading files in
+      // parallel anyhow.
+      if (this->member_ == NULL
+	  && this->symtab_->can_add_symbols_in_parallel(elf_obj))
+	elf_obj->partition_symbols(sd);
+
       // Opening the file locked it, so now we need to unlock it.  We
       // need to unlock it before queuing the Add_symbols task,
       // because the workqueue doesn't know about our lock on the
@@ -576,6 +583,14 @@ Add_symbols::is_runnable()
     return this->this_blocker_;
   if (this->object_->is_locked())
     return this->object_->token();
+  // If we are going to add all the symbols here, we must wait for
+  // any shards still adding symbols from earlier input files.
+  if (!this->add_in_parallel())
+    {
+      Task_token* token = this->symtab_->add_symbols_blocker();
+      if (token != NULL)
+	return token;
+    }
   return NULL;
 }
 
@@ -591,7 +606,7 @@ Add_symbols::locks(Task_locker* tl)
 // Add the symbols in the object to the symbol table.
 
 void
-Add_symbols::run(Workqueue*)
+Add_symbols::run(Workqueue* workqueue)
 {
   Pluginobj* pluginobj = this->object_->pluginobj();
   if (pluginobj != NULL)
@@ -631,15 +646,173 @@ Add_symbols::run(Workqueue*)
 	  incremental_inputs->report_object(this->object_, arg_serial,
 					    this->library_, script_info);
 	}
+      if (!this->add_in_parallel() && this->sd_ != NULL)
+	this->sd_->shard_starts.clear();
       this->object_->layout(this->symtab_, this->layout_, this->sd_);
       this->object_->add_symbols(this->symtab_, this->sd_, this->layout_);
       this->object_->discard_decompressed_sections();
-      delete this->sd_;
+      if (this->sd_ != NULL && !this->sd_->shard_starts.empty())
+	this->queue_shard_tasks(workqueue);
+      else
+	delete this->sd_;
       this->sd_ = NULL;
       this->object_->release();
     }
 }
 
+// Return whether the symbols will be added by Add_symbols_shard
+// tasks.  Once a dynamic object has recorded weak aliases we stop,
+// since overriding a symbol also overrides its aliases, which may be
+// in other shards.  Nothing else adds weak aliases while we wait to
+// run, so this answer does not change between is_runnable and run.
+
+bool
+Add_symbols::add_in_parallel() const
+{
+  return (this->sd_ != NULL
+	  && !this->sd_->shard_starts.empty()
+	  && this->symtab_->shards_are_independent());
+}
+
+// Queue a task for each symbol table shard which has symbols from
+// this object.  Each task waits for the previous task for the same
+// shard, so that each shard sees symbols in input order.  The
+// Release_symbols_data task takes over SD_.
+
+void
+Add_symbols::queue_shard_tasks(Workqueue* workqueue)
+{
+  const std::vector<unsigned int>& starts(this->sd_->shard_starts);
+
+  int count = 0;
+  for (unsigned int i = 0; i < Symbol_table::shard_count; ++i)
+    if (starts[i] != starts[i + 1])
+      ++count;
+
+  Task_token* done_blocker = new Task_token(true);
+  done_blocker->add_blockers(count);
+
+  for (unsigned int i = 0; i < Symbol_table::shard_count; ++i)
+    {
+      if (starts[i] == starts[i + 1])
+	continue;
+      Task_token* this_blocker = this->symtab_->shard_blocker(i);
+      Task_token* next_blocker = new Task_token(true);
+      next_blocker->add_blocker();
+      this->symtab_->set_shard_blocker(i, next_blocker);
+      workqueue->queue_soon(new Add_symbols_shard(this->symtab_,
+						  this->object_, this->sd_,
+						  i, this_blocker,
+						  next_blocker,
+						  done_blocker));
+    }
+
+  workqueue->queue_soon(new Release_symbols_data(this->object_, this->sd_,
+						 done_blocker));
+}
+
+// Class Add_symbols_shard.
+
+Add_symbols_shard::~Add_symbols_shard()
+{
+  if (this->this_blocker_ != NULL)
+    delete this->this_blocker_;
+  // next_blocker_ is deleted by the next task for this shard, or by
+  // the symbol table.  done_blocker_ is deleted by
+  // Release_symbols_data.
+}
+
+// We are blocked by this_blocker_.  We block next_blocker_ and
+// done_blocker_.
+
+Task_token*
+Add_symbols_shard::is_runnable()
+{
+  if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+    return this->this_blocker_;
+  return NULL;
+}
+
+void
+Add_symbols_shard::locks(Task_locker* tl)
+{
+  tl->add(this, this->next_blocker_);
+  tl->add(this, this->done_blocker_);
+}
+
+void
+Add_symbols_shard::run(Workqueue*)
+{
+  this->object_->add_symbols_shard(this->symtab_, this->sd_, this->shard_);
+}
+
+// Class Release_symbols_data.
+
+Release_symbols_data::~Release_symbols_data()
+{
+  delete this->this_blocker_;
+}
+
+// We are blocked by this_blocker_.  We lock the file, since freeing
+// the views requires it.
+
+Task_token*
+Release_symbols_data::is_runnable()
+{
+  if (this->this_blocker_->is_blocked())
+    return this->this_blocker_;
+  if (this->object_->is_locked())
+    return this->object_->token();
+  return NULL;
+}
+
+void
+Release_symbols_data::locks(Task_locker* tl)
+{
+  Task_token* token = this->object_->token();
+  if (token != NULL)
+    tl->add(this, token);
+}
+
+void
+Release_symbols_data::run(Workqueue*)
+{
+  delete this->sd_;
+  this->sd_ = NULL;
+}
+
+// Class Wait_for_symbols.
+
+Wait_for_symbols::~Wait_for_symbols()
+{
+  if (this->this_blocker_ != NULL)
+    delete this->this_blocker_;
+  // next_blocker_ is deleted by the task which follows.
+}
+
+// We are blocked by this_blocker_ and by any symbol table shard which
+// is still adding symbols.
+
+Task_token*
+Wait_for_symbols::is_runnable()
+{
+  if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+    return this->this_blocker_;
+  return this->symtab_->add_symbols_blocker();
+}
+
+void
+Wait_for_symbols::locks(Task_locker* tl)
+{
+  tl->add(this, this->next_blocker_);
+}
+
+void
+Wait_for_symbols::run(Workqueue*)
+{
+  this->symtab_->finish_adding_symbols();
+}
+
 // Class Read_member.
 
 Read_member::~Read_member()
@@ -786,14 +959,15 @@ Start_group::~Start_group()
   // file in the group.
 }
 
-// We need to wait for THIS_BLOCKER_ and unblock NEXT_BLOCKER_.
+// We need to wait for THIS_BLOCKER_ and for the symbol table shards,
+// and unblock NEXT_BLOCKER_.
 
 Task_token*
 Start_group::is_runnable()
 {
   if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
     return this->this_blocker_;
-  return NULL;
+  return this->symtab_->add_symbols_blocker();
 }
 
 void
@@ -820,14 +994,15 @@ Finish_group::~Finish_group()
   // input file following the group.
 }
 
-// We need to wait for THIS_BLOCKER_ and unblock NEXT_BLOCKER_.
+// We need to wait for THIS_BLOCKER_ and for the symbol table shards,
+// and unblock NEXT_BLOCKER_.
 
 Task_token*
 Finish_group::is_runnable()
 {
   if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
     return this->this_blocker_;
-  return NULL;
+  return this->symtab_->add_symbols_blocker();
 }
 
 void
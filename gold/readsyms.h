@@ -165,6 +165,16 @@ class Add_symbols : public Task
   { return "Add_symbols " + this->object_->name(); }
 
 private:
+  // Whether the symbols of the object will be added by
+  // Add_symbols_shard tasks.
+  bool
+  add_in_parallel() const;
+
+  // Queue the Add_symbols_shard tasks, and the task which frees SD_
+  // after them.
+  void
+  queue_shard_tasks(Workqueue*);
+
   Input_objects* input_objects_;
   Symbol_table* symtab_;
   Layout* layout_;
@@ -176,6 +186,124 @@ private:
   Task_token* next_blocker_;
 };
 
+// This class is used to add the symbols of an object which belong to
+// one symbol table shard.  The tasks for a shard are chained in input
+// order, like Add_symbols tasks, but tasks for different shards may
+// run at the same time.
+
+class Add_symbols_shard : public Task
+{
+ public:
+  // THIS_BLOCKER is used to prevent this task from running before the
+  // previous task for the same shard.  NEXT_BLOCKER is used to prevent
+  // the next task for the shard from running.  DONE_BLOCKER is used
+  // to prevent SD from being freed before all shards are added.
+  Add_symbols_shard(Symbol_table* symtab, Object* object,
+		    Read_symbols_data* sd, unsigned int shard,
+		    Task_token* this_blocker, Task_token* next_blocker,
+		    Task_token* done_blocker)
+    : symtab_(symtab), object_(object), sd_(sd), shard_(shard),
+      this_blocker_(this_blocker), next_blocker_(next_blocker),
+      done_blocker_(done_blocker)
+  { }
+
+  ~Add_symbols_shard();
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return "Add_symbols_shard " + this->object_->name(); }
+
+ private:
+  Symbol_table* symtab_;
+  Object* object_;
+  Read_symbols_data* sd_;
+  unsigned int shard_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+  Task_token* done_blocker_;
+};
+
+// This class frees the symbol data of an object once all the
+// Add_symbols_shard tasks for the object have run.
+
+class Release_symbols_data : public Task
+{
+ public:
+  Release_symbols_data(Object* object, Read_symbols_data* sd,
+		       Task_token* this_blocker)
+    : object_(object), sd_(sd), this_blocker_(this_blocker)
+  { }
+
+  ~Release_symbols_data();
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return "Release_symbols_data " + this->object_->name(); }
+
+ private:
+  Object* object_;
+  Read_symbols_data* sd_;
+  Task_token* this_blocker_;
+};
+
+// This class waits until all the input symbols have been added to the
+// symbol table.  It is queued after the tasks for the last input
+// file.
+
+class Wait_for_symbols : public Task
+{
+ public:
+  Wait_for_symbols(Symbol_table* symtab, Task_token* this_blocker,
+		   Task_token* next_blocker)
+    : symtab_(symtab), this_blocker_(this_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  ~Wait_for_symbols();
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return "Wait_for_symbols"; }
+
+ private:
+  Symbol_table* symtab_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
 // This Task is responsible for reading the symbols from an archive
 // member that has changed since the last incremental link.
 
@@ -37,6 +37,7 @@
 #include "script-c.h"
 #include "script.h"
 #include "script-sections.h"
+#include "target.h"
 
 // Support for the SECTIONS clause in linker scripts.
 
@@ -356,8 +357,14 @@ class Orphan_section_placement
   void
   initialize_place(Place_index, const char*);
 
+  // Map from the name of an output section in the linker script to
+  // its location, for orphans which the target places by name.
+  typedef std::map<std::string, Elements_iterator> Named_places;
+
   // The places.
   Place places_[PLACE_MAX];
+  // The named places.
+  Named_places named_places_;
   // True if this is the first call to output_section_init.
   bool first_init_;
 };
@@ -365,7 +372,7 @@ class Orphan_section_placement
 // Initialize Orphan_section_placement.
 
 Orphan_section_placement::Orphan_section_placement()
-  : first_init_(true)
+  : named_places_(), first_init_(true)
 {
   this->initialize_place(PLACE_TEXT, ".text");
   this->initialize_place(PLACE_RODATA, ".rodata");
@@ -402,6 +409,8 @@ Orphan_section_placement::output_section_init(const std::string& name,
   bool first_init = this->first_init_;
   this->first_init_ = false;
 
+  this->named_places_.insert(std::make_pair(name, location));
+
   // Remember the last allocated section. Any orphan bss sections
   // will be placed after it.
   if (os != NULL
@@ -479,6 +488,18 @@ bool
 Orphan_section_placement::find_place(Output_section* os,
 				     Elements_iterator** pwhere)
 {
+  // The target may name the output section which OS should follow.
+  const char* follows = parameters->target().orphan_section_follows(os);
+  if (follows != NULL)
+    {
+      Named_places::iterator p = this->named_places_.find(follows);
+      if (p != this->named_places_.end())
+	{
+	  *pwhere = &p->second;
+	  return true;
+	}
+    }
+
   // Figure out where OS should go.  This is based on the GNU linker
   // code.  FIXME: The GNU linker handles small data sections
   // specially, but we don't.
@@ -2347,6 +2368,37 @@ Script_sections::block_in_region(Symbol_table* symtab, Layout* layout,
   return false;
 }
 
+// Advance the memory region whose next free address is FROM, and
+// which some section has already used, so that it starts at TO.  This
+// is used for an orphan which is loaded in the region but runs
+// elsewhere, so that the sections which follow are not loaded on top
+// of it.
+
+void
+Script_sections::advance_memory_region(const Symbol_table* symtab,
+				       const Layout* layout,
+				       uint64_t from, uint64_t to)
+{
+  if (this->memory_regions_ == NULL || to <= from)
+    return;
+
+  for (Memory_regions::const_iterator mr = this->memory_regions_->begin();
+       mr != this->memory_regions_->end();
+       ++mr)
+    {
+      if ((*mr)->get_last_section() == NULL)
+	continue;
+      uint64_t current =
+	(*mr)->get_current_address()->eval(symtab, layout, false);
+      if (current == from)
+	{
+	  (*mr)->increment_offset((*mr)->get_last_section()->get_section_name(),
+				  to - from, symtab, layout);
+	  return;
+	}
+    }
+}
+
 // Find a memory region that should be used by a given output SECTION.
 // If provided set PREVIOUS_SECTION_RETURN to point to the last section
 // that used the return memory region.
@@ -3034,7 +3086,8 @@ class Orphan_output_section : public Sections_element
 // Set section addresses.
 
 void
-Orphan_output_section::set_section_addresses(Symbol_table*, Layout*,
+Orphan_output_section::set_section_addresses(Symbol_table* symtab,
+					     Layout* layout,
 					     uint64_t* dot_value,
 					     uint64_t*,
                                              uint64_t* load_address)
@@ -3066,6 +3119,22 @@ Orphan_output_section::set_section_addresses(Symbol_table*, Layout*,
       have_load_address = false;
     }
 
+  // The target may want the section to run somewhere other than
+  // where it is loaded.  It is loaded after the preceding section.
+  uint64_t run_address;
+  uint64_t old_load_address = *load_address;
+  bool is_overlay = false;
+  if (!parameters->options().relocatable()
+      && (this->os_->flags() & elfcpp::SHF_ALLOC) != 0
+      && parameters->target().orphan_run_address(this->os_, symtab, layout,
+						 &run_address))
+    {
+      is_overlay = true;
+      address = align_address(run_address, this->os_->addralign());
+      *dot_value = address;
+      have_load_address = true;
+    }
+
   if ((this->os_->flags() & elfcpp::SHF_ALLOC) != 0)
     {
       this->os_->set_address(address);
@@ -3103,6 +3172,14 @@ Orphan_output_section::set_section_addresses(Symbol_table*, Layout*,
       // An SHF_TLS/SHT_NOBITS section does not take up any address space.
       if (!have_load_address)
 	*load_address = address;
+      else if (is_overlay)
+	{
+	  uint64_t load_start = align_address(*load_address,
+					      this->os_->addralign());
+	  *load_address = load_start + (address - *dot_value);
+	  layout->script_options()->script_sections()->advance_memory_region(
+	      symtab, layout, old_load_address, *load_address);
+	}
       else
 	*load_address += address - *dot_value;
 
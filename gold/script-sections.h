@@ -250,6 +250,12 @@ class Script_sections
   // within a memory region.
   bool
   block_in_region(Symbol_table*, Layout*, uint64_t, uint64_t) const;
+
+  // Advance the memory region whose next free address is FROM so
+  // that it starts at TO.
+  void
+  advance_memory_region(const Symbol_table*, const Layout*,
+			uint64_t from, uint64_t to);
     
   // Set the memory region of the section.
   void
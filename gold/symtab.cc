@@ -562,19 +562,152 @@ Symbol::set_undefined()
 
 // Class Symbol_table.
 
+const unsigned int Symbol_table::shard_count;
+
 Symbol_table::Symbol_table(unsigned int count,
                            const Version_script_info& version_script)
-  : saw_undefined_(0), offset_(0), table_(count), namepool_(),
-    forwarders_(), commons_(), tls_commons_(), small_commons_(),
-    large_commons_(), forced_locals_(), warnings_(),
-    version_script_(version_script), gc_(NULL), icf_(NULL),
-    target_symbols_()
+  : offset_(0), shards_(), add_in_parallel_(false), forwarders_(),
+    forwarders_lock_(NULL), commons_(), tls_commons_(), small_commons_(),
+    large_commons_(), deferred_gc_marks_(), deferred_gc_marks_lock_(NULL),
+    defer_gc_marks_(false), warnings_(), version_script_(version_script),
+    gc_(NULL), icf_(NULL), target_symbols_()
 {
-  namepool_.reserve(count);
+  // Adding symbols in parallel is only done when the result can not
+  // depend on the order in which symbols of different names are
+  // seen.  Plugins, --wrap and --detect-odr-violations all look at
+  // or change symbols other than the one being added; -r and
+  // incremental links need the layout to see the symbol table while
+  // the files are being read.
+  const General_options& options(parameters->options());
+  this->add_in_parallel_ = (options.threads()
+			    && !options.has_plugins()
+			    && !options.relocatable()
+			    && !options.any_wrap()
+			    && !options.detect_odr_violations()
+			    && !parameters->incremental());
+
+  this->shards_.reserve(shard_count);
+  for (unsigned int i = 0; i < shard_count; ++i)
+    this->shards_.push_back(new Symbol_table_shard(count / shard_count,
+						   this->add_in_parallel_));
+
+  if (this->add_in_parallel_)
+    {
+      this->forwarders_lock_ = new Lock();
+      this->deferred_gc_marks_lock_ = new Lock();
+      this->defer_gc_marks_ = true;
+    }
 }
 
 Symbol_table::~Symbol_table()
 {
+  for (unsigned int i = 0; i < shard_count; ++i)
+    delete this->shards_[i];
+  delete this->forwarders_lock_;
+  delete this->deferred_gc_marks_lock_;
+}
+
+// Class Symbol_table::Symbol_table_shard.
+
+Symbol_table::Symbol_table_shard::Symbol_table_shard(unsigned int count,
+						     bool threaded)
+  : lock(NULL), table(count), namepool(), saw_undefined(0), commons(),
+    tls_commons(), small_commons(), large_commons(), forced_locals(),
+    add_symbols_blocker(NULL)
+{
+  if (threaded)
+    this->lock = new Lock();
+  this->namepool.reserve(count);
+}
+
+Symbol_table::Symbol_table_shard::~Symbol_table_shard()
+{
+  delete this->lock;
+  // The last token in the chain of tasks for this shard is not
+  // deleted by any task.
+  delete this->add_symbols_blocker;
+}
+
+// Return the shard for a symbol name.  The low bits of the string
+// hash are not well mixed for short names, so fold in the high bits.
+
+unsigned int
+Symbol_table::shard_for_name(const char* name, size_t len)
+{
+  size_t h = gold::string_hash<char>(name, len);
+  h ^= (h >> 11) ^ (h >> 23);
+  return h % shard_count;
+}
+
+// Return whether the symbols of OBJECT may be added in parallel.
+// Target hooks which make or resolve symbols may keep state which is
+// not locked, and adding a dynamic object records weak aliases which
+// may span shards.  This is called while reading the object,
+// so it must not look at anything which changes as symbols are added.
+
+bool
+Symbol_table::can_add_symbols_in_parallel(const Object* object) const
+{
+  return (this->add_in_parallel_
+	  && !object->is_dynamic()
+	  && !object->just_symbols()
+	  && !parameters->target().has_make_symbol()
+	  && !parameters->target().has_resolve());
+}
+
+// Return a token which is blocked while any shard is still having
+// symbols added.
+
+Task_token*
+Symbol_table::add_symbols_blocker() const
+{
+  for (unsigned int i = 0; i < shard_count; ++i)
+    {
+      Task_token* token = this->shards_[i]->add_symbols_blocker;
+      if (token != NULL && token->is_blocked())
+	return token;
+    }
+  return NULL;
+}
+
+// Called when all the input symbols have been added.  Queue the
+// garbage collection marks we deferred while adding symbols in
+// parallel.
+
+void
+Symbol_table::finish_adding_symbols()
+{
+  if (!this->defer_gc_marks_)
+    return;
+  this->defer_gc_marks_ = false;
+  for (std::vector<Symbol*>::const_iterator p =
+	 this->deferred_gc_marks_.begin();
+       p != this->deferred_gc_marks_.end();
+       ++p)
+    this->gc_mark_symbol(*p);
+  this->deferred_gc_marks_.clear();
+}
+
+// Return the count of undefined symbols seen.  This is only used by
+// archive groups, which wait until all the shards are up to date.
+
+size_t
+Symbol_table::saw_undefined() const
+{
+  size_t count = 0;
+  for (unsigned int i = 0; i < shard_count; ++i)
+    count += this->shards_[i]->saw_undefined;
+  return count;
+}
+
+// Canonicalize a symbol name for use in the hash table.
+
+const char*
+Symbol_table::canonicalize_name(const char* name)
+{
+  Symbol_table_shard* shard = this->shard_for(name);
+  Hold_optional_lock hl(shard->lock);
+  return shard->namepool.add(name, true, NULL);
 }
 
 // The symbol table key equality function.  This is called with
@@ -650,6 +783,13 @@ Symbol_table::gc_mark_undef_symbols(Layout* layout)
 void
 Symbol_table::gc_mark_symbol(Symbol* sym)
 {
+  if (this->defer_gc_marks_)
+    {
+      Hold_lock hl(*this->deferred_gc_marks_lock_);
+      this->deferred_gc_marks_.push_back(sym);
+      return;
+    }
+
   // Add the object and section to the work list.
   bool is_ordinary;
   unsigned int shndx = sym->shndx(&is_ordinary);
@@ -679,6 +819,7 @@ Symbol_table::make_forwarder(Symbol* from, Symbol* to)
 {
   gold_assert(from != to);
   gold_assert(!from->is_forwarder() && !to->is_forwarder());
+  Hold_optional_lock hl(this->forwarders_lock_);
   this->forwarders_[from] = to;
   from->set_forwarder();
 }
@@ -700,22 +841,25 @@ Symbol_table::resolve_forwards(const Symbol* from) const
 Symbol*
 Symbol_table::lookup(const char* name, const char* version) const
 {
+  const Symbol_table_shard* shard = this->shard_for(name);
+  Hold_optional_lock hl(shard->lock);
+
   Stringpool::Key name_key;
-  name = this->namepool_.find(name, &name_key);
+  name = shard->namepool.find(name, &name_key);
   if (name == NULL)
     return NULL;
 
   Stringpool::Key version_key = 0;
   if (version != NULL)
     {
-      version = this->namepool_.find(version, &version_key);
+      version = shard->namepool.find(version, &version_key);
       if (version == NULL)
 	return NULL;
     }
 
   Symbol_table_key key(name_key, version_key);
-  Symbol_table::Symbol_table_type::const_iterator p = this->table_.find(key);
-  if (p == this->table_.end())
+  Symbol_table::Symbol_table_type::const_iterator p = shard->table.find(key);
+  if (p == shard->table.end())
     return NULL;
   return p->second;
 }
@@ -763,15 +907,16 @@ Symbol_table::force_local(Symbol* sym)
       return;
     }
   sym->set_is_forced_local();
-  this->forced_locals_.push_back(sym);
+  this->shard_for(sym->name())->forced_locals.push_back(sym);
 }
 
-// Adjust NAME for wrapping, and update *NAME_KEY if necessary.  This
-// is only called for undefined symbols, when at least one --wrap
-// option was used.
+// Adjust NAME for wrapping, and update *NAME_KEY and *PSHARD if
+// necessary.  This is only called for undefined symbols, when at
+// least one --wrap option was used.
 
 const char*
-Symbol_table::wrap_symbol(const char* name, Stringpool::Key* name_key)
+Symbol_table::wrap_symbol(const char* name, Stringpool::Key* name_key,
+			  Symbol_table_shard** pshard)
 {
   // For some targets, we need to ignore a specific character when
   // wrapping, and add it back later.
@@ -791,10 +936,11 @@ Symbol_table::wrap_symbol(const char* name, Stringpool::Key* name_key)
       s += "__wrap_";
       s += name;
 
-      // This will give us both the old and new name in NAMEPOOL_, but
-      // that is OK.  Only the versions we need will wind up in the
-      // real string table in the output file.
-      return this->namepool_.add(s.c_str(), true, name_key);
+      // This will give us both the old and new name in the string
+      // pools, but that is OK.  Only the versions we need will wind
+      // up in the real string table in the output file.
+      *pshard = this->shard_for(s.c_str());
+      return (*pshard)->namepool.add(s.c_str(), true, name_key);
     }
 
   const char* const real_prefix = "__real_";
@@ -807,7 +953,8 @@ Symbol_table::wrap_symbol(const char* name, Stringpool::Key* name_key)
       if (prefix != '\0')
 	s += prefix;
       s += name + real_prefix_length;
-      return this->namepool_.add(s.c_str(), true, name_key);
+      *pshard = this->shard_for(s.c_str());
+      return (*pshard)->namepool.add(s.c_str(), true, name_key);
     }
 
   return name;
@@ -898,7 +1045,8 @@ Symbol_table::define_default_version(Sized_symbol<size>* sym,
 }
 
 // Add one symbol from OBJECT to the symbol table.  NAME is symbol
-// name and VERSION is the version; both are canonicalized.  DEF is
+// name and VERSION is the version; both are canonicalized in the
+// string pool of SHARD, which is the shard for NAME.  DEF is
 // whether this is the default version.  ST_SHNDX is the symbol's
 // section index; IS_ORDINARY is whether this is a normal section
 // rather than a special code.
@@ -929,7 +1077,8 @@ Symbol_table::define_default_version(Sized_symbol<size>* sym,
 
 template<int size, bool big_endian>
 Sized_symbol<size>*
-Symbol_table::add_from_object(Object* object,
+Symbol_table::add_from_object(Symbol_table_shard* shard,
+			      Object* object,
 			      const char* name,
 			      Stringpool::Key name_key,
 			      const char* version,
@@ -938,7 +1087,8 @@ Symbol_table::add_from_object(Object* object,
 			      const elfcpp::Sym<size, big_endian>& sym,
 			      unsigned int st_shndx,
 			      bool is_ordinary,
-			      unsigned int orig_st_shndx)
+			      unsigned int orig_st_shndx,
+			      unsigned int symndx)
 {
   // Print a message if this symbol is being traced.
   if (parameters->options().is_trace_symbol(name))
@@ -954,7 +1104,7 @@ Symbol_table::add_from_object(Object* object,
   if (orig_st_shndx == elfcpp::SHN_UNDEF
       && parameters->options().any_wrap())
     {
-      const char* wrap_name = this->wrap_symbol(name, &name_key);
+      const char* wrap_name = this->wrap_symbol(name, &name_key, &shard);
       if (wrap_name != name)
 	{
 	  // If we see a reference to malloc with version GLIBC_2.0,
@@ -970,15 +1120,15 @@ Symbol_table::add_from_object(Object* object,
 
   Symbol* const snull = NULL;
   std::pair<typename Symbol_table_type::iterator, bool> ins =
-    this->table_.insert(std::make_pair(std::make_pair(name_key, version_key),
+    shard->table.insert(std::make_pair(std::make_pair(name_key, version_key),
 				       snull));
 
   std::pair<typename Symbol_table_type::iterator, bool> insdefault =
-    std::make_pair(this->table_.end(), false);
+    std::make_pair(shard->table.end(), false);
   if (is_default_version)
     {
       const Stringpool::Key vnull_key = 0;
-      insdefault = this->table_.insert(std::make_pair(std::make_pair(name_key,
+      insdefault = shard->table.insert(std::make_pair(std::make_pair(name_key,
 								     vnull_key),
 						      snull));
     }
@@ -1033,7 +1183,7 @@ Symbol_table::add_from_object(Object* object,
 	      // (See PR gold/18703.)
 	      ret->set_is_not_default();
 	      const Stringpool::Key vnull_key = 0;
-	      this->table_.erase(std::make_pair(name_key, vnull_key));
+	      shard->table.erase(std::make_pair(name_key, vnull_key));
 	    }
 	}
     }
@@ -1076,12 +1226,12 @@ Symbol_table::add_from_object(Object* object,
 		  // This means that we don't want a symbol table
 		  // entry after all.
 		  if (!is_default_version)
-		    this->table_.erase(ins.first);
+		    shard->table.erase(ins.first);
 		  else
 		    {
-		      this->table_.erase(insdefault.first);
+		      shard->table.erase(insdefault.first);
 		      // Inserting INSDEFAULT invalidated INS.
-		      this->table_.erase(std::make_pair(name_key,
+		      shard->table.erase(std::make_pair(name_key,
 							version_key));
 		    }
 		  return NULL;
@@ -1108,7 +1258,7 @@ Symbol_table::add_from_object(Object* object,
   // archive groups.
   if (!was_undefined && ret->is_undefined())
     {
-      ++this->saw_undefined_;
+      ++shard->saw_undefined;
       if (parameters->options().has_plugins())
 	parameters->options().plugins()->new_undefined_symbol(ret);
     }
@@ -1116,19 +1266,25 @@ Symbol_table::add_from_object(Object* object,
   // Keep track of common symbols, to speed up common symbol
   // allocation.  Don't record commons from plugin objects;
   // we need to wait until we see the real symbol in the
-  // replacement file.
+  // replacement file.  The shards may be filled in parallel, so
+  // record where in the input we saw each symbol; gather_commons uses
+  // that to put the commons back in input order.
   if (!was_common && ret->is_common() && ret->object()->pluginobj() == NULL)
     {
+      std::pair<uint64_t, Symbol*> common(((static_cast<uint64_t>(
+					      object->input_order()) << 32)
+					    | symndx),
+					   ret);
       if (ret->type() == elfcpp::STT_TLS)
-	this->tls_commons_.push_back(ret);
+	shard->tls_commons.push_back(common);
       else if (!is_ordinary
 	       && st_shndx == parameters->target().small_common_shndx())
-	this->small_commons_.push_back(ret);
+	shard->small_commons.push_back(common);
       else if (!is_ordinary
 	       && st_shndx == parameters->target().large_common_shndx())
-	this->large_commons_.push_back(ret);
+	shard->large_commons.push_back(common);
       else
-	this->commons_.push_back(ret);
+	shard->commons.push_back(common);
     }
 
   // If we're not doing a relocatable link, then any symbol with
@@ -1162,194 +1318,241 @@ Symbol_table::add_from_relobj(
 
   gold_assert(size == parameters->target().get_size());
 
-  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
-
   const bool just_symbols = relobj->just_symbols();
 
-  const unsigned char* p = syms;
-  for (size_t i = 0; i < count; ++i, p += sym_size)
+  for (size_t i = 0; i < count; ++i)
     {
       (*sympointers)[i] = NULL;
+      if (this->add_one_from_relobj(relobj, syms, i, symndx_offset,
+				    sym_names, sym_name_size, just_symbols,
+				    sympointers))
+	++*defined;
+    }
+}
 
-      elfcpp::Sym<size, big_endian> sym(p);
+// Add the symbols in a relocatable object which belong to one shard.
+// This is called by an Add_symbols_shard task, which may run at the
+// same time as tasks for other shards.  The tasks for each shard are
+// run in input order, so each shard sees its symbols in the same
+// order as it would in a serial link.
 
-      unsigned int st_name = sym.get_st_name();
-      if (st_name >= sym_name_size)
-	{
-	  relobj->error(_("bad global symbol name offset %u at %zu"),
-			st_name, i);
-	  continue;
-	}
+template<int size, bool big_endian>
+void
+Symbol_table::add_from_relobj_shard(
+    Sized_relobj_file<size, big_endian>* relobj,
+    const unsigned char* syms,
+    size_t symndx_offset,
+    const char* sym_names,
+    size_t sym_name_size,
+    typename Sized_relobj_file<size, big_endian>::Symbols* sympointers,
+    unsigned int shard,
+    const unsigned int* begin,
+    const unsigned int* end)
+{
+  gold_assert(size == parameters->target().get_size());
+  gold_assert(!relobj->just_symbols());
 
-      const char* name = sym_names + st_name;
+  Hold_optional_lock hl(this->shards_[shard]->lock);
+  for (const unsigned int* p = begin; p != end; ++p)
+    this->add_one_from_relobj(relobj, syms, *p, symndx_offset, sym_names,
+			      sym_name_size, false, sympointers);
+}
 
-      if (!parameters->options().relocatable()
-	  && strcmp (name, "__gnu_lto_slim") == 0)
-        gold_info(_("%s: plugin needed to handle lto object"),
-		  relobj->name().c_str());
+// Add symbol I of a relocatable object to the hash table.  Return
+// whether the symbol is defined.
 
-      bool is_ordinary;
-      unsigned int st_shndx = relobj->adjust_sym_shndx(i + symndx_offset,
-						       sym.get_st_shndx(),
-						       &is_ordinary);
-      unsigned int orig_st_shndx = st_shndx;
-      if (!is_ordinary)
-	orig_st_shndx = elfcpp::SHN_UNDEF;
+template<int size, bool big_endian>
+bool
+Symbol_table::add_one_from_relobj(
+    Sized_relobj_file<size, big_endian>* relobj,
+    const unsigned char* syms,
+    size_t i,
+    size_t symndx_offset,
+    const char* sym_names,
+    size_t sym_name_size,
+    bool just_symbols,
+    typename Sized_relobj_file<size, big_endian>::Symbols* sympointers)
+{
+  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
+  const unsigned char* p = syms + i * sym_size;
 
-      if (st_shndx != elfcpp::SHN_UNDEF)
-	++*defined;
+  elfcpp::Sym<size, big_endian> sym(p);
 
-      // A symbol defined in a section which we are not including must
-      // be treated as an undefined symbol.
-      bool is_defined_in_discarded_section = false;
-      if (st_shndx != elfcpp::SHN_UNDEF
-	  && is_ordinary
-	  && !relobj->is_section_included(st_shndx)
-          && !this->is_section_folded(relobj, st_shndx))
-	{
-	  st_shndx = elfcpp::SHN_UNDEF;
-	  is_defined_in_discarded_section = true;
-	}
+  unsigned int st_name = sym.get_st_name();
+  if (st_name >= sym_name_size)
+    {
+      relobj->error(_("bad global symbol name offset %u at %zu"),
+		    st_name, i);
+      return false;
+    }
+
+  const char* name = sym_names + st_name;
+
+  if (!parameters->options().relocatable()
+      && strcmp (name, "__gnu_lto_slim") == 0)
+    gold_info(_("%s: plugin needed to handle lto object"),
+	      relobj->name().c_str());
+
+  bool is_ordinary;
+  unsigned int st_shndx = relobj->adjust_sym_shndx(i + symndx_offset,
+						   sym.get_st_shndx(),
+						   &is_ordinary);
+  unsigned int orig_st_shndx = st_shndx;
+  if (!is_ordinary)
+    orig_st_shndx = elfcpp::SHN_UNDEF;
+
+  const bool is_defined = st_shndx != elfcpp::SHN_UNDEF;
+
+  // A symbol defined in a section which we are not including must
+  // be treated as an undefined symbol.
+  bool is_defined_in_discarded_section = false;
+  if (st_shndx != elfcpp::SHN_UNDEF
+      && is_ordinary
+      && !relobj->is_section_included(st_shndx)
+      && !this->is_section_folded(relobj, st_shndx))
+    {
+      st_shndx = elfcpp::SHN_UNDEF;
+      is_defined_in_discarded_section = true;
+    }
+
+  // In an object file, an '@' in the name separates the symbol
+  // name from the version name.  If there are two '@' characters,
+  // this is the default version.
+  const char* ver = strchr(name, '@');
+  Stringpool::Key ver_key = 0;
+  int namelen = ver != NULL ? ver - name : strlen(name);
+  // IS_DEFAULT_VERSION: is the version default?
+  // IS_FORCED_LOCAL: is the symbol forced local?
+  bool is_default_version = false;
+  bool is_forced_local = false;
 
-      // In an object file, an '@' in the name separates the symbol
-      // name from the version name.  If there are two '@' characters,
-      // this is the default version.
-      const char* ver = strchr(name, '@');
-      Stringpool::Key ver_key = 0;
-      int namelen = 0;
-      // IS_DEFAULT_VERSION: is the version default?
-      // IS_FORCED_LOCAL: is the symbol forced local?
-      bool is_default_version = false;
-      bool is_forced_local = false;
-
-      // FIXME: For incremental links, we don't store version information,
-      // so we need to ignore version symbols for now.
-      if (parameters->incremental_update() && ver != NULL)
+  // FIXME: For incremental links, we don't store version information,
+  // so we need to ignore version symbols for now.
+  if (parameters->incremental_update() && ver != NULL)
+    ver = NULL;
+
+  // The version, if any, is kept in the same shard as the name.
+  Symbol_table_shard* shard = this->shards_[shard_for_name(name, namelen)];
+
+  if (ver != NULL)
+    {
+      // The symbol name is of the form foo@VERSION or foo@@VERSION
+      ++ver;
+      if (*ver == '@')
 	{
-	  namelen = ver - name;
-	  ver = NULL;
+	  is_default_version = true;
+	  ++ver;
 	}
-
-      if (ver != NULL)
-        {
-          // The symbol name is of the form foo@VERSION or foo@@VERSION
-          namelen = ver - name;
-          ++ver;
-	  if (*ver == '@')
-	    {
-	      is_default_version = true;
-	      ++ver;
-	    }
-	  ver = this->namepool_.add(ver, true, &ver_key);
-        }
-      // We don't want to assign a version to an undefined symbol,
-      // even if it is listed in the version script.  FIXME: What
-      // about a common symbol?
-      else
+      ver = shard->namepool.add(ver, true, &ver_key);
+    }
+  // We don't want to assign a version to an undefined symbol,
+  // even if it is listed in the version script.  FIXME: What
+  // about a common symbol?
+  else
+    {
+      if (!this->version_script_.empty()
+	  && st_shndx != elfcpp::SHN_UNDEF)
 	{
-	  namelen = strlen(name);
-	  if (!this->version_script_.empty()
-	      && st_shndx != elfcpp::SHN_UNDEF)
+	  // The symbol name did not have a version, but the
+	  // version script may assign a version anyway.
+	  std::string version;
+	  bool is_global;
+	  if (this->version_script_.get_symbol_version(name, &version,
+						       &is_global))
 	    {
-	      // The symbol name did not have a version, but the
-	      // version script may assign a version anyway.
-	      std::string version;
-	      bool is_global;
-	      if (this->version_script_.get_symbol_version(name, &version,
-							   &is_global))
+	      if (!is_global)
+		is_forced_local = true;
+	      else if (!version.empty())
 		{
-		  if (!is_global)
-		    is_forced_local = true;
-		  else if (!version.empty())
-		    {
-		      ver = this->namepool_.add_with_length(version.c_str(),
-							    version.length(),
-							    true,
-							    &ver_key);
-		      is_default_version = true;
-		    }
+		  ver = shard->namepool.add_with_length(version.c_str(),
+							version.length(),
+							true,
+							&ver_key);
+		  is_default_version = true;
 		}
 	    }
 	}
+    }
 
-      elfcpp::Sym<size, big_endian>* psym = &sym;
-      unsigned char symbuf[sym_size];
-      elfcpp::Sym<size, big_endian> sym2(symbuf);
-      if (just_symbols)
+  elfcpp::Sym<size, big_endian>* psym = &sym;
+  unsigned char symbuf[sym_size];
+  elfcpp::Sym<size, big_endian> sym2(symbuf);
+  if (just_symbols)
+    {
+      memcpy(symbuf, p, sym_size);
+      elfcpp::Sym_write<size, big_endian> sw(symbuf);
+      if (orig_st_shndx != elfcpp::SHN_UNDEF
+	  && is_ordinary
+	  && relobj->e_type() == elfcpp::ET_REL)
+	{
+	  // Symbol values in relocatable object files are section
+	  // relative.  This is normally what we want, but since here
+	  // we are converting the symbol to absolute we need to add
+	  // the section address.  The section address in an object
+	  // file is normally zero, but people can use a linker
+	  // script to change it.
+	  sw.put_st_value(sym.get_st_value()
+			  + relobj->section_address(orig_st_shndx));
+	}
+      st_shndx = elfcpp::SHN_ABS;
+      is_ordinary = false;
+      psym = &sym2;
+    }
+
+  // Fix up visibility if object has no-export set.
+  if (relobj->no_export()
+      && (orig_st_shndx != elfcpp::SHN_UNDEF || !is_ordinary))
+    {
+      // We may have copied symbol already above.
+      if (psym != &sym2)
 	{
 	  memcpy(symbuf, p, sym_size);
-	  elfcpp::Sym_write<size, big_endian> sw(symbuf);
-	  if (orig_st_shndx != elfcpp::SHN_UNDEF
-	      && is_ordinary
-	      && relobj->e_type() == elfcpp::ET_REL)
-	    {
-	      // Symbol values in relocatable object files are section
-	      // relative.  This is normally what we want, but since here
-	      // we are converting the symbol to absolute we need to add
-	      // the section address.  The section address in an object
-	      // file is normally zero, but people can use a linker
-	      // script to change it.
-	      sw.put_st_value(sym.get_st_value()
-			      + relobj->section_address(orig_st_shndx));
-	    }
-	  st_shndx = elfcpp::SHN_ABS;
-	  is_ordinary = false;
 	  psym = &sym2;
 	}
 
-      // Fix up visibility if object has no-export set.
-      if (relobj->no_export()
-	  && (orig_st_shndx != elfcpp::SHN_UNDEF || !is_ordinary))
-        {
-	  // We may have copied symbol already above.
-	  if (psym != &sym2)
-	    {
-	      memcpy(symbuf, p, sym_size);
-	      psym = &sym2;
-	    }
+      elfcpp::STV visibility = sym2.get_st_visibility();
+      if (visibility == elfcpp::STV_DEFAULT
+	  || visibility == elfcpp::STV_PROTECTED)
+	{
+	  elfcpp::Sym_write<size, big_endian> sw(symbuf);
+	  unsigned char nonvis = sym2.get_st_nonvis();
+	  sw.put_st_other(elfcpp::STV_HIDDEN, nonvis);
+	}
+    }
 
-	  elfcpp::STV visibility = sym2.get_st_visibility();
-	  if (visibility == elfcpp::STV_DEFAULT
-	      || visibility == elfcpp::STV_PROTECTED)
-	    {
-	      elfcpp::Sym_write<size, big_endian> sw(symbuf);
-	      unsigned char nonvis = sym2.get_st_nonvis();
-	      sw.put_st_other(elfcpp::STV_HIDDEN, nonvis);
-	    }
-        }
+  Stringpool::Key name_key;
+  name = shard->namepool.add_with_length(name, namelen, true,
+					 &name_key);
 
-      Stringpool::Key name_key;
-      name = this->namepool_.add_with_length(name, namelen, true,
-					     &name_key);
+  Sized_symbol<size>* res;
+  res = this->add_from_object(shard, relobj, name, name_key, ver, ver_key,
+			      is_default_version, *psym, st_shndx,
+			      is_ordinary, orig_st_shndx, i);
 
-      Sized_symbol<size>* res;
-      res = this->add_from_object(relobj, name, name_key, ver, ver_key,
-				  is_default_version, *psym, st_shndx,
-				  is_ordinary, orig_st_shndx);
+  if (res == NULL)
+    return is_defined;
 
-      if (res == NULL)
-	continue;
-      
-      if (is_forced_local)
-	this->force_local(res);
+  if (is_forced_local)
+    this->force_local(res);
 
-      // Do not treat this symbol as garbage if this symbol will be
-      // exported to the dynamic symbol table.  This is true when
-      // building a shared library or using --export-dynamic and
-      // the symbol is externally visible.
-      if (parameters->options().gc_sections()
-	  && res->is_externally_visible()
-	  && !res->is_from_dynobj()
-          && (parameters->options().shared()
-	      || parameters->options().export_dynamic()
-	      || parameters->options().in_dynamic_list(res->name())))
-        this->gc_mark_symbol(res);
+  // Do not treat this symbol as garbage if this symbol will be
+  // exported to the dynamic symbol table.  This is true when
+  // building a shared library or using --export-dynamic and
+  // the symbol is externally visible.
+  if (parameters->options().gc_sections()
+      && res->is_externally_visible()
+      && !res->is_from_dynobj()
+      && (parameters->options().shared()
+	  || parameters->options().export_dynamic()
+	  || parameters->options().in_dynamic_list(res->name())))
+    this->gc_mark_symbol(res);
 
-      if (is_defined_in_discarded_section)
-	res->set_is_defined_in_discarded_section();
+  if (is_defined_in_discarded_section)
+    res->set_is_defined_in_discarded_section();
 
-      (*sympointers)[i] = res;
-    }
+  (*sympointers)[i] = res;
+
+  return is_defined;
 }
 
 // Add a symbol from a plugin-claimed file.
@@ -1365,13 +1568,14 @@ Symbol_table::add_from_pluginobj(
   unsigned int st_shndx = sym->get_st_shndx();
   bool is_ordinary = st_shndx < elfcpp::SHN_LORESERVE;
 
+  Symbol_table_shard* shard = this->shard_for(name);
   Stringpool::Key ver_key = 0;
   bool is_default_version = false;
   bool is_forced_local = false;
 
   if (ver != NULL)
     {
-      ver = this->namepool_.add(ver, true, &ver_key);
+      ver = shard->namepool.add(ver, true, &ver_key);
     }
   // We don't want to assign a version to an undefined symbol,
   // even if it is listed in the version script.  FIXME: What
@@ -1392,7 +1596,7 @@ Symbol_table::add_from_pluginobj(
 		is_forced_local = true;
 	      else if (!version.empty())
                 {
-                  ver = this->namepool_.add_with_length(version.c_str(),
+                  ver = shard->namepool.add_with_length(version.c_str(),
                                                         version.length(),
                                                         true,
                                                         &ver_key);
@@ -1403,12 +1607,12 @@ Symbol_table::add_from_pluginobj(
     }
 
   Stringpool::Key name_key;
-  name = this->namepool_.add(name, true, &name_key);
+  name = shard->namepool.add(name, true, &name_key);
 
   Sized_symbol<size>* res;
-  res = this->add_from_object(obj, name, name_key, ver, ver_key,
+  res = this->add_from_object(shard, obj, name, name_key, ver, ver_key,
 		              is_default_version, *sym, st_shndx,
-			      is_ordinary, st_shndx);
+			      is_ordinary, st_shndx, 0);
 
   if (res == NULL)
     return NULL;
@@ -1513,6 +1717,7 @@ Symbol_table::add_from_dynobj(
 	}
 
       const char* name = sym_names + st_name;
+      Symbol_table_shard* shard = this->shard_for(name);
 
       bool is_ordinary;
       unsigned int st_shndx = dynobj->adjust_sym_shndx(i, psym->get_st_shndx(),
@@ -1526,10 +1731,10 @@ Symbol_table::add_from_dynobj(
       if (versym == NULL)
 	{
 	  Stringpool::Key name_key;
-	  name = this->namepool_.add(name, true, &name_key);
-	  res = this->add_from_object(dynobj, name, name_key, NULL, 0,
+	  name = shard->namepool.add(name, true, &name_key);
+	  res = this->add_from_object(shard, dynobj, name, name_key, NULL, 0,
 				      false, *psym, st_shndx, is_ordinary,
-				      st_shndx);
+				      st_shndx, i);
 	}
       else
 	{
@@ -1556,15 +1761,15 @@ Symbol_table::add_from_dynobj(
 
 	  // At this point we are definitely going to add this symbol.
 	  Stringpool::Key name_key;
-	  name = this->namepool_.add(name, true, &name_key);
+	  name = shard->namepool.add(name, true, &name_key);
 
 	  if (v == static_cast<unsigned int>(elfcpp::VER_NDX_LOCAL)
 	      || v == static_cast<unsigned int>(elfcpp::VER_NDX_GLOBAL))
 	    {
 	      // This symbol does not have a version.
-	      res = this->add_from_object(dynobj, name, name_key, NULL, 0,
-					  false, *psym, st_shndx, is_ordinary,
-					  st_shndx);
+	      res = this->add_from_object(shard, dynobj, name, name_key,
+					  NULL, 0, false, *psym, st_shndx,
+					  is_ordinary, st_shndx, i);
 	    }
 	  else
 	    {
@@ -1584,7 +1789,7 @@ Symbol_table::add_from_dynobj(
 		}
 
 	      Stringpool::Key version_key;
-	      version = this->namepool_.add(version, true, &version_key);
+	      version = shard->namepool.add(version, true, &version_key);
 
 	      // If this is an absolute symbol, and the version name
 	      // and symbol name are the same, then this is the
@@ -1594,17 +1799,18 @@ Symbol_table::add_from_dynobj(
 	      if (st_shndx == elfcpp::SHN_ABS
 		  && !is_ordinary
 		  && name_key == version_key)
-		res = this->add_from_object(dynobj, name, name_key, NULL, 0,
-					    false, *psym, st_shndx, is_ordinary,
-					    st_shndx);
+		res = this->add_from_object(shard, dynobj, name, name_key,
+					    NULL, 0, false, *psym, st_shndx,
+					    is_ordinary, st_shndx, i);
 	      else
 		{
 		  const bool is_default_version =
 		    !hidden && st_shndx != elfcpp::SHN_UNDEF;
-		  res = this->add_from_object(dynobj, name, name_key, version,
-					      version_key, is_default_version,
-					      *psym, st_shndx,
-					      is_ordinary, st_shndx);
+		  res = this->add_from_object(shard, dynobj, name, name_key,
+					      version, version_key,
+					      is_default_version, *psym,
+					      st_shndx, is_ordinary,
+					      st_shndx, i);
 		}
 	    }
 	}
@@ -1643,7 +1849,8 @@ Symbol_table::add_from_incrobj(
     Object* obj,
     const char* name,
     const char* ver,
-    elfcpp::Sym<size, big_endian>* sym)
+    elfcpp::Sym<size, big_endian>* sym,
+    unsigned int symndx)
 {
   unsigned int st_shndx = sym->get_st_shndx();
   bool is_ordinary = st_shndx < elfcpp::SHN_LORESERVE;
@@ -1651,13 +1858,14 @@ Symbol_table::add_from_incrobj(
   Stringpool::Key ver_key = 0;
   bool is_default_version = false;
 
+  Symbol_table_shard* shard = this->shard_for(name);
   Stringpool::Key name_key;
-  name = this->namepool_.add(name, true, &name_key);
+  name = shard->namepool.add(name, true, &name_key);
 
   Sized_symbol<size>* res;
-  res = this->add_from_object(obj, name, name_key, ver, ver_key,
+  res = this->add_from_object(shard, obj, name, name_key, ver, ver_key,
 		              is_default_version, *sym, st_shndx,
-			      is_ordinary, st_shndx);
+			      is_ordinary, st_shndx, symndx);
 
   return res;
 }
@@ -1786,10 +1994,12 @@ Symbol_table::define_special_symbol(const char** pname, const char** pversion,
   Symbol* oldsym;
   Sized_symbol<size>* sym;
 
+  Symbol_table_shard* shard = this->shard_for(*pname);
+
   bool add_to_table = false;
-  typename Symbol_table_type::iterator add_loc = this->table_.end();
+  typename Symbol_table_type::iterator add_loc = shard->table.end();
   bool add_def_to_table = false;
-  typename Symbol_table_type::iterator add_def_loc = this->table_.end();
+  typename Symbol_table_type::iterator add_def_loc = shard->table.end();
 
   if (only_if_ref)
     {
@@ -1801,7 +2011,7 @@ Symbol_table::define_special_symbol(const char** pname, const char** pversion,
 
       *pname = oldsym->name();
       if (is_default_version)
-	*pversion = this->namepool_.add(*pversion, true, NULL);
+	*pversion = shard->namepool.add(*pversion, true, NULL);
       else
 	*pversion = oldsym->version();
     }
@@ -1809,25 +2019,25 @@ Symbol_table::define_special_symbol(const char** pname, const char** pversion,
     {
       // Canonicalize NAME and VERSION.
       Stringpool::Key name_key;
-      *pname = this->namepool_.add(*pname, true, &name_key);
+      *pname = shard->namepool.add(*pname, true, &name_key);
 
       Stringpool::Key version_key = 0;
       if (*pversion != NULL)
-	*pversion = this->namepool_.add(*pversion, true, &version_key);
+	*pversion = shard->namepool.add(*pversion, true, &version_key);
 
       Symbol* const snull = NULL;
       std::pair<typename Symbol_table_type::iterator, bool> ins =
-	this->table_.insert(std::make_pair(std::make_pair(name_key,
+	shard->table.insert(std::make_pair(std::make_pair(name_key,
 							  version_key),
 					   snull));
 
       std::pair<typename Symbol_table_type::iterator, bool> insdefault =
-	std::make_pair(this->table_.end(), false);
+	std::make_pair(shard->table.end(), false);
       if (is_default_version)
 	{
 	  const Stringpool::Key vnull = 0;
 	  insdefault =
-	    this->table_.insert(std::make_pair(std::make_pair(name_key,
+	    shard->table.insert(std::make_pair(std::make_pair(name_key,
 							      vnull),
 					       snull));
 	}
@@ -2469,7 +2679,7 @@ Symbol_table::add_undefined_symbol_from_command_line(const char* name)
 
   sym->init_undefined(name, version, 0, elfcpp::STT_NOTYPE, elfcpp::STB_GLOBAL,
 		      elfcpp::STV_DEFAULT, 0);
-  ++this->saw_undefined_;
+  ++this->shard_for(name)->saw_undefined;
 }
 
 // Set the dynamic symbol indexes.  INDEX is the index of the first
@@ -2489,23 +2699,27 @@ Symbol_table::set_dynsym_indexes(unsigned int index,
   // First process all the symbols which have been forced to be local,
   // as they must appear before all global symbols.
   unsigned int forced_local_count = 0;
-  for (Forced_locals::iterator p = this->forced_locals_.begin();
-       p != this->forced_locals_.end();
-       ++p)
+  for (unsigned int i = 0; i < shard_count; ++i)
     {
-      Symbol* sym = *p;
-      gold_assert(sym->is_forced_local());
-      if (sym->has_dynsym_index())
-        continue;
-      if (!sym->should_add_dynsym_entry(this))
-	sym->set_dynsym_index(-1U);
-      else
-        {
-          sym->set_dynsym_index(index);
-          ++index;
-          ++forced_local_count;
-	  dynpool->add(sym->name(), false, NULL);
-        }
+      Forced_locals& forced_locals(this->shards_[i]->forced_locals);
+      for (Forced_locals::iterator p = forced_locals.begin();
+	   p != forced_locals.end();
+	   ++p)
+	{
+	  Symbol* sym = *p;
+	  gold_assert(sym->is_forced_local());
+	  if (sym->has_dynsym_index())
+	    continue;
+	  if (!sym->should_add_dynsym_entry(this))
+	    sym->set_dynsym_index(-1U);
+	  else
+	    {
+	      sym->set_dynsym_index(index);
+	      ++index;
+	      ++forced_local_count;
+	      dynpool->add(sym->name(), false, NULL);
+	    }
+	}
     }
   *pforced_local_count = forced_local_count;
 
@@ -2513,65 +2727,73 @@ Symbol_table::set_dynsym_indexes(unsigned int index,
   if (parameters->target().has_custom_set_dynsym_indexes())
     {
       std::vector<Symbol*> dyn_symbols;
-      for (Symbol_table_type::iterator p = this->table_.begin();
-           p != this->table_.end();
-           ++p)
+      for (unsigned int i = 0; i < shard_count; ++i)
         {
-          Symbol* sym = p->second;
-          if (sym->is_forced_local())
-	    continue;
-          if (!sym->should_add_dynsym_entry(this))
-            sym->set_dynsym_index(-1U);
-          else
-            dyn_symbols.push_back(sym);
+	  Symbol_table_type& table(this->shards_[i]->table);
+	  for (Symbol_table_type::iterator p = table.begin();
+	       p != table.end();
+	       ++p)
+	    {
+	      Symbol* sym = p->second;
+	      if (sym->is_forced_local())
+		continue;
+	      if (!sym->should_add_dynsym_entry(this))
+		sym->set_dynsym_index(-1U);
+	      else
+		dyn_symbols.push_back(sym);
+	    }
         }
 
       return parameters->target().set_dynsym_indexes(&dyn_symbols, index, syms,
                                                      dynpool, versions, this);
     }
 
-  for (Symbol_table_type::iterator p = this->table_.begin();
-       p != this->table_.end();
-       ++p)
+  for (unsigned int i = 0; i < shard_count; ++i)
     {
-      Symbol* sym = p->second;
+      Symbol_table_type& table(this->shards_[i]->table);
+      for (Symbol_table_type::iterator p = table.begin();
+	   p != table.end();
+	   ++p)
+	{
+	  Symbol* sym = p->second;
 
-      if (sym->is_forced_local())
-        continue;
+	  if (sym->is_forced_local())
+	    continue;
 
-      // Note that SYM may already have a dynamic symbol index, since
-      // some symbols appear more than once in the symbol table, with
-      // and without a version.
+	  // Note that SYM may already have a dynamic symbol index, since
+	  // some symbols appear more than once in the symbol table, with
+	  // and without a version.
 
-      if (!sym->should_add_dynsym_entry(this))
-	sym->set_dynsym_index(-1U);
-      else if (!sym->has_dynsym_index())
-	{
-	  sym->set_dynsym_index(index);
-	  ++index;
-	  syms->push_back(sym);
-	  dynpool->add(sym->name(), false, NULL);
-
-	  // If the symbol is defined in a dynamic object and is
-	  // referenced strongly in a regular object, then mark the
-	  // dynamic object as needed.  This is used to implement
-	  // --as-needed.
-	  if (sym->is_from_dynobj()
-	      && sym->in_reg()
-	      && !sym->is_undef_binding_weak())
-	    sym->object()->set_is_needed();
-
-	  // Record any version information, except those from
-	  // as-needed libraries not seen to be needed.  Note that the
-	  // is_needed state for such libraries can change in this loop.
-	  if (sym->version() != NULL)
+	  if (!sym->should_add_dynsym_entry(this))
+	    sym->set_dynsym_index(-1U);
+	  else if (!sym->has_dynsym_index())
 	    {
-	      if (!sym->is_from_dynobj()
-		  || !sym->object()->as_needed()
-		  || sym->object()->is_needed())
-		versions->record_version(this, dynpool, sym);
-	      else
-		as_needed_sym.push_back(sym);
+	      sym->set_dynsym_index(index);
+	      ++index;
+	      syms->push_back(sym);
+	      dynpool->add(sym->name(), false, NULL);
+
+	      // If the symbol is defined in a dynamic object and is
+	      // referenced strongly in a regular object, then mark the
+	      // dynamic object as needed.  This is used to implement
+	      // --as-needed.
+	      if (sym->is_from_dynobj()
+		  && sym->in_reg()
+		  && !sym->is_undef_binding_weak())
+		sym->object()->set_is_needed();
+
+	      // Record any version information, except those from
+	      // as-needed libraries not seen to be needed.  Note that the
+	      // is_needed state for such libraries can change in this loop.
+	      if (sym->version() != NULL)
+		{
+		  if (!sym->is_from_dynobj()
+		      || !sym->object()->as_needed()
+		      || sym->object()->is_needed())
+		    versions->record_version(this, dynpool, sym);
+		  else
+		    as_needed_sym.push_back(sym);
+		}
 	    }
 	}
     }
@@ -2691,27 +2913,35 @@ Symbol_table::sized_finalize(off_t off, Stringpool* pool,
 
   // First do all the symbols which have been forced to be local, as
   // they must appear before all global symbols.
-  for (Forced_locals::iterator p = this->forced_locals_.begin();
-       p != this->forced_locals_.end();
-       ++p)
+  for (unsigned int i = 0; i < shard_count; ++i)
     {
-      Symbol* sym = *p;
-      gold_assert(sym->is_forced_local());
-      if (this->sized_finalize_symbol<size>(sym))
+      Forced_locals& forced_locals(this->shards_[i]->forced_locals);
+      for (Forced_locals::iterator p = forced_locals.begin();
+	   p != forced_locals.end();
+	   ++p)
 	{
-	  this->add_to_final_symtab<size>(sym, pool, &index, &off);
-	  ++*plocal_symcount;
+	  Symbol* sym = *p;
+	  gold_assert(sym->is_forced_local());
+	  if (this->sized_finalize_symbol<size>(sym))
+	    {
+	      this->add_to_final_symtab<size>(sym, pool, &index, &off);
+	      ++*plocal_symcount;
+	    }
 	}
     }
 
   // Now do all the remaining symbols.
-  for (Symbol_table_type::iterator p = this->table_.begin();
-       p != this->table_.end();
-       ++p)
+  for (unsigned int i = 0; i < shard_count; ++i)
     {
-      Symbol* sym = p->second;
-      if (this->sized_finalize_symbol<size>(sym))
-	this->add_to_final_symtab<size>(sym, pool, &index, &off);
+      Symbol_table_type& table(this->shards_[i]->table);
+      for (Symbol_table_type::iterator p = table.begin();
+	   p != table.end();
+	   ++p)
+	{
+	  Symbol* sym = p->second;
+	  if (this->sized_finalize_symbol<size>(sym))
+	    this->add_to_final_symtab<size>(sym, pool, &index, &off);
+	}
     }
 
   // Now do target-specific symbols.
@@ -3021,184 +3251,191 @@ Symbol_table::sized_write_globals(const Stringpool* sympool,
   else
     dynamic_view = of->get_output_view(this->dynamic_offset_, dynamic_size);
 
-  for (Symbol_table_type::const_iterator p = this->table_.begin();
-       p != this->table_.end();
-       ++p)
+  for (unsigned int i = 0; i < shard_count; ++i)
     {
-      Sized_symbol<size>* sym = static_cast<Sized_symbol<size>*>(p->second);
+      const Symbol_table_type& table(this->shards_[i]->table);
+      for (Symbol_table_type::const_iterator p = table.begin();
+	   p != table.end();
+	   ++p)
+	{
+	  Sized_symbol<size>* sym =
+	    static_cast<Sized_symbol<size>*>(p->second);
 
-      // Possibly warn about unresolved symbols in shared libraries.
-      this->warn_about_undefined_dynobj_symbol(sym);
+	  // Possibly warn about unresolved symbols in shared libraries.
+	  this->warn_about_undefined_dynobj_symbol(sym);
 
-      unsigned int sym_index = sym->symtab_index();
-      unsigned int dynsym_index;
-      if (dynamic_view == NULL)
-	dynsym_index = -1U;
-      else
-	dynsym_index = sym->dynsym_index();
+	  unsigned int sym_index = sym->symtab_index();
+	  unsigned int dynsym_index;
+	  if (dynamic_view == NULL)
+	    dynsym_index = -1U;
+	  else
+	    dynsym_index = sym->dynsym_index();
 
-      if (sym_index == -1U && dynsym_index == -1U)
-	{
-	  // This symbol is not included in the output file.
-	  continue;
-	}
+	  if (sym_index == -1U && dynsym_index == -1U)
+	    {
+	      // This symbol is not included in the output file.
+	      continue;
+	    }
 
-      unsigned int shndx;
-      typename elfcpp::Elf_types<size>::Elf_Addr sym_value = sym->value();
-      typename elfcpp::Elf_types<size>::Elf_Addr dynsym_value = sym_value;
-      elfcpp::STB binding = sym->binding();
-
-      // If --weak-unresolved-symbols is set, change binding of unresolved
-      // global symbols to STB_WEAK.
-      if (parameters->options().weak_unresolved_symbols()
-	  && binding == elfcpp::STB_GLOBAL
-	  && sym->is_undefined())
-	binding = elfcpp::STB_WEAK;
-
-      // If --no-gnu-unique is set, change STB_GNU_UNIQUE to STB_GLOBAL.
-      if (binding == elfcpp::STB_GNU_UNIQUE
-	  && !parameters->options().gnu_unique())
-	binding = elfcpp::STB_GLOBAL;
+	  unsigned int shndx;
+	  typename elfcpp::Elf_types<size>::Elf_Addr sym_value = sym->value();
+	  typename elfcpp::Elf_types<size>::Elf_Addr dynsym_value = sym_value;
+	  elfcpp::STB binding = sym->binding();
 
-      switch (sym->source())
-	{
-	case Symbol::FROM_OBJECT:
-	  {
-	    bool is_ordinary;
-	    unsigned int in_shndx = sym->shndx(&is_ordinary);
+	  // If --weak-unresolved-symbols is set, change binding of unresolved
+	  // global symbols to STB_WEAK.
+	  if (parameters->options().weak_unresolved_symbols()
+	      && binding == elfcpp::STB_GLOBAL
+	      && sym->is_undefined())
+	    binding = elfcpp::STB_WEAK;
 
-	    if (!is_ordinary
-		&& in_shndx != elfcpp::SHN_ABS
-		&& !Symbol::is_common_shndx(in_shndx))
-	      {
-		gold_error(_("%s: unsupported symbol section 0x%x"),
-			   sym->demangled_name().c_str(), in_shndx);
-		shndx = in_shndx;
-	      }
-	    else
+	  // If --no-gnu-unique is set, change STB_GNU_UNIQUE to STB_GLOBAL.
+	  if (binding == elfcpp::STB_GNU_UNIQUE
+	      && !parameters->options().gnu_unique())
+	    binding = elfcpp::STB_GLOBAL;
+
+	  switch (sym->source())
+	    {
+	    case Symbol::FROM_OBJECT:
 	      {
-		Object* symobj = sym->object();
-		if (symobj->is_dynamic())
+		bool is_ordinary;
+		unsigned int in_shndx = sym->shndx(&is_ordinary);
+
+		if (!is_ordinary
+		    && in_shndx != elfcpp::SHN_ABS
+		    && !Symbol::is_common_shndx(in_shndx))
 		  {
-		    if (sym->needs_dynsym_value())
-		      dynsym_value = target.dynsym_value(sym);
-		    shndx = elfcpp::SHN_UNDEF;
-		    if (sym->is_undef_binding_weak())
-		      binding = elfcpp::STB_WEAK;
-		    else
-		      binding = elfcpp::STB_GLOBAL;
+		    gold_error(_("%s: unsupported symbol section 0x%x"),
+			       sym->demangled_name().c_str(), in_shndx);
+		    shndx = in_shndx;
 		  }
-		else if (symobj->pluginobj() != NULL)
-		  shndx = elfcpp::SHN_UNDEF;
-		else if (in_shndx == elfcpp::SHN_UNDEF
-			 || (!is_ordinary
-			     && (in_shndx == elfcpp::SHN_ABS
-				 || Symbol::is_common_shndx(in_shndx))))
-		  shndx = in_shndx;
 		else
 		  {
-		    Relobj* relobj = static_cast<Relobj*>(symobj);
-		    Output_section* os = relobj->output_section(in_shndx);
-                    if (this->is_section_folded(relobj, in_shndx))
-                      {
-                        // This global symbol must be written out even though
-                        // it is folded.
-                        // Get the os of the section it is folded onto.
-                        Section_id folded =
-                             this->icf_->get_folded_section(relobj, in_shndx);
-                        gold_assert(folded.first !=NULL);
-                        Relobj* folded_obj = 
-                          reinterpret_cast<Relobj*>(folded.first);
-                        os = folded_obj->output_section(folded.second);  
-                        gold_assert(os != NULL);
-                      }
-		    gold_assert(os != NULL);
-		    shndx = os->out_shndx();
-
-		    if (shndx >= elfcpp::SHN_LORESERVE)
+		    Object* symobj = sym->object();
+		    if (symobj->is_dynamic())
 		      {
-			if (sym_index != -1U)
-			  symtab_xindex->add(sym_index, shndx);
-			if (dynsym_index != -1U)
-			  dynsym_xindex->add(dynsym_index, shndx);
-			shndx = elfcpp::SHN_XINDEX;
+			if (sym->needs_dynsym_value())
+			  dynsym_value = target.dynsym_value(sym);
+			shndx = elfcpp::SHN_UNDEF;
+			if (sym->is_undef_binding_weak())
+			  binding = elfcpp::STB_WEAK;
+			else
+			  binding = elfcpp::STB_GLOBAL;
+		      }
+		    else if (symobj->pluginobj() != NULL)
+		      shndx = elfcpp::SHN_UNDEF;
+		    else if (in_shndx == elfcpp::SHN_UNDEF
+			     || (!is_ordinary
+				 && (in_shndx == elfcpp::SHN_ABS
+				     || Symbol::is_common_shndx(in_shndx))))
+		      shndx = in_shndx;
+		    else
+		      {
+			Relobj* relobj = static_cast<Relobj*>(symobj);
+			Output_section* os = relobj->output_section(in_shndx);
+			if (this->is_section_folded(relobj, in_shndx))
+			  {
+			    // This global symbol must be written out even
+			    // though it is folded.
+			    // Get the os of the section it is folded onto.
+			    Section_id folded =
+			      this->icf_->get_folded_section(relobj,
+							     in_shndx);
+			    gold_assert(folded.first !=NULL);
+			    Relobj* folded_obj = 
+			      reinterpret_cast<Relobj*>(folded.first);
+			    os = folded_obj->output_section(folded.second);  
+			    gold_assert(os != NULL);
+			  }
+			gold_assert(os != NULL);
+			shndx = os->out_shndx();
+
+			if (shndx >= elfcpp::SHN_LORESERVE)
+			  {
+			    if (sym_index != -1U)
+			      symtab_xindex->add(sym_index, shndx);
+			    if (dynsym_index != -1U)
+			      dynsym_xindex->add(dynsym_index, shndx);
+			    shndx = elfcpp::SHN_XINDEX;
+			  }
+
+			// In object files symbol values are section
+			// relative.
+			if (parameters->options().relocatable())
+			  sym_value -= os->address();
 		      }
-
-		    // In object files symbol values are section
-		    // relative.
-		    if (parameters->options().relocatable())
-		      sym_value -= os->address();
 		  }
 	      }
-	  }
-	  break;
-
-	case Symbol::IN_OUTPUT_DATA:
-	  {
-	    Output_data* od = sym->output_data();
+	      break;
 
-	    shndx = od->out_shndx();
-	    if (shndx >= elfcpp::SHN_LORESERVE)
+	    case Symbol::IN_OUTPUT_DATA:
 	      {
-		if (sym_index != -1U)
-		  symtab_xindex->add(sym_index, shndx);
-		if (dynsym_index != -1U)
-		  dynsym_xindex->add(dynsym_index, shndx);
-		shndx = elfcpp::SHN_XINDEX;
+		Output_data* od = sym->output_data();
+
+		shndx = od->out_shndx();
+		if (shndx >= elfcpp::SHN_LORESERVE)
+		  {
+		    if (sym_index != -1U)
+		      symtab_xindex->add(sym_index, shndx);
+		    if (dynsym_index != -1U)
+		      dynsym_xindex->add(dynsym_index, shndx);
+		    shndx = elfcpp::SHN_XINDEX;
+		  }
+
+		// In object files symbol values are section
+		// relative.
+		if (parameters->options().relocatable())
+		  {
+		    Output_section* os = od->output_section();
+		    gold_assert(os != NULL);
+		    sym_value -= os->address();
+		  }
 	      }
+	      break;
 
-	    // In object files symbol values are section
-	    // relative.
-	    if (parameters->options().relocatable())
+	    case Symbol::IN_OUTPUT_SEGMENT:
 	      {
-		Output_section* os = od->output_section();
-		gold_assert(os != NULL);
-		sym_value -= os->address();
+		Output_segment* oseg = sym->output_segment();
+		Output_section* osect = oseg->first_section();
+		if (osect == NULL)
+		  shndx = elfcpp::SHN_ABS;
+		else
+		  shndx = osect->out_shndx();
 	      }
-	  }
-	  break;
+	      break;
 
-	case Symbol::IN_OUTPUT_SEGMENT:
-	  {
-	    Output_segment* oseg = sym->output_segment();
-	    Output_section* osect = oseg->first_section();
-	    if (osect == NULL)
+	    case Symbol::IS_CONSTANT:
 	      shndx = elfcpp::SHN_ABS;
-	    else
-	      shndx = osect->out_shndx();
-	  }
-	  break;
-
-	case Symbol::IS_CONSTANT:
-	  shndx = elfcpp::SHN_ABS;
-	  break;
+	      break;
 
-	case Symbol::IS_UNDEFINED:
-	  shndx = elfcpp::SHN_UNDEF;
-	  break;
+	    case Symbol::IS_UNDEFINED:
+	      shndx = elfcpp::SHN_UNDEF;
+	      break;
 
-	default:
-	  gold_unreachable();
-	}
+	    default:
+	      gold_unreachable();
+	    }
 
-      if (sym_index != -1U)
-	{
-	  sym_index -= first_global_index;
-	  gold_assert(sym_index < output_count);
-	  unsigned char* ps = psyms + (sym_index * sym_size);
-	  this->sized_write_symbol<size, big_endian>(sym, sym_value, shndx,
-						     binding, sympool, ps);
-	}
+	  if (sym_index != -1U)
+	    {
+	      sym_index -= first_global_index;
+	      gold_assert(sym_index < output_count);
+	      unsigned char* ps = psyms + (sym_index * sym_size);
+	      this->sized_write_symbol<size, big_endian>(sym, sym_value, shndx,
+							 binding, sympool, ps);
+	    }
 
-      if (dynsym_index != -1U)
-	{
-	  dynsym_index -= first_dynamic_global_index;
-	  gold_assert(dynsym_index < dynamic_count);
-	  unsigned char* pd = dynamic_view + (dynsym_index * sym_size);
-	  this->sized_write_symbol<size, big_endian>(sym, dynsym_value, shndx,
-						     binding, dynpool, pd);
-          // Allow a target to adjust dynamic symbol value.
-          parameters->target().adjust_dyn_symbol(sym, pd);
+	  if (dynsym_index != -1U)
+	    {
+	      dynsym_index -= first_dynamic_global_index;
+	      gold_assert(dynsym_index < dynamic_count);
+	      unsigned char* pd = dynamic_view + (dynsym_index * sym_size);
+	      this->sized_write_symbol<size, big_endian>(sym, dynsym_value,
+							 shndx, binding,
+							 dynpool, pd);
+	      // Allow a target to adjust dynamic symbol value.
+	      parameters->target().adjust_dyn_symbol(sym, pd);
+	    }
 	}
     }
 
@@ -3402,14 +3639,22 @@ Symbol_table::sized_write_section_symbol(const Output_section* os,
 void
 Symbol_table::print_stats() const
 {
+  size_t entries = 0;
+  size_t buckets = 0;
+  for (unsigned int i = 0; i < shard_count; ++i)
+    {
+      entries += this->shards_[i]->table.size();
+      buckets += this->shards_[i]->table.bucket_count();
+    }
 #if defined(HAVE_TR1_UNORDERED_MAP) || defined(HAVE_EXT_HASH_MAP)
   fprintf(stderr, _("%s: symbol table entries: %zu; buckets: %zu\n"),
-	  program_name, this->table_.size(), this->table_.bucket_count());
+	  program_name, entries, buckets);
 #else
   fprintf(stderr, _("%s: symbol table entries: %zu\n"),
-	  program_name, this->table_.size());
+	  program_name, entries);
 #endif
-  this->namepool_.print_stats("symbol table stringpool");
+  for (unsigned int i = 0; i < shard_count; ++i)
+    this->shards_[i]->namepool.print_stats("symbol table stringpool");
 }
 
 // We check for ODR violations by looking for symbols with the same
@@ -3595,10 +3840,9 @@ Symbol_table::detect_odr_violations(const Task* task,
 // Add a new warning.
 
 void
-Warnings::add_warning(Symbol_table* symtab, const char* name, Object* obj,
+Warnings::add_warning(const char* name, Object* obj,
 		      const std::string& warning)
 {
-  name = symtab->canonicalize_name(name);
   this->warnings_[name].set(obj, warning);
 }
 
@@ -3613,7 +3857,7 @@ Warnings::note_warnings(Symbol_table* symtab)
        p != this->warnings_.end();
        ++p)
     {
-      Symbol* sym = symtab->lookup(p->first, NULL);
+      Symbol* sym = symtab->lookup(p->first.c_str(), NULL);
       if (sym != NULL
 	  && sym->source() == Symbol::FROM_OBJECT
 	  && sym->object() == p->second.object)
@@ -3715,6 +3959,66 @@ Symbol_table::add_from_relobj<64, true>(
     size_t* defined);
 #endif
 
+#ifdef HAVE_TARGET_32_LITTLE
+template
+void
+Symbol_table::add_from_relobj_shard<32, false>(
+    Sized_relobj_file<32, false>* relobj,
+    const unsigned char* syms,
+    size_t symndx_offset,
+    const char* sym_names,
+    size_t sym_name_size,
+    Sized_relobj_file<32, false>::Symbols* sympointers,
+    unsigned int shard,
+    const unsigned int* begin,
+    const unsigned int* end);
+#endif
+
+#ifdef HAVE_TARGET_32_BIG
+template
+void
+Symbol_table::add_from_relobj_shard<32, true>(
+    Sized_relobj_file<32, true>* relobj,
+    const unsigned char* syms,
+    size_t symndx_offset,
+    const char* sym_names,
+    size_t sym_name_size,
+    Sized_relobj_file<32, true>::Symbols* sympointers,
+    unsigned int shard,
+    const unsigned int* begin,
+    const unsigned int* end);
+#endif
+
+#ifdef HAVE_TARGET_64_LITTLE
+template
+void
+Symbol_table::add_from_relobj_shard<64, false>(
+    Sized_relobj_file<64, false>* relobj,
+    const unsigned char* syms,
+    size_t symndx_offset,
+    const char* sym_names,
+    size_t sym_name_size,
+    Sized_relobj_file<64, false>::Symbols* sympointers,
+    unsigned int shard,
+    const unsigned int* begin,
+    const unsigned int* end);
+#endif
+
+#ifdef HAVE_TARGET_64_BIG
+template
+void
+Symbol_table::add_from_relobj_shard<64, true>(
+    Sized_relobj_file<64, true>* relobj,
+    const unsigned char* syms,
+    size_t symndx_offset,
+    const char* sym_names,
+    size_t sym_name_size,
+    Sized_relobj_file<64, true>::Symbols* sympointers,
+    unsigned int shard,
+    const unsigned int* begin,
+    const unsigned int* end);
+#endif
+
 #ifdef HAVE_TARGET_32_LITTLE
 template
 Symbol*
@@ -3826,7 +4130,8 @@ Symbol_table::add_from_incrobj(
     Object* obj,
     const char* name,
     const char* ver,
-    elfcpp::Sym<32, false>* sym);
+    elfcpp::Sym<32, false>* sym,
+    unsigned int symndx);
 #endif
 
 #ifdef HAVE_TARGET_32_BIG
@@ -3836,7 +4141,8 @@ Symbol_table::add_from_incrobj(
     Object* obj,
     const char* name,
     const char* ver,
-    elfcpp::Sym<32, true>* sym);
+    elfcpp::Sym<32, true>* sym,
+    unsigned int symndx);
 #endif
 
 #ifdef HAVE_TARGET_64_LITTLE
@@ -3846,7 +4152,8 @@ Symbol_table::add_from_incrobj(
     Object* obj,
     const char* name,
     const char* ver,
-    elfcpp::Sym<64, false>* sym);
+    elfcpp::Sym<64, false>* sym,
+    unsigned int symndx);
 #endif
 
 #ifdef HAVE_TARGET_64_BIG
@@ -3856,7 +4163,8 @@ Symbol_table::add_from_incrobj(
     Object* obj,
     const char* name,
     const char* ver,
-    elfcpp::Sym<64, true>* sym);
+    elfcpp::Sym<64, true>* sym,
+    unsigned int symndx);
 #endif
 
 #if defined(HAVE_TARGET_32_LITTLE) || defined(HAVE_TARGET_32_BIG)
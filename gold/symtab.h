@@ -60,6 +60,8 @@ class Output_file;
 class Output_symtab_xindex;
 class Garbage_collection;
 class Icf;
+class Lock;
+class Task_token;
 
 // The base class of an entry in the symbol table.  The symbol table
 // can have a lot of entries, so we don't want this class too big.
@@ -1297,8 +1299,7 @@ class Warnings
   // Add a warning for symbol NAME in object OBJ.  WARNING is the text
   // of the warning.
   void
-  add_warning(Symbol_table* symtab, const char* name, Object* obj,
-	      const std::string& warning);
+  add_warning(const char* name, Object* obj, const std::string& warning);
 
   // For each symbol for which we should give a warning, make a note
   // on the symbol.
@@ -1335,9 +1336,11 @@ class Warnings
     }
   };
 
-  // A mapping from warning symbol names (canonicalized in
-  // Symbol_table's namepool_ field) to warning information.
-  typedef Unordered_map<const char*, Warning_location> Warning_table;
+  // A mapping from warning symbol names to warning information.  The
+  // names are not canonicalized in the symbol table's string pools,
+  // because warnings are noted during layout, which may run while
+  // other objects are still adding symbols.
+  typedef Unordered_map<std::string, Warning_location> Warning_table;
 
   Warning_table warnings_;
 };
@@ -1382,6 +1385,52 @@ class Symbol_table
 
   ~Symbol_table();
 
+  // The number of partitions ("shards") the symbol table is split
+  // into.  This is fixed, rather than tied to the thread count, so
+  // that the output does not depend on the number of threads.
+  static const unsigned int shard_count = 16;
+
+  // Return the shard holding symbols named NAME, which is LEN
+  // characters long and does not include any version.
+  static unsigned int
+  shard_for_name(const char* name, size_t len);
+
+  // Return whether the symbols of OBJECT may be added by one task
+  // per shard running in parallel, rather than all at once.
+  bool
+  can_add_symbols_in_parallel(const Object* object) const;
+
+  // Return whether adding symbols to one shard only changes symbols
+  // in that shard.  This stops being true once a dynamic object has
+  // recorded weak aliases, since overriding a symbol also overrides
+  // its aliases.
+  bool
+  shards_are_independent() const
+  { return this->weak_aliases_.empty(); }
+
+  // Return the token which is unblocked when the most recently queued
+  // task adding symbols to SHARD completes, or NULL if there is none.
+  Task_token*
+  shard_blocker(unsigned int shard) const
+  { return this->shards_[shard]->add_symbols_blocker; }
+
+  // Set the token which is unblocked when the most recently queued
+  // task adding symbols to SHARD completes.
+  void
+  set_shard_blocker(unsigned int shard, Task_token* token)
+  { this->shards_[shard]->add_symbols_blocker = token; }
+
+  // Return a token which is blocked while symbols are still being
+  // added to some shard, or NULL if there are no such tasks.  Any
+  // task which looks at the symbol table while the input files are
+  // being read must wait for this.
+  Task_token*
+  add_symbols_blocker() const;
+
+  // Called when all the input symbols have been added.
+  void
+  finish_adding_symbols();
+
   void
   set_icf(Icf* icf)
   { this->icf_ = icf;}
@@ -1430,6 +1479,20 @@ class Symbol_table
 		  typename Sized_relobj_file<size, big_endian>::Symbols*,
 		  size_t* defined);
 
+  // Add the external symbols of RELOBJ which belong to shard SHARD.
+  // BEGIN and END delimit the indexes of those symbols, relative to
+  // SYMS; the other parameters are as for add_from_relobj.  This
+  // does not count the defined symbols, which is done when the
+  // symbols are partitioned.
+  template<int size, bool big_endian>
+  void
+  add_from_relobj_shard(Sized_relobj_file<size, big_endian>* relobj,
+			const unsigned char* syms, size_t symndx_offset,
+			const char* sym_names, size_t sym_name_size,
+			typename Sized_relobj_file<size, big_endian>::Symbols*,
+			unsigned int shard, const unsigned int* begin,
+			const unsigned int* end);
+
   // Add one external symbol from the plugin object OBJ to the symbol table.
   // Returns a pointer to the resolved symbol in the symbol table.
   template<int size, bool big_endian>
@@ -1453,11 +1516,13 @@ class Symbol_table
 		  size_t* defined);
 
   // Add one external symbol from the incremental object OBJ to the symbol
-  // table.  Returns a pointer to the resolved symbol in the symbol table.
+  // table.  SYMNDX is the index of the symbol in OBJ.  Returns a pointer
+  // to the resolved symbol in the symbol table.
   template<int size, bool big_endian>
   Sized_symbol<size>*
   add_from_incrobj(Object* obj, const char* name,
-		   const char* ver, elfcpp::Sym<size, big_endian>* sym);
+		   const char* ver, elfcpp::Sym<size, big_endian>* sym,
+		   unsigned int symndx);
 
   // Define a special symbol based on an Output_data.  It is a
   // multiple definition error if this symbol is already defined.
@@ -1531,8 +1596,7 @@ class Symbol_table
 
   // Return the count of undefined symbols seen.
   size_t
-  saw_undefined() const
-  { return this->saw_undefined_; }
+  saw_undefined() const;
 
   // Allocate the common symbols
   void
@@ -1542,12 +1606,11 @@ class Symbol_table
   // of the warning.
   void
   add_warning(const char* name, Object* obj, const std::string& warning)
-  { this->warnings_.add_warning(this, name, obj, warning); }
+  { this->warnings_.add_warning(name, obj, warning); }
 
   // Canonicalize a symbol name for use in the hash table.
   const char*
-  canonicalize_name(const char* name)
-  { return this->namepool_.add(name, true, NULL); }
+  canonicalize_name(const char* name);
 
   // Possibly issue a warning for a reference to SYM at LOCATION which
   // is in OBJ.
@@ -1647,12 +1710,17 @@ class Symbol_table
   void
   for_all_symbols(F f) const
   {
-    for (Symbol_table_type::const_iterator p = this->table_.begin();
-         p != this->table_.end();
-         ++p)
+    for (unsigned int i = 0; i < shard_count; ++i)
       {
-	Sized_symbol<size>* sym = static_cast<Sized_symbol<size>*>(p->second);
-	f(sym);
+	const Symbol_table_type& table(this->shards_[i]->table);
+	for (Symbol_table_type::const_iterator p = table.begin();
+	     p != table.end();
+	     ++p)
+	  {
+	    Sized_symbol<size>* sym =
+	      static_cast<Sized_symbol<size>*>(p->second);
+	    f(sym);
+	  }
       }
   }
 
@@ -1672,6 +1740,12 @@ class Symbol_table
   // The type of the list of common symbols.
   typedef std::vector<Symbol*> Commons_type;
 
+  // The type of the list of common symbols kept in a shard.  Each
+  // symbol is paired with the position in the input at which it
+  // became common: the input order of its object in the high 32 bits
+  // and its symbol index in the low 32 bits.
+  typedef std::vector<std::pair<uint64_t, Symbol*> > Shard_commons_type;
+
   // The type of the symbol hash table.
 
   typedef std::pair<Stringpool::Key, Stringpool::Key> Symbol_table_key;
@@ -1695,6 +1769,55 @@ class Symbol_table
   typedef Unordered_map<Symbol_table_key, Symbol*, Symbol_table_hash,
 			Symbol_table_eq> Symbol_table_type;
 
+  // The type of the list of symbols which have been forced local.
+  typedef std::vector<Symbol*> Forced_locals;
+
+  // One shard of the symbol table.  A symbol lives in the shard
+  // chosen by hashing its name without the version, so all the
+  // versions of a name share a shard, and the Stringpool keys in a
+  // shard's table all come from the shard's own pool.  The lists
+  // here are kept per shard so that the order in which symbols are
+  // recorded does not depend on how tasks for different shards are
+  // scheduled.
+  struct Symbol_table_shard
+  {
+    Symbol_table_shard(unsigned int count, bool threaded);
+
+    ~Symbol_table_shard();
+
+    // Held while adding symbols to, or looking up symbols in, this
+    // shard.  This is NULL unless symbols are added in parallel.
+    Lock* lock;
+    // The symbol hash table.
+    Symbol_table_type table;
+    // A pool of symbol names.  Entries in the hash table point into
+    // this pool.
+    Stringpool namepool;
+    // The number of new undefined symbols seen in this shard.
+    size_t saw_undefined;
+    // Common symbols first defined in this shard; see the commons_
+    // field of Symbol_table.
+    Shard_commons_type commons;
+    Shard_commons_type tls_commons;
+    Shard_commons_type small_commons;
+    Shard_commons_type large_commons;
+    // Symbols in this shard which have been forced to be local.
+    Forced_locals forced_locals;
+    // The token unblocked by the most recently queued task adding
+    // symbols to this shard.  Tasks for a shard are chained through
+    // these tokens in input file order.
+    Task_token* add_symbols_blocker;
+
+   private:
+    Symbol_table_shard(const Symbol_table_shard&);
+    Symbol_table_shard& operator=(const Symbol_table_shard&);
+  };
+
+  // Return the shard for a symbol named NAME.
+  Symbol_table_shard*
+  shard_for(const char* name) const
+  { return this->shards_[shard_for_name(name, strlen(name))]; }
+
   // A map from symbol name (as a pointer into the namepool) to all
   // the locations the symbols is (weakly) defined (and certain other
   // conditions are met).  This map will be used later to detect
@@ -1716,11 +1839,22 @@ class Symbol_table
   // Add a symbol.
   template<int size, bool big_endian>
   Sized_symbol<size>*
-  add_from_object(Object*, const char* name, Stringpool::Key name_key,
+  add_from_object(Symbol_table_shard*, Object*,
+		  const char* name, Stringpool::Key name_key,
 		  const char* version, Stringpool::Key version_key,
 		  bool def, const elfcpp::Sym<size, big_endian>& sym,
 		  unsigned int st_shndx, bool is_ordinary,
-		  unsigned int orig_st_shndx);
+		  unsigned int orig_st_shndx, unsigned int symndx);
+
+  // Add one external symbol from a relocatable object.  Return
+  // whether it is defined.
+  template<int size, bool big_endian>
+  bool
+  add_one_from_relobj(Sized_relobj_file<size, big_endian>* relobj,
+		      const unsigned char* syms, size_t i,
+		      size_t symndx_offset, const char* sym_names,
+		      size_t sym_name_size, bool just_symbols,
+		      typename Sized_relobj_file<size, big_endian>::Symbols*);
 
   // Define a default symbol.
   template<int size, bool big_endian>
@@ -1747,9 +1881,11 @@ class Symbol_table
   void
   force_local(Symbol*);
 
-  // Adjust NAME and *NAME_KEY for wrapping.
+  // Adjust NAME and *NAME_KEY for wrapping.  This updates *PSHARD
+  // if the new name is in a different shard.
   const char*
-  wrap_symbol(const char* name, Stringpool::Key* name_key);
+  wrap_symbol(const char* name, Stringpool::Key* name_key,
+	      Symbol_table_shard** pshard);
 
   // Whether we should override a symbol, based on flags in
   // resolve.cc.
@@ -1852,6 +1988,11 @@ class Symbol_table
   void
   do_allocate_commons(Layout*, Mapfile*, Sort_commons_order);
 
+  // Move the common symbols of one type recorded in each shard to
+  // COMMONS, in the order in which they were seen in the input.
+  void
+  gather_commons(Commons_section_type, Commons_type* commons);
+
   // Allocate the common symbols from one list.
   template<int size>
   void
@@ -1910,16 +2051,10 @@ class Symbol_table
   sized_write_section_symbol(const Output_section*, Output_symtab_xindex*,
 			     Output_file*, off_t) const;
 
-  // The type of the list of symbols which have been forced local.
-  typedef std::vector<Symbol*> Forced_locals;
-
   // A map from symbols with COPY relocs to the dynamic objects where
   // they are defined.
   typedef Unordered_map<const Symbol*, Dynobj*> Copied_symbol_dynobjs;
 
-  // We increment this every time we see a new undefined symbol, for
-  // use in archive groups.
-  size_t saw_undefined_;
   // The index of the first global symbol in the output file.
   unsigned int first_global_index_;
   // The file offset within the output symtab section where we should
@@ -1935,21 +2070,24 @@ class Symbol_table
   // The number of global dynamic symbols (including forced-local symbols),
   // or 0 if none.
   unsigned int dynamic_count_;
-  // The symbol hash table.
-  Symbol_table_type table_;
-  // A pool of symbol names.  This is used for all global symbols.
-  // Entries in the hash table point into this pool.
-  Stringpool namepool_;
+  // The shards of the symbol table, indexed by shard_for_name.
+  std::vector<Symbol_table_shard*> shards_;
+  // Whether symbols from relocatable objects may be added to the
+  // shards in parallel.
+  bool add_in_parallel_;
   // Forwarding symbols.
   Unordered_map<const Symbol*, Symbol*> forwarders_;
+  // Protects forwarders_ when symbols are added in parallel.
+  Lock* forwarders_lock_;
   // Weak aliases.  A symbol in this list points to the next alias.
   // The aliases point to each other in a circular list.
   Unordered_map<Symbol*, Symbol*> weak_aliases_;
   // We don't expect there to be very many common symbols, so we keep
-  // a list of them.  When we find a common symbol we add it to this
-  // list.  It is possible that by the time we process the list the
-  // symbol is no longer a common symbol.  It may also have become a
-  // forwarder.
+  // a list of them.  When we find a common symbol we add it to the
+  // list in its shard, and the shard lists are gathered here in input
+  // order when we allocate them.  It is possible that by the time we
+  // process the list the symbol is no longer a common symbol.  It may
+  // also have become a forwarder.
   Commons_type commons_;
   // This is like the commons_ field, except that it holds TLS common
   // symbols.
@@ -1958,10 +2096,14 @@ class Symbol_table
   Commons_type small_commons_;
   // This is for large common symbols.
   Commons_type large_commons_;
-  // A list of symbols which have been forced to be local.  We don't
-  // expect there to be very many of them, so we keep a list of them
-  // rather than walking the whole table to find them.
-  Forced_locals forced_locals_;
+  // Symbols marked for garbage collection while symbols were being
+  // added in parallel.  The GC worklist is not locked, so these are
+  // queued by finish_adding_symbols.
+  std::vector<Symbol*> deferred_gc_marks_;
+  // Protects deferred_gc_marks_.
+  Lock* deferred_gc_marks_lock_;
+  // Whether gc_mark_symbol should add to deferred_gc_marks_.
+  bool defer_gc_marks_;
   // Manage symbol warnings.
   Warnings warnings_;
   // Manage potential One Definition Rule (ODR) violations.
@@ -122,13 +122,14 @@ class Target
   // If a -z max-page-size argument has set the ABI page size
   // to a value larger than the default starting address,
   // bump the starting address up to the page size, to avoid
-  // misaligning the text segment in the file.
+  // misaligning the text segment in the file.  A zero default,
+  // used by targets that do not load the headers, is kept.
   uint64_t
   default_text_segment_address() const
   {
     uint64_t addr = this->pti_->default_text_segment_address;
     uint64_t pagesize = this->abi_pagesize();
-    if (addr < pagesize)
+    if (addr != 0 && addr < pagesize)
       addr = pagesize;
     return addr;
   }
@@ -464,6 +465,33 @@ class Target
   gc_mark_symbol(Symbol_table* symtab, Symbol* sym) const
   { this->do_gc_mark_symbol(symtab, sym); }
 
+  // Return the processor specific segment flags to use for a section
+  // with processor specific section flags FLAGS.
+  elfcpp::Elf_Word
+  segment_flags_for_section(elfcpp::Elf_Xword flags) const
+  { return this->do_segment_flags_for_section(flags); }
+
+  // Return the name of the output section in the linker script which
+  // the orphan output section OS should follow, or NULL to place it
+  // in the usual way.
+  const char*
+  orphan_section_follows(const Output_section* os) const
+  { return this->do_orphan_section_follows(os); }
+
+  // Return true if the orphan output section OS runs at an address
+  // other than the one at which it is loaded, such as an overlay.
+  // Set *ADDRESS to the address at which it runs.
+  bool
+  orphan_run_address(const Output_section* os, Symbol_table* symtab,
+		     Layout* layout, uint64_t* address) const
+  { return this->do_orphan_run_address(os, symtab, layout, address); }
+
+  // Return true if, without a linker script, the file and program
+  // headers may be put at the start of the first PT_LOAD segment.
+  bool
+  headers_in_load_segment() const
+  { return this->do_headers_in_load_segment(); }
+
   // Return the name of the entry point symbol.
   const char*
   entry_symbol_name() const
@@ -780,6 +808,27 @@ class Target
   do_gc_mark_symbol(Symbol_table*, Symbol*) const
   { }
 
+  // This may be overridden by the child class.
+  virtual elfcpp::Elf_Word
+  do_segment_flags_for_section(elfcpp::Elf_Xword) const
+  { return 0; }
+
+  // This may be overridden by the child class.
+  virtual const char*
+  do_orphan_section_follows(const Output_section*) const
+  { return NULL; }
+
+  // This may be overridden by the child class.
+  virtual bool
+  do_orphan_run_address(const Output_section*, Symbol_table*, Layout*,
+			uint64_t*) const
+  { return false; }
+
+  // This may be overridden by the child class.
+  virtual bool
+  do_headers_in_load_segment() const
+  { return true; }
+
   // This may be overridden by the child class.
   virtual bool
   do_has_custom_set_dynsym_indexes() const
@@ -0,0 +1,77 @@
+#!/bin/sh
+
+# debug_names_test_1.sh -- a test case for the --debug-names option.
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output:"
+	echo "   $2"
+	echo ""
+	echo "Actual error output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+STDOUT=debug_names_test_1.stdout
+
+check $STDOUT "^Contents of the .debug_names section:"
+check $STDOUT "^Version 5"
+check $STDOUT "^Augmentation string: \"GOLD\""
+
+# The one compilation unit.
+
+check $STDOUT "^\[  0\] 0x0$"
+
+# Look for the names we know should be in the index, with their tags.
+
+check $STDOUT "^\[ *[0-9]*\] main: DW_TAG_subprogram DW_IDX_compile_unit=0x0 "
+check $STDOUT "^\[ *[0-9]*\] check_enum: DW_TAG_subprogram "
+check $STDOUT "^\[ *[0-9]*\] int: DW_TAG_base_type "
+check $STDOUT "^\[ *[0-9]*\] one: DW_TAG_namespace "
+check $STDOUT "^\[ *[0-9]*\] c1: DW_TAG_class_type "
+
+# The index must list nested DIEs, inlined instances and anonymous
+# namespaces as well as the top-level ones.
+
+check $STDOUT "^\[ *[0-9]*\] E: DW_TAG_enumeration_type "
+check $STDOUT "^\[ *[0-9]*\] inline_func_1: DW_TAG_inlined_subroutine "
+check $STDOUT "^\[ *[0-9]*\] (anonymous namespace): DW_TAG_namespace "
+
+# If we have llvm-dwarfdump, let it check that the index lists every
+# DIE it should.
+
+VERIFY=debug_names_test_1.verify
+
+if llvm-dwarfdump --version > /dev/null 2>&1
+then
+    if ! llvm-dwarfdump --verify debug_names_test_1 > $VERIFY 2>&1
+    then
+	echo "llvm-dwarfdump --verify failed:"
+	cat $VERIFY
+	exit 1
+    fi
+fi
+
+exit 0
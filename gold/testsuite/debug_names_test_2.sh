@@ -0,0 +1,56 @@
+#!/bin/sh
+
+# debug_names_test_2.sh -- a test case for --debug-names with
+# compressed debug sections.
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output:"
+	echo "   $2"
+	echo ""
+	echo "Actual error output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+STDOUT=debug_names_test_2.stdout
+
+check $STDOUT "^Contents of the .debug_names section:"
+check $STDOUT "^Version 5"
+check $STDOUT "^Augmentation string: \"GOLD\""
+
+# The one compilation unit.
+
+check $STDOUT "^\[  0\] 0x0$"
+
+# Look for the names we know should be in the index, with their tags.
+
+check $STDOUT "^\[ *[0-9]*\] main: DW_TAG_subprogram DW_IDX_compile_unit=0x0 "
+check $STDOUT "^\[ *[0-9]*\] check_enum: DW_TAG_subprogram "
+check $STDOUT "^\[ *[0-9]*\] int: DW_TAG_base_type "
+check $STDOUT "^\[ *[0-9]*\] one: DW_TAG_namespace "
+check $STDOUT "^\[ *[0-9]*\] c1: DW_TAG_class_type "
+
+exit 0
@@ -0,0 +1,60 @@
+#!/bin/sh
+
+# debug_names_test_3.sh -- a test case for --debug-names with type
+# units.
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The .debug_names section cannot describe type units, so gold should
+# warn and write an empty section rather than an index that leaves
+# the types out.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output:"
+	echo "   $2"
+	echo ""
+	echo "Actual error output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_missing()
+{
+    if grep -q "$2" "$1"
+    then
+	echo "Found unexpected output:"
+	echo "   $2"
+	echo ""
+	echo "Actual error output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check debug_names_test_3.err "does not support type units; not writing a .debug_names section"
+
+check debug_names_test_3.stdout "^ *\[ *[0-9]*\] \.debug_names  *PROGBITS  *0*  *[0-9a-f]*  *0*  "
+check_missing debug_names_test_3.stdout "^Augmentation string:"
+
+exit 0
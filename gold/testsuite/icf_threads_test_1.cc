@@ -0,0 +1,64 @@
+// icf_threads_test_1.cc -- a test case for gold
+
+// Copyright (C) 2017 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// The goal of this program is to check that identical code folding
+// run as parallel tasks folds the same sections as a serial link.
+// Some functions here refer to strings in a merge section of
+// icf_threads_test_2.o; ICF reads those functions in its serial step.
+
+extern const char icf_threads_str1[];
+extern const char icf_threads_str2[];
+extern const char icf_threads_str3[];
+
+int kept_func_1(int x) { return x * 3 + 7; }
+int folded_func_1(int x) { return x * 3 + 7; }
+int folded_func_2(int x) { return x * 3 + 7; }
+
+int kept_func_2(int x) { return x * 5 - 1; }
+
+// icf_threads_str1 and icf_threads_str3 hold the same string, so these
+// three fold into one.
+const char* kept_merge_func_1() { return icf_threads_str1; }
+const char* folded_merge_func_1() { return icf_threads_str1; }
+const char* folded_merge_func_2() { return icf_threads_str3; }
+
+// A different string, so this one is kept.
+const char* kept_merge_func_2() { return icf_threads_str2; }
+
+// These call functions which fold, so they fold in a later iteration.
+int kept_caller(int x) { return kept_func_1(x) + kept_func_2(x); }
+int folded_caller(int x) { return folded_func_1(x) + kept_func_2(x); }
+
+extern int folded_func_3(int);
+extern const char* folded_merge_func_3();
+
+int
+main()
+{
+  if (kept_func_1(1) != folded_func_1(1)
+      || folded_func_2(2) != folded_func_3(2)
+      || kept_caller(3) != folded_caller(3)
+      || kept_merge_func_1()[0] != folded_merge_func_2()[0]
+      || folded_merge_func_1()[0] != folded_merge_func_3()[0]
+      || kept_merge_func_2()[0] == kept_merge_func_1()[0])
+    return 1;
+  return 0;
+}
@@ -0,0 +1,42 @@
+// icf_threads_test_2.cc -- a test case for gold
+
+// Copyright (C) 2017 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// Global symbols in a string merge section, used by the functions in
+// icf_threads_test_1.cc.  The compiler only puts local labels in merge
+// sections, so the strings are written in assembler.
+
+__asm__(".pushsection .rodata.icf_threads,\"aMS\",%progbits,1\n"
+	".globl icf_threads_str1\n"
+	"icf_threads_str1:\n"
+	"\t.string \"icf threads\"\n"
+	".globl icf_threads_str2\n"
+	"icf_threads_str2:\n"
+	"\t.string \"other string\"\n"
+	".globl icf_threads_str3\n"
+	"icf_threads_str3:\n"
+	"\t.string \"icf threads\"\n"
+	".popsection\n");
+
+extern const char icf_threads_str1[];
+
+int folded_func_3(int x) { return x * 3 + 7; }
+
+const char* folded_merge_func_3() { return icf_threads_str1; }
@@ -0,0 +1,12 @@
+' gas --dual-encoding assembles _start as CMM and again as LMM, for
+' the GNU linker to keep one of the two.  gold does not choose, so
+' it must refuse the object rather than link both.
+	.global	r0
+	r0 = 0
+	.global	r1
+	r1 = 4
+	.section .text.start,"ax",@progbits
+	.global	_start
+_start:
+	mov	r0,r1
+	add	r0,#1
@@ -0,0 +1,60 @@
+#!/bin/sh
+
+# propeller_layout.sh -- test the Propeller layout without a linker
+# script.
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# As with the default script of bfd ld, .text starts at 0 and the
+# file and program headers are not in a loadable segment.
+
+check()
+{
+    file=$1
+    pattern=$2
+    found=`grep "$pattern" $file`
+    if test -z "$found"; then
+        echo "pattern \"$pattern\" not found in file $file."
+        echo ""
+        echo "Actual output below:"
+        cat "$file"
+        exit 1
+    fi
+}
+
+check_missing()
+{
+    file=$1
+    pattern=$2
+    found=`grep "$pattern" $file`
+    if test -n "$found"; then
+        echo "pattern \"$pattern\" found in file $file."
+        echo ""
+        echo "Actual output below:"
+        cat "$file"
+        exit 1
+    fi
+}
+
+check propeller_layout.stdout "Entry point 0x0$"
+check propeller_layout.stdout " \.text  *PROGBITS  *00000000 "
+check_missing propeller_layout.stdout "LOAD  *0x000000 "
+
+exit 0
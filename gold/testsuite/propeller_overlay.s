@@ -0,0 +1,22 @@
+' The orphan foo.cog is a cog overlay: it is loaded after .text but
+' runs at address 0 of the coguser region.  bfd ld gives the same
+' addresses and contents.
+	.text
+	.global	_start
+_start:
+	jmp	#_start
+	long	__load_start_foo_cog
+	long	__load_stop_foo_cog
+	' R_PROPELLER_32_DIV4, 16_DIV4 and 8_DIV4
+	long	&cogvar
+	word	&cogvar
+	byte	&cogvar
+	byte	0
+	.data
+	long	1
+	.section foo.cog,"ax",@progbits
+foo:
+	mov	tmp, cogvar
+	jmp	#foo
+cogvar:	long	0
+tmp:	long	0
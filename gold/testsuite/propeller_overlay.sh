@@ -0,0 +1,53 @@
+#!/bin/sh
+
+# propeller_overlay.sh -- test Propeller cog overlays and DIV4 relocs.
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The expected values are what bfd ld produces for the same input.
+
+check()
+{
+    file=$1
+    pattern=$2
+    found=`grep "$pattern" $file`
+    if test -z "$found"; then
+        echo "pattern \"$pattern\" not found in file $file."
+        echo ""
+        echo "Actual output below:"
+        cat "$file"
+        exit 1
+    fi
+}
+
+# foo.cog runs at 0 but is loaded after .text.
+check propeller_overlay.stdout "foo.cog  *00000010  00000000  00000014 "
+check propeller_overlay.stdout "\.data  *00000004  00000024  00000024 "
+check propeller_overlay.stdout "^00000014 g .*__load_start_foo_cog$"
+check propeller_overlay.stdout "^00000024 g .*__load_stop_foo_cog$"
+
+# The load addresses, then &cogvar as a long, a word and a byte.
+check propeller_overlay.stdout "^ 0000 00007c5c 14000000 24000000 02000000 "
+check propeller_overlay.stdout "^ 0010 02000200 "
+
+# cogvar and tmp in the overlay are long addresses.
+check propeller_overlay.stdout "^ 0000 0206bca0 00007c5c 00000000 00000000 "
+
+exit 0
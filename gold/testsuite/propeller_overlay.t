@@ -0,0 +1,14 @@
+/* The memory regions and hub sections of the default Propeller linker
+   script that matter for cog overlays.  */
+MEMORY
+{
+  hub     : ORIGIN = 0, LENGTH = 32K
+  coguser : ORIGIN = 0, LENGTH = 1984
+  kerextmem : ORIGIN = 0x6C0, LENGTH = 0x100
+}
+SECTIONS
+{
+  .text : { *(.text*) } >hub AT>hub
+  .data : { *(.data*) } >hub AT>hub
+  .bss : { *(.bss*) } >hub AT>hub
+}
@@ -0,0 +1,12 @@
+' R_PROPELLER_REPINSCNT holds one less than the number of
+' instructions.  bfd ld gives the same encodings.
+	.text
+	.global	_start
+_start:
+	repd	#5, #count
+	repd	#5, #one
+	nop
+	.global	count
+	.global	one
+	count = 33
+	one = 1
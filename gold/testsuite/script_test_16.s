@@ -0,0 +1,8 @@
+	.text
+	.long 1
+
+	.data
+	.long 2
+
+	.section .orphan, "aw"
+	.long 3
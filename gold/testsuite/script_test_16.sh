@@ -0,0 +1,41 @@
+#!/bin/sh
+
+# script_test_16.sh -- test LOADADDR of an orphan section.
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# script_test_16.t takes LOADADDR of .orphan before the orphan is
+# given an address.  gold used to crash on it; the symbol must end up
+# with the load address of .orphan, which here is its address.
+
+file=script_test_16.stdout
+
+section=`sed -n -e 's/.* \.orphan  *[A-Z_]*  *\([0-9a-f]*\) .*/\1/p' $file`
+symbol=`sed -n -e 's/^ *[0-9]*: \([0-9a-f]*\) .* orphan_load$/\1/p' $file`
+
+if test -z "$section" || test "$section" != "$symbol"; then
+    echo "orphan_load ($symbol) is not the address of .orphan ($section)"
+    echo ""
+    echo "Actual output below:"
+    cat $file
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,8 @@
+/* The .orphan section is placed after .data, so its address is not
+   known yet when orphan_load is first evaluated.  */
+SECTIONS
+{
+  .text : { *(.text) }
+  orphan_load = LOADADDR(.orphan);
+  .data : { *(.data) }
+}
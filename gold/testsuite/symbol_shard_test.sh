@@ -0,0 +1,71 @@
+#!/bin/sh
+
+# symbol_shard_test.sh -- test symbol resolution with a sharded symbol table.
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# symbol_shard_test is linked with --threads, so that the symbols of
+# its objects are added in parallel.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected symbol in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_missing()
+{
+    if grep -q "$2" "$1"
+    then
+	echo "Found unexpected symbol in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+# The program checks the weak, common, archive, --start-lib and
+# versioned definitions it calls.
+if ! ./symbol_shard_test
+then
+    echo "symbol_shard_test failed"
+    exit 1
+fi
+
+# The larger of the two common symbols.
+check symbol_shard_test.syms " 32 OBJECT *GLOBAL *DEFAULT .* shard_common$"
+
+# Neither the unused --start-lib member nor the member of the second
+# archive is loaded.
+check_missing symbol_shard_test.syms "shard_lib_unused"
+check_missing symbol_shard_test.syms "symbol_shard_test_3.c"
+check symbol_shard_test.syms "symbol_shard_test_2.c"
+check symbol_shard_test.syms "symbol_shard_test_4.c"
+
+exit 0
@@ -0,0 +1,5 @@
+V1 {
+};
+
+V2 {
+} V1;
@@ -0,0 +1,46 @@
+/* symbol_shard_test_1.c -- overriding definitions for symbol_shard_test.
+
+   Copyright (C) 2017 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* Overrides the weak definition in symbol_shard_test_main.c.  */
+int
+shard_weak (void)
+{
+  return 2;
+}
+
+/* Larger than the common symbol in symbol_shard_test_main.c.  */
+char shard_common[32] __attribute__ ((common));
+
+int shard_common_def = 3;
+
+int
+shard_versioned_1 (void)
+{
+  return 1;
+}
+__asm__ (".symver shard_versioned_1,shard_versioned@V1");
+
+int
+shard_versioned_2 (void)
+{
+  return 2;
+}
+__asm__ (".symver shard_versioned_2,shard_versioned@@V2");
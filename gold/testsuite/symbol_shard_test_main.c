@@ -0,0 +1,60 @@
+/* symbol_shard_test_main.c -- test symbol resolution with sharded symbols.
+
+   Copyright (C) 2017 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   The symbols of the objects in this test are added to the symbol
+   table in parallel when gold runs with --threads.  The resolution
+   must be the same as in a serial link.  */
+
+#include <assert.h>
+
+/* A weak definition, overridden by a strong one in a later object.  */
+int __attribute__ ((weak))
+shard_weak (void)
+{
+  return 1;
+}
+
+/* A common symbol, merged with a larger common symbol in a later
+   object.  */
+char shard_common[8] __attribute__ ((common));
+
+/* A common symbol, overridden by a definition in a later object.  */
+int shard_common_def __attribute__ ((common));
+
+/* Defined in two archives; the first archive searched wins.  */
+extern int shard_archive (void);
+
+/* Defined by a --start-lib member.  */
+extern int shard_lib (void);
+
+/* Defined with a default version and an older version.  */
+extern int shard_versioned (void);
+
+int
+main (void)
+{
+  assert (shard_weak () == 2);
+  assert (shard_common_def == 3);
+  assert (shard_archive () == 10);
+  assert (shard_lib () == 20);
+  assert (shard_versioned () == 2);
+  return 0;
+}
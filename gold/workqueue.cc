@@ -94,6 +94,35 @@ Task_list::pop_front()
   return ret;
 }
 
+// Class Thread_task_list.
+
+// Add T to the end of the list.
+
+void
+Thread_task_list::push_back(Task* t)
+{
+  Hold_lock hl(this->lock_);
+  this->tasks_.push_back(t);
+}
+
+// Remove and return the first Task on the list.
+
+Task*
+Thread_task_list::pop_front()
+{
+  Hold_lock hl(this->lock_);
+  return this->tasks_.pop_front();
+}
+
+// Return whether the list is empty.
+
+bool
+Thread_task_list::empty()
+{
+  Hold_lock hl(this->lock_);
+  return this->tasks_.empty();
+}
+
 // The simple single-threaded implementation of Workqueue_threader.
 
 class Workqueue_threader_single : public Workqueue_threader
@@ -120,15 +149,22 @@ Workqueue::Workqueue(const General_options& options)
   : lock_(),
     first_tasks_(),
     tasks_(),
+    thread_task_count_(0),
     running_(0),
     waiting_(0),
+    sleeping_(0),
     condvar_(this->lock_),
-    threader_(NULL)
+    threader_(NULL),
+    thread_tasks_(),
+    thread_tasks_lock_()
 {
   bool threads = options.threads();
 #ifndef ENABLE_THREADS
   threads = false;
 #endif
+  // The main thread is thread number 0.
+  this->thread_tasks_.push_back(new Thread_task_list());
+
   if (!threads)
     this->threader_ = new Workqueue_threader_single(this);
   else
@@ -143,6 +179,11 @@ Workqueue::Workqueue(const General_options& options)
 
 Workqueue::~Workqueue()
 {
+  for (std::vector<Thread_task_list*>::iterator p =
+	 this->thread_tasks_.begin();
+       p != this->thread_tasks_.end();
+       ++p)
+    delete *p;
 }
 
 // Add a task to the end of a specific queue, or put it on the list
@@ -169,7 +210,7 @@ Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
       else
 	queue->push_back(t);
       // Tell any waiting thread that there is work to do.
-      this->condvar_.signal();
+      this->signal_sleeping_thread();
     }
 }
 
@@ -230,53 +271,180 @@ Workqueue::find_runnable_in_list(Task_list* tasks)
   return NULL;
 }
 
-// Find a runnable task.  Return NULL if none could be found.  The
-// workqueue lock must be held when this is called.
+// Find a runnable task on the list of thread THREAD_NUMBER.  Return
+// NULL if none could be found.  If we find a Task waiting for a
+// Token, add it to the list for that Token.  The workqueue lock must
+// be held when this is called.
 
 Task*
-Workqueue::find_runnable()
+Workqueue::find_runnable_in_thread_list(int thread_number)
+{
+  Thread_task_list* list = this->thread_tasks_[thread_number];
+  Task* t;
+  while ((t = list->pop_front()) != NULL)
+    {
+      --this->thread_task_count_;
+
+      Task_token* token = t->is_runnable();
+
+      if (token == NULL)
+	return t;
+
+      token->add_waiting(t);
+      ++this->waiting_;
+    }
+
+  return NULL;
+}
+
+// Find a runnable task for thread THREAD_NUMBER.  Tasks which should
+// run soon come first, then the tasks this thread unblocked, then the
+// shared queue.  Return NULL if none could be found.  The workqueue
+// lock must be held when this is called.
+
+Task*
+Workqueue::find_runnable(int thread_number)
 {
   Task* t = this->find_runnable_in_list(&this->first_tasks_);
+  if (t == NULL)
+    t = this->find_runnable_in_thread_list(thread_number);
   if (t == NULL)
     t = this->find_runnable_in_list(&this->tasks_);
   return t;
 }
 
-// Find a runnable a task, and wait until we find one.  Return NULL if
-// we should exit.  The workqueue lock must be held when this is
-// called.
+// Take a task from the list of another thread.  We start with the
+// next thread number, so that idle threads do not all go to the same
+// list.  The task may not be runnable; the caller must check.  Return
+// NULL if all the lists are empty.  The workqueue lock must not be
+// held when this is called.  Only the list of one victim is locked
+// at a time; the vector lock is held just long enough to find it.
 
 Task*
-Workqueue::find_runnable_or_wait(int thread_number)
+Workqueue::steal_task(int thread_number)
 {
-  Task* t = this->find_runnable();
+  int count;
+  {
+    Hold_lock hl(this->thread_tasks_lock_);
+    count = this->thread_tasks_.size();
+  }
 
-  while (t == NULL)
+  for (int i = 1; i < count; ++i)
     {
-      if (this->running_ == 0
-	  && this->first_tasks_.empty()
-	  && this->tasks_.empty())
+      int victim = (thread_number + i) % count;
+      Thread_task_list* list;
+      {
+	Hold_lock hl(this->thread_tasks_lock_);
+	list = this->thread_tasks_[victim];
+      }
+      // The lists are never removed, so LIST stays valid after the
+      // vector lock is released.
+      Task* t = list->pop_front();
+      if (t != NULL)
 	{
-	  // Kick all the threads to make them exit.
-	  this->condvar_.broadcast();
-
-	  gold_assert(this->waiting_ == 0);
-	  return NULL;
+	  gold_debug(DEBUG_TASK, "%3d stole     task %s from %d",
+		     thread_number, t->name().c_str(), victim);
+	  return t;
 	}
+    }
+  return NULL;
+}
 
-      if (this->should_cancel_thread(thread_number))
-	return NULL;
+// Add the runnable task T to the list of thread THREAD_NUMBER.  The
+// workqueue lock must be held when this is called.
 
-      gold_debug(DEBUG_TASK, "%3d sleeping", thread_number);
+void
+Workqueue::push_thread_task(int thread_number, Task* t)
+{
+  this->thread_tasks_[thread_number]->push_back(t);
+  ++this->thread_task_count_;
+  this->signal_sleeping_thread();
+}
 
-      this->condvar_.wait();
+// Wake up one thread, if any are waiting for work.  The workqueue
+// lock must be held when this is called.
 
-      gold_debug(DEBUG_TASK, "%3d awake", thread_number);
+void
+Workqueue::signal_sleeping_thread()
+{
+  if (this->sleeping_ > 0)
+    this->condvar_.signal();
+}
 
-      t = this->find_runnable();
-    }
+// Find a runnable a task, and wait until we find one.  Get the locks
+// for the task into TL.  Return NULL if we should exit.  The workqueue
+// lock must not be held when this is called.  We only take it to look
+// at the Task_tokens and the shared lists, not to steal tasks from
+// other threads.
 
-  return t;
+Task*
+Workqueue::find_runnable_or_wait(int thread_number, Task_locker* tl)
+{
+  while (true)
+    {
+      {
+	Hold_lock hl(this->lock_);
+
+	Task* t = this->find_runnable(thread_number);
+	if (t != NULL)
+	  {
+	    // Get the locks for the task.  This must be called while
+	    // we are still holding the Workqueue lock.
+	    t->locks(tl);
+	    ++this->running_;
+	    return t;
+	  }
+
+	if (this->thread_task_count_ == 0)
+	  {
+	    if (this->running_ == 0
+		&& this->first_tasks_.empty()
+		&& this->tasks_.empty())
+	      {
+		// Kick all the threads to make them exit.
+		this->condvar_.broadcast();
+
+		gold_assert(this->waiting_ == 0);
+		return NULL;
+	      }
+
+	    if (this->should_cancel_thread(thread_number))
+	      return NULL;
+
+	    gold_debug(DEBUG_TASK, "%3d sleeping", thread_number);
+
+	    ++this->sleeping_;
+	    this->condvar_.wait();
+	    --this->sleeping_;
+
+	    gold_debug(DEBUG_TASK, "%3d awake", thread_number);
+
+	    continue;
+	  }
+      }
+
+      // Some other thread has tasks on its list, so steal one.  If the
+      // lists are all empty, another thread has just stolen the last
+      // task and is about to start it, so we look again.
+      Task* t = this->steal_task(thread_number);
+      if (t != NULL)
+	{
+	  Hold_lock hl(this->lock_);
+
+	  --this->thread_task_count_;
+
+	  Task_token* token = t->is_runnable();
+	  if (token == NULL)
+	    {
+	      t->locks(tl);
+	      ++this->running_;
+	      return t;
+	    }
+
+	  token->add_waiting(t);
+	  ++this->waiting_;
+	}
+    }
 }
 
 // Find and run tasks.  If we can't find a runnable task, wait for one
@@ -288,24 +456,13 @@ Workqueue::find_runnable_or_wait(int thread_number)
 bool
 Workqueue::find_and_run_task(int thread_number)
 {
-  Task* t;
   Task_locker tl;
 
-  {
-    Hold_lock hl(this->lock_);
-
-    // Find a runnable task.
-    t = this->find_runnable_or_wait(thread_number);
+  // Find a runnable task.
+  Task* t = this->find_runnable_or_wait(thread_number, &tl);
 
-    if (t == NULL)
-      return false;
-
-    // Get the locks for the task.  This must be called while we are
-    // still holding the Workqueue lock.
-    t->locks(&tl);
-
-    ++this->running_;
-  }
+  if (t == NULL)
+    return false;
 
   while (t != NULL)
     {
@@ -339,10 +496,10 @@ Workqueue::find_and_run_task(int thread_number)
 
 	// Release the locks for the task.  This must be done with the
 	// workqueue lock held.  Get the next Task to run if any.
-	next = this->release_locks(t, &tl);
+	next = this->release_locks(t, &tl, thread_number);
 
 	if (next == NULL)
-	  next = this->find_runnable();
+	  next = this->find_runnable(thread_number);
 
 	// If we have another Task to run, get the Locks.  This must
 	// be called while we are still holding the Workqueue lock.
@@ -371,7 +528,8 @@ Workqueue::find_and_run_task(int thread_number)
 
 // 2) Otherwise, T is runnable.  If *PRET is not NULL, then we have
 // already decided which Task to run next.  Add T to the list of
-// runnable tasks, and signal another thread.
+// runnable tasks for this thread, THREAD_NUMBER, and signal another
+// thread, which may steal it.
 
 // 3) Otherwise, *PRET is NULL.  If IS_BLOCKER is false, then T was
 // waiting on a write lock.  We can grab that lock now, so we run T
@@ -384,7 +542,7 @@ Workqueue::find_and_run_task(int thread_number)
 // are, then we generally get a better ordering if we run those tasks
 // now, before T.  A typical example is tasks waiting on the Dirsearch
 // blocker.  We don't want to run those tasks right away just because
-// the Dirsearch was unblocked.
+// the Dirsearch was unblocked.  T goes to the end of the shared list.
 
 // 6) Otherwise, there are no other tasks to run, so we might as well
 // run this one now.
@@ -394,7 +552,8 @@ Workqueue::find_and_run_task(int thread_number)
 // Return true if we set *PRET to T, false otherwise.
 
 bool
-Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
+Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret,
+			   int thread_number)
 {
   Task_token* token = t->is_runnable();
 
@@ -414,7 +573,9 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
     should_return = true;
   else if (t->should_run_soon())
     should_return = true;
-  else if (!this->first_tasks_.empty() || !this->tasks_.empty())
+  else if (!this->first_tasks_.empty()
+	   || !this->thread_tasks_[thread_number]->empty()
+	   || !this->tasks_.empty())
     should_queue = true;
   else
     should_return = true;
@@ -428,10 +589,17 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
   else if (should_queue)
     {
       if (t->should_run_soon())
-	this->first_tasks_.push_back(t);
+	{
+	  this->first_tasks_.push_back(t);
+	  this->signal_sleeping_thread();
+	}
+      else if (*pret != NULL)
+	this->push_thread_task(thread_number, t);
       else
-	this->tasks_.push_back(t);
-      this->condvar_.signal();
+	{
+	  this->tasks_.push_back(t);
+	  this->signal_sleeping_thread();
+	}
       return false;
     }
 
@@ -440,11 +608,11 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
 
 // Release the locks associated with a Task.  Return the first
 // runnable Task that we find.  If we find more runnable tasks, add
-// them to the run queue and signal any other threads.  This must be
-// called with the Workqueue lock held.
+// them to the run queue of thread THREAD_NUMBER and signal any other
+// threads.  This must be called with the Workqueue lock held.
 
 Task*
-Workqueue::release_locks(Task* t, Task_locker* tl)
+Workqueue::release_locks(Task* t, Task_locker* tl, int thread_number)
 {
   Task* ret = NULL;
   for (Task_locker::iterator p = tl->begin(); p != tl->end(); ++p)
@@ -460,7 +628,7 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	      while ((t = token->remove_first_waiting()) != NULL)
 		{
 		  --this->waiting_;
-		  this->return_or_queue(t, true, &ret);
+		  this->return_or_queue(t, true, &ret, thread_number);
 		}
 	    }
 	}
@@ -477,7 +645,7 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	  while ((t = token->remove_first_waiting()) != NULL)
 	    {
 	      --this->waiting_;
-	      if (this->return_or_queue(t, false, &ret))
+	      if (this->return_or_queue(t, false, &ret, thread_number))
 		break;
 	    }
 	}
@@ -504,6 +672,16 @@ Workqueue::set_thread_count(int threads)
 {
   Hold_lock hl(this->lock_);
 
+  // Each new thread needs a list of its own.  We never remove these
+  // lists; any tasks left on the list of a thread which exits will be
+  // stolen by the remaining threads.
+  if (static_cast<int>(this->thread_tasks_.size()) < threads)
+    {
+      Hold_lock hl2(this->thread_tasks_lock_);
+      while (static_cast<int>(this->thread_tasks_.size()) < threads)
+	this->thread_tasks_.push_back(new Thread_task_list());
+    }
+
   this->threader_->set_thread_count(threads);
   // Wake up all the threads, since something has changed.
   this->condvar_.broadcast();
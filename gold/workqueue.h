@@ -28,6 +28,7 @@
 #define GOLD_WORKQUEUE_H
 
 #include <string>
+#include <vector>
 
 #include "gold-threads.h"
 #include "token.h"
@@ -191,6 +192,43 @@ class Task_function : public Task
   const char* name_;
 };
 
+// The runnable Tasks which one thread of the workqueue has made
+// ready.  Each list has its own lock, so that a thread can steal
+// Tasks from the list of another thread without holding the
+// Workqueue lock.  If both are held, the Workqueue lock is acquired
+// first.
+
+class Thread_task_list
+{
+ public:
+  Thread_task_list()
+    : lock_(), tasks_()
+  { }
+
+  // Add T to the end of the list.
+  void
+  push_back(Task* t);
+
+  // Remove the first Task on the list and return it.  Return NULL if
+  // the list is empty.
+  Task*
+  pop_front();
+
+  // Return whether the list is empty.
+  bool
+  empty();
+
+ private:
+  // This class can not be copied.
+  Thread_task_list(const Thread_task_list&);
+  Thread_task_list& operator=(const Thread_task_list&);
+
+  // Lock for tasks_.
+  Lock lock_;
+  // The Tasks.
+  Task_list tasks_;
+};
+
 // The workqueue itself.
 
 class Workqueue_threader;
@@ -242,13 +280,29 @@ class Workqueue
   void
   add_to_queue(Task_list* queue, Task* t, bool front);
 
-  // Find a runnable task, or wait for one.
+  // Find a runnable task, or wait for one, and get its locks.
   Task*
-  find_runnable_or_wait(int thread_number);
+  find_runnable_or_wait(int thread_number, Task_locker*);
 
   // Find a runnable task.
   Task*
-  find_runnable();
+  find_runnable(int thread_number);
+
+  // Find a runnable task on the list of a thread.
+  Task*
+  find_runnable_in_thread_list(int thread_number);
+
+  // Take a task from the list of another thread.
+  Task*
+  steal_task(int thread_number);
+
+  // Add a runnable task to the list of a thread.
+  void
+  push_thread_task(int thread_number, Task* t);
+
+  // Tell a sleeping thread that there is work to do.
+  void
+  signal_sleeping_thread();
 
   // Find a runnable task in a list.
   Task*
@@ -260,11 +314,11 @@ class Workqueue
 
   // Release the locks for a Task.  Return the next Task to run.
   Task*
-  release_locks(Task*, Task_locker*);
+  release_locks(Task*, Task_locker*, int thread_number);
 
   // Store T into *PRET, or queue it as appropriate.
   bool
-  return_or_queue(Task* t, bool is_blocker, Task** pret);
+  return_or_queue(Task* t, bool is_blocker, Task** pret, int thread_number);
 
   // Return whether to cancel this thread.
   bool
@@ -277,10 +331,15 @@ class Workqueue
   Task_list first_tasks_;
   // List of tasks to execute after the ones in first_tasks_.
   Task_list tasks_;
+  // Number of Tasks on the thread_tasks_ lists, plus the number which
+  // a thread has stolen but not yet started.
+  int thread_task_count_;
   // Number of tasks currently running.
   int running_;
   // Number of tasks waiting for a lock to release.
   int waiting_;
+  // Number of threads waiting on condvar_.
+  int sleeping_;
   // Condition variable associated with lock_.  This is signalled when
   // there may be a new Task to execute.
   Condvar condvar_;
@@ -288,6 +347,17 @@ class Workqueue
   // The threading implementation.  This is set at construction time
   // and not changed thereafter.
   Workqueue_threader* threader_;
+
+  // Lists of runnable tasks which each thread has unblocked, indexed
+  // by thread number.  A thread looks at its own list before tasks_,
+  // and steals from the lists of the other threads when it has
+  // nothing else to do.  The lists themselves have their own locks.
+  std::vector<Thread_task_list*> thread_tasks_;
+  // Lock for the thread_tasks_ vector, as opposed to the lists.  The
+  // vector is only changed with both this lock and lock_ held, so it
+  // is safe to read it while holding either one.  It is never held
+  // while taking the lock of a list.
+  Lock thread_tasks_lock_;
 };
 
 } // End namespace gold.
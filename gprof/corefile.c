@@ -55,6 +55,7 @@ extern void tahoe_find_call (Sym *, bfd_vma, bfd_vma);
 extern void sparc_find_call (Sym *, bfd_vma, bfd_vma);
 extern void mips_find_call  (Sym *, bfd_vma, bfd_vma);
 extern void aarch64_find_call (Sym *, bfd_vma, bfd_vma);
+extern void propeller_find_call (Sym *, bfd_vma, bfd_vma);
 
 static void
 parse_error (const char *filename)
@@ -331,6 +332,10 @@ find_call (Sym *parent, bfd_vma p_lowpc, bfd_vma p_highpc)
       aarch64_find_call (parent, p_lowpc, p_highpc);
       break;
 
+    case bfd_arch_propeller:
+      propeller_find_call (parent, p_lowpc, p_highpc);
+      break;
+
     default:
       fprintf (stderr, _("%s: -c not supported on architecture %s\n"),
 	       whoami, bfd_printable_name(core_bfd));
@@ -356,6 +361,13 @@ core_sym_class (asymbol *sym)
   if (sym->section == NULL || (sym->flags & BSF_DEBUGGING) != 0)
     return 0;
 
+  /* The Propeller kernel and cog overlays run at cog addresses, which
+     overlap the addresses of the program in hub memory.  */
+  if (bfd_get_arch (core_bfd) == bfd_arch_propeller
+      && sym->section != core_text_sect
+      && sym->section->vma != sym->section->lma)
+    return 0;
+
   /* Must be a text symbol, and static text symbols
      don't qualify if ignore_static_funcs set.   */
   if (ignore_static_funcs && (sym->flags & BSF_LOCAL))
@@ -0,0 +1,342 @@
+/* Gprof -c option support for the Parallax Propeller.
+   Copyright 2017 Parallax Inc.
+
+   Based upon gprof/mips.c.
+
+   This file is part of GNU Binutils.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#include "gprof.h"
+#include "libiberty.h"
+#include "search_list.h"
+#include "source.h"
+#include "symtab.h"
+#include "cg_arcs.h"
+#include "corefile.h"
+#include "hist.h"
+#include "elf-bfd.h"
+#include "elf/propeller.h"
+#include "opcode/propeller.h"
+
+/* LMM and CMM code runs in hub memory, interpreted by a kernel in a
+   cog.  A call is a jump to a kernel routine followed by the address
+   of the function in the instruction stream:
+
+     LMM:  jmp #__LMM_CALL ; long func
+     CMM:  lcall func (MACRO_LCALL), or the LMM form as a native
+	   instruction (MACRO_NATIVE or PREFIX_PACK_NATIVE)
+
+   Calls through a pointer go to __LMM_CALL_INDIRECT.  Other kernel
+   routines (__LMM_MVI_rN, __MULSI, ...) run in the cog; their time is
+   sampled at the pc of the caller, so they get no arcs.  Cog code
+   calls with jmpret to a cog address.  */
+
+enum kernel_helper
+{
+  HELPER_NONE,
+  HELPER_CALL,
+  HELPER_CALL_INDIRECT,
+  HELPER_LONG,			/* takes a long operand: __LMM_JMP, __LMM_MVI_rN */
+  HELPER_FCACHE
+};
+
+static Sym indirect_child;
+static enum kernel_helper cog_helper[512];
+static bfd_vma *cmm_funcs;
+static long cmm_num_funcs;
+static bfd_boolean is_p2;
+
+void propeller_find_call (Sym *, bfd_vma, bfd_vma);
+
+static int
+compare_vma (const void *a, const void *b)
+{
+  bfd_vma va = *(const bfd_vma *) a;
+  bfd_vma vb = *(const bfd_vma *) b;
+
+  return va < vb ? -1 : va > vb;
+}
+
+/* Find the kernel routines, by cog address, and the functions that
+   are compiled to CMM.  */
+static void
+propeller_init (void)
+{
+  asymbol **syms;
+  long storage, num_syms, i;
+
+  sym_init (&indirect_child);
+  indirect_child.name = _("<indirect child>");
+  indirect_child.cg.prop.fract = 1.0;
+  indirect_child.cg.cyc.head = &indirect_child;
+
+  if (bfd_get_flavour (core_bfd) == bfd_target_elf_flavour)
+    is_p2 = (elf_elfheader (core_bfd)->e_flags & EF_PROPELLER_PROP2) != 0;
+
+  storage = bfd_get_symtab_upper_bound (core_bfd);
+  if (storage <= 0)
+    return;
+  syms = (asymbol **) xmalloc (storage);
+  num_syms = bfd_canonicalize_symtab (core_bfd, syms);
+  cmm_funcs = (bfd_vma *) xmalloc ((num_syms > 0 ? num_syms : 1)
+				   * sizeof (bfd_vma));
+
+  for (i = 0; i < num_syms; i++)
+    {
+      const char *name = bfd_asymbol_name (syms[i]);
+      enum kernel_helper helper = HELPER_NONE;
+      bfd_vma cog;
+
+      if (bfd_is_und_section (syms[i]->section))
+	continue;
+      if (bfd_get_flavour (core_bfd) == bfd_target_elf_flavour
+	  && (((elf_symbol_type *) syms[i])->internal_elf_sym.st_other
+	      & PROPELLER_OTHER_COMPRESSED) != 0)
+	cmm_funcs[cmm_num_funcs++] = bfd_asymbol_value (syms[i]);
+
+      if (strcmp (name, "__LMM_CALL") == 0)
+	helper = HELPER_CALL;
+      else if (strcmp (name, "__LMM_CALL_INDIRECT") == 0)
+	helper = HELPER_CALL_INDIRECT;
+      else if (strcmp (name, "__LMM_JMP") == 0
+	       || strncmp (name, "__LMM_MVI_", 10) == 0)
+	helper = HELPER_LONG;
+      else if (strcmp (name, "__LMM_FCACHE_LOAD") == 0)
+	helper = HELPER_FCACHE;
+      if (helper == HELPER_NONE)
+	continue;
+
+      /* kernel labels are byte addresses in cog memory */
+      cog = bfd_asymbol_value (syms[i]);
+      if (!bfd_is_abs_section (syms[i]->section))
+	cog >>= 2;
+      cog_helper[cog & 511] = helper;
+    }
+  free (syms);
+
+  qsort (cmm_funcs, cmm_num_funcs, sizeof (bfd_vma), compare_vma);
+}
+
+static bfd_boolean
+propeller_cmm_function (bfd_vma addr)
+{
+  return bsearch (&addr, cmm_funcs, cmm_num_funcs, sizeof (bfd_vma),
+		  compare_vma) != NULL;
+}
+
+static bfd_boolean
+propeller_read (bfd_vma pc, unsigned int len, unsigned long *val)
+{
+  bfd_byte *p;
+
+  if (pc < core_text_sect->vma
+      || pc + len > core_text_sect->vma + bfd_get_section_size (core_text_sect))
+    return FALSE;
+  p = (bfd_byte *) core_text_space + pc - core_text_sect->vma;
+  switch (len)
+    {
+    case 1:
+      *val = bfd_get_8 (core_bfd, p);
+      break;
+    case 2:
+      *val = bfd_get_16 (core_bfd, p);
+      break;
+    case 3:
+      *val = bfd_get_16 (core_bfd, p) | (bfd_get_8 (core_bfd, p + 2) << 16);
+      break;
+    default:
+      *val = bfd_get_32 (core_bfd, p);
+      break;
+    }
+  return TRUE;
+}
+
+static void
+propeller_add_arc (Sym *parent, bfd_vma pc, bfd_vma dest_pc)
+{
+  Sym *child;
+
+  DBG (CALLDEBUG, printf (_("[find_call] 0x%lx: call 0x%lx"),
+			  (unsigned long) pc, (unsigned long) dest_pc));
+  if (hist_check_address (dest_pc))
+    {
+      child = sym_lookup (&symtab, dest_pc);
+      if (child)
+	{
+	  DBG (CALLDEBUG,
+	       printf ("\t; name=%s, addr=0x%lx",
+		       child->name, (unsigned long) child->addr));
+	  if (child->addr == dest_pc)
+	    {
+	      DBG (CALLDEBUG, printf ("\n"));
+	      /* a hit:  */
+	      arc_add (parent, child, (unsigned long) 0);
+	      return;
+	    }
+	}
+    }
+  /* Something funny going on.  */
+  DBG (CALLDEBUG, printf ("\tbut it's a botch\n"));
+}
+
+/* Look at the native instruction INSN at PC.  Returns the number of
+   bytes of operands that follow it in the LMM/CMM stream.  */
+static bfd_vma
+propeller_native_call (Sym *parent, bfd_vma pc, bfd_vma next,
+		       unsigned long insn, bfd_boolean cog)
+{
+  unsigned long val;
+
+  /* jmp, jmpret and call with an immediate target */
+  if ((insn >> 26) != 0x17 || (insn & (1 << 22)) == 0)
+    return 0;
+
+  if (cog)
+    {
+      /* jmpret saves the return address: a call in cog code */
+      if (insn & (1 << 23))
+	propeller_add_arc (parent, pc, (insn & 0x1ff) << 2);
+      return 0;
+    }
+
+  if (insn & (1 << 23))
+    return 0;
+  switch (cog_helper[insn & 0x1ff])
+    {
+    case HELPER_CALL:
+      if (propeller_read (next, 4, &val))
+	propeller_add_arc (parent, pc, val);
+      return 4;
+    case HELPER_CALL_INDIRECT:
+      DBG (CALLDEBUG,
+	   printf (_("[find_call] 0x%lx: indirect call\n"), (unsigned long) pc));
+      arc_add (parent, &indirect_child, (unsigned long) 0);
+      return 0;
+    case HELPER_LONG:
+      return 4;
+    case HELPER_FCACHE:
+      /* the count, then the code to load into the cog */
+      if (!propeller_read (next, 4, &val))
+	return 4;
+      return 4 + ((val + 3) & ~3);
+    default:
+      return 0;
+    }
+}
+
+/* Length of the CMM instruction starting with byte OP.  */
+static unsigned int
+propeller_cmm_length (unsigned int op)
+{
+  switch (op & 0xf0)
+    {
+    case PREFIX_MACRO:
+      switch (op & 0x0f)
+	{
+	case MACRO_PUSHM: case MACRO_POPM: case MACRO_POPRET:
+	case MACRO_MVREG: case MACRO_ADDSP:
+	  return 2;
+	case MACRO_LCALL: case MACRO_XMVREG: case MACRO_FCACHE:
+	  return 3;
+	case MACRO_LJMP: case MACRO_NATIVE:
+	  return 5;
+	default:
+	  return 1;
+	}
+    case PREFIX_REGREG: case PREFIX_REGIMM4: case PREFIX_BRS:
+    case PREFIX_MVIB: case PREFIX_LEASP:
+      return 2;
+    case PREFIX_REGIMM12: case PREFIX_BRW: case PREFIX_MVIW:
+    case PREFIX_XMOVREG: case PREFIX_XMOVIMM:
+      return 3;
+    case PREFIX_MVI:
+      return 5;
+    case PREFIX_PACK_NATIVE:
+      return 4;
+    default:
+      return 1;
+    }
+}
+
+void
+propeller_find_call (Sym *parent, bfd_vma p_lowpc, bfd_vma p_highpc)
+{
+  bfd_vma pc, next;
+  unsigned long op, val;
+  static bfd_boolean inited = FALSE;
+  bfd_boolean cog;
+
+  if (!inited)
+    {
+      inited = TRUE;
+      propeller_init ();
+    }
+
+  DBG (CALLDEBUG, printf (_("[find_call] %s: 0x%lx to 0x%lx\n"),
+			  parent->name, (unsigned long) p_lowpc,
+			  (unsigned long) p_highpc));
+
+  if (!propeller_cmm_function (parent->addr))
+    {
+      /* code that runs where it is loaded is LMM, else cog code */
+      cog = (bfd_section_vma (core_bfd, core_text_sect)
+	     != bfd_section_lma (core_bfd, core_text_sect));
+      for (pc = p_lowpc; pc < p_highpc; pc = next)
+	{
+	  if (!propeller_read (pc, 4, &op))
+	    break;
+	  next = pc + 4;
+	  next += propeller_native_call (parent, pc, next, op, cog);
+	}
+      return;
+    }
+
+  for (pc = p_lowpc; pc < p_highpc; pc = next)
+    {
+      if (!propeller_read (pc, 1, &op))
+	break;
+      next = pc + propeller_cmm_length (op);
+
+      if (op == (PREFIX_MACRO | MACRO_LCALL))
+	{
+	  if (propeller_read (pc + 1, 2, &val))
+	    propeller_add_arc (parent, pc, is_p2 ? val * 4 : val);
+	}
+      else if (op == (PREFIX_MACRO | MACRO_NATIVE))
+	{
+	  if (propeller_read (pc + 1, 4, &val))
+	    next += propeller_native_call (parent, pc, next, val, FALSE);
+	}
+      else if ((op & 0xf0) == PREFIX_PACK_NATIVE)
+	{
+	  /* the condition is always, the rest is packed into three
+	     bytes */
+	  if (propeller_read (pc + 1, 3, &val))
+	    {
+	      val = (val & 0x3ffff) | (((val >> 18) & 0x3f) << 26)
+		| (0xf << 18) | ((op & 0x0f) << 22);
+	      next += propeller_native_call (parent, pc, next, val, FALSE);
+	    }
+	}
+      else if (op == (PREFIX_MACRO | MACRO_FCACHE))
+	{
+	  /* native code follows, from the next long */
+	  if (propeller_read (pc + 1, 2, &val))
+	    next = ((pc + 3 + 3) & ~(bfd_vma) 3) + ((val + 3) & ~3);
+	}
+    }
+}
@@ -350,6 +350,7 @@ extern bfd_boolean aarch64_symbol_is_valid (asymbol *, struct disassemble_info *
 extern bfd_boolean arm_symbol_is_valid (asymbol *, struct disassemble_info *);
 extern void disassemble_init_powerpc (struct disassemble_info *);
 extern void disassemble_init_s390 (struct disassemble_info *);
+extern void disassemble_free_propeller (struct disassemble_info *);
 extern void disassemble_init_wasm32 (struct disassemble_info *);
 extern const disasm_options_t *disassembler_options_powerpc (void);
 extern const disasm_options_t *disassembler_options_arm (void);
@@ -362,6 +363,10 @@ extern disassembler_ftype disassembler (bfd *);
    Should only be called after initialising the info->arch field.  */
 extern void disassemble_init_for_target (struct disassemble_info * dinfo);
 
+/* Free any state the disassembler for the target architecture hung on
+   the disassemble_info structure.  */
+extern void disassemble_free_target (struct disassemble_info *);
+
 /* Document any target specific options available from the disassembler.  */
 extern void disassembler_usage (FILE *);
 
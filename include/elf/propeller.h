@@ -51,6 +51,11 @@ START_RELOC_NUMBERS (elf_propeller_reloc_type)
   RELOC_NUMBER (R_PROPELLER_PCREL16, 16)
   RELOC_NUMBER (R_PROPELLER_PCREL8, 17)
   RELOC_NUMBER (R_PROPELLER_REPSREL, 18)
+  RELOC_NUMBER (R_PROPELLER_RELAX, 19)
+  RELOC_NUMBER (R_PROPELLER_ALIGN, 20)
+  RELOC_NUMBER (R_PROPELLER_DIFF8, 21)
+  RELOC_NUMBER (R_PROPELLER_DIFF16, 22)
+  RELOC_NUMBER (R_PROPELLER_DIFF32, 23)
 END_RELOC_NUMBERS (R_PROPELLER_max)
 
 /* processor specific flags for the ELF header e_flags field. */
@@ -74,6 +79,9 @@ END_RELOC_NUMBERS (R_PROPELLER_max)
 /* default value to put in the ABI_VERS field */
 #define DEFAULT_PROPELLER_ABI 0x1
 
+/* Processor specific section types */
+#define SHT_PROPELLER_DUAL              (SHT_LOPROC + 0) /* other encoding of a .text section */
+
 /* Processor specific values for the section header flags */
 #define SHF_PROPELLER_COGDATA           0x10000000 /* data to be loaded in a cog */
 #define PF_PROPELLER_COGDATA            0x10000000 /* same thing for a program header */
@@ -0,0 +1,38 @@
+/* This file defines the interface between the Propeller simulator and GDB.
+
+   Copyright 2017 Parallax Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+
+/* Register numbers as seen by GDB.  r0-r15 (r15 is lr), sp and pc are
+   the first cog registers of the LMM/CMM kernel; cc holds the flags.  */
+enum propeller_sim_regnum
+{
+  PROPELLER_SIM_R0_REGNUM,
+  PROPELLER_SIM_LR_REGNUM = 15,
+  PROPELLER_SIM_SP_REGNUM = 16,
+  PROPELLER_SIM_PC_REGNUM = 17,
+  PROPELLER_SIM_CC_REGNUM = 18
+};
+
+/* Number of registers.  */
+#define PROPELLER_SIM_NUM_REGS 19
+
+/* Bits of the cc register.  */
+#define PROPELLER_SIM_CC_C   0x01	/* carry flag */
+#define PROPELLER_SIM_CC_Z   0x02	/* zero flag */
+#define PROPELLER_SIM_CC_CMM 0x40	/* the pc points to CMM code */
@@ -186,6 +186,7 @@ struct propeller_effect
   int flag;
 };
 
+struct disassemble_info;
 
 int print_insn_propeller (bfd_vma memaddr, struct disassemble_info *info);
 extern const struct propeller_opcode propeller_opcodes[];
@@ -169,6 +169,1662 @@ propeller_place_orphan (asection *s, const char *secname, int constraint)
     }
   return gld${EMULATION_NAME}_place_orphan (s, secname, constraint);
 }
+
+/*
+ * profile guided hub placement: in the XMM models code runs from
+ * external memory through a cache, so the hottest functions are much
+ * faster in hub RAM; move the input sections of the functions with
+ * the most heat per byte from .text into .hub, as far as the free hub
+ * memory allows
+ */
+
+/* hub memory left free for the stack and heap when moving code */
+#define HUB_PROFILE_RESERVE 1024
+
+static const char *hub_profile_name = NULL;
+static bfd_vma hub_budget = (bfd_vma) -1;
+
+struct hub_heat
+{
+  asection *section;
+  bfd_uint64_t heat;
+};
+
+static struct hub_heat *hub_heats;
+static size_t hub_num_heats;
+static size_t hub_max_heats;
+
+/* the sections actually moved, for the map file */
+static size_t hub_num_moved;
+static bfd_vma hub_moved_size;
+static bfd_vma hub_free_size;
+
+/* Functions of the same section are added separately; hub_merge_heats
+   sums them up once the whole profile has been read.  */
+static void
+hub_add_heat (asection *sec, bfd_uint64_t heat)
+{
+  if (hub_num_heats == hub_max_heats)
+    {
+      hub_max_heats = hub_max_heats ? 2 * hub_max_heats : 64;
+      hub_heats = xrealloc (hub_heats, hub_max_heats * sizeof (*hub_heats));
+    }
+  hub_heats[hub_num_heats].section = sec;
+  hub_heats[hub_num_heats].heat = heat;
+  hub_num_heats++;
+}
+
+/* The input section that defines the function NAME.  */
+static asection *
+propeller_function_section (const char *name)
+{
+  struct bfd_link_hash_entry *h;
+
+  /* C functions have a leading underscore */
+  h = bfd_link_hash_lookup (link_info.hash, name, FALSE, FALSE, FALSE);
+  if (h == NULL || h->type != bfd_link_hash_defined)
+    {
+      char *uname = concat ("_", name, (const char *) NULL);
+
+      h = bfd_link_hash_lookup (link_info.hash, uname, FALSE, FALSE, FALSE);
+      free (uname);
+    }
+  if (h == NULL || (h->type != bfd_link_hash_defined
+		    && h->type != bfd_link_hash_defweak))
+    return NULL;
+  return h->u.def.section;
+}
+
+/* Read the heat file NAME: lines of a function name and its heat
+   (samples, cycles, calls, ... anything that grows with the time spent
+   in the function).  The heat of each function goes to the input
+   section that defines it, through ADD_HEAT.  */
+static bfd_boolean
+read_function_profile (const char *profile_name,
+		       void (*add_heat) (asection *, bfd_uint64_t))
+{
+  char line[512];
+  FILE *f;
+
+  f = fopen (profile_name, FOPEN_RT);
+  if (f == NULL)
+    {
+      einfo (_("%P: cannot open profile %s: %E\n"), profile_name);
+      return FALSE;
+    }
+  while (fgets (line, sizeof (line), f) != NULL)
+    {
+      char *p = line, *name, *end;
+      asection *sec;
+      bfd_uint64_t heat;
+
+      while (ISSPACE (*p))
+	p++;
+      if (*p == '#' || *p == '\0')
+	continue;
+      name = p;
+      while (*p != '\0' && !ISSPACE (*p))
+	p++;
+      if (*p != '\0')
+	*p++ = '\0';
+      heat = strtoull (p, &end, 0);
+      if (end == p)
+	{
+	  einfo (_("%P: %s: bad line for %s\n"), profile_name, name);
+	  continue;
+	}
+
+      sec = propeller_function_section (name);
+      if (sec == NULL)
+	continue;
+      if (heat != 0)
+	add_heat (sec, heat);
+    }
+  fclose (f);
+  return TRUE;
+}
+
+/* Bytes of the hub image used by the statements in list L.  */
+static bfd_vma
+hub_statements_size (lang_statement_union_type *s)
+{
+  bfd_vma size = 0;
+
+  for (; s != NULL; s = s->header.next)
+    switch (s->header.type)
+      {
+      case lang_wild_statement_enum:
+	size += hub_statements_size (s->wild_statement.children.head);
+	break;
+      case lang_input_section_enum:
+	if ((s->input_section.section->flags & SEC_EXCLUDE) == 0)
+	  size += (s->input_section.section->size + 3) & ~3;
+	break;
+      case lang_data_statement_enum:
+	size += 4;
+	break;
+      default:
+	break;
+      }
+  return size;
+}
+
+/* Remove the statement for input section SEC from the list L.  */
+static bfd_boolean
+hub_unlink_section (lang_statement_list_type *l, asection *sec)
+{
+  lang_statement_union_type **ps;
+
+  for (ps = &l->head; *ps != NULL; ps = &(*ps)->header.next)
+    {
+      lang_statement_union_type *s = *ps;
+
+      if (s->header.type == lang_input_section_enum
+	  && s->input_section.section == sec)
+	{
+	  *ps = s->header.next;
+	  if (l->tail == &s->header.next)
+	    l->tail = ps;
+	  return TRUE;
+	}
+      if (s->header.type == lang_wild_statement_enum
+	  && hub_unlink_section (&s->wild_statement.children, sec))
+	return TRUE;
+    }
+  return FALSE;
+}
+
+static int
+hub_section_compare (const void *a, const void *b)
+{
+  const struct hub_heat *ha = (const struct hub_heat *) a;
+  const struct hub_heat *hb = (const struct hub_heat *) b;
+
+  return ha->section->id < hb->section->id ? -1
+    : ha->section->id > hb->section->id;
+}
+
+/* Sum up the heat of each section.  */
+static void
+hub_merge_heats (void)
+{
+  size_t i, n = 0;
+
+  qsort (hub_heats, hub_num_heats, sizeof (*hub_heats), hub_section_compare);
+  for (i = 0; i < hub_num_heats; i++)
+    if (n > 0 && hub_heats[n - 1].section == hub_heats[i].section)
+      hub_heats[n - 1].heat += hub_heats[i].heat;
+    else
+      hub_heats[n++] = hub_heats[i];
+  hub_num_heats = n;
+}
+
+static int
+hub_heat_compare (const void *a, const void *b)
+{
+  const struct hub_heat *ha = (const struct hub_heat *) a;
+  const struct hub_heat *hb = (const struct hub_heat *) b;
+  double da = (double) ha->heat / (ha->section->size ? ha->section->size : 1);
+  double db = (double) hb->heat / (hb->section->size ? hb->section->size : 1);
+
+  if (da != db)
+    return da < db ? 1 : -1;
+  if (ha->heat != hb->heat)
+    return ha->heat < hb->heat ? 1 : -1;
+  return hub_section_compare (a, b);
+}
+
+static void
+propeller_hub_placement (void)
+{
+  lang_output_section_statement_type *os, *hub, *text;
+  lang_memory_region_type *hub_region;
+  bfd_vma used = 0, budget;
+  size_t i;
+
+  hub = lang_output_section_find (".hub");
+  text = lang_output_section_find (".text");
+  hub_region = lang_memory_region_lookup ("hub", FALSE);
+  if (hub == NULL || hub->bfd_section == NULL
+      || text == NULL || text->bfd_section == NULL || hub_region == NULL)
+    return;
+  /* nothing to gain if the code already runs from the hub */
+  if (text->region == hub_region)
+    {
+      einfo (_("%P: warning: --hub-profile ignored, .text is already"
+	       " in hub memory\n"));
+      return;
+    }
+  if (!read_function_profile (hub_profile_name, hub_add_heat))
+    return;
+
+  /* what the rest of the program needs of the hub */
+  for (os = &lang_output_section_statement.head->output_section_statement;
+       os != NULL;
+       os = os->next)
+    if (os->bfd_section != NULL
+	&& (os->region == hub_region || os->lma_region == hub_region))
+      used += hub_statements_size (os->children.head);
+  if (used + HUB_PROFILE_RESERVE < hub_region->length)
+    hub_free_size = hub_region->length - used - HUB_PROFILE_RESERVE;
+  budget = hub_free_size;
+  if (budget > hub_budget)
+    budget = hub_budget;
+
+  hub_merge_heats ();
+  qsort (hub_heats, hub_num_heats, sizeof (*hub_heats), hub_heat_compare);
+  for (i = 0; i < hub_num_heats; i++)
+    {
+      asection *sec = hub_heats[i].section;
+      bfd_vma size = (sec->size + 3) & ~3;
+
+      /* only whole functions of ordinary code can move; .init and
+	 .fini fall through from one input section to the next */
+      if (sec->output_section != text->bfd_section
+	  || (sec->flags & SEC_CODE) == 0
+	  || (elf_section_flags (sec) & SHF_PROPELLER_COGDATA) != 0
+	  || size > budget)
+	continue;
+      if (!hub_unlink_section (&text->children, sec))
+	continue;
+      sec->output_section = NULL;
+      lang_add_section (&hub->children, sec, NULL, hub);
+      budget -= size;
+      hub_moved_size += size;
+      hub_heats[hub_num_moved++] = hub_heats[i];
+    }
+}
+
+static void
+propeller_print_hub_placement (FILE *f)
+{
+  size_t i;
+
+  fprintf (f, _("\nHub placement (profile %s, %lu of %lu free bytes used)\n\n"),
+	   hub_profile_name, (unsigned long) hub_moved_size,
+	   (unsigned long) hub_free_size);
+  if (hub_num_moved == 0)
+    {
+      fprintf (f, _("  none\n"));
+      return;
+    }
+  fprintf (f, "  %-32s %-24s %6s %12s\n", _("Section"), _("File"),
+	   _("Size"), _("Heat"));
+  for (i = 0; i < hub_num_moved; i++)
+    {
+      asection *sec = hub_heats[i].section;
+
+      fprintf (f, "  %-32s %-24s %6lu %12llu\n", sec->name,
+	       bfd_get_filename (sec->owner), (unsigned long) sec->size,
+	       (unsigned long long) hub_heats[i].heat);
+    }
+}
+
+/*
+ * per function choice of encoding: gas --dual-encoding assembles each
+ * function both as LMM, which is faster, and as CMM, which is about
+ * half the size.  With a profile the hottest functions, by heat per
+ * extra byte, get LMM as far as the budget of extra bytes allows and
+ * the rest get CMM; with only a budget, as many functions as fit get
+ * LMM.  Otherwise, and always in a relocatable link, each function
+ * keeps the encoding it was written in.
+ * The other encoding is left out of the link.
+ */
+static const char *encoding_profile_name = NULL;
+static bfd_vma lmm_budget = (bfd_vma) -1;
+
+struct dual_function
+{
+  asection *primary;		/* the section as written */
+  asection *lmm;
+  asection *cmm;
+  bfd_uint64_t heat;
+  bfd_boolean use_lmm;
+};
+
+static struct dual_function *dual_funcs;
+static size_t dual_num_funcs;
+static bfd_vma dual_lmm_extra;
+
+static void
+dual_add_heat (asection *sec, bfd_uint64_t heat)
+{
+  size_t i;
+
+  for (i = 0; i < dual_num_funcs; i++)
+    if (dual_funcs[i].primary == sec)
+      dual_funcs[i].heat += heat;
+}
+
+/* what LMM costs over CMM */
+static bfd_signed_vma
+dual_extra (const struct dual_function *df)
+{
+  return (bfd_signed_vma) df->lmm->size - (bfd_signed_vma) df->cmm->size;
+}
+
+static int
+dual_heat_compare (const void *a, const void *b)
+{
+  const struct dual_function *da = (const struct dual_function *) a;
+  const struct dual_function *db = (const struct dual_function *) b;
+  bfd_signed_vma ea = dual_extra (da), eb = dual_extra (db);
+  double ha = (double) da->heat / (ea > 0 ? ea : 1);
+  double hb = (double) db->heat / (eb > 0 ? eb : 1);
+
+  if (ha != hb)
+    return ha < hb ? 1 : -1;
+  return ea > eb ? 1 : ea < eb ? -1 : 0;
+}
+
+static void
+propeller_dual_encoding (void)
+{
+  extern asection *bfd_elf32_propeller_dual_section (asection *,
+						       bfd_boolean *);
+  extern bfd_boolean bfd_elf32_propeller_dual_select (asection *, asection *,
+						      bfd_boolean);
+  bfd *abfd;
+  asection *sec, *alt;
+  bfd_boolean alt_cmm;
+  bfd_vma budget = lmm_budget;
+  size_t i, max = 0;
+
+  for (abfd = link_info.input_bfds; abfd != NULL; abfd = abfd->link.next)
+    for (sec = abfd->sections; sec != NULL; sec = sec->next)
+      {
+	alt = bfd_elf32_propeller_dual_section (sec, &alt_cmm);
+	if (alt == NULL)
+	  continue;
+	if ((alt->flags & SEC_EXCLUDE) != 0)
+	  {
+	    bfd_elf32_propeller_dual_select (sec, alt, !alt_cmm);
+	    continue;
+	  }
+	if (dual_num_funcs == max)
+	  {
+	    max = max ? 2 * max : 64;
+	    dual_funcs = xrealloc (dual_funcs, max * sizeof (*dual_funcs));
+	  }
+	dual_funcs[dual_num_funcs].primary = sec;
+	dual_funcs[dual_num_funcs].lmm = alt_cmm ? sec : alt;
+	dual_funcs[dual_num_funcs].cmm = alt_cmm ? alt : sec;
+	/* without a profile every function is as hot as any other */
+	dual_funcs[dual_num_funcs].heat = encoding_profile_name == NULL;
+	dual_funcs[dual_num_funcs].use_lmm = alt_cmm;
+	dual_num_funcs++;
+      }
+  if (dual_num_funcs == 0)
+    return;
+
+  /* a relocatable link would put both encodings in one section */
+  if (!bfd_link_relocatable (&link_info)
+      && (encoding_profile_name != NULL || lmm_budget != (bfd_vma) -1))
+    {
+      if (encoding_profile_name != NULL
+	  && !read_function_profile (encoding_profile_name, dual_add_heat))
+	return;
+      qsort (dual_funcs, dual_num_funcs, sizeof (*dual_funcs),
+	     dual_heat_compare);
+      for (i = 0; i < dual_num_funcs; i++)
+	{
+	  struct dual_function *df = &dual_funcs[i];
+	  bfd_signed_vma extra = dual_extra (df);
+
+	  df->use_lmm = FALSE;
+	  if (extra <= 0)
+	    df->use_lmm = TRUE;
+	  else if (df->heat != 0 && (bfd_vma) extra <= budget)
+	    {
+	      df->use_lmm = TRUE;
+	      budget -= extra;
+	      dual_lmm_extra += extra;
+	    }
+	}
+    }
+
+  for (i = 0; i < dual_num_funcs; i++)
+    {
+      struct dual_function *df = &dual_funcs[i];
+
+      if (df->use_lmm)
+	bfd_elf32_propeller_dual_select (df->lmm, df->cmm, FALSE);
+      else
+	bfd_elf32_propeller_dual_select (df->cmm, df->lmm, TRUE);
+    }
+}
+
+static void
+propeller_print_dual_encoding (FILE *f)
+{
+  size_t i;
+
+  fprintf (f, _("\nEncoding selection (%lu extra bytes for LMM)\n\n"),
+	   (unsigned long) dual_lmm_extra);
+  fprintf (f, "  %-32s %-24s %8s %6s %6s %12s\n", _("Section"), _("File"),
+	   _("Encoding"), _("LMM"), _("CMM"), _("Heat"));
+  for (i = 0; i < dual_num_funcs; i++)
+    {
+      struct dual_function *df = &dual_funcs[i];
+
+      fprintf (f, "  %-32s %-24s %8s %6lu %6lu %12llu\n", df->primary->name,
+	       bfd_get_filename (df->primary->owner),
+	       df->use_lmm ? "LMM" : "CMM", (unsigned long) df->lmm->size,
+	       (unsigned long) df->cmm->size, (unsigned long long) df->heat);
+    }
+}
+
+static void
+propeller_after_open (void)
+{
+  gld${EMULATION_NAME}_after_open ();
+  propeller_dual_encoding ();
+}
+
+/*
+ * cache line layout: XMM code is fetched from external memory a cache
+ * line at a time, so a small function that straddles two lines costs
+ * two fetches; order the .text input sections so that functions do not
+ * cross lines they need not cross, and so that callers and their
+ * callees share a line
+ */
+
+static bfd_vma xmm_cache_line = 0;
+static const char *xmm_call_graph_name = NULL;
+
+struct xmm_node
+{
+  asection *section;
+  lang_statement_union_type *stmt;
+  unsigned int power;		/* alignment in the layout */
+  size_t order;			/* position in the original layout */
+  size_t leader;		/* the cluster this section is in */
+  size_t next;			/* next section of the cluster */
+  size_t last;			/* for a leader, the last section */
+  bfd_vma size;			/* for a leader, the size of the cluster */
+  bfd_boolean placed;
+};
+
+struct xmm_edge
+{
+  size_t from, to;
+  bfd_uint64_t weight;
+};
+
+#define XMM_NONE ((size_t) -1)
+
+static struct xmm_node *xmm_nodes;
+static size_t xmm_num_nodes;
+static struct xmm_edge *xmm_edges;
+static size_t xmm_num_edges;
+static size_t xmm_max_edges;
+
+/* the sections laid out, in order, for the map file */
+static asection **xmm_layout;
+static size_t xmm_num_layout;
+
+static int
+xmm_node_compare (const void *a, const void *b)
+{
+  const struct xmm_node *na = (const struct xmm_node *) a;
+  const struct xmm_node *nb = (const struct xmm_node *) b;
+  unsigned int ia = na->section->id;
+  unsigned int ib = nb->section->id;
+
+  return ia < ib ? -1 : ia > ib;
+}
+
+/* The node of input section SEC, or XMM_NONE.  */
+static size_t
+xmm_find_node (asection *sec)
+{
+  struct xmm_node key, *n;
+
+  key.section = sec;
+  n = bsearch (&key, xmm_nodes, xmm_num_nodes, sizeof (*xmm_nodes),
+	       xmm_node_compare);
+  return n == NULL ? XMM_NONE : (size_t) (n - xmm_nodes);
+}
+
+static void
+xmm_add_edge (asection *from, asection *to, bfd_uint64_t weight)
+{
+  size_t f = xmm_find_node (from);
+  size_t t = xmm_find_node (to);
+
+  if (f == XMM_NONE || t == XMM_NONE || f == t)
+    return;
+  if (xmm_num_edges == xmm_max_edges)
+    {
+      xmm_max_edges = xmm_max_edges ? 2 * xmm_max_edges : 256;
+      xmm_edges = xrealloc (xmm_edges, xmm_max_edges * sizeof (*xmm_edges));
+    }
+  xmm_edges[xmm_num_edges].from = f;
+  xmm_edges[xmm_num_edges].to = t;
+  xmm_edges[xmm_num_edges].weight = weight;
+  xmm_num_edges++;
+}
+
+/* Add an edge for each reference from one node to another: the static
+   call graph.  */
+static void
+xmm_add_reloc_edges (asection *sec)
+{
+  bfd *abfd = sec->owner;
+  Elf_Internal_Shdr *symtab_hdr;
+  Elf_Internal_Sym *isymbuf = NULL;
+  Elf_Internal_Rela *relocs, *irel, *irelend;
+
+  if (bfd_get_flavour (abfd) != bfd_target_elf_flavour
+      || (sec->flags & SEC_RELOC) == 0 || sec->reloc_count == 0)
+    return;
+  symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
+  relocs = _bfd_elf_link_read_relocs (abfd, sec, NULL, NULL,
+				      link_info.keep_memory);
+  if (relocs == NULL)
+    return;
+  if (symtab_hdr->sh_info != 0)
+    isymbuf = bfd_elf_get_elf_syms (abfd, symtab_hdr, symtab_hdr->sh_info,
+				    0, NULL, NULL, NULL);
+
+  irelend = relocs + sec->reloc_count;
+  for (irel = relocs; irel < irelend; irel++)
+    {
+      unsigned long r_symndx = ELF32_R_SYM (irel->r_info);
+      asection *target = NULL;
+
+      if (r_symndx < symtab_hdr->sh_info)
+	{
+	  if (isymbuf != NULL)
+	    target = bfd_section_from_elf_index (abfd,
+						 isymbuf[r_symndx].st_shndx);
+	}
+      else
+	{
+	  struct elf_link_hash_entry *h;
+
+	  h = elf_sym_hashes (abfd)[r_symndx - symtab_hdr->sh_info];
+	  while (h != NULL && (h->root.type == bfd_link_hash_indirect
+			       || h->root.type == bfd_link_hash_warning))
+	    h = (struct elf_link_hash_entry *) h->root.u.i.link;
+	  if (h != NULL && (h->root.type == bfd_link_hash_defined
+			    || h->root.type == bfd_link_hash_defweak))
+	    target = h->root.u.def.section;
+	}
+      if (target != NULL)
+	xmm_add_edge (sec, target, 1);
+    }
+
+  free (isymbuf);
+  if (elf_section_data (sec)->relocs != relocs)
+    free (relocs);
+}
+
+/* Read the call graph file: lines of a caller, a callee and, if it is
+   known, the number of calls.  */
+static bfd_boolean
+read_xmm_call_graph (void)
+{
+  char line[1024];
+  FILE *f;
+
+  f = fopen (xmm_call_graph_name, FOPEN_RT);
+  if (f == NULL)
+    {
+      einfo (_("%P: cannot open call graph %s: %E\n"), xmm_call_graph_name);
+      return FALSE;
+    }
+  while (fgets (line, sizeof (line), f) != NULL)
+    {
+      char *p = line, *caller, *callee, *end;
+      asection *from, *to;
+      bfd_uint64_t count = 1;
+
+      while (ISSPACE (*p))
+	p++;
+      if (*p == '#' || *p == '\0')
+	continue;
+      caller = p;
+      while (*p != '\0' && !ISSPACE (*p))
+	p++;
+      if (*p != '\0')
+	*p++ = '\0';
+      while (ISSPACE (*p))
+	p++;
+      callee = p;
+      while (*p != '\0' && !ISSPACE (*p))
+	p++;
+      if (*p != '\0')
+	*p++ = '\0';
+      if (*callee == '\0')
+	{
+	  einfo (_("%P: %s: bad line for %s\n"), xmm_call_graph_name, caller);
+	  continue;
+	}
+      while (ISSPACE (*p))
+	p++;
+      if (*p != '\0')
+	{
+	  count = strtoull (p, &end, 0);
+	  if (end == p)
+	    {
+	      einfo (_("%P: %s: bad line for %s\n"), xmm_call_graph_name,
+		     caller);
+	      continue;
+	    }
+	}
+
+      from = propeller_function_section (caller);
+      to = propeller_function_section (callee);
+      /* a profile count is worth more than a call site */
+      if (from != NULL && to != NULL && count != 0)
+	xmm_add_edge (from, to, count * 16);
+    }
+  fclose (f);
+  return TRUE;
+}
+
+static int
+xmm_edge_compare (const void *a, const void *b)
+{
+  const struct xmm_edge *ea = (const struct xmm_edge *) a;
+  const struct xmm_edge *eb = (const struct xmm_edge *) b;
+
+  if (ea->from != eb->from)
+    return ea->from < eb->from ? -1 : 1;
+  return ea->to < eb->to ? -1 : ea->to > eb->to;
+}
+
+/* Heaviest first; equal weights in the order of the callers, then of
+   the callees, in the original layout.  */
+static int
+xmm_weight_compare (const void *a, const void *b)
+{
+  const struct xmm_edge *ea = (const struct xmm_edge *) a;
+  const struct xmm_edge *eb = (const struct xmm_edge *) b;
+  size_t oa, ob;
+
+  if (ea->weight != eb->weight)
+    return ea->weight < eb->weight ? 1 : -1;
+  oa = xmm_nodes[ea->from].order;
+  ob = xmm_nodes[eb->from].order;
+  if (oa != ob)
+    return oa < ob ? -1 : 1;
+  oa = xmm_nodes[ea->to].order;
+  ob = xmm_nodes[eb->to].order;
+  return oa < ob ? -1 : oa > ob;
+}
+
+/* Where a section of SIZE bytes, aligned to 1 << POWER, placed at or
+   after OFFSET, ends.  */
+static bfd_vma
+xmm_place (bfd_vma offset, unsigned int power, bfd_vma size)
+{
+  bfd_vma align = (bfd_vma) 1 << power;
+
+  return ((offset + align - 1) & ~(align - 1)) + size;
+}
+
+/* Where the cluster led by L ends if it is placed at OFFSET.  */
+static bfd_vma
+xmm_cluster_end (size_t l, bfd_vma offset)
+{
+  size_t i;
+
+  for (i = l; i != XMM_NONE; i = xmm_nodes[i].next)
+    offset = xmm_place (offset, xmm_nodes[i].power,
+			xmm_nodes[i].section->size);
+  return offset;
+}
+
+/* Cache lines touched by the bytes from START to END.  */
+static bfd_vma
+xmm_lines (bfd_vma start, bfd_vma end)
+{
+  if (end <= start)
+    return 0;
+  return (end - 1) / xmm_cache_line - start / xmm_cache_line + 1;
+}
+
+/* Append the statements of the node N at *TAIL, after an assignment
+   of ". = ALIGN (...)" if the layout aligns it more than its section
+   is.  */
+static void
+xmm_append_node (size_t n, lang_statement_union_type ***tail)
+{
+  struct xmm_node *node = &xmm_nodes[n];
+
+  if (node->power > node->section->alignment_power)
+    {
+      lang_statement_list_type list;
+
+      lang_list_init (&list);
+      push_stat_ptr (&list);
+      lang_add_assignment (exp_assign (".",
+				       exp_unop (ALIGN_K,
+						 exp_intop ((bfd_vma) 1
+							    << node->power)),
+				       FALSE));
+      pop_stat_ptr ();
+      **tail = list.head;
+      *tail = list.tail;
+    }
+  **tail = node->stmt;
+  *tail = &node->stmt->header.next;
+}
+
+/* Lay out the cluster led by L at *OFFSET, appending its statements at
+   *TAIL.  Start it on a new line if it then touches fewer lines.  */
+static void
+xmm_place_cluster (size_t l, bfd_vma *offset, unsigned int line_power,
+		   lang_statement_union_type ***tail)
+{
+  bfd_vma end = xmm_cluster_end (l, *offset);
+  bfd_vma start = (*offset + xmm_cache_line - 1) & ~(xmm_cache_line - 1);
+  size_t i;
+
+  if (xmm_lines (*offset, end)
+      > xmm_lines (start, xmm_cluster_end (l, start))
+      && xmm_nodes[l].power < line_power)
+    xmm_nodes[l].power = line_power;
+  for (i = l; i != XMM_NONE; i = xmm_nodes[i].next)
+    {
+      *offset = xmm_place (*offset, xmm_nodes[i].power,
+			   xmm_nodes[i].section->size);
+      xmm_nodes[i].placed = TRUE;
+      xmm_layout[xmm_num_layout++] = xmm_nodes[i].section;
+      xmm_append_node (i, tail);
+    }
+}
+
+/* Reorder the input sections of the wild statement W, which start at
+   *OFFSET from the start of a cache line.  */
+static void
+xmm_layout_list (lang_wild_statement_type *w, bfd_vma *offset,
+		 unsigned int line_power)
+{
+  lang_statement_union_type *s, **tail;
+  size_t *leaders;
+  size_t i, j, n = 0, nleaders = 0;
+
+  for (s = w->children.head; s != NULL; s = s->header.next)
+    n++;
+  if (n == 0)
+    return;
+  xmm_nodes = xmalloc (n * sizeof (*xmm_nodes));
+  xmm_num_nodes = 0;
+  xmm_num_edges = 0;
+
+  /* only plain code sections move; anything else stays in front */
+  tail = &w->children.head;
+  for (s = w->children.head; s != NULL; s = s->header.next)
+    {
+      asection *sec;
+
+      if (s->header.type == lang_input_section_enum
+	  && (sec = s->input_section.section) != NULL
+	  && (sec->flags & (SEC_CODE | SEC_EXCLUDE)) == SEC_CODE
+	  && (elf_section_flags (sec) & SHF_PROPELLER_COGDATA) == 0
+	  && sec->size != 0)
+	{
+	  struct xmm_node *node = &xmm_nodes[xmm_num_nodes];
+
+	  node->section = sec;
+	  node->stmt = s;
+	  node->power = sec->alignment_power;
+	  node->order = xmm_num_nodes++;
+	}
+      else
+	{
+	  *tail = s;
+	  tail = &s->header.next;
+	  if (s->header.type == lang_input_section_enum
+	      && (s->input_section.section->flags & SEC_EXCLUDE) == 0)
+	    *offset = xmm_place (*offset,
+				 s->input_section.section->alignment_power,
+				 s->input_section.section->size);
+	}
+    }
+  *tail = NULL;
+  w->children.tail = tail;
+  if (xmm_num_nodes == 0)
+    {
+      free (xmm_nodes);
+      xmm_nodes = NULL;
+      return;
+    }
+
+  /* the call graph: references between the sections, and the profile */
+  qsort (xmm_nodes, xmm_num_nodes, sizeof (*xmm_nodes), xmm_node_compare);
+  for (i = 0; i < xmm_num_nodes; i++)
+    xmm_add_reloc_edges (xmm_nodes[i].section);
+  if (xmm_call_graph_name != NULL)
+    read_xmm_call_graph ();
+
+  /* merge duplicate edges, then take the heaviest first */
+  qsort (xmm_edges, xmm_num_edges, sizeof (*xmm_edges), xmm_edge_compare);
+  for (i = j = 0; i < xmm_num_edges; i++)
+    if (j > 0 && xmm_edges[j - 1].from == xmm_edges[i].from
+	&& xmm_edges[j - 1].to == xmm_edges[i].to)
+      xmm_edges[j - 1].weight += xmm_edges[i].weight;
+    else
+      xmm_edges[j++] = xmm_edges[i];
+  xmm_num_edges = j;
+  qsort (xmm_edges, xmm_num_edges, sizeof (*xmm_edges), xmm_weight_compare);
+
+  for (i = 0; i < xmm_num_nodes; i++)
+    {
+      xmm_nodes[i].leader = i;
+      xmm_nodes[i].next = XMM_NONE;
+      xmm_nodes[i].last = i;
+      xmm_nodes[i].placed = FALSE;
+    }
+  for (i = 0; i < xmm_num_nodes; i++)
+    xmm_nodes[i].size = xmm_cluster_end (i, 0);
+
+  /* cluster callers with their callees, as long as the cluster still
+     fits in a line: put the callee's cluster after the caller's */
+  for (i = 0; i < xmm_num_edges; i++)
+    {
+      size_t a = xmm_nodes[xmm_edges[i].from].leader;
+      size_t b = xmm_nodes[xmm_edges[i].to].leader;
+      size_t k;
+      bfd_vma size;
+
+      if (a == b)
+	continue;
+      xmm_nodes[xmm_nodes[a].last].next = b;
+      size = xmm_cluster_end (a, 0);
+      if (size > xmm_cache_line)
+	{
+	  xmm_nodes[xmm_nodes[a].last].next = XMM_NONE;
+	  continue;
+	}
+      xmm_nodes[a].last = xmm_nodes[b].last;
+      xmm_nodes[a].size = size;
+      if (xmm_nodes[b].order < xmm_nodes[a].order)
+	xmm_nodes[a].order = xmm_nodes[b].order;
+      for (k = b; k != XMM_NONE; k = xmm_nodes[k].next)
+	xmm_nodes[k].leader = a;
+    }
+
+  /* the clusters, in the order of their first section */
+  leaders = xmalloc (xmm_num_nodes * sizeof (*leaders));
+  for (i = 0; i < xmm_num_nodes; i++)
+    if (xmm_nodes[i].leader == i)
+      {
+	for (j = nleaders; j > 0
+	       && xmm_nodes[leaders[j - 1]].order > xmm_nodes[i].order; j--)
+	  leaders[j] = leaders[j - 1];
+	leaders[j] = i;
+	nleaders++;
+      }
+
+  /* place them in turn; when a cluster would straddle a line, first
+     fill the rest of the line with later clusters that fit */
+  xmm_layout = xrealloc (xmm_layout, (xmm_num_layout + xmm_num_nodes)
+			 * sizeof (*xmm_layout));
+  for (i = 0; i < nleaders; i++)
+    {
+      size_t l = leaders[i];
+
+      if (xmm_nodes[l].placed)
+	continue;
+      if (*offset % xmm_cache_line != 0
+	  && xmm_lines (*offset, xmm_cluster_end (l, *offset))
+	     > xmm_lines (0, xmm_nodes[l].size))
+	for (j = i + 1; j < nleaders; j++)
+	  {
+	    size_t f = leaders[j];
+	    bfd_vma end;
+
+	    if (xmm_nodes[f].placed)
+	      continue;
+	    end = xmm_cluster_end (f, *offset);
+	    if ((end - 1) / xmm_cache_line == *offset / xmm_cache_line)
+	      xmm_place_cluster (f, offset, line_power, &tail);
+	    if (*offset % xmm_cache_line == 0)
+	      break;
+	  }
+      xmm_place_cluster (l, offset, line_power, &tail);
+    }
+  free (leaders);
+  *tail = NULL;
+  w->children.tail = tail;
+
+  free (xmm_nodes);
+  xmm_nodes = NULL;
+}
+
+static void
+propeller_xmm_layout (void)
+{
+  lang_output_section_statement_type *text;
+  lang_statement_union_type *s;
+  lang_memory_region_type *hub_region;
+  unsigned int line_power = 0;
+  bfd_vma offset = 0;
+
+  text = lang_output_section_find (".text");
+  hub_region = lang_memory_region_lookup ("hub", FALSE);
+  if (text == NULL || text->bfd_section == NULL)
+    return;
+  if (text->region == hub_region)
+    {
+      einfo (_("%P: warning: --xmm-cache-line ignored, .text is in hub"
+	       " memory\n"));
+      xmm_cache_line = 0;
+      return;
+    }
+  while (((bfd_vma) 1 << line_power) < xmm_cache_line)
+    line_power++;
+
+  /* .text starts on a line */
+  if (text->bfd_section->alignment_power < line_power)
+    text->bfd_section->alignment_power = line_power;
+
+  for (s = text->children.head; s != NULL; s = s->header.next)
+    if (s->header.type == lang_wild_statement_enum)
+      xmm_layout_list (&s->wild_statement, &offset, line_power);
+  free (xmm_edges);
+  xmm_edges = NULL;
+  xmm_max_edges = 0;
+}
+
+static void
+propeller_print_xmm_layout (FILE *f)
+{
+  bfd_vma lines = 0, best = 0;
+  size_t i;
+
+  fprintf (f, _("\nCache line layout (%lu byte lines)\n\n"),
+	   (unsigned long) xmm_cache_line);
+  if (xmm_num_layout == 0)
+    {
+      fprintf (f, _("  none\n"));
+      return;
+    }
+  fprintf (f, "  %-32s %-24s %10s %6s %5s\n", _("Section"), _("File"),
+	   _("Address"), _("Size"), _("Lines"));
+  for (i = 0; i < xmm_num_layout; i++)
+    {
+      asection *sec = xmm_layout[i];
+      bfd_vma start, n;
+
+      if (sec->output_section == NULL)
+	continue;
+      start = sec->output_section->vma + sec->output_offset;
+      n = xmm_lines (start, start + sec->size);
+      lines += n;
+      best += xmm_lines (0, sec->size);
+      fprintf (f, "  %-32s %-24s 0x%08lx %6lu %5lu\n", sec->name,
+	       bfd_get_filename (sec->owner), (unsigned long) start,
+	       (unsigned long) sec->size, (unsigned long) n);
+    }
+  fprintf (f, _("\n  %lu lines touched by %lu functions, at best %lu\n"),
+	   (unsigned long) lines, (unsigned long) xmm_num_layout,
+	   (unsigned long) best);
+}
+
+/*
+ * literal pool: the constants that LMM mvi and ldi load most often go
+ * into a pool in the first 512 bytes of hub memory, right after the
+ * boot code, so that relaxation can turn each load into one rdlong
+ */
+extern asection *bfd_elf32_propeller_literal_pool
+  (struct bfd_link_info *, unsigned int);
+
+#define LITERAL_POOL_LIMIT 0x200
+
+static bfd_boolean literal_pool = FALSE;
+
+static void
+propeller_literal_pool (void)
+{
+  static const char *const boot_sections[] = { ".boot", ".bootpasm", NULL };
+  lang_output_section_statement_type *os, *boot;
+  asection *pool, *s;
+  const char *const *name;
+  bfd_vma start = 0;
+
+  if (!RELAXATION_ENABLED)
+    {
+      einfo (_("%P: warning: --literal-pool has no effect without --relax\n"));
+      return;
+    }
+  os = lang_output_section_find (".lpool");
+  if (os == NULL)
+    {
+      einfo (_("%P: warning: no .lpool output section for the literal pool\n"));
+      return;
+    }
+
+  /* work out how much room the boot code leaves; the pool follows the
+     boot sections in hub memory, .bootpasm at its load address */
+  for (name = boot_sections; *name != NULL; name++)
+    {
+      boot = lang_output_section_find (*name);
+      if (boot != NULL && boot->bfd_section != NULL)
+	for (s = boot->bfd_section->map_head.s; s != NULL; s = s->map_head.s)
+	  start = align_power (start, s->alignment_power) + s->size;
+    }
+  start = align_power (start, 2);
+  if (start >= LITERAL_POOL_LIMIT)
+    return;
+
+  pool = bfd_elf32_propeller_literal_pool (&link_info,
+					   (LITERAL_POOL_LIMIT - start) / 4);
+  if (pool != NULL)
+    lang_add_section (&os->children, pool, NULL, os);
+}
+
+static void
+propeller_before_allocation (void)
+{
+  if (hub_profile_name != NULL && !bfd_link_relocatable (&link_info))
+    propeller_hub_placement ();
+  if (literal_pool && !bfd_link_relocatable (&link_info))
+    propeller_literal_pool ();
+  /* relaxation assumes that a branch within an output section can only
+     get shorter, so the cache line layout must be settled before it
+     runs; it goes by the sizes before relaxation, which only shrinks
+     them */
+  if (xmm_cache_line != 0 && !bfd_link_relocatable (&link_info))
+    propeller_xmm_layout ();
+  gld${EMULATION_NAME}_before_allocation ();
+}
+
+/*
+ * memory budget report: for each memory region, and each section
+ * placed in it, the size and how much room is left; an overlay has
+ * the whole of its region to itself, everything else shares it
+ */
+static const char *memory_report_name = NULL;
+
+struct report_region
+{
+  lang_memory_region_type *region;
+  bfd_vma used;
+};
+
+static struct report_region *report_regions;
+static size_t report_num_regions;
+
+static struct report_region *
+report_find_region (lang_memory_region_type *region)
+{
+  size_t i;
+
+  for (i = 0; i < report_num_regions; i++)
+    if (report_regions[i].region == region)
+      return &report_regions[i];
+  report_regions = xrealloc (report_regions, (report_num_regions + 1)
+			     * sizeof (*report_regions));
+  report_regions[report_num_regions].region = region;
+  report_regions[report_num_regions].used = 0;
+  return &report_regions[report_num_regions++];
+}
+
+static bfd_boolean
+report_region_p (lang_memory_region_type *region)
+{
+  return (region != NULL
+	  && strcmp (region->name_list.name, DEFAULT_MEMORY_REGION) != 0);
+}
+
+static void
+report_use_region (lang_memory_region_type *region, bfd_vma end)
+{
+  struct report_region *r;
+
+  if (!report_region_p (region))
+    return;
+  r = report_find_region (region);
+  if (end > region->origin && end - region->origin > r->used)
+    r->used = end - region->origin;
+}
+
+/* Print the characters of STR escaped for a JSON string, or for a
+   quoted CSV field, without the quotes.  */
+static void
+report_escaped (FILE *f, const char *str, bfd_boolean json)
+{
+  for (; *str != '\0'; str++)
+    {
+      unsigned char c = *str;
+
+      if (!json)
+	{
+	  if (c == '"')
+	    putc ('"', f);
+	  putc (c, f);
+	}
+      else if (c == '"' || c == '\\\\')
+	{
+	  putc ('\\\\', f);
+	  putc (c, f);
+	}
+      else if (c < 0x20)
+	fprintf (f, "\\\\u%04x", c);
+      else
+	putc (c, f);
+    }
+}
+
+/* Print STR as a JSON or CSV string.  */
+static void
+report_string (FILE *f, const char *str, bfd_boolean json)
+{
+  putc ('"', f);
+  report_escaped (f, str, json);
+  putc ('"', f);
+}
+
+/* Print STR as a CSV field, quoted if it needs to be.  */
+static void
+report_field (FILE *f, const char *str)
+{
+  if (strpbrk (str, ",\"\r\n") != NULL)
+    report_string (f, str, FALSE);
+  else
+    fputs (str, f);
+}
+
+/* Print the input files that contributed to the statements in S,
+   each once, separated by SEP.  */
+static void
+report_inputs (FILE *f, lang_statement_union_type *s, const char *sep,
+	       bfd_boolean json, bfd **last)
+{
+  for (; s != NULL; s = s->header.next)
+    if (s->header.type == lang_wild_statement_enum)
+      report_inputs (f, s->wild_statement.children.head, sep, json, last);
+    else if (s->header.type == lang_input_section_enum)
+      {
+	asection *sec = s->input_section.section;
+	bfd *abfd = sec->owner;
+	char *name;
+
+	if (abfd == *last || sec->size == 0
+	    || (sec->flags & SEC_EXCLUDE) != 0
+	    || (abfd->flags & BFD_LINKER_CREATED) != 0)
+	  continue;
+	if (abfd->my_archive != NULL)
+	  name = concat (bfd_get_filename (abfd->my_archive), "(",
+			 bfd_get_filename (abfd), ")", (const char *) NULL);
+	else
+	  name = xstrdup (bfd_get_filename (abfd));
+	if (*last != NULL)
+	  fputs (sep, f);
+	if (json)
+	  report_string (f, name, TRUE);
+	else
+	  report_escaped (f, name, FALSE);
+	free (name);
+	*last = abfd;
+      }
+}
+
+static bfd_boolean
+report_section_p (lang_output_section_statement_type *os)
+{
+  return (os->bfd_section != NULL
+	  && (os->bfd_section->flags & SEC_ALLOC) != 0
+	  && os->bfd_section->size != 0
+	  && report_region_p (os->region));
+}
+
+static void
+propeller_memory_report (void)
+{
+  lang_output_section_statement_type *os;
+  bfd_boolean json;
+  size_t i, n;
+  FILE *f;
+
+  n = strlen (memory_report_name);
+  json = n > 5 && strcmp (memory_report_name + n - 5, ".json") == 0;
+  f = fopen (memory_report_name, FOPEN_WT);
+  if (f == NULL)
+    {
+      einfo (_("%P: cannot open memory report %s: %E\n"),
+	     memory_report_name);
+      return;
+    }
+
+  for (os = &lang_output_section_statement.head->output_section_statement;
+       os != NULL;
+       os = os->next)
+    if (report_section_p (os))
+      {
+	asection *o = os->bfd_section;
+
+	report_use_region (os->region, o->vma + o->size);
+	report_use_region (os->lma_region, o->lma + o->size);
+      }
+
+  if (json)
+    fprintf (f, "{\n  \"regions\": [");
+  else
+    fprintf (f, "region,section,overlay,address,load_address,size,slack,inputs\n");
+  for (i = 0; i < report_num_regions; i++)
+    {
+      lang_memory_region_type *region = report_regions[i].region;
+      bfd_vma used = report_regions[i].used;
+      bfd_vma free_size = used < region->length ? region->length - used : 0;
+      int count = 0;
+
+      if (json)
+	{
+	  fprintf (f, "%s\n    {\n      \"name\": ", i ? "," : "");
+	  report_string (f, region->name_list.name, TRUE);
+	  fprintf (f, ",\n      \"origin\": %lu,\n      \"length\": %lu,\n"
+		   "      \"used\": %lu,\n      \"free\": %lu,\n"
+		   "      \"sections\": [",
+		   (unsigned long) region->origin,
+		   (unsigned long) region->length,
+		   (unsigned long) used, (unsigned long) free_size);
+	}
+      else
+	{
+	  report_field (f, region->name_list.name);
+	  fprintf (f, ",,,0x%08lx,,%lu,%lu,\n",
+		   (unsigned long) region->origin, (unsigned long) used,
+		   (unsigned long) free_size);
+	}
+
+      for (os = &lang_output_section_statement.head->output_section_statement;
+	   os != NULL;
+	   os = os->next)
+	{
+	  asection *o = os->bfd_section;
+	  bfd_boolean overlay;
+	  bfd_vma slack;
+	  bfd *last = NULL;
+
+	  if (!report_section_p (os) || os->region != region)
+	    continue;
+	  overlay = os->sectype == overlay_section;
+	  if (!overlay)
+	    slack = free_size;
+	  else if (o->size < region->length)
+	    slack = region->length - o->size;
+	  else
+	    slack = 0;
+	  if (json)
+	    {
+	      fprintf (f, "%s\n        {\n          \"name\": ",
+		       count++ ? "," : "");
+	      report_string (f, o->name, TRUE);
+	      fprintf (f, ",\n          \"overlay\": %s,\n"
+		       "          \"address\": %lu,\n"
+		       "          \"load_address\": %lu,\n"
+		       "          \"size\": %lu,\n"
+		       "          \"slack\": %lu,\n"
+		       "          \"inputs\": [",
+		       overlay ? "true" : "false",
+		       (unsigned long) o->vma, (unsigned long) o->lma,
+		       (unsigned long) o->size, (unsigned long) slack);
+	      report_inputs (f, os->children.head, ", ", TRUE, &last);
+	      fprintf (f, "]\n        }");
+	    }
+	  else
+	    {
+	      report_field (f, region->name_list.name);
+	      putc (',', f);
+	      report_field (f, o->name);
+	      fprintf (f, ",%s,0x%08lx,0x%08lx,%lu,%lu,\"",
+		       overlay ? "yes" : "no",
+		       (unsigned long) o->vma, (unsigned long) o->lma,
+		       (unsigned long) o->size, (unsigned long) slack);
+	      report_inputs (f, os->children.head, " ", FALSE, &last);
+	      fprintf (f, "\"\n");
+	    }
+	}
+      if (json)
+	fprintf (f, "%s]\n    }", count ? "\n      " : "");
+    }
+  if (json)
+    fprintf (f, "\n  ]\n}\n");
+  fclose (f);
+
+  free (report_regions);
+  report_regions = NULL;
+  report_num_regions = 0;
+}
+
+/*
+ * fcache candidate analysis: read a profile of the program and report
+ * the loops and leaf functions of LMM/CMM code that would fit into the
+ * fcache buffer, with an estimate of the cycles that caching them
+ * would save
+ */
+extern void bfd_elf32_propeller_fcache_candidates
+  (struct bfd_link_info *, const bfd_vma *, const bfd_uint64_t *, size_t,
+   bfd_boolean, bfd_vma,
+   void (*) (const char *, bfd_vma, bfd_vma, bfd_vma, bfd_uint64_t,
+	     bfd_uint64_t, bfd_boolean, void *),
+   void *);
+
+/* default size of the fcache buffer, and the clock used to turn
+   histogram samples into cycles */
+#define FCACHE_DEFAULT_SIZE 256
+#define FCACHE_PROFILE_CLKFREQ 80000000
+
+static const char *fcache_profile_name = NULL;
+static bfd_vma fcache_size = FCACHE_DEFAULT_SIZE;
+
+struct fcache_candidate
+{
+  const char *name;
+  bfd_vma start, end, size;
+  bfd_uint64_t executions, saved;
+  bfd_boolean whole_function;
+};
+
+static struct fcache_candidate *fcache_candidates;
+static size_t fcache_num_candidates;
+static size_t fcache_max_candidates;
+
+/* The profile, as executions (or cycles, for a histogram) per
+   address.  */
+static bfd_vma *profile_pcs;
+static bfd_uint64_t *profile_counts;
+static size_t profile_num;
+static size_t profile_max;
+
+static void
+profile_add (bfd_vma pc, bfd_uint64_t count)
+{
+  if (count == 0)
+    return;
+  if (profile_num == profile_max)
+    {
+      profile_max = profile_max ? 2 * profile_max : 256;
+      profile_pcs = xrealloc (profile_pcs, profile_max * sizeof (bfd_vma));
+      profile_counts = xrealloc (profile_counts,
+				 profile_max * sizeof (bfd_uint64_t));
+    }
+  profile_pcs[profile_num] = pc;
+  profile_counts[profile_num] = count;
+  profile_num++;
+}
+
+static unsigned long
+profile_get32 (const unsigned char *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned long) p[3] << 24);
+}
+
+/* Read a gmon.out file.  Basic block counts are used if there are any,
+   else the histogram.  Returns TRUE for a histogram.  */
+static bfd_boolean
+read_gmon_profile (FILE *f)
+{
+  unsigned char buf[40];
+  bfd_vma *hist_pcs = NULL;
+  bfd_uint64_t *hist_counts = NULL;
+  size_t hist_num = 0, i;
+  bfd_boolean have_bb = FALSE;
+  int tag;
+
+  /* skip the rest of the header: version and padding */
+  if (fread (buf, 1, 16, f) != 16)
+    return FALSE;
+  while ((tag = getc (f)) != EOF)
+    {
+      switch (tag)
+	{
+	case 0:		/* GMON_TAG_TIME_HIST */
+	  {
+	    unsigned long low, high, size, rate, cycles;
+
+	    if (fread (buf, 1, 32, f) != 32)
+	      tag = EOF;
+	    else
+	      {
+		low = profile_get32 (buf);
+		high = profile_get32 (buf + 4);
+		size = profile_get32 (buf + 8);
+		rate = profile_get32 (buf + 12);
+		cycles = rate ? FCACHE_PROFILE_CLKFREQ / rate : 1;
+		hist_pcs = xrealloc (hist_pcs,
+				     (hist_num + size) * sizeof (bfd_vma));
+		hist_counts = xrealloc (hist_counts, (hist_num + size)
+					* sizeof (bfd_uint64_t));
+		for (i = 0; i < size && fread (buf, 1, 2, f) == 2; i++)
+		  {
+		    hist_pcs[hist_num] = low + (bfd_vma) (((bfd_uint64_t) i
+							   * (high - low))
+							  / size);
+		    hist_counts[hist_num++]
+		      = (bfd_uint64_t) (buf[0] | (buf[1] << 8)) * cycles;
+		  }
+	      }
+	  }
+	  break;
+	case 1:		/* GMON_TAG_CG_ARC */
+	  if (fread (buf, 1, 12, f) != 12)
+	    tag = EOF;
+	  break;
+	case 2:		/* GMON_TAG_BB_COUNT */
+	  {
+	    unsigned long n;
+
+	    if (fread (buf, 1, 4, f) != 4)
+	      tag = EOF;
+	    else
+	      {
+		n = profile_get32 (buf);
+		for (i = 0; i < n && fread (buf, 1, 8, f) == 8; i++)
+		  {
+		    profile_add (profile_get32 (buf), profile_get32 (buf + 4));
+		    have_bb = TRUE;
+		  }
+	      }
+	  }
+	  break;
+	default:
+	  einfo (_("%P: %s: unknown gmon record %d\n"),
+		 fcache_profile_name, tag);
+	  tag = EOF;
+	  break;
+	}
+      if (tag == EOF)
+	break;
+    }
+
+  if (!have_bb)
+    for (i = 0; i < hist_num; i++)
+      profile_add (hist_pcs[i], hist_counts[i]);
+  free (hist_pcs);
+  free (hist_counts);
+  return !have_bb;
+}
+
+/* Read a text profile: lines of an address and the number of times
+   it was executed.  */
+static void
+read_text_profile (FILE *f)
+{
+  char line[256];
+
+  while (fgets (line, sizeof (line), f) != NULL)
+    {
+      char *p = line, *end;
+      bfd_vma pc;
+
+      while (ISSPACE (*p))
+	p++;
+      if (*p == '#' || *p == '\0')
+	continue;
+      pc = strtoul (p, &end, 0);
+      if (end == p)
+	continue;
+      p = end;
+      while (ISSPACE (*p) || *p == ':')
+	p++;
+      profile_add (pc, strtoull (p, NULL, 0));
+    }
+}
+
+static int
+profile_compare (const void *a, const void *b)
+{
+  bfd_vma pa = profile_pcs[*(const size_t *) a];
+  bfd_vma pb = profile_pcs[*(const size_t *) b];
+
+  return pa < pb ? -1 : pa > pb;
+}
+
+static int
+fcache_candidate_compare (const void *a, const void *b)
+{
+  const struct fcache_candidate *ca = (const struct fcache_candidate *) a;
+  const struct fcache_candidate *cb = (const struct fcache_candidate *) b;
+
+  if (ca->saved != cb->saved)
+    return ca->saved < cb->saved ? 1 : -1;
+  return ca->start < cb->start ? -1 : ca->start > cb->start;
+}
+
+static void
+fcache_add_candidate (const char *name, bfd_vma start, bfd_vma end,
+		      bfd_vma size, bfd_uint64_t executions,
+		      bfd_uint64_t saved, bfd_boolean whole_function,
+		      void *data ATTRIBUTE_UNUSED)
+{
+  struct fcache_candidate *c;
+
+  if (fcache_num_candidates == fcache_max_candidates)
+    {
+      fcache_max_candidates = (fcache_max_candidates
+			       ? 2 * fcache_max_candidates : 16);
+      fcache_candidates = xrealloc (fcache_candidates,
+				    fcache_max_candidates
+				    * sizeof (*fcache_candidates));
+    }
+  c = &fcache_candidates[fcache_num_candidates++];
+  c->name = name;
+  c->start = start;
+  c->end = end;
+  c->size = size;
+  c->executions = executions;
+  c->saved = saved;
+  c->whole_function = whole_function;
+}
+
+static void
+fcache_print_candidates (FILE *f)
+{
+  size_t i;
+
+  fprintf (f, _("\nfcache candidates (profile %s, fcache size %lu bytes)\n\n"),
+	   fcache_profile_name, (unsigned long) fcache_size);
+  if (fcache_num_candidates == 0)
+    {
+      fprintf (f, _("  none\n"));
+      return;
+    }
+  fprintf (f, "  %-24s %-10s %-10s %5s %12s %14s\n", _("Function"),
+	   _("Start"), _("End"), _("Size"), _("Executions"),
+	   _("Cycles saved"));
+  for (i = 0; i < fcache_num_candidates; i++)
+    {
+      struct fcache_candidate *c = &fcache_candidates[i];
+
+      fprintf (f, "  %-24s 0x%08lx 0x%08lx %5lu %12llu %14llu %s\n",
+	       c->name, (unsigned long) c->start, (unsigned long) c->end,
+	       (unsigned long) c->size, (unsigned long long) c->executions,
+	       (unsigned long long) c->saved,
+	       c->whole_function ? _("function") : _("loop"));
+    }
+}
+
+static void
+propeller_fcache_analysis (void)
+{
+  bfd_vma *pcs;
+  bfd_uint64_t *counts;
+  size_t *order, i;
+  bfd_boolean time_samples;
+  char magic[4];
+  FILE *f;
+
+  f = fopen (fcache_profile_name, FOPEN_RB);
+  if (f == NULL)
+    {
+      einfo (_("%P: cannot open profile %s: %E\n"), fcache_profile_name);
+      return;
+    }
+  if (fread (magic, 1, 4, f) == 4 && memcmp (magic, "gmon", 4) == 0)
+    time_samples = read_gmon_profile (f);
+  else
+    {
+      rewind (f);
+      read_text_profile (f);
+      time_samples = FALSE;
+    }
+  fclose (f);
+
+  /* sort the profile by address */
+  order = xmalloc ((profile_num + 1) * sizeof (size_t));
+  for (i = 0; i < profile_num; i++)
+    order[i] = i;
+  qsort (order, profile_num, sizeof (size_t), profile_compare);
+  pcs = xmalloc ((profile_num + 1) * sizeof (bfd_vma));
+  counts = xmalloc ((profile_num + 1) * sizeof (bfd_uint64_t));
+  for (i = 0; i < profile_num; i++)
+    {
+      pcs[i] = profile_pcs[order[i]];
+      counts[i] = profile_counts[order[i]];
+    }
+
+  bfd_elf32_propeller_fcache_candidates (&link_info, pcs, counts,
+					 profile_num, time_samples,
+					 fcache_size, fcache_add_candidate,
+					 NULL);
+  qsort (fcache_candidates, fcache_num_candidates,
+	 sizeof (*fcache_candidates), fcache_candidate_compare);
+
+  /* the report goes into the map file if there is one */
+  if (config.map_file == NULL)
+    fcache_print_candidates (stderr);
+
+  free (order);
+  free (pcs);
+  free (counts);
+  free (profile_pcs);
+  free (profile_counts);
+  profile_pcs = NULL;
+  profile_counts = NULL;
+  profile_num = profile_max = 0;
+}
+
+static void
+propeller_finish (void)
+{
+  finish_default ();
+  if (memory_report_name != NULL && !bfd_link_relocatable (&link_info))
+    propeller_memory_report ();
+  if (fcache_profile_name != NULL && !bfd_link_relocatable (&link_info))
+    propeller_fcache_analysis ();
+}
+
+static void
+propeller_extra_map_file_text (bfd *abfd ATTRIBUTE_UNUSED,
+			       struct bfd_link_info *info ATTRIBUTE_UNUSED,
+			       FILE *mapf)
+{
+  if (dual_num_funcs != 0 && !bfd_link_relocatable (&link_info))
+    propeller_print_dual_encoding (mapf);
+  if (hub_profile_name != NULL && !bfd_link_relocatable (&link_info))
+    propeller_print_hub_placement (mapf);
+  if (fcache_profile_name != NULL && !bfd_link_relocatable (&link_info))
+    fcache_print_candidates (mapf);
+  if (xmm_cache_line != 0 && !bfd_link_relocatable (&link_info))
+    propeller_print_xmm_layout (mapf);
+}
 EOF
 
 # Define some shell vars to insert bits of code into the standard elf
@@ -176,22 +1832,133 @@ EOF
 #
 PARSE_AND_LIST_PROLOGUE='
 #define OPTION_NO_FLAG_MISMATCH_WARNINGS	301
+#define OPTION_FCACHE_PROFILE			302
+#define OPTION_FCACHE_SIZE			303
+#define OPTION_HUB_PROFILE			304
+#define OPTION_HUB_BUDGET			305
+#define OPTION_MEMORY_REPORT			306
+#define OPTION_XMM_CACHE_LINE			307
+#define OPTION_XMM_CALL_GRAPH			308
+#define OPTION_LITERAL_POOL			309
+#define OPTION_ENCODING_PROFILE			310
+#define OPTION_LMM_BUDGET			311
 '
 
 PARSE_AND_LIST_LONGOPTS='
   { "no-flag-mismatch-warnings", no_argument, NULL, OPTION_NO_FLAG_MISMATCH_WARNINGS},
+  { "fcache-profile", required_argument, NULL, OPTION_FCACHE_PROFILE},
+  { "fcache-size", required_argument, NULL, OPTION_FCACHE_SIZE},
+  { "hub-profile", required_argument, NULL, OPTION_HUB_PROFILE},
+  { "hub-budget", required_argument, NULL, OPTION_HUB_BUDGET},
+  { "memory-report", required_argument, NULL, OPTION_MEMORY_REPORT},
+  { "xmm-cache-line", required_argument, NULL, OPTION_XMM_CACHE_LINE},
+  { "xmm-call-graph", required_argument, NULL, OPTION_XMM_CALL_GRAPH},
+  { "literal-pool", no_argument, NULL, OPTION_LITERAL_POOL},
+  { "encoding-profile", required_argument, NULL, OPTION_ENCODING_PROFILE},
+  { "lmm-budget", required_argument, NULL, OPTION_LMM_BUDGET},
 '
 
 PARSE_AND_LIST_OPTIONS='
   fprintf (file, _("  --no-flag-mismatch-warnings Don'\''t warn about objects with incompatible"
 		   "                                compiler settings\n"));
+  fprintf (file, _("  --fcache-profile=FILE       Report code worth running from the fcache,\n"
+		   "                                according to a gmon.out or address/count\n"
+		   "                                profile\n"));
+  fprintf (file, _("  --fcache-size=SIZE          Size of the fcache buffer in bytes (default 256)\n"));
+  fprintf (file, _("  --hub-profile=FILE          Move the hottest functions in FILE from external\n"
+		   "                                memory into hub memory\n"));
+  fprintf (file, _("  --hub-budget=SIZE           Move at most SIZE bytes of code into hub memory\n"));
+  fprintf (file, _("  --memory-report=FILE        Write the size and free space of each memory\n"
+		   "                                region and overlay to FILE, as JSON if FILE\n"
+		   "                                ends in .json, else as CSV\n"));
+  fprintf (file, _("  --xmm-cache-line=SIZE       Lay out external memory code so that functions\n"
+		   "                                do not needlessly cross SIZE byte cache lines,\n"
+		   "                                and callers share lines with their callees\n"));
+  fprintf (file, _("  --xmm-call-graph=FILE       Cluster the caller/callee pairs in FILE, with\n"
+		   "                                their call counts, for --xmm-cache-line\n"));
+  fprintf (file, _("  --literal-pool              With --relax, load the constants that LMM code\n"
+		   "                                uses most often from a pool in low hub memory\n"));
+  fprintf (file, _("  --encoding-profile=FILE     Of the functions assembled as both LMM and CMM,\n"
+		   "                                link the hottest in FILE as LMM and the rest\n"
+		   "                                as CMM\n"));
+  fprintf (file, _("  --lmm-budget=SIZE           Spend at most SIZE bytes on LMM code in place\n"
+		   "                                of CMM code\n"));
 '
 
 PARSE_AND_LIST_ARGS_CASES='
     case OPTION_NO_FLAG_MISMATCH_WARNINGS:
       no_flag_mismatch_warnings = TRUE;
       break;
+
+    case OPTION_FCACHE_PROFILE:
+      fcache_profile_name = optarg;
+      break;
+
+    case OPTION_FCACHE_SIZE:
+      {
+	char *end;
+
+	fcache_size = strtoul (optarg, &end, 0);
+	if (*end != '\''\0'\'' || fcache_size < 8)
+	  einfo (_("%P%F: invalid fcache size `%s'\''\n"), optarg);
+      }
+      break;
+
+    case OPTION_HUB_PROFILE:
+      hub_profile_name = optarg;
+      break;
+
+    case OPTION_HUB_BUDGET:
+      {
+	char *end;
+
+	hub_budget = strtoul (optarg, &end, 0);
+	if (*end != '\''\0'\'')
+	  einfo (_("%P%F: invalid hub budget `%s'\''\n"), optarg);
+      }
+      break;
+
+    case OPTION_MEMORY_REPORT:
+      memory_report_name = optarg;
+      break;
+
+    case OPTION_XMM_CACHE_LINE:
+      {
+	char *end;
+
+	xmm_cache_line = strtoul (optarg, &end, 0);
+	if (*end != '\''\0'\'' || xmm_cache_line < 4
+	    || (xmm_cache_line & (xmm_cache_line - 1)) != 0)
+	  einfo (_("%P%F: invalid cache line size `%s'\''\n"), optarg);
+      }
+      break;
+
+    case OPTION_XMM_CALL_GRAPH:
+      xmm_call_graph_name = optarg;
+      break;
+
+    case OPTION_LITERAL_POOL:
+      literal_pool = TRUE;
+      break;
+
+    case OPTION_ENCODING_PROFILE:
+      encoding_profile_name = optarg;
+      break;
+
+    case OPTION_LMM_BUDGET:
+      {
+	char *end;
+
+	lmm_budget = strtoul (optarg, &end, 0);
+	if (*end != '\''\0'\'')
+	  einfo (_("%P%F: invalid LMM budget `%s'\''\n"), optarg);
+      }
+      break;
 '
 
+LDEMUL_AFTER_OPEN=propeller_after_open
 LDEMUL_CREATE_OUTPUT_SECTION_STATEMENTS=propeller_elf_create_output_section_statements
 LDEMUL_PLACE_ORPHAN=propeller_place_orphan
+LDEMUL_BEFORE_ALLOCATION=propeller_before_allocation
+LDEMUL_FINISH=propeller_finish
+LDEMUL_EXTRA_MAP_FILE_TEXT=propeller_extra_map_file_text
@@ -31,6 +31,10 @@ SECTIONS
   /* the initial spin boot code, if any */
   ${RELOCATING+ ".boot : \{ KEEP(*(.boot)) \} >hub" }
   ${RELOCATING+ ".bootpasm : \{ KEEP(*(.bootpasm)) \} >bootpasm AT>hub" }
+  /* the literal pool made by --literal-pool; it must be in the first
+     512 bytes of hub memory, but after the boot code, which the
+     loader expects at a fixed place */
+  ${RELOCATING+ ".lpool : \{ *(.lpool) \} >hub" }
 
   /* the initial startup code (including constructors) */
   .init ${RELOCATING-0} :
@@ -59,6 +63,7 @@ SECTIONS
     *(.hub)
     ${HUB_DATA}
     ${RELOCATING+ PROVIDE(__C_LOCK = .); LONG(0); }
+    /* with --hub-profile the linker moves hot .text sections here */
   } ${RELOCATING+ ${HUBTEXT_MEMORY}}
   ${TEXT_DYNAMIC+${DYNAMIC}}
 
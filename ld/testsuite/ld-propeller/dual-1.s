@@ -0,0 +1,19 @@
+' Each function is assembled as CMM and, with --dual-encoding, as LMM
+' too; the linker keeps one encoding of each.
+	.section .text.hot,"ax",@progbits
+	.global	hot
+hot:
+	mov	r0,r1
+	add	r0,#1
+	brs	#hot
+	.section .text.cold,"ax",@progbits
+	.global	cold
+cold:
+	mov	r2,r3
+	sub	r2,#2
+' Data keeps one encoding.
+	.section .text.data,"ax",@progbits
+	.global	table
+table:
+	.long	hot
+	.long	cold
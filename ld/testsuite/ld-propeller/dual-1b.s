@@ -0,0 +1,11 @@
+' Kernel registers for the LMM encodings in dual-1.s.
+	.global	r0
+	r0 = 0
+	.global	r1
+	r1 = 4
+	.global	r2
+	r2 = 8
+	.global	r3
+	r3 = 12
+	.global	pc
+	pc = 0x40
@@ -0,0 +1,14 @@
+' A local function referenced from elsewhere: the reference follows
+' the function into the encoding the linker keeps.
+	.section .text.first,"ax",@progbits
+	.global	first
+first:
+	mov	r0,r1
+	.section .text.helper,"ax",@progbits
+helper:
+	mov	r2,r3
+	sub	r2,#2
+	.section .text.data,"ax",@progbits
+	.global	table
+table:
+	.long	helper
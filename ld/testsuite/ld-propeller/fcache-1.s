@@ -0,0 +1,25 @@
+' A leaf function, and a loop in a function that calls out, for
+' --fcache-profile.
+	.text
+	.global	_start
+_start:
+	lcall	#leaf
+	lcall	#looper
+	lret
+
+	.global	leaf
+leaf:
+	mov	r0,#0
+	add	r0,#1
+	add	r0,#2
+	lret
+
+	.global	looper
+looper:
+	mov	r1,#10
+.Lloop:
+	add	r0,r1
+	sub	r1,#1 wz
+	if_nz	brs	#.Lloop
+	lcall	#leaf
+	lret
@@ -0,0 +1,11 @@
+' Kernel registers and routines for fcache-1.s and hub-1.s.
+	.global	r0
+	r0 = 0
+	.global	r1
+	r1 = 4
+	.global	lr
+	lr = 60
+	.global	pc
+	pc = 68
+	.global	__LMM_CALL
+	__LMM_CALL = 0x400
@@ -0,0 +1,11 @@
+' Only kept.cog is started; --gc-sections drops dropped.cog.
+	.text
+	.global	_start
+_start:
+	.long	__load_start_kept_cog
+	.long	__load_stop_kept_cog
+
+	.section kept.cog,"ax",@progbits
+	mov	0,#1
+	.section dropped.cog,"ax",@progbits
+	mov	0,#2
@@ -0,0 +1,28 @@
+\t\t\tCall graph
+granularity: each sample hit covers 4 byte\(s\) no time propagated
+index % time    self  children    called     name
+                0\.00    0\.00       0/0           main \[4\]
+\[1\]      0\.0    0\.00    0\.00                 cmmfunc \[1\]
+                0\.00    0\.00       0/0           lmmfunc \[3\]
+                0\.00    0\.00       0/0           <indirect child>
+-----------------------------------------------
+                0\.00    0\.00       0/0           lmmfunc \[3\]
+\[2\]      0\.0    0\.00    0\.00                 leaf \[2\]
+-----------------------------------------------
+                0\.00    0\.00       0/0           main \[4\]
+                0\.00    0\.00       0/0           cmmfunc \[1\]
+\[3\]      0\.0    0\.00    0\.00                 lmmfunc \[3\]
+                0\.00    0\.00       0/0           leaf \[2\]
+-----------------------------------------------
+                                                 <spontaneous>
+\[4\]      0\.0    0\.00    0\.00                 main \[4\]
+                0\.00    0\.00       0/0           lmmfunc \[3\]
+                0\.00    0\.00       0/0           cmmfunc \[1\]
+-----------------------------------------------
+                                                 <spontaneous>
+\[5\]      0\.0    0\.00    0\.00                 _etext \[5\]
+-----------------------------------------------
+
+Index by function name
+   \[5\] _etext                  \[2\] leaf                    \[4\] main
+   \[1\] cmmfunc                 \[3\] lmmfunc
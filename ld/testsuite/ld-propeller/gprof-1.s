@@ -0,0 +1,43 @@
+' Calls for the gprof call finder: an LMM function calling LMM and
+' CMM functions, and a CMM function calling back and through a
+' pointer.
+	.section .lmmkernel, "ax"
+r0:	.long	0
+lr:	.long	0
+sp:	.long	0
+pc:	.long	0
+	.org	0x100
+__LMM_JMP:
+	.long	0
+__LMM_CALL:
+	.long	0
+__LMM_CALL_INDIRECT:
+	.long	0
+__LMM_MVI_r0:
+	.long	0
+
+	.text
+	.global	main
+main:
+	mvi	r0, #leaf
+	lcall	#lmmfunc
+	lcall	#cmmfunc
+	lret
+
+	.global	lmmfunc
+lmmfunc:
+	lcall	#leaf
+	lret
+
+	.global	leaf
+leaf:
+	lret
+
+	.compress on
+	.global	cmmfunc
+cmmfunc:
+	lcall	#lmmfunc
+	mvi	r0, #leaf
+	jmp	#__LMM_CALL_INDIRECT
+	lret
+	.compress off
@@ -0,0 +1,22 @@
+' Functions in their own sections for --hub-profile; warm and warm2
+' share one.
+	.section .text.hot,"ax",@progbits
+	.global	hot
+hot:
+	mov	r0,r1
+	mov	r0,r1
+	lret
+	.section .text.warm,"ax",@progbits
+	.global	warm
+warm:
+	mov	r0,r1
+	lret
+	.global	warm2
+warm2:
+	mov	r0,r1
+	lret
+	.section .text.cold,"ax",@progbits
+	.global	cold
+cold:
+	mov	r0,r1
+	lret
@@ -0,0 +1,15 @@
+' ld --relax --literal-pool shortens LMM loads of constants and
+' shares the constants loaded more than once.
+	.text
+	.global	_start
+_start:
+	mvi	r0,#100		' becomes mov
+	mvi	r1,#-5		' becomes neg
+	mvi	r2,#0x12345	' pooled
+	mvi	r3,#big		' pooled
+	mvi	r4,#0x12345	' pooled
+	mvi	r5,#big		' pooled
+	mvi	r6,#0x54321	' used once, stays mvi
+	mov	r7,r0
+	.global	big
+	big = 0x7fff0000
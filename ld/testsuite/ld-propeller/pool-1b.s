@@ -0,0 +1,33 @@
+' Kernel symbols for pool-1.s.
+	.global	r0
+	.global	__LMM_MVI_r0
+	r0 = 0
+	__LMM_MVI_r0 = 256
+	.global	r1
+	.global	__LMM_MVI_r1
+	r1 = 4
+	__LMM_MVI_r1 = 264
+	.global	r2
+	.global	__LMM_MVI_r2
+	r2 = 8
+	__LMM_MVI_r2 = 272
+	.global	r3
+	.global	__LMM_MVI_r3
+	r3 = 12
+	__LMM_MVI_r3 = 280
+	.global	r4
+	.global	__LMM_MVI_r4
+	r4 = 16
+	__LMM_MVI_r4 = 288
+	.global	r5
+	.global	__LMM_MVI_r5
+	r5 = 20
+	__LMM_MVI_r5 = 296
+	.global	r6
+	.global	__LMM_MVI_r6
+	r6 = 24
+	__LMM_MVI_r6 = 304
+	.global	r7
+	.global	__LMM_MVI_r7
+	r7 = 28
+	__LMM_MVI_r7 = 312
@@ -0,0 +1,7 @@
+' Boot code in front of the literal pool: the pool goes after the
+' load image of .bootpasm, which stays right after .boot.
+	.section .boot,"a",@progbits
+	.long	1, 2, 3, 4
+
+	.section .bootpasm,"ax",@progbits
+	.long	5, 6
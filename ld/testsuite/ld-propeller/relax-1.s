@@ -0,0 +1,21 @@
+' ld --relax shrinks branches and constants once their targets are
+' known, and moves everything after them down.
+	.text
+	.global	_start
+_start:
+	brl	#target		' ljmp becomes brs
+	mvi	r0,#small	' mvi becomes mvib
+	mvi	r1,#mid		' mvi becomes mviw
+	brw	#target		' brw becomes brs
+	mov	r2,r3
+here:
+	mov	r0,r1
+	mvi	r2,#big		' stays mvi
+	.balign	4
+aligned:
+	mov	r3,r0
+last:
+	.data
+	.long	last - _start
+	.long	here - _start
+	.long	aligned
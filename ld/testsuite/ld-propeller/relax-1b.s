@@ -0,0 +1,15 @@
+' Symbols and branch targets for relax-1.s.
+	.global	small
+	.global	mid
+	.global	big
+	small = 100
+	mid = 0x1234
+	big = 0x123456
+	.text
+	.global	target
+target:
+	brl	#_start		' ljmp becomes brs
+	brl	#far		' ljmp becomes brw
+	.space	1000
+far:
+	mov	r0,r1
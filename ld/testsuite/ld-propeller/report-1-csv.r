@@ -0,0 +1,6 @@
+region,section,overlay,address,load_address,size,slack,inputs
+hub,,,0x00000000,,16,32752,
+hub,\.text,no,0x00000000,0x00000000,4,32752,"tmpdir/report-1\.o"
+hub,"a""b\tc\\d,e",no,0x00000004,0x00000004,4,32752,"tmpdir/report-1\.o"
+hub,\.hub,no,0x00000008,0x00000008,4,32752,""
+hub,\.hub_heap,no,0x0000000c,0x0000000c,4,32752,""
@@ -0,0 +1,49 @@
+\{
+  "regions": \[
+    \{
+      "name": "hub",
+      "origin": 0,
+      "length": 32768,
+      "used": 16,
+      "free": 32752,
+      "sections": \[
+        \{
+          "name": "\.text",
+          "overlay": false,
+          "address": 0,
+          "load_address": 0,
+          "size": 4,
+          "slack": 32752,
+          "inputs": \["tmpdir/report-1\.o"\]
+        \},
+        \{
+          "name": "a\\"b\\u0009c\\\\d,e",
+          "overlay": false,
+          "address": 4,
+          "load_address": 4,
+          "size": 4,
+          "slack": 32752,
+          "inputs": \["tmpdir/report-1\.o"\]
+        \},
+        \{
+          "name": "\.hub",
+          "overlay": false,
+          "address": 8,
+          "load_address": 8,
+          "size": 4,
+          "slack": 32752,
+          "inputs": \[\]
+        \},
+        \{
+          "name": "\.hub_heap",
+          "overlay": false,
+          "address": 12,
+          "load_address": 12,
+          "size": 4,
+          "slack": 32752,
+          "inputs": \[\]
+        \}
+      \]
+    \}
+  \]
+\}
@@ -0,0 +1,8 @@
+' The memory report has to escape the names it prints.
+	.text
+	.global	_start
+_start:
+	.long	0
+
+	.section "a\"b\tc\\d,e","ax",@progbits
+	.long	1
@@ -0,0 +1,22 @@
+' Functions in their own sections for --xmm-cache-line: main calls
+' callee, which is placed after big in the input.
+	.section .text.main,"ax",@progbits
+	.global	main
+main:
+	.long	callee
+	.fill	3, 4, 0
+
+	.section .text.big,"ax",@progbits
+	.global	big
+big:
+	.fill	25, 4, 0
+
+	.section .text.mid,"ax",@progbits
+	.global	mid
+mid:
+	.fill	10, 4, 0
+
+	.section .text.callee,"ax",@progbits
+	.global	callee
+callee:
+	.fill	4, 4, 0
@@ -0,0 +1,22 @@
+' main calls callee twice and branches once to next, so
+' --xmm-cache-line clusters callee with main and moves next, which
+' follows main in the input, out to the next line.  Relaxation must
+' see the new order: the branch to next stays brw, and the calls
+' become brw, the shortest branch that allows for the alignment
+' padding between input sections.
+	.section .text.main,"ax",@progbits
+	.global	main
+main:
+	brl	#callee
+	brl	#callee
+	brw	#next
+
+	.section .text.next,"ax",@progbits
+	.global	next
+next:
+	.fill	100, 1, 0
+
+	.section .text.callee,"ax",@progbits
+	.global	callee
+callee:
+	.fill	200, 1, 0
@@ -685,6 +685,24 @@ disassemble_init_for_target (struct disassemble_info * info)
     }
 }
 
+void
+disassemble_free_target (struct disassemble_info *info)
+{
+  if (info == NULL)
+    return;
+
+  switch (info->arch)
+    {
+#ifdef ARCH_propeller
+    case bfd_arch_propeller:
+      disassemble_free_propeller (info);
+      break;
+#endif
+    default:
+      break;
+    }
+}
+
 /* Remove whitespace and consecutive commas from OPTIONS.  */
 
 char *
@@ -21,41 +21,67 @@
 #include "sysdep.h"
 #include "dis-asm.h"
 #include "opcode/propeller.h"
+#include "libiberty.h"
 
 #include "elf-bfd.h"
 #include "elf/internal.h"
 #include "elf/propeller.h"
 
 /*
- * some flags
+ * the state kept between calls; each disassemble_info gets its own
+ * copy through private_data, set up on the first instruction and freed
+ * by disassemble_free_propeller
  */
-static int is_p2;  /* if set, assume p2 instructions */
-static int is_compress; /* if set, assume compressed instructions */
-static int is_nocompress; /* if set, assume uncompressed instructions */
+
+/* a run of code that is all compressed or all uncompressed */
+struct prop_code_range
+{
+  bfd_vma start;
+  int compressed;
+};
+
+struct prop_private_data
+{
+  int is_p2;		/* if set, assume p2 instructions */
+  int is_compress;	/* if set, assume compressed instructions */
+  int is_nocompress;	/* if set, assume uncompressed instructions */
+
+  /* ranges for the section with id SECTION_ID, built from a symbol
+     table of SYMTAB_SIZE entries running from SYM_FIRST to SYM_LAST */
+  int ranges_set;
+  unsigned int section_id;
+  int symtab_size;
+  asymbol *sym_first;
+  asymbol *sym_last;
+  struct prop_code_range *ranges;
+  int num_ranges;
+};
 
 
 static void
-parse_prop_dis_option (const char *option, unsigned int len)
+parse_prop_dis_option (struct prop_private_data *priv,
+		       const char *option, unsigned int len)
 {
   if (len == 2 && !strncmp (option, "p2", len))
     {
-      is_p2 = 1;
+      priv->is_p2 = 1;
       return;
     }
   if (len == 8 && !strncmp (option, "compress", len))
     {
-      is_compress = 1;
+      priv->is_compress = 1;
       return;
     }
   if (len == 10 && !strncmp (option, "nocompress", len))
     {
-      is_nocompress = 1;
+      priv->is_nocompress = 1;
       return;
     }
 }
 
 static void
-parse_propeller_dis_options (const char *options)
+parse_propeller_dis_options (struct prop_private_data *priv,
+			     const char *options)
 {
   const char *option_end;
 
@@ -73,7 +99,7 @@ parse_propeller_dis_options (const char *options)
       while (*option_end != ',' && *option_end != '\0')
 	option_end++;
 
-      parse_prop_dis_option (options, option_end - options);
+      parse_prop_dis_option (priv, options, option_end - options);
 
       /* Go on to the next one.  If option_end points to a comma, it
 	 will be skipped above.  */
@@ -83,11 +109,12 @@ parse_propeller_dis_options (const char *options)
 }
 
 static void
-set_default_propeller_dis_options (struct disassemble_info *info)
+set_default_propeller_dis_options (struct prop_private_data *priv,
+				   struct disassemble_info *info)
 {
-  is_p2 = 0;
-  is_compress = 0;
-  is_nocompress = 0;
+  priv->is_p2 = 0;
+  priv->is_compress = 0;
+  priv->is_nocompress = 0;
 
   /* check for p2 object files */
   if (info->flavour == bfd_target_elf_flavour && info->section != NULL)
@@ -97,16 +124,31 @@ set_default_propeller_dis_options (struct disassemble_info *info)
       header = elf_elfheader (info->section->owner);
       if ((header->e_flags & EF_PROPELLER_MACH) == EF_PROPELLER_PROP2)
 	{
-	  is_p2 = 1;
+	  priv->is_p2 = 1;
 	}
     }
 }
 
+/* Free the state print_insn_propeller hung on INFO.  */
+
+void
+disassemble_free_propeller (struct disassemble_info *info)
+{
+  struct prop_private_data *priv = info->private_data;
+
+  if (priv == NULL)
+    return;
+  free (priv->ranges);
+  free (priv);
+  info->private_data = NULL;
+}
 
 static int
-is_propeller2(struct disassemble_info * info ATTRIBUTE_UNUSED)
+is_propeller2(struct disassemble_info * info)
 {
-  return is_p2;
+  struct prop_private_data *priv = info->private_data;
+
+  return priv->is_p2;
 }
 
 static int
@@ -262,6 +304,76 @@ print_setx (struct disassemble_info *info, int setx, int val)
   }
 }
 
+/*
+ * the opcode table is searched through a hash on the instr and zcri
+ * fields (the top 10 bits of the instruction); each bucket lists the
+ * entries that can match such an instruction in propeller_opcodes[]
+ * order, so that the first match is the same as with a linear search
+ */
+#define OPCODE_HASH_BITS 10
+#define OPCODE_HASH_SIZE (1 << OPCODE_HASH_BITS)
+#define OPCODE_HASH(op) \
+  (((unsigned int) (op) >> (32 - OPCODE_HASH_BITS)) & (OPCODE_HASH_SIZE - 1))
+
+/* room for the bucket lists of one table; the P2 table needs about
+   2550 entries */
+#define OPCODE_INDEX_SIZE 3072
+
+struct opcode_hash
+{
+  int built;
+  unsigned int start[OPCODE_HASH_SIZE + 1];
+  unsigned short index[OPCODE_INDEX_SIZE];
+};
+
+/* one table for P1 and one for P2 */
+static struct opcode_hash opcode_hash[2];
+
+static int
+opcode_in_bucket (const struct propeller_opcode *op, unsigned int h)
+{
+  unsigned int key = h << (32 - OPCODE_HASH_BITS);
+  unsigned int mask = (unsigned int) op->mask
+    & ~((1U << (32 - OPCODE_HASH_BITS)) - 1);
+
+  return (key & mask) == ((unsigned int) op->opcode & mask);
+}
+
+static const struct opcode_hash *
+get_opcode_hash (int p2)
+{
+  struct opcode_hash *table = &opcode_hash[p2 != 0];
+  int hardware = p2 ? PROP_2 : PROP_1;
+  unsigned int h, n;
+  int i;
+
+  if (table->built)
+    return table;
+
+  n = 0;
+  for (h = 0; h < OPCODE_HASH_SIZE; h++)
+    {
+      table->start[h] = n;
+      for (i = 0; i < propeller_num_opcodes; i++)
+	if ((propeller_opcodes[i].hardware & hardware) != 0
+	    && opcode_in_bucket (&propeller_opcodes[i], h))
+	  n++;
+    }
+  table->start[OPCODE_HASH_SIZE] = n;
+  if (n > OPCODE_INDEX_SIZE)
+    abort ();
+
+  n = 0;
+  for (h = 0; h < OPCODE_HASH_SIZE; h++)
+    for (i = 0; i < propeller_num_opcodes; i++)
+      if ((propeller_opcodes[i].hardware & hardware) != 0
+	  && opcode_in_bucket (&propeller_opcodes[i], h))
+	table->index[n++] = i;
+
+  table->built = 1;
+  return table;
+}
+
 static int
 print_insn_propeller32 (bfd_vma memaddr, struct disassemble_info *info, int opcode)
 {
@@ -270,6 +382,9 @@ print_insn_propeller32 (bfd_vma memaddr, struct disassemble_info *info, int opco
   int indcond;
   int set, immediate;
   int i;
+  unsigned int k;
+  const struct opcode_hash *table;
+  const struct propeller_opcode *op;
   int need_zcr = 1;
   char *srcindirect, *dstindirect;
   char srcibuf[8], dstibuf[8];
@@ -334,11 +449,13 @@ print_insn_propeller32 (bfd_vma memaddr, struct disassemble_info *info, int opco
       FPRINTF (F, "\t\t");
     }
 
-  for (i = 0; i < propeller_num_opcodes; i++)
+  table = get_opcode_hash (is_propeller2 (info));
+  i = OPCODE_HASH (opcode);
+  for (k = table->start[i]; k < table->start[i + 1]; k++)
     {
-#define OP propeller_opcodes[i]
-#define HWMATCH ((OP.hardware & (is_propeller2(info) ? PROP_2 : PROP_1)) != 0)
-      if (HWMATCH && (opcode & OP.mask) == OP.opcode)
+#define OP (*op)
+      op = &propeller_opcodes[table->index[k]];
+      if ((opcode & OP.mask) == OP.opcode)
         switch (OP.format)
           {
           case PROPELLER_OPERAND_NO_OPS:
@@ -550,8 +667,9 @@ print_insn_propeller32 (bfd_vma memaddr, struct disassemble_info *info, int opco
             return -1;
           }
     }
+  op = NULL;
 done:
-  if (i < propeller_num_opcodes)
+  if (op != NULL)
     {
       if (need_zcr) {
 	char *need_comma = "";
@@ -587,36 +705,94 @@ done:
 
 /*
  * try to figure out from the symbols whether this is compressed
- * or uncompressed code
+ * or uncompressed code; the symbols of a section are turned into a
+ * sorted list of address ranges once, which is then binary searched
  */
 
+static void
+build_code_ranges (struct prop_private_data *priv,
+		   struct disassemble_info *info)
+{
+  int n, count;
+  elf_symbol_type *es;
+  asymbol *sym;
+  int compressed;
+
+  free (priv->ranges);
+  priv->ranges = NULL;
+  priv->num_ranges = 0;
+  priv->ranges_set = 1;
+  priv->section_id = info->section != NULL ? info->section->id : 0;
+  priv->symtab_size = info->symtab_size;
+  priv->sym_first = info->symtab_size > 0 ? info->symtab[0] : NULL;
+  priv->sym_last = (info->symtab_size > 0
+		    ? info->symtab[info->symtab_size - 1] : NULL);
+
+  if (info->symtab_size <= 0)
+    return;
+  priv->ranges = xmalloc (info->symtab_size * sizeof (*priv->ranges));
+
+  /* the symbol table is sorted by address; the last symbol at or
+     below an address decides what kind of code is there */
+  count = 0;
+  for (n = 0; n < info->symtab_size; n++)
+    {
+      sym = info->symtab[n];
+      if (info->section != NULL && info->section != sym->section)
+	continue;
+      if (bfd_asymbol_flavour (sym) != bfd_target_elf_flavour)
+	continue;
+      es = (elf_symbol_type *) sym;
+      compressed = (es->internal_elf_sym.st_other
+		    & PROPELLER_OTHER_COMPRESSED) != 0;
+      if (count > 0
+	  && priv->ranges[count - 1].start == bfd_asymbol_value (sym))
+	count--;
+      if (count > 0 && priv->ranges[count - 1].compressed == compressed)
+	continue;
+      priv->ranges[count].start = bfd_asymbol_value (sym);
+      priv->ranges[count].compressed = compressed;
+      count++;
+    }
+  priv->num_ranges = count;
+}
+
 static int
 is_compressed_code (bfd_vma pc, struct disassemble_info *info)
 {
-  int n, start;
-  bfd_vma addr;
-  elf_symbol_type *es;
-  unsigned int type = 0;
+  struct prop_private_data *priv = info->private_data;
+  int lo, hi, mid;
 
   /* allow explicit option overrides */
-  if (is_compress)
+  if (priv->is_compress)
     return 1;
-  if (is_nocompress)
+  if (priv->is_nocompress)
     return 0;
 
-  start = info->symtab_pos;
-  for (n = start; n < info->symtab_size; n++)
+  /* the symbols of a live section cannot move, so a symbol table with
+     the same size and ends for the same section is the same table */
+  if (!priv->ranges_set
+      || priv->section_id != (info->section != NULL ? info->section->id : 0)
+      || priv->symtab_size != info->symtab_size
+      || (info->symtab_size > 0
+	  && (priv->sym_first != info->symtab[0]
+	      || priv->sym_last != info->symtab[info->symtab_size - 1])))
+    build_code_ranges (priv, info);
+
+  /* find the last range starting at or below pc */
+  lo = 0;
+  hi = priv->num_ranges;
+  while (lo < hi)
     {
-      if (n < 0) continue;
-      addr = bfd_asymbol_value (info->symtab[n]);
-      if (info->section != NULL && info->section != info->symtab[n]->section)
-        continue; /* ignore symbol */
-      if (addr > pc)
-        break;
-      es = *(elf_symbol_type **)(info->symtab + n);
-      type = es->internal_elf_sym.st_other;
+      mid = (lo + hi) / 2;
+      if (priv->ranges[mid].start <= pc)
+	lo = mid + 1;
+      else
+	hi = mid;
     }
-  return (type & PROPELLER_OTHER_COMPRESSED) != 0;
+  if (lo == 0)
+    return 0;
+  return priv->ranges[lo - 1].compressed;
 }
 
 static char *
@@ -770,7 +946,7 @@ print_macro (bfd_vma memaddr, struct disassemble_info *info, int which)
       break;
     case MACRO_LCALL:
       if (read_halfword (memaddr, &src, info) != 0) return -1;
-      if (is_p2)
+      if (is_propeller2 (info))
 	src = src*4;
       print_opstring (info, "\t\tlcall\t%a", 0, src, 1);
       r = 2;
@@ -785,7 +961,7 @@ print_macro (bfd_vma memaddr, struct disassemble_info *info, int which)
     case MACRO_ADDSP:
       if (read_byte (memaddr, &src, info) != 0) return -1;
       r = 1;
-      if (src > 0x80) {
+      if (src >= 0x80) {
         src = 0x100 - src;
         print_opstring (info, "\t\tsub\tsp, %s", 0, src, 1);
       } else {
@@ -938,9 +1114,16 @@ print_insn_propeller (bfd_vma memaddr, struct disassemble_info *info)
   int opcode;
   int r;
   int compress = 0;
+  struct prop_private_data *priv;
 
-  set_default_propeller_dis_options (info);
-  parse_propeller_dis_options (info->disassembler_options);
+  /* the options are looked at once, when the state is set up */
+  if (info->private_data == NULL)
+    {
+      priv = xcalloc (1, sizeof (*priv));
+      set_default_propeller_dis_options (priv, info);
+      parse_propeller_dis_options (priv, info->disassembler_options);
+      info->private_data = priv;
+    }
 
   compress = is_compressed_code (memaddr, info);
   if (compress) {
@@ -918,6 +918,8 @@ trace_disasm (SIM_DESC sd, sim_cpu *cpu, address_word addr)
   /* See if we need to set up the disassembly func.  */
   if (trace_data->dis_bfd != bfd)
     {
+      if (trace_data->dis_bfd != NULL)
+	disassemble_free_target (info);
       trace_data->dis_bfd = bfd;
       trace_data->disassembler = disassembler (trace_data->dis_bfd);
       INIT_DISASSEMBLE_INFO (*info, cpu, dis_printf);
@@ -0,0 +1,1730 @@
+/* Simulator for the Parallax Propeller.
+
+   Copyright 2017 Parallax Inc.
+
+   This file is part of simulators.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include "config.h"
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "bfd.h"
+#include "gdb/callback.h"
+#include "libiberty.h"
+#include "gdb/remote-sim.h"
+
+#include "sim-main.h"
+#include "sim-options.h"
+
+#include "opcode/propeller.h"
+#include "elf-bfd.h"
+#include "elf/propeller.h"
+
+/*
+ * The simulator models a P1 chip: eight cogs with 512 longs of cog
+ * memory each, sharing 32K of hub RAM through a round robin hub
+ * window.  Every cog has its own clock; the cog that is furthest
+ * behind always executes next, so the cogs see the same ordering of
+ * hub accesses as on the real chip.
+ *
+ * Cogs execute native PASM code exactly.  The LMM and CMM kernels
+ * are not executed instruction by instruction; instead a cog running
+ * the kernel fetches and executes the hub code itself, and the kernel
+ * routines that LMM code calls (__LMM_CALL, __LMM_MVI_rN, __MULSI ...)
+ * are recognized by their addresses in the program's symbol table.
+ * Their cycle costs approximate the PASM routines of the kernel.
+ *
+ * Serial output on pin 30 is decoded and written to stdout; the
+ * sequence 0xff 0x00 <status> that the C library sends on exit ends
+ * the simulation, as it does for the serial terminal of the loader.
+ */
+
+/* Cycles taken by the kernel model.  */
+#define LMM_FETCH_CYCLES     4	/* add pc,#4 after the rdlong */
+#define CMM_DECODE_CYCLES    16	/* dispatch on the prefix byte */
+#define KERNEL_CALL_CYCLES   8
+#define KERNEL_MUL_CYCLES    (16 + 4 * 32)
+#define KERNEL_DIV_CYCLES    (16 + 16 * 32)
+#define COGINIT_CYCLES       (8 + 496 * 16)
+
+/* jmp #__LMM_BREAK, the LMM breakpoint used by GDB */
+#define LMM_BREAKPOINT       0x5c7c0014
+
+/* Address used for the kernel loop when the program has none.  */
+#define KERNEL_LOOP_DEFAULT  0x1ef
+
+#define DEFAULT_CLKFREQ      80000000
+#define DEFAULT_BAUD         115200
+
+static struct propeller_chip *
+chip (SIM_DESC sd)
+{
+  return &STATE_CPU (sd, 0)->state;
+}
+
+static void ATTRIBUTE_NORETURN
+propeller_halt (SIM_DESC sd, enum sim_stop reason, int sigrc)
+{
+  struct propeller_chip *st = chip (sd);
+
+  sim_engine_halt (sd, STATE_CPU (sd, 0), NULL,
+		   st->cog[st->focus].mem[PROP_REG_PC], reason, sigrc);
+}
+
+/* Hub memory.  */
+
+static uint32_t
+hub_read (SIM_DESC sd, uint32_t addr, int size)
+{
+  unsigned char buf[4];
+  uint32_t val = 0;
+  int i;
+
+  if (sim_core_read_buffer (sd, NULL, read_map, buf, addr, size) != size)
+    {
+      sim_io_eprintf (sd, "propeller: read of unmapped address 0x%08x\n",
+		      addr);
+      propeller_halt (sd, sim_stopped, SIM_SIGSEGV);
+    }
+  for (i = size - 1; i >= 0; i--)
+    val = (val << 8) | buf[i];
+  return val;
+}
+
+static void
+hub_write (SIM_DESC sd, uint32_t addr, uint32_t val, int size)
+{
+  unsigned char buf[4];
+  int i;
+
+  for (i = 0; i < size; i++)
+    buf[i] = val >> (8 * i);
+  if (sim_core_write_buffer (sd, NULL, write_map, buf, addr, size) != size)
+    {
+      sim_io_eprintf (sd, "propeller: write of unmapped address 0x%08x\n",
+		      addr);
+      propeller_halt (sd, sim_stopped, SIM_SIGSEGV);
+    }
+}
+
+/* Cycles for a hub access started by cog N at its current clock: the
+   cog has to wait for its slot, which comes round every 16 clocks.  */
+static int
+hub_cycles (struct propeller_chip *st, int n)
+{
+  return 8 + (int) ((2 * n - st->cog[n].cycles) & 15);
+}
+
+/* Pins and the serial receiver.  */
+
+static uint32_t
+pins_dir (struct propeller_chip *st)
+{
+  uint32_t dir = 0;
+  int n;
+
+  for (n = 0; n < PROP_NUM_COGS; n++)
+    if (st->cog[n].mode != COG_STOPPED)
+      dir |= st->cog[n].mem[PROP_REG_DIRA];
+  return dir;
+}
+
+static uint32_t
+pins_in (struct propeller_chip *st)
+{
+  uint32_t out = 0, dir = pins_dir (st);
+  int n;
+
+  for (n = 0; n < PROP_NUM_COGS; n++)
+    if (st->cog[n].mode != COG_STOPPED)
+      out |= st->cog[n].mem[PROP_REG_OUTA] & st->cog[n].mem[PROP_REG_DIRA];
+  /* undriven pins read low, except the serial receive line */
+  return out | (~dir & 0x80000000);
+}
+
+static int
+tx_level (struct propeller_chip *st)
+{
+  if ((pins_dir (st) & (1u << 30)) == 0)
+    return 1;
+  return (pins_in (st) >> 30) & 1;
+}
+
+static void
+uart_byte (SIM_DESC sd, struct propeller_chip *st, unsigned int c)
+{
+  static const char exit_seq[2] = { (char) 0xff, 0x00 };
+  char ch = c;
+
+  if (st->uart.held == 2)
+    {
+      sim_io_flush_stdout (sd);
+      sim_engine_halt (sd, STATE_CPU (sd, 0), NULL,
+		       st->cog[st->focus].mem[PROP_REG_PC], sim_exited, c);
+    }
+  if (ch == exit_seq[st->uart.held])
+    {
+      st->uart.held++;
+      return;
+    }
+  if (st->uart.held)
+    sim_io_write_stdout (sd, exit_seq, st->uart.held);
+  st->uart.held = 0;
+  sim_io_write_stdout (sd, &ch, 1);
+  if (c == '\n')
+    sim_io_flush_stdout (sd);
+}
+
+/* Sample the serial line up to clock NOW.  */
+static void
+uart_advance (SIM_DESC sd, struct propeller_chip *st, uint64_t now)
+{
+  struct propeller_uart *u = &st->uart;
+  uint64_t bit_time = st->clkfreq / st->baud;
+
+  while (u->bit >= 0)
+    {
+      uint64_t t = u->start + bit_time * (u->bit + 1) + bit_time / 2;
+
+      if (t > now)
+	break;
+      if (u->bit < 8)
+	{
+	  u->data |= u->level << u->bit;
+	  u->bit++;
+	}
+      else
+	{
+	  u->bit = -1;
+	  uart_byte (sd, st, u->data);
+	}
+    }
+}
+
+static void
+uart_update (SIM_DESC sd, struct propeller_chip *st, uint64_t now)
+{
+  struct propeller_uart *u = &st->uart;
+  int level = tx_level (st);
+
+  uart_advance (sd, st, now);
+  if (u->bit < 0 && u->level == 1 && level == 0)
+    {
+      u->bit = 0;
+      u->data = 0;
+      u->start = now;
+    }
+  u->level = level;
+}
+
+/* Cog registers.  */
+
+static uint32_t
+cog_read_src (struct propeller_chip *st, int n, uint32_t addr)
+{
+  struct propeller_cog *cog = &st->cog[n];
+
+  switch (addr)
+    {
+    case PROP_REG_PAR:
+      return cog->par;
+    case PROP_REG_CNT:
+      return (uint32_t) cog->cycles;
+    case PROP_REG_INA:
+      return pins_in (st);
+    default:
+      return cog->mem[addr];
+    }
+}
+
+static void
+cog_write (SIM_DESC sd, struct propeller_chip *st, int n, uint32_t addr,
+	   uint32_t val)
+{
+  struct propeller_cog *cog = &st->cog[n];
+
+  cog->mem[addr] = val;
+  if (addr == PROP_REG_OUTA || addr == PROP_REG_DIRA)
+    uart_update (sd, st, cog->cycles);
+}
+
+static int
+cog_condition (struct propeller_cog *cog, int cond)
+{
+  return (cond >> ((cog->c << 1) | cog->z)) & 1;
+}
+
+static int
+parity (uint32_t v)
+{
+  v ^= v >> 16;
+  v ^= v >> 8;
+  v ^= v >> 4;
+  v ^= v >> 2;
+  v ^= v >> 1;
+  return v & 1;
+}
+
+static uint32_t
+reverse (uint32_t v)
+{
+  uint32_t r = 0;
+  int i;
+
+  for (i = 0; i < 32; i++)
+    r |= ((v >> i) & 1) << (31 - i);
+  return r;
+}
+
+static int
+add_overflow (uint32_t d, uint32_t s, uint32_t r)
+{
+  return ((d ^ r) & (s ^ r)) >> 31;
+}
+
+static int
+sub_overflow (uint32_t d, uint32_t s, uint32_t r)
+{
+  return ((d ^ s) & (d ^ r)) >> 31;
+}
+
+static void stop_cog (SIM_DESC, struct propeller_chip *, int);
+static int start_cog (SIM_DESC, struct propeller_chip *, int, uint32_t,
+		      uint32_t, uint64_t);
+
+/* Execute the hub instruction (coginit, cogid, locknew ...) selected by
+   S for cog N.  Returns the result; *C is set to the carry result.  */
+static uint32_t
+hubop (SIM_DESC sd, struct propeller_chip *st, int n, uint32_t d,
+       uint32_t s, int *c)
+{
+  struct propeller_cog *cog = &st->cog[n];
+  int i;
+
+  *c = 0;
+  switch (s & 7)
+    {
+    case 0:			/* clkset */
+      return d;
+    case 1:			/* cogid */
+      return n;
+    case 2:			/* coginit */
+      {
+	uint32_t par = (d >> 16) & 0xfffc;
+	uint32_t code = (d >> 2) & 0xfffc;
+	int id = d & 7;
+
+	if (d & 8)
+	  {
+	    for (id = 0; id < PROP_NUM_COGS; id++)
+	      if (st->cog[id].mode == COG_STOPPED)
+		break;
+	    if (id == PROP_NUM_COGS)
+	      {
+		*c = 1;
+		return 7;
+	      }
+	  }
+	start_cog (sd, st, id, code, par, cog->cycles + COGINIT_CYCLES);
+	return id;
+      }
+    case 3:			/* cogstop */
+      stop_cog (sd, st, d & 7);
+      return d & 7;
+    case 4:			/* locknew */
+      for (i = 0; i < PROP_NUM_LOCKS; i++)
+	if (!st->lock_used[i])
+	  {
+	    st->lock_used[i] = 1;
+	    return i;
+	  }
+      *c = 1;
+      return 7;
+    case 5:			/* lockret */
+      st->lock_used[d & 7] = 0;
+      return d & 7;
+    case 6:			/* lockset */
+      *c = st->lock_state[d & 7];
+      st->lock_state[d & 7] = 1;
+      return d & 7;
+    default:			/* lockclr */
+      *c = st->lock_state[d & 7];
+      st->lock_state[d & 7] = 0;
+      return d & 7;
+    }
+}
+
+/* Execute the native instruction INSN in cog N.  NEXT is the cog
+   address of the following instruction; if the instruction jumps,
+   *JUMP is set to the target.  Returns the number of cycles.  */
+static int
+cog_execute (SIM_DESC sd, struct propeller_chip *st, int n, uint32_t insn,
+	     uint32_t next, int *jump)
+{
+  struct propeller_cog *cog = &st->cog[n];
+  unsigned int op = insn >> 26;
+  int wz = (insn >> 25) & 1;
+  int wc = (insn >> 24) & 1;
+  int wr = (insn >> 23) & 1;
+  int imm = (insn >> 22) & 1;
+  int cond = (insn >> 18) & 0xf;
+  uint32_t dst = (insn >> 9) & 0x1ff;
+  uint32_t src = insn & 0x1ff;
+  uint32_t d, s, r;
+  int z, c, sh;
+  int cycles = 4;
+  uint64_t wide;
+
+  *jump = -1;
+  if (!cog_condition (cog, cond))
+    return 4;
+
+  d = cog->mem[dst];
+  s = imm ? src : cog_read_src (st, n, src);
+  sh = s & 31;
+  r = d;
+  z = cog->z;
+  c = cog->c;
+
+  switch (op)
+    {
+    case 0x00:			/* wrbyte/rdbyte */
+    case 0x01:			/* wrword/rdword */
+    case 0x02:			/* wrlong/rdlong */
+      {
+	int size = 1 << op;
+	uint32_t addr = s & PROP_HUB_MASK & ~(size - 1);
+
+	cycles = hub_cycles (st, n);
+	if (wr)
+	  {
+	    r = hub_read (sd, addr, size);
+	    z = r == 0;
+	  }
+	else
+	  hub_write (sd, addr, d, size);
+      }
+      break;
+    case 0x03:			/* hubop */
+      cycles = hub_cycles (st, n);
+      r = hubop (sd, st, n, d, s, &c);
+      z = r == 0;
+      if (cog->mode == COG_STOPPED)
+	return cycles;
+      break;
+    case 0x08:			/* ror */
+      r = sh ? (d >> sh) | (d << (32 - sh)) : d;
+      c = d & 1;
+      z = r == 0;
+      break;
+    case 0x09:			/* rol */
+      r = sh ? (d << sh) | (d >> (32 - sh)) : d;
+      c = d >> 31;
+      z = r == 0;
+      break;
+    case 0x0a:			/* shr */
+      r = d >> sh;
+      c = d & 1;
+      z = r == 0;
+      break;
+    case 0x0b:			/* shl */
+      r = d << sh;
+      c = d >> 31;
+      z = r == 0;
+      break;
+    case 0x0c:			/* rcr */
+      r = d >> sh;
+      if (cog->c && sh)
+	r |= ~(0xffffffffu >> sh);
+      c = d & 1;
+      z = r == 0;
+      break;
+    case 0x0d:			/* rcl */
+      r = d << sh;
+      if (cog->c && sh)
+	r |= (1u << sh) - 1;
+      c = d >> 31;
+      z = r == 0;
+      break;
+    case 0x0e:			/* sar */
+      r = (uint32_t) ((int32_t) d >> sh);
+      c = d & 1;
+      z = r == 0;
+      break;
+    case 0x0f:			/* rev */
+      r = reverse (d) >> sh;
+      c = d & 1;
+      z = r == 0;
+      break;
+    case 0x10:			/* mins */
+      c = (int32_t) d < (int32_t) s;
+      r = c ? s : d;
+      z = s == 0;
+      break;
+    case 0x11:			/* maxs */
+      c = (int32_t) d < (int32_t) s;
+      r = c ? d : s;
+      z = s == 0;
+      break;
+    case 0x12:			/* min */
+      c = d < s;
+      r = c ? s : d;
+      z = s == 0;
+      break;
+    case 0x13:			/* max */
+      c = d < s;
+      r = c ? d : s;
+      z = s == 0;
+      break;
+    case 0x14:			/* movs */
+      r = (d & ~0x1ffu) | (s & 0x1ff);
+      z = r == 0;
+      break;
+    case 0x15:			/* movd */
+      r = (d & ~(0x1ffu << 9)) | ((s & 0x1ff) << 9);
+      z = r == 0;
+      break;
+    case 0x16:			/* movi */
+      r = (d & 0x007fffff) | ((s & 0x1ff) << 23);
+      z = r == 0;
+      break;
+    case 0x17:			/* jmpret (jmp, call, ret) */
+      r = (d & ~0x1ffu) | (next & 0x1ff);
+      z = r == 0;
+      *jump = s & 0x1ff;
+      break;
+    case 0x18:			/* and (test) */
+      r = d & s;
+      z = r == 0;
+      c = parity (r);
+      break;
+    case 0x19:			/* andn (testn) */
+      r = d & ~s;
+      z = r == 0;
+      c = parity (r);
+      break;
+    case 0x1a:			/* or */
+      r = d | s;
+      z = r == 0;
+      c = parity (r);
+      break;
+    case 0x1b:			/* xor */
+      r = d ^ s;
+      z = r == 0;
+      c = parity (r);
+      break;
+    case 0x1c:			/* muxc */
+    case 0x1d:			/* muxnc */
+    case 0x1e:			/* muxz */
+    case 0x1f:			/* muxnz */
+      {
+	int flag = (op & 2) ? cog->z : cog->c;
+
+	if (op & 1)
+	  flag = !flag;
+	r = (d & ~s) | (flag ? s : 0);
+	z = r == 0;
+	c = parity (r);
+      }
+      break;
+    case 0x20:			/* add */
+      r = d + s;
+      c = r < d;
+      z = r == 0;
+      break;
+    case 0x21:			/* sub (cmp) */
+      r = d - s;
+      c = d < s;
+      z = r == 0;
+      break;
+    case 0x22:			/* addabs */
+    case 0x23:			/* subabs */
+      {
+	uint32_t a = (int32_t) s < 0 ? -s : s;
+	int add = (op == 0x22) == ((int32_t) s >= 0);
+
+	r = add ? d + a : d - a;
+	c = add ? r < d : d < a;
+	z = r == 0;
+      }
+      break;
+    case 0x24:			/* sumc */
+    case 0x25:			/* sumnc */
+    case 0x26:			/* sumz */
+    case 0x27:			/* sumnz */
+      {
+	int flag = (op & 2) ? cog->z : cog->c;
+
+	if (op & 1)
+	  flag = !flag;
+	if (flag)
+	  {
+	    r = d - s;
+	    c = sub_overflow (d, s, r);
+	  }
+	else
+	  {
+	    r = d + s;
+	    c = add_overflow (d, s, r);
+	  }
+	z = r == 0;
+      }
+      break;
+    case 0x28:			/* mov */
+      r = s;
+      z = r == 0;
+      c = s >> 31;
+      break;
+    case 0x29:			/* neg */
+      r = -s;
+      z = r == 0;
+      c = s >> 31;
+      break;
+    case 0x2a:			/* abs */
+      r = (int32_t) s < 0 ? -s : s;
+      z = r == 0;
+      c = s >> 31;
+      break;
+    case 0x2b:			/* absneg */
+      r = (int32_t) s < 0 ? s : -s;
+      z = r == 0;
+      c = s >> 31;
+      break;
+    case 0x2c:			/* negc */
+    case 0x2d:			/* negnc */
+    case 0x2e:			/* negz */
+    case 0x2f:			/* negnz */
+      {
+	int flag = (op & 2) ? cog->z : cog->c;
+
+	if (op & 1)
+	  flag = !flag;
+	r = flag ? -s : s;
+	z = r == 0;
+	c = s >> 31;
+      }
+      break;
+    case 0x30:			/* cmps */
+      r = d - s;
+      z = d == s;
+      c = (int32_t) d < (int32_t) s;
+      break;
+    case 0x31:			/* cmpsx */
+      r = d - s - cog->c;
+      z = cog->z && r == 0;
+      c = (int64_t) (int32_t) d < (int64_t) (int32_t) s + cog->c;
+      break;
+    case 0x32:			/* addx */
+      wide = (uint64_t) d + s + cog->c;
+      r = wide;
+      c = wide >> 32;
+      z = cog->z && r == 0;
+      break;
+    case 0x33:			/* subx (cmpx) */
+      r = d - s - cog->c;
+      c = (uint64_t) d < (uint64_t) s + cog->c;
+      z = cog->z && r == 0;
+      break;
+    case 0x34:			/* adds */
+      r = d + s;
+      c = add_overflow (d, s, r);
+      z = r == 0;
+      break;
+    case 0x35:			/* subs */
+      r = d - s;
+      c = sub_overflow (d, s, r);
+      z = r == 0;
+      break;
+    case 0x36:			/* addsx */
+      {
+	int64_t sum = (int64_t) (int32_t) d + (int32_t) s + cog->c;
+
+	r = sum;
+	c = sum != (int32_t) r;
+	z = cog->z && r == 0;
+      }
+      break;
+    case 0x37:			/* subsx */
+      {
+	int64_t diff = (int64_t) (int32_t) d - (int32_t) s - cog->c;
+
+	r = diff;
+	c = diff != (int32_t) r;
+	z = cog->z && r == 0;
+      }
+      break;
+    case 0x38:			/* cmpsub */
+      c = d >= s;
+      r = c ? d - s : d;
+      z = r == 0;
+      break;
+    case 0x39:			/* djnz */
+      r = d - 1;
+      c = d == 0;
+      z = r == 0;
+      if (r != 0)
+	*jump = s & 0x1ff;
+      else
+	cycles = 8;
+      break;
+    case 0x3a:			/* tjnz */
+    case 0x3b:			/* tjz */
+      z = d == 0;
+      c = 0;
+      if ((d != 0) == (op == 0x3a))
+	*jump = s & 0x1ff;
+      else
+	cycles = 8;
+      break;
+    case 0x3c:			/* waitpeq */
+    case 0x3d:			/* waitpne */
+      if (((pins_in (st) & s) == d) != (op == 0x3c))
+	{
+	  /* try again once the other cogs have caught up */
+	  cog->waiting = 1;
+	  return 0;
+	}
+      cog->waiting = 0;
+      cycles = 6;
+      break;
+    case 0x3e:			/* waitcnt */
+      {
+	uint32_t wait = d - (uint32_t) (cog->cycles + 6);
+
+	cycles = 6;
+	cog->cycles += wait;
+	r = d + s;
+	c = r < d;
+	z = r == 0;
+      }
+      break;
+    case 0x3f:			/* waitvid */
+      cycles = 7;
+      break;
+    default:
+      sim_io_eprintf (sd, "propeller: cog %d: illegal instruction 0x%08x\n",
+		      n, insn);
+      propeller_halt (sd, sim_stopped, SIM_SIGILL);
+    }
+
+  if (wz)
+    cog->z = z;
+  if (wc)
+    cog->c = c;
+  if (wr)
+    cog_write (sd, st, n, dst, r);
+  return cycles;
+}
+
+/* The kernel model.  */
+
+static int
+kernel_helper (SIM_DESC sd, struct propeller_chip *st, int n,
+	       const struct propeller_hook *hook, uint32_t arg);
+
+/* A kernel cog jumped to cog address TARGET while interpreting hub
+   code.  Either run the kernel routine there or start executing the
+   cog code.  Returns the cycles taken.  */
+static int
+kernel_jump (SIM_DESC sd, struct propeller_chip *st, int n, uint32_t target)
+{
+  struct propeller_cog *cog = &st->cog[n];
+  const struct propeller_hook *hook = &st->hook[target];
+
+  if (hook->op == KERNEL_LOOP)
+    return 0;
+  if (hook->op != KERNEL_NONE)
+    return kernel_helper (sd, st, n, hook,
+			  st->tmp0 >= 0 ? cog->mem[st->tmp0] : 0);
+  cog->mode = COG_NATIVE;
+  cog->pc = target;
+  return 0;
+}
+
+/* Execute the native instruction INSN fetched from hub memory.  */
+static int
+kernel_execute (SIM_DESC sd, struct propeller_chip *st, int n, uint32_t insn)
+{
+  int jump;
+  int cycles = cog_execute (sd, st, n, insn, st->loop, &jump);
+
+  if (jump >= 0 && st->cog[n].mode != COG_STOPPED)
+    cycles += kernel_jump (sd, st, n, jump);
+  return cycles;
+}
+
+/* Load COUNT bytes of code at the hub pc into the fcache buffer and
+   jump to it.  */
+static int
+kernel_fcache (SIM_DESC sd, struct propeller_chip *st, int n,
+	       uint32_t start, uint32_t count)
+{
+  struct propeller_cog *cog = &st->cog[n];
+  uint32_t i, longs = (count + 3) / 4;
+  int cycles = KERNEL_CALL_CYCLES;
+
+  if (cog->fcache_addr != start)
+    {
+      if (st->fcache_start + longs > PROP_REG_PAR)
+	{
+	  sim_io_eprintf (sd, "propeller: fcache block at 0x%x too large\n",
+			  start);
+	  propeller_halt (sd, sim_stopped, SIM_SIGSEGV);
+	}
+      for (i = 0; i < longs; i++)
+	cog->mem[st->fcache_start + i] = hub_read (sd, start + 4 * i, 4);
+      cog->fcache_addr = start;
+      cycles += longs * 16;
+    }
+  cog->mem[PROP_REG_PC] = start + count;
+  cog->mode = COG_NATIVE;
+  cog->pc = st->fcache_start;
+  return cycles;
+}
+
+static int
+kernel_helper (SIM_DESC sd, struct propeller_chip *st, int n,
+	       const struct propeller_hook *hook, uint32_t arg)
+{
+  struct propeller_cog *cog = &st->cog[n];
+  uint32_t *mem = cog->mem;
+  uint32_t pc = mem[PROP_REG_PC];
+  int cycles = KERNEL_CALL_CYCLES;
+  int i, count, reg;
+
+  switch (hook->op)
+    {
+    case KERNEL_JMP:
+      cycles += hub_cycles (st, n);
+      mem[PROP_REG_PC] = hub_read (sd, pc, 4);
+      break;
+    case KERNEL_CALL:
+      cycles += hub_cycles (st, n);
+      mem[PROP_REG_LR] = pc + 4;
+      mem[PROP_REG_PC] = hub_read (sd, pc, 4);
+      break;
+    case KERNEL_MVI:
+      cycles += hub_cycles (st, n);
+      mem[hook->reg] = hub_read (sd, pc, 4);
+      mem[PROP_REG_PC] = pc + 4;
+      break;
+    case KERNEL_FCACHE:
+      cycles += hub_cycles (st, n);
+      return cycles + kernel_fcache (sd, st, n, pc + 4, hub_read (sd, pc, 4));
+    case KERNEL_PUSHM:
+      /* push COUNT registers, starting at the one in the low nibble */
+      reg = arg & 15;
+      count = (arg >> 4) & 15;
+      for (i = 0; i < count; i++)
+	{
+	  mem[PROP_REG_SP] -= 4;
+	  hub_write (sd, mem[PROP_REG_SP] & PROP_HUB_MASK, mem[reg + i], 4);
+	  cycles += 16;
+	}
+      break;
+    case KERNEL_POPM:
+    case KERNEL_POPRET:
+      /* pop COUNT registers, ending with the one in the low nibble */
+      reg = arg & 15;
+      count = (arg >> 4) & 15;
+      for (i = 0; i < count; i++)
+	{
+	  mem[(reg - i) & 0x1ff] = hub_read (sd, mem[PROP_REG_SP]
+					     & PROP_HUB_MASK, 4);
+	  mem[PROP_REG_SP] += 4;
+	  cycles += 16;
+	}
+      if (hook->op == KERNEL_POPRET)
+	mem[PROP_REG_PC] = mem[PROP_REG_LR];
+      break;
+    case KERNEL_LRET:
+      mem[PROP_REG_PC] = mem[PROP_REG_LR];
+      break;
+    case KERNEL_MUL:
+      mem[0] = mem[0] * mem[1];
+      cycles = KERNEL_MUL_CYCLES;
+      break;
+    case KERNEL_UDIV:
+    case KERNEL_DIV:
+      {
+	uint32_t a = mem[0], b = mem[1], q, rem;
+	int neg_q = 0, neg_r = 0;
+
+	if (hook->op == KERNEL_DIV)
+	  {
+	    neg_q = ((int32_t) a < 0) != ((int32_t) b < 0);
+	    neg_r = (int32_t) a < 0;
+	    if ((int32_t) a < 0)
+	      a = -a;
+	    if ((int32_t) b < 0)
+	      b = -b;
+	  }
+	/* like the shift and subtract loop of the kernel */
+	q = b ? a / b : 0xffffffff;
+	rem = b ? a % b : a;
+	mem[0] = neg_q ? -q : q;
+	mem[1] = neg_r ? -rem : rem;
+	cycles = KERNEL_DIV_CYCLES;
+      }
+      break;
+    default:
+      break;
+    }
+
+  /* routines called from native code return through their _ret
+     register, which holds the return address */
+  if (cog->mode == COG_NATIVE && hook->ret >= 0)
+    {
+      uint32_t ret = mem[hook->ret] & 0x1ff;
+
+      if (st->hook[ret].op == KERNEL_LOOP)
+	cog->mode = cog->kernel;
+      else
+	cog->pc = ret;
+    }
+  else
+    cog->mode = cog->kernel;
+  return cycles;
+}
+
+static void
+kernel_breakpoint (SIM_DESC sd, struct propeller_chip *st, int n)
+{
+  st->focus = n;
+  propeller_halt (sd, sim_stopped, SIM_SIGTRAP);
+}
+
+/* Execute one LMM instruction.  */
+static int
+lmm_step (SIM_DESC sd, struct propeller_chip *st, int n)
+{
+  struct propeller_cog *cog = &st->cog[n];
+  uint32_t pc = cog->mem[PROP_REG_PC];
+  uint32_t insn;
+  int cycles = hub_cycles (st, n) + LMM_FETCH_CYCLES;
+
+  insn = hub_read (sd, pc, 4);
+  if (insn == LMM_BREAKPOINT)
+    kernel_breakpoint (sd, st, n);
+  cog->mem[PROP_REG_PC] = pc + 4;
+  return cycles + kernel_execute (sd, st, n, insn);
+}
+
+/* The extended operations of the compressed register forms.  */
+static void
+cmm_xop (SIM_DESC sd, struct propeller_chip *st, int n, int dst, int xop,
+	 uint32_t s, int *cycles)
+{
+  struct propeller_cog *cog = &st->cog[n];
+  uint32_t d = cog->mem[dst];
+
+  switch (xop)
+    {
+    case XOP_ADD: d += s; break;
+    case XOP_SUB: d -= s; break;
+    case XOP_CMPS:
+      cog->z = d == s;
+      cog->c = (int32_t) d < (int32_t) s;
+      return;
+    case XOP_CMPU:
+      cog->z = d == s;
+      cog->c = d < s;
+      return;
+    case XOP_AND: d &= s; break;
+    case XOP_ANDN: d &= ~s; break;
+    case XOP_NEG: d = -s; break;
+    case XOP_OR: d |= s; break;
+    case XOP_XOR: d ^= s; break;
+    case XOP_SHL: d <<= s & 31; break;
+    case XOP_SHR: d >>= s & 31; break;
+    case XOP_SAR: d = (uint32_t) ((int32_t) d >> (s & 31)); break;
+    case XOP_RDB:
+      *cycles += hub_cycles (st, n);
+      d = hub_read (sd, s & PROP_HUB_MASK, 1);
+      break;
+    case XOP_RDL:
+      *cycles += hub_cycles (st, n);
+      d = hub_read (sd, s & PROP_HUB_MASK & ~3, 4);
+      break;
+    case XOP_WRB:
+      *cycles += hub_cycles (st, n);
+      hub_write (sd, s & PROP_HUB_MASK, d, 1);
+      return;
+    default:			/* XOP_WRL */
+      *cycles += hub_cycles (st, n);
+      hub_write (sd, s & PROP_HUB_MASK & ~3, d, 4);
+      return;
+    }
+  cog->mem[dst] = d;
+}
+
+static uint32_t
+sign_extend (uint32_t v, int bits)
+{
+  uint32_t m = 1u << (bits - 1);
+
+  return (v ^ m) - m;
+}
+
+/* Execute one CMM instruction.  */
+static int
+cmm_step (SIM_DESC sd, struct propeller_chip *st, int n)
+{
+  static const struct propeller_hook helper[] = {
+    { KERNEL_PUSHM, 0, -1 },
+    { KERNEL_POPM, 0, -1 },
+    { KERNEL_POPRET, 0, -1 },
+    { KERNEL_MUL, 0, -1 },
+    { KERNEL_UDIV, 0, -1 },
+    { KERNEL_DIV, 0, -1 }
+  };
+  struct propeller_cog *cog = &st->cog[n];
+  uint32_t *mem = cog->mem;
+  uint32_t pc = mem[PROP_REG_PC];
+  uint32_t v, s;
+  int op, prefix, dst, len;
+  int cycles;
+
+  op = hub_read (sd, pc, 1);
+  prefix = op & 0xf0;
+  dst = op & 0x0f;
+
+  switch (prefix)
+    {
+    case PREFIX_MACRO:
+      switch (dst)
+	{
+	case MACRO_BREAK:
+	  kernel_breakpoint (sd, st, n);
+	  /* not reached */
+	case MACRO_RET:
+	  len = 1;
+	  mem[PROP_REG_PC] = mem[PROP_REG_LR];
+	  break;
+	case MACRO_PUSHM:
+	case MACRO_POPM:
+	case MACRO_POPRET:
+	  len = 2;
+	  mem[PROP_REG_PC] = pc + len;
+	  cycles = kernel_helper (sd, st, n, &helper[dst - MACRO_PUSHM],
+				  hub_read (sd, pc + 1, 1));
+	  return cycles + 2 * hub_cycles (st, n) + CMM_DECODE_CYCLES;
+	case MACRO_LCALL:
+	  len = 3;
+	  mem[PROP_REG_LR] = pc + len;
+	  mem[PROP_REG_PC] = hub_read (sd, pc + 1, 2);
+	  break;
+	case MACRO_MUL:
+	case MACRO_UDIV:
+	case MACRO_DIV:
+	  len = 1;
+	  mem[PROP_REG_PC] = pc + len;
+	  cycles = kernel_helper (sd, st, n, &helper[dst - MACRO_MUL + 3], 0);
+	  return cycles + hub_cycles (st, n) + CMM_DECODE_CYCLES;
+	case MACRO_MVREG:
+	  len = 2;
+	  v = hub_read (sd, pc + 1, 1);
+	  mem[v >> 4] = mem[v & 15];
+	  mem[PROP_REG_PC] = pc + len;
+	  break;
+	case MACRO_XMVREG:
+	  len = 3;
+	  v = hub_read (sd, pc + 1, 1);
+	  mem[v >> 4] = mem[v & 15];
+	  v = hub_read (sd, pc + 2, 1);
+	  mem[v >> 4] = mem[v & 15];
+	  mem[PROP_REG_PC] = pc + len;
+	  break;
+	case MACRO_ADDSP:
+	  len = 2;
+	  mem[PROP_REG_SP] += sign_extend (hub_read (sd, pc + 1, 1), 8);
+	  mem[PROP_REG_PC] = pc + len;
+	  break;
+	case MACRO_LJMP:
+	  len = 5;
+	  mem[PROP_REG_PC] = hub_read (sd, pc + 1, 4);
+	  break;
+	case MACRO_FCACHE:
+	  len = 3;
+	  cycles = kernel_fcache (sd, st, n, (pc + len + 3) & ~3,
+				  hub_read (sd, pc + 1, 2));
+	  return cycles + len * hub_cycles (st, n) + CMM_DECODE_CYCLES;
+	case MACRO_NATIVE:
+	  len = 5;
+	  mem[PROP_REG_PC] = pc + len;
+	  cycles = kernel_execute (sd, st, n, hub_read (sd, pc + 1, 4));
+	  return cycles + len * hub_cycles (st, n) + CMM_DECODE_CYCLES;
+	default:		/* MACRO_NOP */
+	  len = 1;
+	  mem[PROP_REG_PC] = pc + len;
+	  break;
+	}
+      return len * hub_cycles (st, n) + CMM_DECODE_CYCLES;
+
+    case PREFIX_REGREG:
+    case PREFIX_REGIMM4:
+    case PREFIX_REGIMM12:
+    case PREFIX_XMOVREG:
+    case PREFIX_XMOVIMM:
+      cycles = 4;
+      len = 2;
+      if (prefix == PREFIX_XMOVREG || prefix == PREFIX_XMOVIMM)
+	{
+	  /* the mov comes first */
+	  v = hub_read (sd, pc + 1, 1);
+	  mem[v >> 4] = mem[v & 15];
+	  len = 3;
+	}
+      if (prefix == PREFIX_REGIMM12)
+	{
+	  len = 3;
+	  v = hub_read (sd, pc + 1, 2);
+	  s = sign_extend (v & 0xfff, 12);
+	  v >>= 12;
+	}
+      else
+	{
+	  v = hub_read (sd, pc + len - 1, 1);
+	  s = v >> 4;
+	  v &= 15;
+	  if (prefix == PREFIX_REGREG || prefix == PREFIX_XMOVREG)
+	    s = mem[s];
+	}
+      mem[PROP_REG_PC] = pc + len;
+      cmm_xop (sd, st, n, dst, v, s, &cycles);
+      return cycles + len * hub_cycles (st, n) + CMM_DECODE_CYCLES;
+
+    case PREFIX_BRW:
+    case PREFIX_BRS:
+      len = prefix == PREFIX_BRW ? 3 : 2;
+      mem[PROP_REG_PC] = pc + len;
+      if (cog_condition (cog, dst))
+	mem[PROP_REG_PC] += sign_extend (hub_read (sd, pc + 1, len - 1),
+					 8 * (len - 1));
+      break;
+    case PREFIX_MVI:
+      len = 5;
+      mem[dst] = hub_read (sd, pc + 1, 4);
+      mem[PROP_REG_PC] = pc + len;
+      break;
+    case PREFIX_MVIW:
+      len = 3;
+      mem[dst] = hub_read (sd, pc + 1, 2);
+      mem[PROP_REG_PC] = pc + len;
+      break;
+    case PREFIX_MVIB:
+      len = 2;
+      mem[dst] = hub_read (sd, pc + 1, 1);
+      mem[PROP_REG_PC] = pc + len;
+      break;
+    case PREFIX_ZEROREG:
+      len = 1;
+      mem[dst] = 0;
+      mem[PROP_REG_PC] = pc + len;
+      break;
+    case PREFIX_LEASP:
+      len = 2;
+      mem[dst] = mem[PROP_REG_SP] + hub_read (sd, pc + 1, 1);
+      mem[PROP_REG_PC] = pc + len;
+      break;
+    case PREFIX_SKIP2:
+    case PREFIX_SKIP3:
+      /* skip the next instruction if the condition holds */
+      len = 1;
+      mem[PROP_REG_PC] = pc + len;
+      if (cog_condition (cog, dst))
+	mem[PROP_REG_PC] += prefix == PREFIX_SKIP2 ? 2 : 3;
+      break;
+    default:			/* PREFIX_PACK_NATIVE */
+      len = 4;
+      v = hub_read (sd, pc + 1, 3);
+      mem[PROP_REG_PC] = pc + len;
+      cycles = kernel_execute (sd, st, n, (v & 0x3ffff)
+			       | (((v >> 18) & 0x3f) << 26)
+			       | (0xf << 18) | (dst << 22));
+      return cycles + len * hub_cycles (st, n) + CMM_DECODE_CYCLES;
+    }
+  return len * hub_cycles (st, n) + CMM_DECODE_CYCLES;
+}
+
+/* Execute one native instruction.  */
+static int
+native_step (SIM_DESC sd, struct propeller_chip *st, int n)
+{
+  struct propeller_cog *cog = &st->cog[n];
+  int jump, cycles;
+
+  if (cog->kernel != COG_STOPPED && st->hook[cog->pc].op != KERNEL_NONE)
+    {
+      if (st->hook[cog->pc].op == KERNEL_LOOP)
+	{
+	  cog->mode = cog->kernel;
+	  return 0;
+	}
+      return kernel_helper (sd, st, n, &st->hook[cog->pc],
+			    st->tmp0 >= 0 ? cog->mem[st->tmp0] : 0);
+    }
+
+  cycles = cog_execute (sd, st, n, cog->mem[cog->pc],
+			(cog->pc + 1) & 0x1ff, &jump);
+  if (cog->waiting || cog->mode == COG_STOPPED)
+    return cycles;
+  cog->pc = jump >= 0 ? (uint32_t) jump : (cog->pc + 1) & 0x1ff;
+  return cycles;
+}
+
+/* Cogs.  */
+
+static void
+stop_cog (SIM_DESC sd, struct propeller_chip *st, int n)
+{
+  st->cog[n].mode = COG_STOPPED;
+  st->cog[n].kernel = COG_STOPPED;
+  st->cog[n].waiting = 0;
+  uart_update (sd, st, st->cog[n].cycles);
+}
+
+/* Start cog N with the image at hub address CODE and PAR, at clock
+   CYCLES.  A cog started with the kernel image runs the kernel model:
+   PAR points to the initial pc, followed by the stack.  */
+static int
+start_cog (SIM_DESC sd, struct propeller_chip *st, int n, uint32_t code,
+	   uint32_t par, uint64_t cycles)
+{
+  struct propeller_cog *cog = &st->cog[n];
+  int i;
+
+  memset (cog, 0, sizeof (*cog));
+  cog->par = par;
+  cog->cycles = cycles;
+  cog->fcache_addr = ~0u;
+  for (i = 0; i < PROP_REG_PAR; i++)
+    cog->mem[i] = hub_read (sd, (code + 4 * i) & PROP_HUB_MASK, 4);
+
+  if (st->have_kernel && code == st->kernel_lma)
+    {
+      cog->kernel = chip (sd)->cog[0].kernel;
+      cog->mode = cog->kernel;
+      cog->mem[PROP_REG_PC] = hub_read (sd, par, 4);
+      cog->mem[PROP_REG_SP] = par + 4;
+    }
+  else
+    cog->mode = COG_NATIVE;
+  return n;
+}
+
+/* The kernel routines by name.  */
+static const struct
+{
+  const char *name;
+  enum propeller_kernel_op op;
+} kernel_routines[] = {
+  { "__LMM_loop", KERNEL_LOOP },
+  { "__LMM_JMP", KERNEL_JMP },
+  { "__LMM_CALL", KERNEL_CALL },
+  { "__LMM_FCACHE_LOAD", KERNEL_FCACHE },
+  { "__LMM_PUSHM", KERNEL_PUSHM },
+  { "__LMM_POPM", KERNEL_POPM },
+  { "__LMM_POPRET", KERNEL_POPRET },
+  { "__LMM_lret", KERNEL_LRET },
+  { "__MULSI", KERNEL_MUL },
+  { "__UDIVSI", KERNEL_UDIV },
+  { "__DIVSI", KERNEL_DIV },
+};
+
+/* Cog address of symbol SYM.  */
+static uint32_t
+cog_address (asymbol *sym)
+{
+  if (bfd_is_abs_section (bfd_get_section (sym)))
+    return bfd_asymbol_value (sym) & 0x1ff;
+  return (bfd_asymbol_value (sym) >> 2) & 0x1ff;
+}
+
+static asymbol *
+find_symbol (asymbol **syms, long count, const char *name)
+{
+  long i;
+
+  for (i = 0; i < count; i++)
+    if (strcmp (bfd_asymbol_name (syms[i]), name) == 0)
+      return syms[i];
+  return NULL;
+}
+
+static void
+setup_kernel (SIM_DESC sd, struct propeller_chip *st, bfd *abfd,
+	      uint32_t *stack)
+{
+  asymbol **syms = NULL, *sym;
+  long size, count = 0, i;
+  asection *sec;
+  char name[32];
+  int r;
+
+  for (i = 0; i < PROP_COG_LONGS; i++)
+    {
+      st->hook[i].op = KERNEL_NONE;
+      st->hook[i].ret = -1;
+    }
+  st->loop = KERNEL_LOOP_DEFAULT;
+  st->fcache_start = 0;
+  st->tmp0 = -1;
+  st->have_kernel = 0;
+  *stack = 0x8000;
+
+  if (abfd == NULL)
+    {
+      st->hook[st->loop].op = KERNEL_LOOP;
+      return;
+    }
+
+  size = bfd_get_symtab_upper_bound (abfd);
+  if (size > 0)
+    {
+      syms = xmalloc (size);
+      count = bfd_canonicalize_symtab (abfd, syms);
+      if (count < 0)
+	count = 0;
+    }
+
+  if ((sym = find_symbol (syms, count, "__LMM_loop")) != NULL)
+    st->loop = cog_address (sym);
+  st->hook[st->loop].op = KERNEL_LOOP;
+  for (i = 1; i < (long) ARRAY_SIZE (kernel_routines); i++)
+    if ((sym = find_symbol (syms, count, kernel_routines[i].name)) != NULL)
+      {
+	struct propeller_hook *hook = &st->hook[cog_address (sym)];
+	asymbol *ret;
+
+	hook->op = kernel_routines[i].op;
+	snprintf (name, sizeof (name), "%s_ret", kernel_routines[i].name);
+	if ((ret = find_symbol (syms, count, name)) != NULL)
+	  hook->ret = cog_address (ret);
+      }
+  for (r = 0; r < 16; r++)
+    {
+      if (r == PROP_REG_LR)
+	strcpy (name, "__LMM_MVI_lr");
+      else
+	snprintf (name, sizeof (name), "__LMM_MVI_r%d", r);
+      if ((sym = find_symbol (syms, count, name)) != NULL)
+	{
+	  st->hook[cog_address (sym)].op = KERNEL_MVI;
+	  st->hook[cog_address (sym)].reg = r;
+	}
+    }
+  if ((sym = find_symbol (syms, count, "__LMM_FCACHE_START")) != NULL)
+    st->fcache_start = cog_address (sym);
+  if ((sym = find_symbol (syms, count, "__TMP0")) != NULL)
+    st->tmp0 = cog_address (sym);
+  if ((sym = find_symbol (syms, count, "__stack_end")) != NULL)
+    *stack = bfd_asymbol_value (sym);
+
+  /* the kernel image, if the program has one, provides the contents
+     of the kernel's own registers */
+  sec = bfd_get_section_by_name (abfd, ".lmmkernel");
+  if (sec != NULL && bfd_get_section_size (sec) > 0)
+    {
+      bfd_size_type len = bfd_get_section_size (sec);
+      unsigned char buf[PROP_COG_LONGS * 4];
+
+      if (len > sizeof (buf))
+	len = sizeof (buf);
+      memset (buf, 0, sizeof (buf));
+      if (bfd_get_section_contents (abfd, sec, buf, 0, len))
+	{
+	  for (i = 0; i < PROP_COG_LONGS; i++)
+	    st->kernel_image[i] = bfd_getl32 (buf + 4 * i);
+	  st->kernel_lma = bfd_section_lma (abfd, sec);
+	  st->have_kernel = 1;
+	}
+    }
+
+  free (syms);
+}
+
+/* Is the code at ADDR in ABFD compressed?  */
+static int
+entry_is_cmm (bfd *abfd, bfd_vma addr)
+{
+  asymbol **syms;
+  long size, count, i;
+  int cmm = 0;
+
+  if (abfd == NULL || bfd_get_flavour (abfd) != bfd_target_elf_flavour)
+    return 0;
+  if ((elf_elfheader (abfd)->e_flags & EF_PROPELLER_COMPRESS) == 0)
+    return 0;
+  size = bfd_get_symtab_upper_bound (abfd);
+  if (size <= 0)
+    return 0;
+  syms = xmalloc (size);
+  count = bfd_canonicalize_symtab (abfd, syms);
+  for (i = 0; i < count; i++)
+    if (bfd_asymbol_value (syms[i]) == addr
+	&& (syms[i]->flags & BSF_SECTION_SYM) == 0
+	&& (((elf_symbol_type *) syms[i])->internal_elf_sym.st_other
+	    & PROPELLER_OTHER_COMPRESSED) != 0)
+      cmm = 1;
+  free (syms);
+  return cmm;
+}
+
+/* Run the cog that is furthest behind for one instruction.  */
+static void
+step_once (SIM_DESC sd)
+{
+  struct propeller_chip *st = chip (sd);
+  struct propeller_cog *cog;
+  int n, i, cycles;
+
+  n = -1;
+  for (i = 0; i < PROP_NUM_COGS; i++)
+    if (st->cog[i].mode != COG_STOPPED
+	&& (n < 0 || st->cog[i].cycles < st->cog[n].cycles))
+      n = i;
+  if (n < 0)
+    {
+      uart_advance (sd, st, ~(uint64_t) 0);
+      sim_io_flush_stdout (sd);
+      propeller_halt (sd, sim_exited, 0);
+    }
+
+  cog = &st->cog[n];
+  switch (cog->mode)
+    {
+    case COG_LMM:
+      cycles = lmm_step (sd, st, n);
+      break;
+    case COG_CMM:
+      cycles = cmm_step (sd, st, n);
+      break;
+    default:
+      cycles = native_step (sd, st, n);
+      break;
+    }
+
+  if (cog->waiting)
+    {
+      /* let the other cogs run; if they are all waiting for pins
+	 too, nothing can ever change them */
+      uint64_t next = ~(uint64_t) 0;
+
+      for (i = 0; i < PROP_NUM_COGS; i++)
+	if (i != n && st->cog[i].mode != COG_STOPPED && !st->cog[i].waiting
+	    && st->cog[i].cycles < next)
+	  next = st->cog[i].cycles;
+      if (next == ~(uint64_t) 0)
+	{
+	  sim_io_eprintf (sd, "propeller: all cogs are waiting for pins\n");
+	  st->focus = n;
+	  propeller_halt (sd, sim_stopped, SIM_SIGABRT);
+	}
+      cycles = next + 1 - cog->cycles;
+    }
+  cog->cycles += cycles;
+  cog->insns++;
+}
+
+void
+sim_engine_run (SIM_DESC sd,
+		int next_cpu_nr,  /* ignore  */
+		int nr_cpus,      /* ignore  */
+		int siggnal)      /* ignore  */
+{
+  SIM_ASSERT (STATE_MAGIC (sd) == SIM_MAGIC_NUMBER);
+
+  while (1)
+    {
+      step_once (sd);
+      if (sim_events_tick (sd))
+	sim_events_process (sd);
+    }
+}
+
+/* Registers as seen by GDB, in the focus cog.  */
+
+static int
+propeller_reg_store (SIM_CPU *cpu, int rn, unsigned char *memory, int length)
+{
+  struct propeller_chip *st = &cpu->state;
+  struct propeller_cog *cog = &st->cog[st->focus];
+  uint32_t val;
+
+  if (rn < 0 || rn >= PROPELLER_SIM_NUM_REGS || length != 4)
+    return 0;
+  val = bfd_getl32 (memory);
+  if (rn == PROPELLER_SIM_CC_REGNUM)
+    {
+      cog->c = (val & PROPELLER_SIM_CC_C) != 0;
+      cog->z = (val & PROPELLER_SIM_CC_Z) != 0;
+    }
+  else
+    cog->mem[rn] = val;
+  return 4;
+}
+
+static int
+propeller_reg_fetch (SIM_CPU *cpu, int rn, unsigned char *memory, int length)
+{
+  struct propeller_chip *st = &cpu->state;
+  struct propeller_cog *cog = &st->cog[st->focus];
+  uint32_t val;
+
+  if (rn < 0 || rn >= PROPELLER_SIM_NUM_REGS || length != 4)
+    return 0;
+  if (rn == PROPELLER_SIM_CC_REGNUM)
+    val = ((cog->c ? PROPELLER_SIM_CC_C : 0)
+	   | (cog->z ? PROPELLER_SIM_CC_Z : 0)
+	   | (cog->kernel == COG_CMM ? PROPELLER_SIM_CC_CMM : 0));
+  else
+    val = cog->mem[rn];
+  bfd_putl32 (val, memory);
+  return 4;
+}
+
+static sim_cia
+propeller_pc_get (SIM_CPU *cpu)
+{
+  struct propeller_chip *st = &cpu->state;
+
+  return st->cog[st->focus].mem[PROP_REG_PC];
+}
+
+static void
+propeller_pc_set (SIM_CPU *cpu, sim_cia newpc)
+{
+  struct propeller_chip *st = &cpu->state;
+
+  st->cog[st->focus].mem[PROP_REG_PC] = newpc;
+}
+
+/* Options.  */
+
+enum {
+  OPTION_PROPELLER_CLKFREQ = OPTION_START,
+  OPTION_PROPELLER_BAUD
+};
+
+static SIM_RC
+propeller_option_handler (SIM_DESC sd, sim_cpu *cpu, int opt, char *arg,
+			  int is_command)
+{
+  struct propeller_chip *st = chip (sd);
+  unsigned long val = strtoul (arg, NULL, 0);
+
+  if (val == 0)
+    {
+      sim_io_eprintf (sd, "invalid value `%s'\n", arg);
+      return SIM_RC_FAIL;
+    }
+  switch (opt)
+    {
+    case OPTION_PROPELLER_CLKFREQ:
+      st->clkfreq = val;
+      return SIM_RC_OK;
+    case OPTION_PROPELLER_BAUD:
+      st->baud = val;
+      return SIM_RC_OK;
+    default:
+      sim_io_eprintf (sd, "Unknown Propeller option %d\n", opt);
+      return SIM_RC_FAIL;
+    }
+}
+
+static const OPTION propeller_options[] =
+{
+  { {"clkfreq", required_argument, NULL, OPTION_PROPELLER_CLKFREQ },
+      '\0', "HZ", "Set the clock frequency used for serial output",
+      propeller_option_handler, NULL },
+  { {"baud", required_argument, NULL, OPTION_PROPELLER_BAUD },
+      '\0', "RATE", "Set the baud rate of the serial output on pin 30",
+      propeller_option_handler, NULL },
+  { {NULL, no_argument, NULL, 0}, '\0', NULL, NULL, NULL, NULL }
+};
+
+/* Print the cycle counts for "info sim" and "run -v".  */
+static void
+propeller_info (SIM_DESC sd, int verbose)
+{
+  struct propeller_chip *st = chip (sd);
+  int n;
+
+  for (n = 0; n < PROP_NUM_COGS; n++)
+    if (st->cog[n].insns != 0)
+      sim_io_printf (sd, "cog %d: %llu instructions, %llu cycles\n", n,
+		     (unsigned long long) st->cog[n].insns,
+		     (unsigned long long) st->cog[n].cycles);
+}
+
+/* Cover function of sim_state_free to free the cpu buffers as well.  */
+
+static void
+free_state (SIM_DESC sd)
+{
+  if (STATE_MODULES (sd) != NULL)
+    sim_module_uninstall (sd);
+  sim_cpu_free_all (sd);
+  sim_state_free (sd);
+}
+
+SIM_DESC
+sim_open (SIM_OPEN_KIND kind,
+	  host_callback *cb,
+	  struct bfd *abfd,
+	  char * const *argv)
+{
+  char c;
+  SIM_DESC sd = sim_state_alloc (kind, cb);
+
+  /* The cpu data is kept in a separately allocated chunk of memory.  */
+  if (sim_cpu_alloc_all (sd, 1, /*cgen_cpu_max_extra_bytes ()*/0) != SIM_RC_OK)
+    {
+      free_state (sd);
+      return 0;
+    }
+
+  if (sim_pre_argv_init (sd, argv[0]) != SIM_RC_OK)
+    {
+      free_state (sd);
+      return 0;
+    }
+
+  chip (sd)->clkfreq = DEFAULT_CLKFREQ;
+  chip (sd)->baud = DEFAULT_BAUD;
+  sim_add_option_table (sd, NULL, propeller_options);
+  sim_module_add_info_fn (sd, propeller_info);
+
+  /* The parser will print an error message for us, so we silently return.  */
+  if (sim_parse_args (sd, argv) != SIM_RC_OK)
+    {
+      free_state (sd);
+      return 0;
+    }
+
+  /* Allocate the hub memory if none specified by user, and room for
+     the load images of drivers.  */
+  if (sim_core_read_buffer (sd, NULL, read_map, &c, 4, 1) == 0)
+    {
+      sim_do_command (sd, "memory region 0x00000000,0x8000");
+      sim_do_command (sd, "memory region 0xc0000000,0x100000");
+    }
+
+  /* Check for/establish the reference program image.  */
+  if (sim_analyze_program (sd,
+			   (STATE_PROG_ARGV (sd) != NULL
+			    ? *STATE_PROG_ARGV (sd)
+			    : NULL), abfd) != SIM_RC_OK)
+    {
+      free_state (sd);
+      return 0;
+    }
+
+  /* Configure/verify the target byte order and other runtime
+     configuration options.  */
+  if (sim_config (sd) != SIM_RC_OK)
+    {
+      free_state (sd);
+      return 0;
+    }
+
+  if (sim_post_argv_init (sd) != SIM_RC_OK)
+    {
+      free_state (sd);
+      return 0;
+    }
+
+  /* CPU specific initialization.  */
+  CPU_REG_FETCH (STATE_CPU (sd, 0)) = propeller_reg_fetch;
+  CPU_REG_STORE (STATE_CPU (sd, 0)) = propeller_reg_store;
+  CPU_PC_FETCH (STATE_CPU (sd, 0)) = propeller_pc_get;
+  CPU_PC_STORE (STATE_CPU (sd, 0)) = propeller_pc_set;
+
+  return sd;
+}
+
+SIM_RC
+sim_create_inferior (SIM_DESC sd,
+		     struct bfd *abfd,
+		     char * const *argv,
+		     char * const *env)
+{
+  struct propeller_chip *st = chip (sd);
+  struct propeller_cog *cog = &st->cog[0];
+  uint32_t stack, entry;
+  int n;
+
+  /* Standalone mode (i.e. `run`) will take care of the argv for us in
+     sim_open() -> sim_parse_args().  But in debug mode (i.e. 'target sim'
+     with `gdb`), we need to handle it because the user can change the
+     argv on the fly via gdb's 'run'.  */
+  if (STATE_PROG_ARGV (sd) != argv)
+    {
+      freeargv (STATE_PROG_ARGV (sd));
+      STATE_PROG_ARGV (sd) = dupargv (argv);
+    }
+
+  memset (st->cog, 0, sizeof (st->cog));
+  memset (st->lock_used, 0, sizeof (st->lock_used));
+  memset (st->lock_state, 0, sizeof (st->lock_state));
+  memset (&st->uart, 0, sizeof (st->uart));
+  st->uart.level = 1;
+  st->uart.bit = -1;
+  st->focus = 0;
+  for (n = 0; n < PROP_NUM_COGS; n++)
+    st->cog[n].mode = COG_STOPPED;
+
+  setup_kernel (sd, st, abfd, &stack);
+  entry = abfd != NULL ? bfd_get_start_address (abfd) : 0;
+
+  /* Cog 0 starts out running the kernel on the program's entry point,
+     with the stack at the top of hub memory.  */
+  if (st->have_kernel)
+    memcpy (cog->mem, st->kernel_image, sizeof (cog->mem));
+  else
+    {
+      /* the register that gas uses for __MASK_FFFFFFFF */
+      cog->mem[19] = 0xffffffff;
+    }
+  cog->kernel = entry_is_cmm (abfd, entry) ? COG_CMM : COG_LMM;
+  cog->mode = cog->kernel;
+  cog->par = stack;
+  cog->fcache_addr = ~0u;
+  cog->mem[PROP_REG_SP] = stack;
+  cog->mem[PROP_REG_PC] = entry;
+  if (st->have_kernel)
+    {
+      asymbol **syms;
+      long size = bfd_get_symtab_upper_bound (abfd), count;
+
+      /* fcache'd code returns through __LMM_RET */
+      syms = xmalloc (size);
+      count = bfd_canonicalize_symtab (abfd, syms);
+      if (count > 0)
+	{
+	  asymbol *ret = find_symbol (syms, count, "__LMM_RET");
+
+	  if (ret != NULL)
+	    cog->mem[cog_address (ret)] = st->loop;
+	}
+      free (syms);
+    }
+
+  return SIM_RC_OK;
+}
@@ -0,0 +1,134 @@
+/* Simulator for the Parallax Propeller.
+
+   Copyright 2017 Parallax Inc.
+
+   This file is part of simulators.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _PROPELLER_SIM_H_
+#define _PROPELLER_SIM_H_
+
+#include <stdint.h>
+
+#include "gdb/sim-propeller.h"
+
+#define PROP_NUM_COGS    8
+#define PROP_COG_LONGS   512
+#define PROP_NUM_LOCKS   8
+
+/* Hub address space: the 32K of hub RAM.  The P1 ROM above it is
+   not modelled.  */
+#define PROP_HUB_SIZE    0x8000
+#define PROP_HUB_MASK    (PROP_HUB_SIZE - 1)
+
+/* Special purpose registers at the top of cog memory.  */
+#define PROP_REG_PAR     0x1f0
+#define PROP_REG_CNT     0x1f1
+#define PROP_REG_INA     0x1f2
+#define PROP_REG_INB     0x1f3
+#define PROP_REG_OUTA    0x1f4
+#define PROP_REG_OUTB    0x1f5
+#define PROP_REG_DIRA    0x1f6
+#define PROP_REG_DIRB    0x1f7
+
+/* Kernel registers used by LMM and CMM code.  */
+#define PROP_REG_LR      15
+#define PROP_REG_SP      16
+#define PROP_REG_PC      17
+
+/* What a cog is running.  Kernel cogs switch between native code (the
+   kernel itself, fcache'd code) and interpreting hub code.  */
+enum propeller_cog_mode
+{
+  COG_STOPPED,
+  COG_NATIVE,
+  COG_LMM,
+  COG_CMM
+};
+
+/* Kernel routines that the simulator implements itself.  They are
+   found by name in the program's symbol table.  */
+enum propeller_kernel_op
+{
+  KERNEL_NONE,
+  KERNEL_LOOP,
+  KERNEL_JMP,
+  KERNEL_CALL,
+  KERNEL_MVI,
+  KERNEL_FCACHE,
+  KERNEL_PUSHM,
+  KERNEL_POPM,
+  KERNEL_POPRET,
+  KERNEL_LRET,
+  KERNEL_MUL,
+  KERNEL_UDIV,
+  KERNEL_DIV
+};
+
+struct propeller_hook
+{
+  enum propeller_kernel_op op;
+  int reg;			/* register for KERNEL_MVI */
+  int ret;			/* the routine's _ret register, or -1 */
+};
+
+struct propeller_cog
+{
+  uint32_t mem[PROP_COG_LONGS];
+  uint32_t par;
+  uint32_t pc;			/* cog pc of native code */
+  int z, c;
+  enum propeller_cog_mode mode;
+  /* COG_LMM or COG_CMM for a cog running the kernel, else COG_STOPPED */
+  enum propeller_cog_mode kernel;
+  /* waitpeq/waitpne in progress */
+  int waiting;
+  uint64_t cycles;		/* the cog's clock */
+  uint64_t insns;
+  uint32_t fcache_addr;		/* hub address of the code in the fcache */
+};
+
+/* Receiver for the serial output on pin 30.  */
+struct propeller_uart
+{
+  int level;
+  int bit;			/* next bit to sample, -1 when idle */
+  uint64_t start;		/* clock of the start bit */
+  unsigned int data;
+  int held;			/* bytes held back as a possible exit sequence */
+};
+
+struct propeller_chip
+{
+  struct propeller_cog cog[PROP_NUM_COGS];
+  int lock_used[PROP_NUM_LOCKS];
+  int lock_state[PROP_NUM_LOCKS];
+  int focus;			/* cog whose registers GDB sees */
+
+  /* The kernel model.  */
+  struct propeller_hook hook[PROP_COG_LONGS];
+  uint32_t loop;		/* cog address of the kernel loop */
+  uint32_t fcache_start;	/* cog address of the fcache buffer */
+  int tmp0;			/* __TMP0, the argument of pushm/popm */
+  uint32_t kernel_lma;		/* hub copy of the kernel image */
+  uint32_t kernel_image[PROP_COG_LONGS];
+  int have_kernel;
+
+  uint32_t clkfreq;
+  uint32_t baud;
+  struct propeller_uart uart;
+};
+
+#endif  /* _PROPELLER_SIM_H_ */
@@ -0,0 +1,62 @@
+# check that CMM code runs through the kernel model.
+# mach: propeller
+# as: --cmm
+
+	.include "testutils.inc"
+
+	start
+
+# native instructions
+	mov	r4, #10
+	add	r4, #23
+	EXPECT	r4, 33
+	shl	r4, #4
+	EXPECT	r4, 528
+	neg	r4, r4
+	EXPECT	r4, -528
+
+# mvi is a compressed form
+	mvi	r4, #0x12345678
+	EXPECT	r4, 0x12345678
+
+# brs forward and back
+	mov	r4, #0
+	mov	r5, #5
+1:	add	r4, #3
+	sub	r5, #1 wz
+	if_ne	brs	#1b
+	EXPECT	r4, 15
+	brs	#2f
+	brw	#failcase
+2:
+
+# brl beyond brs range is a brw
+	brl	#3f
+	brw	#failcase
+	.space	200
+3:
+
+# lcall and lret
+	mov	r4, #0
+	lcall	#inc4
+	lcall	#inc4
+	EXPECT	r4, 8
+
+# hub memory
+	mvi	r5, #word
+	rdlong	r4, r5
+	EXPECT	r4, 0xdeadbeef
+	mvi	r4, #0x01020304
+	wrlong	r4, r5
+	rdbyte	r4, r5
+	EXPECT	r4, 4
+
+	PASS
+
+inc4:
+	add	r4, #4
+	lret
+
+	.data
+	.balign	4
+word:	.long	0xdeadbeef